@@ -0,0 +1,70 @@
+#! /usr/bin/env python
+
+# Copyright 2021
+#
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This script checks that the reuse of rho_new of a PSATD step as rho_old of the
+# next step (psatd.reuse_rho_old = 1) does not change the result when the grids
+# are load balanced in between. The simulation of the test (`inputs_2d_multi_rt`
+# with the runtime parameters of the test Langmuir_multi_2d_psatd_load_balance)
+# is run again with psatd.reuse_rho_old = 0, from the executable and inputs file
+# that the regression harness copies in the directory of the test, and the fields
+# of the two runs are compared.
+#
+# The two runs only differ by the order in which the particles deposit rho_old,
+# since the particles are redistributed after the push. The relative difference
+# of the fields is thus at the level of the round-off errors; it is checked with
+# a margin of a few orders of magnitude, while a rho_old that is not carried over
+# the load balance (e.g. zero in the boxes that changed rank) changes the fields
+# at the level of the fields themselves.
+import glob
+import os
+import subprocess
+import sys
+import yt
+yt.funcs.mylog.setLevel(50)
+import numpy as np
+
+# this will be the name of the plot file
+fn = sys.argv[1]
+
+# Parameters (these parameters must match the runtime parameters of the test)
+numprocs = 2
+runtime_params = ['algo.maxwell_solver=psatd', 'psatd.fftw_plan_measure=0',
+                  'psatd.update_with_rho=1', 'amr.max_grid_size=32',
+                  'DistributionMapping.strategy=ROUNDROBIN',
+                  'algo.load_balance_intervals=10', 'algo.load_balance_with_sfc=1',
+                  'algo.load_balance_costs_update=Heuristic',
+                  'algo.load_balance_efficiency_ratio_threshold=0.5',
+                  'diag1.fields_to_plot=Ex Ez By jx jz rho',
+                  'warpx.cfl=0.7071067811865475']
+fields = ['Ex', 'Ez', 'By', 'jx', 'jz', 'rho']
+rtol = 1.e-10
+
+# Run the simulation again without the reuse of rho_new
+executable = glob.glob('*.ex')[0]
+fn_ref = 'reference_' + os.path.basename(os.path.normpath(fn))
+prefix_ref = fn_ref[:-5]
+env = dict(os.environ, OMP_NUM_THREADS='1')
+subprocess.check_call(['mpiexec', '-n', str(numprocs), './' + executable, 'inputs_2d_multi_rt']
+                      + runtime_params
+                      + ['psatd.reuse_rho_old=0', 'diag1.file_prefix=' + prefix_ref],
+                      env=env)
+
+ds = yt.load( fn )
+ds_ref = yt.load( fn_ref )
+data = ds.covering_grid(level=0, left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+data_ref = ds_ref.covering_grid(level=0, left_edge=ds_ref.domain_left_edge,
+                                dims=ds_ref.domain_dimensions)
+
+for field in fields:
+    F = data[('mesh', field)].to_ndarray()
+    F_ref = data_ref[('mesh', field)].to_ndarray()
+    error_rel = np.max(np.abs(F - F_ref)) / np.max(np.abs(F_ref))
+    print(field + ': relative difference with psatd.reuse_rho_old=0 = %s' %error_rel)
+    assert( error_rel < rtol )
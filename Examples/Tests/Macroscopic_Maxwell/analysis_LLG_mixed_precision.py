@@ -0,0 +1,46 @@
+#! /usr/bin/env python
+
+# Copyright 2021
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+# This script checks the mixed-precision 2nd-order LLG scheme (USE_LLG_MIXED_PRECISION=TRUE)
+# with inputs_3d_LLG_mixed_precision. A uniform M, saturated along x, is damped towards the
+# uncoupled bias field Hz_bias, for which Mz/Ms = tanh(alpha |gamma| mu0 Hz_bias t / (1 + alpha^2)).
+# The average Mz from the reduced diagnostic `LLGMagnetization` is compared to this solution and,
+# if the reduced diagnostic of a double-precision run of the same input is given as argument,
+# to the double-precision result, which quantifies the error added by the single precision.
+
+import sys
+import numpy as np
+
+Ms = 1.4e5
+alpha = 0.5
+gamma = 1.759e11
+mu0 = 1.25663706212e-06
+Hz_bias = 3e4
+
+def read_Mz(filename):
+    with open(filename) as f:
+        header = f.readline().split()
+    col = [n for n, name in enumerate(header) if 'Mz_avg_lev0' in name][0]
+    data = np.loadtxt(filename)
+    return data[:,1], data[:,col]
+
+time, Mz = read_Mz('./diags/reducedfiles/LLGM.txt')
+
+Mz_theory = Ms * np.tanh(alpha * gamma * mu0 * Hz_bias * time / (1. + alpha**2))
+error_theory = np.max(np.abs(Mz - Mz_theory)) / Ms
+print('max |Mz - Mz_theory|/Ms = %g' % error_theory)
+assert(error_theory < 1.e-3)
+
+if len(sys.argv) > 1:
+    time_ref, Mz_ref = read_Mz(sys.argv[1])
+    assert(np.allclose(time, time_ref))
+    error_ref = np.max(np.abs(Mz - Mz_ref)) / Ms
+    print('max |Mz - Mz_double|/Ms = %g' % error_ref)
+    # the single-precision round-off of H_eff, a and b accumulates over the time steps,
+    # but must stay well below the time-discretization error
+    assert(error_ref < 1.e-4)
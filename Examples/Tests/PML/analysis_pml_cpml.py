@@ -0,0 +1,59 @@
+#! /usr/bin/env python
+
+# Copyright 2021
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+# Reflection coefficient of the convolutional PML (warpx.pml_type = cpml),
+# compared with that of the split PML for the same laser, grid and sigma
+# profile (test pml_x_yee, see analysis_pml_yee.py).
+# Both PMLs damp the same profile, but are discretized differently, so the
+# CPML is only required to reflect at most twice as much energy as the split
+# PML. An error in the damping factors of the memory variables (e.g. the
+# damping of a whole step applied at each half-step update of B) mismatches
+# the E and B damping of the PML, and raises the reflection coefficient far
+# above this bound.
+
+import sys
+import yt ; yt.funcs.mylog.setLevel(0)
+import numpy as np
+import scipy.constants as scc
+
+filename = sys.argv[1]
+
+############################
+### INITIAL LASER ENERGY ###
+############################
+energy_start = 9.1301289517e-08
+
+##########################
+### FINAL LASER ENERGY ###
+##########################
+ds = yt.load( filename )
+all_data_level_0 = ds.covering_grid(level=0,left_edge=ds.domain_left_edge, dims=ds.domain_dimensions)
+Bx = all_data_level_0['boxlib', 'Bx'].v.squeeze()
+By = all_data_level_0['boxlib', 'By'].v.squeeze()
+Bz = all_data_level_0['boxlib', 'Bz'].v.squeeze()
+Ex = all_data_level_0['boxlib', 'Ex'].v.squeeze()
+Ey = all_data_level_0['boxlib', 'Ey'].v.squeeze()
+Ez = all_data_level_0['boxlib', 'Ez'].v.squeeze()
+energyE = np.sum(scc.epsilon_0/2*(Ex**2+Ey**2+Ez**2))
+energyB = np.sum(1./scc.mu_0/2*(Bx**2+By**2+Bz**2))
+energy_end = energyE + energyB
+
+Reflectivity = energy_end/energy_start
+# reflection coefficient of the split PML (analysis_pml_yee.py)
+Reflectivity_split = 5.683000058954201e-07
+
+print("Reflectivity (cpml) : %s" %Reflectivity)
+print("Reflectivity (split): %s" %Reflectivity_split)
+
+ratio = Reflectivity/Reflectivity_split
+tolerance_ratio = 2.
+
+print("ratio          : " + str(ratio))
+print("tolerance_ratio: " + str(tolerance_ratio))
+
+assert( ratio < tolerance_ratio )
@@ -27,6 +27,7 @@ filename = sys.argv[1]
 # Parse test name
 averaged = True if re.search( 'averaged', filename ) else False
 current_correction = True if re.search( 'current_correction', filename ) else False
+single_fft = True if re.search( 'single_fft', filename ) else False
 dims_RZ  = True if re.search('rz', filename) else False
 
 ds = yt.load( filename )
@@ -78,4 +79,16 @@ if current_correction:
     assert( error_rel < tolerance )
 
 test_name = filename[:-9] # Could also be os.path.split(os.getcwd())[1]
-checksumAPI.evaluate_checksum(test_name, filename)
+if single_fft:
+    # Single-precision FFTs: compare with the benchmark of the same test with
+    # double-precision FFTs. The round-off errors of the FFTs change the noise
+    # of the fields and of the thermal momenta over the 400 steps, so the two
+    # runs may be uncorrelated at the end. The checksums of the noisy quantities
+    # are sums of |f| over 128x128 cells or 2x2x128x128 particles, whose relative
+    # statistical fluctuation is below 0.75/128 ~ 6e-3 for Gaussian noise: the
+    # tolerance is about 8 times this, while an unstable or wrongly normalized
+    # single-precision solver changes them by orders of magnitude (see also the
+    # check of the energy of the electric field above).
+    checksumAPI.evaluate_checksum('galilean_2d_psatd', filename, rtol=5.e-2)
+else:
+    checksumAPI.evaluate_checksum(test_name, filename)
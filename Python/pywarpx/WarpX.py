@@ -71,9 +71,9 @@ class WarpX(Bucket):
         argv = ['warpx'] + self.create_argv_list()
         wx.initialize(argv)
 
-    def evolve(self, nsteps=-1):
+    def evolve(self, nsteps=-1, callback=None, callback_interval=1):
         from . import wx
-        wx.evolve(nsteps)
+        wx.evolve(nsteps, callback, callback_interval)
 
     def finalize(self, finalize_mpi=1):
         from . import wx
@@ -10,7 +10,6 @@ import os
 import sys
 import atexit
 import ctypes
-from ctypes.util import find_library as _find_library
 import numpy as np
 from numpy.ctypeslib import ndpointer as _ndpointer
 
@@ -57,8 +56,6 @@ else:
         raise Exception('Undefined coordinate system %d'%_coord_sys)
     del _prob_lo, _coord_sys
 
-_libc = ctypes.CDLL(_find_library('c'))
-
 # this is a plain C/C++ shared library, not a Python module
 if os.name == 'nt':
     mod_ext = "dll"
@@ -94,6 +91,11 @@ else:
 
 dim = libwarpx.warpx_SpaceDim()
 
+# whether the fields and particles live in device memory
+_use_gpu = bool(libwarpx.warpx_use_gpu())
+# whether the data getters return views of the device memory (see use_device_arrays)
+_use_device_arrays = False
+
 # our particle data type, depends on _ParticleReal_size
 _p_struct = [(d, _numpy_particlereal_dtype) for d in 'xyz'[:dim]] + [('id', 'i4'), ('cpu', 'i4')]
 _p_dtype = np.dtype(_p_struct, align=True)
@@ -134,8 +136,55 @@ def _array1d_from_pointer(pointer, dtype, size):
     return np.frombuffer(buf, dtype=dtype, count=size)
 
 
+class DeviceArrayView(object):
+    '''
+    View of an array in device memory, exposing the ``__cuda_array_interface__``
+    so that it can be used in place by CuPy, Numba or PyTorch, without a copy
+    (e.g. ``cupy.asarray(view)``).
+    '''
+    def __init__(self, pointer, dtype, shape, strides):
+        self.__cuda_array_interface__ = {'data': (pointer, False),
+                                         'typestr': np.dtype(dtype).str,
+                                         'shape': tuple(shape),
+                                         'strides': tuple(strides),
+                                         'version': 2}
+
+    @property
+    def shape(self):
+        return self.__cuda_array_interface__['shape']
+
+
+def _device_array(pointer, dtype, shape, strides):
+    '''
+    Returns a CuPy array sharing the device memory at pointer if CuPy is
+    available, a DeviceArrayView of it otherwise.
+    '''
+    view = DeviceArrayView(pointer, dtype, shape, strides)
+    try:
+        import cupy
+    except ImportError:
+        return view
+    return cupy.asarray(view)
+
+
+def use_device_arrays(flag=True):
+    '''
+
+    With flag True, the field and particle getters (get_mesh_*, get_particle_*)
+    of a GPU build return views of the device memory (CuPy arrays if CuPy is
+    installed, DeviceArrayView objects exposing the ``__cuda_array_interface__``
+    otherwise) instead of numpy arrays. The data is neither copied to the host
+    nor migrated there, and can be modified in place. This has no effect on a
+    CPU build.
+
+    '''
+    global _use_device_arrays
+    _use_device_arrays = flag and _use_gpu
+
+
 # set the arg and return types of the wrapped functions
 libwarpx.amrex_init.argtypes = (ctypes.c_int, _LP_LP_c_char)
+libwarpx.warpx_use_gpu.restype = ctypes.c_int
 libwarpx.warpx_getParticleStructs.restype = _LP_particle_p
 libwarpx.warpx_getParticleArrays.restype = _LP_LP_c_particlereal
 libwarpx.warpx_getEfield.restype = _LP_LP_c_real
@@ -198,6 +247,13 @@ libwarpx.warpx_addNParticles.argtypes = (ctypes.c_int, ctypes.c_int,
                                          ctypes.c_int,
                                          _ndpointer(c_particlereal, flags="C_CONTIGUOUS"),
                                          ctypes.c_int)
+libwarpx.warpx_addNParticlesFromDevice.argtypes = (ctypes.c_int, ctypes.c_long,
+                                                   ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p,
+                                                   ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p,
+                                                   ctypes.c_int, ctypes.c_void_p, ctypes.c_int)
+
+_CALLBACK_FUNC_0 = ctypes.CFUNCTYPE(None)
+libwarpx.warpx_evolve_batched.argtypes = (ctypes.c_int, ctypes.c_int, _CALLBACK_FUNC_0)
 
 libwarpx.warpx_getProbLo.restype = c_real
 libwarpx.warpx_getProbHi.restype = c_real
@@ -272,21 +328,34 @@ def finalize(finalize_mpi=1):
     libwarpx.amrex_finalize(finalize_mpi)
 
 
-def evolve(num_steps=-1):
+def evolve(num_steps=-1, callback=None, callback_interval=1):
     '''
 
     Evolve the simulation for num_steps steps. If num_steps=-1,
     the simulation will be run until the end as specified in the
     inputs file.
 
+    With a callback, the steps are taken by batches of callback_interval
+    steps, without returning to Python, and callback() is called after
+    each batch. This is faster than calling evolve(1) in a loop.
+
     Parameters
     ----------
 
     num_steps: int, the number of steps to take
 
+    callback: function without arguments, called after each batch of steps (default = None)
+
+    callback_interval: int, the number of steps of each batch (default = 1)
+
     '''
 
-    libwarpx.warpx_evolve(num_steps);
+    if callback is None:
+        libwarpx.warpx_evolve(num_steps);
+    else:
+        # the ctypes function must stay alive while WarpX may call it
+        c_callback = _CALLBACK_FUNC_0(callback)
+        libwarpx.warpx_evolve_batched(num_steps, callback_interval, c_callback)
 
 
 def getProbLo(direction):
@@ -363,8 +432,18 @@ def add_particles(species_number=0,
     unique_particles : whether the particles are unique or duplicated on
                        several processes. (default = True)
 
+    With a GPU build, x, y, z, ux, uy, uz and attr may instead all be device
+    arrays (exposing the ``__cuda_array_interface__``, e.g. CuPy arrays) of the same
+    length, attr being the weights: the particles are then added on the device,
+    with a single kernel.
+
     '''
 
+    if hasattr(x, '__cuda_array_interface__'):
+        _add_particles_from_device(species_number, x, y, z, ux, uy, uz, attr,
+                                   unique_particles)
+        return
+
     # --- Get length of arrays, set to one for scalars
     lenx = np.size(x)
     leny = np.size(y)
@@ -407,6 +486,39 @@ def add_particles(species_number=0,
                                  x, y, z, ux, uy, uz,
                                  attr.shape[-1], attr, unique_particles)
 
+def _device_pointer(array, size, name):
+    '''
+    Returns the device pointer of the contiguous array of size particle reals, which
+    exposes the ``__cuda_array_interface__``.
+    '''
+    assert hasattr(array, '__cuda_array_interface__'), \
+        "%s must be a device array, like x"%name
+    interface = array.__cuda_array_interface__
+    assert np.dtype(interface['typestr']) == np.dtype(_numpy_particlereal_dtype), \
+        "%s must be an array of %s"%(name, _numpy_particlereal_dtype)
+    assert int(np.prod(interface['shape'])) == size, \
+        "Length of %s doesn't match the length of x"%name
+    strides = interface.get('strides')
+    assert strides is None or len(interface['shape']) != 1 or strides[0] == _ParticleReal_size, \
+        "%s must be contiguous"%name
+    return interface['data'][0]
+
+
+def _add_particles_from_device(species_number, x, y, z, ux, uy, uz, w, unique_particles):
+    '''
+    Adds the particles of the device arrays (exposing the ``__cuda_array_interface__``,
+    e.g. CuPy arrays) x, y, z, ux, uy, uz and of the weights w, with a single kernel
+    and without a copy through the host.
+    '''
+    assert _use_gpu, "Device arrays require a GPU build of WarpX"
+    size = int(np.prod(x.__cuda_array_interface__['shape']))
+    if size == 0:
+        return
+    pointers = [_device_pointer(a, size, name)
+                for a, name in zip([x, y, z, ux, uy, uz, w], ['x', 'y', 'z', 'ux', 'uy', 'uz', 'attr'])]
+    libwarpx.warpx_addNParticlesFromDevice(species_number, size, *pointers[:6],
+                                           1, pointers[6], unique_particles)
+
 def get_particle_structs(species_number, level):
     '''
 
@@ -417,6 +529,9 @@ def get_particle_structs(species_number, level):
     The data for the numpy arrays are not copied, but share the underlying
     memory buffer with WarpX. The numpy arrays are fully writeable.
 
+    With use_device_arrays, each tile is instead a dictionary of the device
+    arrays of 'x', 'y', 'z', 'id', and 'cpu'.
+
     Parameters
     ----------
 
@@ -437,11 +552,17 @@ def get_particle_structs(species_number, level):
 
     particle_data = []
     for i in range(num_tiles.value):
-        arr = _array1d_from_pointer(data[i], _p_dtype, particles_per_tile[i])
+        if _use_device_arrays:
+            # one strided view per member of the particle struct
+            address = ctypes.cast(data[i], ctypes.c_void_p).value or 0
+            arr = {name: _device_array(address + _p_dtype.fields[name][1],
+                                       _p_dtype.fields[name][0],
+                                       (particles_per_tile[i],), (_p_dtype.itemsize,))
+                   for name in _p_dtype.names}
+        else:
+            arr = _array1d_from_pointer(data[i], _p_dtype, particles_per_tile[i])
         particle_data.append(arr)
 
-    _libc.free(particles_per_tile)
-    _libc.free(data)
     return particle_data
 
 
@@ -475,6 +596,12 @@ def get_particle_arrays(species_number, comp, level):
 
     particle_data = []
     for i in range(num_tiles.value):
+        if _use_device_arrays:
+            arr = _device_array(ctypes.cast(data[i], ctypes.c_void_p).value or 0,
+                                c_particlereal, (particles_per_tile[i],),
+                                (ctypes.sizeof(c_particlereal),))
+            particle_data.append(arr)
+            continue
         arr = np.ctypeslib.as_array(data[i], (particles_per_tile[i],))
         try:
             # This fails on some versions of numpy
@@ -483,8 +610,6 @@ def get_particle_arrays(species_number, comp, level):
             pass
         particle_data.append(arr)
 
-    _libc.free(particles_per_tile)
-    _libc.free(data)
     return particle_data
 
 
@@ -651,6 +776,9 @@ def _get_mesh_field_list(warpx_func, level, direction, include_ghosts):
         shapesize += 1
     for i in range(size.value):
         shape = tuple([shapes[shapesize*i + d] for d in range(shapesize)])
+        if _use_device_arrays:
+            grid_data.append(_get_device_field(data[i], shape, ngvect, include_ghosts))
+            continue
         # --- The data is stored in Fortran order, hence shape is reversed and a transpose is taken.
         arr = np.ctypeslib.as_array(data[i], shape[::-1]).T
         try:
@@ -663,11 +791,24 @@ def _get_mesh_field_list(warpx_func, level, direction, include_ghosts):
         else:
             grid_data.append(arr[tuple([slice(ngvect[d], -ngvect[d]) for d in range(dim)])])
 
-    _libc.free(shapes)
-    _libc.free(data)
     return grid_data
 
 
+def _get_device_field(pointer, shape, ngvect, include_ghosts):
+    """
+     View of the device memory of a field on a grid, stored in Fortran order.
+    """
+    itemsize = ctypes.sizeof(c_real)
+    strides = [itemsize*int(np.prod(shape[:d])) for d in range(len(shape))]
+    address = ctypes.cast(pointer, ctypes.c_void_p).value or 0
+    shape = list(shape)
+    if not include_ghosts:
+        for d in range(dim):
+            address += ngvect[d]*strides[d]
+            shape[d] -= 2*ngvect[d]
+    return _device_array(address, c_real, shape, strides)
+
+
 def get_mesh_electric_field(level, direction, include_ghosts=True):
     '''
 
@@ -1168,7 +1309,6 @@ def _get_mesh_array_lovects(level, direction, include_ghosts=True, getlovectsfun
             lovects[d,:] += ngrowvect[d]
 
     del lovects_ref
-    _libc.free(data)
     return lovects, ng
 
 
@@ -1571,7 +1711,6 @@ def _get_nodal_flag(getdatafunc):
     nodal_flag = nodal_flag_ref.copy()
 
     del nodal_flag_ref
-    _libc.free(data)
     return nodal_flag
 
 
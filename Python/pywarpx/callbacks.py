@@ -37,6 +37,12 @@ Functions can be called at the following times:
  - appliedfields <installappliedfields>: allows directly specifying any fields to be applied to the particles
                                          during the advance
 
+By default, the functions installed at a point are called at every step. They
+can be restricted to some steps with setcallbackintervals, e.g.
+setcallbackintervals('afterstep', '::10') to call them every 10 steps: the other
+steps then do not call into Python at all. Likewise, no call into Python is made
+at a point where no function is installed.
+
 To use a decorator, the syntax is as follows. This will install the function myplots to be called after each step.
 
 @callfromafterstep
@@ -81,15 +87,29 @@ class CallbackFunctions(object):
         self.timers = {}
         self.name = name
         self.lcallonce = lcallonce
+        self.cfunc = None
+        self.csetter = None
 
     def __call__(self,*args,**kw):
         "Call all of the functions in the list"
         tt = self.callfuncsinlist(*args,**kw)
         self.time = self.time + tt
-        if self.lcallonce: self.funcs = []
+        if self.lcallonce: self.clearlist()
 
     def clearlist(self):
         self.funcs = []
+        self.updatecallback()
+
+    def setcallback(self,cfunc,csetter):
+        "Sets the C function calling this list, and the setter registering it in WarpX"
+        self.cfunc = cfunc
+        self.csetter = csetter
+        self.updatecallback()
+
+    def updatecallback(self):
+        "Registers the C function in WarpX only when functions are installed"
+        if self.csetter is not None:
+            self.csetter(self.cfunc if self.hasfuncsinstalled() else None)
 
     def __nonzero__(self):
         "Returns True if functions are installed, otherwise False"
@@ -164,6 +184,7 @@ class CallbackFunctions(object):
                 self.funcs.append(f)
         else:
             self.funcs.append(f)
+        self.updatecallback()
 
     def uninstallfuncinlist(self,f):
         "Uninstall the specified function"
@@ -174,15 +195,18 @@ class CallbackFunctions(object):
         for func in funclistcopy:
             if f == func:
                 self.funcs.remove(f)
+                self.updatecallback()
                 return
             elif isinstance(func,list) and isinstance(f,types.MethodType):
                 object = self._getmethodobject(func)
                 if f.im_self is object and f.__name__ == func[1]:
                     self.funcs.remove(func)
+                    self.updatecallback()
                     return
             elif isinstance(func,basestring):
                 if f.__name__ == func:
                     self.funcs.remove(func)
+                    self.updatecallback()
                     return
             elif isinstance(f,basestring):
                 if isinstance(func,basestring): funcname = func
@@ -190,6 +214,7 @@ class CallbackFunctions(object):
                 else:                        funcname = func.__name__
                 if f == funcname:
                     self.funcs.remove(func)
+                    self.updatecallback()
                     return
         raise Exception('Warning: no such function had been installed')
 
@@ -241,31 +266,47 @@ _appliedfields = CallbackFunctions('appliedfields')
 
 # --- Create the objects that can be called from C.
 # --- Note that each of the CFUNCTYPE instances need to be saved
+# --- They are only registered in WarpX while functions are installed.
 _CALLBACK_FUNC_0 = ctypes.CFUNCTYPE(None)
+for _name in ['afterinit', 'beforeEsolve', 'afterEsolve', 'beforedeposition', 'afterdeposition',
+              'particlescraper', 'particleloader', 'beforestep', 'afterstep', 'afterrestart',
+              'particleinjection', 'appliedfields']:
+    getattr(libwarpx, 'warpx_set_callback_py_' + _name).argtypes = [_CALLBACK_FUNC_0]
+libwarpx.warpx_set_callback_py_intervals.argtypes = [ctypes.c_char_p, ctypes.c_char_p]
+libwarpx.warpx_set_callback_py_intervals.restype = ctypes.c_int
 _c_afterinit = _CALLBACK_FUNC_0(_afterinit)
-libwarpx.warpx_set_callback_py_afterinit(_c_afterinit)
+_afterinit.setcallback(_c_afterinit, libwarpx.warpx_set_callback_py_afterinit)
 _c_beforeEsolve = _CALLBACK_FUNC_0(_beforeEsolve)
-libwarpx.warpx_set_callback_py_beforeEsolve(_c_beforeEsolve)
+_beforeEsolve.setcallback(_c_beforeEsolve, libwarpx.warpx_set_callback_py_beforeEsolve)
 _c_afterEsolve = _CALLBACK_FUNC_0(_afterEsolve)
-libwarpx.warpx_set_callback_py_afterEsolve(_c_afterEsolve)
+_afterEsolve.setcallback(_c_afterEsolve, libwarpx.warpx_set_callback_py_afterEsolve)
 _c_beforedeposition = _CALLBACK_FUNC_0(_beforedeposition)
-libwarpx.warpx_set_callback_py_beforedeposition(_c_beforedeposition)
+_beforedeposition.setcallback(_c_beforedeposition, libwarpx.warpx_set_callback_py_beforedeposition)
 _c_afterdeposition = _CALLBACK_FUNC_0(_afterdeposition)
-libwarpx.warpx_set_callback_py_afterdeposition(_c_afterdeposition)
+_afterdeposition.setcallback(_c_afterdeposition, libwarpx.warpx_set_callback_py_afterdeposition)
 _c_particlescraper = _CALLBACK_FUNC_0(_particlescraper)
-libwarpx.warpx_set_callback_py_particlescraper(_c_particlescraper)
+_particlescraper.setcallback(_c_particlescraper, libwarpx.warpx_set_callback_py_particlescraper)
 _c_particleloader = _CALLBACK_FUNC_0(_particleloader)
-libwarpx.warpx_set_callback_py_particleloader(_c_particleloader)
+_particleloader.setcallback(_c_particleloader, libwarpx.warpx_set_callback_py_particleloader)
 _c_beforestep = _CALLBACK_FUNC_0(_beforestep)
-libwarpx.warpx_set_callback_py_beforestep(_c_beforestep)
+_beforestep.setcallback(_c_beforestep, libwarpx.warpx_set_callback_py_beforestep)
 _c_afterstep = _CALLBACK_FUNC_0(_afterstep)
-libwarpx.warpx_set_callback_py_afterstep(_c_afterstep)
+_afterstep.setcallback(_c_afterstep, libwarpx.warpx_set_callback_py_afterstep)
 _c_afterrestart = _CALLBACK_FUNC_0(_afterrestart)
-libwarpx.warpx_set_callback_py_afterrestart(_c_afterrestart)
+_afterrestart.setcallback(_c_afterrestart, libwarpx.warpx_set_callback_py_afterrestart)
 _c_particleinjection = _CALLBACK_FUNC_0(_particleinjection)
-libwarpx.warpx_set_callback_py_particleinjection(_c_particleinjection)
+_particleinjection.setcallback(_c_particleinjection, libwarpx.warpx_set_callback_py_particleinjection)
 _c_appliedfields = _CALLBACK_FUNC_0(_appliedfields)
-libwarpx.warpx_set_callback_py_appliedfields(_c_appliedfields)
+_appliedfields.setcallback(_c_appliedfields, libwarpx.warpx_set_callback_py_appliedfields)
+
+#=============================================================================
+def setcallbackintervals(name, intervals=None):
+    """Restricts the functions installed at the point name (e.g. 'afterstep')
+    to the steps in intervals, with the syntax of the diagnostics intervals
+    (e.g. '::10' or '100:200:5,1000'). With intervals None, they are called
+    at every step."""
+    if not libwarpx.warpx_set_callback_py_intervals(name.encode(), (intervals or '').encode()):
+        raise Exception('setcallbackintervals: unknown call back %s'%name)
 
 #=============================================================================
 def printcallbacktimers(tmin=1.,lminmax=False,ff=None):
@@ -0,0 +1,56 @@
+#!/bin/bash
+
+# Copyright 2021
+#
+# This file is part of WarpX.
+#
+# License: BSD-3-Clause-LBNL
+
+
+# This script benchmarks the communication patterns of WarpX (comm_benchmark.enable):
+# the guard cell exchanges of E, B (and H, M with LLG), the sum of the current guard
+# cells, the synchronization of the nodal points, the PML exchanges and the
+# redistribution of the particles, with the inputs.2d file of this directory.
+# For each number of MPI ranks and with and without PML, it runs the benchmark on
+# the decompositions MAX_GRID_SIZES, and collects the time per call (latency),
+# messages and bytes per call and bandwidth of each pattern in comm_benchmark.txt.
+#
+# Usage, with a compiled executable:
+#   ./comm_benchmark.sh <executable> [n_cell]
+# e.g.
+#   ./comm_benchmark.sh ./main2d.gnu.TPROF.MPI.OMP.ex 256
+
+# exit if error
+set -e
+
+EXECUTABLE=$1
+N_CELL=${2:-128}
+NPROCS="1 2 4"
+MAX_GRID_SIZES="16 32 64"
+REPEAT=100
+OMP_NUM_THREADS=1
+export OMP_NUM_THREADS
+
+if [ -z "$EXECUTABLE" ]; then
+    echo "ERROR: usage: ./comm_benchmark.sh <executable> [n_cell]"
+    exit 1
+fi
+
+rm -f comm_benchmark.txt
+for NP in $NPROCS; do
+    for PML in 0 1; do
+        RUNNAME=NP.$NP.PML.$PML
+        mpirun -np $NP $EXECUTABLE inputs.2d \
+               amr.n_cell="$N_CELL $N_CELL" \
+               amr.blocking_factor=16 \
+               warpx.do_pml=$PML \
+               comm_benchmark.enable=1 \
+               comm_benchmark.max_grid_size="$MAX_GRID_SIZES" \
+               comm_benchmark.repeat=$REPEAT \
+               comm_benchmark.output=$RUNNAME.txt \
+               > $RUNNAME.out
+        echo "# $RUNNAME" >> comm_benchmark.txt
+        cat $RUNNAME.txt >> comm_benchmark.txt
+    done
+done
+echo "Results in comm_benchmark.txt"
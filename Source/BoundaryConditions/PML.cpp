@@ -8,11 +8,14 @@
  */
 #include "BoundaryConditions/PML.H"
 #include "BoundaryConditions/PMLComponent.H"
+#include "Parallelization/CommStats.H"
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXUtil.H"
 #include "WarpX.H"
 
 #include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
 #include <AMReX_Print.H>
 #include <AMReX_VisMF.H>
 
@@ -22,6 +25,8 @@
 
 #include <algorithm>
 #include <memory>
+#include <string>
+#include <vector>
 
 
 using namespace amrex;
@@ -123,6 +128,8 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
     const int*     lo = box.loVect();
     const int*     hi = box.hiVect();
 
+    has_damping.fill(false);
+
     for (int idim = 0; idim < AMREX_SPACEDIM; ++idim)
     {
         sigma                [idim].resize(sz[idim]+1);
@@ -220,6 +227,7 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
                 FillLo(idim, sigma[idim], sigma_cumsum[idim],
                        sigma_star[idim], sigma_star_cumsum[idim],
                        looverlap, grid_box, fac[idim]);
+                has_damping[idim] = true;
             }
 
             Box hibox = amrex::adjCellHi(grid_box, idim, ncell);
@@ -232,6 +240,7 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
                 FillHi(idim, sigma[idim], sigma_cumsum[idim],
                        sigma_star[idim],  sigma_star_cumsum[idim],
                        hioverlap, grid_box, fac[idim]);
+                has_damping[idim] = true;
             }
 
             if (!looverlap.ok() && !hioverlap.ok()) {
@@ -263,6 +272,7 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
                 FillLo(idim, sigma[idim], sigma_cumsum[idim],
                       sigma_star[idim],  sigma_star_cumsum[idim],
                       looverlap, grid_box, fac[idim]);
+                has_damping[idim] = true;
             }
 
             Box hibox = amrex::adjCellHi(grid_box, idim, ncell);
@@ -271,6 +281,7 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
                 FillHi(idim, sigma[idim], sigma_cumsum[idim],
                       sigma_star[idim],  sigma_star_cumsum[idim],
                       hioverlap, grid_box, fac[idim]);
+                has_damping[idim] = true;
             }
 
             if (!looverlap.ok() && !hioverlap.ok()) {
@@ -305,6 +316,7 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
                 FillLo(idim, sigma[idim], sigma_cumsum[idim],
                       sigma_star[idim],  sigma_star_cumsum[idim],
                       looverlap, grid_box, fac[idim]);
+                has_damping[idim] = true;
             }
 
             const Box& hibox = amrex::adjCellHi(grid_box, idim, ncell);
@@ -313,6 +325,7 @@ SigmaBox::SigmaBox (const Box& box, const BoxArray& grids, const Real* dx, int n
                 FillHi(idim, sigma[idim], sigma_cumsum[idim],
                       sigma_star[idim],  sigma_star_cumsum[idim],
                       hioverlap, grid_box, fac[idim]);
+                has_damping[idim] = true;
             }
 
             if (!looverlap.ok() && !hioverlap.ok()) {
@@ -425,14 +438,60 @@ MultiSigmaBox::ComputePMLFactorsE (const Real* dx, Real dt)
     }
 }
 
+namespace
+{
+    // physical direction (0, 1, 2 for x, y, z) of the direction idim of the grid
+    int CPMLDirection (int idim)
+    {
+#if (AMREX_SPACEDIM == 3)
+        return idim;
+#else
+        return (idim == 0) ? 0 : 2;
+#endif
+    }
+}
+
+CPMLBoxData
+CPMLMemory::BoxData (SigmaBox const& sigbox, int K, bool cell_centered, Real dt) const
+{
+    CPMLBoxData data;
+    for (int p = 0; p < 3; ++p) {
+        data.sigma[p] = nullptr;
+        data.lo[p] = 0;
+    }
+    data.dt = dt;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        const int p = CPMLDirection(idim);
+        const Sigma& sigma = (cell_centered) ? sigbox.sigma_star[idim] : sigbox.sigma[idim];
+        data.sigma[p] = sigma.data();
+        data.lo[p] = sigma.lo();
+        const int ibox = (box_index[idim].empty()) ? -1 : box_index[idim][K];
+        for (int n = 0; n < 2; ++n) {
+            data.psi[(p+1+n)%3][p] = (ibox >= 0) ? psi[idim][n]->array(ibox) : Array4<Real>();
+        }
+    }
+    return data;
+}
+
+void
+CPMLMemory::setVal (Real val)
+{
+    for (auto& psi_dir : psi) {
+        for (auto& psi_comp : psi_dir) {
+            if (psi_comp) psi_comp->setVal(val);
+        }
+    }
+}
+
 PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*grid_dm*/,
           const Geometry* geom, const Geometry* cgeom,
           int ncell, int delta, amrex::IntVect ref_ratio,
           Real dt, int nox_fft, int noy_fft, int noz_fft, bool do_nodal,
           int do_dive_cleaning, int do_moving_window,
-          int /*pml_has_particles*/, int do_pml_in_domain,
+          int /*pml_has_particles*/, int do_pml_in_domain, int pml_type,
           const amrex::IntVect do_pml_Lo, const amrex::IntVect do_pml_Hi)
-    : m_geom(geom),
+    : m_pml_type(pml_type),
+      m_geom(geom),
       m_cgeom(cgeom)
 {
 
@@ -504,8 +563,24 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*g
         ngf = ngFFT;
     }
 
-    // Allocate diagonal components (xx,yy,zz) only with divergence cleaning
-    const int ncomp = (do_dive_cleaning) ? 3 : 2;
+    // Allocate diagonal components (xx,yy,zz) only with divergence cleaning.
+    // The convolutional PML stores the total fields, and its memory variables separately.
+    const bool cpml = (pml_type == PMLType::Convolutional);
+    const int ncomp = (cpml) ? 1 : ((do_dive_cleaning) ? 3 : 2);
+    const int ncomp_b = (cpml) ? 1 : 2;
+
+#ifdef WARPX_MAG_LLG
+    // The LLG solver evolves H in the PML. Without magnetic material in the PML, B = mu0*H
+    // there, so that B is not stored in the PML, and the B field of the regular grid is set
+    // from H (see ExchangeB). The material is checked on the PML boxes of the fine patch,
+    // which cover the same region as those of the coarse patch, each time the PML is built.
+    m_B_from_H = !cpml && WarpX::maxwell_solver_id != MaxwellSolverAlgo::PSATD &&
+        !(WarpX::em_solver_medium == MediumForEM::Macroscopic &&
+          WarpX::GetInstance().m_macroscopic_properties->HasMagneticMaterial(ba, dm, lev));
+    if (m_B_from_H) {
+        amrex::Print() << "PML of level " << lev << ": no magnetic material, B is set from H\n";
+    }
+#endif
 
     pml_E_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
         WarpX::GetInstance().getEfield_fp(0,0).ixType().toIntVect() ), dm, ncomp, nge );
@@ -514,12 +589,14 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*g
     pml_E_fp[2] = std::make_unique<MultiFab>(amrex::convert( ba,
         WarpX::GetInstance().getEfield_fp(0,2).ixType().toIntVect() ), dm, ncomp, nge );
 
-    pml_B_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
-        WarpX::GetInstance().getBfield_fp(0,0).ixType().toIntVect() ), dm, 2, ngb );
-    pml_B_fp[1] = std::make_unique<MultiFab>(amrex::convert( ba,
-        WarpX::GetInstance().getBfield_fp(0,1).ixType().toIntVect() ), dm, 2, ngb );
-    pml_B_fp[2] = std::make_unique<MultiFab>(amrex::convert( ba,
-        WarpX::GetInstance().getBfield_fp(0,2).ixType().toIntVect() ), dm, 2, ngb );
+    if (!m_B_from_H) {
+        pml_B_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
+            WarpX::GetInstance().getBfield_fp(0,0).ixType().toIntVect() ), dm, ncomp_b, ngb );
+        pml_B_fp[1] = std::make_unique<MultiFab>(amrex::convert( ba,
+            WarpX::GetInstance().getBfield_fp(0,1).ixType().toIntVect() ), dm, ncomp_b, ngb );
+        pml_B_fp[2] = std::make_unique<MultiFab>(amrex::convert( ba,
+            WarpX::GetInstance().getBfield_fp(0,2).ixType().toIntVect() ), dm, ncomp_b, ngb );
+    }
 #ifdef WARPX_MAG_LLG
     pml_H_fp[0] = std::make_unique<MultiFab>(amrex::convert( ba,
         WarpX::GetInstance().getHfield_fp(0,0).ixType().toIntVect() ), dm, 2, ngb );
@@ -568,9 +645,11 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*g
     pml_E_fp[0]->setVal(0.0);
     pml_E_fp[1]->setVal(0.0);
     pml_E_fp[2]->setVal(0.0);
-    pml_B_fp[0]->setVal(0.0);
-    pml_B_fp[1]->setVal(0.0);
-    pml_B_fp[2]->setVal(0.0);
+    if (pml_B_fp[0]) {
+        pml_B_fp[0]->setVal(0.0);
+        pml_B_fp[1]->setVal(0.0);
+        pml_B_fp[2]->setVal(0.0);
+    }
 #ifdef WARPX_MAG_LLG
     pml_H_fp[0]->setVal(0.0);
     pml_H_fp[1]->setVal(0.0);
@@ -601,6 +680,11 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*g
         sigba_fp = std::make_unique<MultiSigmaBox>(ba, dm, grid_ba, geom->CellSize(), ncell, delta);
     }
 
+    if (cpml) {
+        DefineCPMLMemory(cpml_E_fp, pml_E_fp, *sigba_fp);
+        DefineCPMLMemory(cpml_B_fp, pml_B_fp, *sigba_fp);
+    }
+
     if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::PSATD) {
 #ifndef WARPX_USE_PSATD
         amrex::ignore_unused(lev, dt);
@@ -663,12 +747,14 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*g
         pml_E_cp[2] = std::make_unique<MultiFab>(amrex::convert( cba,
             WarpX::GetInstance().getEfield_cp(1,2).ixType().toIntVect() ), cdm, ncomp, nge );
 
-        pml_B_cp[0] = std::make_unique<MultiFab>(amrex::convert( cba,
-            WarpX::GetInstance().getBfield_cp(1,0).ixType().toIntVect() ), cdm, 2, ngb );
-        pml_B_cp[1] = std::make_unique<MultiFab>(amrex::convert( cba,
-            WarpX::GetInstance().getBfield_cp(1,1).ixType().toIntVect() ), cdm, 2, ngb );
-        pml_B_cp[2] = std::make_unique<MultiFab>(amrex::convert( cba,
-            WarpX::GetInstance().getBfield_cp(1,2).ixType().toIntVect() ), cdm, 2, ngb );
+        if (!m_B_from_H) {
+            pml_B_cp[0] = std::make_unique<MultiFab>(amrex::convert( cba,
+                WarpX::GetInstance().getBfield_cp(1,0).ixType().toIntVect() ), cdm, ncomp_b, ngb );
+            pml_B_cp[1] = std::make_unique<MultiFab>(amrex::convert( cba,
+                WarpX::GetInstance().getBfield_cp(1,1).ixType().toIntVect() ), cdm, ncomp_b, ngb );
+            pml_B_cp[2] = std::make_unique<MultiFab>(amrex::convert( cba,
+                WarpX::GetInstance().getBfield_cp(1,2).ixType().toIntVect() ), cdm, ncomp_b, ngb );
+        }
 #ifdef WARPX_MAG_LLG
         pml_H_cp[0] = std::make_unique<MultiFab>(amrex::convert( cba,
             WarpX::GetInstance().getHfield_cp(1,0).ixType().toIntVect() ), cdm, 2, ngb );
@@ -719,9 +805,11 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*g
         pml_E_cp[0]->setVal(0.0);
         pml_E_cp[1]->setVal(0.0);
         pml_E_cp[2]->setVal(0.0);
-        pml_B_cp[0]->setVal(0.0);
-        pml_B_cp[1]->setVal(0.0);
-        pml_B_cp[2]->setVal(0.0);
+        if (pml_B_cp[0]) {
+            pml_B_cp[0]->setVal(0.0);
+            pml_B_cp[1]->setVal(0.0);
+            pml_B_cp[2]->setVal(0.0);
+        }
 #ifdef WARPX_MAG_LLG
         pml_H_cp[0]->setVal(0.0);
         pml_H_cp[1]->setVal(0.0);
@@ -753,6 +841,11 @@ PML::PML (const int lev, const BoxArray& grid_ba, const DistributionMapping& /*g
             sigba_cp = std::make_unique<MultiSigmaBox>(cba, cdm, grid_cba, cgeom->CellSize(), ncell, delta);
         }
 
+        if (cpml) {
+            DefineCPMLMemory(cpml_E_cp, pml_E_cp, *sigba_cp);
+            DefineCPMLMemory(cpml_B_cp, pml_B_cp, *sigba_cp);
+        }
+
         if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::PSATD) {
 #ifndef WARPX_USE_PSATD
             amrex::ignore_unused(dt);
@@ -866,6 +959,49 @@ PML::ComputePMLFactors (amrex::Real dt)
     }
 }
 
+void
+PML::DefineCPMLMemory (CPMLMemory& cpml, const std::array<std::unique_ptr<amrex::MultiFab>,3>& field,
+                       const MultiSigmaBox& sigba)
+{
+    const BoxArray& ba = sigba.boxArray();
+    const DistributionMapping& dm = sigba.DistributionMap();
+    const int nboxes = static_cast<int>(ba.size());
+
+    // The sigma of each box is only known by its owner
+    Vector<int> has_damping(AMREX_SPACEDIM*nboxes, 0);
+    for (MFIter mfi(sigba); mfi.isValid(); ++mfi) {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            has_damping[idim*nboxes + mfi.index()] = sigba[mfi].has_damping[idim];
+        }
+    }
+    ParallelDescriptor::ReduceIntMax(has_damping.data(), static_cast<int>(has_damping.size()));
+
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        BoxList bl;
+        Vector<int> pmap;
+        cpml.box_index[idim].assign(nboxes, -1);
+        for (int K = 0; K < nboxes; ++K) {
+            if (has_damping[idim*nboxes + K]) {
+                cpml.box_index[idim][K] = static_cast<int>(pmap.size());
+                bl.push_back(ba[K]);
+                pmap.push_back(dm[K]);
+            }
+        }
+        if (pmap.empty()) continue;
+
+        // The memory variables are only used in the valid cells, in the same process as the PML box
+        const BoxArray psi_ba(std::move(bl));
+        const DistributionMapping psi_dm(std::move(pmap));
+        const int p = CPMLDirection(idim);
+        for (int n = 0; n < 2; ++n) {
+            const int comp = (p+1+n)%3;
+            cpml.psi[idim][n] = std::make_unique<MultiFab>(amrex::convert(psi_ba,
+                field[comp]->ixType().toIntVect()), psi_dm, 1, 0);
+        }
+    }
+    cpml.setVal(0.0);
+}
+
 std::array<MultiFab*,3>
 PML::GetE_fp ()
 {
@@ -981,6 +1117,25 @@ PML::ExchangeB (PatchType patch_type,
                 const std::array<amrex::MultiFab*,3>& Bp,
                 int do_pml_in_domain)
 {
+#ifdef WARPX_MAG_LLG
+    if (m_B_from_H)
+    {
+        // B = mu0*H in the PML, which contains no magnetic material
+        if (patch_type == PatchType::fine && pml_H_fp[0] && Bp[0])
+        {
+            CopyToRegular(*pml_H_fp[0], *Bp[0], *m_geom, do_pml_in_domain, PhysConst::mu0);
+            CopyToRegular(*pml_H_fp[1], *Bp[1], *m_geom, do_pml_in_domain, PhysConst::mu0);
+            CopyToRegular(*pml_H_fp[2], *Bp[2], *m_geom, do_pml_in_domain, PhysConst::mu0);
+        }
+        else if (patch_type == PatchType::coarse && pml_H_cp[0] && Bp[0])
+        {
+            CopyToRegular(*pml_H_cp[0], *Bp[0], *m_cgeom, do_pml_in_domain, PhysConst::mu0);
+            CopyToRegular(*pml_H_cp[1], *Bp[1], *m_cgeom, do_pml_in_domain, PhysConst::mu0);
+            CopyToRegular(*pml_H_cp[2], *Bp[2], *m_cgeom, do_pml_in_domain, PhysConst::mu0);
+        }
+        return;
+    }
+#endif
     if (patch_type == PatchType::fine && pml_B_fp[0] && Bp[0])
     {
         Exchange(*pml_B_fp[0], *Bp[0], *m_geom, do_pml_in_domain);
@@ -1109,29 +1264,65 @@ PML::Exchange (MultiFab& pml, MultiFab& reg, const Geometry& geom,
     const int ncp = pml.nComp();
     const auto& period = geom.periodicity();
 
-    // Create temporary MultiFab to copy to and from the PML
+    CopyToRegular(pml, reg, geom, do_pml_in_domain);
+
+    // Copy from valid cells of the regular grid to guard cells of the PML
+    // (and outermost valid cell in the nodal direction)
+    // More specifically, copy from regular data to PML's first component
+    // Zero out the second (and third) component
     MultiFab tmpregmf(reg.boxArray(), reg.DistributionMap(), ncp, ngr);
+    MultiFab::Copy(tmpregmf,reg,0,0,1,0); // Fill first component of tmpregmf
+    if (ncp > 1) {
+        tmpregmf.setVal(0.0, 1, ncp-1, 0); // Zero out the second (and third) component
+    }
+    if (do_pml_in_domain){
+        // Where valid cells of tmpregmf overlap with PML valid cells,
+        // copy the PML (this is order to avoid overwriting PML valid cells,
+        // in the next `ParallelCopy`)
+        tmpregmf.ParallelCopy(pml,0, 0, ncp, IntVect(0), IntVect(0), period);
+    }
+    pml.ParallelCopy(tmpregmf, 0, 0, ncp, IntVect(0), ngp, period);
+}
+
+void
+PML::CopyToRegular (MultiFab& pml, MultiFab& reg, const Geometry& geom,
+                    int do_pml_in_domain, Real scale)
+{
+    const IntVect& ngr = reg.nGrowVect();
+    const int ncp = pml.nComp();
+    const auto& period = geom.periodicity();
 
     // Create the sum of the split fields, in the PML
-    MultiFab totpmlmf(pml.boxArray(), pml.DistributionMap(), 1, 0); // Allocate
-    MultiFab::LinComb(totpmlmf, 1.0, pml, 0, 1.0, pml, 1, 0, 1, 0); // Sum
-    if (ncp == 3) {
-        MultiFab::Add(totpmlmf,pml,2,0,1,0); // Sum the third split component
+    // (the convolutional PML, with one component, already stores the total field)
+    MultiFab totpmlmf;
+    if (ncp > 1 || scale != 1._rt) {
+        totpmlmf.define(pml.boxArray(), pml.DistributionMap(), 1, 0); // Allocate
+        if (ncp > 1) {
+            MultiFab::LinComb(totpmlmf, scale, pml, 0, scale, pml, 1, 0, 1, 0); // Sum
+        } else {
+            MultiFab::Copy(totpmlmf, pml, 0, 0, 1, 0);
+            totpmlmf.mult(scale, 0, 1, 0);
+        }
+        if (ncp == 3) {
+            MultiFab::Saxpy(totpmlmf, scale, pml, 2, 0, 1, 0); // Sum the third split component
+        }
     }
+    const MultiFab& pmltot = (ncp > 1 || scale != 1._rt) ? totpmlmf : pml;
 
     // Copy from the sum of PML split field to valid cells of regular grid
     if (do_pml_in_domain){
         // Valid cells of the PML and of the regular grid overlap
         // Copy from valid cells of the PML to valid cells of the regular grid
-        reg.ParallelCopy(totpmlmf, 0, 0, 1, IntVect(0), IntVect(0), period);
+        reg.ParallelCopy(pmltot, 0, 0, 1, IntVect(0), IntVect(0), period);
     } else {
         // Valid cells of the PML only overlap with guard cells of regular grid
         // (and outermost valid cell of the regular grid, for nodal direction)
         // Copy from valid cells of PML to ghost cells of regular grid
         // but avoid updating the outermost valid cell
         if (ngr.max() > 0) {
+            MultiFab tmpregmf(reg.boxArray(), reg.DistributionMap(), 1, ngr);
             MultiFab::Copy(tmpregmf, reg, 0, 0, 1, ngr);
-            tmpregmf.ParallelCopy(totpmlmf, 0, 0, 1, IntVect(0), ngr, period);
+            tmpregmf.ParallelCopy(pmltot, 0, 0, 1, IntVect(0), ngr, period);
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
@@ -1153,20 +1344,6 @@ PML::Exchange (MultiFab& pml, MultiFab& reg, const Geometry& geom,
             }
         }
     }
-
-    // Copy from valid cells of the regular grid to guard cells of the PML
-    // (and outermost valid cell in the nodal direction)
-    // More specifically, copy from regular data to PML's first component
-    // Zero out the second (and third) component
-    MultiFab::Copy(tmpregmf,reg,0,0,1,0); // Fill first component of tmpregmf
-    tmpregmf.setVal(0.0, 1, ncp-1, 0); // Zero out the second (and third) component
-    if (do_pml_in_domain){
-        // Where valid cells of tmpregmf overlap with PML valid cells,
-        // copy the PML (this is order to avoid overwriting PML valid cells,
-        // in the next `ParallelCopy`)
-        tmpregmf.ParallelCopy(pml,0, 0, ncp, IntVect(0), IntVect(0), period);
-    }
-    pml.ParallelCopy(tmpregmf, 0, 0, ncp, IntVect(0), ngp, period);
 }
 
 
@@ -1182,9 +1359,44 @@ PML::CopyToPML (MultiFab& pml, MultiFab& reg, const Geometry& geom)
 void
 PML::FillBoundary ()
 {
-    FillBoundaryE();
-    FillBoundaryB();
-    FillBoundaryF();
+    FillBoundary(PatchType::fine);
+    FillBoundary(PatchType::coarse);
+}
+
+void
+PML::FillBoundary (PatchType patch_type)
+{
+    CommStats comm_stats(CommSite::FillBoundaryPML);
+    bool const fine = (patch_type == PatchType::fine);
+    const auto& pml_E = (fine) ? pml_E_fp : pml_E_cp;
+    const auto& pml_B = (fine) ? pml_B_fp : pml_B_cp;
+    const auto& pml_F = (fine) ? pml_F_fp : pml_F_cp;
+#ifdef WARPX_MAG_LLG
+    const auto& pml_H = (fine) ? pml_H_fp : pml_H_cp;
+#endif
+    if (!pml_E[0]) return;
+
+    // Same fields as FillBoundaryE, FillBoundaryB, FillBoundaryF (and FillBoundaryH),
+    // exchanged together to send one message per pair of ranks instead of one per field
+    Vector<MultiFab*> mf;
+    if (pml_E[0]->nGrowVect().max() > 0) {
+        mf.insert(mf.end(), {pml_E[0].get(), pml_E[1].get(), pml_E[2].get()});
+    }
+    if (pml_B[0]) {
+        mf.insert(mf.end(), {pml_B[0].get(), pml_B[1].get(), pml_B[2].get()});
+    }
+#ifdef WARPX_MAG_LLG
+    if (pml_H[0]) {
+        mf.insert(mf.end(), {pml_H[0].get(), pml_H[1].get(), pml_H[2].get()});
+    }
+#endif
+    if (pml_F && pml_F->nGrowVect().max() > 0) {
+        mf.push_back(pml_F.get());
+    }
+
+    const auto& period = (fine) ? m_geom->periodicity() : m_cgeom->periodicity();
+    CommStats::AddFillBoundary(mf, period);
+    amrex::FillBoundary(mf, period);
 }
 
 void
@@ -1197,16 +1409,19 @@ PML::FillBoundaryE ()
 void
 PML::FillBoundaryE (PatchType patch_type)
 {
+    CommStats comm_stats(CommSite::FillBoundaryPML);
     if (patch_type == PatchType::fine && pml_E_fp[0] && pml_E_fp[0]->nGrowVect().max() > 0)
     {
         const auto& period = m_geom->periodicity();
         Vector<MultiFab*> mf{pml_E_fp[0].get(),pml_E_fp[1].get(),pml_E_fp[2].get()};
+        CommStats::AddFillBoundary(mf, period);
         amrex::FillBoundary(mf, period);
     }
     else if (patch_type == PatchType::coarse && pml_E_cp[0] && pml_E_cp[0]->nGrowVect().max() > 0)
     {
         const auto& period = m_cgeom->periodicity();
         Vector<MultiFab*> mf{pml_E_cp[0].get(),pml_E_cp[1].get(),pml_E_cp[2].get()};
+        CommStats::AddFillBoundary(mf, period);
         amrex::FillBoundary(mf, period);
     }
 }
@@ -1221,16 +1436,19 @@ PML::FillBoundaryB ()
 void
 PML::FillBoundaryB (PatchType patch_type)
 {
+    CommStats comm_stats(CommSite::FillBoundaryPML);
     if (patch_type == PatchType::fine && pml_B_fp[0])
     {
         const auto& period = m_geom->periodicity();
         Vector<MultiFab*> mf{pml_B_fp[0].get(),pml_B_fp[1].get(),pml_B_fp[2].get()};
+        CommStats::AddFillBoundary(mf, period);
         amrex::FillBoundary(mf, period);
     }
     else if (patch_type == PatchType::coarse && pml_B_cp[0])
     {
         const auto& period = m_cgeom->periodicity();
         Vector<MultiFab*> mf{pml_B_cp[0].get(),pml_B_cp[1].get(),pml_B_cp[2].get()};
+        CommStats::AddFillBoundary(mf, period);
         amrex::FillBoundary(mf, period);
     }
 }
@@ -1246,16 +1464,19 @@ PML::FillBoundaryH ()
 void
 PML::FillBoundaryH (PatchType patch_type)
 {
+    CommStats comm_stats(CommSite::FillBoundaryPML);
     if (patch_type == PatchType::fine && pml_H_fp[0])
     {
         const auto& period = m_geom->periodicity();
         Vector<MultiFab*> mf{pml_H_fp[0].get(),pml_H_fp[1].get(),pml_H_fp[2].get()};
+        CommStats::AddFillBoundary(mf, period);
         amrex::FillBoundary(mf, period);
     }
     else if (patch_type == PatchType::coarse && pml_H_cp[0])
     {
         const auto& period = m_cgeom->periodicity();
         Vector<MultiFab*> mf{pml_H_cp[0].get(),pml_H_cp[1].get(),pml_H_cp[2].get()};
+        CommStats::AddFillBoundary(mf, period);
         amrex::FillBoundary(mf, period);
     }
 }
@@ -1271,18 +1492,46 @@ PML::FillBoundaryF ()
 void
 PML::FillBoundaryF (PatchType patch_type)
 {
+    CommStats comm_stats(CommSite::FillBoundaryPML);
     if (patch_type == PatchType::fine && pml_F_fp && pml_F_fp->nGrowVect().max() > 0)
     {
         const auto& period = m_geom->periodicity();
+        CommStats::AddFillBoundary(*pml_F_fp, pml_F_fp->nComp(), pml_F_fp->nGrowVect(), period);
         pml_F_fp->FillBoundary(period);
     }
     else if (patch_type == PatchType::coarse && pml_F_cp && pml_F_cp->nGrowVect().max() > 0)
     {
         const auto& period = m_cgeom->periodicity();
+        CommStats::AddFillBoundary(*pml_F_cp, pml_F_cp->nComp(), pml_F_cp->nGrowVect(), period);
         pml_F_cp->FillBoundary(period);
     }
 }
 
+namespace
+{
+    void CheckPointCPML (const CPMLMemory& cpml, const std::string& name)
+    {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            for (int n = 0; n < 2; ++n) {
+                if (cpml.psi[idim][n]) {
+                    VisMF::AsyncWrite(*cpml.psi[idim][n], name+std::to_string(idim)+std::to_string(n));
+                }
+            }
+        }
+    }
+
+    void RestartCPML (CPMLMemory& cpml, const std::string& name)
+    {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            for (int n = 0; n < 2; ++n) {
+                if (cpml.psi[idim][n]) {
+                    VisMF::Read(*cpml.psi[idim][n], name+std::to_string(idim)+std::to_string(n));
+                }
+            }
+        }
+    }
+}
+
 void
 PML::CheckPoint (const std::string& dir) const
 {
@@ -1291,9 +1540,13 @@ PML::CheckPoint (const std::string& dir) const
         VisMF::AsyncWrite(*pml_E_fp[0], dir+"_Ex_fp");
         VisMF::AsyncWrite(*pml_E_fp[1], dir+"_Ey_fp");
         VisMF::AsyncWrite(*pml_E_fp[2], dir+"_Ez_fp");
-        VisMF::AsyncWrite(*pml_B_fp[0], dir+"_Bx_fp");
-        VisMF::AsyncWrite(*pml_B_fp[1], dir+"_By_fp");
-        VisMF::AsyncWrite(*pml_B_fp[2], dir+"_Bz_fp");
+        if (pml_B_fp[0]) {
+            VisMF::AsyncWrite(*pml_B_fp[0], dir+"_Bx_fp");
+            VisMF::AsyncWrite(*pml_B_fp[1], dir+"_By_fp");
+            VisMF::AsyncWrite(*pml_B_fp[2], dir+"_Bz_fp");
+        }
+        CheckPointCPML(cpml_E_fp, dir+"_psiE_fp");
+        CheckPointCPML(cpml_B_fp, dir+"_psiB_fp");
 #ifdef WARPX_MAG_LLG
         VisMF::AsyncWrite(*pml_H_fp[0], dir+"_Hx_fp");
         VisMF::AsyncWrite(*pml_H_fp[1], dir+"_Hy_fp");
@@ -1306,9 +1559,13 @@ PML::CheckPoint (const std::string& dir) const
         VisMF::AsyncWrite(*pml_E_cp[0], dir+"_Ex_cp");
         VisMF::AsyncWrite(*pml_E_cp[1], dir+"_Ey_cp");
         VisMF::AsyncWrite(*pml_E_cp[2], dir+"_Ez_cp");
-        VisMF::AsyncWrite(*pml_B_cp[0], dir+"_Bx_cp");
-        VisMF::AsyncWrite(*pml_B_cp[1], dir+"_By_cp");
-        VisMF::AsyncWrite(*pml_B_cp[2], dir+"_Bz_cp");
+        if (pml_B_cp[0]) {
+            VisMF::AsyncWrite(*pml_B_cp[0], dir+"_Bx_cp");
+            VisMF::AsyncWrite(*pml_B_cp[1], dir+"_By_cp");
+            VisMF::AsyncWrite(*pml_B_cp[2], dir+"_Bz_cp");
+        }
+        CheckPointCPML(cpml_E_cp, dir+"_psiE_cp");
+        CheckPointCPML(cpml_B_cp, dir+"_psiB_cp");
 #ifdef WARPX_MAG_LLG
         VisMF::AsyncWrite(*pml_H_cp[0], dir+"_Hx_cp");
         VisMF::AsyncWrite(*pml_H_cp[1], dir+"_Hy_cp");
@@ -1325,9 +1582,13 @@ PML::Restart (const std::string& dir)
         VisMF::Read(*pml_E_fp[0], dir+"_Ex_fp");
         VisMF::Read(*pml_E_fp[1], dir+"_Ey_fp");
         VisMF::Read(*pml_E_fp[2], dir+"_Ez_fp");
-        VisMF::Read(*pml_B_fp[0], dir+"_Bx_fp");
-        VisMF::Read(*pml_B_fp[1], dir+"_By_fp");
-        VisMF::Read(*pml_B_fp[2], dir+"_Bz_fp");
+        if (pml_B_fp[0]) {
+            VisMF::Read(*pml_B_fp[0], dir+"_Bx_fp");
+            VisMF::Read(*pml_B_fp[1], dir+"_By_fp");
+            VisMF::Read(*pml_B_fp[2], dir+"_Bz_fp");
+        }
+        RestartCPML(cpml_E_fp, dir+"_psiE_fp");
+        RestartCPML(cpml_B_fp, dir+"_psiB_fp");
 #ifdef WARPX_MAG_LLG
         VisMF::Read(*pml_H_fp[0], dir+"_Hx_fp");
         VisMF::Read(*pml_H_fp[1], dir+"_Hy_fp");
@@ -1340,9 +1601,13 @@ PML::Restart (const std::string& dir)
         VisMF::Read(*pml_E_cp[0], dir+"_Ex_cp");
         VisMF::Read(*pml_E_cp[1], dir+"_Ey_cp");
         VisMF::Read(*pml_E_cp[2], dir+"_Ez_cp");
-        VisMF::Read(*pml_B_cp[0], dir+"_Bx_cp");
-        VisMF::Read(*pml_B_cp[1], dir+"_By_cp");
-        VisMF::Read(*pml_B_cp[2], dir+"_Bz_cp");
+        if (pml_B_cp[0]) {
+            VisMF::Read(*pml_B_cp[0], dir+"_Bx_cp");
+            VisMF::Read(*pml_B_cp[1], dir+"_By_cp");
+            VisMF::Read(*pml_B_cp[2], dir+"_Bz_cp");
+        }
+        RestartCPML(cpml_E_cp, dir+"_psiE_cp");
+        RestartCPML(cpml_B_cp, dir+"_psiB_cp");
 #ifdef WARPX_MAG_LLG
         VisMF::Read(*pml_H_cp[0], dir+"_Hx_cp");
         VisMF::Read(*pml_H_cp[1], dir+"_Hy_cp");
@@ -1351,6 +1616,36 @@ PML::Restart (const std::string& dir)
     }
 }
 
+amrex::Long
+PML::MemoryBytes () const
+{
+    using WarpXUtilMemory::FabArrayBytes;
+    amrex::Long nbytes = 0;
+    for (int i = 0; i < 3; ++i) {
+        nbytes += FabArrayBytes(pml_E_fp[i].get()) + FabArrayBytes(pml_B_fp[i].get())
+                + FabArrayBytes(pml_j_fp[i].get()) + FabArrayBytes(pml_E_cp[i].get())
+                + FabArrayBytes(pml_B_cp[i].get()) + FabArrayBytes(pml_j_cp[i].get());
+#ifdef WARPX_MAG_LLG
+        nbytes += FabArrayBytes(pml_H_fp[i].get()) + FabArrayBytes(pml_H_cp[i].get());
+#endif
+    }
+    for (auto const* mf : {pml_F_fp.get(), pml_F_cp.get(),
+                           pml_eps_fp.get(), pml_mu_fp.get(), pml_sigma_fp.get(),
+                           pml_eps_cp.get(), pml_mu_cp.get(), pml_sigma_cp.get()}) {
+        nbytes += FabArrayBytes(mf);
+    }
+    for (auto const* cpml : {&cpml_E_fp, &cpml_B_fp, &cpml_E_cp, &cpml_B_cp}) {
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            nbytes += FabArrayBytes(cpml->psi[idim][0].get()) + FabArrayBytes(cpml->psi[idim][1].get());
+        }
+    }
+#ifdef WARPX_USE_PSATD
+    if (spectral_solver_fp) nbytes += spectral_solver_fp->MemoryBytes();
+    if (spectral_solver_cp) nbytes += spectral_solver_cp->MemoryBytes();
+#endif
+    return nbytes;
+}
+
 #ifdef WARPX_USE_PSATD
 void
 PML::PushPSATD (const int lev) {
@@ -1376,32 +1671,36 @@ PushPMLPSATDSinglePatch (
     // (Exy, Ezx, etc.) and the component (PMLComp::xy, PMComp::zx, etc.)
     // of the MultiFabs (e.g. pml_E) is dictated by the
     // function that damps the PML
-    solver.ForwardTransform(lev, *pml_E[0], SpIdx::Exy, PMLComp::xy);
-    solver.ForwardTransform(lev, *pml_E[0], SpIdx::Exz, PMLComp::xz);
-    solver.ForwardTransform(lev, *pml_E[1], SpIdx::Eyz, PMLComp::yz);
-    solver.ForwardTransform(lev, *pml_E[1], SpIdx::Eyx, PMLComp::yx);
-    solver.ForwardTransform(lev, *pml_E[2], SpIdx::Ezx, PMLComp::zx);
-    solver.ForwardTransform(lev, *pml_E[2], SpIdx::Ezy, PMLComp::zy);
-    solver.ForwardTransform(lev, *pml_B[0], SpIdx::Bxy, PMLComp::xy);
-    solver.ForwardTransform(lev, *pml_B[0], SpIdx::Bxz, PMLComp::xz);
-    solver.ForwardTransform(lev, *pml_B[1], SpIdx::Byz, PMLComp::yz);
-    solver.ForwardTransform(lev, *pml_B[1], SpIdx::Byx, PMLComp::yx);
-    solver.ForwardTransform(lev, *pml_B[2], SpIdx::Bzx, PMLComp::zx);
-    solver.ForwardTransform(lev, *pml_B[2], SpIdx::Bzy, PMLComp::zy);
+    // All the components are transformed together, in batches
+    // of at most WarpX::fft_max_batch_size components
+    const std::array<std::array<int,2>,3> pml_comps {{
+        {{PMLComp::xy, PMLComp::xz}}, {{PMLComp::yz, PMLComp::yx}}, {{PMLComp::zx, PMLComp::zy}} }};
+    const std::array<std::array<int,2>,3> E_idx {{
+        {{SpIdx::Exy, SpIdx::Exz}}, {{SpIdx::Eyz, SpIdx::Eyx}}, {{SpIdx::Ezx, SpIdx::Ezy}} }};
+    const std::array<std::array<int,2>,3> B_idx {{
+        {{SpIdx::Bxy, SpIdx::Bxz}}, {{SpIdx::Byz, SpIdx::Byx}}, {{SpIdx::Bzx, SpIdx::Bzy}} }};
+
+    std::vector<SpectralForwardComponent> forward_comps;
+    std::vector<SpectralBackwardComponent> backward_comps;
+    for (int idim = 0; idim < 3; ++idim) {
+        for (int n = 0; n < 2; ++n) {
+            forward_comps.push_back({pml_E[idim].get(), E_idx[idim][n], pml_comps[idim][n],
+                                     pml_E[idim]->ixType().toIntVect()});
+            backward_comps.push_back({pml_E[idim].get(), E_idx[idim][n], pml_comps[idim][n]});
+        }
+    }
+    for (int idim = 0; idim < 3; ++idim) {
+        for (int n = 0; n < 2; ++n) {
+            forward_comps.push_back({pml_B[idim].get(), B_idx[idim][n], pml_comps[idim][n],
+                                     pml_B[idim]->ixType().toIntVect()});
+            backward_comps.push_back({pml_B[idim].get(), B_idx[idim][n], pml_comps[idim][n]});
+        }
+    }
+
+    solver.ForwardTransform(lev, forward_comps);
     // Advance fields in spectral space
     solver.pushSpectralFields();
     // Perform backward Fourier Transform
-    solver.BackwardTransform(lev, *pml_E[0], SpIdx::Exy, PMLComp::xy);
-    solver.BackwardTransform(lev, *pml_E[0], SpIdx::Exz, PMLComp::xz);
-    solver.BackwardTransform(lev, *pml_E[1], SpIdx::Eyz, PMLComp::yz);
-    solver.BackwardTransform(lev, *pml_E[1], SpIdx::Eyx, PMLComp::yx);
-    solver.BackwardTransform(lev, *pml_E[2], SpIdx::Ezx, PMLComp::zx);
-    solver.BackwardTransform(lev, *pml_E[2], SpIdx::Ezy, PMLComp::zy);
-    solver.BackwardTransform(lev, *pml_B[0], SpIdx::Bxy, PMLComp::xy);
-    solver.BackwardTransform(lev, *pml_B[0], SpIdx::Bxz, PMLComp::xz);
-    solver.BackwardTransform(lev, *pml_B[1], SpIdx::Byz, PMLComp::yz);
-    solver.BackwardTransform(lev, *pml_B[1], SpIdx::Byx, PMLComp::yx);
-    solver.BackwardTransform(lev, *pml_B[2], SpIdx::Bzx, PMLComp::zx);
-    solver.BackwardTransform(lev, *pml_B[2], SpIdx::Bzy, PMLComp::zy);
+    solver.BackwardTransform(lev, backward_comps);
 }
 #endif
@@ -40,6 +40,8 @@ void
 WarpX::DampPML (int lev, PatchType patch_type)
 {
     if (!do_pml) return;
+    // the convolutional PML is damped in the field updates, through its memory variables
+    if (pml_type == PMLType::Convolutional) return;
 
     WARPX_PROFILE("WarpX::DampPML()");
 
@@ -60,14 +62,15 @@ WarpX::DampPML (int lev, PatchType patch_type)
         const amrex::IntVect Ey_stag = pml_E[1]->ixType().toIntVect();
         const amrex::IntVect Ez_stag = pml_E[2]->ixType().toIntVect();
 
+#ifndef WARPX_MAG_LLG
         const amrex::IntVect Bx_stag = pml_B[0]->ixType().toIntVect();
         const amrex::IntVect By_stag = pml_B[1]->ixType().toIntVect();
         const amrex::IntVect Bz_stag = pml_B[2]->ixType().toIntVect();
-
-#if WARPX_MAG_LLG
-        const amrex::IntVect Hx_stag = pml_H[0]->ixType().toIntVect();
-        const amrex::IntVect Hy_stag = pml_H[1]->ixType().toIntVect();
-        const amrex::IntVect Hz_stag = pml_H[2]->ixType().toIntVect();
+#else
+        // with LLG, H is damped in place of B
+        const amrex::IntVect Bx_stag = pml_H[0]->ixType().toIntVect();
+        const amrex::IntVect By_stag = pml_H[1]->ixType().toIntVect();
+        const amrex::IntVect Bz_stag = pml_H[2]->ixType().toIntVect();
 #endif
         amrex::IntVect F_stag;
         if (pml_F) {
@@ -82,9 +85,9 @@ WarpX::DampPML (int lev, PatchType patch_type)
             const Box& tex  = mfi.tilebox( pml_E[0]->ixType().toIntVect() );
             const Box& tey  = mfi.tilebox( pml_E[1]->ixType().toIntVect() );
             const Box& tez  = mfi.tilebox( pml_E[2]->ixType().toIntVect() );
-            const Box& tbx  = mfi.tilebox( pml_B[0]->ixType().toIntVect() );
-            const Box& tby  = mfi.tilebox( pml_B[1]->ixType().toIntVect() );
-            const Box& tbz  = mfi.tilebox( pml_B[2]->ixType().toIntVect() );
+            const Box& tbx  = mfi.tilebox( Bx_stag );
+            const Box& tby  = mfi.tilebox( By_stag );
+            const Box& tbz  = mfi.tilebox( Bz_stag );
 
             auto const& pml_Exfab = pml_E[0]->array(mfi);
             auto const& pml_Eyfab = pml_E[1]->array(mfi);
@@ -94,9 +97,9 @@ WarpX::DampPML (int lev, PatchType patch_type)
             auto const& pml_Byfab = pml_B[1]->array(mfi);
             auto const& pml_Bzfab = pml_B[2]->array(mfi);
 #else
-            auto const& pml_Hxfab = pml_H[0]->array(mfi);
-            auto const& pml_Hyfab = pml_H[1]->array(mfi);
-            auto const& pml_Hzfab = pml_H[2]->array(mfi);
+            auto const& pml_Bxfab = pml_H[0]->array(mfi);
+            auto const& pml_Byfab = pml_H[1]->array(mfi);
+            auto const& pml_Bzfab = pml_H[2]->array(mfi);
 #endif
             amrex::Real const * AMREX_RESTRICT sigma_fac_x = sigba[mfi].sigma_fac[0].data();
 #if (AMREX_SPACEDIM == 3)
@@ -123,67 +126,50 @@ WarpX::DampPML (int lev, PatchType patch_type)
             int const z_lo = sigba[mfi].sigma_fac[1].lo();
 #endif
 
-            amrex::ParallelFor(tex, tey, tez,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_ex(i, j, k, pml_Exfab, Ex_stag, sigma_fac_x, sigma_fac_y, sigma_fac_z,
-                                  sigma_star_fac_x, sigma_star_fac_y, sigma_star_fac_z, x_lo, y_lo, z_lo,
-                                  dive_cleaning);
-            },
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_ey(i, j, k, pml_Eyfab, Ey_stag, sigma_fac_x, sigma_fac_y, sigma_fac_z,
-                                  sigma_star_fac_x, sigma_star_fac_y, sigma_star_fac_z, x_lo, y_lo, z_lo,
-                                  dive_cleaning);
-            },
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_ez(i, j, k, pml_Ezfab, Ez_stag, sigma_fac_x, sigma_fac_y, sigma_fac_z,
-                                  sigma_star_fac_x, sigma_star_fac_y, sigma_star_fac_z, x_lo, y_lo, z_lo,
-                                  dive_cleaning);
-            });
+            bool const damp_F = (pml_F != nullptr);
+            amrex::Array4<amrex::Real> pml_F_fab;
+            if (damp_F) pml_F_fab = pml_F->array(mfi);
 
-#ifndef WARPX_MAG_LLG
-            amrex::ParallelFor(tbx, tby, tbz,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_bx(i, j, k, pml_Bxfab, Bx_stag, sigma_fac_y, sigma_fac_z,
-                                  sigma_star_fac_y, sigma_star_fac_z, y_lo, z_lo);
-            },
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_by(i, j, k, pml_Byfab, By_stag, sigma_fac_x, sigma_fac_z,
-                                  sigma_star_fac_x, sigma_star_fac_z, x_lo, z_lo);
-            },
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_bz(i, j, k, pml_Bzfab, Bz_stag, sigma_fac_x, sigma_fac_y,
-                                  sigma_star_fac_x, sigma_star_fac_y, x_lo, y_lo);
-            });
-#else
-            amrex::ParallelFor(tbx, tby, tbz,
+            // All the fields of the tile are damped in a single kernel, over the nodal tilebox,
+            // which contains the tileboxes of all the components, to reduce the number of launches
+            // on the many small PML boxes. For F, mfi.nodaltilebox is used, as before (F is only
+            // multiplied by the damping factors, so that the staggering of its box does not matter).
+            const Box& tnd = mfi.nodaltilebox();
+            amrex::ParallelFor(tnd,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_bx(i, j, k, pml_Hxfab, Hx_stag, sigma_fac_y, sigma_fac_z,
-                                  sigma_star_fac_y, sigma_star_fac_z, y_lo, z_lo);
-            },
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_by(i, j, k, pml_Hyfab, Hy_stag, sigma_fac_x, sigma_fac_z,
-                                  sigma_star_fac_x, sigma_star_fac_z, x_lo, z_lo);
-            },
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                warpx_damp_pml_bz(i, j, k, pml_Hzfab, Hz_stag, sigma_fac_x, sigma_fac_y,
-                                  sigma_star_fac_x, sigma_star_fac_y, x_lo, y_lo);
-            });
-#endif
-
-            // For warpx_damp_pml_F(), mfi.nodaltilebox is used in the ParallelFor loop and here we
-            // use mfi.tilebox. However, it does not matter because in damp_pml, where nodaltilebox
-            // is used, only a simple multiplication is performed.
-            if (pml_F) {
-                const Box& tnd = mfi.nodaltilebox();
-                auto const& pml_F_fab = pml_F->array(mfi);
-                amrex::ParallelFor(tnd,
-                [=] AMREX_GPU_DEVICE (int i, int j, int k)
-                {
+                amrex::IntVect const iv(AMREX_D_DECL(i, j, k));
+                if (tex.contains(iv)) {
+                    warpx_damp_pml_ex(i, j, k, pml_Exfab, Ex_stag, sigma_fac_x, sigma_fac_y, sigma_fac_z,
+                                      sigma_star_fac_x, sigma_star_fac_y, sigma_star_fac_z, x_lo, y_lo, z_lo,
+                                      dive_cleaning);
+                }
+                if (tey.contains(iv)) {
+                    warpx_damp_pml_ey(i, j, k, pml_Eyfab, Ey_stag, sigma_fac_x, sigma_fac_y, sigma_fac_z,
+                                      sigma_star_fac_x, sigma_star_fac_y, sigma_star_fac_z, x_lo, y_lo, z_lo,
+                                      dive_cleaning);
+                }
+                if (tez.contains(iv)) {
+                    warpx_damp_pml_ez(i, j, k, pml_Ezfab, Ez_stag, sigma_fac_x, sigma_fac_y, sigma_fac_z,
+                                      sigma_star_fac_x, sigma_star_fac_y, sigma_star_fac_z, x_lo, y_lo, z_lo,
+                                      dive_cleaning);
+                }
+                if (tbx.contains(iv)) {
+                    warpx_damp_pml_bx(i, j, k, pml_Bxfab, Bx_stag, sigma_fac_y, sigma_fac_z,
+                                      sigma_star_fac_y, sigma_star_fac_z, y_lo, z_lo);
+                }
+                if (tby.contains(iv)) {
+                    warpx_damp_pml_by(i, j, k, pml_Byfab, By_stag, sigma_fac_x, sigma_fac_z,
+                                      sigma_star_fac_x, sigma_star_fac_z, x_lo, z_lo);
+                }
+                if (tbz.contains(iv)) {
+                    warpx_damp_pml_bz(i, j, k, pml_Bzfab, Bz_stag, sigma_fac_x, sigma_fac_y,
+                                      sigma_star_fac_x, sigma_star_fac_y, x_lo, y_lo);
+                }
+                if (damp_F) {
                     warpx_damp_pml_F(i, j, k, pml_F_fab, F_stag, sigma_fac_x, sigma_fac_y, sigma_fac_z,
                                      sigma_star_fac_x, sigma_star_fac_y, sigma_star_fac_z, x_lo, y_lo, z_lo);
-                });
-
-            }
+                }
+            });
         }
     }
 }
@@ -343,40 +343,47 @@ namespace
     }
 
     /*
-      Write the only component in the multifab to the dataset given by field_name.
+      Write all the components of the multifab to the datasets given by field_paths.
+      The file is opened once, and each fab is copied to the host once.
       Uses hdf5-parallel.
     */
-    void output_write_field(const std::string& file_path,
-                            const std::string& field_path,
-                            const MultiFab& mf, const int comp,
-                            const int lo_x, const int lo_y, const int lo_z)
+    void output_write_fields(const std::string& file_path,
+                             const std::vector<std::string>& field_paths,
+                             const MultiFab& mf,
+                             const int lo_x, const int lo_y, const int lo_z)
     {
 
-        WARPX_PROFILE("output_write_field");
+        WARPX_PROFILE("output_write_fields");
 
         MPI_Comm comm = MPI_COMM_WORLD;
         MPI_Info info = MPI_INFO_NULL;
         int mpi_rank;
         MPI_Comm_rank(comm, &mpi_rank);
 
+        const int ncomp = mf.nComp();
+
         // Create the file access prop list.
         hid_t pa_plist = H5Pcreate(H5P_FILE_ACCESS);
         H5Pset_fapl_mpio(pa_plist, comm, info);
 
         // Open the file, and the group.
         hid_t file = H5Fopen(file_path.c_str(), H5F_ACC_RDWR, pa_plist);
-        // Open the field dataset.
-        hid_t dataset = H5Dopen(file, field_path.c_str(), H5P_DEFAULT);
 
-        // Make sure the dataset is there.
-        if (dataset < 0)
+        // Open the field datasets, and grab their dataspaces from file.
+        std::vector<hid_t> datasets(ncomp);
+        std::vector<hid_t> file_dataspaces(ncomp);
+        for (int comp = 0; comp < ncomp; ++comp)
         {
-            amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
-                         ". Count not find dataset " + field_path + "\n");
-        }
+            datasets[comp] = H5Dopen(file, field_paths[comp].c_str(), H5P_DEFAULT);
 
-        // Grab the dataspace of the field dataset from file.
-        hid_t file_dataspace = H5Dget_space(dataset);
+            // Make sure the dataset is there.
+            if (datasets[comp] < 0)
+            {
+                amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
+                             ". Count not find dataset " + field_paths[comp] + "\n");
+            }
+            file_dataspaces[comp] = H5Dget_space(datasets[comp]);
+        }
 
         // Create collective io prop list.
         hid_t collective_plist = H5Pcreate(H5P_DATASET_XFER);
@@ -399,8 +406,6 @@ namespace
 #endif
         hid_t slab_dataspace;
 
-        int write_count = 0;
-
         std::vector<Real> transposed_data;
 
         for (MFIter mfi(mf); mfi.isValid(); ++mfi)
@@ -409,6 +414,11 @@ namespace
             const int *lo_vec = box.loVect();
             const int *hi_vec = box.hiVect();
 
+            // Copy all the components of the fab to the host at once
+            FArrayBox host_fab(box, ncomp, The_Pinned_Arena());
+            host_fab.copy<RunOn::Device>(mf[mfi], box, 0, box, 0, ncomp);
+            Gpu::streamSynchronize();
+
             transposed_data.resize(box.numPts(), 0.0);
 
             // Set slab offset and shape.
@@ -420,44 +430,49 @@ namespace
                 slab_dims[idim] = hi_vec[idim] - lo_vec[idim] + 1;
             }
 
-            int cnt = 0;
-            AMREX_D_TERM(
-                         for (int i = lo_vec[0]; i <= hi_vec[0]; ++i),
-                         for (int j = lo_vec[1]; j <= hi_vec[1]; ++j),
-                         for (int k = lo_vec[2]; k <= hi_vec[2]; ++k))
-                transposed_data[cnt++] = mf[mfi](IntVect(AMREX_D_DECL(i, j, k)), comp);
-
             // Create the slab space.
             slab_dataspace = H5Screate_simple(AMREX_SPACEDIM, slab_dims, NULL);
 
-            // Select the hyperslab matching this fab.
-            status = H5Sselect_hyperslab(file_dataspace, H5S_SELECT_SET,
-                                         slab_offsets, NULL, slab_dims, NULL);
-            if (status < 0)
+            for (int comp = 0; comp < ncomp; ++comp)
             {
-                amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
-                             " could not select hyperslab.\n");
-            }
+                int cnt = 0;
+                AMREX_D_TERM(
+                             for (int i = lo_vec[0]; i <= hi_vec[0]; ++i),
+                             for (int j = lo_vec[1]; j <= hi_vec[1]; ++j),
+                             for (int k = lo_vec[2]; k <= hi_vec[2]; ++k))
+                    transposed_data[cnt++] = host_fab(IntVect(AMREX_D_DECL(i, j, k)), comp);
+
+                // Select the hyperslab matching this fab.
+                status = H5Sselect_hyperslab(file_dataspaces[comp], H5S_SELECT_SET,
+                                             slab_offsets, NULL, slab_dims, NULL);
+                if (status < 0)
+                {
+                    amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
+                                 " could not select hyperslab.\n");
+                }
 
-            // Write this pencil.
-            status = H5Dwrite(dataset, H5T_NATIVE_DOUBLE, slab_dataspace,
-                              file_dataspace, collective_plist, transposed_data.data());
-            if (status < 0)
-            {
-                amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
-                             " could not write hyperslab.\n");
+                // Write this pencil.
+                status = H5Dwrite(datasets[comp], H5T_NATIVE_DOUBLE, slab_dataspace,
+                                  file_dataspaces[comp], collective_plist, transposed_data.data());
+                if (status < 0)
+                {
+                    amrex::Abort("Error on rank " + std::to_string(mpi_rank) +
+                                 " could not write hyperslab.\n");
+                }
             }
 
             H5Sclose(slab_dataspace);
-            write_count++;
         }
 
         ParallelDescriptor::Barrier();
 
         // Close HDF5 resources.
         H5Pclose(collective_plist);
-        H5Sclose(file_dataspace);
-        H5Dclose(dataset);
+        for (int comp = 0; comp < ncomp; ++comp)
+        {
+            H5Sclose(file_dataspaces[comp]);
+            H5Dclose(datasets[comp]);
+        }
         H5Fclose(file);
         H5Pclose(pa_plist);
     }
@@ -583,6 +598,10 @@ BackTransformedDiagnostic(Real zmin_lab, Real zmax_lab, Real v_window_lab,
             map_actual_fields_to_dump[i] = m_possible_fields_to_dump[fieldstr];
         }
     }
+    m_d_map_actual_fields_to_dump.resize(map_actual_fields_to_dump.size());
+    Gpu::copy(Gpu::hostToDevice,
+              map_actual_fields_to_dump.begin(), map_actual_fields_to_dump.end(),
+              m_d_map_actual_fields_to_dump.begin());
 
     // allocating array with total number of lab frame diags (snapshots+slices)
     m_LabFrameDiags_.resize(N_snapshots+N_slice_snapshots);
@@ -727,12 +746,10 @@ void BackTransformedDiagnostic::Flush(const Geometry& /*geom*/)
                 tmp.copy(*lf_diags->m_data_buffer_, 0, 0, ncomp);
 
 #ifdef WARPX_USE_HDF5
-                for (int comp = 0; comp < ncomp; ++comp) {
-                    output_write_field(lf_diags->m_file_name,
-                                       m_mesh_field_names[comp], tmp, comp,
-                                       lbound(buff_box).x, lbound(buff_box).y,
-                                       lbound(buff_box).z);
-                }
+                output_write_fields(lf_diags->m_file_name,
+                                    m_mesh_field_names, tmp,
+                                    lbound(buff_box).x, lbound(buff_box).y,
+                                    lbound(buff_box).z);
 #else
                 std::stringstream ss;
                 ss << lf_diags->m_file_name << "/Level_0/"
@@ -792,7 +809,7 @@ writeLabFrameData(const MultiFab* cell_centered_data,
     Real prev_t_lab = -dt;
     std::unique_ptr<amrex::MultiFab> tmp_slice_ptr;
     std::unique_ptr<amrex::MultiFab> slice;
-    amrex::Vector<WarpXParticleContainer::DiagnosticParticleData> tmp_particle_buffer;
+    amrex::Vector<WarpXParticleContainer::DiagnosticParticleData>& tmp_particle_buffer = m_tmp_particle_buffer_;
 
     // Loop over snapshots
     for (auto& lf_diags : m_LabFrameDiags_) {
@@ -879,19 +896,16 @@ writeLabFrameData(const MultiFab* cell_centered_data,
              // data_buffer that stores the back-transformed data.
              tmp_slice_ptr->copy(*slice, 0, 0, ncomp);
              lf_diags->AddDataToBuffer(*tmp_slice_ptr, i_lab,
-                                               map_actual_fields_to_dump);
+                                               m_d_map_actual_fields_to_dump);
              tmp_slice_ptr = nullptr;
         }
 
         if (WarpX::do_back_transformed_particles) {
 
             if (lf_diags->m_t_lab != prev_t_lab ) {
-               if (tmp_particle_buffer.size()>0)
-               {
-                  tmp_particle_buffer.clear();
-                  tmp_particle_buffer.shrink_to_fit();
-               }
+               // the particles of the previous slice are discarded, but not the memory
                tmp_particle_buffer.resize(mypc.nSpeciesBackTransformedDiagnostics());
+               for (auto& species_buffer : tmp_particle_buffer) species_buffer.resize(0);
                mypc.GetLabFrameData(lf_diags->m_file_name, i_lab,
                                     m_boost_direction_, old_z_boost,
                                     lf_diags->m_current_z_boost,
@@ -911,12 +925,11 @@ writeLabFrameData(const MultiFab* cell_centered_data,
 #ifdef WARPX_USE_HDF5
 
                 Box buff_box = lf_diags->m_buff_box_;
-                for (int comp = 0; comp < lf_diags->m_data_buffer_->nComp(); ++comp)
-                    output_write_field(lf_diags->m_file_name,
-                                       m_mesh_field_names[comp],
-                                       *lf_diags->m_data_buffer_, comp,
-                                       lbound(buff_box).x, lbound(buff_box).y,
-                                       lbound(buff_box).z);
+                output_write_fields(lf_diags->m_file_name,
+                                    m_mesh_field_names,
+                                    *lf_diags->m_data_buffer_,
+                                    lbound(buff_box).x, lbound(buff_box).y,
+                                    lbound(buff_box).z);
 #else
                 std::stringstream mesh_ss;
                 mesh_ss << lf_diags->m_file_name << "/Level_0/" <<
@@ -1319,20 +1332,11 @@ LabFrameSlice(Real t_lab_in, Real t_boost, Real inv_gamma_boost_in,
 void
 LabFrameSnapShot::
 AddDataToBuffer( MultiFab& tmp, int k_lab,
-                 amrex::Vector<int> const& map_actual_fields_to_dump)
+                 amrex::Gpu::DeviceVector<int> const& map_actual_fields_to_dump)
 {
     const int ncomp_to_dump = map_actual_fields_to_dump.size();
     MultiFab& buf = *m_data_buffer_;
-#ifdef AMREX_USE_GPU
-    Gpu::DeviceVector<int> d_map_actual_fields_to_dump(ncomp_to_dump);
-    Gpu::copyAsync(Gpu::hostToDevice,
-                   map_actual_fields_to_dump.begin(), map_actual_fields_to_dump.end(),
-                   d_map_actual_fields_to_dump.begin());
-    Gpu::synchronize();
-    int const* field_map_ptr = d_map_actual_fields_to_dump.dataPtr();
-#else
     int const* field_map_ptr = map_actual_fields_to_dump.dataPtr();
-#endif
     for (MFIter mfi(tmp, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
          Array4<Real> tmp_arr = tmp[mfi].array();
          Array4<Real> buf_arr = buf[mfi].array();
@@ -1357,20 +1361,11 @@ AddDataToBuffer( MultiFab& tmp, int k_lab,
 void
 LabFrameSlice::
 AddDataToBuffer( MultiFab& tmp, int k_lab,
-                 amrex::Vector<int> const& map_actual_fields_to_dump)
+                 amrex::Gpu::DeviceVector<int> const& map_actual_fields_to_dump)
 {
     const int ncomp_to_dump = map_actual_fields_to_dump.size();
     MultiFab& buf = *m_data_buffer_;
-#ifdef AMREX_USE_GPU
-    Gpu::DeviceVector<int> d_map_actual_fields_to_dump(ncomp_to_dump);
-    Gpu::copyAsync(Gpu::hostToDevice,
-                   map_actual_fields_to_dump.begin(), map_actual_fields_to_dump.end(),
-                   d_map_actual_fields_to_dump.begin());
-    Gpu::synchronize();
-    int const* field_map_ptr = d_map_actual_fields_to_dump.dataPtr();
-#else
     int const* field_map_ptr = map_actual_fields_to_dump.dataPtr();
-#endif
     for (MFIter mfi(tmp, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
        Box& bx = m_buff_box_;
@@ -65,16 +65,7 @@ BackTransformFunctor::operator ()(amrex::MultiFab& mf_dst, int /*dcomp*/, const
         const int k_lab = m_k_index_zlab[i_buffer];
         const int ncomp_dst = mf_dst.nComp();
         amrex::MultiFab& tmp = *tmp_slice_ptr;
-#ifdef AMREX_USE_GPU
-        Gpu::DeviceVector<int> d_map_varnames(m_map_varnames.size());
-        Gpu::copyAsync(Gpu::hostToDevice,
-                       m_map_varnames.begin(), m_map_varnames.end(),
-                       d_map_varnames.begin());
-        Gpu::synchronize();
-        int const* field_map_ptr = d_map_varnames.dataPtr();
-#else
-        int const* field_map_ptr = m_map_varnames.dataPtr();
-#endif
+        int const* field_map_ptr = m_d_map_varnames.dataPtr();
         for (amrex::MFIter mfi(tmp, TilingIfNotGPU()); mfi.isValid(); ++mfi)
         {
             // Box spanning the user-defined index-space for diagnostic, mf_dst
@@ -145,6 +136,10 @@ BackTransformFunctor::InitData ()
     {
         m_map_varnames[i] = m_possible_fields_to_dump[ m_varnames[i] ] ;
     }
+    // The map is used by the slice copy at every step: keep it on the device
+    m_d_map_varnames.resize( m_map_varnames.size() );
+    Gpu::copy(Gpu::hostToDevice, m_map_varnames.begin(), m_map_varnames.end(),
+              m_d_map_varnames.begin());
 
 }
 
@@ -11,6 +11,30 @@ CellCenterFunctor::CellCenterFunctor(amrex::MultiFab const * mf_src, int lev,
       m_convertRZmodes2cartesian(convertRZmodes2cartesian), m_scomp(scomp)
 {}
 
+bool
+CellCenterFunctor::CanFuse (const amrex::MultiFab& mf_dst, const amrex::IntVect& crse_ratio) const
+{
+#ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(mf_dst, crse_ratio);
+    return false;
+#else
+    if (m_crse_ratio != crse_ratio) return false;
+    // Guard cells of mf_dst (e.g. for the in situ formats) are filled as in
+    // operator(), which requires no coarsening and enough source guard cells.
+    const amrex::IntVect ngrow = mf_dst.nGrowVect();
+    if (ngrow != amrex::IntVect(0)) {
+        if (m_crse_ratio != amrex::IntVect(1)) return false;
+        const amrex::IntVect stag_src = m_mf_src->ixType().toIntVect();
+        const amrex::IntVect stag_dst = mf_dst.ixType().toIntVect();
+        if (!(m_mf_src->nGrowVect() >= stag_dst - stag_src + ngrow)) return false;
+    }
+    amrex::BoxArray ba = amrex::convert(m_mf_src->boxArray(), mf_dst.ixType().toIntVect());
+    if (!ba.coarsenable(m_crse_ratio)) return false;
+    ba.coarsen(m_crse_ratio);
+    return ba == mf_dst.boxArray() && m_mf_src->DistributionMap() == mf_dst.DistributionMap();
+#endif
+}
+
 void
 CellCenterFunctor::operator()(amrex::MultiFab& mf_dst, int dcomp, const int /*i_buffer*/) const
 {
@@ -15,8 +15,8 @@ DivBFunctor::operator()(amrex::MultiFab& mf_dst, int dcomp, const int /*i_buffer
     constexpr int ng = 1;
     // A cell-centered divB multifab spanning the entire domain is generated
     // and divB is computed on the cell-center, with ng=1.
-    amrex::MultiFab divB( warpx.boxArray(m_lev), warpx.DistributionMap(m_lev), 1, ng );
-    warpx.ComputeDivB(divB, 0, m_arr_mf_src, WarpX::CellSize(m_lev) );
+    ReuseOrDefine( m_divB, warpx.boxArray(m_lev), warpx.DistributionMap(m_lev), 1, ng );
+    warpx.ComputeDivB(m_divB, 0, m_arr_mf_src, WarpX::CellSize(m_lev) );
     // Coarsen and Interpolate from divB to coarsened/reduced_domain mf_dst
-    CoarsenIO::Coarsen( mf_dst, divB, dcomp, 0, nComp(), 0, m_crse_ratio);
+    CoarsenIO::Coarsen( mf_dst, m_divB, dcomp, 0, nComp(), 0, m_crse_ratio);
 }
@@ -22,11 +22,11 @@ PartPerCellFunctor::operator()(amrex::MultiFab& mf_dst, const int dcomp, const i
     // the operations performend in the CoarsenAndInterpolate function.
     constexpr int ng = 1;
     // Temporary cell-centered, single-component MultiFab for storing particles per cell.
-    amrex::MultiFab ppc_mf(warpx.boxArray(m_lev), warpx.DistributionMap(m_lev), 1, ng);
+    ReuseOrDefine(m_ppc_mf, warpx.boxArray(m_lev), warpx.DistributionMap(m_lev), 1, ng);
     // Set value to 0, and increment the value in each cell with ppc.
-    ppc_mf.setVal(0._rt);
+    m_ppc_mf.setVal(0._rt);
     // Compute ppc which includes a summation over all species.
-    warpx.GetPartContainer().Increment(ppc_mf, m_lev);
-    // Coarsen and interpolate from ppc_mf to the output diagnostic MultiFab, mf_dst.
-    CoarsenIO::Coarsen(mf_dst, ppc_mf, dcomp, 0, nComp(), 0, m_crse_ratio);
+    warpx.GetPartContainer().Increment(m_ppc_mf, m_lev);
+    // Coarsen and interpolate from m_ppc_mf to the output diagnostic MultiFab, mf_dst.
+    CoarsenIO::Coarsen(mf_dst, m_ppc_mf, dcomp, 0, nComp(), 0, m_crse_ratio);
 }
@@ -21,14 +21,14 @@ PartPerGridFunctor::operator()(amrex::MultiFab& mf_dst, const int dcomp, const i
     constexpr int ng = 1;
     // Temporary MultiFab containing number of particles per grid.
     // (stored as constant for all cells in each grid)
-    amrex::MultiFab ppg_mf(warpx.boxArray(m_lev), warpx.DistributionMap(m_lev), 1, ng);
+    ReuseOrDefine(m_ppg_mf, warpx.boxArray(m_lev), warpx.DistributionMap(m_lev), 1, ng);
 #ifdef AMREX_USE_OMP
 #pragma omp parallel
 #endif
-    for (amrex::MFIter mfi(ppg_mf); mfi.isValid(); ++mfi) {
-        ppg_mf[mfi].setVal<amrex::RunOn::Host>(static_cast<amrex::Real>(npart_in_grid[mfi.index()]));
+    for (amrex::MFIter mfi(m_ppg_mf); mfi.isValid(); ++mfi) {
+        m_ppg_mf[mfi].setVal<amrex::RunOn::Host>(static_cast<amrex::Real>(npart_in_grid[mfi.index()]));
     }
 
-    // Coarsen and interpolate from ppg_mf to the output diagnostic MultiFab, mf_dst.
-    CoarsenIO::Coarsen(mf_dst, ppg_mf, dcomp, 0, nComp(), 0, m_crse_ratio);
+    // Coarsen and interpolate from m_ppg_mf to the output diagnostic MultiFab, mf_dst.
+    CoarsenIO::Coarsen(mf_dst, m_ppg_mf, dcomp, 0, nComp(), 0, m_crse_ratio);
 }
@@ -12,6 +12,7 @@
 #   include "FlushFormats/FlushFormatOpenPMD.H"
 #endif
 #include "WarpX.H"
+#include "Utils/CoarsenIO.H"
 #include "Utils/WarpXUtil.H"
 #include <AMReX_Vector.H>
 #include <string>
@@ -237,10 +238,10 @@ Diagnostics::InitBaseData ()
     }
     // Construct Flush class.
     if        (m_format == "plotfile"){
-        m_flush_format = std::make_unique<FlushFormatPlotfile>() ;
+        m_flush_format = std::make_unique<FlushFormatPlotfile>(m_diag_name) ;
     } else if (m_format == "checkpoint"){
         // creating checkpoint format
-        m_flush_format = std::make_unique<FlushFormatCheckpoint>() ;
+        m_flush_format = std::make_unique<FlushFormatCheckpoint>(m_diag_name) ;
     } else if (m_format == "ascent"){
         m_flush_format = std::make_unique<FlushFormatAscent>();
     } else if (m_format == "sensei"){
@@ -280,26 +281,51 @@ Diagnostics::ComputeAndPack ()
     // prepare the field-data necessary to compute output data
     PrepareFieldDataForOutput();
 
+    // compute the necessary fields and store result in m_mf_output.
+    ComputeFields(m_mf_output);
+}
+
+void
+Diagnostics::ComputeFields (amrex::Vector< amrex::Vector< amrex::MultiFab > >& mf_dst)
+{
     auto & warpx = WarpX::GetInstance();
 
-    // compute the necessary fields and store result in m_mf_output.
     for (int i_buffer = 0; i_buffer < m_num_buffers; ++i_buffer) {
         for(int lev=0; lev<nlev_output; lev++){
             int icomp_dst = 0;
+            // Sources, components and output components of the cell-centering
+            // functors that are computed together by CoarsenIO::FusedLoop
+            amrex::Vector<const amrex::MultiFab*> fused_src;
+            amrex::Vector<int> fused_scomp, fused_dcomp;
             for (int icomp=0, n=m_all_field_functors[0].size(); icomp<n; icomp++){
-                // Call all functors in m_all_field_functors[lev]. Each of them computes
-                // a diagnostics and writes in one or more components of the output
-                // multifab m_mf_output[lev].
-                m_all_field_functors[lev][icomp]->operator()(m_mf_output[i_buffer][lev], icomp_dst, i_buffer);
+                auto const* cc_functor =
+                    dynamic_cast<CellCenterFunctor const*>(m_all_field_functors[lev][icomp].get());
+                if (cc_functor && cc_functor->CanFuse(mf_dst[i_buffer][lev], m_crse_ratio)) {
+                    for (int n_cc = 0; n_cc < cc_functor->nComp(); ++n_cc) {
+                        fused_src.push_back(cc_functor->SrcMF());
+                        fused_scomp.push_back(cc_functor->sComp() + n_cc);
+                        fused_dcomp.push_back(icomp_dst + n_cc);
+                    }
+                } else {
+                    // Call all other functors in m_all_field_functors[lev]. Each of them computes
+                    // a diagnostics and writes in one or more components of the output
+                    // multifab mf_dst[i_buffer][lev].
+                    m_all_field_functors[lev][icomp]->operator()(mf_dst[i_buffer][lev], icomp_dst, i_buffer);
+                }
                 // update the index of the next component to fill
                 icomp_dst += m_all_field_functors[lev][icomp]->nComp();
             }
+            // Cell-center E, B, j, H, M, ... in one kernel per box
+            if (!fused_src.empty()) {
+                CoarsenIO::FusedLoop(mf_dst[i_buffer][lev], fused_src,
+                                     fused_scomp, fused_dcomp, m_crse_ratio);
+            }
             // Check that the proper number of components of mf_avg were updated.
             AMREX_ALWAYS_ASSERT( icomp_dst == m_varnames.size() );
 
             // needed for contour plots of rho, i.e. ascent/sensei
             if (m_format == "sensei" || m_format == "ascent") {
-                m_mf_output[i_buffer][lev].FillBoundary(warpx.Geom(lev).periodicity());
+                mf_dst[i_buffer][lev].FillBoundary(warpx.Geom(lev).periodicity());
             }
         }
     }
@@ -324,3 +350,15 @@ Diagnostics::FilterComputePackFlush (int step, bool force_flush)
     }
 
 }
+
+amrex::Long
+Diagnostics::MemoryBytes (int lev) const
+{
+    amrex::Long nbytes = 0;
+    for (auto const& mf_buffer : m_mf_output) {
+        if (lev < static_cast<int>(mf_buffer.size())) {
+            nbytes += WarpXUtilMemory::FabArrayBytes(&mf_buffer[lev]);
+        }
+    }
+    return nbytes;
+}
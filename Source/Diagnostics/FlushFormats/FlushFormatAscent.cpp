@@ -31,15 +31,21 @@ FlushFormatAscent::WriteToFile (
     // const auto step = istep[0];
     // WriteBlueprintFiles(bp_mesh,"bp_export",step,"hdf5");
 
-    ascent::Ascent ascent;
-    conduit::Node opts;
-    opts["exceptions"] = "catch";
-    opts["mpi_comm"] = MPI_Comm_c2f(ParallelDescriptor::Communicator());
-    ascent.open(opts);
-    ascent.publish(bp_mesh);
+    // Opening Ascent initializes its runtime and parses the actions:
+    // do it only once per diagnostics
+    if (!m_ascent_is_open) {
+        conduit::Node opts;
+        opts["exceptions"] = "catch";
+        opts["mpi_comm"] = MPI_Comm_c2f(ParallelDescriptor::Communicator());
+        m_ascent.open(opts);
+        m_ascent_is_open = true;
+    }
+
+    // bp_mesh points to the data of mf: make sure the kernels filling it are done
+    amrex::Gpu::streamSynchronize();
+    m_ascent.publish(bp_mesh);
     conduit::Node actions;
-    ascent.execute(actions);
-    ascent.close();
+    m_ascent.execute(actions);
 
 #else
     amrex::ignore_unused(varnames, mf, geom, iteration, time,
@@ -49,6 +55,13 @@ FlushFormatAscent::WriteToFile (
         plot_raw_F);
 }
 
+FlushFormatAscent::~FlushFormatAscent ()
+{
+#ifdef AMREX_USE_ASCENT
+    if (m_ascent_is_open) m_ascent.close();
+#endif
+}
+
 #ifdef AMREX_USE_ASCENT
 void
 FlushFormatAscent::WriteParticles(const amrex::Vector<ParticleDiag>& particle_diags, conduit::Node& a_bp_mesh) const
@@ -1,8 +1,14 @@
 #include "FlushFormatCheckpoint.H"
 #include "WarpX.H"
+#include "Utils/BoxCostTimer.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "Utils/WarpXUtil.H"
 
 #include <AMReX_buildInfo.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Reduce.H>
+
+#include <fstream>
 
 using namespace amrex;
 
@@ -11,6 +17,22 @@ namespace
     const std::string default_level_prefix {"Level_"};
 }
 
+FlushFormatCheckpoint::FlushFormatCheckpoint (const std::string& diag_name)
+    : FlushFormatPlotfile(diag_name)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_single_precision,
+        "<diag_name>.output_precision = single cannot be used for a checkpoint");
+#ifdef WARPX_MAG_LLG
+    ParmParse pp_diag_name(diag_name);
+    pp_diag_name.query("full_checkpoint_interval", m_full_checkpoint_interval);
+    queryWithParser(pp_diag_name, "incremental_tolerance", m_incremental_tolerance);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_full_checkpoint_interval >= 1,
+        "full_checkpoint_interval must be at least 1");
+#else
+    amrex::ignore_unused(diag_name);
+#endif
+}
+
 void
 FlushFormatCheckpoint::WriteToFile (
         const amrex::Vector<std::string> /*varnames*/,
@@ -27,8 +49,16 @@ FlushFormatCheckpoint::WriteToFile (
 {
     WARPX_PROFILE("FlushFormatCheckpoint::WriteToFile()");
 
+    // With amrex.async_out, the fields and particles are copied to host
+    // buffers and written by the AsyncOut thread while the simulation goes on
+    WaitForPreviousAsyncWrite();
+
     auto & warpx = WarpX::GetInstance();
 
+    // Reduced diagnostics buffered in memory are written with the checkpoint,
+    // so that a restart from it appends to complete files
+    warpx.reduced_diags->Flush();
+
     VisMF::Header::Version current_version = VisMF::GetHeaderVersion();
     VisMF::SetHeaderVersion(amrex::VisMF::Header::NoFabHeader_v1);
 
@@ -36,72 +66,129 @@ FlushFormatCheckpoint::WriteToFile (
 
     amrex::Print() << "  Writing checkpoint " << checkpointname << "\n";
 
+    // With a staging directory, the checkpoint is written there, then moved
+    // to checkpointname in the background
+    const std::string path = m_staging.Path(checkpointname);
+    Vector<std::string> staged_dirs{""};
+    for (auto const& part_diag : particle_diags) staged_dirs.push_back(part_diag.getSpeciesName());
+
     // const int nlevels = finestLevel()+1;
-    amrex::PreBuildDirectorHierarchy(checkpointname, default_level_prefix, nlev, true);
+    amrex::PreBuildDirectorHierarchy(path, default_level_prefix, nlev, true);
+    m_staging.CreateDirectories(checkpointname, nlev, staged_dirs);
+
+    WriteWarpXHeader(path, particle_diags, geom);
 
-    WriteWarpXHeader(checkpointname, particle_diags, geom);
+    WriteJobInfo(path);
 
-    WriteJobInfo(checkpointname);
+    WriteCosts(path, nlev);
+
+#ifdef WARPX_MAG_LLG
+    const bool is_full = IsFullCheckpoint(nlev);
+    // MultiFabs of the boxes of M written to an incremental checkpoint
+    Vector<std::string> deltas;
+#endif
 
     for (int lev = 0; lev < nlev; ++lev)
     {
-        VisMF::Write(warpx.getEfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_fp"));
-        VisMF::Write(warpx.getEfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_fp"));
-        VisMF::Write(warpx.getEfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 0),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 1),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_fp"));
-        VisMF::Write(warpx.getBfield_fp(lev, 2),
-                     amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_fp"));
+        VisMF::AsyncWrite(warpx.getEfield_fp(lev, 0),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Ex_fp"));
+        VisMF::AsyncWrite(warpx.getEfield_fp(lev, 1),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Ey_fp"));
+        VisMF::AsyncWrite(warpx.getEfield_fp(lev, 2),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Ez_fp"));
+        VisMF::AsyncWrite(warpx.getBfield_fp(lev, 0),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Bx_fp"));
+        VisMF::AsyncWrite(warpx.getBfield_fp(lev, 1),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "By_fp"));
+        VisMF::AsyncWrite(warpx.getBfield_fp(lev, 2),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Bz_fp"));
+#ifdef WARPX_MAG_LLG
+        VisMF::AsyncWrite(warpx.getHfield_fp(lev, 0),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Hx_fp"));
+        VisMF::AsyncWrite(warpx.getHfield_fp(lev, 1),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Hy_fp"));
+        VisMF::AsyncWrite(warpx.getHfield_fp(lev, 2),
+                     amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Hz_fp"));
+        // M is written to full checkpoints, and only where it changed to the
+        // incremental ones. H_bias is static, it is set from the inputs on restart.
+        Vector<std::string> const lev_deltas = WriteMagnetization(path, lev, is_full);
+        deltas.insert(deltas.end(), lev_deltas.begin(), lev_deltas.end());
+#endif
         if (warpx.getis_synchronized()) {
             // Need to save j if synchronized because after restart we need j to evolve E by dt/2.
-            VisMF::Write(warpx.getcurrent_fp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jx_fp"));
-            VisMF::Write(warpx.getcurrent_fp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jy_fp"));
-            VisMF::Write(warpx.getcurrent_fp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jz_fp"));
+            VisMF::AsyncWrite(warpx.getcurrent_fp(lev, 0),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "jx_fp"));
+            VisMF::AsyncWrite(warpx.getcurrent_fp(lev, 1),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "jy_fp"));
+            VisMF::AsyncWrite(warpx.getcurrent_fp(lev, 2),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "jz_fp"));
         }
 
         if (lev > 0)
         {
-            VisMF::Write(warpx.getEfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ex_cp"));
-            VisMF::Write(warpx.getEfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ey_cp"));
-            VisMF::Write(warpx.getEfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Ez_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 0),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bx_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 1),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "By_cp"));
-            VisMF::Write(warpx.getBfield_cp(lev, 2),
-                         amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "Bz_cp"));
+            VisMF::AsyncWrite(warpx.getEfield_cp(lev, 0),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Ex_cp"));
+            VisMF::AsyncWrite(warpx.getEfield_cp(lev, 1),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Ey_cp"));
+            VisMF::AsyncWrite(warpx.getEfield_cp(lev, 2),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Ez_cp"));
+            VisMF::AsyncWrite(warpx.getBfield_cp(lev, 0),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Bx_cp"));
+            VisMF::AsyncWrite(warpx.getBfield_cp(lev, 1),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "By_cp"));
+            VisMF::AsyncWrite(warpx.getBfield_cp(lev, 2),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Bz_cp"));
+#ifdef WARPX_MAG_LLG
+            VisMF::AsyncWrite(warpx.getHfield_cp(lev, 0),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Hx_cp"));
+            VisMF::AsyncWrite(warpx.getHfield_cp(lev, 1),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Hy_cp"));
+            VisMF::AsyncWrite(warpx.getHfield_cp(lev, 2),
+                         amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "Hz_cp"));
+#endif
             if (warpx.getis_synchronized()) {
                 // Need to save j if synchronized because after restart we need j to evolve E by dt/2.
-                VisMF::Write(warpx.getcurrent_cp(lev, 0),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jx_cp"));
-                VisMF::Write(warpx.getcurrent_cp(lev, 1),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jy_cp"));
-                VisMF::Write(warpx.getcurrent_cp(lev, 2),
-                             amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "jz_cp"));
+                VisMF::AsyncWrite(warpx.getcurrent_cp(lev, 0),
+                             amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "jx_cp"));
+                VisMF::AsyncWrite(warpx.getcurrent_cp(lev, 1),
+                             amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "jy_cp"));
+                VisMF::AsyncWrite(warpx.getcurrent_cp(lev, 2),
+                             amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "jz_cp"));
             }
         }
 
         if (warpx.DoPML() && warpx.GetPML(lev)) {
             warpx.GetPML(lev)->CheckPoint(
-                amrex::MultiFabFileFullPrefix(lev, checkpointname, default_level_prefix, "pml"));
+                amrex::MultiFabFileFullPrefix(lev, path, default_level_prefix, "pml"));
         }
     }
 
-    CheckpointParticles(checkpointname, particle_diags);
+    CheckpointParticles(path, particle_diags);
+
+#ifdef WARPX_MAG_LLG
+    if (is_full) {
+        m_last_full_checkpoint = checkpointname;
+        m_nincremental = 0;
+    } else {
+        ++m_nincremental;
+        // The restart reads M from the last full checkpoint, then the boxes
+        // listed in this file from this checkpoint
+        if (ParallelDescriptor::IOProcessor()) {
+            std::ofstream ofs(path + "/WarpXIncremental");
+            ofs << m_last_full_checkpoint << '\n';
+            for (auto const& d : deltas) ofs << d << '\n';
+            if (!ofs.good()) {
+                amrex::FileOpenFailed(path + "/WarpXIncremental");
+            }
+        }
+    }
+#endif
+
+    MarkEndOfAsyncWrite();
 
     VisMF::SetHeaderVersion(current_version);
 
+    m_staging.Drain(checkpointname);
 }
 
 void
@@ -110,7 +197,174 @@ FlushFormatCheckpoint::CheckpointParticles(
     const amrex::Vector<ParticleDiag>& particle_diags) const
 {
     for (unsigned i = 0, n = particle_diags.size(); i < n; ++i) {
-        particle_diags[i].getParticleContainer()->Checkpoint(
-            dir, particle_diags[i].getSpeciesName());
+        WarpXParticleContainer* pc = particle_diags[i].getParticleContainer();
+        if (!m_particle_aggregation.IsActive()) {
+            m_particle_aggregation.Write([&] () {
+                pc->Checkpoint(dir, particle_diags[i].getSpeciesName());
+            });
+            continue;
+        }
+
+        // The species is copied to pinned memory, and the copy is aggregated
+        ParticleDiag::PinnedParticleContainer tmp(&WarpX::GetInstance());
+        for (int ic = 0; ic < pc->NumRuntimeRealComps(); ++ic) tmp.AddRealComp();
+        for (int ic = 0; ic < pc->NumRuntimeIntComps(); ++ic) tmp.AddIntComp();
+        tmp.resizeData();
+        for (int lev = 0; lev <= pc->finestLevel(); ++lev) {
+            for (WarpXParIter pti(*pc, lev); pti.isValid(); ++pti) {
+                auto& dst_tile = tmp.DefineAndReturnParticleTile(lev, pti.index(), pti.LocalTileIndex());
+                dst_tile.resize(pti.numParticles());
+                amrex::copyParticles(dst_tile, pti.GetParticleTile());
+            }
+        }
+        Gpu::synchronize();
+        m_particle_aggregation.Aggregate(tmp);
+        m_particle_aggregation.Write([&] () {
+            tmp.Checkpoint(dir, particle_diags[i].getSpeciesName());
+        });
+    }
+}
+
+void
+FlushFormatCheckpoint::WriteCosts (const std::string& dir, int nlev) const
+{
+    if (!WarpX::getCosts(0)) return;
+    BoxCostTimer::Flush();
+
+    Vector<Vector<Real> > costs(nlev);
+    bool has_costs = false;
+    for (int lev = 0; lev < nlev; ++lev) {
+        LayoutData<Real> const& lev_costs = *WarpX::getCosts(lev);
+        costs[lev].resize(lev_costs.size(), 0._rt);
+        for (int i : lev_costs.IndexArray()) {
+            costs[lev][i] = lev_costs[i];
+        }
+        ParallelDescriptor::ReduceRealSum(costs[lev].dataPtr(), costs[lev].size(),
+                                          ParallelDescriptor::IOProcessorNumber());
+        for (Real c : costs[lev]) has_costs = has_costs || (c > 0._rt);
+    }
+
+    // The costs are reset after each load balancing: nothing to save if
+    // none were recorded since
+    if (ParallelDescriptor::IOProcessor() && has_costs) {
+        std::ofstream ofs(dir + "/WarpXCosts");
+        ofs.precision(17);
+        for (int lev = 0; lev < nlev; ++lev) {
+            ofs << costs[lev].size();
+            for (Real c : costs[lev]) ofs << ' ' << c;
+            ofs << '\n';
+        }
+        if (!ofs.good()) {
+            amrex::FileOpenFailed(dir + "/WarpXCosts");
+        }
+    }
+}
+
+#ifdef WARPX_MAG_LLG
+bool
+FlushFormatCheckpoint::IsFullCheckpoint (int nlev) const
+{
+    if (m_last_full_checkpoint.empty() ||
+        m_nincremental+1 >= m_full_checkpoint_interval ||
+        static_cast<int>(m_M_ref_fp.size()) < nlev) {
+        return true;
+    }
+
+    // The reference M must be defined on the current grids (e.g. not after
+    // a load balancing)
+    auto & warpx = WarpX::GetInstance();
+    for (int lev = 0; lev < nlev; ++lev) {
+        for (int i = 0; i < 3; ++i) {
+            for (bool fine : {true, false}) {
+                if (lev == 0 && !fine) continue;
+                const MultiFab& M = fine ? warpx.getMfield_fp(lev, i) : warpx.getMfield_cp(lev, i);
+                const auto& ref = fine ? m_M_ref_fp[lev][i] : m_M_ref_cp[lev][i];
+                if (!ref || !(ref->boxArray() == M.boxArray()) ||
+                    !(ref->DistributionMap() == M.DistributionMap())) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+Vector<std::string>
+FlushFormatCheckpoint::WriteMagnetization (const std::string& dir, int lev, bool is_full) const
+{
+    auto & warpx = WarpX::GetInstance();
+    Vector<std::string> deltas;
+
+    if (static_cast<int>(m_M_ref_fp.size()) <= lev) {
+        m_M_ref_fp.resize(lev+1);
+        m_M_ref_cp.resize(lev+1);
+    }
+
+    for (bool fine : {true, false}) {
+        if (lev == 0 && !fine) continue;
+        for (int i = 0; i < 3; ++i) {
+            const MultiFab& M = fine ? warpx.getMfield_fp(lev, i) : warpx.getMfield_cp(lev, i);
+            auto& ref = fine ? m_M_ref_fp[lev][i] : m_M_ref_cp[lev][i];
+            const std::string name = std::string("M") + "xyz"[i] + (fine ? "_fp" : "_cp");
+
+            if (is_full) {
+                VisMF::AsyncWrite(M, amrex::MultiFabFileFullPrefix(lev, dir, default_level_prefix, name));
+                // keep M as the reference of the next incremental checkpoints
+                if (m_full_checkpoint_interval > 1) {
+                    ref = std::make_unique<MultiFab>(M.boxArray(), M.DistributionMap(),
+                                                     M.nComp(), M.nGrowVect());
+                    MultiFab::Copy(*ref, M, 0, 0, M.nComp(), M.nGrowVect());
+                }
+            } else if (WriteChangedBoxes(M, *ref,
+                           amrex::MultiFabFileFullPrefix(lev, dir, default_level_prefix, name + "_delta"))) {
+                deltas.push_back(std::to_string(lev) + " " + name);
+            }
+        }
+    }
+    return deltas;
+}
+
+bool
+FlushFormatCheckpoint::WriteChangedBoxes (const MultiFab& mf, const MultiFab& ref,
+                                          const std::string& name) const
+{
+    // maximum change in each box since the reference, guard cells included
+    Vector<Real> change(mf.size(), 0._rt);
+    const int ncomp = mf.nComp();
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+        Array4<Real const> const& a = mf.const_array(mfi);
+        Array4<Real const> const& r = ref.const_array(mfi);
+        ReduceOps<ReduceOpMax> reduce_op;
+        ReduceData<Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(mfi.fabbox(), ncomp, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) -> ReduceTuple
+            {
+                return {amrex::Math::abs(a(i,j,k,n) - r(i,j,k,n))};
+            });
+        change[mfi.index()] = amrex::get<0>(reduce_data.value());
+    }
+    ParallelDescriptor::ReduceRealMax(change.dataPtr(), change.size());
+
+    // the changed boxes stay on the MPI rank that owns them
+    BoxList bl(mf.boxArray().ixType());
+    Vector<int> pmap;
+    Vector<int> index;
+    for (int i = 0; i < mf.size(); ++i) {
+        if (change[i] > m_incremental_tolerance) {
+            bl.push_back(mf.boxArray()[i]);
+            pmap.push_back(mf.DistributionMap()[i]);
+            index.push_back(i);
+        }
+    }
+    if (index.empty()) return false;
+
+    MultiFab delta(BoxArray(std::move(bl)), DistributionMapping(std::move(pmap)),
+                   ncomp, mf.nGrowVect());
+    for (MFIter mfi(delta); mfi.isValid(); ++mfi) {
+        delta[mfi].copy<RunOn::Device>(mf[index[mfi.index()]]);
     }
+    VisMF::AsyncWrite(delta, name);
+    return true;
 }
+#endif
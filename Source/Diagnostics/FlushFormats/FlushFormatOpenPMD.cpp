@@ -4,20 +4,51 @@
 
 #include <AMReX_buildInfo.H>
 
+#include <map>
+#include <string>
+#include <vector>
+
 using namespace amrex;
 
 FlushFormatOpenPMD::FlushFormatOpenPMD (const std::string& diag_name)
 {
     ParmParse pp_diag_name(diag_name);
-    // Which backend to use (ADIOS, ADIOS2 or HDF5). Default depends on what is available
+    // Which backend to use (ADIOS, ADIOS2 or HDF5), or ADIOS2 streaming engine (SST or SSC).
+    // Default depends on what is available
     std::string openpmd_backend {"default"};
     // one file per timestep (or one file for all steps)
     bool openpmd_tspf = true;
     pp_diag_name.query("openpmd_backend", openpmd_backend);
     pp_diag_name.query("openpmd_tspf", openpmd_tspf);
+
+    // ADIOS2 compression operator (e.g. blosc, zfp, sz) and its parameters,
+    // given as a list of key value pairs
+    std::string operator_type;
+    pp_diag_name.query("adios2_operator.type", operator_type);
+    std::vector<std::string> operator_parameters_list;
+    pp_diag_name.queryarr("adios2_operator.parameters", operator_parameters_list);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(operator_parameters_list.size() % 2 == 0,
+        "adios2_operator.parameters must be a list of key value pairs");
+    std::map< std::string, std::string > operator_parameters;
+    for (std::size_t i = 0; i < operator_parameters_list.size(); i += 2) {
+        operator_parameters[operator_parameters_list[i]] = operator_parameters_list[i+1];
+    }
+
+    // parameters of the ADIOS2 streaming engine (openpmd_backend = sst or ssc),
+    // given as a list of key value pairs
+    std::vector<std::string> engine_parameters_list;
+    pp_diag_name.queryarr("adios2_engine.parameters", engine_parameters_list);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(engine_parameters_list.size() % 2 == 0,
+        "adios2_engine.parameters must be a list of key value pairs");
+    std::map< std::string, std::string > engine_parameters;
+    for (std::size_t i = 0; i < engine_parameters_list.size(); i += 2) {
+        engine_parameters[engine_parameters_list[i]] = engine_parameters_list[i+1];
+    }
+
     auto & warpx = WarpX::GetInstance();
     m_OpenPMDPlotWriter = new WarpXOpenPMDPlot(
-        openpmd_tspf, openpmd_backend, warpx.getPMLdirections()
+        openpmd_tspf, openpmd_backend, operator_type, operator_parameters,
+        engine_parameters, QuerySinglePrecision(diag_name), warpx.getPMLdirections()
         );
 }
 
@@ -35,6 +66,8 @@ FlushFormatOpenPMD::WriteToFile (
 {
     WARPX_PROFILE("FlushFormatOpenPMD::WriteToFile()");
 
+    const amrex::Real t_start = amrex::second();
+
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
         !plot_raw_fields && !plot_raw_fields_guards && !plot_raw_rho && !plot_raw_F,
         "Cannot plot raw data with OpenPMD output format. Use plotfile instead.");
@@ -58,6 +91,15 @@ FlushFormatOpenPMD::WriteToFile (
 
     // signal that no further updates will be written to this iteration
     m_OpenPMDPlotWriter->CloseStep(isBTD, isLastBTDFlush);
+
+    // Report the uncompressed size of the data and the time spent writing
+    // (including the compression, if any), to compare with the size on disk
+    amrex::Real t_write = amrex::second() - t_start;
+    amrex::Real stored_mb = static_cast<amrex::Real>(m_OpenPMDPlotWriter->GetStoredBytes()) / 1.e6_rt;
+    ParallelDescriptor::ReduceRealMax(t_write, ParallelDescriptor::IOProcessorNumber());
+    ParallelDescriptor::ReduceRealSum(stored_mb, ParallelDescriptor::IOProcessorNumber());
+    amrex::Print() << "  openPMD: wrote " << stored_mb << " MB (before compression) in "
+                   << t_write << " s\n";
 }
 
 FlushFormatOpenPMD::~FlushFormatOpenPMD (){
@@ -5,12 +5,34 @@
 
 #include <AMReX_AmrParticles.H>
 #include <AMReX_buildInfo.H>
+#include <AMReX_FArrayBox.H>
+#include <AMReX_ParmParse.H>
+
+#include <utility>
 
 using namespace amrex;
 
 namespace
 {
     const std::string default_level_prefix {"Level_"};
+
+    /** Staging directory of the diagnostics diag_name, empty if none */
+    std::string QueryStagingDir (const std::string& diag_name)
+    {
+        std::string staging_dir;
+        ParmParse pp_diag_name(diag_name);
+        pp_diag_name.query("staging_dir", staging_dir);
+        return staging_dir;
+    }
+}
+
+FlushFormatPlotfile::FlushFormatPlotfile (const std::string& diag_name)
+    : m_staging(QueryStagingDir(diag_name)),
+      m_single_precision(QuerySinglePrecision(diag_name))
+{
+    // the AsyncOut thread writes the fields in the precision of amrex::Real
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_single_precision || !AsyncOut::UseAsyncOut(),
+        "<diag_name>.output_precision = single cannot be used with amrex.async_out");
 }
 
 void
@@ -27,13 +49,28 @@ FlushFormatPlotfile::WriteToFile (
 {
     WARPX_PROFILE("FlushFormatPlotfile::WriteToFile()");
     auto & warpx = WarpX::GetInstance();
-    const std::string& filename = amrex::Concatenate(prefix, iteration[0]);
-    amrex::Print() << "  Writing plotfile " << filename << "\n";
+    const std::string& plotfilename = amrex::Concatenate(prefix, iteration[0]);
+    amrex::Print() << "  Writing plotfile " << plotfilename << "\n";
+
+    // With amrex.async_out, the fields and particles are copied to host
+    // buffers and written by the AsyncOut thread while the simulation goes on
+    WaitForPreviousAsyncWrite();
+
+    // With a staging directory, the plotfile is written there, then moved to
+    // plotfilename in the background
+    const std::string filename = m_staging.Path(plotfilename);
+    Vector<std::string> staged_dirs{""};
+    if (plot_raw_fields) staged_dirs.push_back("raw_fields");
+    for (auto const& part_diag : particle_diags) staged_dirs.push_back(part_diag.getSpeciesName());
+    m_staging.CreateDirectories(plotfilename, nlev, staged_dirs);
 
     Vector<std::string> rfs;
     VisMF::Header::Version current_version = VisMF::GetHeaderVersion();
     VisMF::SetHeaderVersion(amrex::VisMF::Header::Version_v1);
     if (plot_raw_fields) rfs.emplace_back("raw_fields");
+    // The fields are converted to float by VisMF as they are written
+    FABio::Format const current_format = FArrayBox::getFormat();
+    if (m_single_precision) FArrayBox::setFormat(FABio::FAB_NATIVE_32);
     amrex::WriteMultiLevelPlotfile(filename, nlev,
                                    amrex::GetVecOfConstPtrs(mf),
                                    varnames, geom,
@@ -47,13 +84,19 @@ FlushFormatPlotfile::WriteToFile (
     WriteAllRawFields(plot_raw_fields, nlev, filename, plot_raw_fields_guards,
                       plot_raw_rho, plot_raw_F);
 
+    FArrayBox::setFormat(current_format);
+
     WriteParticles(filename, particle_diags);
 
     WriteJobInfo(filename);
 
     WriteWarpXHeader(filename, particle_diags, geom);
 
+    MarkEndOfAsyncWrite();
+
     VisMF::SetHeaderVersion(current_version);
+
+    m_staging.Drain(plotfilename);
 }
 
 void
@@ -295,50 +338,33 @@ FlushFormatPlotfile::WriteParticles(const std::string& dir,
             // integer attribs, and it is automatically dumped to plotfiles
             // when ionization is on.
             int_flags.resize(1, 1);
-            tmp.AddIntComp(false);
+            tmp.AddIntComp(m_particle_aggregation.IsActive());
         }
 
 #ifdef WARPX_QED
         if( pc->has_breit_wheeler() ) {
             real_names.push_back("optical_depth_BW");
-            tmp.AddRealComp(false);
+            tmp.AddRealComp(m_particle_aggregation.IsActive());
         }
         if( pc->has_quantum_sync() ) {
             real_names.push_back("optical_depth_QSR");
-            tmp.AddRealComp(false);
+            tmp.AddRealComp(m_particle_aggregation.IsActive());
         }
 #endif
 
-        pc->ConvertUnits(ConvertDirection::WarpX_to_SI);
-
-        RandomFilter const random_filter(particle_diags[i].m_do_random_filter,
-                                         particle_diags[i].m_random_fraction);
-        UniformFilter const uniform_filter(particle_diags[i].m_do_uniform_filter,
-                                           particle_diags[i].m_uniform_stride);
-        ParserFilter parser_filter(particle_diags[i].m_do_parser_filter,
-                                   getParser(particle_diags[i].m_particle_filter_parser),
-                                   pc->getMass());
-        parser_filter.m_units = InputUnits::SI;
-        GeometryFilter const geometry_filter(particle_diags[i].m_do_geom_filter,
-                                             particle_diags[i].m_diag_domain);
-
-        using SrcData = WarpXParticleContainer::ParticleTileType::ConstParticleTileDataType;
-        tmp.copyParticles(*pc,
-                          [=] AMREX_GPU_HOST_DEVICE (const SrcData& src, int ip, const amrex::RandomEngine& engine)
-        {
-            const SuperParticleType& p = src.getSuperParticle(ip);
-            return random_filter(p, engine) * uniform_filter(p, engine)
-                * parser_filter(p, engine) * geometry_filter(p, engine);
-        }, true);
+        // Select, pack and convert to SI units the particles to write
+        particle_diags[i].FilterAndPack(tmp);
+        // The runtime components are only communicated if the particles are aggregated
+        m_particle_aggregation.Aggregate(tmp);
 
         // real_names contains a list of all particle attributes.
         // particle_diags[i].plot_flags is 1 or 0, whether quantity is dumped or not.
-        tmp.WritePlotFile(
-            dir, particle_diags[i].getSpeciesName(),
-            particle_diags[i].plot_flags, int_flags,
-            real_names, int_names);
-
-        pc->ConvertUnits(ConvertDirection::SI_to_WarpX);
+        m_particle_aggregation.Write([&] () {
+            tmp.WritePlotFile(
+                dir, particle_diags[i].getSpeciesName(),
+                particle_diags[i].plot_flags, int_flags,
+                real_names, int_names);
+        });
     }
 }
 
@@ -347,7 +373,7 @@ FlushFormatPlotfile::WriteParticles(const std::string& dir,
  *  Write guard cells if `plot_guards` is True.
  */
 void
-WriteRawMF ( const MultiFab& F, const DistributionMapping& dm,
+WriteRawMF ( const MultiFab& F, const DistributionMapping& /*dm*/,
              const std::string& filename,
              const std::string& level_prefix,
              const std::string& field_name,
@@ -355,15 +381,8 @@ WriteRawMF ( const MultiFab& F, const DistributionMapping& dm,
 {
     std::string prefix = amrex::MultiFabFileFullPrefix(lev,
                             filename, level_prefix, field_name);
-    if (plot_guards) {
-        // Dump original MultiFab F
-        VisMF::Write(F, prefix);
-    } else {
-        // Copy original MultiFab into one that does not have guard cells
-        MultiFab tmpF( F.boxArray(), dm, F.nComp(), 0);
-        MultiFab::Copy(tmpF, F, 0, 0, F.nComp(), 0);
-        VisMF::Write(tmpF, prefix);
-    }
+    // Dump original MultiFab F, without its guard cells unless plot_guards
+    VisMF::AsyncWrite(F, prefix, !plot_guards);
 }
 
 /** \brief Write a multifab of the same shape as `F` but filled with 0.
@@ -384,7 +403,7 @@ WriteZeroRawMF( const MultiFab& F, const DistributionMapping& dm,
 
     MultiFab tmpF(F.boxArray(), dm, F.nComp(), ng);
     tmpF.setVal(0.);
-    VisMF::Write(tmpF, prefix);
+    VisMF::AsyncWrite(std::move(tmpF), prefix);
 }
 
 /** \brief Write the coarse vector multifab `F*_cp` to the file `filename`
@@ -74,6 +74,9 @@ FlushFormatSensei::WriteToFile (
     amrex::Vector<amrex::MultiFab> *mf_ptr =
         const_cast<amrex::Vector<amrex::MultiFab>*>(&mf);
 
+    // the bridge reads the data of mf in place: make sure the kernels filling it are done
+    amrex::Gpu::streamSynchronize();
+
     if (m_insitu_bridge->update(iteration[0], time, m_amr_mesh,
         {mf_ptr}, {varnames}))
     {
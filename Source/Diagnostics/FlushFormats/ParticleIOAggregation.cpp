@@ -0,0 +1,88 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "ParticleIOAggregation.H"
+
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_VisMF.H>
+
+#include <algorithm>
+#include <utility>
+
+using namespace amrex;
+
+ParticleIOAggregation::ParticleIOAggregation ()
+{
+    ParmParse pp_warpx("warpx");
+    pp_warpx.query("particle_io_aggregators_per_node", m_aggregators_per_node);
+    pp_warpx.query("particle_io_stripe_size", m_stripe_size);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_aggregators_per_node >= 0 && m_stripe_size >= 0,
+        "warpx.particle_io_aggregators_per_node and warpx.particle_io_stripe_size must be >= 0");
+    if (!IsActive()) return;
+
+    const int myproc = ParallelDescriptor::MyProc();
+    int aggregator = myproc;
+#ifdef AMREX_USE_MPI
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED,
+                        myproc, MPI_INFO_NULL, &node_comm);
+    int node_rank, node_size;
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_size(node_comm, &node_size);
+    // ranks of the node, ordered by node rank
+    Vector<int> node_procs(node_size);
+    MPI_Allgather(&myproc, 1, MPI_INT, node_procs.data(), 1, MPI_INT, node_comm);
+    MPI_Comm_free(&node_comm);
+
+    // Contiguous groups of ranks, so that with AMReX, which writes the particle files
+    // from contiguous blocks of ranks, each file is written by a single aggregator
+    const int naggregators = std::min(m_aggregators_per_node, node_size);
+    const int group = node_rank*naggregators/node_size;
+    aggregator = node_procs[(group*node_size + naggregators - 1)/naggregators];
+
+    m_aggregator.resize(ParallelDescriptor::NProcs());
+    MPI_Allgather(&aggregator, 1, MPI_INT, m_aggregator.data(), 1, MPI_INT,
+                  ParallelDescriptor::Communicator());
+#else
+    m_aggregator.push_back(aggregator);
+#endif
+    m_naggregators = 0;
+    for (int proc = 0; proc < static_cast<int>(m_aggregator.size()); ++proc) {
+        if (m_aggregator[proc] == proc) ++m_naggregators;
+    }
+
+    // One file per aggregator, unless each rank already writes its own file
+    // (e.g. with a node-local staging directory). AMReX reads this parameter at
+    // each write, and only the aggregators write particles, so it is set once
+    // here, for all the diagnostics, rather than around each write.
+    ParmParse pp_particles("particles");
+    int nfiles = 256;
+    pp_particles.query("particles_nfiles", nfiles);
+    if (nfiles != -1 && nfiles != m_naggregators) {
+        pp_particles.add("particles_nfiles", m_naggregators);
+    }
+}
+
+DistributionMapping
+ParticleIOAggregation::AggregatorMap (DistributionMapping const& dm) const
+{
+    Vector<int> pmap = dm.ProcessorMap();
+    for (int& proc : pmap) proc = m_aggregator[proc];
+    return DistributionMapping(std::move(pmap));
+}
+
+void
+ParticleIOAggregation::Write (std::function<void()> const& write) const
+{
+    const Long io_buffer_size = VisMF::GetIOBufferSize();
+    if (m_stripe_size > 0) VisMF::SetIOBufferSize(m_stripe_size);
+
+    write();
+
+    VisMF::SetIOBufferSize(io_buffer_size);
+}
@@ -0,0 +1,186 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "StagedOutput.H"
+
+#include <AMReX.H>
+#include <AMReX_AsyncOut.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Utility.H>
+#include <AMReX_VisMF.H>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iostream>
+
+using namespace amrex;
+
+namespace
+{
+    const std::string default_level_prefix {"Level_"};
+
+    /** Size of the file path in bytes, or -1 if it cannot be read */
+    long FileSize (const std::string& path)
+    {
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) return -1;
+        return static_cast<long>(st.st_size);
+    }
+
+    /** Move the files of the tree src to the tree dst, creating the missing
+     *  directories. The files that could not be copied are kept in src.
+     *  \return whether all the files were moved
+     */
+    bool MoveTree (const std::string& src, const std::string& dst)
+    {
+        DIR* dir = opendir(src.c_str());
+        if (!dir) return true; // nothing was staged on this node
+        bool success = amrex::UtilCreateDirectory(dst, 0755);
+
+        while (struct dirent* entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+            if (name == "." || name == ".." || name == ".warpx_staging") continue;
+            const std::string s = src + "/" + name;
+            const std::string d = dst + "/" + name;
+            struct stat st;
+            if (stat(s.c_str(), &st) != 0) continue;
+
+            if (S_ISDIR(st.st_mode)) {
+                success = MoveTree(s, d) && success;
+            } else {
+                {
+                    std::ifstream in(s, std::ios::binary);
+                    std::ofstream out(d, std::ios::binary | std::ios::trunc);
+                    out << in.rdbuf();
+                }
+                if (FileSize(d) == static_cast<long>(st.st_size)) {
+                    std::remove(s.c_str());
+                } else {
+                    std::cerr << "StagedOutput: could not copy " << s << " to " << d
+                              << ", the staged file is kept\n";
+                    success = false;
+                }
+            }
+        }
+        closedir(dir);
+        rmdir(src.c_str()); // fails, as it should, if a file was kept
+        return success;
+    }
+}
+
+StagedOutput::StagedOutput (const std::string& staging_dir)
+    : m_staging_dir(staging_dir)
+{
+    if (!IsActive()) return;
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!amrex::AsyncOut::UseAsyncOut(),
+        "staging_dir cannot be used with amrex.async_out");
+
+#ifdef AMREX_USE_MPI
+    MPI_Comm node_comm;
+    MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED,
+                        ParallelDescriptor::MyProc(), MPI_INFO_NULL, &node_comm);
+    int node_rank;
+    MPI_Comm_rank(node_comm, &node_rank);
+    MPI_Comm_free(&node_comm);
+    m_is_node_leader = (node_rank == 0);
+#else
+    m_is_node_leader = true;
+#endif
+
+    // The staging directory is either shared by all the nodes, or local to
+    // each node: it is shared if a file created by the I/O processor is seen
+    // by all the node leaders.
+    const std::string marker = m_staging_dir + "/.warpx_staging";
+    if (ParallelDescriptor::IOProcessor()) {
+        if (!amrex::UtilCreateDirectory(m_staging_dir, 0755)) {
+            amrex::CreateDirectoryFailed(m_staging_dir);
+        }
+        std::ofstream ofs(marker);
+    }
+    ParallelDescriptor::Barrier();
+    int not_seen = 0;
+    if (m_is_node_leader) {
+        if (!amrex::UtilCreateDirectory(m_staging_dir, 0755)) {
+            amrex::CreateDirectoryFailed(m_staging_dir);
+        }
+        not_seen = (FileSize(marker) < 0) ? 1 : 0;
+    }
+    ParallelDescriptor::ReduceIntMax(not_seen);
+    m_is_shared = (not_seen == 0);
+    m_sees_io_dirs = m_is_shared || (FileSize(marker) >= 0);
+
+    if (m_is_shared) {
+        // a single rank moves the dumps
+        m_is_node_leader = ParallelDescriptor::IOProcessor();
+    } else {
+        // Each file written by a rank must stay on its node, while by default
+        // several ranks, possibly on different nodes, write one after the
+        // other to the same file.
+        VisMF::SetNOutFiles(ParallelDescriptor::NProcs());
+        ParmParse pp_particles("particles");
+        pp_particles.add("particles_nfiles", -1);
+    }
+}
+
+StagedOutput::~StagedOutput ()
+{
+    if (m_drain.valid()) m_drain.wait();
+}
+
+std::string
+StagedOutput::Path (const std::string& name) const
+{
+    return IsActive() ? m_staging_dir + "/" + name : name;
+}
+
+void
+StagedOutput::CreateDirectories (const std::string& name, int nlev,
+                                 const amrex::Vector<std::string>& subdirs) const
+{
+    if (!IsActive()) return;
+
+    // The I/O processor creates the directories. On the nodes that do not see
+    // them, they are created by the node leader before the dump.
+    if (m_is_node_leader && !m_sees_io_dirs) {
+        const std::string path = Path(name);
+        for (auto const& subdir : subdirs) {
+            const std::string dir = subdir.empty() ? path : path + "/" + subdir;
+            for (int lev = 0; lev < nlev; ++lev) {
+                const std::string level_dir = dir + "/" + amrex::Concatenate(default_level_prefix, lev, 1);
+                if (!amrex::UtilCreateDirectory(level_dir, 0755)) {
+                    amrex::CreateDirectoryFailed(level_dir);
+                }
+            }
+        }
+    }
+    ParallelDescriptor::Barrier();
+}
+
+void
+StagedOutput::Drain (const std::string& name) const
+{
+    if (!IsActive()) return;
+
+    // all the files of the dump are written
+    ParallelDescriptor::Barrier();
+
+    if (m_is_node_leader) {
+        // one dump at a time is moved
+        if (m_drain.valid()) m_drain.wait();
+        const std::string src = Path(name);
+        m_drain = std::async(std::launch::async, [src, name] () {
+            if (!MoveTree(src, name)) {
+                std::cerr << "StagedOutput: " << name << " is incomplete, see the files kept in "
+                          << src << "\n";
+            }
+        });
+    }
+}
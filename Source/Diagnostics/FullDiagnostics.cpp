@@ -11,6 +11,7 @@
 #include "FlushFormats/FlushFormatPlotfile.H"
 #include "FlushFormats/FlushFormatCheckpoint.H"
 #include "FlushFormats/FlushFormatAscent.H"
+#include "Utils/ColdFields.H"
 #ifdef WARPX_USE_OPENPMD
 #    include "FlushFormats/FlushFormatOpenPMD.H"
 #endif
@@ -78,6 +79,19 @@ FullDiagnostics::ReadParameters ()
     // Number of buffers = 1 for FullDiagnostics.
     // It is used to allocate the number of output multi-level MultiFab, m_mf_output
     m_num_buffers = 1;
+
+    // diag_lo = diag_hi in a dimension requests a slice, see InitializeFieldBufferData
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        if (m_lo[idim] == m_hi[idim]) m_slice_dims[idim] = 1;
+    }
+    if (m_slice_dims.max() > 0) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            m_format == "plotfile" || m_format == "openpmd",
+            "A slice (<diag>.diag_lo = <diag>.diag_hi in a dimension) can only be written "
+            "with <diag>.format = plotfile or openpmd");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_plot_raw_fields && !m_plot_raw_rho,
+            "The raw fields cannot be written for a slice");
+    }
 }
 
 void
@@ -121,6 +135,64 @@ FullDiagnostics::DoDump (int step, int /*i_buffer*/, bool force_flush)
     return false;
 }
 
+void
+FullDiagnostics::ComputeAndPack ()
+{
+    if (m_slice_dims.max() == 0) {
+        Diagnostics::ComputeAndPack();
+        return;
+    }
+    PrepareFieldDataForOutput();
+    ComputeFields(m_mf_slice_src);
+    InterpolateSlice();
+}
+
+void
+FullDiagnostics::InterpolateSlice ()
+{
+    amrex::IntVect const slice_dims = m_slice_dims;
+    amrex::GpuArray<amrex::Real, AMREX_SPACEDIM> const slice_weights = m_slice_weights;
+
+    for (int i_buffer = 0; i_buffer < m_num_buffers; ++i_buffer) {
+        for (int lev = 0; lev < nlev_output; ++lev) {
+            amrex::MultiFab& mf_dst = m_mf_output[i_buffer][lev];
+            amrex::MultiFab const& mf_src = m_mf_slice_src[i_buffer][lev];
+            int const ncomp = mf_dst.nComp();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+            for (amrex::MFIter mfi(mf_dst, amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+                amrex::Box const& bx = mfi.tilebox();
+                amrex::Array4<amrex::Real> const& dst = mf_dst.array(mfi);
+                amrex::Array4<amrex::Real const> const& src = mf_src.const_array(mfi);
+                amrex::ParallelFor(bx, ncomp,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+                    {
+                        // Sum over the corners of the cells around the slice: both cells in
+                        // the sliced dimensions, the cell (i,j,k) in the others
+                        amrex::Real value = 0._rt;
+                        for (int corner = 0; corner < (1 << AMREX_SPACEDIM); ++corner) {
+                            int iv[3] = {i, j, k};
+                            amrex::Real weight = 1._rt;
+                            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                                int const upper = (corner >> idim) & 1;
+                                if (slice_dims[idim]) {
+                                    iv[idim] += upper;
+                                    weight *= upper ? slice_weights[idim]
+                                                    : 1._rt - slice_weights[idim];
+                                } else if (upper) {
+                                    weight = 0._rt;
+                                }
+                            }
+                            if (weight != 0._rt) value += weight * src(iv[0], iv[1], iv[2], n);
+                        }
+                        dst(i, j, k, n) = value;
+                    });
+            }
+        }
+    }
+}
+
 bool
 FullDiagnostics::DoComputeAndPack (int step, bool force_flush)
 {
@@ -250,6 +322,20 @@ FullDiagnostics::AddRZModesToOutputNames (const std::string& field, int ncomp){
 }
 
 
+void
+FullDiagnostics::RemakeLevels ()
+{
+    auto & warpx = WarpX::GetInstance();
+    nlev = warpx.finestLevel() + 1;
+    nlev_output = nlev;
+    for (int i_buffer = 0; i_buffer < m_num_buffers; ++i_buffer) {
+        for (int lev = 1; lev < nlev; ++lev) {
+            InitializeFieldFunctors(lev);
+            InitializeFieldBufferData(i_buffer, lev);
+        }
+    }
+}
+
 void
 FullDiagnostics::InitializeFieldBufferData (int i_buffer, int lev ) {
     auto & warpx = WarpX::GetInstance();
@@ -285,6 +371,7 @@ FullDiagnostics::InitializeFieldBufferData (int i_buffer, int lev ) {
         if ( fabs(warpx.Geom(lev).ProbHi(idim) - diag_dom.hi(idim))
                                > warpx.Geom(lev).CellSize(idim) )
              use_warpxba = false;
+        if (m_slice_dims[idim]) use_warpxba = false;
 
         // User-defined value for coarsening should be an integer divisor of
         // blocking factor at level, lev. This assert is not relevant and thus
@@ -317,6 +404,18 @@ FullDiagnostics::InitializeFieldBufferData (int i_buffer, int lev ) {
                     m_crse_ratio[idim]==1, "coarsening ratio in reduced dimension must be 1."
                  );
             }
+            // for a slice, the two cells whose centers are on each side of the slice
+            if (m_slice_dims[idim]) {
+                AMREX_ALWAYS_ASSERT_WITH_MESSAGE(lev == 0 && nmax_lev == 1,
+                    "A slice cannot be written with mesh refinement");
+                const amrex::Real dx = warpx.Geom(lev).CellSize(idim);
+                const amrex::Real x_cell = (diag_dom.lo(idim) - warpx.Geom(lev).ProbLo(idim)) / dx;
+                lo[idim] = static_cast<int>( floor( x_cell - 0.5_rt ) );
+                lo[idim] = std::max( std::min( lo[idim],
+                                     warpx.Geom(lev).Domain().bigEnd(idim) - 1 ), 0 );
+                hi[idim] = lo[idim] + 1;
+                m_slice_weights[idim] = std::max( std::min( x_cell - 0.5_rt - lo[idim], 1._rt ), 0._rt );
+            }
         }
 
         // Box for the output MultiFab corresponding to the user-defined physical co-ordinates at lev.
@@ -347,10 +446,37 @@ FullDiagnostics::InitializeFieldBufferData (int i_buffer, int lev ) {
     // Generate a new distribution map if the physical m_lo and m_hi for the output
     // is different from the lo and hi physical co-ordinates of the simulation domain.
     if (use_warpxba == false) dmap = amrex::DistributionMapping{ba};
+    const amrex::MFInfo output_info = m_cold_output ? ColdFields::Info() : amrex::MFInfo();
+    if (m_slice_dims.max() > 0) {
+        // The fields are computed on the two cells around the slice, and interpolated in
+        // m_mf_output, which has one cell at the lower of them in the sliced dimensions
+        m_mf_slice_src.resize( m_num_buffers );
+        m_mf_slice_src[i_buffer].resize( nmax_lev );
+        m_mf_slice_src[i_buffer][lev] = amrex::MultiFab(ba, dmap, m_varnames.size(), 0,
+                                                        output_info);
+        amrex::BoxList slice_bl;
+        for (int i = 0; i < static_cast<int>(ba.size()); ++i) {
+            amrex::Box b = ba[i];
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                if (m_slice_dims[idim]) b.setBig(idim, b.smallEnd(idim));
+            }
+            slice_bl.push_back(b);
+        }
+        ba = amrex::BoxArray(std::move(slice_bl));
+        // The output cell is centered on the slice
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (!m_slice_dims[idim]) continue;
+            const amrex::Real dx = warpx.Geom(lev).CellSize(idim);
+            const amrex::Real x_slice = diag_dom.lo(idim) + (0.5_rt + m_slice_weights[idim]) * dx;
+            diag_dom.setLo(idim, x_slice - 0.5_rt * dx);
+            diag_dom.setHi(idim, x_slice + 0.5_rt * dx);
+        }
+    }
     // Allocate output MultiFab for diagnostics. The data will be stored at cell-centers.
     int ngrow = (m_format == "sensei" || m_format == "ascent") ? 1 : 0;
     // The zero is hard-coded since the number of output buffers = 1 for FullDiagnostics
-    m_mf_output[i_buffer][lev] = amrex::MultiFab(ba, dmap, m_varnames.size(), ngrow);
+    m_mf_output[i_buffer][lev] = amrex::MultiFab(ba, dmap, m_varnames.size(), ngrow,
+                                                 output_info);
 
 
     if (lev == 0) {
@@ -15,6 +15,8 @@ MultiDiagnostics::MultiDiagnostics ()
             alldiags[i] = std::make_unique<FullDiagnostics>(i, diags_names[i]);
         } else if ( diags_types[i] == DiagTypes::BackTransformed ){
             alldiags[i] = std::make_unique<BTDiagnostics>(i, diags_names[i]);
+        } else if ( diags_types[i] == DiagTypes::TimeAveraged ){
+            alldiags[i] = std::make_unique<TimeAveragedDiagnostics>(i, diags_names[i]);
         } else {
             amrex::Abort("Unknown diagnostic type");
         }
@@ -38,6 +40,14 @@ MultiDiagnostics::InitializeFieldFunctors ( int lev )
     }
 }
 
+void
+MultiDiagnostics::RemakeLevels ()
+{
+    for( auto& diag : alldiags ){
+        diag->RemakeLevels();
+    }
+}
+
 void
 MultiDiagnostics::ReadParameters ()
 {
@@ -57,6 +67,7 @@ MultiDiagnostics::ReadParameters ()
         pp_diag_name.get("diag_type", diag_type_str);
         if (diag_type_str == "Full") diags_types[i] = DiagTypes::Full;
         if (diag_type_str == "BackTransformed") diags_types[i] = DiagTypes::BackTransformed;
+        if (diag_type_str == "TimeAveraged") diags_types[i] = DiagTypes::TimeAveraged;
     }
 }
 
@@ -75,3 +86,13 @@ MultiDiagnostics::NewIteration ()
         diag->NewIteration();
     }
 }
+
+amrex::Long
+MultiDiagnostics::MemoryBytes (int lev) const
+{
+    amrex::Long nbytes = 0;
+    for( auto const& diag : alldiags ){
+        nbytes += diag->MemoryBytes(lev);
+    }
+    return nbytes;
+}
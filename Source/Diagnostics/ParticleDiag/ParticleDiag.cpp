@@ -1,8 +1,12 @@
 #include "WarpX.H"
 #include "ParticleDiag.H"
 #include "Utils/WarpXUtil.H"
+#include "Utils/WarpXProfilerWrapper.H"
+#include "Particles/Filter/FilterFunctors.H"
 
+#include <AMReX_GpuContainers.H>
 #include <AMReX_ParmParse.H>
+#include <AMReX_Scan.H>
 
 using namespace amrex;
 
@@ -79,3 +83,106 @@ ParticleDiag::ParticleDiag(std::string diag_name, std::string name, WarpXParticl
             makeParser(function_string,{"t","x","y","z","ux","uy","uz"}));
     }
 }
+
+void
+ParticleDiag::FilterAndPack (PinnedParticleContainer& tmp) const
+{
+    WARPX_PROFILE("ParticleDiag::FilterAndPack()");
+
+    RandomFilter const random_filter(m_do_random_filter, m_random_fraction);
+    UniformFilter const uniform_filter(m_do_uniform_filter, m_uniform_stride);
+    ParserFilter const parser_filter(m_do_parser_filter,
+                                     getParser(m_particle_filter_parser),
+                                     m_pc->getMass());
+    GeometryFilter const geometry_filter(m_do_geom_filter, m_diag_domain);
+    const bool do_random_filter = m_do_random_filter;
+
+    // Components of the particles that are copied, and momenta converted to SI units
+    amrex::GpuArray<int, PIdx::nattribs> copy_comp;
+    for (int j = 0; j < PIdx::nattribs; ++j) copy_comp[j] = plot_flags[j];
+    const ParticleReal factor = m_pc->getMomentumFactorSI();
+    const int n_runtime_real = tmp.NumRuntimeRealComps();
+    const int n_runtime_int = tmp.NumRuntimeIntComps();
+
+    tmp.clearParticles();
+    tmp.resizeData();
+    for (int lev = 0; lev <= m_pc->finestLevel(); ++lev)
+    {
+        // The tiles of tmp are defined before the parallel loop
+        for (WarpXParIter pti(*m_pc, lev); pti.isValid(); ++pti) {
+            tmp.DefineAndReturnParticleTile(lev, pti.index(), pti.LocalTileIndex());
+        }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        {
+            Gpu::DeviceVector<int> mask;
+            Gpu::DeviceVector<int> selected;
+
+            for (WarpXParIter pti(*m_pc, lev); pti.isValid(); ++pti)
+            {
+                const int np = static_cast<int>(pti.numParticles());
+                if (np == 0) continue;
+                auto const src = pti.GetParticleTile().getConstParticleTileData();
+
+                // The random filter draws one number per particle, in a separate kernel
+                int* p_mask = nullptr;
+                if (do_random_filter) {
+                    mask.resize(np);
+                    p_mask = mask.dataPtr();
+                    amrex::ParallelForRNG(np,
+                        [=] AMREX_GPU_DEVICE (int i, amrex::RandomEngine const& engine) noexcept
+                        {
+                            p_mask[i] = random_filter(src.getSuperParticle(i), engine);
+                        });
+                }
+
+                // Indices of the selected particles
+                selected.resize(np);
+                int* const AMREX_RESTRICT p_selected = selected.dataPtr();
+                auto is_selected = [=] AMREX_GPU_HOST_DEVICE (int i) -> int
+                {
+                    if (p_mask && !p_mask[i]) return 0;
+                    const SuperParticleType& p = src.getSuperParticle(i);
+                    // the other filters do not draw random numbers
+                    const amrex::RandomEngine engine{};
+                    return uniform_filter(p, engine) * parser_filter(p, engine)
+                        * geometry_filter(p, engine);
+                };
+                const int nselected = amrex::Scan::PrefixSum<int>(np,
+                    [=] AMREX_GPU_DEVICE (int i) -> int { return is_selected(i); },
+                    [=] AMREX_GPU_DEVICE (int i, int const& s)
+                    {
+                        if (is_selected(i)) p_selected[s] = i;
+                    },
+                    amrex::Scan::Type::exclusive);
+
+                // Copy them
+                auto& dst_tile = tmp.GetParticles(lev).at(
+                    std::make_pair(pti.index(), pti.LocalTileIndex()));
+                dst_tile.resize(nselected);
+                auto const dst = dst_tile.getParticleTileData();
+                amrex::ParallelFor(nselected, [=] AMREX_GPU_DEVICE (int k) noexcept
+                {
+                    const int i = p_selected[k];
+                    dst.m_aos[k] = src.m_aos[i];
+                    for (int j = 0; j < PIdx::nattribs; ++j) {
+                        if (!copy_comp[j]) continue;
+                        const bool is_momentum = (j == PIdx::ux) || (j == PIdx::uy) || (j == PIdx::uz);
+                        dst.m_rdata[j][k] = is_momentum ? factor*src.m_rdata[j][i] : src.m_rdata[j][i];
+                    }
+                    for (int j = 0; j < n_runtime_real; ++j) {
+                        dst.m_runtime_rdata[j][k] = src.m_runtime_rdata[j][i];
+                    }
+                    for (int j = 0; j < n_runtime_int; ++j) {
+                        dst.m_runtime_idata[j][k] = src.m_runtime_idata[j][i];
+                    }
+                });
+
+                // This is necessary because of mask and selected
+                amrex::Gpu::synchronize();
+            }
+        }
+    }
+}
@@ -105,6 +105,13 @@ MultiParticleContainer::WriteHeader (std::ostream& os) const
 // Photons are a special case, since particle momentum is defined as
 // (photon_energy/(m_e * c) ) * u, where u is the photon direction (a
 // unit vector).
+ParticleReal
+PhysicalParticleContainer::getMomentumFactorSI () const
+{
+    // Account for the special case of photons
+    return AmIA<PhysicalSpecies::photon>() ? PhysConst::m_e : mass;
+}
+
 void
 PhysicalParticleContainer::ConvertUnits(ConvertDirection convert_direction)
 {
@@ -113,9 +120,7 @@ PhysicalParticleContainer::ConvertUnits(ConvertDirection convert_direction)
     // Compute conversion factor
     auto factor = 1_rt;
 
-    // Account for the special case of photons
-    const auto t_mass =
-        AmIA<PhysicalSpecies::photon>() ? PhysConst::m_e : mass;
+    const auto t_mass = getMomentumFactorSI();
 
     if (convert_direction == ConvertDirection::WarpX_to_SI){
         factor = t_mass;
@@ -6,10 +6,11 @@
  */
 #include "BeamRelevant.H"
 #include "WarpX.H"
+#include "Particles/Pusher/GetAndSetPosition.H"
 #include "Utils/WarpXConst.H"
 
 #include <AMReX_REAL.H>
-#include <AMReX_ParticleReduce.H>
+#include <AMReX_Reduce.H>
 
 #include <iostream>
 #include <cmath>
@@ -109,6 +110,30 @@ BeamRelevant::BeamRelevant (std::string rd_name)
 
 // function that compute beam relevant quantities
 void BeamRelevant::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void BeamRelevant::ComputeDiags
+
+// function that registers the moments of the beam species in the broker
+void BeamRelevant::ComputeLocalDiags (int step, ReductionBroker& broker)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    const auto & mypc = WarpX::GetInstance().GetPartContainer();
+    auto const species_names = mypc.GetSpeciesNames();
+    for (int i_s = 0; i_s < mypc.nSpecies(); ++i_s)
+    {
+        if (species_names[i_s] != m_beam_name) { continue; }
+        WarpX::GetInstance().reduced_diags->m_species_moments.Request(i_s, broker);
+    }
+}
+// end void BeamRelevant::ComputeLocalDiags
+
+// function that computes the beam relevant quantities from the reduced moments,
+// with a second pass over the particles for the moments around the means
+void BeamRelevant::FinishDiags (int step)
 {
 
     // Judge if the diags should be done
@@ -126,13 +151,6 @@ void BeamRelevant::ComputeDiags (int step)
     // inverse of speed of light squared
     Real constexpr inv_c2 = 1.0_rt / (PhysConst::c * PhysConst::c);
 
-    // If 2D-XZ, p.pos(1) is z, rather than p.pos(2).
-#if (defined WARPX_DIM_3D)
-    int const index_z = 2;
-#elif (defined WARPX_DIM_XZ || defined WARPX_DIM_RZ)
-    int const index_z = 1;
-#endif
-
     // loop over species
     for (int i_s = 0; i_s < nSpecies; ++i_s)
     {
@@ -141,21 +159,18 @@ void BeamRelevant::ComputeDiags (int step)
         if (species_names[i_s] != m_beam_name) { continue; }
 
         // get WarpXParticleContainer class object
-        auto const & myspc = mypc.GetParticleContainer(i_s);
+        auto & myspc = mypc.GetParticleContainer(i_s);
 
         // get mass and charge (Real), FIXME actually all here are ParticleReal
         Real const m = myspc.getMass();
         Real const q = myspc.getCharge();
 
-        using PType = typename WarpXParticleContainer::SuperParticleType;
+        // The weight sum and the means are computed in a single pass over the particles,
+        // shared with the other particle reduced diagnostics of this step
+        SpeciesMoments const& moments = WarpX::GetInstance().reduced_diags->m_species_moments.Get(i_s);
 
         // weight sum
-        Real w_sum = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.rdata(PIdx::w); });
-
-        // reduced sum over mpi ranks
-        ParallelDescriptor::ReduceRealSum(w_sum);
+        Real const w_sum = moments.sum[SumIdx::w];
 
         if (w_sum < std::numeric_limits<Real>::min() )
         {
@@ -165,249 +180,86 @@ void BeamRelevant::ComputeDiags (int step)
             return;
         }
 
-#if (defined WARPX_DIM_RZ)
-        // x mean
-        Real x_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.pos(0)*std::cos(p.rdata(PIdx::theta)) * p.rdata(PIdx::w); });
-#else
-        // x mean
-        Real x_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.pos(0) * p.rdata(PIdx::w); });
-#endif
-
-#if (defined WARPX_DIM_3D)
-        // y mean
-        Real y_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.pos(1) * p.rdata(PIdx::w); });
-#elif (defined WARPX_DIM_RZ)
-        // y mean
-        Real y_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.pos(0)*std::sin(p.rdata(PIdx::theta)) * p.rdata(PIdx::w); });
-#endif
-
-        // z mean
-        Real z_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.pos(index_z) * p.rdata(PIdx::w); });
-
-        // ux mean
-        Real ux_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.rdata(PIdx::ux) * p.rdata(PIdx::w); });
-
-        // uy mean
-        Real uy_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.rdata(PIdx::uy) * p.rdata(PIdx::w); });
-
-        // uz mean
-        Real uz_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        { return p.rdata(PIdx::uz) * p.rdata(PIdx::w); });
-
-        // gamma mean
-        Real gm_mean = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
+        Real const x_mean  = moments.sum[SumIdx::wx] / w_sum;
+        Real const y_mean  = moments.sum[SumIdx::wy] / w_sum;
+        Real const z_mean  = moments.sum[SumIdx::wz] / w_sum;
+        Real const ux_mean = moments.sum[SumIdx::wux] / w_sum;
+        Real const uy_mean = moments.sum[SumIdx::wuy] / w_sum;
+        Real const uz_mean = moments.sum[SumIdx::wuz] / w_sum;
+        Real const gm_mean = moments.sum[SumIdx::wgamma] / w_sum;
+
+        // Second moments around the means, in a second pass over the particles:
+        // x, y, z, ux, uy, uz, gamma mean squares, then x*ux, y*uy, z*uz
+        ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+                  ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+        ReduceData<Real, Real, Real, Real, Real,
+                   Real, Real, Real, Real, Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        for (int lev = 0; lev <= myspc.finestLevel(); ++lev)
         {
-            Real ux = p.rdata(PIdx::ux);
-            Real uy = p.rdata(PIdx::uy);
-            Real uz = p.rdata(PIdx::uz);
-            Real us = ux*ux + uy*uy + uz*uz;
-            return std::sqrt(1.0_rt + us*inv_c2) * p.rdata(PIdx::w);
-        });
-
-        // reduced sum over mpi ranks
-        ParallelDescriptor::ReduceRealSum(x_mean);  x_mean  /= w_sum;
-#if (defined WARPX_DIM_3D || defined WARPX_DIM_RZ)
-        ParallelDescriptor::ReduceRealSum(y_mean);  y_mean  /= w_sum;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
-        ParallelDescriptor::ReduceRealSum(z_mean);  z_mean  /= w_sum;
-        ParallelDescriptor::ReduceRealSum(ux_mean); ux_mean /= w_sum;
-        ParallelDescriptor::ReduceRealSum(uy_mean); uy_mean /= w_sum;
-        ParallelDescriptor::ReduceRealSum(uz_mean); uz_mean /= w_sum;
-        ParallelDescriptor::ReduceRealSum(gm_mean); gm_mean /= w_sum;
-
-#if (defined WARPX_DIM_RZ)
-        // x mean square
-        Real x_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const x = p.pos(0)*std::cos(p.rdata(PIdx::theta));
-            Real const a = (x-x_mean) * (x-x_mean);
-            return a * p.rdata(PIdx::w);
-        });
-#else
-        // x mean square
-        Real x_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.pos(0)-x_mean) * (p.pos(0)-x_mean);
-            return a * p.rdata(PIdx::w);
-        });
+            for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti)
+            {
+                const auto GetPosition = GetParticlePosition(pti);
+                auto& attribs = pti.GetAttribs();
+                ParticleReal const * const AMREX_RESTRICT wp = attribs[PIdx::w].dataPtr();
+                ParticleReal const * const AMREX_RESTRICT uxp = attribs[PIdx::ux].dataPtr();
+                ParticleReal const * const AMREX_RESTRICT uyp = attribs[PIdx::uy].dataPtr();
+                ParticleReal const * const AMREX_RESTRICT uzp = attribs[PIdx::uz].dataPtr();
+
+                reduce_op.eval(pti.numParticles(), reduce_data,
+                [=] AMREX_GPU_DEVICE (int i) -> ReduceTuple
+                {
+                    ParticleReal x, y, z;
+                    GetPosition(i, x, y, z);
+#if (defined WARPX_DIM_XZ)
+                    y = 0._prt;
 #endif
-
-#if (defined WARPX_DIM_3D)
-        // y mean square
-        Real y_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.pos(1)-y_mean) * (p.pos(1)-y_mean);
-            return a * p.rdata(PIdx::w);
-        });
-#elif (defined WARPX_DIM_RZ)
-        // y mean square
-        Real y_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const y = p.pos(0)*std::sin(p.rdata(PIdx::theta));
-            Real const a = (y-y_mean) * (y-y_mean);
-            return a * p.rdata(PIdx::w);
-        });
-#endif
-
-        // z mean square
-        Real z_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.pos(index_z)-z_mean) * (p.pos(index_z)-z_mean);
-            return a * p.rdata(PIdx::w);
-        });
-
-        // ux mean square
-        Real ux_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.rdata(PIdx::ux)-ux_mean) *
-                           (p.rdata(PIdx::ux)-ux_mean);
-            return a * p.rdata(PIdx::w);
-        });
-
-        // uy mean square
-        Real uy_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.rdata(PIdx::uy)-uy_mean) *
-                           (p.rdata(PIdx::uy)-uy_mean);
-            return a * p.rdata(PIdx::w);
-        });
-
-        // uz mean square
-        Real uz_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.rdata(PIdx::uz)-uz_mean) *
-                           (p.rdata(PIdx::uz)-uz_mean);
-            return a * p.rdata(PIdx::w);
-        });
-
-        // gamma mean square
-        Real gm_ms = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const ux = p.rdata(PIdx::ux);
-            Real const uy = p.rdata(PIdx::uy);
-            Real const uz = p.rdata(PIdx::uz);
-            Real const us = ux*ux + uy*uy + uz*uz;
-            Real const gm = std::sqrt(1.0_rt + us*inv_c2);
-            Real const a  = (gm - gm_mean) * (gm - gm_mean);
-            return a * p.rdata(PIdx::w);
-        });
-
-#if (defined WARPX_DIM_RZ)
-        // x times ux
-        Real xux = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const x = p.pos(0)*std::cos(p.rdata(PIdx::theta));
-            Real const a = (x-x_mean) * (p.rdata(PIdx::ux)-ux_mean);
-            return a * p.rdata(PIdx::w);
-        });
-#else
-        // x times ux
-        Real xux = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.pos(0)-x_mean) * (p.rdata(PIdx::ux)-ux_mean);
-            return a * p.rdata(PIdx::w);
-        });
-#endif
-
-#if (defined WARPX_DIM_3D)
-        // y times uy
-        Real yuy = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.pos(1)-y_mean) * (p.rdata(PIdx::uy)-uy_mean);
-            return a * p.rdata(PIdx::w);
-        });
-#elif (defined WARPX_DIM_RZ)
-        // y times uy
-        Real yuy = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const y = p.pos(0)*std::sin(p.rdata(PIdx::theta));
-            Real const a = (y-y_mean) * (p.rdata(PIdx::uy)-uy_mean);
-            return a * p.rdata(PIdx::w);
-        });
-#endif
-
-        // z times uz
-        Real zuz = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const a = (p.pos(index_z)-z_mean) * (p.rdata(PIdx::uz)-uz_mean);
-            return a * p.rdata(PIdx::w);
-        });
-
-        // charge
-        Real charge = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            Real const w = p.rdata(PIdx::w);
-            return q * w;
-        });
+                    Real const w = wp[i];
+                    Real const ux = uxp[i];
+                    Real const uy = uyp[i];
+                    Real const uz = uzp[i];
+                    Real const us = ux*ux + uy*uy + uz*uz;
+                    Real const gm = std::sqrt(1.0_rt + us*inv_c2);
+                    Real const dx = x - x_mean;
+                    Real const dy = y - y_mean;
+                    Real const dz = z - z_mean;
+                    Real const dux = ux - ux_mean;
+                    Real const duy = uy - uy_mean;
+                    Real const duz = uz - uz_mean;
+                    Real const dgm = gm - gm_mean;
+                    return {w*dx*dx, w*dy*dy, w*dz*dz, w*dux*dux, w*duy*duy, w*duz*duz,
+                            w*dgm*dgm, w*dx*dux, w*dy*duy, w*dz*duz};
+                });
+            }
+        }
 
         // reduced sum over mpi ranks
-        ParallelDescriptor::ReduceRealSum
-            ( x_ms, ParallelDescriptor::IOProcessorNumber());
-        x_ms /= w_sum;
+        auto const r = reduce_data.value();
+        Real ms[10] = {get<0>(r), get<1>(r), get<2>(r), get<3>(r), get<4>(r),
+                       get<5>(r), get<6>(r), get<7>(r), get<8>(r), get<9>(r)};
+        ParallelDescriptor::ReduceRealSum(ms, 10, ParallelDescriptor::IOProcessorNumber());
+
+        Real const x_ms  = ms[0] / w_sum;
 #if (defined WARPX_DIM_3D || defined WARPX_DIM_RZ)
-        ParallelDescriptor::ReduceRealSum
-            ( y_ms, ParallelDescriptor::IOProcessorNumber());
-        y_ms /= w_sum;
+        Real const y_ms  = ms[1] / w_sum;
 #endif
-        ParallelDescriptor::ReduceRealSum
-            ( z_ms, ParallelDescriptor::IOProcessorNumber());
-        z_ms /= w_sum;
-        ParallelDescriptor::ReduceRealSum
-            (ux_ms, ParallelDescriptor::IOProcessorNumber());
-        ux_ms /= w_sum;
-        ParallelDescriptor::ReduceRealSum
-            (uy_ms, ParallelDescriptor::IOProcessorNumber());
-        uy_ms /= w_sum;
-        ParallelDescriptor::ReduceRealSum
-            (uz_ms, ParallelDescriptor::IOProcessorNumber());
-        uz_ms /= w_sum;
-        ParallelDescriptor::ReduceRealSum
-            (gm_ms, ParallelDescriptor::IOProcessorNumber());
-        gm_ms /= w_sum;
-        ParallelDescriptor::ReduceRealSum
-            (   xux, ParallelDescriptor::IOProcessorNumber());
-        xux /= w_sum;
+        Real const z_ms  = ms[2] / w_sum;
+        Real const ux_ms = ms[3] / w_sum;
+        Real const uy_ms = ms[4] / w_sum;
+        Real const uz_ms = ms[5] / w_sum;
+        Real const gm_ms = ms[6] / w_sum;
+        Real const xux   = ms[7] / w_sum;
 #if (defined WARPX_DIM_3D || defined WARPX_DIM_RZ)
-        ParallelDescriptor::ReduceRealSum
-            (   yuy, ParallelDescriptor::IOProcessorNumber());
-        yuy /= w_sum;
+        Real const yuy   = ms[8] / w_sum;
 #endif
-        ParallelDescriptor::ReduceRealSum
-            (   zuz, ParallelDescriptor::IOProcessorNumber());
-        zuz /= w_sum;
-        ParallelDescriptor::ReduceRealSum
-            ( charge, ParallelDescriptor::IOProcessorNumber());
+        Real const zuz   = ms[9] / w_sum;
+
+        // charge
+        Real const charge = q * w_sum;
 
         // save data
 #if (defined WARPX_DIM_3D || defined WARPX_DIM_RZ)
@@ -451,4 +303,4 @@ void BeamRelevant::ComputeDiags (int step)
     // end loop over species
 
 }
-// end void BeamRelevant::ComputeDiags
+// end void BeamRelevant::FinishDiags
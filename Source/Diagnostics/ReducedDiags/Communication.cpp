@@ -0,0 +1,115 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "Communication.H"
+#include "Parallelization/CommStats.H"
+
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+// constructor
+Communication::Communication (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+    // the exchanges are counted from now on
+    CommStats::Enable();
+    m_last_calls = CommStats::Calls();
+    m_last_bytes = CommStats::Bytes();
+    m_last_messages = CommStats::Messages();
+    m_last_times = CommStats::Times();
+
+    const Vector<std::string> names = CommStats::Names();
+    const int nSites = names.size();
+
+    // resize data array: calls, bytes, messages and time of each site
+    m_data.resize(4*nSites, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            constexpr int shift = 3;
+            const Vector<std::string> quantities = {"calls()", "bytes(B)", "messages()", "time(s)"};
+            for (int i = 0; i < nSites; ++i)
+            {
+                for (int q = 0; q < 4; ++q)
+                {
+                    ofs << m_sep;
+                    ofs << "[" + std::to_string(shift+4*i+q) + "]";
+                    ofs << names[i] + "_" + quantities[q];
+                }
+            }
+            ofs << std::endl;
+
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the communication per step of each call site
+void Communication::ComputeDiags (int step)
+{
+    ++m_steps;
+
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // counters since the last output on this rank
+    const Vector<Long> calls = CommStats::Calls();
+    const Vector<Long> bytes = CommStats::Bytes();
+    const Vector<Long> messages = CommStats::Messages();
+    const Vector<Real> times = CommStats::Times();
+    const int nSites = calls.size();
+    Vector<Long> counts(3*nSites);
+    Vector<Real> tmax(nSites);
+    for (int i = 0; i < nSites; ++i)
+    {
+        counts[3*i]   = calls[i] - m_last_calls[i];
+        counts[3*i+1] = bytes[i] - m_last_bytes[i];
+        counts[3*i+2] = messages[i] - m_last_messages[i];
+        tmax[i] = times[i] - m_last_times[i];
+    }
+    m_last_calls = calls;
+    m_last_bytes = bytes;
+    m_last_messages = messages;
+    m_last_times = times;
+
+    // the calls are the same on all ranks; sum the bytes and messages, and take the
+    // maximum of the time, over the MPI ranks
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceLongSum(counts.dataPtr(), 3*nSites, ioproc);
+    ParallelDescriptor::ReduceRealMax(tmax.dataPtr(), nSites, ioproc);
+
+    const Real nProcs = static_cast<Real>(ParallelDescriptor::NProcs());
+    const Real nSteps = static_cast<Real>(m_steps);
+    for (int i = 0; i < nSites; ++i)
+    {
+        m_data[4*i]   = static_cast<Real>(counts[3*i]) / nProcs / nSteps;
+        m_data[4*i+1] = static_cast<Real>(counts[3*i+1]) / nSteps;
+        m_data[4*i+2] = static_cast<Real>(counts[3*i+2]) / nSteps;
+        m_data[4*i+3] = tmax[i] / nSteps;
+    }
+    m_steps = 0;
+
+    /* m_data now contains up-to-date values for:
+     *  [calls, bytes, messages and time per step of the exchange of E,
+     *   calls, bytes, messages and time per step of the exchange of B,
+     *   ......,
+     *   calls, bytes, messages and time per step of the other exchanges] */
+}
+// end void Communication::ComputeDiags
@@ -10,14 +10,46 @@
 #include "Utils/WarpXConst.H"
 
 #include <AMReX_REAL.H>
-#include <AMReX_ParticleReduce.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_iMultiFab.H>
 
+#include <array>
 #include <iostream>
 #include <cmath>
+#include <memory>
 
 
 using namespace amrex;
 
+namespace
+{
+    /** \brief Component of a field on one tile, with the owner mask of its points */
+    struct FieldComponentBox
+    {
+        Box bx;
+        Array4<Real const> arr;
+        Array4<int const> owner;
+
+        /** \brief Square of the field at (i,j,k), or 0 if the point is not in the tile or
+         *  is owned by another box (points shared by several boxes are only counted once) */
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        Real Square (int i, int j, int k) const noexcept
+        {
+            if (!bx.contains(IntVect(AMREX_D_DECL(i,j,k))) || !owner(i,j,k)) return 0._rt;
+            Real const f = arr(i,j,k);
+            return f*f;
+        }
+    };
+
+    /** \brief Owner masks of the three components mf */
+    std::array<std::unique_ptr<iMultiFab>,3> OwnerMasks (std::array<MultiFab const*,3> const& mf,
+                                                         Periodicity const& period)
+    {
+        return {mf[0]->OwnerMask(period), mf[1]->OwnerMask(period), mf[2]->OwnerMask(period)};
+    }
+}
+
 // constructor
 FieldEnergy::FieldEnergy (std::string rd_name)
 : ReducedDiags{rd_name}
@@ -35,7 +67,12 @@ FieldEnergy::FieldEnergy (std::string rd_name)
     pp_amr.query("max_level", nLevel);
     nLevel += 1;
 
-    constexpr int noutputs = 3; // total energy, E-field energy and B-field energy
+#ifdef WARPX_MAG_LLG
+    m_do_H = (WarpX::em_solver_medium == MediumForEM::Macroscopic);
+#endif
+
+    // total energy, E-field energy and B-field energy (and H-field energy)
+    const int noutputs = m_do_H ? 4 : 3;
     // resize data array
     m_data.resize(noutputs*nLevel, 0.0_rt);
 
@@ -64,6 +101,11 @@ FieldEnergy::FieldEnergy (std::string rd_name)
                 ofs << m_sep;
                 ofs << "[" + std::to_string(shift_B+noutputs*lev) + "]";
                 ofs << "B_lev"+std::to_string(lev)+"(J)";
+                if (m_do_H) {
+                    ofs << m_sep;
+                    ofs << "[" + std::to_string(shift_B+1+noutputs*lev) + "]";
+                    ofs << "H_lev"+std::to_string(lev)+"(J)";
+                }
             }
             ofs << std::endl;
             // close file
@@ -76,6 +118,13 @@ FieldEnergy::FieldEnergy (std::string rd_name)
 
 // function that computes field energy
 void FieldEnergy::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void FieldEnergy::ComputeDiags
+
+// function that computes the local sums of the squared fields
+void FieldEnergy::ComputeLocalDiags (int step, ReductionBroker& broker)
 {
 
     // Judge if the diags should be done
@@ -87,18 +136,102 @@ void FieldEnergy::ComputeDiags (int step)
     // get number of level
     const auto nLevel = warpx.finestLevel() + 1;
 
+    // sums of E squared, B squared and H squared on each level
+    constexpr int nsums = 3;
+    Vector<Real>& sums = m_sums;
+    sums.assign(nsums*nLevel, 0._rt);
+    bool const do_H = m_do_H;
+
     // loop over refinement levels
     for (int lev = 0; lev < nLevel; ++lev)
     {
 
         // get MultiFab data at lev
-        const MultiFab & Ex = warpx.getEfield(lev,0);
-        const MultiFab & Ey = warpx.getEfield(lev,1);
-        const MultiFab & Ez = warpx.getEfield(lev,2);
-        const MultiFab & Bx = warpx.getBfield(lev,0);
-        const MultiFab & By = warpx.getBfield(lev,1);
-        const MultiFab & Bz = warpx.getBfield(lev,2);
+        std::array<MultiFab const*,3> const E = {&warpx.getEfield(lev,0), &warpx.getEfield(lev,1), &warpx.getEfield(lev,2)};
+        std::array<MultiFab const*,3> const B = {&warpx.getBfield(lev,0), &warpx.getBfield(lev,1), &warpx.getBfield(lev,2)};
+#ifdef WARPX_MAG_LLG
+        std::array<MultiFab const*,3> const H = {&warpx.getHfield(lev,0), &warpx.getHfield(lev,1), &warpx.getHfield(lev,2)};
+#else
+        std::array<MultiFab const*,3> const H = B;
+#endif
+
+        // points shared by several boxes are only counted once, as in MultiFab::norm2
+        Geometry const & geom = warpx.Geom(lev);
+        auto const owner_E = OwnerMasks(E, geom.periodicity());
+        auto const owner_B = OwnerMasks(B, geom.periodicity());
+        std::array<std::unique_ptr<iMultiFab>,3> owner_H;
+        if (do_H) owner_H = OwnerMasks(H, geom.periodicity());
+
+        // all the components are reduced together, in a single pass over the boxes
+        ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum> reduce_op;
+        ReduceData<Real, Real, Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*E[0], TilingIfNotGPU()); mfi.isValid(); ++mfi )
+        {
+            // the tiles of all the components are in the nodal tile
+            const Box box = mfi.nodaltilebox();
+            FieldComponentBox fE[3], fB[3], fH[3];
+            for (int idir = 0; idir < 3; ++idir) {
+                fE[idir] = {mfi.tilebox(E[idir]->ixType().toIntVect()), E[idir]->const_array(mfi), owner_E[idir]->const_array(mfi)};
+                fB[idir] = {mfi.tilebox(B[idir]->ixType().toIntVect()), B[idir]->const_array(mfi), owner_B[idir]->const_array(mfi)};
+                fH[idir] = do_H ? FieldComponentBox{mfi.tilebox(H[idir]->ixType().toIntVect()), H[idir]->const_array(mfi),
+                                                    owner_H[idir]->const_array(mfi)}
+                                : fB[idir];
+            }
+            FieldComponentBox const Ex = fE[0], Ey = fE[1], Ez = fE[2];
+            FieldComponentBox const Bx = fB[0], By = fB[1], Bz = fB[2];
+            FieldComponentBox const Hx = fH[0], Hy = fH[1], Hz = fH[2];
+
+            reduce_op.eval(box, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                Real const E2 = Ex.Square(i,j,k) + Ey.Square(i,j,k) + Ez.Square(i,j,k);
+                Real const B2 = Bx.Square(i,j,k) + By.Square(i,j,k) + Bz.Square(i,j,k);
+                Real const H2 = do_H ? Hx.Square(i,j,k) + Hy.Square(i,j,k) + Hz.Square(i,j,k) : 0._rt;
+                return {E2, B2, H2};
+            });
+        }
+
+        auto const hv = reduce_data.value();
+        sums[lev*nsums+0] = amrex::get<0>(hv);
+        sums[lev*nsums+1] = amrex::get<1>(hv);
+        sums[lev*nsums+2] = amrex::get<2>(hv);
+    }
+    // end loop over refinement levels
+
+    // MPI reduce, for all the levels at once, with the other buffers of the broker
+    broker.Sum(sums.data(), static_cast<int>(sums.size()));
+}
+// end void FieldEnergy::ComputeLocalDiags
+
+// function that computes the field energy from the reduced sums
+void FieldEnergy::FinishDiags (int step)
+{
+
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
 
+    // get number of level
+    const auto nLevel = warpx.finestLevel() + 1;
+
+    // sums of E squared, B squared and H squared on each level, reduced by the broker
+    constexpr int nsums = 3;
+    Vector<Real> const& sums = m_sums;
+
+    const int noutputs = m_do_H ? 4 : 3; // total energy, E-field energy, B-field energy (and H-field energy)
+    constexpr int index_total = 0;
+    constexpr int index_E = 1;
+    constexpr int index_B = 2;
+    constexpr int index_H = 3;
+    for (int lev = 0; lev < nLevel; ++lev)
+    {
         // get cell size
         Geometry const & geom = warpx.Geom(lev);
 #if (AMREX_SPACEDIM == 2)
@@ -107,40 +240,25 @@ void FieldEnergy::ComputeDiags (int step)
         auto dV = geom.CellSize(0) * geom.CellSize(1) * geom.CellSize(2);
 #endif
 
-        // compute E squared
-        Real const tmpEx = Ex.norm2(0,geom.periodicity());
-        Real const tmpEy = Ey.norm2(0,geom.periodicity());
-        Real const tmpEz = Ez.norm2(0,geom.periodicity());
-        Real const Es = tmpEx*tmpEx + tmpEy*tmpEy + tmpEz*tmpEz;
-
-        // compute B squared
-        Real const tmpBx = Bx.norm2(0,geom.periodicity());
-        Real const tmpBy = By.norm2(0,geom.periodicity());
-        Real const tmpBz = Bz.norm2(0,geom.periodicity());
-        Real const Bs = tmpBx*tmpBx + tmpBy*tmpBy + tmpBz*tmpBz;
-
-        constexpr int noutputs = 3; // total energy, E-field energy and B-field energy
-        constexpr int index_total = 0;
-        constexpr int index_E = 1;
-        constexpr int index_B = 2;
-
         // save data
-        m_data[lev*noutputs+index_E] = 0.5_rt * Es * PhysConst::ep0 * dV;
-        m_data[lev*noutputs+index_B] = 0.5_rt * Bs / PhysConst::mu0 * dV;
+        m_data[lev*noutputs+index_E] = 0.5_rt * sums[lev*nsums+0] * PhysConst::ep0 * dV;
+        m_data[lev*noutputs+index_B] = 0.5_rt * sums[lev*nsums+1] / PhysConst::mu0 * dV;
         m_data[lev*noutputs+index_total] = m_data[lev*noutputs+index_E] +
                                            m_data[lev*noutputs+index_B];
-
+        if (m_do_H) {
+            m_data[lev*noutputs+index_H] = 0.5_rt * sums[lev*nsums+2] * PhysConst::mu0 * dV;
+        }
     }
-    // end loop over refinement levels
 
     /* m_data now contains up-to-date values for:
      *  [total field energy at level 0,
      *   electric field energy at level 0,
      *   magnetic field energy at level 0,
+     *   (H field energy at level 0,)
      *   total field energy at level 1,
      *   electric field energy at level 1,
      *   magnetic field energy at level 1,
      *   ......] */
 
 }
-// end void FieldEnergy::ComputeDiags
+// end void FieldEnergy::FinishDiags
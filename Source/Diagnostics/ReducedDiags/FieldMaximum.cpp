@@ -9,8 +9,68 @@
 #include "WarpX.H"
 #include "Utils/CoarsenIO.H"
 
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Reduce.H>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <utility>
+
 using namespace amrex;
 
+namespace
+{
+    /** \brief Components of a vector field on one box and their staggering, to interpolate
+     *  the field to the cell centers */
+    struct VectorFieldBox
+    {
+        Array4<Real const> arr[3];
+        GpuArray<int,3> type[3];
+        int comp[3];
+
+        /** \brief Absolute values of the components and squared norm of the field at the cell center (i,j,k) */
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        void AtCellCenter (int i, int j, int k, Real& vx, Real& vy, Real& vz, Real& v2) const noexcept
+        {
+            const GpuArray<int,3> cellCenteredtype{0,0,0};
+            const GpuArray<int,3> reduction_coarsening_ratio{1,1,1};
+            const Real fx = CoarsenIO::Interp(arr[0], type[0], cellCenteredtype, reduction_coarsening_ratio, i, j, k, comp[0]);
+            const Real fy = CoarsenIO::Interp(arr[1], type[1], cellCenteredtype, reduction_coarsening_ratio, i, j, k, comp[1]);
+            const Real fz = CoarsenIO::Interp(arr[2], type[2], cellCenteredtype, reduction_coarsening_ratio, i, j, k, comp[2]);
+            vx = amrex::Math::abs(fx);
+            vy = amrex::Math::abs(fy);
+            vz = amrex::Math::abs(fz);
+            v2 = fx*fx + fy*fy + fz*fz;
+        }
+    };
+
+    /** \brief VectorFieldBox of the components mf on the box of mfi; the component idir of
+     *  the field is the component idir*comp_stride of mf[idir] (e.g. 1 for M, whose face
+     *  arrays hold the three components) */
+    VectorFieldBox MakeVectorFieldBox (std::array<MultiFab const*,3> const& mf, MFIter const& mfi,
+                                       int const comp_stride)
+    {
+        VectorFieldBox f;
+        for (int idir = 0; idir < 3; ++idir) {
+            f.arr[idir] = mf[idir]->const_array(mfi);
+            for (int i = 0; i < 3; ++i) {
+                f.type[idir][i] = (i < AMREX_SPACEDIM) ? mf[idir]->ixType()[i] : 0;
+            }
+            f.comp[idir] = idir*comp_stride;
+        }
+        return f;
+    }
+
+    /** \brief Copy the elements of the tuple t into the array a */
+    template <typename T, std::size_t... I>
+    void TupleToArray (T const& t, Real* a, std::index_sequence<I...>)
+    {
+        int const dummy[] = {(a[I] = amrex::get<I>(t), 0)...};
+        amrex::ignore_unused(dummy);
+    }
+}
+
 // constructor
 FieldMaximum::FieldMaximum (std::string rd_name)
 : ReducedDiags{rd_name}
@@ -22,15 +82,20 @@ FieldMaximum::FieldMaximum (std::string rd_name)
         "FieldMaximum reduced diagnostics does not work for RZ coordinate.");
 #endif
 
+#ifdef WARPX_MAG_LLG
+    m_do_HM = (WarpX::em_solver_medium == MediumForEM::Macroscopic);
+#endif
+
     // read number of levels
     int nLevel = 0;
     ParmParse pp_amr("amr");
     pp_amr.query("max_level", nLevel);
     nLevel += 1;
 
-    constexpr int noutputs = 8; // total energy, E-field energy and B-field energy
+    // max of Ex,Ey,Ez,|E|,Bx,By,Bz and |B| (and of Hx,Hy,Hz,|H|,Mx,My,Mz and |M|)
+    const int noutputs = m_do_HM ? 16 : 8;
     // resize data array
-    m_data.resize(noutputs*nLevel, 0.0_rt); // max of Ex,Ey,Ez,|E|,Bx,By,Bz and |B|
+    m_data.resize(noutputs*nLevel, 0.0_rt);
 
     if (ParallelDescriptor::IOProcessor())
     {
@@ -43,40 +108,20 @@ FieldMaximum::FieldMaximum (std::string rd_name)
             ofs << "[1]step()";
             ofs << m_sep;
             ofs << "[2]time(s)";
-            constexpr int shift_Ex = 3;
-            constexpr int shift_Ey = 4;
-            constexpr int shift_Ez = 5;
-            constexpr int shift_absE = 6;
-            constexpr int shift_Bx = 7;
-            constexpr int shift_By = 8;
-            constexpr int shift_Bz = 9;
-            constexpr int shift_absB = 10;
+            constexpr int shift = 3;
+            std::string const names[16] = {"max_Ex", "max_Ey", "max_Ez", "max_|E|",
+                                           "max_Bx", "max_By", "max_Bz", "max_|B|",
+                                           "max_Hx", "max_Hy", "max_Hz", "max_|H|",
+                                           "max_Mx", "max_My", "max_Mz", "max_|M|"};
+            std::string const units[4] = {" (V/m)", " (T)", " (A/m)", " (A/m)"};
             for (int lev = 0; lev < nLevel; ++lev)
             {
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_Ex+noutputs*lev) + "]";
-                ofs << "max_Ex_lev"+std::to_string(lev)+" (V/m)";
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_Ey+noutputs*lev) + "]";
-                ofs << "max_Ey_lev"+std::to_string(lev)+" (V/m)";
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_Ez+noutputs*lev) + "]";
-                ofs << "max_Ez_lev"+std::to_string(lev)+" (V/m)";
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_absE+noutputs*lev) + "]";
-                ofs << "max_|E|_lev"+std::to_string(lev)+" (V/m)";
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_Bx+noutputs*lev) + "]";
-                ofs << "max_Bx_lev"+std::to_string(lev)+" (T)";
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_By+noutputs*lev) + "]";
-                ofs << "max_By_lev"+std::to_string(lev)+" (T)";
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_Bz+noutputs*lev) + "]";
-                ofs << "max_Bz_lev"+std::to_string(lev)+" (T)";
-                ofs << m_sep;
-                ofs << "[" + std::to_string(shift_absB+noutputs*lev) + "]";
-                ofs << "max_|B|_lev"+std::to_string(lev)+" (T)";
+                for (int n = 0; n < noutputs; ++n)
+                {
+                    ofs << m_sep;
+                    ofs << "[" + std::to_string(shift+noutputs*lev+n) + "]";
+                    ofs << names[n]+"_lev"+std::to_string(lev)+units[n/4];
+                }
             }
             ofs << std::endl;
             // close file
@@ -89,6 +134,13 @@ FieldMaximum::FieldMaximum (std::string rd_name)
 
 // function that computes maximum field values
 void FieldMaximum::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void FieldMaximum::ComputeDiags
+
+// function that computes the local maxima of the fields
+void FieldMaximum::ComputeLocalDiags (int step, ReductionBroker& broker)
 {
     // Judge if the diags should be done
     if (!m_intervals.contains(step+1)) { return; }
@@ -99,192 +151,101 @@ void FieldMaximum::ComputeDiags (int step)
     // get number of level
     const auto nLevel = warpx.finestLevel() + 1;
 
+    // for each field, max of the three components and of the squared norm
+    const int noutputs = m_do_HM ? 16 : 8;
+    std::fill(m_data.begin(), m_data.end(), 0._rt);
+
     // loop over refinement levels
     for (int lev = 0; lev < nLevel; ++lev)
     {
 
         // get MultiFab data at lev
-        const MultiFab & Ex = warpx.getEfield(lev,0);
-        const MultiFab & Ey = warpx.getEfield(lev,1);
-        const MultiFab & Ez = warpx.getEfield(lev,2);
-        const MultiFab & Bx = warpx.getBfield(lev,0);
-        const MultiFab & By = warpx.getBfield(lev,1);
-        const MultiFab & Bz = warpx.getBfield(lev,2);
-
-        constexpr int noutputs = 8; // max of Ex,Ey,Ez,|E|,Bx,By,Bz and |B|
-        constexpr int index_Ex = 0;
-        constexpr int index_Ey = 1;
-        constexpr int index_Ez = 2;
-        constexpr int index_absE = 3;
-        constexpr int index_Bx = 4;
-        constexpr int index_By = 5;
-        constexpr int index_Bz = 6;
-        constexpr int index_absB = 7;
-
-        // General preparation of interpolation and reduction operations
-        const GpuArray<int,3> cellCenteredtype{0,0,0};
-        const GpuArray<int,3> reduction_coarsening_ratio{1,1,1};
-        constexpr int reduction_comp = 0;
-
-        ReduceOps<ReduceOpMax> reduceEx_op;
-        ReduceOps<ReduceOpMax> reduceEy_op;
-        ReduceOps<ReduceOpMax> reduceEz_op;
-        ReduceOps<ReduceOpMax> reduceBx_op;
-        ReduceOps<ReduceOpMax> reduceBy_op;
-        ReduceOps<ReduceOpMax> reduceBz_op;
-        ReduceOps<ReduceOpMax> reduceE_op;
-        ReduceOps<ReduceOpMax> reduceB_op;
-
-        ReduceData<Real> reduceEx_data(reduceEx_op);
-        ReduceData<Real> reduceEy_data(reduceEy_op);
-        ReduceData<Real> reduceEz_data(reduceEz_op);
-        ReduceData<Real> reduceBx_data(reduceBx_op);
-        ReduceData<Real> reduceBy_data(reduceBy_op);
-        ReduceData<Real> reduceBz_data(reduceBz_op);
-        ReduceData<Real> reduceE_data(reduceE_op);
-        ReduceData<Real> reduceB_data(reduceB_op);
-
-        using ReduceTuple = typename decltype(reduceEx_data)::Type;
-
-        // Prepare interpolation of field components to cell center
-        GpuArray<int,3> Extype;
-        GpuArray<int,3> Eytype;
-        GpuArray<int,3> Eztype;
-        GpuArray<int,3> Bxtype;
-        GpuArray<int,3> Bytype;
-        GpuArray<int,3> Bztype;
-        for (int i = 0; i < AMREX_SPACEDIM; ++i){
-            Extype[i] = Ex.ixType()[i];
-            Eytype[i] = Ey.ixType()[i];
-            Eztype[i] = Ez.ixType()[i];
-            Bxtype[i] = Bx.ixType()[i];
-            Bytype[i] = By.ixType()[i];
-            Bztype[i] = Bz.ixType()[i];
-        }
-#if   (AMREX_SPACEDIM == 2)
-        Extype[2] = 0;
-        Eytype[2] = 0;
-        Eztype[2] = 0;
-        Bxtype[2] = 0;
-        Bytype[2] = 0;
-        Bztype[2] = 0;
+        std::array<MultiFab const*,3> const E = {&warpx.getEfield(lev,0), &warpx.getEfield(lev,1), &warpx.getEfield(lev,2)};
+        std::array<MultiFab const*,3> const B = {&warpx.getBfield(lev,0), &warpx.getBfield(lev,1), &warpx.getBfield(lev,2)};
+
+        // all the fields are reduced together, in a single pass over the boxes
+#ifdef WARPX_MAG_LLG
+        std::array<MultiFab const*,3> const H = {&warpx.getHfield(lev,0), &warpx.getHfield(lev,1), &warpx.getHfield(lev,2)};
+        std::array<MultiFab const*,3> const M = {&warpx.getMfield(lev,0), &warpx.getMfield(lev,1), &warpx.getMfield(lev,2)};
+        bool const do_HM = m_do_HM;
+
+        ReduceOps<ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax,
+                  ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax,
+                  ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax,
+                  ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax> reduce_op;
+        ReduceData<Real, Real, Real, Real, Real, Real, Real, Real,
+                   Real, Real, Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
+        constexpr int ntuple = 16;
+#else
+        ReduceOps<ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax,
+                  ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax> reduce_op;
+        ReduceData<Real, Real, Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
+        constexpr int ntuple = 8;
 #endif
+        using ReduceTuple = typename decltype(reduce_data)::Type;
 
         // MFIter loop to interpolate fields to cell center and get maximum values
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
-        for ( MFIter mfi(Ex, TilingIfNotGPU()); mfi.isValid(); ++mfi )
+        for ( MFIter mfi(*E[0], TilingIfNotGPU()); mfi.isValid(); ++mfi )
         {
             // Make the box cell centered to avoid including ghost cells in the calculation
             const Box& box = enclosedCells(mfi.nodaltilebox());
-            const auto& arrEx = Ex[mfi].array();
-            const auto& arrEy = Ey[mfi].array();
-            const auto& arrEz = Ez[mfi].array();
-            const auto& arrBx = Bx[mfi].array();
-            const auto& arrBy = By[mfi].array();
-            const auto& arrBz = Bz[mfi].array();
-
-            reduceEx_op.eval(box, reduceEx_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Ex_interp = CoarsenIO::Interp(arrEx, Extype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Ex_interp);
-            });
-            reduceEy_op.eval(box, reduceEy_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Ey_interp = CoarsenIO::Interp(arrEy, Eytype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Ey_interp);
-            });
-            reduceEz_op.eval(box, reduceEz_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Ez_interp = CoarsenIO::Interp(arrEz, Eztype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Ez_interp);
-            });
-            reduceBx_op.eval(box, reduceBx_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Bx_interp = CoarsenIO::Interp(arrBx, Bxtype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Bx_interp);
-            });
-            reduceBy_op.eval(box, reduceBy_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real By_interp = CoarsenIO::Interp(arrBy, Bytype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(By_interp);
-            });
-            reduceBz_op.eval(box, reduceBz_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Bz_interp = CoarsenIO::Interp(arrBz, Bztype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return amrex::Math::abs(Bz_interp);
-            });
-            reduceE_op.eval(box, reduceE_data,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
-            {
-                const Real Ex_interp = CoarsenIO::Interp(arrEx, Extype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                const Real Ey_interp = CoarsenIO::Interp(arrEy, Eytype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                const Real Ez_interp = CoarsenIO::Interp(arrEz, Eztype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return Ex_interp*Ex_interp + Ey_interp*Ey_interp + Ez_interp*Ez_interp;
-            });
-            reduceB_op.eval(box, reduceB_data,
+            VectorFieldBox const fE = MakeVectorFieldBox(E, mfi, 0);
+            VectorFieldBox const fB = MakeVectorFieldBox(B, mfi, 0);
+#ifdef WARPX_MAG_LLG
+            VectorFieldBox const fH = do_HM ? MakeVectorFieldBox(H, mfi, 0) : fE;
+            VectorFieldBox const fM = do_HM ? MakeVectorFieldBox(M, mfi, 1) : fE;
+#endif
+
+            reduce_op.eval(box, reduce_data,
             [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
             {
-                const Real Bx_interp = CoarsenIO::Interp(arrBx, Bxtype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                const Real By_interp = CoarsenIO::Interp(arrBy, Bytype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                const Real Bz_interp = CoarsenIO::Interp(arrBz, Bztype, cellCenteredtype,
-                                        reduction_coarsening_ratio, i, j, k, reduction_comp);
-                return Bx_interp*Bx_interp + By_interp*By_interp + Bz_interp*Bz_interp;
+                Real Ex, Ey, Ez, E2, Bx, By, Bz, B2;
+                fE.AtCellCenter(i, j, k, Ex, Ey, Ez, E2);
+                fB.AtCellCenter(i, j, k, Bx, By, Bz, B2);
+#ifdef WARPX_MAG_LLG
+                Real Hx = 0._rt, Hy = 0._rt, Hz = 0._rt, H2 = 0._rt;
+                Real Mx = 0._rt, My = 0._rt, Mz = 0._rt, M2 = 0._rt;
+                if (do_HM) {
+                    fH.AtCellCenter(i, j, k, Hx, Hy, Hz, H2);
+                    fM.AtCellCenter(i, j, k, Mx, My, Mz, M2);
+                }
+                return {Ex, Ey, Ez, E2, Bx, By, Bz, B2, Hx, Hy, Hz, H2, Mx, My, Mz, M2};
+#else
+                return {Ex, Ey, Ez, E2, Bx, By, Bz, B2};
+#endif
             });
         }
 
-        Real hv_Ex = amrex::get<0>(reduceEx_data.value()); // highest value of |Ex|
-        Real hv_Ey = amrex::get<0>(reduceEy_data.value()); // highest value of |Ey|
-        Real hv_Ez = amrex::get<0>(reduceEz_data.value()); // highest value of |Ez|
-        Real hv_Bx = amrex::get<0>(reduceBx_data.value()); // highest value of |Bx|
-        Real hv_By = amrex::get<0>(reduceBy_data.value()); // highest value of |By|
-        Real hv_Bz = amrex::get<0>(reduceBz_data.value()); // highest value of |Bz|
-        Real hv_E = amrex::get<0>(reduceE_data.value()); // highest value of |E|**2
-        Real hv_B = amrex::get<0>(reduceB_data.value()); // highest value of |B|**2
-
-        // MPI reduce
-        ParallelDescriptor::ReduceRealMax(hv_Ex);
-        ParallelDescriptor::ReduceRealMax(hv_Ey);
-        ParallelDescriptor::ReduceRealMax(hv_Ez);
-        ParallelDescriptor::ReduceRealMax(hv_Bx);
-        ParallelDescriptor::ReduceRealMax(hv_By);
-        ParallelDescriptor::ReduceRealMax(hv_Bz);
-        ParallelDescriptor::ReduceRealMax(hv_E);
-        ParallelDescriptor::ReduceRealMax(hv_B);
-
-        // Fill output array
-        m_data[lev*noutputs+index_Ex] = hv_Ex;
-        m_data[lev*noutputs+index_Ey] = hv_Ey;
-        m_data[lev*noutputs+index_Ez] = hv_Ez;
-        m_data[lev*noutputs+index_Bx] = hv_Bx;
-        m_data[lev*noutputs+index_By] = hv_By;
-        m_data[lev*noutputs+index_Bz] = hv_Bz;
-        m_data[lev*noutputs+index_absE] = std::sqrt(hv_E);
-        m_data[lev*noutputs+index_absB] = std::sqrt(hv_B);
+        Real hv[ntuple];
+        TupleToArray(reduce_data.value(), hv, std::make_index_sequence<ntuple>());
+        std::copy(hv, hv + noutputs, m_data.begin() + lev*noutputs);
     }
     // end loop over refinement levels
 
+    // MPI reduce, for all the levels at once, with the other buffers of the broker
+    broker.Max(m_data.data(), static_cast<int>(m_data.size()));
+}
+// end void FieldMaximum::ComputeLocalDiags
+
+// function that computes the norms from the reduced maxima
+void FieldMaximum::FinishDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // the squared norms are reduced, and their square root taken once
+    for (int n = 3; n < static_cast<int>(m_data.size()); n += 4) {
+        m_data[n] = std::sqrt(m_data[n]);
+    }
+
     /* m_data now contains up-to-date values for:
      *  [max(Ex),max(Ey),max(Ez),max(|E|),
-     *   max(Bx),max(By),max(Bz),max(|B|)] */
+     *   max(Bx),max(By),max(Bz),max(|B|)
+     *   (,max(Hx),max(Hy),max(Hz),max(|H|),
+     *   max(Mx),max(My),max(Mz),max(|M|))] */
 
 }
-// end void FieldMaximum::ComputeDiags
+// end void FieldMaximum::FinishDiags
@@ -0,0 +1,94 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "LLGIterations.H"
+#include "WarpX.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+// constructor
+LLGIterations::LLGIterations (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#ifndef WARPX_MAG_LLG
+    amrex::Abort("LLGIterations reduced diagnostics requires USE_LLG=TRUE");
+#endif
+
+    // read number of levels
+    int nLevel = 0;
+    ParmParse pp_amr("amr");
+    pp_amr.query("max_level", nLevel);
+    nLevel += 1;
+
+    // resize data array
+    m_data.resize(2*nLevel, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            constexpr int shift = 3;
+            for (int lev = 0; lev < nLevel; ++lev)
+            {
+                ofs << m_sep;
+                ofs << "[" + std::to_string(shift+2*lev) + "]";
+                ofs << "iterations_lev"+std::to_string(lev)+"()";
+                ofs << m_sep;
+                ofs << "[" + std::to_string(shift+2*lev+1) + "]";
+                ofs << "calls_lev"+std::to_string(lev)+"()";
+            }
+            ofs << std::endl;
+
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that gets the iteration counts of the 2nd-order LLG scheme
+void LLGIterations::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+#ifdef WARPX_MAG_LLG
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
+
+    // get number of level
+    const auto nLevel = warpx.finestLevel() + 1;
+
+    // loop over refinement levels
+    for (int lev = 0; lev < nLevel; ++lev)
+    {
+        FiniteDifferenceSolver const * fdtd_solver = warpx.get_pointer_fdtd_solver_fp(lev);
+
+        // the iteration counts are the same on all MPI ranks, no reduction is needed
+        m_data[2*lev]   = (fdtd_solver) ? static_cast<amrex::Real>(fdtd_solver->LLGIterationCount()) : 0._rt;
+        m_data[2*lev+1] = (fdtd_solver) ? static_cast<amrex::Real>(fdtd_solver->LLGIterationCalls()) : 0._rt;
+    }
+    // end loop over refinement levels
+#endif
+
+    /* m_data now contains up-to-date values for:
+     *  [iterations at level 0, calls at level 0,
+     *   iterations at level 1, calls at level 1,
+     *   ......] */
+}
+// end void LLGIterations::ComputeDiags
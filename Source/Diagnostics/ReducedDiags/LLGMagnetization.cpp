@@ -0,0 +1,308 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "LLGMagnetization.H"
+#include "WarpX.H"
+#include "Utils/CoarsenIO.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_iMultiFab.H>
+
+using namespace amrex;
+
+namespace
+{
+    constexpr int noutputs = 7; // <Mx>, <My>, <Mz>, max deviation, max torque, Zeeman and demagnetizing energies
+    constexpr int nsums = 6; // number of magnetic faces, sums of Mx, My, Mz, M.H_bias and M.H
+    constexpr int nmaxs = 2; // max deviation and max torque
+
+#ifdef WARPX_MAG_LLG
+    // number of magnetic faces, sums of Mx, My, Mz, M.H_bias and M.H, max deviation and max torque
+    using MagReduceTuple = GpuTuple<Real, Real, Real, Real, Real, Real, Real, Real>;
+
+    /** \brief Contribution of the face (i,j,k) of M_face to the reduction, zero on the
+     *  non-magnetic faces and on the faces owned by another box
+     *
+     * \param[in] face         staggering of the faces of M_face, e.g. IntVect(1,0,0) for the x-faces
+     * \param[in] M_face       M on the faces, with 3 components
+     * \param[in] owner        owner mask of M_face
+     * \param[in] Ms, Ms_stag  cell-centered Ms and its staggering
+     * \param[in] M_stag       staggering of M_face
+     * \param[in] macro_cr     coarsening ratio of the interpolation of Ms to the faces
+     * \param[in] Hx, Hy, Hz   components of H, each on its own faces
+     * \param[in] Hx_bias, Hy_bias, Hz_bias components of H_bias, each on its own faces
+     * \param[in] coupling     if 1, H_eff includes H (warpx.mag_LLG_coupling)
+     */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    MagReduceTuple MagFaceReduce (int i, int j, int k, IntVect const& face,
+                                  Array4<Real const> const& M_face, Array4<int const> const& owner,
+                                  MacroPropertyArray const& Ms, GpuArray<int,3> const& Ms_stag,
+                                  GpuArray<int,3> const& M_stag, GpuArray<int,3> const& macro_cr,
+                                  Array4<Real> const& Hx, Array4<Real> const& Hy, Array4<Real> const& Hz,
+                                  HBiasComponent const& Hx_bias, HBiasComponent const& Hy_bias, HBiasComponent const& Hz_bias,
+                                  int coupling)
+    {
+        Real const Ms_face = CoarsenIO::Interp(Ms, Ms_stag, M_stag, macro_cr, i, j, k, 0);
+        if (!owner(i, j, k) || !(Ms_face > 0._rt)) {
+            return {0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt, 0._rt};
+        }
+
+        Real const Mx = M_face(i, j, k, 0);
+        Real const My = M_face(i, j, k, 1);
+        Real const Mz = M_face(i, j, k, 2);
+
+        // H and H_bias interpolated to the faces of M, as in the LLG kernels
+        Real const Hx_b = MacroscopicProperties::face_avg_to_face(i, j, k, 0, IntVect(1, 0, 0), face, Hx_bias);
+        Real const Hy_b = MacroscopicProperties::face_avg_to_face(i, j, k, 0, IntVect(0, 1, 0), face, Hy_bias);
+        Real const Hz_b = MacroscopicProperties::face_avg_to_face(i, j, k, 0, IntVect(0, 0, 1), face, Hz_bias);
+        Real const Hx_f = MacroscopicProperties::face_avg_to_face(i, j, k, 0, IntVect(1, 0, 0), face, Hx);
+        Real const Hy_f = MacroscopicProperties::face_avg_to_face(i, j, k, 0, IntVect(0, 1, 0), face, Hy);
+        Real const Hz_f = MacroscopicProperties::face_avg_to_face(i, j, k, 0, IntVect(0, 0, 1), face, Hz);
+
+        Real const Hx_eff = (coupling == 1) ? Hx_b + Hx_f : Hx_b;
+        Real const Hy_eff = (coupling == 1) ? Hy_b + Hy_f : Hy_b;
+        Real const Hz_eff = (coupling == 1) ? Hz_b + Hz_f : Hz_b;
+
+        Real const deviation = amrex::Math::abs(std::sqrt(Mx*Mx + My*My + Mz*Mz) / Ms_face - 1._rt);
+
+        Real const Tx = My*Hz_eff - Mz*Hy_eff;
+        Real const Ty = Mz*Hx_eff - Mx*Hz_eff;
+        Real const Tz = Mx*Hy_eff - My*Hx_eff;
+        Real const torque = std::sqrt(Tx*Tx + Ty*Ty + Tz*Tz) / Ms_face;
+
+        return {1._rt, Mx, My, Mz,
+                Mx*Hx_b + My*Hy_b + Mz*Hz_b,
+                Mx*Hx_f + My*Hy_f + Mz*Hz_f,
+                deviation, torque};
+    }
+#endif
+}
+
+// constructor
+LLGMagnetization::LLGMagnetization (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#ifndef WARPX_MAG_LLG
+    amrex::Abort("LLGMagnetization reduced diagnostics requires USE_LLG=TRUE");
+#endif
+
+    // read number of levels
+    int nLevel = 0;
+    ParmParse pp_amr("amr");
+    pp_amr.query("max_level", nLevel);
+    nLevel += 1;
+
+    // resize data array
+    m_data.resize(noutputs*nLevel, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            constexpr int shift = 3;
+            std::string const names[noutputs] = {"Mx_avg", "My_avg", "Mz_avg", "max_dev_M/Ms", "max_torque",
+                                                 "E_zeeman", "E_demag"};
+            std::string const units[noutputs] = {"(A/m)", "(A/m)", "(A/m)", "()", "(A/m)", "(J)", "(J)"};
+            for (int lev = 0; lev < nLevel; ++lev)
+            {
+                for (int n = 0; n < noutputs; ++n)
+                {
+                    ofs << m_sep;
+                    ofs << "[" + std::to_string(shift+noutputs*lev+n) + "]";
+                    ofs << names[n]+"_lev"+std::to_string(lev)+units[n];
+                }
+            }
+            ofs << std::endl;
+
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the magnetization diagnostics
+void LLGMagnetization::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void LLGMagnetization::ComputeDiags
+
+// function that computes the local sums and maxima over the faces of M
+void LLGMagnetization::ComputeLocalDiags (int step, ReductionBroker& broker)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+#ifdef WARPX_MAG_LLG
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::em_solver_medium == MediumForEM::Macroscopic,
+        "LLGMagnetization reduced diagnostics requires algo.em_solver_medium = macroscopic");
+
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
+    MacroscopicProperties & macroscopic_properties = warpx.GetMacroscopicProperties();
+    int const coupling = warpx.mag_LLG_coupling;
+
+    // get number of level
+    const auto nLevel = warpx.finestLevel() + 1;
+    m_sums.assign(nsums*nLevel, 0._rt);
+    m_maxs.assign(nmaxs*nLevel, 0._rt);
+
+    // loop over refinement levels
+    for (int lev = 0; lev < nLevel; ++lev)
+    {
+        MultiFab * const Mx_mf = warpx.get_pointer_Mfield_fp(lev, 0);
+        MultiFab * const My_mf = warpx.get_pointer_Mfield_fp(lev, 1);
+        MultiFab * const Mz_mf = warpx.get_pointer_Mfield_fp(lev, 2);
+        MultiFab * const Hx_mf = warpx.get_pointer_Hfield_fp(lev, 0);
+        MultiFab * const Hy_mf = warpx.get_pointer_Hfield_fp(lev, 1);
+        MultiFab * const Hz_mf = warpx.get_pointer_Hfield_fp(lev, 2);
+        // null if H_bias is evaluated on the fly (warpx.mag_H_bias_on_the_fly)
+        std::array<std::unique_ptr<MultiFab>, 3> const& H_biasfield = warpx.getH_biasfield_fp_array(lev);
+
+        Geometry const & geom = warpx.Geom(lev);
+
+        // faces shared by several boxes are only counted once
+        std::unique_ptr<iMultiFab> const owner_x = Mx_mf->OwnerMask(geom.periodicity());
+        std::unique_ptr<iMultiFab> const owner_y = My_mf->OwnerMask(geom.periodicity());
+        std::unique_ptr<iMultiFab> const owner_z = Mz_mf->OwnerMask(geom.periodicity());
+
+        macroscopic_properties.SetPatch(lev, PatchType::fine);
+        GpuArray<int, 3> const& Ms_stag = macroscopic_properties.mag_Ms_IndexType;
+        GpuArray<int, 3> const& Mx_stag = macroscopic_properties.Mx_IndexType;
+        GpuArray<int, 3> const& My_stag = macroscopic_properties.My_IndexType;
+        GpuArray<int, 3> const& Mz_stag = macroscopic_properties.Mz_IndexType;
+        GpuArray<int, 3> const& macro_cr = macroscopic_properties.macro_cr_ratio;
+
+        ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+                  ReduceOpMax, ReduceOpMax> reduce_op;
+        ReduceData<Real, Real, Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+
+        // the three face arrays of M are reduced together, in a single pass over the boxes
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*Mx_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi )
+        {
+            Array4<Real const> const M_xface = Mx_mf->const_array(mfi);
+            Array4<Real const> const M_yface = My_mf->const_array(mfi);
+            Array4<Real const> const M_zface = Mz_mf->const_array(mfi);
+            Array4<int const> const own_x = owner_x->const_array(mfi);
+            Array4<int const> const own_y = owner_y->const_array(mfi);
+            Array4<int const> const own_z = owner_z->const_array(mfi);
+            MacroPropertyArray const Ms = macroscopic_properties.getproperty_arr(mfi, MacroProp::Ms);
+            Array4<Real> const Hx = Hx_mf->array(mfi);
+            Array4<Real> const Hy = Hy_mf->array(mfi);
+            Array4<Real> const Hz = Hz_mf->array(mfi);
+            GpuArray<HBiasComponent, 3> const H_bias = warpx.GetHBias(H_biasfield, lev, mfi);
+            HBiasComponent const Hx_bias = H_bias[0];
+            HBiasComponent const Hy_bias = H_bias[1];
+            HBiasComponent const Hz_bias = H_bias[2];
+
+            Box const tbx = mfi.tilebox(Mx_mf->ixType().toIntVect());
+            Box const tby = mfi.tilebox(My_mf->ixType().toIntVect());
+            Box const tbz = mfi.tilebox(Mz_mf->ixType().toIntVect());
+
+            reduce_op.eval(tbx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                return MagFaceReduce(i, j, k, IntVect(1, 0, 0), M_xface, own_x, Ms, Ms_stag, Mx_stag, macro_cr,
+                                     Hx, Hy, Hz, Hx_bias, Hy_bias, Hz_bias, coupling);
+            });
+            reduce_op.eval(tby, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                return MagFaceReduce(i, j, k, IntVect(0, 1, 0), M_yface, own_y, Ms, Ms_stag, My_stag, macro_cr,
+                                     Hx, Hy, Hz, Hx_bias, Hy_bias, Hz_bias, coupling);
+            });
+            reduce_op.eval(tbz, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                return MagFaceReduce(i, j, k, IntVect(0, 0, 1), M_zface, own_z, Ms, Ms_stag, Mz_stag, macro_cr,
+                                     Hx, Hy, Hz, Hx_bias, Hy_bias, Hz_bias, coupling);
+            });
+        }
+
+        auto const hv = reduce_data.value();
+        Real* const sums = m_sums.data() + lev*nsums;
+        Real* const maxs = m_maxs.data() + lev*nmaxs;
+        sums[0] = amrex::get<0>(hv);
+        sums[1] = amrex::get<1>(hv);
+        sums[2] = amrex::get<2>(hv);
+        sums[3] = amrex::get<3>(hv);
+        sums[4] = amrex::get<4>(hv);
+        sums[5] = amrex::get<5>(hv);
+        maxs[0] = amrex::get<6>(hv);
+        maxs[1] = amrex::get<7>(hv);
+    }
+    // end loop over refinement levels
+
+    macroscopic_properties.SetPatch(0, PatchType::fine);
+
+    // MPI reduce, for all the levels at once, with the other buffers of the broker
+    broker.Sum(m_sums.data(), static_cast<int>(m_sums.size()));
+    broker.Max(m_maxs.data(), static_cast<int>(m_maxs.size()));
+#else
+    amrex::ignore_unused(broker);
+#endif
+}
+// end void LLGMagnetization::ComputeLocalDiags
+
+// function that computes the magnetization diagnostics from the reduced sums and maxima
+void LLGMagnetization::FinishDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+#ifdef WARPX_MAG_LLG
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
+
+    // get number of level
+    const auto nLevel = warpx.finestLevel() + 1;
+
+    // loop over refinement levels
+    for (int lev = 0; lev < nLevel; ++lev)
+    {
+        Real const* const sums = m_sums.data() + lev*nsums;
+        Real const* const maxs = m_maxs.data() + lev*nmaxs;
+
+        Geometry const & geom = warpx.Geom(lev);
+        auto const dV = AMREX_D_TERM(geom.CellSize(0), * geom.CellSize(1), * geom.CellSize(2));
+
+        Real const n_faces = sums[0];
+        Real const inv_n_faces = (n_faces > 0._rt) ? 1._rt/n_faces : 0._rt;
+
+        // each cell holds one face of each of the three face arrays of M
+        m_data[lev*noutputs+0] = sums[1] * inv_n_faces;
+        m_data[lev*noutputs+1] = sums[2] * inv_n_faces;
+        m_data[lev*noutputs+2] = sums[3] * inv_n_faces;
+        m_data[lev*noutputs+3] = maxs[0];
+        m_data[lev*noutputs+4] = maxs[1];
+        m_data[lev*noutputs+5] = - PhysConst::mu0 * sums[4] * dV / 3._rt;
+        m_data[lev*noutputs+6] = - 0.5_rt * PhysConst::mu0 * sums[5] * dV / 3._rt;
+    }
+    // end loop over refinement levels
+#endif
+
+    /* m_data now contains up-to-date values for:
+     *  [<Mx>, <My>, <Mz>, max | |M|/Ms - 1 |, max |M x H_eff|/Ms,
+     *   Zeeman energy and demagnetizing energy at level 0,
+     *   ......] */
+}
+// end void LLGMagnetization::FinishDiags
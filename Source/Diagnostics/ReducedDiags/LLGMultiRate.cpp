@@ -0,0 +1,94 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "LLGMultiRate.H"
+#include "WarpX.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+// constructor
+LLGMultiRate::LLGMultiRate (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#ifndef WARPX_MAG_LLG
+    amrex::Abort("LLGMultiRate reduced diagnostics requires USE_LLG=TRUE");
+#endif
+
+    // read number of levels
+    int nLevel = 0;
+    ParmParse pp_amr("amr");
+    pp_amr.query("max_level", nLevel);
+    nLevel += 1;
+
+    // resize data array
+    m_data.resize(2*nLevel, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            constexpr int shift = 3;
+            for (int lev = 0; lev < nLevel; ++lev)
+            {
+                ofs << m_sep;
+                ofs << "[" + std::to_string(shift+2*lev) + "]";
+                ofs << "dM_lev"+std::to_string(lev)+"()";
+                ofs << m_sep;
+                ofs << "[" + std::to_string(shift+2*lev+1) + "]";
+                ofs << "dH_lev"+std::to_string(lev)+"()";
+            }
+            ofs << std::endl;
+
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that gets the error indicators of the multi-rate LLG scheme
+void LLGMultiRate::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+#ifdef WARPX_MAG_LLG
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
+
+    // get number of level
+    const auto nLevel = warpx.finestLevel() + 1;
+
+    // loop over refinement levels
+    for (int lev = 0; lev < nLevel; ++lev)
+    {
+        FiniteDifferenceSolver const * fdtd_solver = warpx.get_pointer_fdtd_solver_fp(lev);
+
+        // the indicators are already reduced over all MPI ranks
+        m_data[2*lev]   = (fdtd_solver) ? fdtd_solver->LLGDMIndicator() : 0._rt;
+        m_data[2*lev+1] = (fdtd_solver) ? fdtd_solver->LLGMultiRateDHIndicator() : 0._rt;
+    }
+    // end loop over refinement levels
+#endif
+
+    /* m_data now contains up-to-date values for:
+     *  [dM at level 0, dH at level 0,
+     *   dM at level 1, dH at level 1,
+     *   ......] */
+}
+// end void LLGMultiRate::ComputeDiags
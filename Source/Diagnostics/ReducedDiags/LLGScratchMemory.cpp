@@ -0,0 +1,94 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "LLGScratchMemory.H"
+#include "WarpX.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex;
+
+// constructor
+LLGScratchMemory::LLGScratchMemory (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+#ifndef WARPX_MAG_LLG
+    amrex::Abort("LLGScratchMemory reduced diagnostics requires USE_LLG=TRUE");
+#endif
+
+    // read number of levels
+    int nLevel = 0;
+    ParmParse pp_amr("amr");
+    pp_amr.query("max_level", nLevel);
+    nLevel += 1;
+
+    // resize data array
+    m_data.resize(nLevel, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            constexpr int shift = 3;
+            for (int lev = 0; lev < nLevel; ++lev)
+            {
+                ofs << m_sep;
+                ofs << "[" + std::to_string(shift+lev) + "]";
+                ofs << "scratch_bytes_lev"+std::to_string(lev)+"(B)";
+            }
+            ofs << std::endl;
+
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the memory held by the LLG scratch fields
+void LLGScratchMemory::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+#ifdef WARPX_MAG_LLG
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
+
+    // get number of level
+    const auto nLevel = warpx.finestLevel() + 1;
+
+    // loop over refinement levels
+    for (int lev = 0; lev < nLevel; ++lev)
+    {
+        FiniteDifferenceSolver const * fdtd_solver = warpx.get_pointer_fdtd_solver_fp(lev);
+        amrex::Long nbytes = (fdtd_solver) ? fdtd_solver->LLGScratchBytes() : 0;
+
+        // sum over all MPI ranks
+        ParallelDescriptor::ReduceLongSum(nbytes);
+
+        // save data
+        m_data[lev] = static_cast<amrex::Real>(nbytes);
+    }
+    // end loop over refinement levels
+#endif
+
+    /* m_data now contains up-to-date values for:
+     *  [bytes of LLG scratch fields at level 0,
+     *   bytes of LLG scratch fields at level 1,
+     *   ......] */
+}
+// end void LLGScratchMemory::ComputeDiags
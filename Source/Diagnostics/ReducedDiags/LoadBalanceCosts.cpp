@@ -8,8 +8,17 @@
 #include "WarpX.H"
 #include "LoadBalanceCosts.H"
 #include "Utils/WarpXUtil.H"
+#include "Utils/BoxCostTimer.H"
 
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
 #include <memory>
+#include <sstream>
 
 using namespace amrex;
 
@@ -17,7 +26,48 @@ using namespace amrex;
 LoadBalanceCosts::LoadBalanceCosts (std::string rd_name)
     : ReducedDiags{rd_name}
 {
+    ParmParse pp_rd_name(m_rd_name);
+    pp_rd_name.query("summary", m_summary);
+    std::vector<std::string> box_intervals_string_vec = {"0"};
+    pp_rd_name.queryarr("box_intervals", box_intervals_string_vec);
+    m_box_intervals = IntervalsParser(box_intervals_string_vec);
+
+    // the hostnames are written as strings in the text file of the boxes
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_binary || m_summary,
+        "LoadBalanceCosts reduced diagnostics support format = binary only with summary = 1");
+
+    if (!m_summary) return;
+
+    m_data.resize(m_nSummaryFields, 0.0_rt);
 
+    if (ParallelDescriptor::IOProcessor() && m_IsNotRestart)
+    {
+        // open file
+        std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+        // write header row
+        const std::vector<std::string> names = {
+            "total_cost()", "n_boxes()",
+            "rank_cost_min()", "rank_cost_max()", "rank_cost_mean()",
+            "rank_boxes_min()", "rank_boxes_max()",
+            "box_cost_min()", "box_cost_max()", "box_cost_mean()",
+            "efficiency()"};
+        ofs << "#";
+        ofs << "[1]step()";
+        ofs << m_sep;
+        ofs << "[2]time(s)";
+        for (int i = 0; i < static_cast<int>(names.size()); ++i)
+        {
+            ofs << m_sep;
+            ofs << "[" + std::to_string(3+i) + "]" + names[i];
+        }
+        ofs << std::endl;
+        // close file
+        ofs.close();
+
+        // replace / create the file of the boxes; its header is written at the end of the run
+        std::ofstream ofs_boxes{BoxesFileName(), std::ios::trunc};
+        ofs_boxes.close();
+    }
 }
 
 // function that gathers costs
@@ -26,36 +76,51 @@ void LoadBalanceCosts::ComputeDiags (int step)
     // get a reference to WarpX instance
     auto& warpx = WarpX::GetInstance();
 
-    const amrex::LayoutData<amrex::Real>* cost = warpx.getCosts(0);
+    // with summary = 1, the statistics are written at intervals
+    // and the boxes at box_intervals
+    const bool do_summary = m_summary && m_intervals.contains(step+1);
+    const bool do_boxes = m_summary ? m_box_intervals.contains(step+1)
+                                    : m_intervals.contains(step+1);
 
     // judge if the diags should be done
     // costs is initialized only if we're doing load balance
-    if (!m_intervals.contains(step+1) ||
+    if (!(do_summary || do_boxes) ||
           !warpx.get_load_balance_intervals().isActivated() ) { return; }
 
-    // get number of boxes over all levels
-    auto nLevels = warpx.finestLevel() + 1;
-    int nBoxes = 0;
-    for (int lev = 0; lev < nLevels; ++lev)
+    const auto costs = GetCosts();
+
+    if (do_summary) { ComputeSummary(costs); }
+
+    if (!do_boxes) { return; }
+
+    if (!m_summary)
     {
-        cost = warpx.getCosts(lev);
-        nBoxes += cost->size();
+        GatherBoxes(costs, m_data);
+        return;
     }
 
-    // keep track of the max number of boxes, this is needed later on to fill
-    // the jagged array (in case each step does not have the same number of boxes)
-    m_nBoxesMax = std::max(m_nBoxesMax, nBoxes);
+    // the boxes are written at a lower cadence, directly to their own file
+    GatherBoxes(costs, m_box_data);
+    if (!ParallelDescriptor::IOProcessor()) return;
 
-    // resize and clear data array
-    const size_t dataSize =
-        static_cast<size_t>(m_nDataFields)*
-        static_cast<size_t>(nBoxes);
-    m_data.resize(dataSize, 0.0_rt);
-    m_data.assign(dataSize, 0.0_rt);
+    std::ofstream ofs{BoxesFileName(), std::ofstream::out | std::ofstream::app};
+    ofs << BoxesLine(step, m_box_data);
+    ofs.close();
+
+    // final output of the boxes, fill jagged array with NaN
+    if (m_box_intervals.nextContains(step+1) > warpx.maxStep()) { PadBoxesFile(); }
+}
+
+amrex::Vector<std::unique_ptr<amrex::LayoutData<amrex::Real> > >
+LoadBalanceCosts::GetCosts ()
+{
+    auto& warpx = WarpX::GetInstance();
+    const int nLevels = warpx.finestLevel() + 1;
 
     // read in WarpX costs to local copy; compute if using `Heuristic` update
     amrex::Vector<std::unique_ptr<amrex::LayoutData<amrex::Real> > > costs;
 
+    BoxCostTimer::Flush();
     costs.resize(nLevels);
     for (int lev = 0; lev < nLevels; ++lev)
     {
@@ -67,8 +132,83 @@ void LoadBalanceCosts::ComputeDiags (int step)
         warpx.ComputeCostsHeuristic(costs);
     }
 
+    return costs;
+}
+
+void LoadBalanceCosts::ComputeSummary (
+    amrex::Vector<std::unique_ptr<amrex::LayoutData<amrex::Real> > > const& costs)
+{
+    // cost and number of the boxes of this rank, over all levels
+    Real rank_cost = 0._rt;
+    Real rank_boxes = 0._rt;
+    Real box_cost_min = std::numeric_limits<Real>::max();
+    Real box_cost_max = std::numeric_limits<Real>::lowest();
+    for (int lev = 0; lev < static_cast<int>(costs.size()); ++lev)
+    {
+        for (MFIter mfi(*costs[lev], false); mfi.isValid(); ++mfi)
+        {
+            const Real box_cost = (*costs[lev])[mfi.index()];
+            rank_cost += box_cost;
+            rank_boxes += 1._rt;
+            box_cost_min = std::min(box_cost_min, box_cost);
+            box_cost_max = std::max(box_cost_max, box_cost);
+        }
+    }
+
+    // the minima are reduced as the maxima of the opposite values
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    Real maxs[6] = {rank_cost, rank_boxes, box_cost_max, -rank_cost, -rank_boxes, -box_cost_min};
+    ParallelDescriptor::ReduceRealMax(maxs, 6, ioproc);
+    Real sums[2] = {rank_cost, rank_boxes};
+    ParallelDescriptor::ReduceRealSum(sums, 2, ioproc);
+
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    const Real total_cost = sums[0];
+    const Real n_boxes = sums[1];
+    const Real rank_cost_mean = total_cost/ParallelDescriptor::NProcs();
+    m_data[0] = total_cost;
+    m_data[1] = n_boxes;
+    m_data[2] = -maxs[3];
+    m_data[3] = maxs[0];
+    m_data[4] = rank_cost_mean;
+    m_data[5] = -maxs[4];
+    m_data[6] = maxs[1];
+    m_data[7] = -maxs[5];
+    m_data[8] = maxs[2];
+    m_data[9] = (n_boxes > 0._rt) ? total_cost/n_boxes : 0._rt;
+    // same as LoadBalanceEfficiency: mean over max cost per rank, -1 until costs are recorded
+    m_data[10] = (maxs[0] > 0._rt) ? rank_cost_mean/maxs[0] : -1._rt;
+}
+
+void LoadBalanceCosts::GatherBoxes (
+    amrex::Vector<std::unique_ptr<amrex::LayoutData<amrex::Real> > > const& costs,
+    std::vector<amrex::Real>& data)
+{
+    // get a reference to WarpX instance
+    auto& warpx = WarpX::GetInstance();
+
+    // get number of boxes over all levels
+    const int nLevels = static_cast<int>(costs.size());
+    int nBoxes = 0;
+    for (int lev = 0; lev < nLevels; ++lev)
+    {
+        nBoxes += costs[lev]->size();
+    }
+
+    // keep track of the max number of boxes, this is needed later on to fill
+    // the jagged array (in case each step does not have the same number of boxes)
+    m_nBoxesMax = std::max(m_nBoxesMax, nBoxes);
+
+    // resize and clear data array
+    const size_t dataSize =
+        static_cast<size_t>(m_nDataFields)*
+        static_cast<size_t>(nBoxes);
+    data.resize(dataSize, 0.0_rt);
+    data.assign(dataSize, 0.0_rt);
+
     // keep track of correct index in array over all boxes on all levels
-    // shift index for m_data
+    // shift index for data
     int shift_m_data = 0;
 
     // save data
@@ -79,22 +219,22 @@ void LoadBalanceCosts::ComputeDiags (int step)
         for (MFIter mfi(Ex, false); mfi.isValid(); ++mfi)
         {
             const Box& tbx = mfi.tilebox();
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 0] = (*costs[lev])[mfi.index()];
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 1] = dm[mfi.index()];
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 2] = lev;
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 3] = tbx.loVect()[0];
+            data[shift_m_data + mfi.index()*m_nDataFields + 0] = (*costs[lev])[mfi.index()];
+            data[shift_m_data + mfi.index()*m_nDataFields + 1] = dm[mfi.index()];
+            data[shift_m_data + mfi.index()*m_nDataFields + 2] = lev;
+            data[shift_m_data + mfi.index()*m_nDataFields + 3] = tbx.loVect()[0];
 #if (AMREX_SPACEDIM >= 2)
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 4] = tbx.loVect()[1];
+            data[shift_m_data + mfi.index()*m_nDataFields + 4] = tbx.loVect()[1];
 #else
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 4] = 0.;
+            data[shift_m_data + mfi.index()*m_nDataFields + 4] = 0.;
 #endif
 #if (AMREX_SPACEDIM == 3)
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 5] = tbx.loVect()[2];
+            data[shift_m_data + mfi.index()*m_nDataFields + 5] = tbx.loVect()[2];
 #else
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 5] = 0.;
+            data[shift_m_data + mfi.index()*m_nDataFields + 5] = 0.;
 #endif
 #ifdef AMREX_USE_GPU
-            m_data[shift_m_data + mfi.index()*m_nDataFields + 6] = amrex::Gpu::Device::deviceId();
+            data[shift_m_data + mfi.index()*m_nDataFields + 6] = amrex::Gpu::Device::deviceId();
 #endif
         }
 
@@ -103,10 +243,14 @@ void LoadBalanceCosts::ComputeDiags (int step)
     }
 
     // parallel reduce to IO proc and get data over all procs
-    ParallelDescriptor::ReduceRealSum(m_data.data(),
-                                      m_data.size(),
+    ParallelDescriptor::ReduceRealSum(data.data(),
+                                      data.size(),
                                       ParallelDescriptor::IOProcessorNumber());
 
+    // the hostnames do not change, they are gathered only once
+    if (m_hostnames_gathered) return;
+    m_hostnames_gathered = true;
+
 #ifdef AMREX_USE_MPI
     // now parallel reduce to IO proc and get string data (host name) over all procs
     // MPI Gatherv preliminaries
@@ -133,7 +277,7 @@ void LoadBalanceCosts::ComputeDiags (int step)
     // + 1 is for chosen separation between words in the gathered string; this
     // chosen separator character is set further below when elements of
     // m_data_string_recvbuf are initialized
-    m_data_string_recvbuf_length += m_data_string_recvcount[0] + 1;
+    m_data_string_recvbuf_length = m_data_string_recvcount[0] + 1;
     for (int i=1; i<m_data_string_disp.size(); i++)
     {
         m_data_string_recvbuf_length += (m_data_string_recvcount[i] + 1);
@@ -167,7 +311,7 @@ void LoadBalanceCosts::ComputeDiags (int step)
 #endif
     }
 
-    /* m_data now contains up-to-date values for:
+    /* data now contains up-to-date values for:
      *  [[cost, proc, lev, i_low, j_low, k_low(, gpu_ID [if GPU run]) ] of box 0 at level 0,
      *   [cost, proc, lev, i_low, j_low, k_low(, gpu_ID [if GPU run]) ] of box 1 at level 0,
      *   [cost, proc, lev, i_low, j_low, k_low(, gpu_ID [if GPU run]) ] of box 2 at level 0,
@@ -191,9 +335,32 @@ void LoadBalanceCosts::ComputeDiags (int step)
 // write to file function for cost
 void LoadBalanceCosts::WriteToFile (int step) const
 {
-    // open file
-    std::ofstream ofs{m_path + m_rd_name + "." + m_extension,
-            std::ofstream::out | std::ofstream::app};
+    // the statistics are written as for the other reduced diagnostics
+    if (m_summary)
+    {
+        ReducedDiags::WriteToFile(step);
+        return;
+    }
+
+    AppendToBuffer(BoxesLine(step, m_data));
+
+    // get a reference to WarpX instance
+    auto& warpx = WarpX::GetInstance();
+
+    if (!ParallelDescriptor::IOProcessor()) return;
+
+    // final step is a special case, fill jagged array with NaN
+    if (m_intervals.nextContains(step+1) > warpx.maxStep())
+    {
+        // write the outputs still in memory before rewriting the file
+        Flush();
+        PadBoxesFile();
+    }
+}
+
+std::string LoadBalanceCosts::BoxesLine (int step, std::vector<amrex::Real> const& data) const
+{
+    std::ostringstream ofs;
 
     // write step
     ofs << step+1 << m_sep;
@@ -205,120 +372,118 @@ void LoadBalanceCosts::WriteToFile (int step) const
     ofs << WarpX::GetInstance().gett_new(0);
 
     // loop over data size and write
-    for (int i = 0; i < static_cast<int>(m_data.size()); ++i)
+    for (int i = 0; i < static_cast<int>(data.size()); ++i)
     {
-        ofs << m_sep << m_data[i];
+        ofs << m_sep << data[i];
         if ((i - m_nDataFields + 1)%m_nDataFields == 0)
         {
             // at the end of current group of m_nDatafields, output the string data (hostname)
             int ind_rank = i - m_nDataFields + 2; // index for the rank corresponding to current box
 
-            // m_data --> rank --> hostname
-            ofs << m_sep << m_data_string[static_cast<long unsigned int>(m_data[ind_rank])];
+            // data --> rank --> hostname
+            ofs << m_sep << m_data_string[static_cast<long unsigned int>(data[ind_rank])];
         }
     }
     // end loop over data size
 
     // end line
-    ofs << std::endl;
-
-    // close file
-    ofs.close();
-
+    ofs << "\n";
 
-    // get a reference to WarpX instance
-    auto& warpx = WarpX::GetInstance();
+    return ofs.str();
+}
 
-    if (!ParallelDescriptor::IOProcessor()) return;
+std::string LoadBalanceCosts::BoxesFileName () const
+{
+    return m_summary ? m_path + m_rd_name + "_boxes." + m_extension
+                     : m_path + m_rd_name + "." + m_extension;
+}
 
-    // final step is a special case, fill jagged array with NaN
-    if (m_intervals.nextContains(step+1) > warpx.maxStep())
+void LoadBalanceCosts::PadBoxesFile () const
+{
+    // open tmp file to copy data
+    std::string fileDataName = BoxesFileName();
+    std::string fileTmpName = fileDataName + ".tmp";
+    std::ofstream ofstmp(fileTmpName, std::ofstream::out);
+
+    // write header row
+    // for each box on each level we saved 7 data fields: [cost, proc, lev, i_low, j_low, k_low, hostname])
+    // nDataFieldsToWrite = below accounts for the Real data fields (m_nDataFields), then 1 string output to write
+    int nDataFieldsToWrite = m_nDataFields + 1;
+
+    ofstmp << "#";
+    ofstmp << "[1]step()";
+    ofstmp << m_sep;
+    ofstmp << "[2]time(s)";
+
+    for (int boxNumber=0; boxNumber<m_nBoxesMax; ++boxNumber)
     {
-        // open tmp file to copy data
-        std::string fileTmpName = m_path + m_rd_name + ".tmp." + m_extension;
-        std::ofstream ofstmp(fileTmpName, std::ofstream::out);
-
-        // write header row
-        // for each box on each level we saved 7 data fields: [cost, proc, lev, i_low, j_low, k_low, hostname])
-        // nDataFieldsToWrite = below accounts for the Real data fields (m_nDataFields), then 1 string output to write
-        int nDataFieldsToWrite = m_nDataFields + 1;
-
-        ofstmp << "#";
-        ofstmp << "[1]step()";
         ofstmp << m_sep;
-        ofstmp << "[2]time(s)";
-
-        for (int boxNumber=0; boxNumber<m_nBoxesMax; ++boxNumber)
-        {
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(3 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "cost_box_"+std::to_string(boxNumber)+"()";
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(4 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "proc_box_"+std::to_string(boxNumber)+"()";
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(5 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "lev_box_"+std::to_string(boxNumber)+"()";
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(6 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "i_low_box_"+std::to_string(boxNumber)+"()";
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(7 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "j_low_box_"+std::to_string(boxNumber)+"()";
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(8 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "k_low_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << "[" + std::to_string(3 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "cost_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(4 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "proc_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(5 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "lev_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(6 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "i_low_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(7 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "j_low_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(8 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "k_low_box_"+std::to_string(boxNumber)+"()";
 #ifdef AMREX_USE_GPU
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(9 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "gpu_ID_box_"+std::to_string(boxNumber)+"()";
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(10 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "hostname_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(9 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "gpu_ID_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(10 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "hostname_box_"+std::to_string(boxNumber)+"()";
 #else
-            ofstmp << m_sep;
-            ofstmp << "[" + std::to_string(9 + nDataFieldsToWrite*boxNumber) + "]";
-            ofstmp << "hostname_box_"+std::to_string(boxNumber)+"()";
+        ofstmp << m_sep;
+        ofstmp << "[" + std::to_string(9 + nDataFieldsToWrite*boxNumber) + "]";
+        ofstmp << "hostname_box_"+std::to_string(boxNumber)+"()";
 #endif
-        }
-        ofstmp << std::endl;
+    }
+    ofstmp << std::endl;
+
+    // open the data-containing file
+    std::ifstream ifs(fileDataName, std::ifstream::in);
 
-        // open the data-containing file
-        std::string fileDataName = m_path + m_rd_name + "." + m_extension;
-        std::ifstream ifs(fileDataName, std::ifstream::in);
+    // Fill in the tmp costs file with data, padded with NaNs
+    for (std::string lineIn; std::getline(ifs, lineIn);)
+    {
+        // count the elements in the input line
+        int cnt = 0;
+        std::stringstream ss(lineIn);
+        std::string token;
 
-        // Fill in the tmp costs file with data, padded with NaNs
-        for (std::string lineIn; std::getline(ifs, lineIn);)
+        while (std::getline(ss, token, m_sep[0]))
         {
-            // count the elements in the input line
-            int cnt = 0;
-            std::stringstream ss(lineIn);
-            std::string token;
-
-            while (std::getline(ss, token, m_sep[0]))
-            {
-                cnt += 1;
-                if (ss.peek() == m_sep[0]) ss.ignore();
-            }
-
-            // 2 columns for step, time; then nBoxes*nDatafields columns for data;
-            // then nBoxes*1 columns for hostname;
-            // then fill the remaining columns (i.e., up to 2 + m_nBoxesMax*nDataFieldsToWrite)
-            // with NaN, so the array is not jagged
-            ofstmp << lineIn;
-            for (int i=0; i<(m_nBoxesMax*nDataFieldsToWrite - (cnt - 2)); ++i)
-            {
-                ofstmp << m_sep << "NaN";
-            }
-            ofstmp << std::endl;
+            cnt += 1;
+            if (ss.peek() == m_sep[0]) ss.ignore();
         }
 
-        // close files
-        ifs.close();
-        ofstmp.close();
-
-        // remove the original, rename tmp file
-        std::remove(fileDataName.c_str());
-        std::rename(fileTmpName.c_str(), fileDataName.c_str());
+        // 2 columns for step, time; then nBoxes*nDatafields columns for data;
+        // then nBoxes*1 columns for hostname;
+        // then fill the remaining columns (i.e., up to 2 + m_nBoxesMax*nDataFieldsToWrite)
+        // with NaN, so the array is not jagged
+        ofstmp << lineIn;
+        for (int i=0; i<(m_nBoxesMax*nDataFieldsToWrite - (cnt - 2)); ++i)
+        {
+            ofstmp << m_sep << "NaN";
+        }
+        ofstmp << std::endl;
     }
+
+    // close files
+    ifs.close();
+    ofstmp.close();
+
+    // remove the original, rename tmp file
+    std::remove(fileDataName.c_str());
+    std::rename(fileTmpName.c_str(), fileDataName.c_str());
 }
@@ -0,0 +1,151 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "MemoryUsage.H"
+#include "WarpX.H"
+
+#include <AMReX_Arena.H>
+#include <AMReX_CArena.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+namespace
+{
+    /** Bytes of The_Arena in use and size of its pool (0 if it is not a CArena) */
+    void ArenaBytes (Long& used, Long& pool)
+    {
+        used = 0;
+        pool = 0;
+        if (auto const* arena = dynamic_cast<CArena const*>(The_Arena())) {
+            used = static_cast<Long>(arena->heap_space_actually_used());
+            pool = static_cast<Long>(arena->heap_space_used());
+        }
+    }
+}
+
+// constructor
+MemoryUsage::MemoryUsage (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+    // read number of levels
+    int max_level = 0;
+    ParmParse pp_amr("amr");
+    pp_amr.query("max_level", max_level);
+    m_nlevels = max_level + 1;
+
+    // names of the quantities: the subsystems on each level, the species and the arena
+    const Vector<std::string> categories = WarpX::MemoryCategoryNames();
+    const std::vector<std::string> species_names = WarpX::GetInstance().GetPartContainer().GetSpeciesNames();
+    Vector<std::string> names;
+    for (int lev = 0; lev < m_nlevels; ++lev) {
+        for (auto const& c : categories) names.push_back(c + "_lev" + std::to_string(lev));
+    }
+    for (auto const& s : species_names) names.push_back("particles_" + s);
+    names.push_back("arena_used");
+    names.push_back("arena_pool");
+    names.push_back("arena_max_used");
+
+    const int nNames = names.size();
+
+    // resize data array: min, max and total of each quantity
+    m_data.resize(3*nNames, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            constexpr int shift = 3;
+            const Vector<std::string> stats = {"min", "max", "total"};
+            for (int i = 0; i < nNames; ++i)
+            {
+                for (int s = 0; s < 3; ++s)
+                {
+                    ofs << m_sep;
+                    ofs << "[" + std::to_string(shift+3*i+s) + "]";
+                    ofs << names[i] + "_" + stats[s] + "(B)";
+                }
+            }
+            ofs << std::endl;
+
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the memory held by each subsystem
+void MemoryUsage::ComputeDiags (int step)
+{
+    // sample the memory in use at each step
+    Long arena_used, arena_pool;
+    ArenaBytes(arena_used, arena_pool);
+    m_arena_max_used = std::max(m_arena_max_used, arena_used);
+
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
+    auto & mypc = warpx.GetPartContainer();
+
+    // bytes of each quantity on this rank
+    Vector<Long> nbytes;
+    for (int lev = 0; lev < m_nlevels; ++lev)
+    {
+        if (lev <= warpx.finestLevel()) {
+            const Vector<Long> lev_bytes = warpx.MemoryBytes(lev);
+            nbytes.insert(nbytes.end(), lev_bytes.begin(), lev_bytes.end());
+        } else {
+            nbytes.resize(nbytes.size() + WarpX::MemoryCategoryNames().size(), 0);
+        }
+    }
+    for (int i = 0; i < mypc.nSpecies(); ++i)
+    {
+        nbytes.push_back(mypc.GetParticleContainer(i).MemoryBytes());
+    }
+    nbytes.push_back(arena_used);
+    nbytes.push_back(arena_pool);
+    nbytes.push_back(m_arena_max_used);
+    m_arena_max_used = arena_used;
+
+    // reduce over the MPI ranks
+    const int n = nbytes.size();
+    Vector<Long> bmin = nbytes, bmax = nbytes, bsum = nbytes;
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceLongMin(bmin.dataPtr(), n, ioproc);
+    ParallelDescriptor::ReduceLongMax(bmax.dataPtr(), n, ioproc);
+    ParallelDescriptor::ReduceLongSum(bsum.dataPtr(), n, ioproc);
+
+    for (int i = 0; i < n; ++i)
+    {
+        m_data[3*i]   = static_cast<Real>(bmin[i]);
+        m_data[3*i+1] = static_cast<Real>(bmax[i]);
+        m_data[3*i+2] = static_cast<Real>(bsum[i]);
+    }
+
+    /* m_data now contains up-to-date values for:
+     *  [min, max and total of the bytes of the fields at level 0,
+     *   ......,
+     *   min, max and total of the bytes of the particles of each species,
+     *   ......,
+     *   min, max and total of the bytes in use in the arena, of its pool
+     *   and of the maximum in use since the last output] */
+}
+// end void MemoryUsage::ComputeDiags
@@ -8,6 +8,7 @@
 #include "LoadBalanceCosts.H"
 #include "LoadBalanceEfficiency.H"
 #include "ParticleHistogram.H"
+#include "ParticleHistogram2D.H"
 #include "BeamRelevant.H"
 #include "ParticleEnergy.H"
 #include "ParticleExtrema.H"
@@ -15,6 +16,13 @@
 #include "FieldMaximum.H"
 #include "RhoMaximum.H"
 #include "ParticleNumber.H"
+#include "LLGScratchMemory.H"
+#include "LLGIterations.H"
+#include "LLGMultiRate.H"
+#include "LLGMagnetization.H"
+#include "Timing.H"
+#include "MemoryUsage.H"
+#include "Communication.H"
 #include "MultiReducedDiags.H"
 
 #include <AMReX_ParmParse.H>
@@ -89,6 +97,11 @@ MultiReducedDiags::MultiReducedDiags ()
             m_multi_rd[i_rd] =
                 std::make_unique<ParticleHistogram>(m_rd_names[i_rd]);
         }
+        else if (rd_type.compare("ParticleHistogram2D") == 0)
+        {
+            m_multi_rd[i_rd] =
+                std::make_unique<ParticleHistogram2D>(m_rd_names[i_rd]);
+        }
         else if (rd_type.compare("ParticleNumber") == 0)
         {
             m_multi_rd[i_rd]=
@@ -99,6 +112,41 @@ MultiReducedDiags::MultiReducedDiags ()
             m_multi_rd[i_rd]=
                 std::make_unique<ParticleExtrema>(m_rd_names[i_rd]);
         }
+        else if (rd_type.compare("LLGScratchMemory") == 0)
+        {
+            m_multi_rd[i_rd]=
+                std::make_unique<LLGScratchMemory>(m_rd_names[i_rd]);
+        }
+        else if (rd_type.compare("LLGIterations") == 0)
+        {
+            m_multi_rd[i_rd]=
+                std::make_unique<LLGIterations>(m_rd_names[i_rd]);
+        }
+        else if (rd_type.compare("LLGMultiRate") == 0)
+        {
+            m_multi_rd[i_rd]=
+                std::make_unique<LLGMultiRate>(m_rd_names[i_rd]);
+        }
+        else if (rd_type.compare("LLGMagnetization") == 0)
+        {
+            m_multi_rd[i_rd]=
+                std::make_unique<LLGMagnetization>(m_rd_names[i_rd]);
+        }
+        else if (rd_type.compare("Timing") == 0)
+        {
+            m_multi_rd[i_rd]=
+                std::make_unique<Timing>(m_rd_names[i_rd]);
+        }
+        else if (rd_type.compare("MemoryUsage") == 0)
+        {
+            m_multi_rd[i_rd]=
+                std::make_unique<MemoryUsage>(m_rd_names[i_rd]);
+        }
+        else if (rd_type.compare("Communication") == 0)
+        {
+            m_multi_rd[i_rd]=
+                std::make_unique<Communication>(m_rd_names[i_rd]);
+        }
         else
         { Abort("No matching reduced diagnostics type found."); }
         // end if match diags
@@ -112,10 +160,23 @@ MultiReducedDiags::MultiReducedDiags ()
 // call functions to compute diags
 void MultiReducedDiags::ComputeDiags (int step)
 {
-    // loop over all reduced diags
+    // the particles have moved since the last call
+    m_species_moments.Invalidate();
+
+    // loop over all reduced diags: local values, registered in the broker
+    for (int i_rd = 0; i_rd < static_cast<int>(m_rd_names.size()); ++i_rd)
+    {
+        m_multi_rd[i_rd] -> ComputeLocalDiags(step, m_reduction_broker);
+    }
+    // end loop over all reduced diags
+
+    // one sum and one max over the MPI ranks for all the reduced diags
+    m_reduction_broker.Reduce();
+
+    // loop over all reduced diags: values from the reduced buffers
     for (int i_rd = 0; i_rd < static_cast<int>(m_rd_names.size()); ++i_rd)
     {
-        m_multi_rd[i_rd] -> ComputeDiags(step);
+        m_multi_rd[i_rd] -> FinishDiags(step);
     }
     // end loop over all reduced diags
 }
@@ -141,3 +202,13 @@ void MultiReducedDiags::WriteToFile (int step)
     // end loop over all reduced diags
 }
 // end void MultiReducedDiags::WriteToFile
+
+// function to write the buffered data
+void MultiReducedDiags::Flush ()
+{
+    // Only the I/O rank buffers data
+    if ( !ParallelDescriptor::IOProcessor() ) { return; }
+
+    for (auto& rd : m_multi_rd) { rd->Flush(); }
+}
+// end void MultiReducedDiags::Flush
@@ -10,7 +10,6 @@
 #include "Utils/WarpXConst.H"
 
 #include <AMReX_REAL.H>
-#include <AMReX_ParticleReduce.H>
 
 #include <iostream>
 #include <cmath>
@@ -77,6 +76,27 @@ ParticleEnergy::ParticleEnergy (std::string rd_name)
 
 // function that computes kinetic energy
 void ParticleEnergy::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void ParticleEnergy::ComputeDiags
+
+// function that registers the particle moments of all species in the broker
+void ParticleEnergy::ComputeLocalDiags (int step, ReductionBroker& broker)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    const int nSpecies = WarpX::GetInstance().GetPartContainer().nSpecies();
+    for (int i_s = 0; i_s < nSpecies; ++i_s)
+    {
+        WarpX::GetInstance().reduced_diags->m_species_moments.Request(i_s, broker);
+    }
+}
+// end void ParticleEnergy::ComputeLocalDiags
+
+// function that computes the particle energy from the reduced moments
+void ParticleEnergy::FinishDiags (int step)
 {
 
     // Judge if the diags should be done
@@ -91,64 +111,14 @@ void ParticleEnergy::ComputeDiags (int step)
     // get species names (std::vector<std::string>)
     const auto species_names = mypc.GetSpeciesNames();
 
-    // speed of light squared
-    auto c2 = PhysConst::c * PhysConst::c;
-
     // loop over species
     for (int i_s = 0; i_s < nSpecies; ++i_s)
     {
-        // get WarpXParticleContainer class object
-        const auto & myspc = mypc.GetParticleContainer(i_s);
-
-        // get mass (Real)
-        auto m = myspc.getMass();
-
-        using PType = typename WarpXParticleContainer::SuperParticleType;
-
-        // Use amrex::ReduceSum to compute the sum of energies of all particles
-        // held by the current MPI rank, for this species. This involves a loop over all
-        // boxes held by this MPI rank.
-        Real Etot = 0.0_rt;
-        if(myspc.AmIA<PhysicalSpecies::photon>()){
-            //Photons have m = 0, but ux,uy and uz are calculated assuming
-            //a mass equal to the electron mass. Therefore, photons need a special
-            //treatment to calculate the total energy.
-            constexpr auto me_c = PhysConst::m_e * PhysConst::c;
-            Etot = ReduceSum( myspc,
-            [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-            {
-                const auto w  = p.rdata(PIdx::w);
-                const auto ux = p.rdata(PIdx::ux);
-                const auto uy = p.rdata(PIdx::uy);
-                const auto uz = p.rdata(PIdx::uz);
-                const auto us = ux*ux + uy*uy + uz*uz;
-                return std::sqrt(us) * me_c * w;
-            });
-        } else {
-            Etot = ReduceSum( myspc,
-            [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-            {
-                const auto w  = p.rdata(PIdx::w);
-                const auto ux = p.rdata(PIdx::ux);
-                const auto uy = p.rdata(PIdx::uy);
-                const auto uz = p.rdata(PIdx::uz);
-                const auto us = ux*ux + uy*uy + uz*uz;
-                return ( std::sqrt(us*c2 + c2*c2) - c2 ) * m * w;
-            });
-        }
-
-        // Same thing for the particles weights.
-        auto Wtot = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> Real
-        {
-            return p.rdata(PIdx::w);
-        });
-
-        // reduced sum over mpi ranks
-        ParallelDescriptor::ReduceRealSum
-            (Etot, ParallelDescriptor::IOProcessorNumber());
-        ParallelDescriptor::ReduceRealSum
-            (Wtot, ParallelDescriptor::IOProcessorNumber());
+        // The energy and weight sums are computed in a single pass over the particles,
+        // shared with the other particle reduced diagnostics of this step
+        SpeciesMoments const& moments = WarpX::GetInstance().reduced_diags->m_species_moments.Get(i_s);
+        const Real Etot = moments.sum[SumIdx::wenergy];
+        const Real Wtot = moments.sum[SumIdx::w];
 
         // save results for this species i_s into m_data
         m_data[i_s+1] = Etot;
@@ -182,4 +152,4 @@ void ParticleEnergy::ComputeDiags (int step)
      *   mean energy (species n)] */
 
 }
-// end void ParticleEnergy::ComputeDiags
+// end void ParticleEnergy::FinishDiags
@@ -133,221 +133,44 @@ ParticleExtrema::ParticleExtrema (std::string rd_name)
 // function that computes extrema
 void ParticleExtrema::ComputeDiags (int step)
 {
+    ComputeDiagsAlone(step);
+}
+// end void ParticleExtrema::ComputeDiags
 
+// function that registers the moments of the species, and the local extrema of chi, in the broker
+void ParticleExtrema::ComputeLocalDiags (int step, ReductionBroker& broker)
+{
     // Judge if the diags should be done
     if (!m_intervals.contains(step+1)) { return; }
 
     // get MultiParticleContainer class object
     auto & mypc = WarpX::GetInstance().GetPartContainer();
 
-    // get number of species (int)
-    const auto nSpecies = mypc.nSpecies();
-
     // get species names (std::vector<std::string>)
     const auto species_names = mypc.GetSpeciesNames();
 
-    // inverse of speed of light squared
-    Real constexpr inv_c2 = 1.0_rt / (PhysConst::c * PhysConst::c);
-
-    // If 2D-XZ, p.pos(1) is z, rather than p.pos(2).
-#if (defined WARPX_DIM_3D)
-    int const index_z = 2;
-#elif (defined WARPX_DIM_XZ || defined WARPX_DIM_RZ)
-    int const index_z = 1;
-#endif
-
     // loop over species
-    for (int i_s = 0; i_s < nSpecies; ++i_s)
+    for (int i_s = 0; i_s < mypc.nSpecies(); ++i_s)
     {
-
         // only chosen species does
         if (species_names[i_s] != m_species_name) { continue; }
 
+        // The extrema are computed in a single pass over the particles,
+        // shared with the other particle reduced diagnostics of this step
+        WarpX::GetInstance().reduced_diags->m_species_moments.Request(i_s, broker);
+
+#if (defined WARPX_QED)
         // get WarpXParticleContainer class object
         auto & myspc = mypc.GetParticleContainer(i_s);
 
-        // get mass (Real)
-        auto m = myspc.getMass();
-        auto is_photon = myspc.AmIA<PhysicalSpecies::photon>();
-        if ( is_photon ) {
-            m = PhysConst::m_e;
-        }
-
-        using PType = typename WarpXParticleContainer::SuperParticleType;
-
-        // xmin
-#if (defined WARPX_DIM_RZ)
-        Real xmin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(0)*std::cos(p.rdata(PIdx::theta)); });
-        ParallelDescriptor::ReduceRealMin(xmin);
-#else
-        Real xmin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(0); });
-        ParallelDescriptor::ReduceRealMin(xmin);
-#endif
-
-        // xmax
-#if (defined WARPX_DIM_RZ)
-        Real xmax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(0)*std::cos(p.rdata(PIdx::theta)); });
-        ParallelDescriptor::ReduceRealMax(xmax);
-#else
-        Real xmax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(0); });
-        ParallelDescriptor::ReduceRealMax(xmax);
-#endif
-
-        // ymin
-#if (defined WARPX_DIM_RZ)
-        Real ymin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(0)*std::sin(p.rdata(PIdx::theta)); });
-        ParallelDescriptor::ReduceRealMin(ymin);
-#elif (defined WARPX_DIM_XZ)
-        Real ymin = 0.0_rt;
-#else
-        Real ymin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(1); });
-        ParallelDescriptor::ReduceRealMin(ymin);
-#endif
-
-        // ymax
-#if (defined WARPX_DIM_RZ)
-        Real ymax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(0)*std::sin(p.rdata(PIdx::theta)); });
-        ParallelDescriptor::ReduceRealMax(ymax);
-#elif (defined WARPX_DIM_XZ)
-        Real ymax = 0.0_rt;
-#else
-        Real ymax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(1); });
-        ParallelDescriptor::ReduceRealMax(ymax);
-#endif
-
-        // zmin
-        Real zmin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(index_z); });
-        ParallelDescriptor::ReduceRealMin(zmin);
-
-        // zmax
-        Real zmax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.pos(index_z); });
-        ParallelDescriptor::ReduceRealMax(zmax);
-
-        // uxmin
-        Real uxmin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::ux); });
-        ParallelDescriptor::ReduceRealMin(uxmin);
-
-        // uxmax
-        Real uxmax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::ux); });
-        ParallelDescriptor::ReduceRealMax(uxmax);
-
-        // uymin
-        Real uymin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::uy); });
-        ParallelDescriptor::ReduceRealMin(uymin);
-
-        // uymax
-        Real uymax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::uy); });
-        ParallelDescriptor::ReduceRealMax(uymax);
-
-        // uzmin
-        Real uzmin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::uz); });
-        ParallelDescriptor::ReduceRealMin(uzmin);
-
-        // uzmax
-        Real uzmax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::uz); });
-        ParallelDescriptor::ReduceRealMax(uzmax);
-
-        // gmin
-        Real gmin = 0.0_rt;
-        if ( is_photon ) {
-            gmin = ReduceMin( myspc,
-            [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-            {
-                Real ux = p.rdata(PIdx::ux);
-                Real uy = p.rdata(PIdx::uy);
-                Real uz = p.rdata(PIdx::uz);
-                Real us = ux*ux + uy*uy + uz*uz;
-                return std::sqrt(us*inv_c2);
-            });
-        } else {
-            gmin = ReduceMin( myspc,
-            [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-            {
-                Real ux = p.rdata(PIdx::ux);
-                Real uy = p.rdata(PIdx::uy);
-                Real uz = p.rdata(PIdx::uz);
-                Real us = ux*ux + uy*uy + uz*uz;
-                return std::sqrt(1.0_rt + us*inv_c2);
-            });
-        }
-        ParallelDescriptor::ReduceRealMin(gmin);
-
-        // gmax
-        Real gmax = 0.0_rt;
-        if ( is_photon ) {
-            gmax = ReduceMax( myspc,
-            [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-            {
-                Real ux = p.rdata(PIdx::ux);
-                Real uy = p.rdata(PIdx::uy);
-                Real uz = p.rdata(PIdx::uz);
-                Real us = ux*ux + uy*uy + uz*uz;
-                return std::sqrt(us*inv_c2);
-            });
-        } else {
-            gmax = ReduceMax( myspc,
-            [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-            {
-                Real ux = p.rdata(PIdx::ux);
-                Real uy = p.rdata(PIdx::uy);
-                Real uz = p.rdata(PIdx::uz);
-                Real us = ux*ux + uy*uy + uz*uz;
-                return std::sqrt(1.0_rt + us*inv_c2);
-            });
-        }
-        ParallelDescriptor::ReduceRealMax(gmax);
-
-        // wmin
-        Real wmin = ReduceMin( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::w); });
-        ParallelDescriptor::ReduceRealMin(wmin);
-
-        // wmax
-        Real wmax = ReduceMax( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p)
-        { return p.rdata(PIdx::w); });
-        ParallelDescriptor::ReduceRealMax(wmax);
-
-#if (defined WARPX_QED)
         // get number of level (int)
         const auto level_number = WarpX::GetInstance().finestLevel();
 
         // compute chimin and chimax
-        Real chimin_f = 0.0_rt;
-        Real chimax_f = 0.0_rt;
+        Real& chimin_f = m_chi_extrema[0];
+        Real& chimax_f = m_chi_extrema[1];
+        chimin_f = 0.0_rt;
+        chimax_f = 0.0_rt;
         GetExternalEField get_externalE;
         GetExternalBField get_externalB;
 
@@ -456,32 +279,73 @@ void ParticleExtrema::ComputeDiags (int step)
                 chimin_f = *std::min_element(chimin.begin(), chimin.end());
                 chimax_f = *std::max_element(chimax.begin(), chimax.end());
             }
-            ParallelDescriptor::ReduceRealMin(chimin_f);
-            ParallelDescriptor::ReduceRealMax(chimax_f);
+            // reduced over the MPI ranks with the other buffers of the broker
+            broker.Min(&chimin_f, 1);
+            broker.Max(&chimax_f, 1);
         }
 #endif
+    }
+    // end loop over species
+}
+// end void ParticleExtrema::ComputeLocalDiags
+
+// function that computes the particle extrema from the reduced buffers
+void ParticleExtrema::FinishDiags (int step)
+{
+
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // get MultiParticleContainer class object
+    auto & mypc = WarpX::GetInstance().GetPartContainer();
+
+    // get number of species (int)
+    const auto nSpecies = mypc.nSpecies();
+
+    // get species names (std::vector<std::string>)
+    const auto species_names = mypc.GetSpeciesNames();
+
+    // loop over species
+    for (int i_s = 0; i_s < nSpecies; ++i_s)
+    {
+
+        // only chosen species does
+        if (species_names[i_s] != m_species_name) { continue; }
+
+        // get WarpXParticleContainer class object
+        auto & myspc = mypc.GetParticleContainer(i_s);
+
+        // get mass (Real)
+        auto m = myspc.getMass();
+        auto is_photon = myspc.AmIA<PhysicalSpecies::photon>();
+        if ( is_photon ) {
+            m = PhysConst::m_e;
+        }
 
-        m_data[0]  = xmin;
-        m_data[1]  = xmax;
-        m_data[2]  = ymin;
-        m_data[3]  = ymax;
-        m_data[4]  = zmin;
-        m_data[5]  = zmax;
-        m_data[6]  = uxmin*m;
-        m_data[7]  = uxmax*m;
-        m_data[8]  = uymin*m;
-        m_data[9]  = uymax*m;
-        m_data[10] = uzmin*m;
-        m_data[11] = uzmax*m;
-        m_data[12] = gmin;
-        m_data[13] = gmax;
-        m_data[14] = wmin;
-        m_data[15] = wmax;
+        // moments reduced over the MPI ranks by the broker
+        SpeciesMoments const& moments = WarpX::GetInstance().reduced_diags->m_species_moments.Get(i_s);
+
+        m_data[0]  = moments.min[ExtIdx::x];
+        m_data[1]  = moments.max[ExtIdx::x];
+        m_data[2]  = moments.min[ExtIdx::y];
+        m_data[3]  = moments.max[ExtIdx::y];
+        m_data[4]  = moments.min[ExtIdx::z];
+        m_data[5]  = moments.max[ExtIdx::z];
+        m_data[6]  = moments.min[ExtIdx::ux]*m;
+        m_data[7]  = moments.max[ExtIdx::ux]*m;
+        m_data[8]  = moments.min[ExtIdx::uy]*m;
+        m_data[9]  = moments.max[ExtIdx::uy]*m;
+        m_data[10] = moments.min[ExtIdx::uz]*m;
+        m_data[11] = moments.max[ExtIdx::uz]*m;
+        m_data[12] = moments.min[ExtIdx::gamma];
+        m_data[13] = moments.max[ExtIdx::gamma];
+        m_data[14] = moments.min[ExtIdx::w];
+        m_data[15] = moments.max[ExtIdx::w];
 #if (defined WARPX_QED)
         if (myspc.DoQED())
         {
-            m_data[16] = chimin_f;
-            m_data[17] = chimax_f;
+            m_data[16] = m_chi_extrema[0];
+            m_data[17] = m_chi_extrema[1];
         }
 #endif
 
@@ -489,4 +353,4 @@ void ParticleExtrema::ComputeDiags (int step)
     // end loop over species
 
 }
-// end void ParticleEnergy::ComputeDiags
+// end void ParticleExtrema::FinishDiags
@@ -6,6 +6,7 @@
  */
 
 #include "ParticleHistogram.H"
+#include "HistogramDeposition.H"
 #include "WarpX.H"
 #include "Particles/Pusher/GetAndSetPosition.H"
 #include "Utils/WarpXUtil.H"
@@ -19,19 +20,11 @@
 #include <algorithm>
 #include <limits>
 #include <memory>
+#include <vector>
 
 
 using namespace amrex;
 
-struct NormalizationType {
-    enum {
-        no_normalization = 0,
-        unity_particle_weight,
-        max_to_unity,
-        area_to_unity
-    };
-};
-
 // constructor
 ParticleHistogram::ParticleHistogram (std::string rd_name)
 : ReducedDiags{rd_name}
@@ -132,6 +125,13 @@ ParticleHistogram::ParticleHistogram (std::string rd_name)
 
 // function that computes the histogram
 void ParticleHistogram::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void ParticleHistogram::ComputeDiags
+
+// function that computes the local histogram
+void ParticleHistogram::ComputeLocalDiags (int step, ReductionBroker& broker)
 {
 
     // Judge if the diags should be done
@@ -166,15 +166,22 @@ void ParticleHistogram::ComputeDiags (int step)
 
     // zero-out old data on the host
     std::fill(m_data.begin(), m_data.end(), amrex::Real(0.0));
+#ifdef AMREX_USE_GPU
     amrex::Gpu::DeviceVector< amrex::Real > d_data( m_data.size(), 0.0 );
     amrex::Real* const AMREX_RESTRICT dptr_data = d_data.dataPtr();
+#endif
 
     int const nlevs = std::max(0, myspc.finestLevel()+1);
-    for (int lev = 0; lev < nlevs; ++lev) {
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
-        {
+    {
+#ifndef AMREX_USE_GPU
+        // on CPU, each thread fills its own histogram, without atomics
+        std::vector< amrex::Real > thread_data( m_data.size(), 0.0_rt );
+        amrex::Real* const AMREX_RESTRICT dptr_data = thread_data.data();
+#endif
+        for (int lev = 0; lev < nlevs; ++lev) {
             for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti)
             {
                 auto const GetPosition = GetParticlePosition(pti);
@@ -187,9 +194,8 @@ void ParticleHistogram::ComputeDiags (int step)
 
                 long const np = pti.numParticles();
 
-                //Flag particles that need to be copied if they cross the z_slice
-                amrex::ParallelFor(np,
-                   [=] AMREX_GPU_DEVICE(int i)
+                DepositHistogram(np, num_bins, dptr_data,
+                   [=] AMREX_GPU_HOST_DEVICE (int i, int& bin, amrex::Real& weight) -> bool
                 {
                     amrex::ParticleReal x, y, z;
                     GetPosition(i, x, y, z);
@@ -201,35 +207,45 @@ void ParticleHistogram::ComputeDiags (int step)
                     // don't count a particle if it is filtered out
                     if (do_parser_filter)
                         if (!fun_filterparser(t, x, y, z, ux, uy, uz))
-                            return;
+                            return false;
                     // continue function if particle is not filtered out
                     auto const f = fun_partparser(t, x, y, z, ux, uy, uz);
 
                     // determine particle bin
-                    int const bin = int(Math::floor((f-bin_min)/bin_size));
-                    if ( bin<0 || bin>=num_bins ) return; // discard if out-of-range
-
-                    // add particle to histogram bin
-                    //! @todo performance: on CPU, we are probably faster by
-                    //        letting each thread compute its own histogram and
-                    //        then we reduce the histograms after the loop
-                    if ( is_unity_particle_weight ) {
-                        amrex::HostDevice::Atomic::Add(&dptr_data[bin], 1.0_rt);
-                    } else {
-                        amrex::HostDevice::Atomic::Add(&dptr_data[bin], w);
-                    }
+                    bin = int(Math::floor((f-bin_min)/bin_size));
+                    if ( bin<0 || bin>=num_bins ) return false; // discard if out-of-range
+
+                    weight = is_unity_particle_weight ? 1.0_rt : w;
+                    return true;
                 });
             }
         }
+#ifndef AMREX_USE_GPU
+        // reduce the histograms of the threads
+#ifdef AMREX_USE_OMP
+#pragma omp critical (particle_histogram_reduce)
+#endif
+        for (int i = 0; i < num_bins; ++i) m_data[i] += thread_data[i];
+#endif
     }
 
+#ifdef AMREX_USE_GPU
     // blocking copy from device to host
     amrex::Gpu::copy(amrex::Gpu::deviceToHost,
         d_data.begin(), d_data.end(), m_data.begin());
+#endif
+
+    // reduced sum over mpi ranks, with the other buffers of the broker
+    broker.Sum(m_data.data(), static_cast<int>(m_data.size()));
+}
+// end void ParticleHistogram::ComputeLocalDiags
 
-    // reduced sum over mpi ranks
-    ParallelDescriptor::ReduceRealSum
-        (m_data.data(), m_data.size(), ParallelDescriptor::IOProcessorNumber());
+// function that normalizes the reduced histogram
+void ParticleHistogram::FinishDiags (int step)
+{
+
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) return;
 
     // normalize the maximum value to be one
     if ( m_norm == NormalizationType::max_to_unity )
@@ -262,4 +278,4 @@ void ParticleHistogram::ComputeDiags (int step)
     }
 
 }
-// end void ParticleHistogram::ComputeDiags
+// end void ParticleHistogram::FinishDiags
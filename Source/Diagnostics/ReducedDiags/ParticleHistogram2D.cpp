@@ -0,0 +1,293 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "ParticleHistogram2D.H"
+#include "ParticleHistogram.H"
+#include "HistogramDeposition.H"
+#include "WarpX.H"
+#include "Particles/Pusher/GetAndSetPosition.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX_GpuContainers.H>
+#include <AMReX_Math.H>
+#include <AMReX_REAL.H>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using namespace amrex;
+
+// constructor
+ParticleHistogram2D::ParticleHistogram2D (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+
+    ParmParse pp_rd_name(rd_name);
+
+    // read species
+    std::string selected_species_name;
+    pp_rd_name.get("species",selected_species_name);
+
+    // read bin parameters
+    pp_rd_name.get("bin_number_abs",m_bin_num_abs);
+    pp_rd_name.get("bin_number_ord",m_bin_num_ord);
+    getWithParser(pp_rd_name, "bin_max_abs", m_bin_max_abs);
+    getWithParser(pp_rd_name, "bin_min_abs", m_bin_min_abs);
+    getWithParser(pp_rd_name, "bin_max_ord", m_bin_max_ord);
+    getWithParser(pp_rd_name, "bin_min_ord", m_bin_min_ord);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_bin_num_abs > 0 && m_bin_num_ord > 0,
+        "ParticleHistogram2D: bin_number_abs and bin_number_ord must be positive");
+    m_bin_size_abs = (m_bin_max_abs - m_bin_min_abs) / m_bin_num_abs;
+    m_bin_size_ord = (m_bin_max_ord - m_bin_min_ord) / m_bin_num_ord;
+
+    // read histogram functions
+    std::string function_string = "";
+    Store_parserString(pp_rd_name,"histogram_function_abs(t,x,y,z,ux,uy,uz)",
+                       function_string);
+    m_parser_abs = std::make_unique<ParserWrapper<m_nvars>>(
+        makeParser(function_string,{"t","x","y","z","ux","uy","uz"}));
+    function_string = "";
+    Store_parserString(pp_rd_name,"histogram_function_ord(t,x,y,z,ux,uy,uz)",
+                       function_string);
+    m_parser_ord = std::make_unique<ParserWrapper<m_nvars>>(
+        makeParser(function_string,{"t","x","y","z","ux","uy","uz"}));
+
+    // read normalization type
+    std::string norm_string = "default";
+    pp_rd_name.query("normalization",norm_string);
+
+    // set normalization type
+    if ( norm_string == "default" ) {
+        m_norm = NormalizationType::no_normalization;
+    } else if ( norm_string == "unity_particle_weight" ) {
+        m_norm = NormalizationType::unity_particle_weight;
+    } else if ( norm_string == "max_to_unity" ) {
+        m_norm = NormalizationType::max_to_unity;
+    } else if ( norm_string == "area_to_unity" ) {
+        m_norm = NormalizationType::area_to_unity;
+    } else {
+        Abort("Unknown ParticleHistogram2D normalization type.");
+    }
+
+    // get MultiParticleContainer class object
+    const auto & mypc = WarpX::GetInstance().GetPartContainer();
+    // get species names (std::vector<std::string>)
+    auto const species_names = mypc.GetSpeciesNames();
+    // select species
+    for ( int i = 0; i < mypc.nSpecies(); ++i )
+    {
+        if ( selected_species_name == species_names[i] ){
+            m_selected_species_id = i;
+        }
+    }
+    // if m_selected_species_id is not modified
+    if ( m_selected_species_id == -1 ){
+        Abort("Unknown species for ParticleHistogram2D reduced diagnostic.");
+    }
+
+    // Read optional filter
+    std::string buf;
+    m_do_parser_filter = pp_rd_name.query("filter_function(t,x,y,z,ux,uy,uz)", buf);
+    if (m_do_parser_filter) {
+        std::string filter_string = "";
+        Store_parserString(pp_rd_name,"filter_function(t,x,y,z,ux,uy,uz)", filter_string);
+        m_parser_filter = std::make_unique<ParserWrapper<m_nvars>>(
+                                     makeParser(filter_string,{"t","x","y","z","ux","uy","uz"}));
+    }
+
+    // resize data array
+    m_data.resize(m_bin_num_abs*m_bin_num_ord,0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            for (int i = 0; i < m_bin_num_abs; ++i)
+            {
+                Real const a = m_bin_min_abs + m_bin_size_abs*(Real(i)+0.5_rt);
+                for (int j = 0; j < m_bin_num_ord; ++j)
+                {
+                    Real const b = m_bin_min_ord + m_bin_size_ord*(Real(j)+0.5_rt);
+                    ofs << m_sep;
+                    ofs << "[" + std::to_string(3+i*m_bin_num_ord+j) + "]";
+                    ofs << "bin" + std::to_string(1+i) + "_" + std::to_string(1+j)
+                                 + "=(" + std::to_string(a) + "," + std::to_string(b) + ")()";
+                }
+            }
+            ofs << std::endl;
+            // close file
+            ofs.close();
+        }
+    }
+
+}
+// end constructor
+
+// function that computes the 2D histogram
+void ParticleHistogram2D::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void ParticleHistogram2D::ComputeDiags
+
+// function that computes the local histogram
+void ParticleHistogram2D::ComputeLocalDiags (int step, ReductionBroker& broker)
+{
+
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) return;
+
+    // get a reference to WarpX instance
+    auto & warpx = WarpX::GetInstance();
+
+    // get time at level 0
+    auto const t = warpx.gett_new(0);
+
+    // get MultiParticleContainer class object
+    const auto & mypc = warpx.GetPartContainer();
+
+    // get WarpXParticleContainer class object
+    auto & myspc = mypc.GetParticleContainer(m_selected_species_id);
+
+    // get parsers
+    HostDeviceParser<m_nvars> fun_abs = getParser(m_parser_abs);
+    HostDeviceParser<m_nvars> fun_ord = getParser(m_parser_ord);
+
+    // get filter parser
+    HostDeviceParser<m_nvars> fun_filterparser = getParser(m_parser_filter);
+
+    // declare local variables
+    int const num_bins_abs = m_bin_num_abs;
+    int const num_bins_ord = m_bin_num_ord;
+    int const num_bins = num_bins_abs*num_bins_ord;
+    Real const bin_min_abs  = m_bin_min_abs;
+    Real const bin_size_abs = m_bin_size_abs;
+    Real const bin_min_ord  = m_bin_min_ord;
+    Real const bin_size_ord = m_bin_size_ord;
+    const bool is_unity_particle_weight =
+        (m_norm == NormalizationType::unity_particle_weight) ? true : false;
+
+    bool const do_parser_filter = m_do_parser_filter;
+
+    // zero-out old data on the host
+    std::fill(m_data.begin(), m_data.end(), amrex::Real(0.0));
+#ifdef AMREX_USE_GPU
+    amrex::Gpu::DeviceVector< amrex::Real > d_data( m_data.size(), 0.0 );
+    amrex::Real* const AMREX_RESTRICT dptr_data = d_data.dataPtr();
+#endif
+
+    int const nlevs = std::max(0, myspc.finestLevel()+1);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    {
+#ifndef AMREX_USE_GPU
+        // on CPU, each thread fills its own histogram, without atomics
+        std::vector< amrex::Real > thread_data( m_data.size(), 0.0_rt );
+        amrex::Real* const AMREX_RESTRICT dptr_data = thread_data.data();
+#endif
+        for (int lev = 0; lev < nlevs; ++lev) {
+            for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti)
+            {
+                auto const GetPosition = GetParticlePosition(pti);
+
+                auto & attribs = pti.GetAttribs();
+                Real* const AMREX_RESTRICT d_w = attribs[PIdx::w].dataPtr();
+                Real* const AMREX_RESTRICT d_ux = attribs[PIdx::ux].dataPtr();
+                Real* const AMREX_RESTRICT d_uy = attribs[PIdx::uy].dataPtr();
+                Real* const AMREX_RESTRICT d_uz = attribs[PIdx::uz].dataPtr();
+
+                long const np = pti.numParticles();
+
+                DepositHistogram(np, num_bins, dptr_data,
+                   [=] AMREX_GPU_HOST_DEVICE (int i, int& bin, amrex::Real& weight) -> bool
+                {
+                    amrex::ParticleReal x, y, z;
+                    GetPosition(i, x, y, z);
+                    auto const w  = d_w[i];
+                    auto const ux = d_ux[i] / PhysConst::c;
+                    auto const uy = d_uy[i] / PhysConst::c;
+                    auto const uz = d_uz[i] / PhysConst::c;
+
+                    // don't count a particle if it is filtered out
+                    if (do_parser_filter)
+                        if (!fun_filterparser(t, x, y, z, ux, uy, uz))
+                            return false;
+
+                    // determine particle bins, discard if out-of-range
+                    auto const fa = fun_abs(t, x, y, z, ux, uy, uz);
+                    int const bin_abs = int(Math::floor((fa-bin_min_abs)/bin_size_abs));
+                    if ( bin_abs<0 || bin_abs>=num_bins_abs ) return false;
+                    auto const fo = fun_ord(t, x, y, z, ux, uy, uz);
+                    int const bin_ord = int(Math::floor((fo-bin_min_ord)/bin_size_ord));
+                    if ( bin_ord<0 || bin_ord>=num_bins_ord ) return false;
+
+                    bin = bin_abs*num_bins_ord + bin_ord;
+                    weight = is_unity_particle_weight ? 1.0_rt : w;
+                    return true;
+                });
+            }
+        }
+#ifndef AMREX_USE_GPU
+        // reduce the histograms of the threads
+#ifdef AMREX_USE_OMP
+#pragma omp critical (particle_histogram_2d_reduce)
+#endif
+        for (int i = 0; i < num_bins; ++i) m_data[i] += thread_data[i];
+#endif
+    }
+
+#ifdef AMREX_USE_GPU
+    // blocking copy from device to host
+    amrex::Gpu::copy(amrex::Gpu::deviceToHost,
+        d_data.begin(), d_data.end(), m_data.begin());
+#endif
+
+    // reduced sum over mpi ranks, with the other buffers of the broker
+    broker.Sum(m_data.data(), static_cast<int>(m_data.size()));
+}
+// end void ParticleHistogram2D::ComputeLocalDiags
+
+// function that normalizes the reduced histogram
+void ParticleHistogram2D::FinishDiags (int step)
+{
+
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) return;
+
+    // normalize the maximum value to be one
+    if ( m_norm == NormalizationType::max_to_unity )
+    {
+        Real const f_max = *std::max_element(m_data.begin(), m_data.end());
+        if ( f_max > std::numeric_limits<Real>::min() ) {
+            for ( auto& f : m_data ) f /= f_max;
+        }
+        return;
+    }
+
+    // normalize the area (integral) to be one
+    if ( m_norm == NormalizationType::area_to_unity )
+    {
+        Real f_area = 0.0_rt;
+        for ( auto const f : m_data ) f_area += f * m_bin_size_abs * m_bin_size_ord;
+        if ( f_area > std::numeric_limits<Real>::min() ) {
+            for ( auto& f : m_data ) f /= f_area;
+        }
+        return;
+    }
+
+}
+// end void ParticleHistogram2D::FinishDiags
@@ -75,6 +75,32 @@ ParticleNumber::ParticleNumber (std::string rd_name)
 
 // function that computes total number of macroparticles and physical particles
 void ParticleNumber::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void ParticleNumber::ComputeDiags
+
+// function that registers the local numbers of macroparticles and the moments in the broker
+void ParticleNumber::ComputeLocalDiags (int step, ReductionBroker& broker)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    const auto & mypc = WarpX::GetInstance().GetPartContainer();
+    const int nSpecies = mypc.nSpecies();
+    m_numbers.resize(nSpecies);
+    for (int i_s = 0; i_s < nSpecies; ++i_s)
+    {
+        // local number of macroparticles of this rank
+        m_numbers[i_s] = mypc.GetParticleContainer(i_s).TotalNumberOfParticles(true, true);
+        WarpX::GetInstance().reduced_diags->m_species_moments.Request(i_s, broker);
+    }
+    broker.Sum(m_numbers.data(), nSpecies);
+}
+// end void ParticleNumber::ComputeLocalDiags
+
+// function that computes the numbers of macroparticles and the sums of weights
+void ParticleNumber::FinishDiags (int step)
 {
 
     // Judge if the diags should be done
@@ -96,41 +122,33 @@ void ParticleNumber::ComputeDiags (int step)
     const int idx_first_species_sum_weight = idx_total_sum_weight + 1;
 
     // Initialize total number of macroparticles and total weight (all species) to 0
-    m_data[idx_total_macroparticles] = 0.0_rt;
     m_data[idx_total_sum_weight] = 0.0_rt;
+    amrex::Long total_macroparticles = 0;
 
     // loop over species
     for (int i_s = 0; i_s < nSpecies; ++i_s)
     {
-        // get WarpXParticleContainer class object
-        const auto & myspc = mypc.GetParticleContainer(i_s);
-
         // Save total number of macroparticles for this species
-        m_data[idx_first_species_macroparticles + i_s] = myspc.TotalNumberOfParticles();
+        m_data[idx_first_species_macroparticles + i_s] = static_cast<amrex::Real>(m_numbers[i_s]);
 
-        using PType = typename WarpXParticleContainer::SuperParticleType;
-
-        // Reduction to compute sum of weights for this species
-        auto Wtot = ReduceSum( myspc,
-        [=] AMREX_GPU_HOST_DEVICE (const PType& p) -> amrex::Real
-        {
-            return p.rdata(PIdx::w);
-        });
-
-        // MPI reduction
-        amrex::ParallelDescriptor::ReduceRealSum
-            (Wtot, amrex::ParallelDescriptor::IOProcessorNumber());
+        // Sum of weights for this species, computed in a single pass over the particles
+        // shared with the other particle reduced diagnostics of this step
+        const amrex::Real Wtot =
+            WarpX::GetInstance().reduced_diags->m_species_moments.Get(i_s).sum[SumIdx::w];
 
         // Save sum of particles weight for this species
         m_data[idx_first_species_sum_weight + i_s] = Wtot;
 
 
         // Increase total number of macroparticles and total weight (all species)
-        m_data[idx_total_macroparticles] += m_data[idx_first_species_macroparticles + i_s];
+        total_macroparticles += m_numbers[i_s];
         m_data[idx_total_sum_weight] += m_data[idx_first_species_sum_weight + i_s];
     }
     // end loop over species
 
+    // Save total number of macroparticles (all species)
+    m_data[idx_total_macroparticles] = static_cast<amrex::Real>(total_macroparticles);
+
     /* m_data now contains up-to-date values for:
      *  [total number of macroparticles (all species),
      *   total number of macroparticles (species 1),
@@ -142,4 +160,4 @@ void ParticleNumber::ComputeDiags (int step)
      *   sum of particles weight (species n)] */
 
 }
-// end void ParticleNumber::ComputeDiags
+// end void ParticleNumber::FinishDiags
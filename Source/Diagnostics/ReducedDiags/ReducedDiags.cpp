@@ -12,6 +12,7 @@
 #include <AMReX_Utility.H>
 
 #include <iomanip>
+#include <sstream>
 
 using namespace amrex;
 
@@ -59,6 +60,25 @@ ReducedDiags::ReducedDiags (std::string rd_name)
     // read separator
     pp_rd_name.query("separator", m_sep);
 
+    // read number of outputs buffered in memory between two writes
+    pp_rd_name.query("flush_interval", m_flush_interval);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_flush_interval > 0,
+        "<reduced_diags_name>.flush_interval must be strictly positive");
+
+    // read output format
+    std::string format = "txt";
+    pp_rd_name.query("format", format);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(format == "txt" || format == "binary",
+        "<reduced_diags_name>.format must be txt or binary");
+    m_binary = (format == "binary");
+
+    // replace / create binary output file; the text file only holds the header
+    if (m_binary && m_IsNotRestart && ParallelDescriptor::IOProcessor())
+    {
+        std::ofstream ofs{m_path+m_rd_name+".bin", std::ios::trunc | std::ios::binary};
+        ofs.close();
+    }
+
 }
 // end constructor
 
@@ -76,9 +96,20 @@ void ReducedDiags::BackwardCompatibility ()
 void ReducedDiags::WriteToFile (int step) const
 {
 
-    // open file
-    std::ofstream ofs{m_path + m_rd_name + "." + m_extension,
-        std::ofstream::out | std::ofstream::app};
+    if (m_binary)
+    {
+        // one record of doubles: step, time, data
+        std::vector<double> record;
+        record.reserve(m_data.size() + 2);
+        record.push_back(static_cast<double>(step+1));
+        record.push_back(static_cast<double>(WarpX::GetInstance().gett_new(0)));
+        record.insert(record.end(), m_data.begin(), m_data.end());
+        AppendToBuffer(std::string(reinterpret_cast<const char*>(record.data()),
+                                   record.size()*sizeof(double)));
+        return;
+    }
+
+    std::ostringstream ofs;
 
     // write step
     ofs << step+1;
@@ -100,10 +131,47 @@ void ReducedDiags::WriteToFile (int step) const
     // end loop over data size
 
     // end line
-    ofs << std::endl;
+    ofs << "\n";
 
-    // close file
-    ofs.close();
+    AppendToBuffer(ofs.str());
 
 }
 // end ReducedDiags::WriteToFile
+
+void ReducedDiags::AppendToBuffer (const std::string& output) const
+{
+    m_buffer += output;
+    ++m_nbuffered;
+    if (m_nbuffered >= m_flush_interval) { Flush(); }
+}
+
+void ReducedDiags::Flush () const
+{
+    if (m_buffer.empty()) { return; }
+
+    const std::string filename = m_binary ?
+        m_path + m_rd_name + ".bin" : m_path + m_rd_name + "." + m_extension;
+    std::ofstream ofs{filename, std::ofstream::out | std::ofstream::app | std::ofstream::binary};
+    ofs.write(m_buffer.data(), static_cast<std::streamsize>(m_buffer.size()));
+    ofs.close();
+
+    m_buffer.clear();
+    m_nbuffered = 0;
+}
+
+void ReducedDiags::ComputeLocalDiags (int step, ReductionBroker& /*broker*/)
+{
+    ComputeDiags(step);
+}
+
+void ReducedDiags::FinishDiags (int /*step*/)
+{
+}
+
+void ReducedDiags::ComputeDiagsAlone (int step)
+{
+    ReductionBroker broker;
+    ComputeLocalDiags(step, broker);
+    broker.Reduce();
+    FinishDiags(step);
+}
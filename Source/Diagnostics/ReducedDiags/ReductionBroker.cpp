@@ -0,0 +1,96 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "ReductionBroker.H"
+#include "Utils/WarpXProfilerWrapper.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Vector.H>
+
+#include <algorithm>
+
+using namespace amrex;
+
+void
+ReductionBroker::Sum (Real* data, int n)
+{
+    if (n > 0) { m_sum.push_back({data, n}); }
+}
+
+void
+ReductionBroker::Sum (Long* data, int n)
+{
+    if (n > 0) { m_sum_long.push_back({data, n}); }
+}
+
+void
+ReductionBroker::Max (Real* data, int n)
+{
+    if (n > 0) { m_max.push_back({data, n}); }
+}
+
+void
+ReductionBroker::Min (Real* data, int n)
+{
+    if (n > 0) { m_min.push_back({data, n}); }
+}
+
+void
+ReductionBroker::Reduce ()
+{
+    WARPX_PROFILE("ReductionBroker::Reduce()");
+
+    // all the sums in one message
+    Vector<Real> sums;
+    for (Buffer const& b : m_sum) { sums.insert(sums.end(), b.data, b.data+b.n); }
+    if (!sums.empty()) {
+        ParallelDescriptor::ReduceRealSum(sums.data(), static_cast<int>(sums.size()));
+        int offset = 0;
+        for (Buffer const& b : m_sum) {
+            std::copy(sums.begin()+offset, sums.begin()+offset+b.n, b.data);
+            offset += b.n;
+        }
+    }
+
+    // all the sums of integers in one message
+    Vector<Long> sums_long;
+    for (LongBuffer const& b : m_sum_long) {
+        sums_long.insert(sums_long.end(), b.data, b.data+b.n);
+    }
+    if (!sums_long.empty()) {
+        ParallelDescriptor::ReduceLongSum(sums_long.data(), static_cast<int>(sums_long.size()));
+        int offset = 0;
+        for (LongBuffer const& b : m_sum_long) {
+            std::copy(sums_long.begin()+offset, sums_long.begin()+offset+b.n, b.data);
+            offset += b.n;
+        }
+    }
+
+    // all the maxima and minima in one message: min(x) = -max(-x)
+    Vector<Real> maxs;
+    for (Buffer const& b : m_max) { maxs.insert(maxs.end(), b.data, b.data+b.n); }
+    for (Buffer const& b : m_min) {
+        for (int i = 0; i < b.n; ++i) { maxs.push_back(-b.data[i]); }
+    }
+    if (!maxs.empty()) {
+        ParallelDescriptor::ReduceRealMax(maxs.data(), static_cast<int>(maxs.size()));
+        int offset = 0;
+        for (Buffer const& b : m_max) {
+            std::copy(maxs.begin()+offset, maxs.begin()+offset+b.n, b.data);
+            offset += b.n;
+        }
+        for (Buffer const& b : m_min) {
+            for (int i = 0; i < b.n; ++i) { b.data[i] = -maxs[offset+i]; }
+            offset += b.n;
+        }
+    }
+
+    m_sum.clear();
+    m_sum_long.clear();
+    m_max.clear();
+    m_min.clear();
+}
@@ -113,6 +113,13 @@ RhoMaximum::RhoMaximum (std::string rd_name)
 
 // function that computes maximum charge density values
 void RhoMaximum::ComputeDiags (int step)
+{
+    ComputeDiagsAlone(step);
+}
+// end void RhoMaximum::ComputeDiags
+
+// function that computes the local extrema of rho, reduced over the MPI ranks by the broker
+void RhoMaximum::ComputeLocalDiags (int step, ReductionBroker& broker)
 {
     // Judge if the diags should be done
     if (!m_intervals.contains(step+1)) { return; }
@@ -127,6 +134,10 @@ void RhoMaximum::ComputeDiags (int step)
     // Min and max of total rho + max of |rho| for each species
     const int noutputs_per_level = 2+n_charged_species;
 
+    constexpr int idx_max_rho_data = 0;
+    constexpr int idx_min_rho_data = 1;
+    constexpr int idx_first_species_data = 2;
+
     // loop over refinement levels
     for (int lev = 0; lev < nLevel; ++lev)
     {
@@ -144,13 +155,13 @@ void RhoMaximum::ComputeDiags (int step)
         constexpr int i_buffer = 0;
         m_rho_functors[lev][idx_total_rho_functor]->operator()(mf_temp, icomp, i_buffer);
 
-        constexpr int idx_max_rho_data = 0;
-        constexpr int idx_min_rho_data = 1;
-        constexpr int idx_first_species_data = 2;
+        // the values of this rank, reduced over the MPI ranks by the broker
+        constexpr int nghost = 0;
+        constexpr bool local = true;
 
         // Fill output array with min and max of total rho
-        m_data[lev*noutputs_per_level + idx_max_rho_data] = mf_temp.max(icomp);
-        m_data[lev*noutputs_per_level + idx_min_rho_data] = mf_temp.min(icomp);
+        m_data[lev*noutputs_per_level + idx_max_rho_data] = mf_temp.max(icomp, nghost, local);
+        m_data[lev*noutputs_per_level + idx_min_rho_data] = mf_temp.min(icomp, nghost, local);
 
         // Loop over all charged species
         for (int i = 0; i < n_charged_species; ++i)
@@ -158,13 +169,20 @@ void RhoMaximum::ComputeDiags (int step)
             // Fill temporary MultiFAB with the species charge density
             m_rho_functors[lev][idx_first_species_functor+i]->operator()(mf_temp, icomp, i_buffer);
             // Fill output array with max |rho| of species
-            m_data[lev*noutputs_per_level + idx_first_species_data + i] = mf_temp.norm0();
+            m_data[lev*noutputs_per_level + idx_first_species_data + i] = mf_temp.norm0(icomp, nghost, local);
         }
     }
     // end loop over refinement levels
 
-    /* m_data now contains up-to-date values for:
+    for (int lev = 0; lev < nLevel; ++lev)
+    {
+        broker.Max(&m_data[lev*noutputs_per_level + idx_max_rho_data], 1);
+        broker.Min(&m_data[lev*noutputs_per_level + idx_min_rho_data], 1);
+        broker.Max(&m_data[lev*noutputs_per_level + idx_first_species_data], n_charged_species);
+    }
+
+    /* once reduced by the broker, m_data contains up-to-date values for:
      *  [max(rho), min(rho), max(|rho_charged_species1|), max(|rho_charged_species2|), ...] */
 
 }
-// end void RhoMaximum::ComputeDiags
+// end void RhoMaximum::ComputeLocalDiags
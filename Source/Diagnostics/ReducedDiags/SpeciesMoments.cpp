@@ -0,0 +1,119 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "SpeciesMoments.H"
+#include "WarpX.H"
+#include "Particles/Pusher/GetAndSetPosition.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXProfilerWrapper.H"
+
+#include <AMReX_Reduce.H>
+
+using namespace amrex;
+
+void
+SpeciesMomentsCache::Invalidate ()
+{
+    m_valid.assign(m_valid.size(), false);
+}
+
+SpeciesMoments const&
+SpeciesMomentsCache::Get (int i_s)
+{
+    if (i_s >= static_cast<int>(m_valid.size()) || !m_valid[i_s]) {
+        ReductionBroker broker;
+        Request(i_s, broker);
+        broker.Reduce();
+    }
+    return m_moments[i_s];
+}
+
+void
+SpeciesMomentsCache::Request (int i_s, ReductionBroker& broker)
+{
+    const auto & mypc = WarpX::GetInstance().GetPartContainer();
+    const int nSpecies = mypc.nSpecies();
+    if (static_cast<int>(m_moments.size()) != nSpecies) {
+        m_moments.resize(nSpecies);
+        m_valid.assign(nSpecies, false);
+    }
+    if (m_valid[i_s]) { return; }
+
+    WARPX_PROFILE("SpeciesMomentsCache::Request()");
+
+    auto & myspc = mypc.GetParticleContainer(i_s);
+
+    // Photons have m = 0, but ux, uy and uz are computed assuming the
+    // electron mass. Their "gamma" is their energy in units of m_e c^2.
+    const bool is_photon = myspc.AmIA<PhysicalSpecies::photon>();
+    const Real m = is_photon ? PhysConst::m_e : myspc.getMass();
+    const Real mc2 = m * PhysConst::c * PhysConst::c;
+    Real constexpr inv_c2 = 1.0_rt / (PhysConst::c * PhysConst::c);
+
+    // 9 weighted sums, then the minima and maxima of 8 quantities (see SumIdx and ExtIdx)
+    ReduceOps<ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+              ReduceOpSum, ReduceOpSum, ReduceOpSum, ReduceOpSum,
+              ReduceOpMin, ReduceOpMin, ReduceOpMin, ReduceOpMin,
+              ReduceOpMin, ReduceOpMin, ReduceOpMin, ReduceOpMin,
+              ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax,
+              ReduceOpMax, ReduceOpMax, ReduceOpMax, ReduceOpMax> reduce_op;
+    ReduceData<Real, Real, Real, Real, Real, Real, Real, Real, Real,
+               Real, Real, Real, Real, Real, Real, Real, Real,
+               Real, Real, Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+
+    for (int lev = 0; lev <= myspc.finestLevel(); ++lev)
+    {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti)
+        {
+            const auto GetPosition = GetParticlePosition(pti);
+            auto& attribs = pti.GetAttribs();
+            ParticleReal const * const AMREX_RESTRICT wp = attribs[PIdx::w].dataPtr();
+            ParticleReal const * const AMREX_RESTRICT uxp = attribs[PIdx::ux].dataPtr();
+            ParticleReal const * const AMREX_RESTRICT uyp = attribs[PIdx::uy].dataPtr();
+            ParticleReal const * const AMREX_RESTRICT uzp = attribs[PIdx::uz].dataPtr();
+
+            reduce_op.eval(pti.numParticles(), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i) -> ReduceTuple
+            {
+                ParticleReal x, y, z;
+                GetPosition(i, x, y, z);
+#if (defined WARPX_DIM_XZ)
+                y = 0._prt;
+#endif
+                const Real w = wp[i];
+                const Real ux = uxp[i];
+                const Real uy = uyp[i];
+                const Real uz = uzp[i];
+                const Real us = ux*ux + uy*uy + uz*uz;
+                const Real gamma = is_photon ? std::sqrt(us*inv_c2) : std::sqrt(1.0_rt + us*inv_c2);
+                const Real energy = is_photon ? gamma*mc2 : (gamma - 1.0_rt)*mc2;
+                return {w, w*x, w*y, w*z, w*ux, w*uy, w*uz, w*gamma, w*energy,
+                        x, y, z, ux, uy, uz, gamma, w,
+                        x, y, z, ux, uy, uz, gamma, w};
+            });
+        }
+    }
+
+    auto const r = reduce_data.value();
+    SpeciesMoments& mom = m_moments[i_s];
+    mom.sum = {get<0>(r), get<1>(r), get<2>(r), get<3>(r), get<4>(r),
+               get<5>(r), get<6>(r), get<7>(r), get<8>(r)};
+    mom.min = {get<9>(r), get<10>(r), get<11>(r), get<12>(r),
+               get<13>(r), get<14>(r), get<15>(r), get<16>(r)};
+    mom.max = {get<17>(r), get<18>(r), get<19>(r), get<20>(r),
+               get<21>(r), get<22>(r), get<23>(r), get<24>(r)};
+
+    // reduced over the MPI ranks with the other buffers of the broker
+    broker.Sum(mom.sum.data(), SumIdx::nsums);
+    broker.Min(mom.min.data(), ExtIdx::nquantities);
+    broker.Max(mom.max.data(), ExtIdx::nquantities);
+
+    m_valid[i_s] = true;
+}
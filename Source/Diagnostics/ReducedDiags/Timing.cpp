@@ -0,0 +1,102 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "Timing.H"
+#include "Utils/PhaseTimer.H"
+
+#include <AMReX_ParallelDescriptor.H>
+
+using namespace amrex;
+
+// constructor
+Timing::Timing (std::string rd_name)
+: ReducedDiags{rd_name}
+{
+    // the phases of the steps are timed from now on
+    PhaseTimer::Enable();
+
+    const Vector<std::string> names = PhaseTimer::Names();
+    const int nTimes = names.size();
+    m_last_times.resize(nTimes, 0.0_rt);
+
+    // resize data array: min, avg and max of each time
+    m_data.resize(3*nTimes, 0.0_rt);
+
+    if (ParallelDescriptor::IOProcessor())
+    {
+        if ( m_IsNotRestart )
+        {
+            // open file
+            std::ofstream ofs{m_path + m_rd_name + "." + m_extension, std::ofstream::out};
+
+            // write header row
+            ofs << "#";
+            ofs << "[1]step()";
+            ofs << m_sep;
+            ofs << "[2]time(s)";
+            constexpr int shift = 3;
+            const Vector<std::string> stats = {"min", "avg", "max"};
+            for (int i = 0; i < nTimes; ++i)
+            {
+                for (int s = 0; s < 3; ++s)
+                {
+                    ofs << m_sep;
+                    ofs << "[" + std::to_string(shift+3*i+s) + "]";
+                    ofs << names[i] + "_" + stats[s] + "(s)";
+                }
+            }
+            ofs << std::endl;
+
+            // close file
+            ofs.close();
+        }
+    }
+}
+// end constructor
+
+// function that computes the time per step of each phase
+void Timing::ComputeDiags (int step)
+{
+    // Judge if the diags should be done
+    if (!m_intervals.contains(step+1)) { return; }
+
+    // time per step of each phase on this rank, since the last output
+    const Vector<Real> times = PhaseTimer::Times();
+    const int nTimes = times.size();
+    const int nSteps = PhaseTimer::NumSteps() - m_last_steps;
+    Vector<Real> tmin(nTimes), tsum(nTimes), tmax(nTimes);
+    for (int i = 0; i < nTimes; ++i)
+    {
+        const Real t = (nSteps > 0) ? (times[i] - m_last_times[i]) / nSteps : 0._rt;
+        tmin[i] = t;
+        tsum[i] = t;
+        tmax[i] = t;
+    }
+    m_last_times = times;
+    m_last_steps = PhaseTimer::NumSteps();
+
+    // reduce over the MPI ranks
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    ParallelDescriptor::ReduceRealMin(tmin.dataPtr(), nTimes, ioproc);
+    ParallelDescriptor::ReduceRealSum(tsum.dataPtr(), nTimes, ioproc);
+    ParallelDescriptor::ReduceRealMax(tmax.dataPtr(), nTimes, ioproc);
+
+    const Real nProcs = static_cast<Real>(ParallelDescriptor::NProcs());
+    for (int i = 0; i < nTimes; ++i)
+    {
+        m_data[3*i]   = tmin[i];
+        m_data[3*i+1] = tsum[i] / nProcs;
+        m_data[3*i+2] = tmax[i];
+    }
+
+    /* m_data now contains up-to-date values for:
+     *  [min, avg and max of the field push time,
+     *   min, avg and max of the LLG time,
+     *   ......,
+     *   min, avg and max of the step time] */
+}
+// end void Timing::ComputeDiags
@@ -0,0 +1,100 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "TimeAveragedDiagnostics.H"
+#include "WarpX.H"
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+
+using namespace amrex::literals;
+
+TimeAveragedDiagnostics::TimeAveragedDiagnostics (int i, std::string name)
+    : FullDiagnostics(i, name)
+{
+    // the fields are computed in m_mf_output at each step of the averaging windows
+    m_cold_output = false;
+    amrex::ParmParse pp_diag_name(m_diag_name);
+    pp_diag_name.get("average_period_steps", m_average_period_steps);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_average_period_steps > 0,
+        "<diag>.average_period_steps must be > 0");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_format != "checkpoint",
+        "<diag>.format cannot be checkpoint for TimeAveraged diagnostics");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+        !m_plot_raw_fields && !m_plot_raw_rho,
+        "<diag>.plot_raw_fields and <diag>.plot_raw_rho are not averaged, "
+        "and cannot be used with TimeAveraged diagnostics");
+}
+
+void
+TimeAveragedDiagnostics::InitializeFieldBufferData (int i_buffer, int lev)
+{
+    FullDiagnostics::InitializeFieldBufferData(i_buffer, lev);
+
+    m_mf_sum.resize( m_num_buffers );
+    m_mf_sum[i_buffer].resize( nmax_lev );
+    m_num_averaged_steps.resize( nmax_lev, 0 );
+    const amrex::MultiFab& mf = m_mf_output[i_buffer][lev];
+    m_mf_sum[i_buffer][lev] = amrex::MultiFab(mf.boxArray(), mf.DistributionMap(),
+                                              mf.nComp(), mf.nGrow());
+    // the level restarts its average on its new grids
+    m_num_averaged_steps[lev] = 0;
+}
+
+bool
+TimeAveragedDiagnostics::DoComputeAndPack (int step, bool force_flush)
+{
+    if (force_flush) return true;
+    // The output step ending the current window, if any
+    const int next_dump = m_intervals.nextContains(step);
+    return next_dump - (step+1) < m_average_period_steps;
+}
+
+void
+TimeAveragedDiagnostics::ComputeAndPack ()
+{
+    FullDiagnostics::ComputeAndPack();
+
+    // The forced flush at the end of the simulation computes the fields of the last
+    // step again
+    const int istep = WarpX::GetInstance().getistep(0);
+    if (istep == m_last_averaged_step) return;
+    m_last_averaged_step = istep;
+
+    for (int i_buffer = 0; i_buffer < m_num_buffers; ++i_buffer) {
+        for (int lev = 0; lev < nlev_output; ++lev) {
+            amrex::MultiFab& sum = m_mf_sum[i_buffer][lev];
+            const amrex::MultiFab& mf = m_mf_output[i_buffer][lev];
+            // The first step of the window overwrites the sum, so it is never reset
+            if (m_num_averaged_steps[lev] == 0) {
+                amrex::MultiFab::Copy(sum, mf, 0, 0, mf.nComp(), mf.nGrow());
+            } else {
+                amrex::MultiFab::Add(sum, mf, 0, 0, mf.nComp(), mf.nGrow());
+            }
+        }
+    }
+    for (int lev = 0; lev < nlev_output; ++lev) {
+        ++m_num_averaged_steps[lev];
+    }
+}
+
+void
+TimeAveragedDiagnostics::Flush (int i_buffer)
+{
+    for (int lev = 0; lev < nlev_output; ++lev) {
+        const int n = m_num_averaged_steps[lev];
+        if (n == 0) continue;
+        amrex::MultiFab& mf = m_mf_output[i_buffer][lev];
+        amrex::MultiFab::Copy(mf, m_mf_sum[i_buffer][lev], 0, 0, mf.nComp(), mf.nGrow());
+        mf.mult(1._rt/n, 0, mf.nComp(), mf.nGrow());
+    }
+
+    FullDiagnostics::Flush(i_buffer);
+
+    for (int lev = 0; lev < nlev_output; ++lev) {
+        m_num_averaged_steps[lev] = 0;
+    }
+}
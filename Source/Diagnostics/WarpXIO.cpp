@@ -24,13 +24,42 @@
 #   include <AMReX_AmrMeshInSituBridge.H>
 #endif
 
+#include <cmath>
 #include <memory>
+#include <set>
+#include <sstream>
+#include <string>
 
 using namespace amrex;
 
 namespace
 {
     const std::string level_prefix {"Level_"};
+
+#ifdef WARPX_MAG_LLG
+    /** Read the MultiFab name of level lev into mf. In an incremental
+     *  checkpoint chkfile (see FlushFormatCheckpoint), it is read from the
+     *  full checkpoint base, then updated with the boxes that changed since,
+     *  listed in deltas.
+     */
+    void ReadIncremental (MultiFab& mf, int lev, const std::string& chkfile,
+                          const std::string& base, const std::set<std::string>& deltas,
+                          const std::string& name)
+    {
+        VisMF::Read(mf, amrex::MultiFabFileFullPrefix(lev, base.empty() ? chkfile : base,
+                                                      level_prefix, name));
+        if (deltas.count(std::to_string(lev) + " " + name)) {
+            MultiFab delta;
+            VisMF::Read(delta, amrex::MultiFabFileFullPrefix(lev, chkfile, level_prefix,
+                                                             name + "_delta"));
+            // the guard cells outside of the domain come with the changed boxes,
+            // then their valid cells are copied over
+            const int ncomp = mf.nComp();
+            mf.ParallelCopy(delta, 0, 0, ncomp, delta.nGrowVect(), mf.nGrowVect());
+            mf.ParallelCopy(delta, 0, 0, ncomp, IntVect(0), mf.nGrowVect());
+        }
+    }
+#endif
 }
 
 void
@@ -40,6 +69,28 @@ WarpX::GotoNextLine (std::istream& is)
     is.ignore(bl_ignore_max, '\n');
 }
 
+Vector<Vector<Real> >
+WarpX::ReadCheckpointCosts (const std::string& chkfile)
+{
+    Vector<Vector<Real> > costs;
+
+    // The file is optional: it is only written when load balancing is on
+    Vector<char> fileCharPtr;
+    const bool bExitOnError = false;
+    ParallelDescriptor::ReadAndBcastFile(chkfile + "/WarpXCosts", fileCharPtr, bExitOnError);
+    if (fileCharPtr.empty()) return costs;
+
+    std::string fileCharPtrString(fileCharPtr.dataPtr());
+    std::istringstream is(fileCharPtrString, std::istringstream::in);
+    int nboxes;
+    while (is >> nboxes) {
+        Vector<Real> lev_costs(nboxes);
+        for (auto& c : lev_costs) is >> c;
+        costs.push_back(std::move(lev_costs));
+    }
+    return costs;
+}
+
 void
 WarpX::InitFromCheckpoint ()
 {
@@ -140,11 +191,29 @@ WarpX::InitFromCheckpoint ()
 
         ResetProbDomain(RealBox(prob_lo,prob_hi));
 
+        // Costs of the boxes saved with the checkpoint, if any
+        const Vector<Vector<Real> > saved_costs = ReadCheckpointCosts(restart_chkfile);
+
         for (int lev = 0; lev < nlevs; ++lev) {
             BoxArray ba;
             ba.readFrom(is);
             GotoNextLine(is);
-            DistributionMapping dm { ba, ParallelDescriptor::NProcs() };
+            // The boxes are distributed over the MPI ranks of this run, whose
+            // number may differ from the run that wrote the checkpoint. With
+            // the saved costs, the distribution is balanced from the start.
+            DistributionMapping dm;
+            if (lev < static_cast<int>(saved_costs.size()) &&
+                saved_costs[lev].size() == static_cast<std::size_t>(ba.size()))
+            {
+                const amrex::Real nboxes = ba.size();
+                const amrex::Real nprocs = ParallelDescriptor::NProcs();
+                const int nmax = static_cast<int>(std::ceil(nboxes/nprocs*load_balance_knapsack_factor));
+                dm = (load_balance_with_sfc)
+                    ? DistributionMapping::makeSFC(saved_costs[lev], ba)
+                    : DistributionMapping::makeKnapSack(saved_costs[lev], nmax);
+            } else {
+                dm = DistributionMapping{ ba, ParallelDescriptor::NProcs() };
+            }
             SetBoxArray(lev, ba);
             SetDistributionMap(lev, dm);
             AllocLevelData(lev, ba, dm);
@@ -157,6 +226,29 @@ WarpX::InitFromCheckpoint ()
 
     const int nlevs = finestLevel()+1;
 
+#ifdef WARPX_MAG_LLG
+    // In an incremental checkpoint, M is read from the last full checkpoint
+    // and updated with the boxes that changed since
+    std::string base_chkfile;
+    std::set<std::string> M_deltas;
+    {
+        Vector<char> fileCharPtr;
+        const bool bExitOnError = false;
+        ParallelDescriptor::ReadAndBcastFile(restart_chkfile + "/WarpXIncremental",
+                                             fileCharPtr, bExitOnError);
+        if (!fileCharPtr.empty()) {
+            std::string fileCharPtrString(fileCharPtr.dataPtr());
+            std::istringstream is(fileCharPtrString, std::istringstream::in);
+            std::getline(is, base_chkfile);
+            std::string line;
+            while (std::getline(is, line)) {
+                if (!line.empty()) M_deltas.insert(line);
+            }
+            amrex::Print() << "  Incremental checkpoint, based on " << base_chkfile << "\n";
+        }
+    }
+#endif
+
     // Initialize the field data
     for (int lev = 0; lev < nlevs; ++lev)
     {
@@ -200,12 +292,19 @@ WarpX::InitFromCheckpoint ()
                     amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bz_fp"));
 
 #ifdef WARPX_MAG_LLG
-        VisMF::Read(*Mfield_fp[lev][0],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mx_fp"));
-        VisMF::Read(*Mfield_fp[lev][1],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "My_fp"));
-        VisMF::Read(*Mfield_fp[lev][2],
-                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mz_fp"));
+        ReadIncremental(*Mfield_fp[lev][0], lev, restart_chkfile, base_chkfile, M_deltas, "Mx_fp");
+        ReadIncremental(*Mfield_fp[lev][1], lev, restart_chkfile, base_chkfile, M_deltas, "My_fp");
+        ReadIncremental(*Mfield_fp[lev][2], lev, restart_chkfile, base_chkfile, M_deltas, "Mz_fp");
+
+        VisMF::Read(*Hfield_fp[lev][0],
+                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hx_fp"));
+        VisMF::Read(*Hfield_fp[lev][1],
+                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hy_fp"));
+        VisMF::Read(*Hfield_fp[lev][2],
+                    amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hz_fp"));
+
+        // H_bias is static and is not stored in the checkpoints
+        InitHBiasField(lev);
 #endif
 
         if (is_synchronized) {
@@ -234,12 +333,16 @@ WarpX::InitFromCheckpoint ()
                         amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Bz_cp"));
 
 #ifdef WARPX_MAG_LLG
-            VisMF::Read(*Mfield_cp[lev][0],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mx_cp"));
-            VisMF::Read(*Mfield_cp[lev][1],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "My_cp"));
-            VisMF::Read(*Mfield_cp[lev][2],
-                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Mz_cp"));
+            ReadIncremental(*Mfield_cp[lev][0], lev, restart_chkfile, base_chkfile, M_deltas, "Mx_cp");
+            ReadIncremental(*Mfield_cp[lev][1], lev, restart_chkfile, base_chkfile, M_deltas, "My_cp");
+            ReadIncremental(*Mfield_cp[lev][2], lev, restart_chkfile, base_chkfile, M_deltas, "Mz_cp");
+
+            VisMF::Read(*Hfield_cp[lev][0],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hx_cp"));
+            VisMF::Read(*Hfield_cp[lev][1],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hy_cp"));
+            VisMF::Read(*Hfield_cp[lev][2],
+                        amrex::MultiFabFileFullPrefix(lev, restart_chkfile, level_prefix, "Hz_cp"));
 #endif
 
             if (is_synchronized) {
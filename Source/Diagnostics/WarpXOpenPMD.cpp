@@ -12,15 +12,19 @@
 #include "Utils/WarpXUtil.H"
 
 #include <AMReX_AmrParticles.H>
+#include <AMReX_GpuContainers.H>
 #include <AMReX_ParallelDescriptor.H>
 
 #include <algorithm>
 #include <cstdint>
 #include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
 #include <iostream>
 #include <fstream>
 
@@ -28,6 +32,126 @@
 namespace detail
 {
 #ifdef WARPX_USE_OPENPMD
+    /** JSON object of string values, one key value pair per line
+     *
+     * @param parameters key value pairs
+     * @param indent indentation of the lines
+     * @return JSON string, without the enclosing braces
+     */
+    inline std::string
+    getJSONParameters ( std::map< std::string, std::string > const& parameters,
+                        std::string const& indent )
+    {
+        std::string json;
+        for (auto const& kv : parameters) {
+            if (!json.empty()) json += ",\n";
+            json += indent + "\"" + kv.first + "\": \"" + kv.second + "\"";
+        }
+        return json;
+    }
+
+    /** JSON options of the openPMD::Series, that select the ADIOS2 engine and
+     *  enable an ADIOS2 compression operator
+     *
+     * @param operator_type ADIOS2 operator, e.g. "blosc", "zfp" or "sz" (empty: no compression)
+     * @param operator_parameters parameters of the operator, passed as strings to ADIOS2
+     * @param engine_type ADIOS2 engine, e.g. "sst" or "ssc" (empty: the default file engine)
+     * @param engine_parameters parameters of the engine, passed as strings to ADIOS2
+     * @return JSON string for the openPMD::Series constructor
+     */
+    inline std::string
+    getSeriesOptions ( std::string const& operator_type,
+                       std::map< std::string, std::string > const& operator_parameters,
+                       std::string const& engine_type,
+                       std::map< std::string, std::string > const& engine_parameters )
+    {
+        if (operator_type.empty() && engine_type.empty()) return "{}";
+
+        std::string adios2;
+        if (!engine_type.empty()) {
+            adios2 += R"END(
+    "engine": {
+      "type": ")END" + engine_type + R"END(",
+      "parameters": {
+)END" + getJSONParameters(engine_parameters, "        ") + R"END(
+      }
+    })END";
+        }
+        if (!operator_type.empty()) {
+            if (!adios2.empty()) adios2 += ",";
+            adios2 += R"END(
+    "dataset": {
+      "operators": [
+        {
+          "type": ")END" + operator_type + R"END(",
+          "parameters": {
+)END" + getJSONParameters(operator_parameters, "            ") + R"END(
+          }
+        }
+      ]
+    })END";
+        }
+        return R"END(
+{
+  "adios2": {)END" + adios2 + R"END(
+  }
+}
+)END";
+    }
+
+    /** Allocate a host buffer for one chunk of n entries
+     *
+     * @param n number of entries
+     * @return buffer owned by a shared_ptr, as expected by storeChunk
+     */
+    template< typename T >
+    inline std::shared_ptr< T >
+    allocateChunk ( long const n )
+    {
+        return std::shared_ptr< T >(
+            new T[n],
+            [](T const *p){ delete[] p; }
+        );
+    }
+
+    /** Datatype of the reals written to file
+     *
+     * @param single whether the reals are written in single precision
+     * @return datatype of float if single is true, of T otherwise
+     */
+    template< typename T >
+    inline openPMD::Datatype
+    getRealDatatype ( bool const single )
+    {
+        return single ? openPMD::Datatype::FLOAT : openPMD::determineDatatype< T >();
+    }
+
+    /** Store a chunk of reals from the host, converted to float in single precision
+     *
+     * @param rc record component to which the chunk belongs
+     * @param data contiguous data of the chunk
+     * @param offset offset of the chunk in the record component
+     * @param extent extent of the chunk
+     * @param single whether the reals are written in single precision
+     */
+    template< typename T >
+    inline void
+    storeRealChunk ( openPMD::RecordComponent rc, std::shared_ptr< T > const& data,
+                     openPMD::Offset const& offset, openPMD::Extent const& extent,
+                     bool const single )
+    {
+        if (!single || std::is_same< typename std::remove_const< T >::type, float >::value) {
+            rc.storeChunk(data, offset, extent);
+            return;
+        }
+        std::size_t n = 1;
+        for (auto const e : extent) n *= e;
+        auto data_single = allocateChunk< float >(n);
+        std::transform(data.get(), data.get() + n, data_single.get(),
+                       [](T const x) { return static_cast< float >(x); });
+        rc.storeChunk(data_single, offset, extent);
+    }
+
     /** Unclutter a real_names to openPMD record
      *
      * @param fullName name as in real_names variable
@@ -196,10 +320,19 @@ namespace detail
 
 #ifdef WARPX_USE_OPENPMD
 WarpXOpenPMDPlot::WarpXOpenPMDPlot(bool oneFilePerTS,
-    std::string openPMDFileType, std::vector<bool> fieldPMLdirections)
+    std::string openPMDFileType,
+    std::string operator_type,
+    std::map< std::string, std::string > operator_parameters,
+    std::map< std::string, std::string > engine_parameters,
+    bool singlePrecision,
+    std::vector<bool> fieldPMLdirections)
   :m_Series(nullptr),
    m_OneFilePerTS(oneFilePerTS),
    m_OpenPMDFileType(std::move(openPMDFileType)),
+   m_OperatorType(std::move(operator_type)),
+   m_OperatorParameters(std::move(operator_parameters)),
+   m_EngineParameters(std::move(engine_parameters)),
+   m_SinglePrecision(singlePrecision),
    m_fieldPMLdirections(std::move(fieldPMLdirections))
 {
   // pick first available backend if default is chosen
@@ -213,6 +346,35 @@ WarpXOpenPMDPlot::WarpXOpenPMDPlot(bool oneFilePerTS,
 #else
     m_OpenPMDFileType = "json";
 #endif
+
+  // the streaming engines of ADIOS2 send all the steps through one open series
+  if( m_OpenPMDFileType == "sst" || m_OpenPMDFileType == "ssc" ) {
+#ifndef WARPX_OPENPMD_STREAMING
+    amrex::Abort("openPMD: openpmd_backend = " + m_OpenPMDFileType +
+                 " requires openPMD-api 0.13.0 or newer with ADIOS2 support");
+#endif
+    m_EngineType = m_OpenPMDFileType;
+    m_OpenPMDFileType = "bp";
+    m_OneFilePerTS = false;
+    // By default, the writer never blocks: it does not wait for a reader to connect,
+    // and discards the steps that a slow reader has not taken from the queue
+    if( m_EngineType == "sst" ) {
+      m_EngineParameters.insert({"RendezvousReaderCount", "0"});
+      m_EngineParameters.insert({"QueueLimit", "2"});
+      m_EngineParameters.insert({"QueueFullPolicy", "Discard"});
+    }
+  }
+
+  // compression operators and engine parameters are only passed to the ADIOS2 backend
+#if openPMD_HAVE_ADIOS2==1
+  bool const has_adios2 = m_OpenPMDFileType == "bp";
+#else
+  bool const has_adios2 = false;
+#endif
+  AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_OperatorType.empty() || has_adios2,
+      "openPMD: adios2_operator requires the ADIOS2 backend (openpmd_backend = bp)");
+  AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_EngineParameters.empty() || !m_EngineType.empty(),
+      "openPMD: adios2_engine.parameters requires openpmd_backend = sst or ssc");
 }
 
 WarpXOpenPMDPlot::~WarpXOpenPMDPlot()
@@ -254,7 +416,12 @@ void WarpXOpenPMDPlot::SetStep (int ts, const std::string& filePrefix,
             amrex::Warning(warnMsg);
         }
     }
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!isBTD || m_EngineType.empty(),
+        "openPMD: the back-transformed diagnostics cannot be streamed");
     m_CurrentStep = ts;
+    m_StoredBytes = 0;
+    // a stream stays open, and each step is sent as a new iteration
+    if( !m_EngineType.empty() && m_Series != nullptr ) return;
     Init(openPMD::Access::CREATE, filePrefix, isBTD);
 }
 
@@ -266,10 +433,21 @@ void WarpXOpenPMDPlot::CloseStep (bool isBTD, bool isLastBTDFlush)
     if (isBTD and !isLastBTDFlush) callClose = false;
     if (callClose) {
         if (m_Series)
-            m_Series->iterations[m_CurrentStep].close();
+            GetIteration(m_CurrentStep).close();
     }
 }
 
+openPMD::Iteration
+WarpXOpenPMDPlot::GetIteration (int const iteration) const
+{
+#ifdef WARPX_OPENPMD_STREAMING
+    // the streaming engines require the steps to be written in order, and closed
+    if( !m_EngineType.empty() )
+        return m_Series->writeIterations()[iteration];
+#endif
+    return m_Series->iterations[iteration];
+}
+
 void
 WarpXOpenPMDPlot::Init (openPMD::Access access, const std::string& filePrefix, bool isBTD)
 {
@@ -285,11 +463,15 @@ WarpXOpenPMDPlot::Init (openPMD::Access access, const std::string& filePrefix, b
     // see ADIOS1 limitation: https://github.com/openPMD/openPMD-api/pull/686
     m_Series = nullptr;
 
+    std::string const options = detail::getSeriesOptions(
+        m_OperatorType, m_OperatorParameters, m_EngineType, m_EngineParameters);
+
     if (amrex::ParallelDescriptor::NProcs() > 1) {
 #if defined(AMREX_USE_MPI)
         m_Series = std::make_unique<openPMD::Series>(
                 filepath, access,
-                amrex::ParallelDescriptor::Communicator()
+                amrex::ParallelDescriptor::Communicator(),
+                options
         );
         m_MPISize = amrex::ParallelDescriptor::NProcs();
         m_MPIRank = amrex::ParallelDescriptor::MyProc();
@@ -297,13 +479,13 @@ WarpXOpenPMDPlot::Init (openPMD::Access access, const std::string& filePrefix, b
         amrex::Abort("openPMD-api not built with MPI support!");
 #endif
     } else {
-        m_Series = std::make_unique<openPMD::Series>(filepath, access);
+        m_Series = std::make_unique<openPMD::Series>(filepath, access, options);
         m_MPISize = 1;
         m_MPIRank = 1;
     }
 
     // create a little helper file for ParaView 5.9+
-    if (amrex::ParallelDescriptor::IOProcessor())
+    if (amrex::ParallelDescriptor::IOProcessor() && m_EngineType.empty())
     {
         std::ofstream pv_helper_file(filePrefix + "/paraview.pmd");
         pv_helper_file << filename << std::endl;
@@ -368,27 +550,8 @@ WarpXOpenPMDPlot::WriteOpenPMDParticles (const amrex::Vector<ParticleDiag>& part
         }
 #endif
 
-      pc->ConvertUnits(ConvertDirection::WarpX_to_SI);
-
-      RandomFilter const random_filter(particle_diags[i].m_do_random_filter,
-                                       particle_diags[i].m_random_fraction);
-      UniformFilter const uniform_filter(particle_diags[i].m_do_uniform_filter,
-                                         particle_diags[i].m_uniform_stride);
-      ParserFilter parser_filter(particle_diags[i].m_do_parser_filter,
-                                 getParser(particle_diags[i].m_particle_filter_parser),
-                                 pc->getMass());
-      parser_filter.m_units = InputUnits::SI;
-      GeometryFilter const geometry_filter(particle_diags[i].m_do_geom_filter,
-                                           particle_diags[i].m_diag_domain);
-
-      using SrcData = WarpXParticleContainer::ParticleTileType::ConstParticleTileDataType;
-      tmp.copyParticles(*pc,
-                        [=] AMREX_GPU_HOST_DEVICE (const SrcData& src, int ip, const amrex::RandomEngine& engine)
-      {
-          const SuperParticleType& p = src.getSuperParticle(ip);
-          return random_filter(p, engine) * uniform_filter(p, engine)
-                 * parser_filter(p, engine) * geometry_filter(p, engine);
-      }, true);
+      // Select, pack and convert to SI units the particles to write
+      particle_diags[i].FilterAndPack(tmp);
 
     // real_names contains a list of all real particle attributes.
     // particle_diags[i].plot_flags is 1 or 0, whether quantity is dumped or not.
@@ -403,9 +566,6 @@ WarpXOpenPMDPlot::WriteOpenPMDParticles (const amrex::Vector<ParticleDiag>& part
          pc->getCharge(), pc->getMass()
       );
     }
-
-    // Convert momentum back to WarpX units
-    pc->ConvertUnits(ConvertDirection::SI_to_WarpX);
   }
 }
 
@@ -424,7 +584,7 @@ WarpXOpenPMDPlot::DumpToFile (ParticleContainer* pc,
 
   WarpXParticleCounter counter(pc);
 
-  openPMD::Iteration currIteration = m_Series->iterations[iteration];
+  openPMD::Iteration currIteration = GetIteration(iteration);
   openPMD::ParticleSpecies currSpecies = currIteration.particles[name];
   // meta data for ED-PIC extension
   currSpecies.setAttribute( "particleShape", double( WarpX::noz ) );
@@ -471,90 +631,83 @@ WarpXOpenPMDPlot::DumpToFile (ParticleContainer* pc,
   // open files from all processors, in case some will not contribute below
   m_Series->flush();
 
+  // Each rank gathers its tiles into one contiguous buffer per attribute
+  // and stores a single chunk per attribute and level, instead of one tiny
+  // chunk per tile.
   for (auto currentLevel = 0; currentLevel <= pc->finestLevel(); currentLevel++)
     {
-      uint64_t offset = static_cast<uint64_t>( counter.m_ParticleOffsetAtRank[currentLevel] );
+      uint64_t const offset = static_cast<uint64_t>( counter.m_ParticleOffsetAtRank[currentLevel] );
+      auto const numParticleOnRank = counter.m_ParticleSizeAtRank[currentLevel];
+      if (numParticleOnRank == 0) continue;
+      uint64_t const numParticleOnRank64 = static_cast<uint64_t>( numParticleOnRank );
 
+      // get position and particle ID from aos
+#if defined(WARPX_DIM_RZ)
+      //   reconstruct x and y from polar coordinates r, theta
+      auto x = detail::allocateChunk< amrex::ParticleReal >(numParticleOnRank);
+      auto y = detail::allocateChunk< amrex::ParticleReal >(numParticleOnRank);
+      auto z = detail::allocateChunk< amrex::ParticleReal >(numParticleOnRank);
+#else
+      std::vector< std::shared_ptr< amrex::ParticleReal > > pos(AMREX_SPACEDIM);
+      for (auto currDim = 0; currDim < AMREX_SPACEDIM; currDim++)
+          pos[currDim] = detail::allocateChunk< amrex::ParticleReal >(numParticleOnRank);
+#endif
+      auto ids = detail::allocateChunk< uint64_t >(numParticleOnRank);
+
+      long tileOffset = 0; // offset of the current tile in the buffers of this rank
       for (ParticleIter pti(*pc, currentLevel); pti.isValid(); ++pti) {
          auto const numParticleOnTile = pti.numParticles();
-         uint64_t const numParticleOnTile64 = static_cast<uint64_t>( numParticleOnTile );
-
-         // get position and particle ID from aos
-         // note: this implementation iterates the AoS 4x...
-         // if we flush late as we do now, we can also copy out the data in one go
          const auto& aos = pti.GetArrayOfStructs();  // size =  numParticlesOnTile
-         {
-           // Save positions
-           auto const positionComponents = detail::getParticlePositionComponentLabels();
 #if defined(WARPX_DIM_RZ)
-           {
-              std::shared_ptr<amrex::ParticleReal> z(
-                      new amrex::ParticleReal[numParticleOnTile],
-                      [](amrex::ParticleReal const *p) { delete[] p; }
-              );
-              for (auto i = 0; i < numParticleOnTile; i++)
-                  z.get()[i] = aos[i].pos(1);  // {0: "r", 1: "z"}
-              std::string const positionComponent = "z";
-              currSpecies["position"]["z"].storeChunk(z, {offset}, {numParticleOnTile64});
-           }
-
-           //   reconstruct x and y from polar coordinates r, theta
-           auto const& soa = pti.GetStructOfArrays();
-           amrex::ParticleReal const* theta = soa.GetRealData(PIdx::theta).dataPtr();
-           AMREX_ALWAYS_ASSERT_WITH_MESSAGE(theta != nullptr, "openPMD: invalid theta pointer.");
-           AMREX_ALWAYS_ASSERT_WITH_MESSAGE(int(soa.GetRealData(PIdx::theta).size()) == numParticleOnTile,
-                                            "openPMD: theta and tile size do not match");
-           {
-               std::shared_ptr< amrex::ParticleReal > x(
-                       new amrex::ParticleReal[numParticleOnTile],
-                       [](amrex::ParticleReal const *p){ delete[] p; }
-               );
-               std::shared_ptr< amrex::ParticleReal > y(
-                       new amrex::ParticleReal[numParticleOnTile],
-                       [](amrex::ParticleReal const *p){ delete[] p; }
-               );
-               for (auto i=0; i<numParticleOnTile; i++) {
-                   auto const r = aos[i].pos(0);  // {0: "r", 1: "z"}
-                   x.get()[i] = r * std::cos(theta[i]);
-                   y.get()[i] = r * std::sin(theta[i]);
-               }
-               currSpecies["position"]["x"].storeChunk(x, {offset}, {numParticleOnTile64});
-               currSpecies["position"]["y"].storeChunk(y, {offset}, {numParticleOnTile64});
-           }
+         auto const& soa = pti.GetStructOfArrays();
+         amrex::ParticleReal const* theta = soa.GetRealData(PIdx::theta).dataPtr();
+         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(theta != nullptr, "openPMD: invalid theta pointer.");
+         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(int(soa.GetRealData(PIdx::theta).size()) == numParticleOnTile,
+                                          "openPMD: theta and tile size do not match");
+         for (auto i = 0; i < numParticleOnTile; i++) {
+             auto const r = aos[i].pos(0);  // {0: "r", 1: "z"}
+             x.get()[tileOffset + i] = r * std::cos(theta[i]);
+             y.get()[tileOffset + i] = r * std::sin(theta[i]);
+             z.get()[tileOffset + i] = aos[i].pos(1);
+         }
 #else
-           for (auto currDim = 0; currDim < AMREX_SPACEDIM; currDim++) {
-                std::shared_ptr< amrex::ParticleReal > curr(
-                    new amrex::ParticleReal[numParticleOnTile],
-                    [](amrex::ParticleReal const *p){ delete[] p; }
-                );
-                for (auto i=0; i<numParticleOnTile; i++) {
-                     curr.get()[i] = aos[i].pos(currDim);
-                }
-                std::string const positionComponent = positionComponents[currDim];
-                currSpecies["position"][positionComponent].storeChunk(curr, {offset}, {numParticleOnTile64});
-           }
+         for (auto currDim = 0; currDim < AMREX_SPACEDIM; currDim++) {
+             amrex::ParticleReal* const curr = pos[currDim].get() + tileOffset;
+             for (auto i=0; i<numParticleOnTile; i++) {
+                 curr[i] = aos[i].pos(currDim);
+             }
+         }
 #endif
-
-           // save particle ID after converting it to a globally unique ID
-           std::shared_ptr< uint64_t > ids(
-               new uint64_t[numParticleOnTile],
-               [](uint64_t const *p){ delete[] p; }
-           );
-           for (auto i=0; i<numParticleOnTile; i++) {
-               ids.get()[i] = WarpXUtilIO::localIDtoGlobal( aos[i].id(), aos[i].cpu() );
-           }
-           auto const scalar = openPMD::RecordComponent::SCALAR;
-           currSpecies["id"][scalar].storeChunk(ids, {offset}, {numParticleOnTile64});
+         // particle ID after converting it to a globally unique ID
+         for (auto i=0; i<numParticleOnTile; i++) {
+             ids.get()[tileOffset + i] = WarpXUtilIO::localIDtoGlobal( aos[i].id(), aos[i].cpu() );
          }
-         //  save "extra" particle properties in AoS and SoA
-         SaveRealProperty(pti,
-             currSpecies,
-             offset,
-             write_real_comp, real_comp_names,
-             write_int_comp, int_comp_names);
-
-         offset += numParticleOnTile64;
+         tileOffset += numParticleOnTile;
       }
+
+#if defined(WARPX_DIM_RZ)
+      detail::storeRealChunk(currSpecies["position"]["x"], x, {offset}, {numParticleOnRank64}, m_SinglePrecision);
+      detail::storeRealChunk(currSpecies["position"]["y"], y, {offset}, {numParticleOnRank64}, m_SinglePrecision);
+      detail::storeRealChunk(currSpecies["position"]["z"], z, {offset}, {numParticleOnRank64}, m_SinglePrecision);
+#else
+      auto const positionComponents = detail::getParticlePositionComponentLabels();
+      for (auto currDim = 0; currDim < AMREX_SPACEDIM; currDim++) {
+          std::string const positionComponent = positionComponents[currDim];
+          detail::storeRealChunk(currSpecies["position"][positionComponent], pos[currDim],
+                                 {offset}, {numParticleOnRank64}, m_SinglePrecision);
+      }
+#endif
+      auto const scalar = openPMD::RecordComponent::SCALAR;
+      currSpecies["id"][scalar].storeChunk(ids, {offset}, {numParticleOnRank64});
+      m_StoredBytes += numParticleOnRank64 *
+          (detail::getParticlePositionComponentLabels().size() * GetParticleRealBytes() + sizeof(uint64_t));
+
+      //  save "extra" particle properties in AoS and SoA
+      SaveRealProperty(pc, currentLevel,
+          currSpecies,
+          offset, numParticleOnRank,
+          write_real_comp, real_comp_names,
+          write_int_comp, int_comp_names);
     }
     m_Series->flush();
 }
@@ -567,7 +720,7 @@ WarpXOpenPMDPlot::SetupRealProperties (openPMD::ParticleSpecies& currSpecies,
                       const amrex::Vector<std::string>& int_comp_names,
                       unsigned long long np) const
 {
-    auto dtype_real = openPMD::Dataset(openPMD::determineDatatype<amrex::ParticleReal>(), {np});
+    auto dtype_real = openPMD::Dataset(detail::getRealDatatype<amrex::ParticleReal>(m_SinglePrecision), {np});
     auto dtype_int  = openPMD::Dataset(openPMD::determineDatatype<int>(), {np});
 
     //
@@ -639,50 +792,24 @@ WarpXOpenPMDPlot::SetupRealProperties (openPMD::ParticleSpecies& currSpecies,
 }
 
 void
-WarpXOpenPMDPlot::SaveRealProperty (ParticleIter& pti,
+WarpXOpenPMDPlot::SaveRealProperty (ParticleContainer* pc, int const lev,
                        openPMD::ParticleSpecies& currSpecies,
                        unsigned long long const offset,
+                       long const np_on_rank,
                        amrex::Vector<int> const& write_real_comp,
                        amrex::Vector<std::string> const& real_comp_names,
                        amrex::Vector<int> const& write_int_comp,
                        amrex::Vector<std::string> const& int_comp_names) const
 
 {
-  int numOutputReal = 0;
+  uint64_t const numParticleOnRank64 = static_cast<uint64_t>( np_on_rank );
   int const totalRealAttrs = m_NumAoSRealAttributes + m_NumSoARealAttributes;
+  auto const int_counter = std::min(write_int_comp.size(), int_comp_names.size());
 
-  for( int i = 0; i < totalRealAttrs; ++i )
-    if( write_real_comp[i] )
-      ++numOutputReal;
-
-  auto const numParticleOnTile = pti.numParticles();
-  uint64_t const numParticleOnTile64 = static_cast<uint64_t>( numParticleOnTile );
-  auto const& aos = pti.GetArrayOfStructs();  // size =  numParticlesOnTile
-  auto const& soa = pti.GetStructOfArrays();
-
-  // first we concatinate the AoS into contiguous arrays
-  {
-    for( auto idx=0; idx<m_NumAoSRealAttributes; idx++ ) {
-      if( write_real_comp[idx] ) {
-          // handle scalar and non-scalar records by name
-          std::string record_name, component_name;
-          std::tie(record_name, component_name) = detail::name2openPMD(real_comp_names[idx]);
-          auto currRecord = currSpecies[record_name];
-          auto currRecordComp = currRecord[component_name];
-
-          std::shared_ptr< amrex::ParticleReal > d(
-              new amrex::ParticleReal[numParticleOnTile],
-              [](amrex::ParticleReal const *p){ delete[] p; }
-          );
-
-          for( auto kk=0; kk<numParticleOnTile; kk++ )
-               d.get()[kk] = aos[kk].rdata(idx);
-
-          currRecordComp.storeChunk(d,
-               {offset}, {numParticleOnTile64});
-      }
-    }
-  }
+  for( auto ii=0; ii<totalRealAttrs; ii++ )
+    if( write_real_comp[ii] ) m_StoredBytes += numParticleOnRank64 * GetParticleRealBytes();
+  for( auto idx=0; idx<int_counter; idx++ )
+    if( write_int_comp[m_NumAoSIntAttributes + idx] ) m_StoredBytes += numParticleOnRank64 * sizeof(int);
 
   auto const getComponentRecord = [&currSpecies](std::string const comp_name) {
     // handle scalar and non-scalar records by name
@@ -691,26 +818,86 @@ WarpXOpenPMDPlot::SaveRealProperty (ParticleIter& pti,
     return currSpecies[record_name][component_name];
   };
 
-  // here we the save the SoA properties (real)
-  {
+  // all particles of this rank in a single tile: the SoA data are written
+  // directly from the (pinned) tile, without copy
+  int numTilesWithParticles = 0;
+  for (ParticleIter pti(*pc, lev); pti.isValid(); ++pti) {
+    if (pti.numParticles() > 0) ++numTilesWithParticles;
+  }
+  if (numTilesWithParticles == 1) {
+    for (ParticleIter pti(*pc, lev); pti.isValid(); ++pti) {
+      if (pti.numParticles() == 0) continue;
+      auto const& soa = pti.GetStructOfArrays();
+      for (auto idx=0; idx<m_NumSoARealAttributes; idx++) {
+        auto ii = m_NumAoSRealAttributes + idx;
+        if (write_real_comp[ii]) {
+          detail::storeRealChunk(getComponentRecord(real_comp_names[ii]),
+            openPMD::shareRaw(soa.GetRealData(idx)), {offset}, {numParticleOnRank64},
+            m_SinglePrecision);
+        }
+      }
+      for (auto idx=0; idx<int_counter; idx++) {
+        auto ii = m_NumAoSIntAttributes + idx; // jump over AoS names
+        if (write_int_comp[ii]) {
+          getComponentRecord(int_comp_names[ii]).storeChunk(openPMD::shareRaw(soa.GetIntData(idx)),
+            {offset}, {numParticleOnRank64});
+        }
+      }
+    }
+  }
+
+  // otherwise, concatenate the tiles into one buffer per attribute
+  bool const copySoA = numTilesWithParticles > 1;
+  std::vector< std::shared_ptr< amrex::ParticleReal > > real_data(totalRealAttrs);
+  for( auto ii=0; ii<totalRealAttrs; ii++ ) {
+    bool const isAoS = ii < m_NumAoSRealAttributes;
+    if( write_real_comp[ii] && (isAoS || copySoA) )
+      real_data[ii] = detail::allocateChunk< amrex::ParticleReal >(np_on_rank);
+  }
+  std::vector< std::shared_ptr< int > > int_data(int_counter);
+  for( auto idx=0; idx<int_counter; idx++ ) {
+    if( write_int_comp[m_NumAoSIntAttributes + idx] && copySoA )
+      int_data[idx] = detail::allocateChunk< int >(np_on_rank);
+  }
+
+  long tileOffset = 0; // offset of the current tile in the buffers of this rank
+  for (ParticleIter pti(*pc, lev); pti.isValid(); ++pti) {
+    auto const numParticleOnTile = pti.numParticles();
+    auto const& aos = pti.GetArrayOfStructs();  // size =  numParticlesOnTile
+    auto const& soa = pti.GetStructOfArrays();
+
+    for( auto idx=0; idx<m_NumAoSRealAttributes; idx++ ) {
+      if( real_data[idx] ) {
+        amrex::ParticleReal* const d = real_data[idx].get() + tileOffset;
+        for( auto kk=0; kk<numParticleOnTile; kk++ )
+          d[kk] = aos[kk].rdata(idx);
+      }
+    }
     for (auto idx=0; idx<m_NumSoARealAttributes; idx++) {
       auto ii = m_NumAoSRealAttributes + idx;
-      if (write_real_comp[ii]) {
-        getComponentRecord(real_comp_names[ii]).storeChunk(openPMD::shareRaw(soa.GetRealData(idx)),
-          {offset}, {numParticleOnTile64});
+      if (real_data[ii]) {
+        std::copy_n(soa.GetRealData(idx).dataPtr(), numParticleOnTile,
+                    real_data[ii].get() + tileOffset);
       }
     }
-  }
-  // and now SoA int properties
-  {
-    auto const int_counter = std::min(write_int_comp.size(), int_comp_names.size());
     for (auto idx=0; idx<int_counter; idx++) {
-      auto ii = m_NumAoSIntAttributes + idx; // jump over AoS names
-      if (write_int_comp[ii]) {
-        getComponentRecord(int_comp_names[ii]).storeChunk(openPMD::shareRaw(soa.GetIntData(idx)),
-          {offset}, {numParticleOnTile64});
+      if (int_data[idx]) {
+        std::copy_n(soa.GetIntData(idx).dataPtr(), numParticleOnTile,
+                    int_data[idx].get() + tileOffset);
       }
     }
+    tileOffset += numParticleOnTile;
+  }
+
+  for( auto ii=0; ii<totalRealAttrs; ii++ ) {
+    if( real_data[ii] )
+      detail::storeRealChunk(getComponentRecord(real_comp_names[ii]), real_data[ii],
+        {offset}, {numParticleOnRank64}, m_SinglePrecision);
+  }
+  for( auto idx=0; idx<int_counter; idx++ ) {
+    if( int_data[idx] )
+      getComponentRecord(int_comp_names[m_NumAoSIntAttributes + idx]).storeChunk(int_data[idx],
+        {offset}, {numParticleOnRank64});
   }
 }
 
@@ -723,13 +910,15 @@ WarpXOpenPMDPlot::SetupPos(
     amrex::ParticleReal const mass) const
 {
   auto const realType = openPMD::Dataset(openPMD::determineDatatype<amrex::ParticleReal>(), {np});
+  auto const positionType = openPMD::Dataset(
+      detail::getRealDatatype<amrex::ParticleReal>(m_SinglePrecision), {np});
   auto const idType = openPMD::Dataset(openPMD::determineDatatype< uint64_t >(), {np});
 
   auto const positionComponents = detail::getParticlePositionComponentLabels();
   for( auto const& comp : positionComponents ) {
       currSpecies["positionOffset"][comp].resetDataset( realType );
       currSpecies["positionOffset"][comp].makeConstant( 0. );
-      currSpecies["position"][comp].resetDataset( realType );
+      currSpecies["position"][comp].resetDataset( positionType );
   }
 
   auto const scalar = openPMD::RecordComponent::SCALAR;
@@ -800,11 +989,11 @@ WarpXOpenPMDPlot::WriteOpenPMDFields ( //const std::string& filename,
   std::vector<std::string> axis_labels = detail::getFieldAxisLabels();
 
   // Prepare the type of dataset that will be written
-  openPMD::Datatype const datatype = openPMD::determineDatatype<amrex::Real>();
+  openPMD::Datatype const datatype = detail::getRealDatatype<amrex::Real>(m_SinglePrecision);
   auto const dataset = openPMD::Dataset(datatype, global_size);
 
   // meta data
-  auto series_iteration = m_Series->iterations[iteration];
+  auto series_iteration = GetIteration(iteration);
   auto meshes = series_iteration.meshes;
   if( first_write_to_iteration ) {
       series_iteration.setTime( time );
@@ -845,10 +1034,10 @@ WarpXOpenPMDPlot::WriteOpenPMDFields ( //const std::string& filename,
       meshes.setAttribute("fieldBoundary", fieldBoundary);
       meshes.setAttribute("particleBoundary", particleBoundary);
       meshes.setAttribute("currentSmoothing", []() {
-          if (WarpX::use_filter) return "Binomial";
+          if (WarpX::use_filter || WarpX::use_kspace_filter) return "Binomial";
           else return "none";
       }());
-      if (WarpX::use_filter)
+      if (WarpX::use_filter || WarpX::use_kspace_filter)
           meshes.setAttribute("currentSmoothingParameters", []() {
               std::stringstream ss;
               ss << "period=1;compensator=false";
@@ -936,8 +1125,25 @@ WarpXOpenPMDPlot::WriteOpenPMDFields ( //const std::string& filename,
 
       // Write local data
       amrex::Real const * local_data = fab.dataPtr( icomp );
-      mesh_comp.storeChunk( openPMD::shareRaw(local_data),
-                            chunk_offset, chunk_size );
+      if( m_SinglePrecision ) {
+          // convert on the device, and copy only the floats to the host
+          amrex::Long const npts = local_box.numPts();
+          amrex::Gpu::DeviceVector<float> single_data(npts);
+          float * const single_ptr = single_data.dataPtr();
+          amrex::ParallelFor(npts, [=] AMREX_GPU_DEVICE (amrex::Long i) noexcept {
+              single_ptr[i] = static_cast<float>(local_data[i]);
+          });
+          auto host_data = detail::allocateChunk< float >(npts);
+          amrex::Gpu::copyAsync(amrex::Gpu::deviceToHost,
+                                single_data.begin(), single_data.end(), host_data.get());
+          amrex::Gpu::streamSynchronize();
+          mesh_comp.storeChunk( host_data, chunk_offset, chunk_size );
+          m_StoredBytes += npts * sizeof(float);
+      } else {
+          mesh_comp.storeChunk( openPMD::shareRaw(local_data),
+                                chunk_offset, chunk_size );
+          m_StoredBytes += local_box.numPts() * sizeof(amrex::Real);
+      }
     }
   }
   // Flush data to disk after looping over all components
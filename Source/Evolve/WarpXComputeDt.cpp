@@ -67,6 +67,13 @@ WarpX::ComputeDt ()
     if (do_electrostatic != ElectrostaticSolverAlgo::None) {
         dt[0] = const_dt;
     }
+#ifdef WARPX_MAG_LLG
+    // magnetostatic mode: dt is set by the precession of M, not by the speed of light
+    if (mag_magnetostatic) {
+        dt[0] = const_dt;
+        if (mag_adaptive_dt) dt[0] = amrex::min(mag_adaptive_dt_max, amrex::max(mag_adaptive_dt_min, dt[0]));
+    }
+#endif
 
     for (int lev=0; lev <= max_level; lev++) {
         const amrex::Real* dx_lev = geom[lev].CellSize();
@@ -80,3 +87,21 @@ WarpX::ComputeDt ()
 #endif
     }
 }
+
+#ifdef WARPX_MAG_LLG
+/**
+ * Adapt the time step of the magnetostatic mode to the precession of M: dt is scaled by
+ * 0.9 * warpx.mag_adaptive_dt_angle / angle, where angle = max |M^{n+1} - M^{n}| / max(Ms) is the
+ * largest precession angle of M in the last step, with a growth (shrink) by at most a factor 2
+ * per step, and within [warpx.mag_adaptive_dt_min, warpx.mag_adaptive_dt_max]. */
+void
+WarpX::UpdateMagAdaptiveDt ()
+{
+    amrex::Real const angle = m_fdtd_solver_fp[0]->LLGDMIndicator();
+    amrex::Real factor = 2._rt;
+    if (angle > 0._rt) {
+        factor = amrex::min(2._rt, amrex::max(0.5_rt, 0.9_rt * mag_adaptive_dt_angle / angle));
+    }
+    dt[0] = amrex::min(mag_adaptive_dt_max, amrex::max(mag_adaptive_dt_min, factor * dt[0]));
+}
+#endif
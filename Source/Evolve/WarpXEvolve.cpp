@@ -13,7 +13,11 @@
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpXUtil.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/PhaseTimer.H"
 #include "Python/WarpX_py.H"
+#include "Parallelization/WarpXSumGuardCells.H"
+#include "Parallelization/CommStats.H"
 #ifdef WARPX_USE_PSATD
 #   include "FieldSolver/SpectralSolver/SpectralSolver.H"
 #endif
@@ -31,6 +35,9 @@ WarpX::Evolve (int numsteps)
 
     Real cur_time = t_new[0];
 
+    // the particles may have been changed since the last call (e.g. from Python)
+    m_rho_old_is_valid = false;
+
     if (do_compute_max_step_from_zmax) {
         computeMaxStepBoostAccelerator(geom[0]);
     }
@@ -45,6 +52,7 @@ WarpX::Evolve (int numsteps)
     bool early_params_checked = false; // check typos in inputs after step 1
 
     Real walltime, walltime_start = amrex::second();
+    PhaseTimer::Restart();
     for (int step = istep[0]; step < numsteps_max && cur_time < stop_time; ++step)
     {
         Real walltime_beg_step = amrex::second();
@@ -54,12 +62,12 @@ WarpX::Evolve (int numsteps)
         // Start loop on time steps
         amrex::Print() << "\nSTEP " << step+1 << " starts ...\n";
 
-        if (warpx_py_beforestep) warpx_py_beforestep();
+        ExecuteCallbacks(CallbackPoint::beforestep, step+1);
 
         amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(0);
         if (cost) {
-            if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::PSATD)
-                amrex::Abort("LoadBalance for PSATD: TODO");
+            // Add the GPU timers of the previous step to the costs
+            BoxCostTimer::Flush();
             if (step > 0 && load_balance_intervals.contains(step+1))
             {
                 LoadBalance();
@@ -84,20 +92,30 @@ WarpX::Evolve (int numsteps)
             }
         }
 
+        // Move the refined patches to where the refinement criteria are met
+        if (regrid_int > 0 && max_level > 0 && step > 0 && step % regrid_int == 0) {
+            Regrid();
+        }
+
+        // Fit of the weights of the heuristic costs: record the boxes before the step
+        CostsCalibrationBeginStep();
+
         // At the beginning, we have B^{n} and E^{n}.
         // Particles have p^{n} and x^{n}.
         // is_synchronized is true.
         if (is_synchronized) {
             if (do_electrostatic == ElectrostaticSolverAlgo::None) {
                 // Not called at each iteration, so exchange all guard cells
-                FillBoundaryE(guard_cells.ng_alloc_EB);
+                // (the exchanges of all the fields are in flight together)
+                FillBoundaryE_nowait(guard_cells.ng_alloc_EB);
 #ifndef WARPX_MAG_LLG
-                FillBoundaryB(guard_cells.ng_alloc_EB);
+                FillBoundaryB_nowait(guard_cells.ng_alloc_EB);
 #endif
 #ifdef WARPX_MAG_LLG
-                FillBoundaryH(guard_cells.ng_alloc_EB);
-                FillBoundaryM(guard_cells.ng_alloc_EB);
+                FillBoundaryH_nowait(guard_cells.ng_alloc_EB);
+                FillBoundaryM_nowait(guard_cells.ng_alloc_EB);
 #endif
+                FillBoundary_finish();
                 UpdateAuxilaryData();
                 FillBoundaryAux(guard_cells.ng_UpdateAux);
             }
@@ -115,14 +133,16 @@ WarpX::Evolve (int numsteps)
                 // Particles have p^{n-1/2} and x^{n}.
 
                 // E and B are up-to-date inside the domain only
-                FillBoundaryE(guard_cells.ng_FieldGather);
+                // (the exchanges of all the fields are in flight together)
+                FillBoundaryE_nowait(guard_cells.ng_FieldGather);
 #ifndef WARPX_MAG_LLG
-                FillBoundaryB(guard_cells.ng_FieldGather);
+                FillBoundaryB_nowait(guard_cells.ng_FieldGather);
 #endif
 #ifdef WARPX_MAG_LLG
-                FillBoundaryH(guard_cells.ng_FieldGather);
-                FillBoundaryM(guard_cells.ng_FieldGather);
+                FillBoundaryH_nowait(guard_cells.ng_FieldGather);
+                FillBoundaryM_nowait(guard_cells.ng_FieldGather);
 #endif
+                FillBoundary_finish();
                 // E and B: enough guard cells to update Aux or call Field Gather in fp and cp
                 // Need to update Aux on lower levels, to interpolate to higher levels.
                 if (fft_do_time_averaging)
@@ -176,6 +196,9 @@ WarpX::Evolve (int numsteps)
             // B : guard cells are NOT up-to-date
         }
 
+        // Fit of the weights of the heuristic costs: add the times of the boxes in the step
+        CostsCalibrationEndStep();
+
         if (cur_time + dt[0] >= stop_time - 1.e-3*dt[0] || step == numsteps_max-1) {
             // At the end of last step, push p by 0.5*dt to synchronize
             UpdateAuxilaryData();
@@ -221,8 +244,11 @@ WarpX::Evolve (int numsteps)
         } else
         {
             // Electromagnetic solver: due to CFL condition, particles can
-            // only move by one or two cells per time step
-            if (max_level == 0) {
+            // only move by one or two cells per time step, and are only
+            // exchanged with the neighbouring boxes. A full Redistribute is
+            // done on the steps at which the particles are sorted, which
+            // also catches any particle that moved further.
+            if (max_level == 0 && !sort_intervals.contains(step+1)) {
                 int num_redistribute_ghost = num_moved;
                 if ((m_v_galilean[0]!=0) or (m_v_galilean[1]!=0) or (m_v_galilean[2]!=0)) {
                     // Galilean algorithm ; particles can move by up to 2 cells
@@ -244,6 +270,8 @@ WarpX::Evolve (int numsteps)
             mypc->SortParticlesByBin(sort_bin_size);
         }
 
+        mypc->ShrinkParticleTiles(step+1);
+
         if( do_electrostatic != ElectrostaticSolverAlgo::None ) {
             // Electrostatic solver:
             // For each species: deposit charge and add the associated space-charge
@@ -268,19 +296,31 @@ WarpX::Evolve (int numsteps)
             t_new[i] = cur_time;
         }
 
-        /// reduced diags
-        if (reduced_diags->m_plot_rd != 0)
+        // the diagnostics of this step are timed with the next step
+        PhaseTimer::EndStep();
+
         {
-            reduced_diags->ComputeDiags(step);
-            reduced_diags->WriteToFile(step);
+            PhaseTimer diagnostics_timer(TimerPhase::Diagnostics);
+
+            /// reduced diags
+            if (reduced_diags->m_plot_rd != 0)
+            {
+                reduced_diags->ComputeDiags(step);
+                reduced_diags->WriteToFile(step);
+            }
+            multi_diags->FilterComputePackFlush( step );
         }
-        multi_diags->FilterComputePackFlush( step );
+
+#ifdef WARPX_MAG_LLG
+        // adapt the time step of the next step to the precession of M in this step
+        if (mag_adaptive_dt) UpdateMagAdaptiveDt();
+#endif
 
         if (cur_time >= stop_time - 1.e-3*dt[0]) {
             break;
         }
 
-        if (warpx_py_afterstep) warpx_py_afterstep();
+        ExecuteCallbacks(CallbackPoint::afterstep, step+1);
 
         // inputs: unused parameters (e.g. typos) check after step 1 has finished
         if (!early_params_checked) {
@@ -294,6 +334,10 @@ WarpX::Evolve (int numsteps)
 
     multi_diags->FilterComputePackFlush( istep[0], true );
 
+    if (reduced_diags->m_plot_rd != 0) {
+        reduced_diags->Flush();
+    }
+
     if (do_back_transformed_diagnostics) {
         myBFD->Flush(geom[0]);
     }
@@ -311,21 +355,30 @@ WarpX::OneStep_nosub (Real cur_time)
     //               from p^{n-1/2} to p^{n+1/2}
     // Deposit current j^{n+1/2}
     // Deposit charge density rho^{n}
-    if (warpx_py_particleinjection) warpx_py_particleinjection();
-    if (warpx_py_particlescraper) warpx_py_particlescraper();
-    if (warpx_py_beforedeposition) warpx_py_beforedeposition();
-    PushParticlesandDepose(cur_time);
-    if (warpx_py_afterdeposition) warpx_py_afterdeposition();
+    ExecuteCallbacks(CallbackPoint::particleinjection, istep[0]+1);
+    ExecuteCallbacks(CallbackPoint::particlescraper, istep[0]+1);
+    ExecuteCallbacks(CallbackPoint::beforedeposition, istep[0]+1);
+    // When the particles only moved since the deposition of rho^{n+1} at the previous
+    // step, rho^{n} is copied from it instead of being deposited again
+    const bool skip_rho_old = ReuseRhoOld();
+    if (skip_rho_old) {
+        const int ncomp = rho_fp[0]->nComp()/2;
+        MultiFab::Copy(*rho_fp[0], *rho_fp[0], ncomp, 0, ncomp, rho_fp[0]->nGrowVect());
+    }
+    PushParticlesandDepose(cur_time, skip_rho_old);
+    ExecuteCallbacks(CallbackPoint::afterdeposition, istep[0]+1);
 
     // Synchronize J and rho
     SyncCurrent();
-    SyncRho();
+    SyncRho(skip_rho_old);
+    m_rho_old_is_valid = (rho_fp[0] != nullptr);
 
     // Apply current correction in Fourier space: for periodic single-box global FFTs
-    // without guard cells, apply this after calling SyncCurrent
+    // without guard cells (or distributed global FFTs), apply this after calling SyncCurrent
     if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::PSATD) {
-        if (fft_periodic_single_box && current_correction) CurrentCorrection();
-        if (fft_periodic_single_box && (WarpX::current_deposition_algo == CurrentDepositionAlgo::Vay))
+        const bool global_fft = fft_periodic_single_box || fft_global;
+        if (global_fft && current_correction) CurrentCorrection();
+        if (global_fft && (WarpX::current_deposition_algo == CurrentDepositionAlgo::Vay))
             VayDeposition();
     }
 
@@ -340,8 +393,19 @@ WarpX::OneStep_nosub (Real cur_time)
 
     // ApplyExternalFieldExcitation
     ApplyExternalFieldExcitationOnGrid();
-    if (warpx_py_beforeEsolve) warpx_py_beforeEsolve();
+    ExecuteCallbacks(CallbackPoint::beforeEsolve, istep[0]+1);
 
+#ifdef WARPX_MAG_LLG
+    if (mag_magnetostatic) {
+        // Magnetostatic solver:
+        // Push M from {n} to {n+1}, with H the demagnetizing field of M
+        // (E is not advanced)
+        MacroscopicEvolveHM(dt[0]); // we now have M^{n+1} and H^{n+1}
+        FillBoundaryH_nowait(guard_cells.ng_FieldSolver);
+        FillBoundaryM_nowait(guard_cells.ng_FieldSolver);
+        FillBoundary_finish();
+    } else
+#endif
     if( do_electrostatic == ElectrostaticSolverAlgo::None ) {
         // Electromagnetic solver:
         // Push E and B from {n} to {n+1}
@@ -353,37 +417,61 @@ WarpX::OneStep_nosub (Real cur_time)
                 FillBoundaryE(guard_cells.ng_alloc_EB);
             }
             PushPSATD(dt[0]);
-            FillBoundaryE(guard_cells.ng_alloc_EB);
-            FillBoundaryB(guard_cells.ng_alloc_EB);
+            FillBoundaryE_nowait(guard_cells.ng_alloc_EB);
+            FillBoundaryB_nowait(guard_cells.ng_alloc_EB);
+            FillBoundary_start();
 
             if (use_hybrid_QED)
             {
+                FillBoundary_finish();
                 WarpX::Hybrid_QED_Push(dt);
                 FillBoundaryE(guard_cells.ng_alloc_EB);
             }
             if (do_pml) {
+                // Only the PML fields are modified here: this overlaps
+                // with the guard cell exchange of E and B
                 DampPML();
                 NodalSyncPML();
             }
+            FillBoundary_finish();
+#ifndef WARPX_MAG_LLG
+        } else if (do_fused_fdtd) {
+            // the excitations only set E and B in the valid cells, while the fused step
+            // reads them in the guard cells too
+            if (E_excitation_grid_s != "default") FillBoundaryE(guard_cells.ng_FieldSolver);
+            if (B_excitation_grid_s != "default") FillBoundaryB(guard_cells.ng_FieldSolver);
+            // B^{n+1/2}, E^{n+1} and B^{n+1} in a single sweep over the boxes, which also
+            // updates the guard cells of E and B with intermediate values
+            EvolveBEFused(dt[0]); // We now have E^{n+1} and B^{n+1}
+            FillBoundaryE_nowait(guard_cells.ng_FieldSolver);
+            FillBoundaryB_nowait(guard_cells.ng_FieldSolver);
+            FillBoundary_finish();
+#endif
         } else {
-            EvolveF(0.5_rt * dt[0], DtType::FirstHalf);
-            FillBoundaryF(guard_cells.ng_FieldSolverF);
 #ifndef WARPX_MAG_LLG
-            EvolveB(0.5 * dt[0]); // We now have B^{n+1/2}
-            if (do_silver_mueller) ApplySilverMuellerBoundary( dt[0] );
+            // F and B are updated in the same sweeps over the boxes, which read E^{n};
+            // the Silver-Mueller boundary condition can be applied in the kernels of B too
+            EvolveBF(0.5_rt * dt[0], DtType::FirstHalf,
+                     do_silver_mueller && do_silver_mueller_fused); // We now have F^{n+1/2} and B^{n+1/2}
+            if (do_silver_mueller && !do_silver_mueller_fused) ApplySilverMuellerBoundary( dt[0] );
+            FillBoundaryF(guard_cells.ng_FieldSolverF);
             FillBoundaryB(guard_cells.ng_FieldSolver);
+#else
+            EvolveF(0.5_rt * dt[0], DtType::FirstHalf);
+            FillBoundaryF(guard_cells.ng_FieldSolverF);
 #endif
 #ifdef WARPX_MAG_LLG
             if (WarpX::em_solver_medium == MediumForEM::Macroscopic) { //evolveM is not applicable to vacuum
-                if (mag_time_scheme_order==1){
+                if (mag_time_scheme_order==1 || mag_time_scheme_order==3){
                     MacroscopicEvolveHM(0.5*dt[0]); // we now have M^{n+1/2} and H^{n+1/2}
                 } else if (mag_time_scheme_order==2){
                     MacroscopicEvolveHM_2nd(0.5*dt[0]); // we now have M^{n+1/2} and H^{n+1/2}
                 } else {
                     amrex::Abort("unsupported mag_time_scheme_order for M field");
                 }
-                FillBoundaryH(guard_cells.ng_FieldSolver);
-                FillBoundaryM(guard_cells.ng_FieldSolver);
+                FillBoundaryH_nowait(guard_cells.ng_FieldSolver);
+                FillBoundaryM_nowait(guard_cells.ng_FieldSolver);
+                FillBoundary_finish();
             } else {
                 amrex::Abort("unsupported em_solver_medium for M field");
             }
@@ -399,20 +487,16 @@ WarpX::OneStep_nosub (Real cur_time)
             }
 
             FillBoundaryE(guard_cells.ng_FieldSolver);
-            EvolveF(0.5_rt * dt[0], DtType::SecondHalf);
 #ifndef WARPX_MAG_LLG
-            EvolveB(0.5_rt * dt[0]); // We now have B^{n+1}
+            EvolveBF(0.5_rt * dt[0], DtType::SecondHalf); // We now have F^{n+1} and B^{n+1}
+#else
+            EvolveF(0.5_rt * dt[0], DtType::SecondHalf);
 #endif
             if (do_pml) {
                 FillBoundaryF(guard_cells.ng_alloc_F);
                 DampPML();
                 NodalSyncPML();
-                FillBoundaryE(guard_cells.ng_MovingWindow);
-                FillBoundaryF(guard_cells.ng_MovingWindow);
-                FillBoundaryB(guard_cells.ng_MovingWindow);
-#ifdef WARPX_MAG_LLG
-                FillBoundaryH(guard_cells.ng_MovingWindow);
-#endif
+                FillBoundaryEBF(guard_cells.ng_MovingWindow);
             }
             // E and B are up-to-date in the domain, but all guard cells are
             // outdated.
@@ -421,7 +505,7 @@ WarpX::OneStep_nosub (Real cur_time)
             }
 #ifdef WARPX_MAG_LLG
             if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
-                if (mag_time_scheme_order==1){
+                if (mag_time_scheme_order==1 || mag_time_scheme_order==3){
                     MacroscopicEvolveHM(0.5*dt[0]); // we now have M^{n+1} and H^{n+1}
                 } else if (mag_time_scheme_order==2){
                     MacroscopicEvolveHM_2nd(0.5*dt[0]); // we now have M^{n+1} and H^{n+1}
@@ -443,7 +527,40 @@ WarpX::OneStep_nosub (Real cur_time)
 
     } // !do_electrostatic
 
-    if (warpx_py_afterEsolve) warpx_py_afterEsolve();
+    ExecuteCallbacks(CallbackPoint::afterEsolve, istep[0]+1);
+}
+
+bool
+WarpX::ReuseRhoOld ()
+{
+    bool reusable = reuse_rho_old && rho_fp[0] &&
+        WarpX::maxwell_solver_id == MaxwellSolverAlgo::PSATD &&
+        do_electrostatic == ElectrostaticSolverAlgo::None &&
+        finest_level == 0 && !do_moving_window &&
+        m_v_galilean[0] == 0._rt && m_v_galilean[1] == 0._rt && m_v_galilean[2] == 0._rt &&
+        !mypc->ParticlesChangeOutsideOfPush();
+#ifdef WARPX_DIM_RZ
+    // rho is scaled by the inverse volume of the cells after each deposition
+    reusable = false;
+#endif
+    if (!reusable) {
+        m_rho_old_is_valid = false;
+        return false;
+    }
+
+    // The particles absorbed at the boundaries are the only change of the number of particles
+    Vector<Long> num_particles(mypc->nSpecies());
+    for (int is = 0; is < mypc->nSpecies(); ++is) {
+        num_particles[is] = mypc->GetParticleContainer(is).TotalNumberOfParticles(false, true);
+    }
+    ParallelDescriptor::ReduceLongSum(num_particles.data(), static_cast<int>(num_particles.size()));
+
+    const bool reuse = m_rho_old_is_valid &&
+        NumCallbacksExecuted() == m_rho_deposition_callbacks &&
+        num_particles == m_rho_deposition_num_particles;
+    m_rho_deposition_callbacks = NumCallbacksExecuted();
+    m_rho_deposition_num_particles = num_particles;
+    return reuse;
 }
 
 /* /brief Perform one PIC iteration, with subcycling
@@ -644,18 +761,29 @@ WarpX::doQEDEvents (int lev)
 #endif
 
 void
-WarpX::PushParticlesandDepose (amrex::Real cur_time)
+WarpX::PushParticlesandDepose (amrex::Real cur_time, bool skip_rho_old)
 {
     // Evolve particles to p^{n+1/2} and x^{n+1}
     // Depose current, j^{n+1/2}
     for (int lev = 0; lev <= finest_level; ++lev) {
-        PushParticlesandDepose(lev, cur_time);
+        PushParticlesandDepose(lev, cur_time, DtType::Full, skip_rho_old);
     }
 }
 
 void
-WarpX::PushParticlesandDepose (int lev, amrex::Real cur_time, DtType a_dt_type)
+WarpX::PushParticlesandDepose (int lev, amrex::Real cur_time, DtType a_dt_type,
+                               bool skip_rho_old)
 {
+    PhaseTimer timer(TimerPhase::ParticlePush);
+
+    // The filtered fields are gathered by all the species
+    if (use_fdtd_nci_corr) ApplyNCIFilter(lev);
+
+    if (pipeline_current_sum && finest_level == 0 && mypc->nSpecies() > 1) {
+        PushParticlesandDeposePipelined(cur_time, a_dt_type, skip_rho_old);
+        return;
+    }
+
     mypc->Evolve(lev,
                  *Efield_aux[lev][0],*Efield_aux[lev][1],*Efield_aux[lev][2],
                  *Bfield_aux[lev][0],*Bfield_aux[lev][1],*Bfield_aux[lev][2],
@@ -666,7 +794,7 @@ WarpX::PushParticlesandDepose (int lev, amrex::Real cur_time, DtType a_dt_type)
                  rho_fp[lev].get(), charge_buf[lev].get(),
                  Efield_cax[lev][0].get(), Efield_cax[lev][1].get(), Efield_cax[lev][2].get(),
                  Bfield_cax[lev][0].get(), Bfield_cax[lev][1].get(), Bfield_cax[lev][2].get(),
-                 cur_time, dt[lev], a_dt_type);
+                 cur_time, dt[lev], a_dt_type, skip_rho_old);
 #ifdef WARPX_DIM_RZ
     // This is called after all particles have deposited their current and charge.
     ApplyInverseVolumeScalingToCurrentDensity(current_fp[lev][0].get(), current_fp[lev][1].get(), current_fp[lev][2].get(), lev);
@@ -682,6 +810,147 @@ WarpX::PushParticlesandDepose (int lev, amrex::Real cur_time, DtType a_dt_type)
 #endif
 }
 
+namespace
+{
+    /** Filter src into dst, which is (re)allocated if it is not defined on the
+     *  boxes of src, with ng guard cells (at most those of src). The time spent
+     *  on each box is added to cost, if not null. */
+    void FilterNCI (std::unique_ptr<MultiFab>& dst, const MultiFab& src,
+                    NCIGodfreyFilter& filter, const IntVect& ng,
+                    LayoutData<Real>* cost)
+    {
+        if (!dst || dst->boxArray() != src.boxArray() ||
+            dst->DistributionMap() != src.DistributionMap()) {
+            dst = std::make_unique<MultiFab>(src.boxArray(), src.DistributionMap(),
+                                             src.nComp(), ng.min(src.nGrowVect()));
+        }
+        filter.ApplyStencil(*dst, src, 0, 0, src.nComp(), cost);
+    }
+}
+
+void
+WarpX::ApplyNCIFilter (int lev)
+{
+    WARPX_PROFILE("WarpX::ApplyNCIFilter()");
+
+    // The particles gather within nox (noy, noz) cells of their box
+    const IntVect ng(AMREX_D_DECL(static_cast<int>(nox),
+                                  static_cast<int>(noy),
+                                  static_cast<int>(noz)));
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    // Same filter for fields Ex, Ey and Bz, and for fields Bx, By and Ez.
+    // In 2D, only Ex, Ez and By are filtered.
+    auto filter_patch = [&] (int glev,
+                             const std::array<std::unique_ptr<MultiFab>,3>& E,
+                             const std::array<std::unique_ptr<MultiFab>,3>& B,
+                             std::array<std::unique_ptr<MultiFab>,3>& E_nci,
+                             std::array<std::unique_ptr<MultiFab>,3>& B_nci)
+    {
+        NCIGodfreyFilter& exeybz = *nci_godfrey_filter_exeybz[glev];
+        NCIGodfreyFilter& bxbyez = *nci_godfrey_filter_bxbyez[glev];
+        FilterNCI(E_nci[0], *E[0], exeybz, ng, cost);
+        FilterNCI(E_nci[2], *E[2], bxbyez, ng, cost);
+        FilterNCI(B_nci[1], *B[1], bxbyez, ng, cost);
+#if (AMREX_SPACEDIM == 3)
+        FilterNCI(E_nci[1], *E[1], exeybz, ng, cost);
+        FilterNCI(B_nci[0], *B[0], bxbyez, ng, cost);
+        FilterNCI(B_nci[2], *B[2], exeybz, ng, cost);
+#endif
+    };
+
+    filter_patch(lev, Efield_aux[lev], Bfield_aux[lev], Efield_nci[lev], Bfield_nci[lev]);
+    // Coarse patch, gathered by the particles in the gather buffers
+    if (Efield_cax[lev][0]) {
+        filter_patch(lev-1, Efield_cax[lev], Bfield_cax[lev],
+                     Efield_nci_cax[lev], Bfield_nci_cax[lev]);
+    }
+}
+
+void
+WarpX::PushParticlesandDeposePipelined (amrex::Real cur_time, DtType a_dt_type,
+                                        bool skip_rho_old)
+{
+    constexpr int lev = 0;
+    const auto& period = Geom(lev).periodicity();
+
+    for (auto const& j : current_fp[lev]) j->setVal(0.0);
+    if (rho_fp[lev]) {
+        // with skip_rho_old, rho_old (the first half of the components) is kept
+        const int icomp = skip_rho_old ? rho_fp[lev]->nComp()/2 : 0;
+        rho_fp[lev]->setVal(0.0, icomp, rho_fp[lev]->nComp()-icomp, rho_fp[lev]->nGrowVect());
+    }
+
+    // Two buffers: a species deposits its current in one of them, while the sum of the
+    // current of the previous species, from the other one, is in flight
+    std::array<std::array<std::unique_ptr<MultiFab>,3>,2> j_buf;
+    // Sources of the sums in flight (the buffers, or the filtered buffers)
+    std::array<std::array<std::unique_ptr<MultiFab>,3>,2> j_filtered;
+    int ibuf = 0;
+    bool in_flight = false;
+
+    for (int ispecies = 0; ispecies < mypc->nSpecies(); ++ispecies) {
+        WarpXParticleContainer& pc = mypc->GetParticleContainer(ispecies);
+        auto& j = j_buf[ibuf];
+        for (int idim = 0; idim < 3; ++idim) {
+            if (!j[idim]) {
+                const MultiFab& jfp = *current_fp[lev][idim];
+                j[idim] = std::make_unique<MultiFab>(jfp.boxArray(), jfp.DistributionMap(),
+                                                     jfp.nComp(), jfp.nGrowVect());
+            }
+            j[idim]->setVal(0.0);
+        }
+        pc.Evolve(lev,
+                  *Efield_aux[lev][0],*Efield_aux[lev][1],*Efield_aux[lev][2],
+                  *Bfield_aux[lev][0],*Bfield_aux[lev][1],*Bfield_aux[lev][2],
+                  *Efield_avg_aux[lev][0],*Efield_avg_aux[lev][1],*Efield_avg_aux[lev][2],
+                  *Bfield_avg_aux[lev][0],*Bfield_avg_aux[lev][1],*Bfield_avg_aux[lev][2],
+                  *j[0], *j[1], *j[2],
+                  current_buf[lev][0].get(), current_buf[lev][1].get(), current_buf[lev][2].get(),
+                  rho_fp[lev].get(), charge_buf[lev].get(),
+                  Efield_cax[lev][0].get(), Efield_cax[lev][1].get(), Efield_cax[lev][2].get(),
+                  Bfield_cax[lev][0].get(), Bfield_cax[lev][1].get(), Bfield_cax[lev][2].get(),
+                  cur_time, dt[lev], a_dt_type, skip_rho_old);
+        // e.g. photons: nothing to add
+        if (pc.getCharge() == 0._prt) continue;
+
+#ifdef WARPX_DIM_RZ
+        ApplyInverseVolumeScalingToCurrentDensity(j[0].get(), j[1].get(), j[2].get(), lev);
+#endif
+        // The sum of the previous species must be complete before the next one starts
+        if (in_flight) {
+            for (auto const& jfp : current_fp[lev]) jfp->ParallelCopy_finish();
+        }
+        for (int idim = 0; idim < 3; ++idim) {
+            const MultiFab* src = j[idim].get();
+            if (use_filter) {
+                IntVect ng = j[idim]->nGrowVect();
+                ng += bilinear_filter.stencil_length_each_dir-1;
+                j_filtered[ibuf][idim] = std::make_unique<MultiFab>(
+                    j[idim]->boxArray(), j[idim]->DistributionMap(), j[idim]->nComp(), ng);
+                bilinear_filter.ApplyStencil(*j_filtered[ibuf][idim], *j[idim]);
+                src = j_filtered[ibuf][idim].get();
+            }
+            // the sum is completed by ParallelCopy_finish, with the deposition of the next species
+            CommStats comm_stats(CommSite::SumBoundaryJ);
+            WarpXAddGuardCells_nowait(*current_fp[lev][idim], *src, period);
+        }
+        in_flight = true;
+        ibuf = 1 - ibuf;
+    }
+    if (in_flight) {
+        for (auto const& jfp : current_fp[lev]) jfp->ParallelCopy_finish();
+    }
+    m_current_is_summed = true;
+
+#ifdef WARPX_DIM_RZ
+    if (rho_fp[lev].get()) {
+        ApplyInverseVolumeScalingToChargeDensity(rho_fp[lev].get(), lev);
+    }
+#endif
+}
+
 /* \brief computes max_step for wakefield simulation in boosted frame.
  * \param geom: Geometry object that contains simulation domain.
  *
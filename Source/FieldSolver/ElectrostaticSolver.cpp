@@ -16,6 +16,8 @@
 
 #include <WarpX.H>
 
+#include <algorithm>
+#include <cmath>
 #include <memory>
 
 using namespace amrex;
@@ -36,13 +38,38 @@ WarpX::ComputeSpaceChargeField (bool const reset_fields)
     if (do_electrostatic == ElectrostaticSolverAlgo::LabFrame) {
         AddSpaceChargeFieldLabFrame();
     } else {
-        // Loop over the species and add their space-charge contribution to E and B
+        // Group the species whose mean velocities agree within
+        // self_fields_beta_tolerance, and add the space-charge contribution
+        // of each group to E and B, with one Poisson solve per group
+        Vector<Vector<WarpXParticleContainer*> > groups;
+        Vector<std::array<Real, 3> > groups_beta;
         for (int ispecies=0; ispecies<mypc->nSpecies(); ispecies++){
             WarpXParticleContainer& species = mypc->GetParticleContainer(ispecies);
-            if (species.initialize_self_fields ||
-                (do_electrostatic == ElectrostaticSolverAlgo::Relativistic)) {
-                AddSpaceChargeField(species);
+            if (!species.initialize_self_fields &&
+                (do_electrostatic != ElectrostaticSolverAlgo::Relativistic)) continue;
+
+            // Get the particle beta vector
+            bool const local_average = false; // Average across all MPI ranks
+            std::array<Real, 3> beta = species.meanParticleVelocity(local_average);
+            for (Real& beta_comp : beta) beta_comp /= PhysConst::c; // Normalize
+
+            int igroup = 0;
+            for (; igroup < static_cast<int>(groups.size()); ++igroup) {
+                bool same_beta = true;
+                for (int idim = 0; idim < 3; ++idim) {
+                    same_beta = same_beta &&
+                        std::abs(beta[idim] - groups_beta[igroup][idim]) <= self_fields_beta_tolerance;
+                }
+                if (same_beta) break;
+            }
+            if (igroup == static_cast<int>(groups.size())) {
+                groups.push_back({});
+                groups_beta.push_back(beta);
             }
+            groups[igroup].push_back(&species);
+        }
+        for (int igroup = 0; igroup < static_cast<int>(groups.size()); ++igroup) {
+            AddSpaceChargeField(groups[igroup], groups_beta[igroup]);
         }
     }
     // Transfer fields from 'fp' array to 'aux' array.
@@ -53,8 +80,16 @@ WarpX::ComputeSpaceChargeField (bool const reset_fields)
 
 }
 
+/* \brief Add the space-charge fields of a group of species that move at
+   (approximately) the same velocity, with a single Poisson solve for the sum
+   of their charge densities
+
+   \param[in] species The species of the group
+   \param[in] beta The velocity of the group, normalized by c
+*/
 void
-WarpX::AddSpaceChargeField (WarpXParticleContainer& pc)
+WarpX::AddSpaceChargeField (Vector<WarpXParticleContainer*> const& species,
+                            std::array<Real, 3> const beta)
 {
 
 #ifdef WARPX_DIM_RZ
@@ -65,6 +100,7 @@ WarpX::AddSpaceChargeField (WarpXParticleContainer& pc)
     // Allocate fields for charge and potential
     const int num_levels = max_level + 1;
     Vector<std::unique_ptr<MultiFab> > rho(num_levels);
+    Vector<std::unique_ptr<MultiFab> > rho_species(num_levels);
     Vector<std::unique_ptr<MultiFab> > phi(num_levels);
     // Use number of guard cells used for local deposition of rho
     const amrex::IntVect ng = guard_cells.ng_depos_rho;
@@ -72,23 +108,38 @@ WarpX::AddSpaceChargeField (WarpXParticleContainer& pc)
         BoxArray nba = boxArray(lev);
         nba.surroundingNodes();
         rho[lev] = std::make_unique<MultiFab>(nba, dmap[lev], 1, ng);
+        rho[lev]->setVal(0.);
+        if (species.size() > 1) {
+            rho_species[lev] = std::make_unique<MultiFab>(nba, dmap[lev], 1, ng);
+        }
         phi[lev] = std::make_unique<MultiFab>(nba, dmap[lev], 1, 1);
         phi[lev]->setVal(0.);
     }
 
     // Deposit particle charge density (source of Poisson solver)
+    // (each species is deposited separately, since the exchange of the guard
+    // cells and the average down of the charge density are done on deposition)
     bool const local = false;
     bool const reset = true;
     bool const do_rz_volume_scaling = true;
-    pc.DepositCharge(rho, local, reset, do_rz_volume_scaling);
-
-    // Get the particle beta vector
-    bool const local_average = false; // Average across all MPI ranks
-    std::array<Real, 3> beta = pc.meanParticleVelocity(local_average);
-    for (Real& beta_comp : beta) beta_comp /= PhysConst::c; // Normalize
+    Real required_precision = species[0]->self_fields_required_precision;
+    int max_iters = species[0]->self_fields_max_iters;
+    for (WarpXParticleContainer* pc : species) {
+        if (species.size() == 1) {
+            pc->DepositCharge(rho, local, reset, do_rz_volume_scaling);
+        } else {
+            pc->DepositCharge(rho_species, local, reset, do_rz_volume_scaling);
+            for (int lev = 0; lev <= max_level; lev++) {
+                MultiFab::Add(*rho[lev], *rho_species[lev], 0, 0, 1, rho[lev]->nGrowVect());
+            }
+        }
+        // The group is solved with the strictest requirements of its species
+        required_precision = std::min(required_precision, pc->self_fields_required_precision);
+        max_iters = std::max(max_iters, pc->self_fields_max_iters);
+    }
 
     // Compute the potential phi, by solving the Poisson equation
-    computePhi( rho, phi, beta, pc.self_fields_required_precision, pc.self_fields_max_iters );
+    computePhi( rho, phi, beta, required_precision, max_iters );
 
     // Compute the corresponding electric and magnetic field, from the potential phi
     computeE( Efield_fp, phi, beta );
@@ -106,7 +157,7 @@ WarpX::AddSpaceChargeFieldLabFrame ()
 #endif
 
     // Allocate fields for charge
-    // Also, zero out the phi data
+    // (phi_fp is not reset: the previous potential is the initial guess of the solver)
     const int num_levels = max_level + 1;
     Vector<std::unique_ptr<MultiFab> > rho(num_levels);
     // Use number of guard cells used for local deposition of rho
@@ -116,7 +167,6 @@ WarpX::AddSpaceChargeFieldLabFrame ()
         nba.surroundingNodes();
         rho[lev] = std::make_unique<MultiFab>(nba, dmap[lev], 1, ng);
         rho[lev]->setVal(0.);
-        phi_fp[lev]->setVal(0.);
     }
 
     // Deposit particle charge density (source of Poisson solver)
@@ -153,8 +203,11 @@ WarpX::AddSpaceChargeFieldLabFrame ()
    a source, assuming that the source moves at a constant speed \f$\vec{\beta}\f$.
    This uses the amrex solver.
 
+   The linear operator and the MLMG solver are kept between calls, and
+   the input value of `phi` is used as the initial guess.
+
    \param[in] rho The charge density a given species
-   \param[out] phi The potential to be computed by this function
+   \param[inout] phi The potential to be computed by this function
    \param[in] beta Represents the velocity of the source of `phi`
 */
 void
@@ -164,12 +217,49 @@ WarpX::computePhi (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho,
                    Real const required_precision,
                    int const max_iters) const
 {
+#if defined(WARPX_USE_PSATD) && !defined(WARPX_DIM_RZ)
+    if (poisson_solver_id == PoissonSolverAlgo::FFT) {
+        // Direct solve on level 0 (max_level = 0 is checked when reading the input)
+        if (!m_fft_poisson_solver) {
+            m_fft_poisson_solver = std::make_unique<FFTPoissonSolver>(Geom(0));
+        }
+        m_fft_poisson_solver->Solve(*rho[0], *phi[0], beta);
+        m_poisson_num_iters = 0;
+        return;
+    }
+#endif
+
 #ifdef WARPX_DIM_RZ
     computePhiRZ( rho, phi, beta, required_precision, max_iters );
 #else
     computePhiCartesian( rho, phi, beta, required_precision, max_iters );
 #endif
 
+    m_poisson_num_iters = m_poisson_mlmg->getNumIters();
+}
+
+/* \brief Whether the cached Poisson solver must be (re)built, i.e. if it
+   does not exist yet, or if the grids or the distribution mapping have
+   changed since it was built. In RZ, the geometry of the solver is scaled
+   by the Lorentz factor, and the solver is also rebuilt when `beta` changes
+   (in Cartesian geometry, `beta` is only a coefficient of the operator).
+
+   \param[in] beta Represents the velocity of the source of `phi`
+*/
+bool
+WarpX::PoissonSolverNeedsRebuild (std::array<Real, 3> const beta) const
+{
+    if (!m_poisson_mlmg) return true;
+#ifdef WARPX_DIM_RZ
+    if (beta != m_poisson_beta) return true;
+#else
+    amrex::ignore_unused(beta);
+#endif
+    if (static_cast<int>(m_poisson_ba.size()) != max_level+1) return true;
+    for (int lev = 0; lev <= max_level; ++lev) {
+        if (m_poisson_ba[lev] != boxArray(lev) || m_poisson_dm[lev] != dmap[lev]) return true;
+    }
+    return false;
 }
 
 #ifdef WARPX_DIM_RZ
@@ -193,6 +283,62 @@ WarpX::computePhiRZ (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho
                    std::array<Real, 3> const beta,
                    Real const required_precision,
                    int const max_iters) const
+{
+    if (PoissonSolverNeedsRebuild(beta)) {
+        BuildPoissonSolverRZ(beta);
+        // The previous potential is not a valid initial guess on new grids
+        for (int lev = 0; lev <= max_level; ++lev) phi[lev]->setVal(0.);
+    }
+
+    // Multiply rho by radius (rho is node centered)
+    // Note that this multiplication is not undone since rho is
+    // a temporary array.
+    for (int lev = 0; lev <= max_level; ++lev) {
+        const amrex::Real rmin = Geom(lev).ProbLo(0);
+        const amrex::Real dr = Geom(lev).CellSize(0);
+        for ( MFIter mfi(*rho[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi )
+        {
+            const amrex::Box& tbx = mfi.tilebox();
+            const amrex::Dim3 lo = amrex::lbound(tbx);
+            const int irmin = lo.x;
+            int const ncomp = rho[lev]->nComp(); // This should be 1!
+            Array4<Real> const& rho_arr = rho[lev]->array(mfi);
+            amrex::ParallelFor(tbx, ncomp,
+            [=] AMREX_GPU_DEVICE (int i, int j, int /*k*/, int icomp)
+            {
+                amrex::Real r = rmin + (i - irmin)*dr;
+                if (r == 0.) {
+                    // dr/3 is used to be consistent with the finite volume formulism
+                    // that is used to solve Poisson's equation
+                    rho_arr(i,j,0,icomp) *= dr/3._rt;
+                } else {
+                    rho_arr(i,j,0,icomp) *= r;
+                }
+            });
+        }
+    }
+
+    // Solve the Poisson equation, starting from the previous potential
+    // (converted to the normalization of the solver)
+    for (int lev=0; lev < rho.size(); lev++){
+        phi[lev]->mult(-PhysConst::ep0);
+    }
+    m_poisson_mlmg->setMaxIter(max_iters);
+    m_poisson_mlmg->solve( GetVecOfPtrs(phi), GetVecOfConstPtrs(rho), required_precision, 0.0);
+
+    // Normalize by the correct physical constant
+    for (int lev=0; lev < rho.size(); lev++){
+        phi[lev]->mult(-1._rt/PhysConst::ep0);
+    }
+}
+
+/* \brief Build the linear operator and the MLMG solver used by computePhiRZ,
+   for the current grids and the velocity `beta` of the source
+
+   \param[in] beta Represents the velocity of the source of `phi`
+*/
+void
+WarpX::BuildPoissonSolverRZ (std::array<Real, 3> const beta) const
 {
     // Create a new geometry with the z coordinate scaled by gamma
     amrex::Real const gamma = std::sqrt(1._rt/(1. - beta[2]*beta[2]));
@@ -236,30 +382,6 @@ WarpX::computePhiRZ (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho
                 }
             );
         }
-
-        // Also, multiply rho by radius (rho is node centered)
-        // Note that this multiplication is not undone since rho is
-        // a temporary array.
-        for ( MFIter mfi(*rho[lev], TilingIfNotGPU()); mfi.isValid(); ++mfi )
-        {
-            const amrex::Box& tbx = mfi.tilebox();
-            const amrex::Dim3 lo = amrex::lbound(tbx);
-            const int irmin = lo.x;
-            int const ncomp = rho[lev]->nComp(); // This should be 1!
-            Array4<Real> const& rho_arr = rho[lev]->array(mfi);
-            amrex::ParallelFor(tbx, ncomp,
-            [=] AMREX_GPU_DEVICE (int i, int j, int /*k*/, int icomp)
-            {
-                amrex::Real r = rmin + (i - irmin)*dr;
-                if (r == 0.) {
-                    // dr/3 is used to be consistent with the finite volume formulism
-                    // that is used to solve Poisson's equation
-                    rho_arr(i,j,0,icomp) *= dr/3._rt;
-                } else {
-                    rho_arr(i,j,0,icomp) *= r;
-                }
-            });
-        }
     }
 
     // Define the boundary conditions
@@ -277,22 +399,20 @@ WarpX::computePhiRZ (const amrex::Vector<std::unique_ptr<amrex::MultiFab> >& rho
     }
 
     // Define the linear operator (Poisson operator)
-    MLNodeLaplacian linop( geom_scaled, boxArray(), dmap );
+    // (the MLMG solver refers to the operator, and is thus destroyed first)
+    m_poisson_mlmg.reset();
+    m_poisson_linop = std::make_unique<MLNodeLaplacian>( geom_scaled, boxArray(), dmap );
     for (int lev = 0; lev <= max_level; ++lev) {
-        linop.setSigma( lev, *sigma[lev] );
+        m_poisson_linop->setSigma( lev, *sigma[lev] );
     }
+    m_poisson_linop->setDomainBC( lobc, hibc );
 
-    // Solve the Poisson equation
-    linop.setDomainBC( lobc, hibc );
-    MLMG mlmg(linop);
-    mlmg.setVerbose(2);
-    mlmg.setMaxIter(max_iters);
-    mlmg.solve( GetVecOfPtrs(phi), GetVecOfConstPtrs(rho), required_precision, 0.0);
+    m_poisson_mlmg = std::make_unique<MLMG>(*m_poisson_linop);
+    m_poisson_mlmg->setVerbose(2);
 
-    // Normalize by the correct physical constant
-    for (int lev=0; lev < rho.size(); lev++){
-        phi[lev]->mult(-1._rt/PhysConst::ep0);
-    }
+    m_poisson_beta = beta;
+    m_poisson_ba = boxArray();
+    m_poisson_dm = dmap;
 }
 
 #else
@@ -319,6 +439,53 @@ WarpX::computePhiCartesian (const amrex::Vector<std::unique_ptr<amrex::MultiFab>
                             int const max_iters) const
 {
 
+    if (PoissonSolverNeedsRebuild(beta)) {
+        BuildPoissonSolverCartesian(beta);
+        // The previous potential is not a valid initial guess on new grids
+        for (int lev = 0; lev <= max_level; ++lev) phi[lev]->setVal(0.);
+    } else if (beta != m_poisson_beta) {
+        // Keep the multigrid hierarchy, and only update the operator
+        // (e.g. between the groups of species of AddSpaceChargeField)
+        m_poisson_linop->setBeta( PoissonSolverBeta(beta) );
+        m_poisson_beta = beta;
+    }
+
+    // Solve the Poisson equation, starting from the previous potential
+    // (converted to the normalization of the solver)
+    for (int lev=0; lev < rho.size(); lev++){
+        phi[lev]->mult(-PhysConst::ep0);
+    }
+    m_poisson_mlmg->setMaxIter(max_iters);
+    m_poisson_mlmg->solve( GetVecOfPtrs(phi), GetVecOfConstPtrs(rho), required_precision, 0.0);
+
+    // Normalize by the correct physical constant
+    for (int lev=0; lev < rho.size(); lev++){
+        phi[lev]->mult(-1._rt/PhysConst::ep0);
+    }
+}
+
+/* \brief Components of `beta` along the dimensions of the Poisson solver
+
+   \param[in] beta Represents the velocity of the source of `phi`
+*/
+amrex::Array<amrex::Real,AMREX_SPACEDIM>
+WarpX::PoissonSolverBeta (std::array<Real, 3> const beta)
+{
+#if (AMREX_SPACEDIM==2)
+    return {{ beta[0], beta[2] }};  // beta_x and beta_z
+#else
+    return {{ beta[0], beta[1], beta[2] }};
+#endif
+}
+
+/* \brief Build the linear operator and the MLMG solver used by computePhiCartesian,
+   for the current grids and the velocity `beta` of the source
+
+   \param[in] beta Represents the velocity of the source of `phi`
+*/
+void
+WarpX::BuildPoissonSolverCartesian (std::array<Real, 3> const beta) const
+{
     // Define the boundary conditions
     Array<LinOpBCType,AMREX_SPACEDIM> lobc, hibc;
     for (int idim=0; idim<AMREX_SPACEDIM; idim++){
@@ -334,27 +501,19 @@ WarpX::computePhiCartesian (const amrex::Vector<std::unique_ptr<amrex::MultiFab>
     }
 
     // Define the linear operator (Poisson operator)
-    MLNodeTensorLaplacian linop( Geom(), boxArray(), DistributionMap() );
+    // (the MLMG solver refers to the operator, and is thus destroyed first)
+    m_poisson_mlmg.reset();
+    m_poisson_linop = std::make_unique<MLNodeTensorLaplacian>( Geom(), boxArray(), DistributionMap() );
     // Set the value of beta
-    amrex::Array<amrex::Real,AMREX_SPACEDIM> beta_solver =
-#if (AMREX_SPACEDIM==2)
-        {{ beta[0], beta[2] }};  // beta_x and beta_z
-#else
-        {{ beta[0], beta[1], beta[2] }};
-#endif
-    linop.setBeta( beta_solver );
+    m_poisson_linop->setBeta( PoissonSolverBeta(beta) );
+    m_poisson_linop->setDomainBC( lobc, hibc );
 
-    // Solve the Poisson equation
-    linop.setDomainBC( lobc, hibc );
-    MLMG mlmg(linop);
-    mlmg.setVerbose(2);
-    mlmg.setMaxIter(max_iters);
-    mlmg.solve( GetVecOfPtrs(phi), GetVecOfConstPtrs(rho), required_precision, 0.0);
+    m_poisson_mlmg = std::make_unique<MLMG>(*m_poisson_linop);
+    m_poisson_mlmg->setVerbose(2);
 
-    // Normalize by the correct physical constant
-    for (int lev=0; lev < rho.size(); lev++){
-        phi[lev]->mult(-1._rt/PhysConst::ep0);
-    }
+    m_poisson_beta = beta;
+    m_poisson_ba = boxArray();
+    m_poisson_dm = dmap;
 }
 #endif
 
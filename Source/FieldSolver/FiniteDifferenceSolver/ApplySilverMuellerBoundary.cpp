@@ -7,7 +7,7 @@
 
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "FiniteDifferenceSolver.H"
-#include "Utils/WarpXConst.H"
+#include "SilverMuellerBoundary.H"
 #include <AMReX_Gpu.H>
 
 using namespace amrex;
@@ -30,21 +30,8 @@ void FiniteDifferenceSolver::ApplySilverMuellerBoundary (
         amrex::Abort("The Silver-Mueller boundary conditions can only be used with the Yee solver.");
     }
 
-    // Ensure that we are using the cells the domain
-    domain_box.enclosedCells();
-
     // Calculate relevant coefficients
-    amrex::Real const cdt_over_dx = PhysConst::c*dt*m_stencil_coefs_x[0];
-    amrex::Real const coef1_x = (1._rt - cdt_over_dx)/(1._rt + cdt_over_dx);
-    amrex::Real const coef2_x = 2._rt*cdt_over_dx/(1._rt + cdt_over_dx) / PhysConst::c;
-#ifdef WARPX_DIM_3D
-    amrex::Real const cdt_over_dy = PhysConst::c*dt*m_stencil_coefs_y[0];
-    amrex::Real const coef1_y = (1._rt - cdt_over_dy)/(1._rt + cdt_over_dx);
-    amrex::Real const coef2_y = 2._rt*cdt_over_dy/(1._rt + cdt_over_dy) / PhysConst::c;
-#endif
-    amrex::Real const cdt_over_dz = PhysConst::c*dt*m_stencil_coefs_z[0];
-    amrex::Real const coef1_z = (1._rt - cdt_over_dz)/(1._rt + cdt_over_dx);
-    amrex::Real const coef2_z = 2._rt*cdt_over_dz/(1._rt + cdt_over_dz) / PhysConst::c;
+    SilverMuellerBoundary const sm = GetSilverMuellerBoundary(domain_box, dt);
 
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
@@ -80,76 +67,34 @@ void FiniteDifferenceSolver::ApplySilverMuellerBoundary (
 
             // Apply Boundary condition to Bx
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
-
-#ifdef WARPX_DIM_3D
-                // At the +y boundary (innermost guard cell)
-                if ( j==domain_box.bigEnd(1)+1 )
-                    Bx(i,j,k) = coef1_y * Bx(i,j,k) + coef2_y * Ez(i,j,k);
-                // At the -y boundary (innermost guard cell)
-                if ( j==domain_box.smallEnd(1)-1 )
-                    Bx(i,j,k) = coef1_y * Bx(i,j,k) - coef2_y * Ez(i,j+1,k);
-                // At the +z boundary (innermost guard cell)
-                if ( k==domain_box.bigEnd(2)+1 )
-                    Bx(i,j,k) = coef1_z * Bx(i,j,k) - coef2_z * Ey(i,j,k);
-                // At the -z boundary (innermost guard cell)
-                if ( k==domain_box.smallEnd(2)-1 )
-                    Bx(i,j,k) = coef1_z * Bx(i,j,k) + coef2_z * Ey(i,j,k+1);
-#elif WARPX_DIM_XZ
-                // At the +z boundary (innermost guard cell)
-                if ( j==domain_box.bigEnd(1)+1 )
-                    Bx(i,j,k) = coef1_z * Bx(i,j,k) - coef2_z * Ey(i,j,k);
-                // At the -z boundary (innermost guard cell)
-                if ( j==domain_box.smallEnd(1)-1 )
-                    Bx(i,j,k) = coef1_z * Bx(i,j,k) + coef2_z * Ey(i,j+1,k);
-#endif
+                sm.UpdateBx(Bx, Ey, Ez, i, j, k);
             },
 
             // Apply Boundary condition to By
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
-
-                // At the +x boundary (innermost guard cell)
-                if ( i==domain_box.bigEnd(0)+1 )
-                    By(i,j,k) = coef1_x * By(i,j,k) - coef2_x * Ez(i,j,k);
-                // At the -x boundary (innermost guard cell)
-                if ( i==domain_box.smallEnd(0)-1 )
-                    By(i,j,k) = coef1_x * By(i,j,k) + coef2_x * Ez(i+1,j,k);
-#ifdef WARPX_DIM_3D
-                // At the +z boundary (innermost guard cell)
-                if ( k==domain_box.bigEnd(2)+1 )
-                    By(i,j,k) = coef1_z * By(i,j,k) + coef2_z * Ex(i,j,k);
-                // At the -z boundary (innermost guard cell)
-                if ( k==domain_box.smallEnd(2)-1 )
-                    By(i,j,k) = coef1_z * By(i,j,k) - coef2_z * Ex(i,j,k+1);
-#elif WARPX_DIM_XZ
-                // At the +z boundary (innermost guard cell)
-                if ( j==domain_box.bigEnd(1)+1 )
-                    By(i,j,k) = coef1_z * By(i,j,k) + coef2_z * Ex(i,j,k);
-                // At the -z boundary (innermost guard cell)
-                if ( j==domain_box.smallEnd(1)-1 )
-                    By(i,j,k) = coef1_z * By(i,j,k) - coef2_z * Ex(i,j+1,k);
-#endif
+                sm.UpdateBy(By, Ex, Ez, i, j, k);
             },
 
             // Apply Boundary condition to Bz
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
-
-                // At the +x boundary (innermost guard cell)
-                if ( i==domain_box.bigEnd(0)+1 )
-                    Bz(i,j,k) = coef1_x * Bz(i,j,k) + coef2_x * Ey(i,j,k);
-                // At the -x boundary (innermost guard cell)
-                if ( i==domain_box.smallEnd(0)-1 )
-                    Bz(i,j,k) = coef1_x * Bz(i,j,k) - coef2_x * Ey(i+1,j,k);
-#ifdef WARPX_DIM_3D
-                // At the +y boundary (innermost guard cell)
-                if ( j==domain_box.bigEnd(1)+1 )
-                    Bz(i,j,k) = coef1_y * Bz(i,j,k) - coef2_y * Ex(i,j,k);
-                // At the -y boundary (innermost guard cell)
-                if ( j==domain_box.smallEnd(1)-1 )
-                    Bz(i,j,k) = coef1_y * Bz(i,j,k) + coef2_y * Ex(i,j+1,k);
-#endif
+                sm.UpdateBz(Bz, Ex, Ey, i, j, k);
             }
         );
 
     }
 #endif // WARPX_DIM_RZ
 }
+
+SilverMuellerBoundary FiniteDifferenceSolver::GetSilverMuellerBoundary (
+    amrex::Box const& domain_box,
+    amrex::Real const dt ) const {
+
+#ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(domain_box, dt);
+    amrex::Abort("The Silver-Mueller boundary conditions cannot be used in RZ geometry.");
+    return SilverMuellerBoundary();
+#else
+    return SilverMuellerBoundary(domain_box, dt, m_stencil_coefs_x[0],
+                                 m_stencil_coefs_y[0], m_stencil_coefs_z[0]);
+#endif
+}
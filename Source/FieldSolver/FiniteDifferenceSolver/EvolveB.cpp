@@ -7,7 +7,12 @@
 
 #include "WarpX.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/HardwareCounters.H"
+#include "Utils/WarpXConst.H"
 #include "FiniteDifferenceSolver.H"
+#include "FusedBoxParallelFor.H"
+#include "StencilParallelFor.H"
 #ifdef WARPX_DIM_RZ
 #   include "FiniteDifferenceAlgorithms/CylindricalYeeAlgorithm.H"
 #else
@@ -25,7 +30,28 @@ using namespace amrex;
 void FiniteDifferenceSolver::EvolveB (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Bfield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
-    int lev, amrex::Real const dt ) {
+    int lev, amrex::Real const dt,
+    SilverMuellerBoundary const* silver_mueller ) {
+
+    HardwareCounterRegion counters("EvolveB");
+
+    if (silver_mueller) {
+#ifdef WARPX_DIM_RZ
+        amrex::Abort("The Silver-Mueller boundary conditions cannot be used in RZ geometry.");
+#else
+        // Ensure that we are using the Yee solver
+        if (m_fdtd_algo != MaxwellSolverAlgo::Yee) {
+            amrex::Abort("The Silver-Mueller boundary conditions can only be used with the Yee solver.");
+        }
+        // Update B and apply the boundary condition in the same kernels
+        if (m_do_nodal) {
+            EvolveBCartesian <CartesianNodalAlgorithm, true> ( Bfield, Efield, lev, dt, *silver_mueller );
+        } else {
+            EvolveBCartesian <CartesianYeeAlgorithm, true> ( Bfield, Efield, lev, dt, *silver_mueller );
+        }
+        return;
+#endif
+    }
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
@@ -54,75 +80,203 @@ void FiniteDifferenceSolver::EvolveB (
 
 }
 
+/**
+ * \brief Update the B and F fields, over one timestep, in the same sweeps over the boxes
+ */
+void FiniteDifferenceSolver::EvolveBF (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Bfield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
+    std::unique_ptr<amrex::MultiFab>& Ffield,
+    std::unique_ptr<amrex::MultiFab> const& rhofield,
+    int const rhocomp,
+    int lev, amrex::Real const dt,
+    SilverMuellerBoundary const* silver_mueller ) {
+
+#ifdef WARPX_DIM_RZ
+    // the cylindrical updates are not fused
+    EvolveF( Ffield, Efield, rhofield, rhocomp, dt );
+    EvolveB( Bfield, Efield, lev, dt, silver_mueller );
+#else
+    HardwareCounterRegion counters("EvolveBF");
+
+    if (silver_mueller) {
+        // Ensure that we are using the Yee solver
+        if (m_fdtd_algo != MaxwellSolverAlgo::Yee) {
+            amrex::Abort("The Silver-Mueller boundary conditions can only be used with the Yee solver.");
+        }
+        if (m_do_nodal) {
+            EvolveBCartesian <CartesianNodalAlgorithm, true> ( Bfield, Efield, lev, dt, *silver_mueller,
+                                                               Ffield.get(), rhofield.get(), rhocomp );
+        } else {
+            EvolveBCartesian <CartesianYeeAlgorithm, true> ( Bfield, Efield, lev, dt, *silver_mueller,
+                                                             Ffield.get(), rhofield.get(), rhocomp );
+        }
+        return;
+    }
+
+    // Select algorithm (The choice of algorithm is a runtime option,
+    // but we compile code for each algorithm, using templates)
+    if (m_do_nodal) {
+
+        EvolveBCartesian <CartesianNodalAlgorithm> ( Bfield, Efield, lev, dt, SilverMuellerBoundary(),
+                                                     Ffield.get(), rhofield.get(), rhocomp );
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
+
+        EvolveBCartesian <CartesianYeeAlgorithm> ( Bfield, Efield, lev, dt, SilverMuellerBoundary(),
+                                                   Ffield.get(), rhofield.get(), rhocomp );
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
+
+        EvolveBCartesian <CartesianCKCAlgorithm> ( Bfield, Efield, lev, dt, SilverMuellerBoundary(),
+                                                   Ffield.get(), rhofield.get(), rhocomp );
+
+    } else {
+        amrex::Abort("EvolveBF: Unknown algorithm");
+    }
+#endif
+}
+
 
 #ifndef WARPX_DIM_RZ
 
-template<typename T_Algo>
+template<typename T_Algo, bool do_silver_mueller>
 void FiniteDifferenceSolver::EvolveBCartesian (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Bfield,
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Efield,
-    int lev, amrex::Real const dt ) {
+    int lev, amrex::Real const dt,
+    SilverMuellerBoundary const& silver_mueller,
+    amrex::MultiFab* const Ffield,
+    amrex::MultiFab* const rhofield,
+    int const rhocomp ) {
 
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
+    // Extract stencil coefficients
+    Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+    int const n_coefs_x = m_stencil_coefs_x.size();
+    Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+    int const n_coefs_y = m_stencil_coefs_y.size();
+    Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+    int const n_coefs_z = m_stencil_coefs_z.size();
+
+    // With the Silver-Mueller boundary condition, the boxes that touch the boundary of the domain
+    // are grown by one guard cell there: these cells, outside of the domain of each component,
+    // are updated with the boundary condition instead of the Maxwell equations
+    SilverMuellerBoundary const sm = silver_mueller;
+    Box const domain_x = amrex::convert(sm.domain_box, Bfield[0]->ixType());
+    Box const domain_y = amrex::convert(sm.domain_box, Bfield[1]->ixType());
+    Box const domain_z = amrex::convert(sm.domain_box, Bfield[2]->ixType());
+
+    // Update of the fields at (i,j,k), from the arrays a = {Bx, By, Bz, Ex, Ey, Ez} of a box
+    auto const update_Bx = [=] AMREX_GPU_DEVICE (FusedArrays<6> const& a, int i, int j, int k){
+        if (do_silver_mueller && !domain_x.contains(IntVect(AMREX_D_DECL(i, j, k)))) {
+            sm.UpdateBx(a.a[0], a.a[4], a.a[5], i, j, k);
+            return;
+        }
+        a.a[0](i, j, k) += dt * T_Algo::UpwardDz(a.a[4], coefs_z, n_coefs_z, i, j, k)
+                         - dt * T_Algo::UpwardDy(a.a[5], coefs_y, n_coefs_y, i, j, k);
+    };
+    auto const update_By = [=] AMREX_GPU_DEVICE (FusedArrays<6> const& a, int i, int j, int k){
+        if (do_silver_mueller && !domain_y.contains(IntVect(AMREX_D_DECL(i, j, k)))) {
+            sm.UpdateBy(a.a[1], a.a[3], a.a[5], i, j, k);
+            return;
+        }
+        a.a[1](i, j, k) += dt * T_Algo::UpwardDx(a.a[5], coefs_x, n_coefs_x, i, j, k)
+                         - dt * T_Algo::UpwardDz(a.a[3], coefs_z, n_coefs_z, i, j, k);
+    };
+    auto const update_Bz = [=] AMREX_GPU_DEVICE (FusedArrays<6> const& a, int i, int j, int k){
+        if (do_silver_mueller && !domain_z.contains(IntVect(AMREX_D_DECL(i, j, k)))) {
+            sm.UpdateBz(a.a[2], a.a[3], a.a[4], i, j, k);
+            return;
+        }
+        a.a[2](i, j, k) += dt * T_Algo::UpwardDy(a.a[3], coefs_y, n_coefs_y, i, j, k)
+                         - dt * T_Algo::UpwardDx(a.a[4], coefs_x, n_coefs_x, i, j, k);
+    };
+
+    // Update of F at (i,j,k) with divergence cleaning (see EvolveFCartesian),
+    // from the arrays a = {F, rho, Ex, Ey, Ez} of a box
+    Real constexpr inv_epsilon0 = 1._rt/PhysConst::ep0;
+    auto const update_F = [=] AMREX_GPU_DEVICE (FusedArrays<5> const& a, int i, int j, int k){
+        a.a[0](i, j, k) += dt * (
+            - a.a[1](i, j, k, rhocomp) * inv_epsilon0
+            + T_Algo::DownwardDx(a.a[2], coefs_x, n_coefs_x, i, j, k)
+            + T_Algo::DownwardDy(a.a[3], coefs_y, n_coefs_y, i, j, k)
+            + T_Algo::DownwardDz(a.a[4], coefs_z, n_coefs_z, i, j, k) );
+    };
+
+#ifdef AMREX_USE_GPU
+    // Update all the boxes with one kernel launch per component (the cost of
+    // each box can only be measured when the boxes are updated separately)
+    if (amrex::Gpu::inLaunchRegion() &&
+        !(cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers))
+    {
+        FusedBoxTable<6>& fused = do_silver_mueller ? m_fused_B_silver_mueller : m_fused_B;
+        fused.Update({Bfield[0].get(), Bfield[1].get(), Bfield[2].get(),
+                      Efield[0].get(), Efield[1].get(), Efield[2].get()},
+                     {Bfield[0]->ixType().toIntVect(), Bfield[1]->ixType().toIntVect(),
+                      Bfield[2]->ixType().toIntVect()},
+                     getEBBoxTypes(), EBBoxType::Covered,
+                     do_silver_mueller ? sm.domain_box : Box());
+        fused.ParallelFor(0, update_Bx);
+        fused.ParallelFor(1, update_By);
+        fused.ParallelFor(2, update_Bz);
+        if (Ffield) {
+            // F is also updated in the boxes covered by the embedded boundary
+            IntVect const f_type = Ffield->ixType().toIntVect();
+            m_fused_F.Update({Ffield, rhofield, Efield[0].get(), Efield[1].get(), Efield[2].get()},
+                             {f_type, f_type, f_type});
+            m_fused_F.ParallelFor(0, update_F);
+        }
+        return;
+    }
+#endif
+
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
     for ( MFIter mfi(*Bfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
-
-        // Extract field data for this grid/tile
-        Array4<Real> const& Bx = Bfield[0]->array(mfi);
-        Array4<Real> const& By = Bfield[1]->array(mfi);
-        Array4<Real> const& Bz = Bfield[2]->array(mfi);
-        Array4<Real> const& Ex = Efield[0]->array(mfi);
-        Array4<Real> const& Ey = Efield[1]->array(mfi);
-        Array4<Real> const& Ez = Efield[2]->array(mfi);
-
-        // Extract stencil coefficients
-        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
-        int const n_coefs_x = m_stencil_coefs_x.size();
-        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
-        int const n_coefs_y = m_stencil_coefs_y.size();
-        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
-        int const n_coefs_z = m_stencil_coefs_z.size();
-
-        // Extract tileboxes for which to loop
-        Box const& tbx  = mfi.tilebox(Bfield[0]->ixType().toIntVect());
-        Box const& tby  = mfi.tilebox(Bfield[1]->ixType().toIntVect());
-        Box const& tbz  = mfi.tilebox(Bfield[2]->ixType().toIntVect());
-
-        // Loop over the cells and update the fields
-        amrex::ParallelFor(tbx, tby, tbz,
-
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                Bx(i, j, k) += dt * T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
-                             - dt * T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k);
-            },
-
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                By(i, j, k) += dt * T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
-                             - dt * T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k);
-            },
-
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                Bz(i, j, k) += dt * T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
-                             - dt * T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k);
+        // B is not updated in the boxes covered by the embedded boundary (F is)
+        bool const covered = (getEBBoxType(mfi) == EBBoxType::Covered);
+        if (covered && !Ffield) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
+        WARPX_PROFILE_RANGE("FiniteDifferenceSolver::EvolveB box " + std::to_string(mfi.index()));
+
+        if (!covered) {
+            // Extract field data for this grid/tile
+            FusedArrays<6> const a {{Bfield[0]->array(mfi), Bfield[1]->array(mfi), Bfield[2]->array(mfi),
+                                     Efield[0]->array(mfi), Efield[1]->array(mfi), Efield[2]->array(mfi)}};
+
+            // Extract tileboxes for which to loop
+            Box tbx  = mfi.tilebox(Bfield[0]->ixType().toIntVect());
+            Box tby  = mfi.tilebox(Bfield[1]->ixType().toIntVect());
+            Box tbz  = mfi.tilebox(Bfield[2]->ixType().toIntVect());
+            if (do_silver_mueller) {
+                // grown only outside of the domain, so that the tiles do not overlap
+                tbx = GrowAtDomainBoundary(tbx, sm.domain_box);
+                tby = GrowAtDomainBoundary(tby, sm.domain_box);
+                tbz = GrowAtDomainBoundary(tbz, sm.domain_box);
             }
 
-        );
+            // Loop over the cells and update the fields
+            StencilParallelFor(tbx, tby, tbz,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Bx(a, i, j, k); },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_By(a, i, j, k); },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Bz(a, i, j, k); }
+            );
+        }
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
+        // Update F on the same tile, while E is in cache
+        if (Ffield) {
+            FusedArrays<5> const af {{Ffield->array(mfi), rhofield->array(mfi),
+                                      Efield[0]->array(mfi), Efield[1]->array(mfi), Efield[2]->array(mfi)}};
+            Box const& tf = mfi.tilebox(Ffield->ixType().toIntVect());
+            StencilParallelFor(tf,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_F(af, i, j, k); });
         }
+
+        box_timer.stop();
     }
 }
 
@@ -141,11 +295,9 @@ void FiniteDifferenceSolver::EvolveBCylindrical (
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
     for ( MFIter mfi(*Bfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
 
         // Extract field data for this grid/tile
         Array4<Real> const& Br = Bfield[0]->array(mfi);
@@ -234,12 +386,7 @@ void FiniteDifferenceSolver::EvolveBCylindrical (
 
         );
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+        box_timer.stop();
     }
 }
 
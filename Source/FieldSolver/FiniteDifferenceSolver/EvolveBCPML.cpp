@@ -0,0 +1,130 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#ifndef WARPX_DIM_RZ
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
+#endif
+#include "BoundaryConditions/CPMLKernels.H"
+#include "BoundaryConditions/PML.H"
+#include <AMReX_Gpu.H>
+#include <AMReX.H>
+
+using namespace amrex;
+
+/**
+ * \brief Update the B field in the convolutional PML, over one timestep
+ */
+void FiniteDifferenceSolver::EvolveBCPML (
+    std::array< amrex::MultiFab*, 3 > Bfield,
+    std::array< amrex::MultiFab*, 3 > const Efield,
+    CPMLMemory const& psi_B,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt ) {
+
+   // Select algorithm (The choice of algorithm is a runtime option,
+   // but we compile code for each algorithm, using templates)
+#ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(Bfield, Efield, psi_B, sigba, dt);
+    amrex::Abort("PML are not implemented in cylindrical geometry.");
+#else
+    if (m_do_nodal) {
+
+        amrex::Abort("EvolveBCPML: the convolutional PML is not implemented with the nodal solver");
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
+
+        EvolveBCPMLCartesian <CartesianYeeAlgorithm> (Bfield, Efield, psi_B, sigba, dt);
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
+
+        EvolveBCPMLCartesian <CartesianCKCAlgorithm> (Bfield, Efield, psi_B, sigba, dt);
+
+    } else {
+        amrex::Abort("EvolveBCPML: Unknown algorithm");
+    }
+#endif
+}
+
+
+#ifndef WARPX_DIM_RZ
+
+template<typename T_Algo>
+void FiniteDifferenceSolver::EvolveBCPMLCartesian (
+    std::array< amrex::MultiFab*, 3 > Bfield,
+    std::array< amrex::MultiFab*, 3 > const Efield,
+    CPMLMemory const& psi_B,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt ) {
+
+    // Loop through the grids, and over the tiles within each grid
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( MFIter mfi(*Bfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+
+        // Extract field data for this grid/tile
+        Array4<Real> const& Bx = Bfield[0]->array(mfi);
+        Array4<Real> const& By = Bfield[1]->array(mfi);
+        Array4<Real> const& Bz = Bfield[2]->array(mfi);
+        Array4<Real> const& Ex = Efield[0]->array(mfi);
+        Array4<Real> const& Ey = Efield[1]->array(mfi);
+        Array4<Real> const& Ez = Efield[2]->array(mfi);
+
+        // Memory variables and damping profiles of this box, for the damping factors of dt
+        // (the components of B are cell-centered along their transverse directions)
+        CPMLBoxData const cpml = psi_B.BoxData(sigba[mfi], mfi.index(), true, dt);
+
+        // Extract stencil coefficients
+        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+        int const n_coefs_x = m_stencil_coefs_x.size();
+        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+        int const n_coefs_y = m_stencil_coefs_y.size();
+        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+        int const n_coefs_z = m_stencil_coefs_z.size();
+
+        // Extract tileboxes for which to loop
+        Box const& tbx  = mfi.tilebox(Bfield[0]->ixType().ixType());
+        Box const& tby  = mfi.tilebox(Bfield[1]->ixType().ixType());
+        Box const& tbz  = mfi.tilebox(Bfield[2]->ixType().ixType());
+
+        // Loop over the cells and update the fields
+        amrex::ParallelFor(tbx, tby, tbz,
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dz_Ey = warpx_cpml_derivative(i, j, k, 2, 0,
+                    T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k), cpml);
+                Real const dy_Ez = warpx_cpml_derivative(i, j, k, 1, 0,
+                    T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k), cpml);
+                Bx(i, j, k) += dt * (dz_Ey - dy_Ez);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dx_Ez = warpx_cpml_derivative(i, j, k, 0, 1,
+                    T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k), cpml);
+                Real const dz_Ex = warpx_cpml_derivative(i, j, k, 2, 1,
+                    T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k), cpml);
+                By(i, j, k) += dt * (dx_Ez - dz_Ex);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dy_Ex = warpx_cpml_derivative(i, j, k, 1, 2,
+                    T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k), cpml);
+                Real const dx_Ey = warpx_cpml_derivative(i, j, k, 0, 2,
+                    T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k), cpml);
+                Bz(i, j, k) += dt * (dy_Ex - dx_Ey);
+            }
+
+        );
+
+    }
+
+}
+
+#endif // corresponds to ifndef WARPX_DIM_RZ
@@ -0,0 +1,275 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "WarpX.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/CoarsenIO.H"
+#include "FiniteDifferenceSolver.H"
+#include "StencilParallelFor.H"
+#ifndef WARPX_DIM_RZ
+#   include "FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
+#   include "FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
+#   include "FiniteDifferenceAlgorithms/FieldAccessorFunctors.H"
+#endif
+#include <AMReX_Gpu.H>
+
+using namespace amrex;
+
+#ifndef WARPX_MAG_LLG
+
+/**
+ * \brief Update B over dt/2, E over dt and B over dt/2 in a single sweep (algo.fused_fdtd = 1)
+ */
+void FiniteDifferenceSolver::EvolveBEFused (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Bfield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
+    int lev, amrex::Real const dt,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties ) {
+
+#ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(Bfield, Efield, Jfield, lev, dt, macroscopic_properties);
+    amrex::Abort("EvolveBEFused: algo.fused_fdtd = 1 is not implemented in RZ geometry");
+#else
+    bool const macroscopic = (WarpX::em_solver_medium == MediumForEM::Macroscopic);
+    bool const backward_euler = (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler);
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(getEBBoxTypes() == nullptr,
+        "EvolveBEFused: algo.fused_fdtd = 1 does not work with an embedded boundary");
+
+    if (m_do_nodal) {
+        amrex::Abort("EvolveBEFused: algo.fused_fdtd = 1 does not work for nodal");
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
+
+        if (macroscopic && backward_euler) {
+            EvolveBEFusedCartesian <CartesianYeeAlgorithm, BackwardEulerAlgo>
+                ( Bfield, Efield, Jfield, lev, dt, macroscopic_properties );
+        } else {
+            EvolveBEFusedCartesian <CartesianYeeAlgorithm, LaxWendroffAlgo>
+                ( Bfield, Efield, Jfield, lev, dt, macroscopic_properties );
+        }
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
+
+        if (macroscopic && backward_euler) {
+            EvolveBEFusedCartesian <CartesianCKCAlgorithm, BackwardEulerAlgo>
+                ( Bfield, Efield, Jfield, lev, dt, macroscopic_properties );
+        } else {
+            EvolveBEFusedCartesian <CartesianCKCAlgorithm, LaxWendroffAlgo>
+                ( Bfield, Efield, Jfield, lev, dt, macroscopic_properties );
+        }
+
+    } else {
+        amrex::Abort("EvolveBEFused: Unknown algorithm");
+    }
+#endif
+}
+
+
+#ifndef WARPX_DIM_RZ
+
+/**
+ * The three updates B^{n+1/2} = B^n - dt/2 curl E^n, E^{n+1} (as in EvolveE or MacroscopicEvolveE)
+ * and B^{n+1} = B^{n+1/2} - dt/2 curl E^{n+1} are done box by box, so that the box stays in
+ * cache between the updates if it is small enough (amr.max_grid_size). The first update of B is
+ * done on the box grown by FusedHalo-1 cells and the update of E on the box grown by FusedHalo-2
+ * cells, in place in the guard cells of the box, so that E and B are only exchanged once per time
+ * step, with FusedHalo guard cells. The guard cells of B and E are left at intermediate times and
+ * must be exchanged after this function. The grown boxes are clipped to the domain in the
+ * non-periodic directions, where the guard cells are not updated, as in EvolveB and EvolveE.
+ */
+template<typename T_Algo, typename T_MacroAlgo>
+void FiniteDifferenceSolver::EvolveBEFusedCartesian (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Bfield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield,
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
+    int lev, amrex::Real const dt,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties ) {
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+    Geometry const& geom = WarpX::GetInstance().Geom(lev);
+    bool const macroscopic = (WarpX::em_solver_medium == MediumForEM::Macroscopic);
+    Real constexpr c2 = PhysConst::c * PhysConst::c;
+    Real const half_dt = 0.5_rt * dt;
+
+    int constexpr ngE = FusedHalo;
+    int constexpr ngB = FusedHalo - 1;
+    for (int idim = 0; idim < 3; ++idim) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(Efield[idim]->nGrowVect().allGE(IntVect(ngE)) && Bfield[idim]->nGrowVect().allGE(IntVect(ngB))
+                                         && Jfield[idim]->nGrowVect().allGE(IntVect(1)),
+            "EvolveBEFused: not enough guard cells of E, B or J for algo.fused_fdtd = 1");
+    }
+
+    // Index types required for calling CoarsenIO::Interp to interpolate the macroscopic
+    // properties from their respective staggering to the Ex, Ey, Ez locations
+    amrex::GpuArray<int, 3> sigma_stag{0, 0, 0};
+    amrex::GpuArray<int, 3> epsilon_stag{0, 0, 0};
+    amrex::GpuArray<int, 3> macro_cr{1, 1, 1};
+    std::array<amrex::GpuArray<int, 3>, 3> edge_stag{};
+    if (macroscopic) {
+        sigma_stag = macroscopic_properties->sigma_IndexType;
+        epsilon_stag = macroscopic_properties->epsilon_IndexType;
+        macro_cr = macroscopic_properties->macro_cr_ratio;
+        edge_stag = {macroscopic_properties->Ex_IndexType, macroscopic_properties->Ey_IndexType,
+                     macroscopic_properties->Ez_IndexType};
+    }
+
+    // box grown by ng in all directions, clipped to the domain in the non-periodic directions
+    auto grow_in_domain = [&geom] (Box const& bx, int const ng) {
+        Box domain = amrex::convert(geom.Domain(), bx.ixType());
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (geom.isPeriodic(idim)) domain.grow(idim, ng);
+        }
+        return amrex::grow(bx, ng) & domain;
+    };
+
+    // Loop through the grids, without tiling since the halo of a tile would overlap the neighbouring tiles
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( MFIter mfi(*Bfield[0]); mfi.isValid(); ++mfi ) {
+        BoxCostTimer box_timer(cost, mfi.index());
+
+        // Extract the boxes of the six components
+        std::array<Box, 3> tb, te;
+        for (int idim = 0; idim < 3; ++idim) {
+            tb[idim] = mfi.tilebox(Bfield[idim]->ixType().toIntVect());
+            te[idim] = mfi.tilebox(Efield[idim]->ixType().toIntVect());
+        }
+
+        // Extract field data for this grid
+        Array4<Real> const& Bx = Bfield[0]->array(mfi);
+        Array4<Real> const& By = Bfield[1]->array(mfi);
+        Array4<Real> const& Bz = Bfield[2]->array(mfi);
+        Array4<Real> const& Ex = Efield[0]->array(mfi);
+        Array4<Real> const& Ey = Efield[1]->array(mfi);
+        Array4<Real> const& Ez = Efield[2]->array(mfi);
+        Array4<Real> const& jx = Jfield[0]->array(mfi);
+        Array4<Real> const& jy = Jfield[1]->array(mfi);
+        Array4<Real> const& jz = Jfield[2]->array(mfi);
+
+        // Extract stencil coefficients
+        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+        int const n_coefs_x = m_stencil_coefs_x.size();
+        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+        int const n_coefs_y = m_stencil_coefs_y.size();
+        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+        int const n_coefs_z = m_stencil_coefs_z.size();
+
+        // B^{n+1/2} on the box grown by ngB, E^{n+1} on the box grown by ngE-2, and B^{n+1} on the box
+        for (int substep = 0; substep < 3; ++substep) {
+
+            if (substep == 1) {
+                Box const tex = grow_in_domain(te[0], ngE - 2);
+                Box const tey = grow_in_domain(te[1], ngE - 2);
+                Box const tez = grow_in_domain(te[2], ngE - 2);
+                if (!macroscopic) {
+                    StencilParallelFor(tex, tey, tez,
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                            Ex(i, j, k) += c2 * dt * (
+                                - T_Algo::DownwardDz(By, coefs_z, n_coefs_z, i, j, k)
+                                + T_Algo::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k)
+                                - PhysConst::mu0 * jx(i, j, k) );
+                        },
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                            Ey(i, j, k) += c2 * dt * (
+                                - T_Algo::DownwardDx(Bz, coefs_x, n_coefs_x, i, j, k)
+                                + T_Algo::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k)
+                                - PhysConst::mu0 * jy(i, j, k) );
+                        },
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                            Ez(i, j, k) += c2 * dt * (
+                                - T_Algo::DownwardDy(Bx, coefs_y, n_coefs_y, i, j, k)
+                                + T_Algo::DownwardDx(By, coefs_x, n_coefs_x, i, j, k)
+                                - PhysConst::mu0 * jz(i, j, k) );
+                        }
+                    );
+                } else {
+                    // The uniform-box and precomputed-coefficient variants of MacroscopicEvolveE are not used,
+                    // since the material properties are only classified and the coefficients only stored on
+                    // the valid edges, while E is updated here on the halo too
+                    MacroPropertyArray const sigma_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::sigma);
+                    MacroPropertyArray const eps_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::epsilon);
+                    MacroPropertyArray const mu_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::mu);
+                    FieldAccessorMacroscopic<MacroPropertyArray> const Hx(Bx, mu_arr);
+                    FieldAccessorMacroscopic<MacroPropertyArray> const Hy(By, mu_arr);
+                    FieldAccessorMacroscopic<MacroPropertyArray> const Hz(Bz, mu_arr);
+                    amrex::GpuArray<int, 3> const Ex_stag = edge_stag[0];
+                    amrex::GpuArray<int, 3> const Ey_stag = edge_stag[1];
+                    amrex::GpuArray<int, 3> const Ez_stag = edge_stag[2];
+                    const int scomp = 0;
+                    StencilParallelFor(tex, tey, tez,
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                            amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
+                                                       Ex_stag, macro_cr, i, j, k, scomp);
+                            amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
+                                                       Ex_stag, macro_cr, i, j, k, scomp);
+                            amrex::Real const alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                            amrex::Real const beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+                            Ex(i, j, k) = alpha * Ex(i, j, k)
+                                        + beta * ( - T_Algo::DownwardDz(Hy, coefs_z, n_coefs_z, i, j, k,0)
+                                                   + T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k,0)
+                                                 ) - beta * jx(i, j, k);
+                        },
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                            amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
+                                                       Ey_stag, macro_cr, i, j, k, scomp);
+                            amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
+                                                       Ey_stag, macro_cr, i, j, k, scomp);
+                            amrex::Real const alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                            amrex::Real const beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+                            Ey(i, j, k) = alpha * Ey(i, j, k)
+                                        + beta * ( - T_Algo::DownwardDx(Hz, coefs_x, n_coefs_x, i, j, k,0)
+                                                   + T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k,0)
+                                                 ) - beta * jy(i, j, k);
+                        },
+                        [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                            amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
+                                                       Ez_stag, macro_cr, i, j, k, scomp);
+                            amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
+                                                       Ez_stag, macro_cr, i, j, k, scomp);
+                            amrex::Real const alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                            amrex::Real const beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+                            Ez(i, j, k) = alpha * Ez(i, j, k)
+                                        + beta * ( - T_Algo::DownwardDy(Hx, coefs_y, n_coefs_y, i, j, k,0)
+                                                   + T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k,0)
+                                                 ) - beta * jz(i, j, k);
+                        }
+                    );
+                }
+                continue;
+            }
+
+            Box const bx = grow_in_domain(tb[0], (substep == 0) ? ngB : 0);
+            Box const by = grow_in_domain(tb[1], (substep == 0) ? ngB : 0);
+            Box const bz = grow_in_domain(tb[2], (substep == 0) ? ngB : 0);
+            StencilParallelFor(bx, by, bz,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    Bx(i, j, k) += half_dt * T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
+                                 - half_dt * T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    By(i, j, k) += half_dt * T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
+                                 - half_dt * T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    Bz(i, j, k) += half_dt * T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
+                                 - half_dt * T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k);
+                }
+            );
+        }
+
+        box_timer.stop();
+    }
+}
+
+#endif // corresponds to ifndef WARPX_DIM_RZ
+
+#endif // corresponds to ifndef WARPX_MAG_LLG
@@ -27,25 +27,26 @@ void FiniteDifferenceSolver::EvolveBPML (
     std::array< amrex::MultiFab*, 3 > Bfield,
     std::array< amrex::MultiFab*, 3 > const Efield,
     amrex::Real const dt,
-    const bool dive_cleaning) {
+    const bool dive_cleaning,
+    amrex::MultiFab* const Ffield ) {
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
-    amrex::ignore_unused(Bfield, Efield, dt, dive_cleaning);
+    amrex::ignore_unused(Bfield, Efield, dt, dive_cleaning, Ffield);
     amrex::Abort("PML are not implemented in cylindrical geometry.");
 #else
     if (m_do_nodal) {
 
-        EvolveBPMLCartesian <CartesianNodalAlgorithm> (Bfield, Efield, dt, dive_cleaning);
+        EvolveBPMLCartesian <CartesianNodalAlgorithm> (Bfield, Efield, dt, dive_cleaning, Ffield);
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
 
-        EvolveBPMLCartesian <CartesianYeeAlgorithm> (Bfield, Efield, dt, dive_cleaning);
+        EvolveBPMLCartesian <CartesianYeeAlgorithm> (Bfield, Efield, dt, dive_cleaning, Ffield);
 
     } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
 
-        EvolveBPMLCartesian <CartesianCKCAlgorithm> (Bfield, Efield, dt, dive_cleaning);
+        EvolveBPMLCartesian <CartesianCKCAlgorithm> (Bfield, Efield, dt, dive_cleaning, Ffield);
 
     } else {
         amrex::Abort("EvolveBPML: Unknown algorithm");
@@ -61,7 +62,8 @@ void FiniteDifferenceSolver::EvolveBPMLCartesian (
     std::array< amrex::MultiFab*, 3 > Bfield,
     std::array< amrex::MultiFab*, 3 > const Efield,
     amrex::Real const dt,
-    const bool dive_cleaning) {
+    const bool dive_cleaning,
+    amrex::MultiFab* const Ffield ) {
 
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
@@ -158,6 +160,35 @@ void FiniteDifferenceSolver::EvolveBPMLCartesian (
 
         );
 
+        // Update F on the same tile, while E is in cache (see EvolveFPMLCartesian)
+        if (Ffield) {
+            Array4<Real> const& F = Ffield->array(mfi);
+            Box const& tf  = mfi.tilebox(Ffield->ixType().ixType());
+
+            amrex::ParallelFor(tf,
+
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+
+                    F(i, j, k, PMLComp::x) += dt * (
+                          T_Algo::DownwardDx(Ex, coefs_x, n_coefs_x, i, j, k, PMLComp::xx)
+                        + T_Algo::DownwardDx(Ex, coefs_x, n_coefs_x, i, j, k, PMLComp::xy)
+                        + T_Algo::DownwardDx(Ex, coefs_x, n_coefs_x, i, j, k, PMLComp::xz) );
+
+                    F(i, j, k, PMLComp::y) += dt * (
+                          T_Algo::DownwardDy(Ey, coefs_y, n_coefs_y, i, j, k, PMLComp::yx)
+                        + T_Algo::DownwardDy(Ey, coefs_y, n_coefs_y, i, j, k, PMLComp::yy)
+                        + T_Algo::DownwardDy(Ey, coefs_y, n_coefs_y, i, j, k, PMLComp::yz) );
+
+                    F(i, j, k, PMLComp::z) += dt * (
+                          T_Algo::DownwardDz(Ez, coefs_z, n_coefs_z, i, j, k, PMLComp::zx)
+                        + T_Algo::DownwardDz(Ez, coefs_z, n_coefs_z, i, j, k, PMLComp::zy)
+                        + T_Algo::DownwardDz(Ez, coefs_z, n_coefs_z, i, j, k, PMLComp::zz) );
+
+                }
+
+            );
+        }
+
     }
 
 }
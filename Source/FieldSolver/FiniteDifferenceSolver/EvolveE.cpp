@@ -7,7 +7,11 @@
 
 #include "WarpX.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/HardwareCounters.H"
 #include "FiniteDifferenceSolver.H"
+#include "FusedBoxParallelFor.H"
+#include "StencilParallelFor.H"
 #ifdef WARPX_DIM_RZ
 #   include "FiniteDifferenceAlgorithms/CylindricalYeeAlgorithm.H"
 #else
@@ -31,6 +35,8 @@ void FiniteDifferenceSolver::EvolveE (
     std::unique_ptr<amrex::MultiFab> const& Ffield,
     int lev, amrex::Real const dt ) {
 
+    HardwareCounterRegion counters("EvolveE");
+
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
@@ -72,35 +78,87 @@ void FiniteDifferenceSolver::EvolveECartesian (
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
     Real constexpr c2 = PhysConst::c * PhysConst::c;
 
+    // Extract stencil coefficients
+    Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+    int const n_coefs_x = m_stencil_coefs_x.size();
+    Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+    int const n_coefs_y = m_stencil_coefs_y.size();
+    Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+    int const n_coefs_z = m_stencil_coefs_z.size();
+
+    // Update of the fields at (i,j,k), from the arrays
+    // a = {Ex, Ey, Ez, Bx, By, Bz, jx, jy, jz, F} of a box
+    auto const update_Ex = [=] AMREX_GPU_DEVICE (FusedArrays<10> const& a, int i, int j, int k){
+        a.a[0](i, j, k) += c2 * dt * (
+            - T_Algo::DownwardDz(a.a[4], coefs_z, n_coefs_z, i, j, k)
+            + T_Algo::DownwardDy(a.a[5], coefs_y, n_coefs_y, i, j, k)
+            - PhysConst::mu0 * a.a[6](i, j, k) );
+    };
+    auto const update_Ey = [=] AMREX_GPU_DEVICE (FusedArrays<10> const& a, int i, int j, int k){
+        a.a[1](i, j, k) += c2 * dt * (
+            - T_Algo::DownwardDx(a.a[5], coefs_x, n_coefs_x, i, j, k)
+            + T_Algo::DownwardDz(a.a[3], coefs_z, n_coefs_z, i, j, k)
+            - PhysConst::mu0 * a.a[7](i, j, k) );
+    };
+    auto const update_Ez = [=] AMREX_GPU_DEVICE (FusedArrays<10> const& a, int i, int j, int k){
+        a.a[2](i, j, k) += c2 * dt * (
+            - T_Algo::DownwardDy(a.a[3], coefs_y, n_coefs_y, i, j, k)
+            + T_Algo::DownwardDx(a.a[4], coefs_x, n_coefs_x, i, j, k)
+            - PhysConst::mu0 * a.a[8](i, j, k) );
+    };
+
+    // If F is not a null pointer, further update E using the grad(F) term
+    // (hyperbolic correction for errors in charge conservation)
+    auto const update_Ex_F = [=] AMREX_GPU_DEVICE (FusedArrays<10> const& a, int i, int j, int k){
+        a.a[0](i, j, k) += c2 * dt * T_Algo::UpwardDx(a.a[9], coefs_x, n_coefs_x, i, j, k);
+    };
+    auto const update_Ey_F = [=] AMREX_GPU_DEVICE (FusedArrays<10> const& a, int i, int j, int k){
+        a.a[1](i, j, k) += c2 * dt * T_Algo::UpwardDy(a.a[9], coefs_y, n_coefs_y, i, j, k);
+    };
+    auto const update_Ez_F = [=] AMREX_GPU_DEVICE (FusedArrays<10> const& a, int i, int j, int k){
+        a.a[2](i, j, k) += c2 * dt * T_Algo::UpwardDz(a.a[9], coefs_z, n_coefs_z, i, j, k);
+    };
+
+#ifdef AMREX_USE_GPU
+    // Update all the boxes with one kernel launch per component (the cost of
+    // each box can only be measured when the boxes are updated separately)
+    if (amrex::Gpu::inLaunchRegion() &&
+        !(cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers))
+    {
+        m_fused_E.Update({Efield[0].get(), Efield[1].get(), Efield[2].get(),
+                          Bfield[0].get(), Bfield[1].get(), Bfield[2].get(),
+                          Jfield[0].get(), Jfield[1].get(), Jfield[2].get(), Ffield.get()},
+                         {Efield[0]->ixType().toIntVect(), Efield[1]->ixType().toIntVect(),
+                          Efield[2]->ixType().toIntVect()},
+                         getEBBoxTypes(), EBBoxType::Covered);
+        m_fused_E.ParallelFor(0, update_Ex);
+        m_fused_E.ParallelFor(1, update_Ey);
+        m_fused_E.ParallelFor(2, update_Ez);
+        if (Ffield) {
+            m_fused_E.ParallelFor(0, update_Ex_F);
+            m_fused_E.ParallelFor(1, update_Ey_F);
+            m_fused_E.ParallelFor(2, update_Ez_F);
+        }
+        ApplyEBMask(Efield);
+        return;
+    }
+#endif
+
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
     for ( MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
+        WARPX_PROFILE_RANGE("FiniteDifferenceSolver::EvolveE box " + std::to_string(mfi.index()));
 
         // Extract field data for this grid/tile
-        Array4<Real> const& Ex = Efield[0]->array(mfi);
-        Array4<Real> const& Ey = Efield[1]->array(mfi);
-        Array4<Real> const& Ez = Efield[2]->array(mfi);
-        Array4<Real> const& Bx = Bfield[0]->array(mfi);
-        Array4<Real> const& By = Bfield[1]->array(mfi);
-        Array4<Real> const& Bz = Bfield[2]->array(mfi);
-        Array4<Real> const& jx = Jfield[0]->array(mfi);
-        Array4<Real> const& jy = Jfield[1]->array(mfi);
-        Array4<Real> const& jz = Jfield[2]->array(mfi);
-
-        // Extract stencil coefficients
-        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
-        int const n_coefs_x = m_stencil_coefs_x.size();
-        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
-        int const n_coefs_y = m_stencil_coefs_y.size();
-        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
-        int const n_coefs_z = m_stencil_coefs_z.size();
+        FusedArrays<10> const a {{Efield[0]->array(mfi), Efield[1]->array(mfi), Efield[2]->array(mfi),
+                                  Bfield[0]->array(mfi), Bfield[1]->array(mfi), Bfield[2]->array(mfi),
+                                  Jfield[0]->array(mfi), Jfield[1]->array(mfi), Jfield[2]->array(mfi),
+                                  Ffield ? Ffield->array(mfi) : Array4<Real>()}};
 
         // Extract tileboxes for which to loop
         Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
@@ -108,63 +166,25 @@ void FiniteDifferenceSolver::EvolveECartesian (
         Box const& tez  = mfi.tilebox(Efield[2]->ixType().toIntVect());
 
         // Loop over the cells and update the fields
-        amrex::ParallelFor(tex, tey, tez,
-
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                Ex(i, j, k) += c2 * dt * (
-                    - T_Algo::DownwardDz(By, coefs_z, n_coefs_z, i, j, k)
-                    + T_Algo::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k)
-                    - PhysConst::mu0 * jx(i, j, k) );
-            },
-
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                Ey(i, j, k) += c2 * dt * (
-                    - T_Algo::DownwardDx(Bz, coefs_x, n_coefs_x, i, j, k)
-                    + T_Algo::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k)
-                    - PhysConst::mu0 * jy(i, j, k) );
-            },
-
-            [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                Ez(i, j, k) += c2 * dt * (
-                    - T_Algo::DownwardDy(Bx, coefs_y, n_coefs_y, i, j, k)
-                    + T_Algo::DownwardDx(By, coefs_x, n_coefs_x, i, j, k)
-                    - PhysConst::mu0 * jz(i, j, k) );
-            }
-
+        StencilParallelFor(tex, tey, tez,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Ex(a, i, j, k); },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Ey(a, i, j, k); },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Ez(a, i, j, k); }
         );
 
-        // If F is not a null pointer, further update E using the grad(F) term
-        // (hyperbolic correction for errors in charge conservation)
         if (Ffield) {
-
-            // Extract field data for this grid/tile
-            Array4<Real> F = Ffield->array(mfi);
-
-            // Loop over the cells and update the fields
-            amrex::ParallelFor(tex, tey, tez,
-
-                [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                    Ex(i, j, k) += c2 * dt * T_Algo::UpwardDx(F, coefs_x, n_coefs_x, i, j, k);
-                },
-                [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                    Ey(i, j, k) += c2 * dt * T_Algo::UpwardDy(F, coefs_y, n_coefs_y, i, j, k);
-                },
-                [=] AMREX_GPU_DEVICE (int i, int j, int k){
-                    Ez(i, j, k) += c2 * dt * T_Algo::UpwardDz(F, coefs_z, n_coefs_z, i, j, k);
-                }
-
+            StencilParallelFor(tex, tey, tez,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Ex_F(a, i, j, k); },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Ey_F(a, i, j, k); },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){ update_Ez_F(a, i, j, k); }
             );
-
         }
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+        box_timer.stop();
     }
 
+    // E vanishes on the surface of the embedded boundary
+    ApplyEBMask(Efield);
 }
 
 #else // corresponds to ifndef WARPX_DIM_RZ
@@ -184,11 +204,9 @@ void FiniteDifferenceSolver::EvolveECylindrical (
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
     for ( MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
 
         // Extract field data for this grid/tile
         Array4<Real> const& Er = Efield[0]->array(mfi);
@@ -359,14 +377,11 @@ void FiniteDifferenceSolver::EvolveECylindrical (
 
         } // end of if condition for F
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+        box_timer.stop();
     } // end of loop over grid/tiles
 
+    // E vanishes on the surface of the embedded boundary
+    ApplyEBMask(Efield);
 }
 
 #endif // corresponds to ifndef WARPX_DIM_RZ
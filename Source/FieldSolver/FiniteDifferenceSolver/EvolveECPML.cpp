@@ -0,0 +1,133 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#ifndef WARPX_DIM_RZ
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
+#endif
+#include "BoundaryConditions/CPMLKernels.H"
+#include "BoundaryConditions/PML.H"
+#include "Utils/WarpXConst.H"
+#include <AMReX_Gpu.H>
+#include <AMReX.H>
+
+using namespace amrex;
+
+/**
+ * \brief Update the E field in the convolutional PML, in vacuum, over one timestep
+ */
+void FiniteDifferenceSolver::EvolveECPML (
+    std::array< amrex::MultiFab*, 3 > Efield,
+    std::array< amrex::MultiFab*, 3 > const Bfield,
+    CPMLMemory const& psi_E,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt ) {
+
+   // Select algorithm (The choice of algorithm is a runtime option,
+   // but we compile code for each algorithm, using templates)
+#ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(Efield, Bfield, psi_E, sigba, dt);
+    amrex::Abort("PML are not implemented in cylindrical geometry.");
+#else
+    if (m_do_nodal) {
+
+        amrex::Abort("EvolveECPML: the convolutional PML is not implemented with the nodal solver");
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
+
+        EvolveECPMLCartesian <CartesianYeeAlgorithm> (Efield, Bfield, psi_E, sigba, dt);
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
+
+        EvolveECPMLCartesian <CartesianCKCAlgorithm> (Efield, Bfield, psi_E, sigba, dt);
+
+    } else {
+        amrex::Abort("EvolveECPML: Unknown algorithm");
+    }
+#endif
+}
+
+
+#ifndef WARPX_DIM_RZ
+
+template<typename T_Algo>
+void FiniteDifferenceSolver::EvolveECPMLCartesian (
+    std::array< amrex::MultiFab*, 3 > Efield,
+    std::array< amrex::MultiFab*, 3 > const Bfield,
+    CPMLMemory const& psi_E,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt ) {
+
+    Real const c2 = PhysConst::c * PhysConst::c;
+
+    // Loop through the grids, and over the tiles within each grid
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+
+        // Extract field data for this grid/tile
+        Array4<Real> const& Ex = Efield[0]->array(mfi);
+        Array4<Real> const& Ey = Efield[1]->array(mfi);
+        Array4<Real> const& Ez = Efield[2]->array(mfi);
+        Array4<Real> const& Bx = Bfield[0]->array(mfi);
+        Array4<Real> const& By = Bfield[1]->array(mfi);
+        Array4<Real> const& Bz = Bfield[2]->array(mfi);
+
+        // Memory variables and damping profiles of this box, for the damping factors of dt
+        // (the components of E are nodal along their transverse directions)
+        CPMLBoxData const cpml = psi_E.BoxData(sigba[mfi], mfi.index(), false, dt);
+
+        // Extract stencil coefficients
+        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+        int const n_coefs_x = m_stencil_coefs_x.size();
+        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+        int const n_coefs_y = m_stencil_coefs_y.size();
+        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+        int const n_coefs_z = m_stencil_coefs_z.size();
+
+        // Extract tileboxes for which to loop
+        Box const& tex  = mfi.tilebox(Efield[0]->ixType().ixType());
+        Box const& tey  = mfi.tilebox(Efield[1]->ixType().ixType());
+        Box const& tez  = mfi.tilebox(Efield[2]->ixType().ixType());
+
+        // Loop over the cells and update the fields
+        amrex::ParallelFor(tex, tey, tez,
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dy_Bz = warpx_cpml_derivative(i, j, k, 1, 0,
+                    T_Algo::DownwardDy(Bz, coefs_y, n_coefs_y, i, j, k), cpml);
+                Real const dz_By = warpx_cpml_derivative(i, j, k, 2, 0,
+                    T_Algo::DownwardDz(By, coefs_z, n_coefs_z, i, j, k), cpml);
+                Ex(i, j, k) += c2 * dt * (dy_Bz - dz_By);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dz_Bx = warpx_cpml_derivative(i, j, k, 2, 1,
+                    T_Algo::DownwardDz(Bx, coefs_z, n_coefs_z, i, j, k), cpml);
+                Real const dx_Bz = warpx_cpml_derivative(i, j, k, 0, 1,
+                    T_Algo::DownwardDx(Bz, coefs_x, n_coefs_x, i, j, k), cpml);
+                Ey(i, j, k) += c2 * dt * (dz_Bx - dx_Bz);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                Real const dx_By = warpx_cpml_derivative(i, j, k, 0, 2,
+                    T_Algo::DownwardDx(By, coefs_x, n_coefs_x, i, j, k), cpml);
+                Real const dy_Bx = warpx_cpml_derivative(i, j, k, 1, 2,
+                    T_Algo::DownwardDy(Bx, coefs_y, n_coefs_y, i, j, k), cpml);
+                Ez(i, j, k) += c2 * dt * (dx_By - dy_Bx);
+            }
+
+        );
+
+    }
+
+}
+
+#endif // corresponds to ifndef WARPX_DIM_RZ
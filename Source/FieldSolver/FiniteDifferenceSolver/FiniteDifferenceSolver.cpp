@@ -90,3 +90,77 @@ FiniteDifferenceSolver::FiniteDifferenceSolver (
     amrex::Gpu::synchronize();
 #endif
 }
+
+#ifdef AMREX_USE_EB
+void FiniteDifferenceSolver::SetEB (amrex::EBFArrayBoxFactory const& eb_factory)
+{
+    m_eb_flags = &eb_factory.getMultiEBCellFlagFab();
+    m_eb_box_type = std::make_unique<amrex::LayoutData<int>>(m_eb_flags->boxArray(),
+                                                             m_eb_flags->DistributionMap());
+
+    // The E update of the edges of a box reads B in its first guard cells
+    bool has_eb = false;
+    for (amrex::MFIter mfi(*m_eb_box_type); mfi.isValid(); ++mfi) {
+        amrex::FabType const fab_type = (*m_eb_flags)[mfi].getType(amrex::grow(mfi.validbox(), 1));
+        if (fab_type == amrex::FabType::regular) {
+            (*m_eb_box_type)[mfi] = EBBoxType::Regular;
+        } else if (fab_type == amrex::FabType::covered) {
+            (*m_eb_box_type)[mfi] = EBBoxType::Covered;
+            has_eb = true;
+        } else {
+            (*m_eb_box_type)[mfi] = EBBoxType::Cut;
+            has_eb = true;
+        }
+    }
+    // e.g. eb2.geom_type = all_regular: the updates are unchanged
+    if (!has_eb) m_eb_box_type.reset();
+}
+#endif
+
+void FiniteDifferenceSolver::ApplyEBMask (
+    std::array< std::unique_ptr<amrex::MultiFab>, 3 >& Efield )
+{
+#ifdef AMREX_USE_EB
+    if (!m_eb_box_type) return;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( amrex::MFIter mfi(*Efield[0], amrex::TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+        // the edges of the regular boxes do not touch any covered cell
+        if ((*m_eb_box_type)[mfi] != EBBoxType::Cut) continue;
+        amrex::Array4<amrex::EBCellFlag const> const& flag = m_eb_flags->const_array(mfi);
+
+        for (int idim = 0; idim < 3; ++idim) {
+            amrex::Array4<amrex::Real> const& E = Efield[idim]->array(mfi);
+            int const ncomp = Efield[idim]->nComp();
+            amrex::IntVect const ixtype = Efield[idim]->ixType().toIntVect();
+            // an edge touches the cells on both sides of it along its nodal directions
+            int const di = ixtype[0];
+            int const dj = ixtype[1];
+#if (AMREX_SPACEDIM == 3)
+            int const dk = ixtype[2];
+#else
+            int const dk = 0;
+#endif
+            amrex::ParallelFor(mfi.tilebox(ixtype),
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    bool covered = false;
+                    for (int kk = k-dk; kk <= k; ++kk) {
+                        for (int jj = j-dj; jj <= j; ++jj) {
+                            for (int ii = i-di; ii <= i; ++ii) {
+                                covered = covered || flag(ii, jj, kk).isCovered();
+                            }
+                        }
+                    }
+                    if (covered) {
+                        for (int n = 0; n < ncomp; ++n) E(i, j, k, n) = amrex::Real(0.);
+                    }
+                }
+            );
+        }
+    }
+#else
+    amrex::ignore_unused(Efield);
+#endif
+}
@@ -1,5 +1,6 @@
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "FiniteDifferenceSolver.H"
+#include "StencilParallelFor.H"
 #ifdef WARPX_DIM_RZ
     // currently works only for 3D
 #else
@@ -9,6 +10,8 @@
 #endif
 #include "Utils/WarpXConst.H"
 #include "Utils/CoarsenIO.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/HardwareCounters.H"
 #include <WarpX.H>
 #include <AMReX.H>
 #include <AMReX_Gpu.H>
@@ -24,12 +27,14 @@ void FiniteDifferenceSolver::MacroscopicEvolveE (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Hfield,
 #endif
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
-    amrex::Real const dt, std::unique_ptr<MacroscopicProperties> const& macroscopic_properties ) {
+    int lev, amrex::Real const dt, std::unique_ptr<MacroscopicProperties> const& macroscopic_properties ) {
+
+    HardwareCounterRegion counters("EvolveE");
 
    // Select algorithm (The choice of algorithm is a runtime option,
    // but we compile code for each algorithm, using templates)
 #ifdef WARPX_DIM_RZ
-    amrex::ignore_unused(Efield, Bfield, Jfield, dt, macroscopic_properties);
+    amrex::ignore_unused(Efield, Bfield, Jfield, lev, dt, macroscopic_properties);
     amrex::Abort("currently macro E-push does not work for RZ");
 #else
     if (m_do_nodal) {
@@ -46,7 +51,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveE (
 #else
                          Hfield,
 #endif
-                         Jfield, dt, macroscopic_properties );
+                         Jfield, lev, dt, macroscopic_properties );
         }
         if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
 
@@ -57,7 +62,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveE (
 #else
                          Hfield,
 #endif
-                         Jfield, dt, macroscopic_properties );
+                         Jfield, lev, dt, macroscopic_properties );
 
         }
 
@@ -74,7 +79,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveE (
 #else
                          Hfield,
 #endif
-                         Jfield, dt, macroscopic_properties );
+                         Jfield, lev, dt, macroscopic_properties );
 
         } else if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
 
@@ -85,7 +90,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveE (
 #else
                          Hfield,
 #endif
-                         Jfield, dt, macroscopic_properties );
+                         Jfield, lev, dt, macroscopic_properties );
         }
 
     } else {
@@ -107,11 +112,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Hfield,
 #endif
     std::array< std::unique_ptr<amrex::MultiFab>, 3 > const& Jfield,
-    amrex::Real const dt, std::unique_ptr<MacroscopicProperties> const& macroscopic_properties ) {
+    int lev, amrex::Real const dt, std::unique_ptr<MacroscopicProperties> const& macroscopic_properties ) {
 
-    auto& sigma_mf = macroscopic_properties->getsigma_mf();
-    auto& epsilon_mf = macroscopic_properties->getepsilon_mf();
-    auto& mu_mf = macroscopic_properties->getmu_mf();
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
     // Index type required for calling CoarsenIO::Interp to interpolate macroscopic
     // properties from their respective staggering to the Ex, Ey, Ez locations
@@ -122,12 +125,18 @@ void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
     amrex::GpuArray<int, 3> const& Ez_stag = macroscopic_properties->Ez_IndexType;
     amrex::GpuArray<int, 3> const& macro_cr     = macroscopic_properties->macro_cr_ratio;
 
+    // coefficients of the E update precomputed on the edges, recomputed only if dt has changed
+    bool const use_E_coefs = macroscopic_properties->getprecompute_E_coefs();
+    if (use_E_coefs) macroscopic_properties->UpdateECoefs<T_MacroAlgo>(dt);
 
     // Loop through the grids, and over the tiles within each grid
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
     for ( MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
 
         // Extract field data for this grid/tile
         Array4<Real> const& Ex = Efield[0]->array(mfi);
@@ -143,10 +152,10 @@ void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
         Array4<Real> const& Bz = Bfield[2]->array(mfi);
 #endif
 
-        // material prop //
-        Array4<Real> const& sigma_arr = sigma_mf.array(mfi);
-        Array4<Real> const& eps_arr = epsilon_mf.array(mfi);
-        Array4<Real> const& mu_arr = mu_mf.array(mfi);
+        // Extract tileboxes for which to loop
+        Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
+        Box const& tey  = mfi.tilebox(Efield[1]->ixType().toIntVect());
+        Box const& tez  = mfi.tilebox(Efield[2]->ixType().toIntVect());
 
         // Extract stencil coefficients
         Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
@@ -156,24 +165,97 @@ void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
         Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
         int const n_coefs_z = m_stencil_coefs_z.size();
 
+        // On vacuum and uniform boxes, the coefficients are the same on all the edges
+        // and the material properties are not read (on vacuum boxes, this is the Yee update of EvolveE)
+        if (macroscopic_properties->getmaterial_box_type(mfi) != MaterialBoxType::Varying) {
+            std::array<Real, 3> const& box_values = macroscopic_properties->getmaterial_box_values(mfi);
+            amrex::Real const alpha = T_MacroAlgo::alpha( box_values[0], box_values[1], dt);
+            amrex::Real const beta = T_MacroAlgo::beta( box_values[0], box_values[1], dt);
+#ifndef WARPX_MAG_LLG
+            // H = B / mu
+            amrex::Real const beta_curl = beta / box_values[2];
+            Array4<Real> const& Fx = Bx;
+            Array4<Real> const& Fy = By;
+            Array4<Real> const& Fz = Bz;
+#else
+            amrex::Real const beta_curl = beta;
+            Array4<Real> const& Fx = Hfield[0]->array(mfi);
+            Array4<Real> const& Fy = Hfield[1]->array(mfi);
+            Array4<Real> const& Fz = Hfield[2]->array(mfi);
+#endif
+            StencilParallelFor(tex, tey, tez,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    Ex(i, j, k) = alpha * Ex(i, j, k)
+                                + beta_curl * ( - T_Algo::DownwardDz(Fy, coefs_z, n_coefs_z, i, j, k,0)
+                                                + T_Algo::DownwardDy(Fz, coefs_y, n_coefs_y, i, j, k,0)
+                                              ) - beta * jx(i, j, k);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    Ey(i, j, k) = alpha * Ey(i, j, k)
+                                + beta_curl * ( - T_Algo::DownwardDx(Fz, coefs_x, n_coefs_x, i, j, k,0)
+                                                + T_Algo::DownwardDz(Fx, coefs_z, n_coefs_z, i, j, k,0)
+                                              ) - beta * jy(i, j, k);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    Ez(i, j, k) = alpha * Ez(i, j, k)
+                                + beta_curl * ( - T_Algo::DownwardDy(Fx, coefs_y, n_coefs_y, i, j, k,0)
+                                                + T_Algo::DownwardDx(Fy, coefs_x, n_coefs_x, i, j, k,0)
+                                              ) - beta * jz(i, j, k);
+                }
+            );
+            continue;
+        }
+
+        // material prop //
+        MacroPropertyArray const sigma_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::sigma);
+        MacroPropertyArray const eps_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::epsilon);
+        MacroPropertyArray const mu_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::mu);
+
 #ifndef WARPX_MAG_LLG
-        FieldAccessorMacroscopic const Hx(Bx, mu_arr);
-        FieldAccessorMacroscopic const Hy(By, mu_arr);
-        FieldAccessorMacroscopic const Hz(Bz, mu_arr);
+        FieldAccessorMacroscopic<MacroPropertyArray> const Hx(Bx, mu_arr);
+        FieldAccessorMacroscopic<MacroPropertyArray> const Hy(By, mu_arr);
+        FieldAccessorMacroscopic<MacroPropertyArray> const Hz(Bz, mu_arr);
 #else
         Array4<Real> const& Hx = Hfield[0]->array(mfi);
         Array4<Real> const& Hy = Hfield[1]->array(mfi);
         Array4<Real> const& Hz = Hfield[2]->array(mfi);
 #endif
 
-        // Extract tileboxes for which to loop
-        Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
-        Box const& tey  = mfi.tilebox(Efield[1]->ixType().toIntVect());
-        Box const& tez  = mfi.tilebox(Efield[2]->ixType().toIntVect());
+        // With the precomputed coefficients, sigma and epsilon are not read
+        if (use_E_coefs) {
+            Array4<Real const> const coef_x = macroscopic_properties->getE_coefs_mf(0).const_array(mfi);
+            Array4<Real const> const coef_y = macroscopic_properties->getE_coefs_mf(1).const_array(mfi);
+            Array4<Real const> const coef_z = macroscopic_properties->getE_coefs_mf(2).const_array(mfi);
+            StencilParallelFor(tex, tey, tez,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    amrex::Real const beta = coef_x(i, j, k, MacroECoef::beta);
+                    Ex(i, j, k) = coef_x(i, j, k, MacroECoef::alpha) * Ex(i, j, k)
+                                + beta * ( - T_Algo::DownwardDz(Hy, coefs_z, n_coefs_z, i, j, k,0)
+                                           + T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k,0)
+                                         ) - beta * jx(i, j, k);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    amrex::Real const beta = coef_y(i, j, k, MacroECoef::beta);
+                    Ey(i, j, k) = coef_y(i, j, k, MacroECoef::alpha) * Ey(i, j, k)
+                                + beta * ( - T_Algo::DownwardDx(Hz, coefs_x, n_coefs_x, i, j, k,0)
+                                           + T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k,0)
+                                         ) - beta * jy(i, j, k);
+                },
+                [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                    amrex::Real const beta = coef_z(i, j, k, MacroECoef::beta);
+                    Ez(i, j, k) = coef_z(i, j, k, MacroECoef::alpha) * Ez(i, j, k)
+                                + beta * ( - T_Algo::DownwardDy(Hx, coefs_y, n_coefs_y, i, j, k,0)
+                                           + T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k,0)
+                                         ) - beta * jz(i, j, k);
+                }
+            );
+            continue;
+        }
+
         // starting component to interpolate macro properties to Ex, Ey, Ez locations
         const int scomp = 0;
         // Loop over the cells and update the fields
-        amrex::ParallelFor(tex, tey, tez,
+        StencilParallelFor(tex, tey, tez,
             [=] AMREX_GPU_DEVICE (int i, int j, int k){
                 //// Interpolate conductivity, sigma, to Ex position on the grid
                 amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
@@ -219,6 +301,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveECartesian (
             }
         );
     }
+
+    // E vanishes on the surface of the embedded boundary
+    ApplyEBMask(Efield);
 }
 
 #endif // corresponds to ifndef WARPX_DIM_RZ
@@ -0,0 +1,201 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#ifndef WARPX_DIM_RZ
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianYeeAlgorithm.H"
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/CartesianCKCAlgorithm.H"
+#   include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceAlgorithms/FieldAccessorFunctors.H"
+#endif
+#include "BoundaryConditions/CPMLKernels.H"
+#include "BoundaryConditions/PML.H"
+#include "Utils/CoarsenIO.H"
+#include "WarpX.H"
+#include <AMReX_Gpu.H>
+#include <AMReX.H>
+
+using namespace amrex;
+
+#ifndef WARPX_MAG_LLG
+
+/**
+ * \brief Update the E field in the convolutional PML, in a macroscopic medium, over one timestep
+ */
+void FiniteDifferenceSolver::MacroscopicEvolveECPML (
+    std::array< amrex::MultiFab*, 3 > Efield,
+    std::array< amrex::MultiFab*, 3 > const Bfield,
+    CPMLMemory const& psi_E,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    amrex::MultiFab* const eps_mf,
+    amrex::MultiFab* const mu_mf,
+    amrex::MultiFab* const sigma_mf ) {
+
+   // Select algorithm (The choice of algorithm is a runtime option,
+   // but we compile code for each algorithm, using templates)
+#ifdef WARPX_DIM_RZ
+    amrex::ignore_unused(Efield, Bfield, psi_E, sigba, dt, macroscopic_properties, eps_mf, mu_mf, sigma_mf);
+    amrex::Abort("PML are not implemented in cylindrical geometry.");
+#else
+    if (m_do_nodal) {
+
+        amrex::Abort("Macro E-push is not implemented for nodal, yet.");
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::Yee) {
+
+        if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::LaxWendroff) {
+            MacroscopicEvolveECPMLCartesian <CartesianYeeAlgorithm, LaxWendroffAlgo> (
+                Efield, Bfield, psi_E, sigba, dt, macroscopic_properties, eps_mf, mu_mf, sigma_mf );
+        }
+        else if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
+            MacroscopicEvolveECPMLCartesian <CartesianYeeAlgorithm, BackwardEulerAlgo> (
+                Efield, Bfield, psi_E, sigba, dt, macroscopic_properties, eps_mf, mu_mf, sigma_mf );
+        }
+
+    } else if (m_fdtd_algo == MaxwellSolverAlgo::CKC) {
+
+        // Note :: Macroscopic Evolve E for PML is the same for CKC and Yee
+        if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::LaxWendroff) {
+            MacroscopicEvolveECPMLCartesian <CartesianCKCAlgorithm, LaxWendroffAlgo> (
+                Efield, Bfield, psi_E, sigba, dt, macroscopic_properties, eps_mf, mu_mf, sigma_mf );
+        }
+        else if (WarpX::macroscopic_solver_algo == MacroscopicSolverAlgo::BackwardEuler) {
+            MacroscopicEvolveECPMLCartesian <CartesianCKCAlgorithm, BackwardEulerAlgo> (
+                Efield, Bfield, psi_E, sigba, dt, macroscopic_properties, eps_mf, mu_mf, sigma_mf );
+        }
+
+    } else {
+        amrex::Abort("MacroscopicEvolveECPML: Unknown algorithm");
+    }
+#endif
+}
+
+
+#ifndef WARPX_DIM_RZ
+
+template<typename T_Algo, typename T_MacroAlgo>
+void FiniteDifferenceSolver::MacroscopicEvolveECPMLCartesian (
+    std::array< amrex::MultiFab*, 3 > Efield,
+    std::array< amrex::MultiFab*, 3 > const Bfield,
+    CPMLMemory const& psi_E,
+    MultiSigmaBox const& sigba,
+    amrex::Real const dt,
+    std::unique_ptr<MacroscopicProperties> const& macroscopic_properties,
+    amrex::MultiFab* const eps_mf,
+    amrex::MultiFab* const mu_mf,
+    amrex::MultiFab* const sigma_mf ) {
+
+    // Index type required for calling CoarsenIO::Interp to interpolate macroscopic
+    // properties from their respective staggering to the Ex, Ey, Ez locations
+    amrex::GpuArray<int, 3> const& sigma_stag = macroscopic_properties->sigma_IndexType;
+    amrex::GpuArray<int, 3> const& epsilon_stag = macroscopic_properties->epsilon_IndexType;
+    amrex::GpuArray<int, 3> const& Ex_stag = macroscopic_properties->Ex_IndexType;
+    amrex::GpuArray<int, 3> const& Ey_stag = macroscopic_properties->Ey_IndexType;
+    amrex::GpuArray<int, 3> const& Ez_stag = macroscopic_properties->Ez_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr     = macroscopic_properties->macro_cr_ratio;
+
+    // Loop through the grids, and over the tiles within each grid
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    for ( MFIter mfi(*Efield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
+
+        // Extract field data for this grid/tile
+        Array4<Real> const& Ex = Efield[0]->array(mfi);
+        Array4<Real> const& Ey = Efield[1]->array(mfi);
+        Array4<Real> const& Ez = Efield[2]->array(mfi);
+        Array4<Real> const& Bx = Bfield[0]->array(mfi);
+        Array4<Real> const& By = Bfield[1]->array(mfi);
+        Array4<Real> const& Bz = Bfield[2]->array(mfi);
+
+        // material macroscopic properties
+        Array4<Real> const& sigma_arr = sigma_mf->array(mfi);
+        Array4<Real> const& eps_arr = eps_mf->array(mfi);
+        Array4<Real> const& mu_arr = mu_mf->array(mfi);
+
+        // Memory variables and damping profiles of this box, for the damping factors of dt
+        // (the components of E are nodal along their transverse directions)
+        CPMLBoxData const cpml = psi_E.BoxData(sigba[mfi], mfi.index(), false, dt);
+
+        // Extract stencil coefficients
+        Real const * const AMREX_RESTRICT coefs_x = m_stencil_coefs_x.dataPtr();
+        int const n_coefs_x = m_stencil_coefs_x.size();
+        Real const * const AMREX_RESTRICT coefs_y = m_stencil_coefs_y.dataPtr();
+        int const n_coefs_y = m_stencil_coefs_y.size();
+        Real const * const AMREX_RESTRICT coefs_z = m_stencil_coefs_z.dataPtr();
+        int const n_coefs_z = m_stencil_coefs_z.size();
+
+        FieldAccessorMacroscopic<> const Hx(Bx, mu_arr);
+        FieldAccessorMacroscopic<> const Hy(By, mu_arr);
+        FieldAccessorMacroscopic<> const Hz(Bz, mu_arr);
+
+        // Extract tileboxes for which to loop
+        Box const& tex  = mfi.tilebox(Efield[0]->ixType().toIntVect());
+        Box const& tey  = mfi.tilebox(Efield[1]->ixType().toIntVect());
+        Box const& tez  = mfi.tilebox(Efield[2]->ixType().toIntVect());
+        // starting component to interpolate macro properties to Ex, Ey, Ez locations
+        const int scomp = 0;
+
+        // Loop over the cells and update the fields
+        amrex::ParallelFor(tex, tey, tez,
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
+                                           Ex_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
+                                           Ex_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                amrex::Real const beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+
+                Real const dy_Hz = warpx_cpml_derivative(i, j, k, 1, 0,
+                    T_Algo::DownwardDy(Hz, coefs_y, n_coefs_y, i, j, k), cpml);
+                Real const dz_Hy = warpx_cpml_derivative(i, j, k, 2, 0,
+                    T_Algo::DownwardDz(Hy, coefs_z, n_coefs_z, i, j, k), cpml);
+                Ex(i, j, k) = alpha * Ex(i, j, k) + beta * (dy_Hz - dz_Hy);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
+                                           Ey_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
+                                           Ey_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                amrex::Real const beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+
+                Real const dz_Hx = warpx_cpml_derivative(i, j, k, 2, 1,
+                    T_Algo::DownwardDz(Hx, coefs_z, n_coefs_z, i, j, k), cpml);
+                Real const dx_Hz = warpx_cpml_derivative(i, j, k, 0, 1,
+                    T_Algo::DownwardDx(Hz, coefs_x, n_coefs_x, i, j, k), cpml);
+                Ey(i, j, k) = alpha * Ey(i, j, k) + beta * (dz_Hx - dx_Hz);
+            },
+
+            [=] AMREX_GPU_DEVICE (int i, int j, int k){
+                amrex::Real const sigma_interp = CoarsenIO::Interp( sigma_arr, sigma_stag,
+                                           Ez_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const epsilon_interp = CoarsenIO::Interp( eps_arr, epsilon_stag,
+                                           Ez_stag, macro_cr, i, j, k, scomp);
+                amrex::Real const alpha = T_MacroAlgo::alpha( sigma_interp, epsilon_interp, dt);
+                amrex::Real const beta = T_MacroAlgo::beta( sigma_interp, epsilon_interp, dt);
+
+                Real const dx_Hy = warpx_cpml_derivative(i, j, k, 0, 2,
+                    T_Algo::DownwardDx(Hy, coefs_x, n_coefs_x, i, j, k), cpml);
+                Real const dy_Hx = warpx_cpml_derivative(i, j, k, 1, 2,
+                    T_Algo::DownwardDy(Hx, coefs_y, n_coefs_y, i, j, k), cpml);
+                Ez(i, j, k) = alpha * Ez(i, j, k) + beta * (dx_Hy - dy_Hx);
+            }
+
+        );
+
+    }
+
+}
+
+#endif // corresponds to ifndef WARPX_DIM_RZ
+
+#endif // corresponds to ifndef WARPX_MAG_LLG
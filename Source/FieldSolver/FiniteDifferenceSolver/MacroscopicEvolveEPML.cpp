@@ -162,9 +162,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveEPMLCartesian (
         int const n_coefs_z = m_stencil_coefs_z.size();
 
 #ifndef WARPX_MAG_LLG
-        FieldAccessorMacroscopic const Hx(Bx, mu_arr);
-        FieldAccessorMacroscopic const Hy(By, mu_arr);
-        FieldAccessorMacroscopic const Hz(Bz, mu_arr);
+        FieldAccessorMacroscopic<> const Hx(Bx, mu_arr);
+        FieldAccessorMacroscopic<> const Hy(By, mu_arr);
+        FieldAccessorMacroscopic<> const Hz(Bz, mu_arr);
 #else
         Array4<Real> const Hx = Hfield[0]->array(mfi);
         Array4<Real> const Hy = Hfield[1]->array(mfi);
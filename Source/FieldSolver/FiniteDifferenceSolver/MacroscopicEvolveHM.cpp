@@ -2,6 +2,7 @@
  * License: BSD-3-Clause-LBNL
  */
 
+#include "WarpX.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 #include "FiniteDifferenceSolver.H"
 #ifdef WARPX_DIM_RZ
@@ -13,6 +14,10 @@
 #endif
 #include "Utils/WarpXConst.H"
 #include "Utils/CoarsenIO.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/HardwareCounters.H"
+#include "MacroscopicProperties/MagDriftCheck.H"
+#include "MacroscopicProperties/MagImplicitMidpoint.H"
 #include <AMReX_Gpu.H>
 
 using namespace amrex;
@@ -31,13 +36,29 @@ void FiniteDifferenceSolver::MacroscopicEvolveHM(
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
-    amrex::Real const dt,
+    int lev, amrex::Real const dt,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
 {
 
+    HardwareCounterRegion counters("LLG");
+
     if (m_fdtd_algo == MaxwellSolverAlgo::Yee)
     {
-        MacroscopicEvolveHMCartesian<CartesianYeeAlgorithm>(Mfield, Hfield, Bfield, H_biasfield, Efield, dt, macroscopic_properties);
+        // The coupling and the normalization of M are runtime options, but the kernels are compiled
+        // for each of their values, so that the branches on them are resolved at compile time.
+        // M_normalization = 1 and 2 are the same in the 1st-order scheme.
+        auto &warpx = WarpX::GetInstance();
+        int const coupling = warpx.mag_LLG_coupling;
+        int const M_normalization = warpx.mag_M_normalization;
+        if (coupling == 0 && M_normalization == 0) {
+            MacroscopicEvolveHMCartesian<CartesianYeeAlgorithm, 0, 0>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 0 && M_normalization > 0) {
+            MacroscopicEvolveHMCartesian<CartesianYeeAlgorithm, 0, 1>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 1 && M_normalization == 0) {
+            MacroscopicEvolveHMCartesian<CartesianYeeAlgorithm, 1, 0>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 1 && M_normalization > 0) {
+            MacroscopicEvolveHMCartesian<CartesianYeeAlgorithm, 1, 1>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        }
     }
     else
     {
@@ -47,20 +68,20 @@ void FiniteDifferenceSolver::MacroscopicEvolveHM(
 #endif
 
 #ifdef WARPX_MAG_LLG
-template <typename T_Algo>
+template <typename T_Algo, int coupling, int M_normalization>
 void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Hfield, // H Maxwell
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
-    amrex::Real const dt,
+    int lev, amrex::Real const dt,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties)
 {
 
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
     auto &warpx = WarpX::GetInstance();
-    int coupling = warpx.mag_LLG_coupling;
-    int M_normalization = warpx.mag_M_normalization;
     // temporary Multifab storing M from previous timestep (old_time) before updating to M(new_time)
     std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_old; // Mfield_old is M(old_time)
 
@@ -71,6 +92,8 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
     amrex::GpuArray<int, 3> const& My_stag        = macroscopic_properties->My_IndexType;
     amrex::GpuArray<int, 3> const& Mz_stag        = macroscopic_properties->Mz_IndexType;
     amrex::GpuArray<int, 3> const& macro_cr       = macroscopic_properties->macro_cr_ratio;
+    // read the precomputed face-centered material coefficients instead of interpolating them (macroscopic.mag_precompute_face_coefs = 1)
+    int const use_face_coefs = macroscopic_properties->getmag_precompute_face_coefs();
 
     for (int i = 0; i < 3; i++)
     {
@@ -80,8 +103,70 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         MultiFab::Copy(*Mfield_old[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
     }
 
+    // multi-rate time stepping (warpx.mag_LLG_multirate_ratio > 1): within a window of mag_LLG_multirate_ratio
+    // Maxwell steps (i.e. twice as many calls), H is advanced at every call with M frozen, and M is only advanced
+    // at the last call, over the whole window and with the time average of H over the window
+    int const multirate_ratio = warpx.mag_LLG_multirate_ratio;
+    // magnetostatic mode (warpx.mag_magnetostatic = 1): H is the demagnetizing field of M instead of being advanced with curl E
+    int const magnetostatic = warpx.mag_magnetostatic;
+    bool update_M = true;
+    amrex::Real dt_M = dt;
+    std::array<amrex::MultiFab*, 3> H_M = {Hfield[0].get(), Hfield[1].get(), Hfield[2].get()}; // H used by the update of M
+    if (multirate_ratio > 1){
+        for (int i = 0; i < 3; i++){
+            // (re)distribute the average of H if the level has been remade since the last call
+            bool const is_valid = m_llg_H_avg[i]
+                && m_llg_H_avg[i]->boxArray() == Hfield[i]->boxArray()
+                && m_llg_H_avg[i]->DistributionMap() == Hfield[i]->DistributionMap();
+            if (!is_valid){
+                auto H_avg = std::make_unique<MultiFab>(Hfield[i]->boxArray(), Hfield[i]->DistributionMap(), 1, Hfield[i]->nGrowVect());
+                H_avg->setVal(0.);
+                if (m_llg_H_avg[i]) H_avg->ParallelCopy(*m_llg_H_avg[i], 0, 0, 1, IntVect::TheZeroVector(), IntVect::TheZeroVector());
+                m_llg_H_avg[i] = std::move(H_avg);
+            }
+            if (m_llg_window_calls == 0) m_llg_H_avg[i]->setVal(0.);
+            // accumulate H at the beginning of the call, as in the single-rate explicit update of M
+            MultiFab::Saxpy(*m_llg_H_avg[i], dt, *Hfield[i], 0, 0, 1, Hfield[i]->nGrowVect());
+        }
+        m_llg_window_dt += dt;
+        m_llg_window_calls++;
+
+        if (m_llg_window_calls < 2*multirate_ratio){
+            update_M = false;
+        } else {
+            dt_M = m_llg_window_dt;
+            amrex::Real dH_max = 0._rt;
+            amrex::Real H_avg_max = 0._rt;
+            for (int i = 0; i < 3; i++){
+                m_llg_H_avg[i]->mult(1._rt / m_llg_window_dt, m_llg_H_avg[i]->nGrow());
+                m_llg_H_avg[i]->FillBoundary(macroscopic_properties->getpatch_geom().periodicity());
+                H_M[i] = m_llg_H_avg[i].get();
+                // deviation of the current H from its average over the window
+                MultiFab dH(Hfield[i]->boxArray(), Hfield[i]->DistributionMap(), 1, 0);
+                MultiFab::LinComb(dH, 1._rt, *Hfield[i], 0, -1._rt, *m_llg_H_avg[i], 0, 0, 1, 0);
+                dH_max = amrex::max(dH_max, dH.norm0());
+                H_avg_max = amrex::max(H_avg_max, m_llg_H_avg[i]->norm0());
+            }
+            m_llg_dH_indicator = (H_avg_max > 0._rt) ? dH_max / H_avg_max : 0._rt;
+            m_llg_window_dt = 0._rt;
+            m_llg_window_calls = 0;
+        }
+    }
+
     // obtain the maximum relative amount we let M deviate from Ms before aborting
     amrex::Real mag_normalized_error = macroscopic_properties->getmag_normalized_error();
+    // faces on which |M| drifts too much from Ms are recorded in the kernel, and checked on the host after the launch
+    MagDriftCheck drift_check;
+    MagDriftRecord* const drift = drift_check.data();
+
+    // warpx.mag_time_scheme_order = 3: M is advanced with the implicit midpoint rule, solved on each face with
+    // Newton's method (tolerance macroscopic.mag_tol relative to Ms, at most macroscopic.mag_max_iter iterations)
+    int const implicit_M = (warpx.mag_time_scheme_order == 3);
+    int const newton_max_iter = macroscopic_properties->getmag_max_iter();
+    amrex::Real const newton_tol = macroscopic_properties->getmag_tol();
+    // largest number of Newton iterations over the faces
+    amrex::Gpu::DeviceScalar<int> newton_iter_max(0);
+    int* const newton_iter = newton_iter_max.dataPtr();
 
 #ifdef _OPENMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
@@ -89,27 +174,36 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
     for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi) /* remember to FIX */
     {
-        auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
-        auto& mag_alpha_mf = macroscopic_properties->getmag_alpha_mf();
-        auto& mag_gamma_mf = macroscopic_properties->getmag_gamma_mf();
+        // M is frozen until the last call of the multi-rate window
+        if (!update_M) break;
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
+
         // extract material properties
-        Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
-        Array4<Real> const& mag_alpha_arr = mag_alpha_mf.array(mfi);
-        Array4<Real> const& mag_gamma_arr = mag_gamma_mf.array(mfi);
+        MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
+        MacroPropertyArray const mag_alpha_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::alpha);
+        MacroPropertyArray const mag_gamma_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::gamma);
+        // precomputed face-centered material coefficients (only used if use_face_coefs)
+        Array4<Real const> const coef_xface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(0).const_array(mfi) : Array4<Real const>();
+        Array4<Real const> const coef_yface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(1).const_array(mfi) : Array4<Real const>();
+        Array4<Real const> const coef_zface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(2).const_array(mfi) : Array4<Real const>();
 
         // extract field data
-        Array4<Real> const &Hx = Hfield[0]->array(mfi);
-        Array4<Real> const &Hy = Hfield[1]->array(mfi);
-        Array4<Real> const &Hz = Hfield[2]->array(mfi);
+        Array4<Real> const &Hx = H_M[0]->array(mfi);
+        Array4<Real> const &Hy = H_M[1]->array(mfi);
+        Array4<Real> const &Hz = H_M[2]->array(mfi);
         Array4<Real> const &M_xface = Mfield[0]->array(mfi);         // note M_xface include x,y,z components at |_x faces
         Array4<Real> const &M_yface = Mfield[1]->array(mfi);         // note M_yface include x,y,z components at |_y faces
         Array4<Real> const &M_zface = Mfield[2]->array(mfi);         // note M_zface include x,y,z components at |_z faces
         Array4<Real> const &M_xface_old = Mfield_old[0]->array(mfi); // note M_xface_old include x,y,z components at |_x faces
         Array4<Real> const &M_yface_old = Mfield_old[1]->array(mfi); // note M_yface_old include x,y,z components at |_y faces
         Array4<Real> const &M_zface_old = Mfield_old[2]->array(mfi); // note M_zface_old include x,y,z components at |_z faces
-        Array4<Real> const &Hx_bias = H_biasfield[0]->array(mfi);    // Hx_bias is the x component at |_x faces
-        Array4<Real> const &Hy_bias = H_biasfield[1]->array(mfi);    // Hy_bias is the y component at |_y faces
-        Array4<Real> const &Hz_bias = H_biasfield[2]->array(mfi);    // Hz_bias is the z component at |_z faces
+        // H_bias, read from H_biasfield or evaluated on the fly (warpx.mag_H_bias_on_the_fly)
+        amrex::GpuArray<HBiasComponent, 3> const H_bias = warpx.GetHBias(H_biasfield, lev, mfi);
+        HBiasComponent const Hx_bias = H_bias[0];    // Hx_bias is the x component at |_x faces
+        HBiasComponent const Hy_bias = H_bias[1];    // Hy_bias is the y component at |_y faces
+        HBiasComponent const Hz_bias = H_bias[2];    // Hz_bias is the z component at |_z faces
 
         // extract tileboxes for which to loop
         Box const &tbx = mfi.tilebox(Hfield[0]->ixType().toIntVect()); /* just define which grid type */
@@ -117,12 +211,13 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         Box const &tbz = mfi.tilebox(Hfield[2]->ixType().toIntVect());
 
         // loop over cells and update fields
-        amrex::ParallelFor(tbx, tby, tbz,
+        // skipped on vacuum boxes, and restricted to the magnetic faces on mixed boxes
+        macroscopic_properties->MagneticParallelFor(mfi, tbx, tby, tbz,
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                Real mag_Ms_arrx    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
-                Real mag_alpha_arrx = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mx_stag, macro_cr, i, j, k, 0);
-                Real mag_gamma_arrx = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mx_stag, macro_cr, i, j, k, 0);
+                Real mag_Ms_arrx    = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
+                Real mag_alpha_arrx = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mx_stag, macro_cr, i, j, k, 0);
+                Real mag_gamma_arrx = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mx_stag, macro_cr, i, j, k, 0);
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_arrx > 0._rt)
@@ -146,7 +241,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     // magnetic material properties mag_alpha and mag_Ms are defined at faces
                     // removed the interpolation from version with cell-nodal material properties
-                    amrex::Real mag_gammaL = mag_gamma_arrx / (1._rt + std::pow(mag_alpha_arrx, 2._rt));
+                    amrex::Real mag_gammaL = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::gammaL) : mag_gamma_arrx / (1._rt + std::pow(mag_alpha_arrx, 2._rt));
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
                     amrex::Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) + std::pow(M_xface(i, j, k, 2), 2._rt))
@@ -154,20 +249,34 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                     amrex::Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha_arrx / M_magnitude;
 
                     // now you have access to use M_xface(i,j,k,0) M_xface(i,j,k,1), M_xface(i,j,k,2), Hx(i,j,k), Hy, Hz on the RHS of these update lines below
-                    // x component on x-faces of grid
-                    M_xface(i, j, k, 0) += dt * (PhysConst::mu0 * mag_gammaL) * (M_xface_old(i, j, k, 1) * Hz_eff - M_xface_old(i, j, k, 2) * Hy_eff)
-                                         + dt * Gil_damp * (M_xface_old(i, j, k, 1) * (M_xface_old(i, j, k, 0) * Hy_eff - M_xface_old(i, j, k, 1) * Hx_eff)
-                                         - M_xface_old(i, j, k, 2) * (M_xface_old(i, j, k, 2) * Hx_eff - M_xface_old(i, j, k, 0) * Hz_eff));
-
-                    // y component on x-faces of grid
-                    M_xface(i, j, k, 1) += dt * (PhysConst::mu0 * mag_gammaL) * (M_xface_old(i, j, k, 2) * Hx_eff - M_xface_old(i, j, k, 0) * Hz_eff)
-                                         + dt * Gil_damp * (M_xface_old(i, j, k, 2) * (M_xface_old(i, j, k, 1) * Hz_eff - M_xface_old(i, j, k, 2) * Hy_eff)
-                                         - M_xface_old(i, j, k, 0) * (M_xface_old(i, j, k, 0) * Hy_eff - M_xface_old(i, j, k, 1) * Hx_eff));
-
-                    // z component on x-faces of grid
-                    M_xface(i, j, k, 2) += dt * (PhysConst::mu0 * mag_gammaL) * (M_xface_old(i, j, k, 0) * Hy_eff - M_xface_old(i, j, k, 1) * Hx_eff)
-                                         + dt * Gil_damp * (M_xface_old(i, j, k, 0) * (M_xface_old(i, j, k, 2) * Hx_eff - M_xface_old(i, j, k, 0) * Hz_eff)
-                                         - M_xface_old(i, j, k, 1) * (M_xface_old(i, j, k, 1) * Hz_eff - M_xface_old(i, j, k, 2) * Hy_eff));
+                    if (implicit_M)
+                    {
+                        // implicit midpoint rule, with H_eff frozen over the time step
+                        Real const M_n[3] = {M_xface_old(i, j, k, 0), M_xface_old(i, j, k, 1), M_xface_old(i, j, k, 2)};
+                        Real M_new[3] = {M_n[0], M_n[1], M_n[2]};
+                        Real const H_eff[3] = {Hx_eff, Hy_eff, Hz_eff};
+                        int const n_iter = MagImplicitMidpoint::Solve(M_new, M_n, H_eff, PhysConst::mu0 * mag_gammaL, Gil_damp, dt_M,
+                                                                      newton_tol * mag_Ms_arrx, newton_max_iter);
+                        amrex::Gpu::Atomic::Max(newton_iter, n_iter);
+                        for (int comp = 0; comp < 3; ++comp) M_xface(i, j, k, comp) = M_new[comp];
+                    }
+                    else
+                    {
+                        // x component on x-faces of grid
+                        M_xface(i, j, k, 0) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_xface_old(i, j, k, 1) * Hz_eff - M_xface_old(i, j, k, 2) * Hy_eff)
+                                             + dt_M * Gil_damp * (M_xface_old(i, j, k, 1) * (M_xface_old(i, j, k, 0) * Hy_eff - M_xface_old(i, j, k, 1) * Hx_eff)
+                                             - M_xface_old(i, j, k, 2) * (M_xface_old(i, j, k, 2) * Hx_eff - M_xface_old(i, j, k, 0) * Hz_eff));
+
+                        // y component on x-faces of grid
+                        M_xface(i, j, k, 1) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_xface_old(i, j, k, 2) * Hx_eff - M_xface_old(i, j, k, 0) * Hz_eff)
+                                             + dt_M * Gil_damp * (M_xface_old(i, j, k, 2) * (M_xface_old(i, j, k, 1) * Hz_eff - M_xface_old(i, j, k, 2) * Hy_eff)
+                                             - M_xface_old(i, j, k, 0) * (M_xface_old(i, j, k, 0) * Hy_eff - M_xface_old(i, j, k, 1) * Hx_eff));
+
+                        // z component on x-faces of grid
+                        M_xface(i, j, k, 2) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_xface_old(i, j, k, 0) * Hy_eff - M_xface_old(i, j, k, 1) * Hx_eff)
+                                             + dt_M * Gil_damp * (M_xface_old(i, j, k, 0) * (M_xface_old(i, j, k, 2) * Hx_eff - M_xface_old(i, j, k, 0) * Hz_eff)
+                                             - M_xface_old(i, j, k, 1) * (M_xface_old(i, j, k, 1) * Hz_eff - M_xface_old(i, j, k, 2) * Hy_eff));
+                    }
 
                     // temporary normalized magnitude of M_xface field at the fixed point
                     // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
@@ -179,9 +288,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
                         {
-                            printf("i = %d, j=%d, k=%d\n", i, j, k);
-                            printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                            amrex::Abort("Exceed the normalized error of the M_xface field");
+                            MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 0, i, j, k, M_magnitude_normalized, mag_Ms_arrx);
                         }
                         // normalize the M_xface field
                         M_xface(i, j, k, 0) /= M_magnitude_normalized;
@@ -193,9 +300,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (M_magnitude_normalized > (1._rt + mag_normalized_error))
                         {
-                            printf("i = %d, j=%d, k=%d\n", i, j, k);
-                            printf("M_magnitude_normalized = %f, Ms = %f\n", M_magnitude_normalized, mag_Ms_arrx);
-                            amrex::Abort("Caution: Unsaturated material has M_xface exceeding the saturation magnetization");
+                            MagDriftCheck::Record(drift, MagDriftCheck::Unsaturated, 0, i, j, k, M_magnitude_normalized, mag_Ms_arrx);
                         }
                         else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= (1._rt + mag_normalized_error) )
                         {
@@ -210,9 +315,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                Real mag_Ms_arry    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
-                Real mag_alpha_arry = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, My_stag, macro_cr, i, j, k, 0);
-                Real mag_gamma_arry = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, My_stag, macro_cr, i, j, k, 0);
+                Real mag_Ms_arry    = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
+                Real mag_alpha_arry = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, My_stag, macro_cr, i, j, k, 0);
+                Real mag_gamma_arry = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, My_stag, macro_cr, i, j, k, 0);
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_arry > 0._rt)
@@ -236,27 +341,41 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     // magnetic material properties mag_alpha and mag_Ms are defined at faces
                     // removed the interpolation from version with cell-nodal material properties
-                    Real mag_gammaL = mag_gamma_arry / (1._rt + std::pow(mag_alpha_arry, 2._rt));
+                    Real mag_gammaL = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::gammaL) : mag_gamma_arry / (1._rt + std::pow(mag_alpha_arry, 2._rt));
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
                     Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) + std::pow(M_yface(i, j, k, 2), 2._rt))
                                                               : mag_Ms_arry;
                     Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha_arry / M_magnitude;
 
-                    // x component on y-faces of grid
-                    M_yface(i, j, k, 0) += dt * (PhysConst::mu0 * mag_gammaL) * (M_yface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff)
-                                         + dt * Gil_damp * (M_yface_old(i, j, k, 1) * (M_yface_old(i, j, k, 0) * Hy_eff - M_yface_old(i, j, k, 1) * Hx_eff)
-                                         - M_yface_old(i, j, k, 2) * (M_yface_old(i, j, k, 2) * Hx_eff - M_yface_old(i, j, k, 0) * Hz_eff));
-
-                    // y component on y-faces of grid
-                    M_yface(i, j, k, 1) += dt * (PhysConst::mu0 * mag_gammaL) * (M_yface_old(i, j, k, 2) * Hx_eff - M_yface_old(i, j, k, 0) * Hz_eff)
-                                         + dt * Gil_damp * (M_yface_old(i, j, k, 2) * (M_yface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff)
-                                         - M_yface_old(i, j, k, 0) * (M_yface_old(i, j, k, 0) * Hy_eff - M_yface_old(i, j, k, 1) * Hx_eff));
-
-                    // z component on y-faces of grid
-                    M_yface(i, j, k, 2) += dt * (PhysConst::mu0 * mag_gammaL) * (M_yface_old(i, j, k, 0) * Hy_eff - M_yface_old(i, j, k, 1) * Hx_eff)
-                                         + dt * Gil_damp * (M_yface_old(i, j, k, 0) * (M_yface_old(i, j, k, 2) * Hx_eff - M_yface_old(i, j, k, 0) * Hz_eff)
-                                         - M_yface_old(i, j, k, 1) * (M_yface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff));
+                    if (implicit_M)
+                    {
+                        // implicit midpoint rule, with H_eff frozen over the time step
+                        Real const M_n[3] = {M_yface_old(i, j, k, 0), M_yface_old(i, j, k, 1), M_yface_old(i, j, k, 2)};
+                        Real M_new[3] = {M_n[0], M_n[1], M_n[2]};
+                        Real const H_eff[3] = {Hx_eff, Hy_eff, Hz_eff};
+                        int const n_iter = MagImplicitMidpoint::Solve(M_new, M_n, H_eff, PhysConst::mu0 * mag_gammaL, Gil_damp, dt_M,
+                                                                      newton_tol * mag_Ms_arry, newton_max_iter);
+                        amrex::Gpu::Atomic::Max(newton_iter, n_iter);
+                        for (int comp = 0; comp < 3; ++comp) M_yface(i, j, k, comp) = M_new[comp];
+                    }
+                    else
+                    {
+                        // x component on y-faces of grid
+                        M_yface(i, j, k, 0) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_yface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff)
+                                             + dt_M * Gil_damp * (M_yface_old(i, j, k, 1) * (M_yface_old(i, j, k, 0) * Hy_eff - M_yface_old(i, j, k, 1) * Hx_eff)
+                                             - M_yface_old(i, j, k, 2) * (M_yface_old(i, j, k, 2) * Hx_eff - M_yface_old(i, j, k, 0) * Hz_eff));
+
+                        // y component on y-faces of grid
+                        M_yface(i, j, k, 1) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_yface_old(i, j, k, 2) * Hx_eff - M_yface_old(i, j, k, 0) * Hz_eff)
+                                             + dt_M * Gil_damp * (M_yface_old(i, j, k, 2) * (M_yface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff)
+                                             - M_yface_old(i, j, k, 0) * (M_yface_old(i, j, k, 0) * Hy_eff - M_yface_old(i, j, k, 1) * Hx_eff));
+
+                        // z component on y-faces of grid
+                        M_yface(i, j, k, 2) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_yface_old(i, j, k, 0) * Hy_eff - M_yface_old(i, j, k, 1) * Hx_eff)
+                                             + dt_M * Gil_damp * (M_yface_old(i, j, k, 0) * (M_yface_old(i, j, k, 2) * Hx_eff - M_yface_old(i, j, k, 0) * Hz_eff)
+                                             - M_yface_old(i, j, k, 1) * (M_yface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff));
+                    }
 
                     // temporary normalized magnitude of M_yface field at the fixed point
                     // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
@@ -268,9 +387,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
                         {
-                            printf("i = %d, j=%d, k=%d\n", i, j, k);
-                            printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                            amrex::Abort("Exceed the normalized error of the M_yface field");
+                            MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 1, i, j, k, M_magnitude_normalized, mag_Ms_arry);
                         }
                         // normalize the M_yface field
                         M_yface(i, j, k, 0) /= M_magnitude_normalized;
@@ -282,9 +399,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (M_magnitude_normalized > 1._rt + mag_normalized_error)
                         {
-                            printf("i = %d, j=%d, k=%d\n", i, j, k);
-                            printf("M_magnitude_normalized = %f, Ms = %f\n", M_magnitude_normalized, mag_Ms_arry);
-                            amrex::Abort("Caution: Unsaturated material has M_yface exceeding the saturation magnetization");
+                            MagDriftCheck::Record(drift, MagDriftCheck::Unsaturated, 1, i, j, k, M_magnitude_normalized, mag_Ms_arry);
                         }
                         else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error)
                         {
@@ -299,9 +414,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                Real mag_Ms_arrz    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
-                Real mag_alpha_arrz = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mz_stag, macro_cr, i, j, k, 0);
-                Real mag_gamma_arrz = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mz_stag, macro_cr, i, j, k, 0);
+                Real mag_Ms_arrz    = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
+                Real mag_alpha_arrz = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mz_stag, macro_cr, i, j, k, 0);
+                Real mag_gamma_arrz = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mz_stag, macro_cr, i, j, k, 0);
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_arrz > 0._rt)
@@ -326,27 +441,41 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
 
                     // magnetic material properties mag_alpha and mag_Ms are defined at faces
                     // removed the interpolation from version with cell-nodal material properties
-                    Real mag_gammaL = mag_gamma_arrz / (1._rt + std::pow(mag_alpha_arrz, 2._rt));
+                    Real mag_gammaL = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::gammaL) : mag_gamma_arrz / (1._rt + std::pow(mag_alpha_arrz, 2._rt));
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
                     Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) + std::pow(M_zface(i, j, k, 2), 2._rt))
                                                               : mag_Ms_arrz;
                     Real Gil_damp = PhysConst::mu0 * mag_gammaL * mag_alpha_arrz / M_magnitude;
 
-                    // x component on z-faces of grid
-                    M_zface(i, j, k, 0) += dt * (PhysConst::mu0 * mag_gammaL) * (M_zface_old(i, j, k, 1) * Hz_eff - M_zface_old(i, j, k, 2) * Hy_eff)
-                                         + dt * Gil_damp * (M_zface_old(i, j, k, 1) * (M_zface_old(i, j, k, 0) * Hy_eff - M_zface_old(i, j, k, 1) * Hx_eff)
-                                         - M_zface_old(i, j, k, 2) * (M_zface_old(i, j, k, 2) * Hx_eff - M_zface_old(i, j, k, 0) * Hz_eff));
-
-                    // y component on z-faces of grid
-                    M_zface(i, j, k, 1) += dt * (PhysConst::mu0 * mag_gammaL) * (M_zface_old(i, j, k, 2) * Hx_eff - M_zface_old(i, j, k, 0) * Hz_eff)
-                                         + dt * Gil_damp * (M_zface_old(i, j, k, 2) * (M_zface_old(i, j, k, 1) * Hz_eff - M_zface_old(i, j, k, 2) * Hy_eff)
-                                         - M_zface_old(i, j, k, 0) * (M_zface_old(i, j, k, 0) * Hy_eff - M_zface_old(i, j, k, 1) * Hx_eff));
-
-                    // z component on z-faces of grid
-                    M_zface(i, j, k, 2) += dt * (PhysConst::mu0 * mag_gammaL) * (M_zface_old(i, j, k, 0) * Hy_eff - M_zface_old(i, j, k, 1) * Hx_eff)
-                                         + dt * Gil_damp * (M_zface_old(i, j, k, 0) * (M_zface_old(i, j, k, 2) * Hx_eff - M_zface_old(i, j, k, 0) * Hz_eff)
-                                         - M_zface_old(i, j, k, 1) * (M_zface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff));
+                    if (implicit_M)
+                    {
+                        // implicit midpoint rule, with H_eff frozen over the time step
+                        Real const M_n[3] = {M_zface_old(i, j, k, 0), M_zface_old(i, j, k, 1), M_zface_old(i, j, k, 2)};
+                        Real M_new[3] = {M_n[0], M_n[1], M_n[2]};
+                        Real const H_eff[3] = {Hx_eff, Hy_eff, Hz_eff};
+                        int const n_iter = MagImplicitMidpoint::Solve(M_new, M_n, H_eff, PhysConst::mu0 * mag_gammaL, Gil_damp, dt_M,
+                                                                      newton_tol * mag_Ms_arrz, newton_max_iter);
+                        amrex::Gpu::Atomic::Max(newton_iter, n_iter);
+                        for (int comp = 0; comp < 3; ++comp) M_zface(i, j, k, comp) = M_new[comp];
+                    }
+                    else
+                    {
+                        // x component on z-faces of grid
+                        M_zface(i, j, k, 0) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_zface_old(i, j, k, 1) * Hz_eff - M_zface_old(i, j, k, 2) * Hy_eff)
+                                             + dt_M * Gil_damp * (M_zface_old(i, j, k, 1) * (M_zface_old(i, j, k, 0) * Hy_eff - M_zface_old(i, j, k, 1) * Hx_eff)
+                                             - M_zface_old(i, j, k, 2) * (M_zface_old(i, j, k, 2) * Hx_eff - M_zface_old(i, j, k, 0) * Hz_eff));
+
+                        // y component on z-faces of grid
+                        M_zface(i, j, k, 1) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_zface_old(i, j, k, 2) * Hx_eff - M_zface_old(i, j, k, 0) * Hz_eff)
+                                             + dt_M * Gil_damp * (M_zface_old(i, j, k, 2) * (M_zface_old(i, j, k, 1) * Hz_eff - M_zface_old(i, j, k, 2) * Hy_eff)
+                                             - M_zface_old(i, j, k, 0) * (M_zface_old(i, j, k, 0) * Hy_eff - M_zface_old(i, j, k, 1) * Hx_eff));
+
+                        // z component on z-faces of grid
+                        M_zface(i, j, k, 2) += dt_M * (PhysConst::mu0 * mag_gammaL) * (M_zface_old(i, j, k, 0) * Hy_eff - M_zface_old(i, j, k, 1) * Hx_eff)
+                                             + dt_M * Gil_damp * (M_zface_old(i, j, k, 0) * (M_zface_old(i, j, k, 2) * Hx_eff - M_zface_old(i, j, k, 0) * Hz_eff)
+                                             - M_zface_old(i, j, k, 1) * (M_zface_old(i, j, k, 1) * Hz_eff - M_yface_old(i, j, k, 2) * Hy_eff));
+                    }
 
                     // temporary normalized magnitude of M_zface field at the fixed point
                     // re-investigate the way we do Ms interp, in case we encounter the case where Ms changes across two adjacent cells that you are doing interp
@@ -358,9 +487,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error)
                         {
-                            printf("i = %d, j=%d, k=%d\n", i, j, k);
-                            printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                            amrex::Abort("Exceed the normalized error of the M_zface field");
+                            MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 2, i, j, k, M_magnitude_normalized, mag_Ms_arrz);
                         }
                         // normalize the M_zface field
                         M_zface(i, j, k, 0) /= M_magnitude_normalized;
@@ -372,9 +499,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                         // check the normalized error
                         if (M_magnitude_normalized > 1._rt + mag_normalized_error)
                         {
-                            printf("i = %d, j=%d, k=%d\n", i, j, k);
-                            printf("M_magnitude_normalized = %f, Ms = %f\n", M_magnitude_normalized, mag_Ms_arrz);
-                            amrex::Abort("Caution: Unsaturated material has M_zface exceeding the saturation magnetization");
+                            MagDriftCheck::Record(drift, MagDriftCheck::Unsaturated, 2, i, j, k, M_magnitude_normalized, mag_Ms_arrz);
                         }
                         else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error)
                         {
@@ -387,9 +512,37 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
                 } // end if (mag_Ms_arrz(i,j,k) > 0...
             });
     }
+    drift_check.Check(mag_normalized_error);
+
+    if (implicit_M && update_M && newton_iter_max.dataValue() > newton_max_iter){
+        amrex::Abort("The Newton iterations of the implicit LLG update exceed macroscopic.mag_max_iter");
+    }
+
+    if ((multirate_ratio > 1 || warpx.mag_adaptive_dt) && update_M){
+        // largest change of M over the window (or the step), relative to the largest Ms
+        amrex::Real dM_max = 0._rt;
+        for (int i = 0; i < 3; i++){
+            MultiFab dM(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, 0);
+            MultiFab::LinComb(dM, 1._rt, *Mfield[i], 0, -1._rt, *Mfield_old[i], 0, 0, 3, 0);
+            for (int comp = 0; comp < 3; comp++) dM_max = amrex::max(dM_max, dM.norm0(comp));
+        }
+        amrex::Real const Ms_max = macroscopic_properties->getproperty_max(MacroProp::Ms);
+        m_llg_dM_indicator = (Ms_max > 0._rt) ? dM_max / Ms_max : 0._rt;
+    }
+
+#if defined(WARPX_USE_PSATD) && (AMREX_SPACEDIM == 3)
+    if (magnetostatic) warpx.get_pointer_mag_demag_solver()->ComputeDemagField(Mfield, Hfield);
+#endif
+
     // Update H(new_time) = f(H(old_time), M(new_time), M(old_time), E(old_time))
     for (MFIter mfi(*Hfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
+        // H = H_demag(M(new_time)) in magnetostatic mode
+        if (magnetostatic) break;
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
+
         // Extract field data for this grid/tile
         Array4<Real> const &Hx = Hfield[0]->array(mfi);
         Array4<Real> const &Hy = Hfield[1]->array(mfi);
@@ -418,12 +571,10 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         Box const &tbz = mfi.tilebox(Hfield[2]->ixType().toIntVect());
 
         // read in Ms to decide if the grid is magnetic or not
-        auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
-        Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
+        MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
 
-        // mu_mf will be imported but will only be called at grids where Ms == 0
-        auto& mu_mf = macroscopic_properties->getmu_mf();
-        Array4<Real> const& mu_arr = mu_mf.array(mfi);
+        // mu will be imported but will only be called at grids where Ms == 0
+        MacroPropertyArray const mu_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::mu);
 
         amrex::Real const mu0_inv = 1. / PhysConst::mu0;
 
@@ -476,6 +627,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
     // update B
     for (MFIter mfi(*Bfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
         // Extract field data for this grid/tile
         Array4<Real> const &Hx = Hfield[0]->array(mfi);
         Array4<Real> const &Hy = Hfield[1]->array(mfi);
@@ -493,12 +647,10 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian(
         Box const &tbz = mfi.tilebox(Bfield[2]->ixType().toIntVect());
 
         // read in Ms to decide if the grid is magnetic or not
-        auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
-        Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
+        MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
 
-        // mu_mf will be imported but will only be called at grids where Ms == 0
-        auto& mu_mf = macroscopic_properties->getmu_mf();
-        Array4<Real> const& mu_arr = mu_mf.array(mfi);
+        // mu will be imported but will only be called at grids where Ms == 0
+        MacroPropertyArray const mu_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::mu);
 
         // Loop over the cells and update the fields
         amrex::ParallelFor(tbx, tby, tbz,
@@ -9,10 +9,210 @@ blank
 
 #include "Utils/WarpXConst.H"
 #include "Utils/CoarsenIO.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/HardwareCounters.H"
+#include "MacroscopicProperties/MagDriftCheck.H"
 #include <AMReX_Gpu.H>
+#include <AMReX_ParallelDescriptor.H>
 
 using namespace amrex;
 
+#ifdef WARPX_MAG_LLG
+namespace {
+    /**
+     * \brief Mark as active every box that is still iterating, together with all the boxes
+     * sharing its guard cells, since the M update of the latter reads H from the former.
+     *
+     * \param[in]  ba          cell-centered BoxArray of the level
+     * \param[in]  geom        geometry of the level, used to find the periodic neighbours
+     * \param[in]  ng          number of guard cells exchanged between neighbouring boxes
+     * \param[in]  box_error   maximum error of the M field on each box (global, i.e. for all boxes)
+     * \param[in]  tol         tolerance below which the M field of a box is considered converged
+     * \param[out] box_active  1 if the box takes part in the next iteration, 0 otherwise
+     */
+    void BuildActiveBoxMask (amrex::BoxArray const& ba, amrex::Geometry const& geom,
+                             amrex::IntVect const& ng,
+                             amrex::Vector<amrex::Real> const& box_error, amrex::Real const tol,
+                             amrex::Vector<int>& box_active)
+    {
+        const int nboxes = ba.size();
+        box_active.assign(nboxes, 0);
+        std::vector<amrex::IntVect> pshifts;
+        for (int ibox = 0; ibox < nboxes; ++ibox) {
+            if (box_error[ibox] <= tol) continue;
+            box_active[ibox] = 1;
+            // also activate the neighbours of ibox, including across periodic boundaries
+            const amrex::Box grown_box = amrex::grow(ba[ibox], ng);
+            geom.periodicShift(geom.Domain(), grown_box, pshifts);
+            pshifts.push_back(amrex::IntVect::TheZeroVector());
+            for (auto const& iv : pshifts) {
+                for (auto const& isect : ba.intersections(grown_box + iv)) {
+                    box_active[isect.first] = 1;
+                }
+            }
+        }
+    }
+
+    /**
+     * \brief Maximum of a value over the MPI ranks with a non-blocking reduction, so that the
+     * communication overlaps with the work done between Start and Wait.
+     */
+    class AsyncReduceRealMax
+    {
+    public:
+        AsyncReduceRealMax () = default;
+        AsyncReduceRealMax (AsyncReduceRealMax const&) = delete;
+        AsyncReduceRealMax& operator= (AsyncReduceRealMax const&) = delete;
+        ~AsyncReduceRealMax () { if (m_pending) Wait(); }
+
+        /** \brief Start the reduction of the value `local` of this rank */
+        void Start (amrex::Real const local)
+        {
+            AMREX_ALWAYS_ASSERT(!m_pending);
+            m_send = local;
+            m_recv = local;
+            m_pending = true;
+#ifdef AMREX_USE_MPI
+            MPI_Iallreduce(&m_send, &m_recv, 1, amrex::ParallelDescriptor::Mpi_typemap<amrex::Real>::type(),
+                           MPI_MAX, amrex::ParallelDescriptor::Communicator(), &m_request);
+#endif
+        }
+
+        /** \brief Whether a reduction was started and not waited for */
+        bool Pending () const { return m_pending; }
+
+        /** \brief Wait for the reduction started by Start and return the maximum over the ranks */
+        amrex::Real Wait ()
+        {
+            AMREX_ALWAYS_ASSERT(m_pending);
+#ifdef AMREX_USE_MPI
+            MPI_Wait(&m_request, MPI_STATUS_IGNORE);
+#endif
+            m_pending = false;
+            return m_recv;
+        }
+
+    private:
+        amrex::Real m_send = 0._rt;
+        amrex::Real m_recv = 0._rt;
+        bool m_pending = false;
+#ifdef AMREX_USE_MPI
+        MPI_Request m_request = MPI_REQUEST_NULL;
+#endif
+    };
+
+    /**
+     * \brief Solve the (small, dense) normal equations A gamma = b of the Anderson mixing
+     * with Gaussian elimination and partial pivoting. A small Tikhonov regularization is
+     * added to the diagonal, since the residual differences become nearly colinear close
+     * to convergence.
+     *
+     * \param[in]  A      n x n matrix of the dot products of the residual differences (row-major)
+     * \param[in]  b      dot products of the residual differences with the current residual
+     * \param[in]  n      number of residual differences in the history
+     * \param[out] gamma  mixing coefficients
+     */
+    void SolveAndersonSystem (amrex::Vector<amrex::Real> A, amrex::Vector<amrex::Real> b,
+                              int const n, amrex::Vector<amrex::Real>& gamma)
+    {
+        gamma.assign(n, 0._rt);
+        amrex::Real trace = 0._rt;
+        for (int i = 0; i < n; ++i) trace += A[i*n+i];
+        if (trace <= 0._rt) return;
+        amrex::Real const reg = 1.e-10_rt * trace / n;
+        for (int i = 0; i < n; ++i) A[i*n+i] += reg;
+
+        for (int col = 0; col < n; ++col) {
+            int piv = col;
+            for (int row = col+1; row < n; ++row) {
+                if (amrex::Math::abs(A[row*n+col]) > amrex::Math::abs(A[piv*n+col])) piv = row;
+            }
+            if (A[piv*n+col] == 0._rt) return; // singular system: fall back to a plain Picard step
+            if (piv != col) {
+                for (int j = 0; j < n; ++j) std::swap(A[col*n+j], A[piv*n+j]);
+                std::swap(b[col], b[piv]);
+            }
+            for (int row = col+1; row < n; ++row) {
+                amrex::Real const f = A[row*n+col] / A[col*n+col];
+                for (int j = col; j < n; ++j) A[row*n+j] -= f * A[col*n+j];
+                b[row] -= f * b[col];
+            }
+        }
+        for (int row = n-1; row >= 0; --row) {
+            amrex::Real sum = b[row];
+            for (int j = row+1; j < n; ++j) sum -= A[row*n+j] * gamma[j];
+            gamma[row] = sum / A[row*n+row];
+        }
+    }
+
+    /**
+     * \brief Average the three components of H_bias (and of H if coupling == 1) on the face
+     * of nodality iv_out, and store H_eff there. If assemble_bias is 0, the average of H_bias
+     * is read from H_bias_face, where it was stored by a previous call with assemble_bias = 1.
+     */
+    template <int coupling>
+    AMREX_GPU_DEVICE AMREX_FORCE_INLINE
+    void AssembleHeffOnFace (int i, int j, int k, amrex::IntVect const& iv_out,
+                             amrex::GpuArray<HBiasComponent, 3> const& H_bias,
+                             amrex::GpuArray<amrex::Array4<amrex::Real>, 3> const& H,
+                             int const assemble_bias,
+                             amrex::Array4<MagReal> const& H_bias_face,
+                             amrex::Array4<MagReal> const& H_eff_face)
+    {
+        for (int comp = 0; comp < 3; ++comp) {
+            amrex::IntVect const iv_in(comp == 0, comp == 1, comp == 2);
+            MagReal H_eff_comp;
+            if (assemble_bias) {
+                H_eff_comp = MacroscopicProperties::face_avg_to_face(i, j, k, 0, iv_in, iv_out, H_bias[comp]);
+                H_bias_face(i, j, k, comp) = H_eff_comp;
+            } else {
+                H_eff_comp = H_bias_face(i, j, k, comp);
+            }
+            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
+            if (coupling == 1) {
+                H_eff_comp += MacroscopicProperties::face_avg_to_face(i, j, k, 0, iv_in, iv_out, H[comp]);
+            }
+            H_eff_face(i, j, k, comp) = H_eff_comp;
+        }
+    }
+
+    /**
+     * \brief Assemble H_eff on the x-, y- and z-faces of a tile in a single launch
+     * (macroscopic.mag_H_eff_stage = 1), so that the M update kernels only stream it.
+     *
+     * \tparam     coupling       1 if H_maxwell is part of H_eff
+     * \param[in]  mfi            MFIter of the tile
+     * \param[in]  tbx,tby,tbz    tileboxes of the x-, y- and z-faces
+     * \param[in]  mp             macroscopic properties, used to skip the vacuum faces
+     * \param[in]  H_bias,H       components of H_bias and H on their own faces
+     * \param[in]  assemble_bias  1 to average H_bias and store it in H_bias_face, 0 to read it
+     * \param[in,out] H_bias_face H_bias averaged on the x-, y- and z-faces
+     * \param[out] H_eff_face     H_eff on the x-, y- and z-faces
+     */
+    template <int coupling>
+    void AssembleHeffFaces (amrex::MFIter const& mfi,
+                            amrex::Box const& tbx, amrex::Box const& tby, amrex::Box const& tbz,
+                            MacroscopicProperties const& mp,
+                            amrex::GpuArray<HBiasComponent, 3> const& H_bias,
+                            amrex::GpuArray<amrex::Array4<amrex::Real>, 3> const& H,
+                            int const assemble_bias,
+                            amrex::GpuArray<amrex::Array4<MagReal>, 3> const& H_bias_face,
+                            amrex::GpuArray<amrex::Array4<MagReal>, 3> const& H_eff_face)
+    {
+        mp.MagneticParallelFor(mfi, tbx, tby, tbz,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                AssembleHeffOnFace<coupling>(i, j, k, amrex::IntVect(1, 0, 0), H_bias, H, assemble_bias, H_bias_face[0], H_eff_face[0]);
+            },
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                AssembleHeffOnFace<coupling>(i, j, k, amrex::IntVect(0, 1, 0), H_bias, H, assemble_bias, H_bias_face[1], H_eff_face[1]);
+            },
+            [=] AMREX_GPU_DEVICE(int i, int j, int k) {
+                AssembleHeffOnFace<coupling>(i, j, k, amrex::IntVect(0, 0, 1), H_bias, H, assemble_bias, H_bias_face[2], H_eff_face[2]);
+            });
+    }
+}
+#endif
+
 /**
  * \brief Update H and M fields with iterative correction, over one timestep
  */
@@ -27,42 +227,70 @@ void FiniteDifferenceSolver::MacroscopicEvolveHM_2nd(
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
-    amrex::Real const dt,
+    int lev, amrex::Real const dt,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties) {
 
+    HardwareCounterRegion counters("LLG");
+
     if (m_fdtd_algo == MaxwellSolverAlgo::Yee){
-        MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm>(Mfield, Hfield, Bfield, H_biasfield, Efield, dt, macroscopic_properties);
+        // The coupling and the normalization of M are runtime options, but the kernels are compiled
+        // for each of their values, so that the branches on them are resolved at compile time
+        auto &warpx = WarpX::GetInstance();
+        int const coupling = warpx.mag_LLG_coupling;
+        int const M_normalization = warpx.mag_M_normalization;
+        if (coupling == 0 && M_normalization == 0) {
+            MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm, 0, 0>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 0 && M_normalization == 1) {
+            MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm, 0, 1>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 0 && M_normalization == 2) {
+            MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm, 0, 2>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 1 && M_normalization == 0) {
+            MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm, 1, 0>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 1 && M_normalization == 1) {
+            MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm, 1, 1>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        } else if (coupling == 1 && M_normalization == 2) {
+            MacroscopicEvolveHMCartesian_2nd<CartesianYeeAlgorithm, 1, 2>(Mfield, Hfield, Bfield, H_biasfield, Efield, lev, dt, macroscopic_properties);
+        }
     } else {
         amrex::Abort("Only yee algorithm is compatible for M updates.");
     }
 } // closes function MacroscopicEvolveHM_2nd
 #endif
 #ifdef WARPX_MAG_LLG
-template <typename T_Algo>
+template <typename T_Algo, int coupling, int M_normalization>
 void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Hfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> &Bfield,
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &H_biasfield, // H bias
     std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Efield,
-    amrex::Real const dt,
+    int lev, amrex::Real const dt,
     std::unique_ptr<MacroscopicProperties> const &macroscopic_properties) {
 
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
     // obtain the maximum relative amount we let M deviate from Ms before aborting
     amrex::Real mag_normalized_error = macroscopic_properties->getmag_normalized_error();
 
     auto &warpx = WarpX::GetInstance();
-    int coupling = warpx.mag_LLG_coupling;
-    int M_normalization = warpx.mag_M_normalization;
-
-    // build temporary vector<multifab,3> Mfield_prev, Mfield_error, a_temp, a_temp_static, b_temp_static
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Hfield_old;    // H^(old_time) before the current time step
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_old;    // M^(old_time) before the current time step
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_prev;   // M^(new_time) of the (r-1)th iteration
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> Mfield_error;  // The error of the M field between the two consecutive iterations
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> a_temp;        // right-hand side of vector a, see the documentation
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> a_temp_static; // α M^(old_time)/|M| in the right-hand side of vector a, see the documentation
-    std::array<std::unique_ptr<amrex::MultiFab>, 3> b_temp_static; // right-hand side of vector b, see the documentation
+
+    // reset the iteration statistics at the first call of a new time step
+    if (warpx.getistep(0) != m_llg_iter_step){
+        m_llg_iter_step = warpx.getistep(0);
+        m_llg_iter_count = 0;
+        m_llg_iter_calls = 0;
+    }
+
+    // get the persistent scratch vector<multifab,3> Hfield_old, Mfield_old, Mfield_prev, Mfield_error, a_temp, a_temp_static, b_temp_static
+    // (allocated on first use, and re-allocated only if the BoxArray or DistributionMapping has changed)
+    AllocateLLGScratchFields(Mfield, Hfield);
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Hfield_old    = m_Hfield_old;    // H^(old_time) before the current time step
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield_old    = m_Mfield_old;    // M^(old_time) before the current time step
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield_prev   = m_Mfield_prev;   // M^(new_time) of the (r-1)th iteration
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> &Mfield_error  = m_Mfield_error;  // The error of the M field between the two consecutive iterations
+    std::array<std::unique_ptr<MagMultiFab>, 3> &a_temp        = m_a_temp;        // right-hand side of vector a, see the documentation
+    std::array<std::unique_ptr<MagMultiFab>, 3> &a_temp_static = m_a_temp_static; // α M^(old_time)/|M| in the right-hand side of vector a, see the documentation
+    std::array<std::unique_ptr<MagMultiFab>, 3> &b_temp_static = m_b_temp_static; // right-hand side of vector b, see the documentation
 
     amrex::GpuArray<int, 3> const& mag_Ms_stag    = macroscopic_properties->mag_Ms_IndexType;
     amrex::GpuArray<int, 3> const& mag_alpha_stag = macroscopic_properties->mag_alpha_IndexType;
@@ -72,66 +300,83 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
     amrex::GpuArray<int, 3> const& My_stag        = macroscopic_properties->My_IndexType;
     amrex::GpuArray<int, 3> const& Mz_stag        = macroscopic_properties->Mz_IndexType;
     amrex::GpuArray<int, 3> const& macro_cr       = macroscopic_properties->macro_cr_ratio;
+    // read the precomputed face-centered material coefficients instead of interpolating them (macroscopic.mag_precompute_face_coefs = 1)
+    int const use_face_coefs = macroscopic_properties->getmag_precompute_face_coefs();
+    // assemble H_eff on the faces of each tile in one launch before the M update kernels (macroscopic.mag_H_eff_stage = 1)
+    int const use_H_eff_stage = macroscopic_properties->getmag_H_eff_stage();
+    if (use_H_eff_stage) AllocateLLGHeffFields(Mfield);
+    std::array<std::unique_ptr<MagMultiFab>, 3> &H_bias_face = m_H_bias_face; // H_bias averaged on the faces of M, constant over the time step
+    std::array<std::unique_ptr<MagMultiFab>, 3> &H_eff_face  = m_H_eff_face;  // H_eff on the faces of M, reassembled at each iteration
 
     // Initialize Hfield_old (H^(old_time)), Mfield_old (M^(old_time)), Mfield_prev (M^[(new_time),r-1]), Mfield_error
     for (int i = 0; i < 3; i++){
-        Hfield_old[i].reset(new MultiFab(Hfield[i]->boxArray(), Hfield[i]->DistributionMap(), 1, Hfield[i]->nGrow()));
-        Mfield_old[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        Mfield_prev[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        Mfield_error[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
         Mfield_error[i]->setVal(0.); // reset Mfield_error to zero
         MultiFab::Copy(*Hfield_old[i], *Hfield[i], 0, 0, 1, Hfield[i]->nGrow());
         MultiFab::Copy(*Mfield_old[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
         MultiFab::Copy(*Mfield_prev[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
     }
-    // initialize a_temp, a_temp_static, b_temp_static
-    for (int i = 0; i < 3; i++){
-        a_temp[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        a_temp_static[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-        b_temp_static[i].reset(new MultiFab(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, Mfield[i]->nGrow()));
-    }
+    // a_temp, a_temp_static and b_temp_static are only read on magnetic faces,
+    // where they are fully overwritten below, so they do not need to be reset
 
     // calculate the b_temp_static, a_temp_static
     for (MFIter mfi(*a_temp_static[0], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
-        auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
-        auto& mag_alpha_mf = macroscopic_properties->getmag_alpha_mf();
-        auto& mag_gamma_mf = macroscopic_properties->getmag_gamma_mf();
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
         // extract material properties
-        Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
-        Array4<Real> const& mag_alpha_arr = mag_alpha_mf.array(mfi);
-        Array4<Real> const& mag_gamma_arr = mag_gamma_mf.array(mfi);
+        MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
+        MacroPropertyArray const mag_alpha_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::alpha);
+        MacroPropertyArray const mag_gamma_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::gamma);
+        // precomputed face-centered material coefficients (only used if use_face_coefs)
+        Array4<Real const> const coef_xface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(0).const_array(mfi) : Array4<Real const>();
+        Array4<Real const> const coef_yface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(1).const_array(mfi) : Array4<Real const>();
+        Array4<Real const> const coef_zface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(2).const_array(mfi) : Array4<Real const>();
 
         // extract field data
         Array4<Real> const &M_xface = Mfield[0]->array(mfi);      // note M_xface include x,y,z components at |_x faces
         Array4<Real> const &M_yface = Mfield[1]->array(mfi);      // note M_yface include x,y,z components at |_y faces
         Array4<Real> const &M_zface = Mfield[2]->array(mfi);      // note M_zface include x,y,z components at |_z faces
-        Array4<Real> const &Hx_bias = H_biasfield[0]->array(mfi); // Hx_bias is the x component at |_x faces
-        Array4<Real> const &Hy_bias = H_biasfield[1]->array(mfi); // Hy_bias is the y component at |_y faces
-        Array4<Real> const &Hz_bias = H_biasfield[2]->array(mfi); // Hz_bias is the z component at |_z faces
+        // H_bias, read from H_biasfield or evaluated on the fly (warpx.mag_H_bias_on_the_fly)
+        amrex::GpuArray<HBiasComponent, 3> const H_bias = warpx.GetHBias(H_biasfield, lev, mfi);
+        HBiasComponent const Hx_bias = H_bias[0]; // Hx_bias is the x component at |_x faces
+        HBiasComponent const Hy_bias = H_bias[1]; // Hy_bias is the y component at |_y faces
+        HBiasComponent const Hz_bias = H_bias[2]; // Hz_bias is the z component at |_z faces
         Array4<Real> const &Hx_old = Hfield_old[0]->array(mfi);   // Hx_old is the x component at |_x faces
         Array4<Real> const &Hy_old = Hfield_old[1]->array(mfi);   // Hy_old is the y component at |_y faces
         Array4<Real> const &Hz_old = Hfield_old[2]->array(mfi);   // Hz_old is the z component at |_z faces
 
         // extract field data of a_temp_static and b_temp_static
-        Array4<Real> const &a_temp_static_xface = a_temp_static[0]->array(mfi);
-        Array4<Real> const &a_temp_static_yface = a_temp_static[1]->array(mfi);
-        Array4<Real> const &a_temp_static_zface = a_temp_static[2]->array(mfi);
-        Array4<Real> const &b_temp_static_xface = b_temp_static[0]->array(mfi);
-        Array4<Real> const &b_temp_static_yface = b_temp_static[1]->array(mfi);
-        Array4<Real> const &b_temp_static_zface = b_temp_static[2]->array(mfi);
+        Array4<MagReal> const &a_temp_static_xface = a_temp_static[0]->array(mfi);
+        Array4<MagReal> const &a_temp_static_yface = a_temp_static[1]->array(mfi);
+        Array4<MagReal> const &a_temp_static_zface = a_temp_static[2]->array(mfi);
+        Array4<MagReal> const &b_temp_static_xface = b_temp_static[0]->array(mfi);
+        Array4<MagReal> const &b_temp_static_yface = b_temp_static[1]->array(mfi);
+        Array4<MagReal> const &b_temp_static_zface = b_temp_static[2]->array(mfi);
 
         // extract tileboxes for which to loop
         Box const &tbx = mfi.tilebox(Mfield[0]->ixType().toIntVect()); /* just define which grid type */
         Box const &tby = mfi.tilebox(Mfield[1]->ixType().toIntVect());
         Box const &tbz = mfi.tilebox(Mfield[2]->ixType().toIntVect());
 
-        // loop over cells and update fields
-        amrex::ParallelFor(tbx, tby, tbz,
+        // H_eff on the faces of the tile (only used if use_H_eff_stage)
+        Array4<MagReal> const H_eff_xface = (use_H_eff_stage) ? H_eff_face[0]->array(mfi) : Array4<MagReal>();
+        Array4<MagReal> const H_eff_yface = (use_H_eff_stage) ? H_eff_face[1]->array(mfi) : Array4<MagReal>();
+        Array4<MagReal> const H_eff_zface = (use_H_eff_stage) ? H_eff_face[2]->array(mfi) : Array4<MagReal>();
+        if (use_H_eff_stage){
+            // H_bias does not change during the time step, its average on the faces is stored for the iterations
+            AssembleHeffFaces<coupling>(mfi, tbx, tby, tbz, *macroscopic_properties,
+                              {Hx_bias, Hy_bias, Hz_bias}, {Hx_old, Hy_old, Hz_old}, 1,
+                              {H_bias_face[0]->array(mfi), H_bias_face[1]->array(mfi), H_bias_face[2]->array(mfi)},
+                              {H_eff_xface, H_eff_yface, H_eff_zface});
+        }
+
+        // loop over cells and update fields (skipped on vacuum boxes, and restricted to the magnetic faces on mixed boxes)
+        macroscopic_properties->MagneticParallelFor(mfi, tbx, tby, tbz,
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                Real mag_Ms_arrx    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
-                Real mag_alpha_arrx = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mx_stag, macro_cr, i, j, k, 0);
-                Real mag_gamma_arrx = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mx_stag, macro_cr, i, j, k, 0);
+                Real mag_Ms_arrx    = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
+                Real mag_alpha_arrx = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mx_stag, macro_cr, i, j, k, 0);
+                Real mag_gamma_arrx = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mx_stag, macro_cr, i, j, k, 0);
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_arrx > 0._rt){
@@ -139,29 +384,37 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                     // when working on M_xface(i,j,k, 0:2) we have direct access to M_xface(i,j,k,0:2) and Hx(i,j,k)
                     // Hy and Hz can be acquired by interpolation
 
-                    // H_bias
-                    Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx_bias);
-                    Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy_bias);
-                    Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz_bias);
+                    // H_eff, read from the scratch assembled above (macroscopic.mag_H_eff_stage = 1) or averaged on the face here
+                    MagReal Hx_eff, Hy_eff, Hz_eff;
+                    if (use_H_eff_stage){
+                        Hx_eff = H_eff_xface(i, j, k, 0);
+                        Hy_eff = H_eff_xface(i, j, k, 1);
+                        Hz_eff = H_eff_xface(i, j, k, 2);
+                    } else {
+                        // H_bias
+                        Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx_bias);
+                        Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy_bias);
+                        Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz_bias);
 
-                    if (coupling == 1){
-                        // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
+                        if (coupling == 1){
+                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
 
-                        // H_maxwell
-                        Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx_old);
-                        Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy_old);
-                        Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz_old);
+                            // H_maxwell
+                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx_old);
+                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy_old);
+                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz_old);
+                        }
                     }
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
                     Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_xface(i, j, k, 0), 2._rt) + std::pow(M_xface(i, j, k, 1), 2._rt) + std::pow(M_xface(i, j, k, 2), 2._rt))
                                                               : mag_Ms_arrx;
                     // a_temp_static_coeff does not change in the current step for SATURATED materials; but it does change for UNSATURATED ones
-                    Real a_temp_static_coeff = mag_alpha_arrx / M_magnitude;
+                    MagReal a_temp_static_coeff = mag_alpha_arrx / M_magnitude;
 
                     // calculate the b_temp_static_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                     // while in real simulations, the input dt is actually dt/2.0)
-                    Real b_temp_static_coeff = - PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrx) / 2._rt;
+                    MagReal b_temp_static_coeff = (use_face_coefs) ? - coef_xface(i, j, k, MagFaceCoef::half_mu0_abs_gamma) : - PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrx) / 2._rt;
 
                     for (int comp=0; comp<3; ++comp) {
                         // calculate a_temp_static_xface
@@ -183,9 +436,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                Real mag_Ms_arry    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
-                Real mag_alpha_arry = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, My_stag, macro_cr, i, j, k, 0);
-                Real mag_gamma_arry = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, My_stag, macro_cr, i, j, k, 0);
+                Real mag_Ms_arry    = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
+                Real mag_alpha_arry = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, My_stag, macro_cr, i, j, k, 0);
+                Real mag_gamma_arry = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, My_stag, macro_cr, i, j, k, 0);
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_arry > 0._rt){
@@ -193,29 +446,37 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                     // when working on M_yface(i,j,k,0:2) we have direct access to M_yface(i,j,k,0:2) and Hy(i,j,k)
                     // Hy and Hz can be acquired by interpolation
 
-                    // H_bias
-                    Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx_bias);
-                    Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy_bias);
-                    Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz_bias);
+                    // H_eff, read from the scratch assembled above (macroscopic.mag_H_eff_stage = 1) or averaged on the face here
+                    MagReal Hx_eff, Hy_eff, Hz_eff;
+                    if (use_H_eff_stage){
+                        Hx_eff = H_eff_yface(i, j, k, 0);
+                        Hy_eff = H_eff_yface(i, j, k, 1);
+                        Hz_eff = H_eff_yface(i, j, k, 2);
+                    } else {
+                        // H_bias
+                        Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx_bias);
+                        Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy_bias);
+                        Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz_bias);
 
-                    if (coupling == 1){
-                        // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
+                        if (coupling == 1){
+                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
 
-                        // H_maxwell
-                        Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx_old);
-                        Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy_old);
-                        Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz_old);
+                            // H_maxwell
+                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx_old);
+                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy_old);
+                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz_old);
+                        }
                     }
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
                     // note the unsaturated case is less usefull in real devices
                     Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_yface(i, j, k, 0), 2._rt) + std::pow(M_yface(i, j, k, 1), 2._rt) + std::pow(M_yface(i, j, k, 2), 2._rt))
                                                               : mag_Ms_arry;
-                    Real a_temp_static_coeff = mag_alpha_arry / M_magnitude;
+                    MagReal a_temp_static_coeff = mag_alpha_arry / M_magnitude;
 
                     // calculate the b_temp_static_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                     // while in real simulations, the input dt is actually dt/2.0)
-                    Real b_temp_static_coeff = - PhysConst::mu0 * amrex::Math::abs(mag_gamma_arry) / 2._rt;
+                    MagReal b_temp_static_coeff = (use_face_coefs) ? - coef_yface(i, j, k, MagFaceCoef::half_mu0_abs_gamma) : - PhysConst::mu0 * amrex::Math::abs(mag_gamma_arry) / 2._rt;
 
                     for (int comp=0; comp<3; ++comp) {
                         // calculate a_temp_static_yface
@@ -237,9 +498,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
             [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                Real mag_Ms_arrz    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
-                Real mag_alpha_arrz = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mz_stag, macro_cr, i, j, k, 0);
-                Real mag_gamma_arrz = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mz_stag, macro_cr, i, j, k, 0);
+                Real mag_Ms_arrz    = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
+                Real mag_alpha_arrz = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mz_stag, macro_cr, i, j, k, 0);
+                Real mag_gamma_arrz = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mz_stag, macro_cr, i, j, k, 0);
 
                 // determine if the material is nonmagnetic or not
                 if (mag_Ms_arrz > 0._rt){
@@ -247,28 +508,36 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                     // when working on M_zface(i,j,k,0:2) we have direct access to M_zface(i,j,k,0:2) and Hz(i,j,k)
                     // Hy and Hz can be acquired by interpolation
 
-                    // H_bias
-                    Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx_bias);
-                    Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy_bias);
-                    Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz_bias);
+                    // H_eff, read from the scratch assembled above (macroscopic.mag_H_eff_stage = 1) or averaged on the face here
+                    MagReal Hx_eff, Hy_eff, Hz_eff;
+                    if (use_H_eff_stage){
+                        Hx_eff = H_eff_zface(i, j, k, 0);
+                        Hy_eff = H_eff_zface(i, j, k, 1);
+                        Hz_eff = H_eff_zface(i, j, k, 2);
+                    } else {
+                        // H_bias
+                        Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx_bias);
+                        Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy_bias);
+                        Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz_bias);
 
-                    if (coupling == 1){
-                        // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
+                        if (coupling == 1){
+                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
 
-                        // H_maxwell
-                        Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx_old);
-                        Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy_old);
-                        Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz_old);
+                            // H_maxwell
+                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx_old);
+                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy_old);
+                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz_old);
+                        }
                     }
 
                     // 0 = unsaturated; compute |M| locally.  1 = saturated; use M_s
                     Real M_magnitude = (M_normalization == 0) ? std::sqrt(std::pow(M_zface(i, j, k, 0), 2._rt) + std::pow(M_zface(i, j, k, 1), 2._rt) + std::pow(M_zface(i, j, k, 2), 2._rt))
                                                               : mag_Ms_arrz;
-                    Real a_temp_static_coeff = mag_alpha_arrz / M_magnitude;
+                    MagReal a_temp_static_coeff = mag_alpha_arrz / M_magnitude;
 
                     // calculate the b_temp_static_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                     // while in real simulations, the input dt is actually dt/2.0)
-                    Real b_temp_static_coeff = - PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrz) / 2._rt;
+                    MagReal b_temp_static_coeff = (use_face_coefs) ? - coef_zface(i, j, k, MagFaceCoef::half_mu0_abs_gamma) : - PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrz) / 2._rt;
 
                     for (int comp=0; comp<3; ++comp) {
                         // calculate a_temp_static_zface
@@ -297,27 +566,60 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
     amrex::Real M_tol = macroscopic_properties->getmag_tol();
     int stop_iter = 0;
 
+    // per-box convergence masking: boxes that have converged, and whose neighbours have converged too,
+    // are skipped in the following iterations. box_error and box_active are indexed by the global box index.
+    int const use_box_masking = macroscopic_properties->getmag_iter_box_masking();
+    int const nboxes = Mfield[0]->boxArray().size();
+    amrex::Vector<amrex::Real> box_error(nboxes, 0._rt);
+    amrex::Vector<int> box_active(nboxes, 1);
+
+    // Anderson mixing of the fixed-point iteration: M^(r+1) = G(M^(r)) - sum_j gamma_j dG_j,
+    // where G is the Picard update above and gamma minimizes |f_r - sum_j gamma_j dF_j|, f_r = G(M^(r)) - M^(r)
+    bool const use_anderson = (macroscopic_properties->getmag_iter_solver() == MagIterSolverAlgo::Anderson);
+    int const anderson_depth = macroscopic_properties->getmag_anderson_depth();
+    int anderson_nhist = 0; // number of valid entries in the history
+    int anderson_next = 0;  // slot of the history to be overwritten next
+    if (use_anderson) AllocateLLGAndersonFields(Mfield, anderson_depth);
+
+    // the convergence is only checked every check_interval iterations (and from the last allowed one on),
+    // which skips the reductions over the ranks and the device-to-host copies of the other iterations.
+    // With async_check, the reduction of the error is non-blocking: the next iteration is computed
+    // speculatively while it is in flight, and kept as the solution if the reduced error has converged.
+    int const check_interval = macroscopic_properties->getmag_iter_check_interval();
+    bool const async_check = macroscopic_properties->getmag_iter_async_check();
+    AsyncReduceRealMax async_error;
+    int async_error_iter = 0; // iteration whose error is being reduced
+
     // begin the iteration
     while (!stop_iter){
 
         warpx.FillBoundaryH(warpx.getngE());
 
         for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
-            auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
-            auto& mag_alpha_mf = macroscopic_properties->getmag_alpha_mf();
-            auto& mag_gamma_mf = macroscopic_properties->getmag_gamma_mf();
+            // the box has converged, as well as all its neighbours
+            if (use_box_masking && !box_active[mfi.index()]) continue;
+            // the fields are not updated in the boxes covered by the embedded boundary
+            if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+            BoxCostTimer box_timer(cost, mfi.index());
+
             // extract material properties
-            Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
-            Array4<Real> const& mag_alpha_arr = mag_alpha_mf.array(mfi);
-            Array4<Real> const& mag_gamma_arr = mag_gamma_mf.array(mfi);
+            MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
+            MacroPropertyArray const mag_alpha_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::alpha);
+            MacroPropertyArray const mag_gamma_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::gamma);
+            // precomputed face-centered material coefficients (only used if use_face_coefs)
+            Array4<Real const> const coef_xface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(0).const_array(mfi) : Array4<Real const>();
+            Array4<Real const> const coef_yface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(1).const_array(mfi) : Array4<Real const>();
+            Array4<Real const> const coef_zface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(2).const_array(mfi) : Array4<Real const>();
 
             // extract field data
             Array4<Real> const &M_xface = Mfield[0]->array(mfi);      // note M_xface include x,y,z components at |_x faces
             Array4<Real> const &M_yface = Mfield[1]->array(mfi);      // note M_yface include x,y,z components at |_y faces
             Array4<Real> const &M_zface = Mfield[2]->array(mfi);      // note M_zface include x,y,z components at |_z faces
-            Array4<Real> const &Hx_bias = H_biasfield[0]->array(mfi); // Hx_bias is the x component at |_x faces
-            Array4<Real> const &Hy_bias = H_biasfield[1]->array(mfi); // Hy_bias is the y component at |_y faces
-            Array4<Real> const &Hz_bias = H_biasfield[2]->array(mfi); // Hz_bias is the z component at |_z faces
+            // H_bias, read from H_biasfield or evaluated on the fly (warpx.mag_H_bias_on_the_fly)
+            amrex::GpuArray<HBiasComponent, 3> const H_bias = warpx.GetHBias(H_biasfield, lev, mfi);
+            HBiasComponent const Hx_bias = H_bias[0]; // Hx_bias is the x component at |_x faces
+            HBiasComponent const Hy_bias = H_bias[1]; // Hy_bias is the y component at |_y faces
+            HBiasComponent const Hz_bias = H_bias[2]; // Hz_bias is the z component at |_z faces
             Array4<Real> const &Hx = Hfield[0]->array(mfi);           // Hx is the x component at |_x faces
             Array4<Real> const &Hy = Hfield[1]->array(mfi);           // Hy is the y component at |_y faces
             Array4<Real> const &Hz = Hfield[2]->array(mfi);           // Hz is the z component at |_z faces
@@ -332,53 +634,73 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
             Array4<Real> const &M_error_xface = Mfield_error[0]->array(mfi);
             Array4<Real> const &M_error_yface = Mfield_error[1]->array(mfi);
             Array4<Real> const &M_error_zface = Mfield_error[2]->array(mfi);
-            Array4<Real> const &a_temp_xface = a_temp[0]->array(mfi);
-            Array4<Real> const &a_temp_yface = a_temp[1]->array(mfi);
-            Array4<Real> const &a_temp_zface = a_temp[2]->array(mfi);
-            Array4<Real> const &a_temp_static_xface = a_temp_static[0]->array(mfi);
-            Array4<Real> const &a_temp_static_yface = a_temp_static[1]->array(mfi);
-            Array4<Real> const &a_temp_static_zface = a_temp_static[2]->array(mfi);
-            Array4<Real> const &b_temp_static_xface = b_temp_static[0]->array(mfi);
-            Array4<Real> const &b_temp_static_yface = b_temp_static[1]->array(mfi);
-            Array4<Real> const &b_temp_static_zface = b_temp_static[2]->array(mfi);
+            Array4<MagReal> const &a_temp_xface = a_temp[0]->array(mfi);
+            Array4<MagReal> const &a_temp_yface = a_temp[1]->array(mfi);
+            Array4<MagReal> const &a_temp_zface = a_temp[2]->array(mfi);
+            Array4<MagReal> const &a_temp_static_xface = a_temp_static[0]->array(mfi);
+            Array4<MagReal> const &a_temp_static_yface = a_temp_static[1]->array(mfi);
+            Array4<MagReal> const &a_temp_static_zface = a_temp_static[2]->array(mfi);
+            Array4<MagReal> const &b_temp_static_xface = b_temp_static[0]->array(mfi);
+            Array4<MagReal> const &b_temp_static_yface = b_temp_static[1]->array(mfi);
+            Array4<MagReal> const &b_temp_static_zface = b_temp_static[2]->array(mfi);
 
             // extract tileboxes for which to loop
             Box const &tbx = mfi.tilebox(Hfield[0]->ixType().toIntVect()); /* just define which grid type */
             Box const &tby = mfi.tilebox(Hfield[1]->ixType().toIntVect());
             Box const &tbz = mfi.tilebox(Hfield[2]->ixType().toIntVect());
 
-            // loop over cells and update fields
-            amrex::ParallelFor(tbx, tby, tbz,
+            // H_eff on the faces of the tile (only used if use_H_eff_stage), assembled from the current H
+            // just before the update, so that it is still in cache when the tile is updated on CPU
+            Array4<MagReal> const H_eff_xface = (use_H_eff_stage) ? H_eff_face[0]->array(mfi) : Array4<MagReal>();
+            Array4<MagReal> const H_eff_yface = (use_H_eff_stage) ? H_eff_face[1]->array(mfi) : Array4<MagReal>();
+            Array4<MagReal> const H_eff_zface = (use_H_eff_stage) ? H_eff_face[2]->array(mfi) : Array4<MagReal>();
+            if (use_H_eff_stage){
+                AssembleHeffFaces<coupling>(mfi, tbx, tby, tbz, *macroscopic_properties,
+                                  {Hx_bias, Hy_bias, Hz_bias}, {Hx, Hy, Hz}, 0,
+                                  {H_bias_face[0]->array(mfi), H_bias_face[1]->array(mfi), H_bias_face[2]->array(mfi)},
+                                  {H_eff_xface, H_eff_yface, H_eff_zface});
+            }
+
+            // loop over cells and update fields (skipped on vacuum boxes, and restricted to the magnetic faces on mixed boxes)
+            macroscopic_properties->MagneticParallelFor(mfi, tbx, tby, tbz,
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                    Real mag_Ms_arrx    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
-                    Real mag_alpha_arrx = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mx_stag, macro_cr, i, j, k, 0);
-                    Real mag_gamma_arrx = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mx_stag, macro_cr, i, j, k, 0);
+                    Real mag_Ms_arrx    = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
+                    Real mag_alpha_arrx = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mx_stag, macro_cr, i, j, k, 0);
+                    Real mag_gamma_arrx = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mx_stag, macro_cr, i, j, k, 0);
 
                     // determine if the material is nonmagnetic or not
                     if (mag_Ms_arrx > 0._rt){
                         // when working on M_xface(i,j,k, 0:2) we have direct access to M_xface(i,j,k,0:2) and Hx(i,j,k)
                         // Hy and Hz can be acquired by interpolation
 
-                        // H_bias
-                        Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx_bias);
-                        Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy_bias);
-                        Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz_bias);
-
-                        if (coupling == 1){
-                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
-
-                            // H_maxwell
-                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx);
-                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy);
-                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz);
+                        // H_eff, read from the scratch assembled above (macroscopic.mag_H_eff_stage = 1) or averaged on the face here
+                        MagReal Hx_eff, Hy_eff, Hz_eff;
+                        if (use_H_eff_stage){
+                            Hx_eff = H_eff_xface(i, j, k, 0);
+                            Hy_eff = H_eff_xface(i, j, k, 1);
+                            Hz_eff = H_eff_xface(i, j, k, 2);
+                        } else {
+                            // H_bias
+                            Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx_bias);
+                            Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy_bias);
+                            Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz_bias);
+
+                            if (coupling == 1){
+                                // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
+
+                                // H_maxwell
+                                Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(1, 0, 0), Hx);
+                                Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(1, 0, 0), Hy);
+                                Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(1, 0, 0), Hz);
+                            }
                         }
 
                         // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                         // while in real simulations, the input dt is actually dt/2.0)
-                        Real a_temp_dynamic_coeff = PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrx) / 2._rt;
+                        MagReal a_temp_dynamic_coeff = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::half_mu0_abs_gamma) : PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrx) / 2._rt;
 
-                        amrex::GpuArray<amrex::Real,3> H_eff;
+                        amrex::GpuArray<MagReal,3> H_eff;
                         H_eff[0] = Hx_eff;
                         H_eff[1] = Hy_eff;
                         H_eff[2] = Hz_eff;
@@ -405,9 +727,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                             // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
                             // check the normalized error
                             if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                                amrex::Abort("Exceed the normalized error of the M_xface field");
+                                MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 0, i, j, k, M_magnitude_normalized, mag_Ms_arrx);
                             }
                             // normalize the M_xface field
                             M_xface(i, j, k, 0) /= M_magnitude_normalized;
@@ -417,9 +737,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                         else if (M_normalization == 0){
                             // check the normalized error
                             if (M_magnitude_normalized > (1._rt + mag_normalized_error)){
-                                printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                printf("M_magnitude_normalized = %f, Ms = %f\n", M_magnitude_normalized, mag_Ms_arrx);
-                                amrex::Abort("Caution: Unsaturated material has M_xface exceeding the saturation magnetization");
+                                MagDriftCheck::Record(drift, MagDriftCheck::Unsaturated, 0, i, j, k, M_magnitude_normalized, mag_Ms_arrx);
                             }
                             else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
                                 // normalize the M_xface field
@@ -439,34 +757,42 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                    Real mag_Ms_arry    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
-                    Real mag_alpha_arry = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, My_stag, macro_cr, i, j, k, 0);
-                    Real mag_gamma_arry = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, My_stag, macro_cr, i, j, k, 0);
+                    Real mag_Ms_arry    = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
+                    Real mag_alpha_arry = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, My_stag, macro_cr, i, j, k, 0);
+                    Real mag_gamma_arry = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, My_stag, macro_cr, i, j, k, 0);
 
                     // determine if the material is nonmagnetic or not
                     if (mag_Ms_arry > 0._rt){
                         // when working on M_yface(i,j,k,0:2) we have direct access to M_yface(i,j,k,0:2) and Hy(i,j,k)
                         // Hy and Hz can be acquired by interpolation
 
-                        // H_bias
-                        Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx_bias);
-                        Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy_bias);
-                        Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz_bias);
-
-                        if (coupling == 1){
-                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
-
-                            // H_maxwell
-                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx);
-                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy);
-                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz);
+                        // H_eff, read from the scratch assembled above (macroscopic.mag_H_eff_stage = 1) or averaged on the face here
+                        MagReal Hx_eff, Hy_eff, Hz_eff;
+                        if (use_H_eff_stage){
+                            Hx_eff = H_eff_yface(i, j, k, 0);
+                            Hy_eff = H_eff_yface(i, j, k, 1);
+                            Hz_eff = H_eff_yface(i, j, k, 2);
+                        } else {
+                            // H_bias
+                            Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx_bias);
+                            Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy_bias);
+                            Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz_bias);
+
+                            if (coupling == 1){
+                                // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
+
+                                // H_maxwell
+                                Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 1, 0), Hx);
+                                Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 1, 0), Hy);
+                                Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 1, 0), Hz);
+                            }
                         }
 
                         // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                         // while in real simulations, the input dt is actually dt/2.0)
-                        Real a_temp_dynamic_coeff = PhysConst::mu0 * amrex::Math::abs(mag_gamma_arry) / 2._rt;
+                        MagReal a_temp_dynamic_coeff = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::half_mu0_abs_gamma) : PhysConst::mu0 * amrex::Math::abs(mag_gamma_arry) / 2._rt;
 
-                        amrex::GpuArray<amrex::Real,3> H_eff;
+                        amrex::GpuArray<MagReal,3> H_eff;
                         H_eff[0] = Hx_eff;
                         H_eff[1] = Hy_eff;
                         H_eff[2] = Hz_eff;
@@ -493,9 +819,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                             // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
                             // check the normalized error
                             if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                                amrex::Abort("Exceed the normalized error of the M_yface field");
+                                MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 1, i, j, k, M_magnitude_normalized, mag_Ms_arry);
                             }
                             // normalize the M_yface field
                             M_yface(i, j, k, 0) /= M_magnitude_normalized;
@@ -505,9 +829,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                         else if (M_normalization == 0){
                             // check the normalized error
                             if (M_magnitude_normalized > 1._rt + mag_normalized_error){
-                                printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                printf("M_magnitude_normalized = %f, Ms = %f\n", M_magnitude_normalized, mag_Ms_arry);
-                                amrex::Abort("Caution: Unsaturated material has M_yface exceeding the saturation magnetization");
+                                MagDriftCheck::Record(drift, MagDriftCheck::Unsaturated, 1, i, j, k, M_magnitude_normalized, mag_Ms_arry);
                             }
                             else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
                                 // normalize the M_yface field
@@ -527,34 +849,42 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
 
-                    Real mag_Ms_arrz    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
-                    Real mag_alpha_arrz = CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mz_stag, macro_cr, i, j, k, 0);
-                    Real mag_gamma_arrz = CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mz_stag, macro_cr, i, j, k, 0);
+                    Real mag_Ms_arrz    = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
+                    Real mag_alpha_arrz = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::alpha) : CoarsenIO::Interp( mag_alpha_arr, mag_alpha_stag, Mz_stag, macro_cr, i, j, k, 0);
+                    Real mag_gamma_arrz = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::gamma) : CoarsenIO::Interp( mag_gamma_arr, mag_gamma_stag, Mz_stag, macro_cr, i, j, k, 0);
 
                     // determine if the material is nonmagnetic or not
                     if (mag_Ms_arrz > 0._rt){
                         // when working on M_zface(i,j,k,0:2) we have direct access to M_zface(i,j,k,0:2) and Hz(i,j,k)
                         // Hy and Hz can be acquired by interpolation
 
-                        // H_bias
-                        Real Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx_bias);
-                        Real Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy_bias);
-                        Real Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz_bias);
-
-                        if (coupling == 1){
-                            // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
-
-                            // H_maxwell
-                            Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx);
-                            Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy);
-                            Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz);
+                        // H_eff, read from the scratch assembled above (macroscopic.mag_H_eff_stage = 1) or averaged on the face here
+                        MagReal Hx_eff, Hy_eff, Hz_eff;
+                        if (use_H_eff_stage){
+                            Hx_eff = H_eff_zface(i, j, k, 0);
+                            Hy_eff = H_eff_zface(i, j, k, 1);
+                            Hz_eff = H_eff_zface(i, j, k, 2);
+                        } else {
+                            // H_bias
+                            Hx_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx_bias);
+                            Hy_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy_bias);
+                            Hz_eff = MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz_bias);
+
+                            if (coupling == 1){
+                                // H_eff = H_maxwell + H_bias + H_exchange + H_anisotropy ... (only the first two terms are considered here)
+
+                                // H_maxwell
+                                Hx_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(1, 0, 0), amrex::IntVect(0, 0, 1), Hx);
+                                Hy_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 1, 0), amrex::IntVect(0, 0, 1), Hy);
+                                Hz_eff += MacroscopicProperties::face_avg_to_face(i, j, k, 0, amrex::IntVect(0, 0, 1), amrex::IntVect(0, 0, 1), Hz);
+                            }
                         }
 
                         // calculate the a_temp_dynamic_coeff (it is divided by 2.0 because the derivation is based on an interger dt,
                         // while in real simulations, the input dt is actually dt/2.0)
-                        Real a_temp_dynamic_coeff = PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrz) / 2._rt;
+                        MagReal a_temp_dynamic_coeff = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::half_mu0_abs_gamma) : PhysConst::mu0 * amrex::Math::abs(mag_gamma_arrz) / 2._rt;
 
-                        amrex::GpuArray<amrex::Real,3> H_eff;
+                        amrex::GpuArray<MagReal,3> H_eff;
                         H_eff[0] = Hx_eff;
                         H_eff[1] = Hy_eff;
                         H_eff[2] = Hz_eff;
@@ -581,9 +911,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                             // saturated case; if |M| has drifted from M_s too much, abort.  Otherwise, normalize
                             // check the normalized error
                             if (amrex::Math::abs(1. - M_magnitude_normalized) > mag_normalized_error){
-                                printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                                amrex::Abort("Exceed the normalized error of the M_zface field");
+                                MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 2, i, j, k, M_magnitude_normalized, mag_Ms_arrz);
                             }
                             // normalize the M_zface field
                             M_zface(i, j, k, 0) /= M_magnitude_normalized;
@@ -593,9 +921,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                         else if (M_normalization == 0){
                             // check the normalized error
                             if (M_magnitude_normalized > 1._rt + mag_normalized_error){
-                                printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                printf("M_magnitude_normalized = %f, Ms = %f\n", M_magnitude_normalized, mag_Ms_arrz);
-                                amrex::Abort("Caution: Unsaturated material has M_zface exceeding the saturation magnetization");
+                                MagDriftCheck::Record(drift, MagDriftCheck::Unsaturated, 2, i, j, k, M_magnitude_normalized, mag_Ms_arrz);
                             }
                             else if (M_magnitude_normalized > 1._rt && M_magnitude_normalized <= 1._rt + mag_normalized_error){
                                 // normalize the M_zface field
@@ -616,6 +942,12 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
         // update H
         for (MFIter mfi(*Hfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+            // M is unchanged on inactive boxes, so that H would be unchanged as well
+            if (use_box_masking && !box_active[mfi.index()]) continue;
+            // the fields are not updated in the boxes covered by the embedded boundary
+            if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+            BoxCostTimer box_timer(cost, mfi.index());
+
             // Extract field data for this grid/tile
             Array4<Real> const &Hx = Hfield[0]->array(mfi);
             Array4<Real> const &Hy = Hfield[1]->array(mfi);
@@ -647,12 +979,14 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
             Box const &tbz = mfi.tilebox(Hfield[2]->ixType().toIntVect());
 
             // read in Ms to decide if the grid is magnetic or not
-            auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
-            Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
+            MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
 
-            // mu_mf will be imported but will only be called at grids where Ms == 0
-            auto& mu_mf = macroscopic_properties->getmu_mf();
-            Array4<Real> const& mu_arr = mu_mf.array(mfi);
+            // mu will be imported but will only be called at grids where Ms == 0
+            MacroPropertyArray const mu_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::mu);
+            // precomputed face-centered material coefficients (only used if use_face_coefs)
+            Array4<Real const> const coef_xface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(0).const_array(mfi) : Array4<Real const>();
+            Array4<Real const> const coef_yface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(1).const_array(mfi) : Array4<Real const>();
+            Array4<Real const> const coef_zface = (use_face_coefs) ? macroscopic_properties->getmag_face_coefs_mf(2).const_array(mfi) : Array4<Real const>();
 
             amrex::Real const mu0_inv = 1. / PhysConst::mu0;
 
@@ -660,9 +994,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
             amrex::ParallelFor(tbx, tby, tbz,
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
-                    Real mag_Ms_arrx    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
+                    Real mag_Ms_arrx    = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mx_stag, macro_cr, i, j, k, 0);
                     if (mag_Ms_arrx == 0._rt){ // nonmagnetic region
-                        Real mu_arrx    = CoarsenIO::Interp( mu_arr, mu_stag, Mx_stag, macro_cr, i, j, k, 0);
+                        Real mu_arrx    = (use_face_coefs) ? coef_xface(i, j, k, MagFaceCoef::mu) : CoarsenIO::Interp( mu_arr, mu_stag, Mx_stag, macro_cr, i, j, k, 0);
                         Hx(i, j, k) = Hx_old(i, j, k) + 1. / mu_arrx * dt * (T_Algo::UpwardDz(Ey, coefs_z, n_coefs_z, i, j, k)
                                                                            - T_Algo::UpwardDy(Ez, coefs_y, n_coefs_y, i, j, k));
                     } else if (mag_Ms_arrx > 0){ // magnetic region
@@ -675,9 +1009,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                 },
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
-                    Real mag_Ms_arry    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
+                    Real mag_Ms_arry    = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, My_stag, macro_cr, i, j, k, 0);
                     if (mag_Ms_arry == 0._rt){ // nonmagnetic region
-                        Real mu_arry    = CoarsenIO::Interp( mu_arr, mu_stag, My_stag, macro_cr, i, j, k, 0);
+                        Real mu_arry    = (use_face_coefs) ? coef_yface(i, j, k, MagFaceCoef::mu) : CoarsenIO::Interp( mu_arr, mu_stag, My_stag, macro_cr, i, j, k, 0);
                         Hy(i, j, k) = Hy_old(i, j, k) + 1. / mu_arry * dt * (T_Algo::UpwardDx(Ez, coefs_x, n_coefs_x, i, j, k)
                                                                            - T_Algo::UpwardDz(Ex, coefs_z, n_coefs_z, i, j, k));
                     } else if (mag_Ms_arry > 0){ // magnetic region
@@ -690,9 +1024,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                 },
 
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) {
-                    Real mag_Ms_arrz    = CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
+                    Real mag_Ms_arrz    = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::Ms) : CoarsenIO::Interp( mag_Ms_arr, mag_Ms_stag, Mz_stag, macro_cr, i, j, k, 0);
                     if (mag_Ms_arrz == 0._rt){ // nonmagnetic region
-                        Real mu_arrz    = CoarsenIO::Interp( mu_arr, mu_stag, Mz_stag, macro_cr, i, j, k, 0);
+                        Real mu_arrz    = (use_face_coefs) ? coef_zface(i, j, k, MagFaceCoef::mu) : CoarsenIO::Interp( mu_arr, mu_stag, Mz_stag, macro_cr, i, j, k, 0);
                         Hz(i, j, k) = Hz_old(i, j, k) + 1. / mu_arrz * dt * (T_Algo::UpwardDy(Ex, coefs_y, n_coefs_y, i, j, k)
                                                                            - T_Algo::UpwardDx(Ey, coefs_x, n_coefs_x, i, j, k));
                     } else if (mag_Ms_arrz > 0){ // magnetic region
@@ -707,18 +1041,84 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
             );
         }
 
+        bool const check_now = ((M_iter + 1) % check_interval == 0) || (M_iter >= M_max_iter);
+
         // Check the error between Mfield and Mfield_prev and decide whether another iteration is needed
-        amrex::Real M_iter_maxerror = -1._rt;
-        for (int iface = 0; iface < 3; iface++){
-            for (int jcomp = 0; jcomp < 3; jcomp++){
-                Real M_iter_error = Mfield_error[iface]->norm0(jcomp);
-                if (M_iter_error >= M_iter_maxerror){
-                    M_iter_maxerror = M_iter_error;
+        amrex::Real M_iter_maxerror = -1._rt; // negative if not known in this iteration
+        int error_iter = M_iter;              // iteration of M_iter_maxerror
+        bool converged = false;
+        int n_active_boxes = nboxes;
+        if (check_now){
+            // abort if |M| has drifted too much from Ms on any face since the last check
+            drift_check.Check(mag_normalized_error);
+        }
+        if (check_now && use_box_masking){
+            // maximum error on each local box that was updated in this iteration;
+            // inactive boxes keep the (converged) error of the last iteration in which they were updated
+            for (MFIter mfi(*Mfield_error[0]); mfi.isValid(); ++mfi){
+                if (!box_active[mfi.index()]) continue;
+                amrex::Real err = 0._rt;
+                for (int iface = 0; iface < 3; iface++){
+                    Box const& vbx = Mfield_error[iface]->box(mfi.index());
+                    for (int jcomp = 0; jcomp < 3; jcomp++){
+                        err = amrex::max(err, (*Mfield_error[iface])[mfi].maxabs<RunOn::Device>(vbx, jcomp));
+                    }
+                }
+                box_error[mfi.index()] = err;
+            }
+            // each box is owned by a single rank, and the error is non-negative
+            amrex::Vector<amrex::Real> box_error_local(nboxes, 0._rt);
+            for (MFIter mfi(*Mfield_error[0]); mfi.isValid(); ++mfi){
+                box_error_local[mfi.index()] = box_error[mfi.index()];
+            }
+            ParallelDescriptor::ReduceRealMax(box_error_local.data(), nboxes);
+            box_error = box_error_local;
+
+            for (int ibox = 0; ibox < nboxes; ++ibox){
+                M_iter_maxerror = amrex::max(M_iter_maxerror, box_error[ibox]);
+            }
+            converged = (M_iter_maxerror <= M_tol);
+            // only boxes that are still iterating, and their neighbours, take part in the next iteration
+            BuildActiveBoxMask(amrex::convert(Mfield[0]->boxArray(), IntVect::TheZeroVector()),
+                               macroscopic_properties->getpatch_geom(), Hfield[0]->nGrowVect(), box_error, M_tol, box_active);
+            n_active_boxes = 0;
+            for (int ibox = 0; ibox < nboxes; ++ibox) n_active_boxes += box_active[ibox];
+        } else if (check_now){
+            // maximum over the faces and components of this rank, followed by a single reduction over the ranks
+            amrex::Real local_maxerror = 0._rt;
+            for (int iface = 0; iface < 3; iface++){
+                for (int jcomp = 0; jcomp < 3; jcomp++){
+                    local_maxerror = amrex::max(local_maxerror, Mfield_error[iface]->norm0(jcomp, 0, true));
+                }
+            }
+            if (async_check){
+                // the error of the previous check has arrived during this iteration;
+                // if it has converged, the current (speculative) iterate is kept
+                if (async_error.Pending()){
+                    error_iter = async_error_iter;
+                    M_iter_maxerror = async_error.Wait();
+                    converged = (M_iter_maxerror <= M_tol);
+                }
+                if (!converged){
+                    if (M_iter >= M_max_iter){
+                        // no further iteration is allowed, the error of this one is needed now
+                        error_iter = M_iter;
+                        M_iter_maxerror = local_maxerror;
+                        ParallelDescriptor::ReduceRealMax(M_iter_maxerror);
+                        converged = (M_iter_maxerror <= M_tol);
+                    } else {
+                        async_error_iter = M_iter;
+                        async_error.Start(local_maxerror);
+                    }
                 }
+            } else {
+                M_iter_maxerror = local_maxerror;
+                ParallelDescriptor::ReduceRealMax(M_iter_maxerror);
+                converged = (M_iter_maxerror <= M_tol);
             }
         }
 
-        if (M_iter_maxerror <= M_tol){
+        if (converged){
 
             stop_iter = 1;
 
@@ -726,9 +1126,9 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
             if (M_normalization == 2){
 
                 for (MFIter mfi(*Mfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
-                    auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
+                    BoxCostTimer box_timer(cost, mfi.index());
                     // extract material properties
-                    Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
+                    MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
 
                     // extract field data
                     Array4<Real> const &M_xface = Mfield[0]->array(mfi); // note M_xface include x,y,z components at |_x faces
@@ -755,9 +1155,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                                 // check the normalized error
                                 if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                    printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                    printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                                    amrex::Abort("Exceed the normalized error of the M_xface field");
+                                    MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 0, i, j, k, M_magnitude_normalized, mag_Ms_arrx);
                                 }
                                 // normalize the M_xface field
                                 M_xface(i, j, k, 0) /= M_magnitude_normalized;
@@ -779,9 +1177,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                                 // check the normalized error
                                 if (amrex::Math::abs(1._rt - M_magnitude_normalized) > mag_normalized_error){
-                                    printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                    printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                                    amrex::Abort("Exceed the normalized error of the M_yface field");
+                                    MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 1, i, j, k, M_magnitude_normalized, mag_Ms_arry);
                                 }
                                 // normalize the M_yface field
                                 M_yface(i, j, k, 0) /= M_magnitude_normalized;
@@ -803,9 +1199,7 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
 
                                 // check the normalized error
                                 if (amrex::Math::abs(1. - M_magnitude_normalized) > mag_normalized_error){
-                                    printf("i = %d, j=%d, k=%d\n", i, j, k);
-                                    printf("M_magnitude_normalized = %f, mag_normalized_error=%f\n", M_magnitude_normalized, mag_normalized_error);
-                                    amrex::Abort("Exceed the normalized error of the M_zface field");
+                                    MagDriftCheck::Record(drift, MagDriftCheck::Saturated, 2, i, j, k, M_magnitude_normalized, mag_Ms_arrz);
                                 }
                                 // normalize the M_zface field
                                 M_zface(i, j, k, 0) /= M_magnitude_normalized;
@@ -814,9 +1208,63 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
                             }
                         });
                 }
+                drift_check.Check(mag_normalized_error);
             }
         }
         else{
+            if (use_anderson){
+                // current residual f_r = G(M^(r)) - M^(r)
+                for (int i = 0; i < 3; i++){
+                    MultiFab::LinComb(*m_anderson_F_cur[i], 1._rt, *Mfield[i], 0, -1._rt, *Mfield_prev[i], 0, 0, 3, 0);
+                }
+                if (M_iter > 0){
+                    // dF = f_r - f_(r-1), dG = G(M^(r)) - G(M^(r-1))
+                    for (int i = 0; i < 3; i++){
+                        MultiFab::LinComb(*m_anderson_dF[anderson_next][i], 1._rt, *m_anderson_F_cur[i], 0, -1._rt, *m_anderson_F_prev[i], 0, 0, 3, 0);
+                        MultiFab::LinComb(*m_anderson_dG[anderson_next][i], 1._rt, *Mfield[i], 0, -1._rt, *m_anderson_G_prev[i], 0, 0, 3, 0);
+                    }
+                    anderson_next = (anderson_next + 1) % anderson_depth;
+                    anderson_nhist = amrex::min(anderson_nhist + 1, anderson_depth);
+                }
+                for (int i = 0; i < 3; i++){
+                    MultiFab::Copy(*m_anderson_F_prev[i], *m_anderson_F_cur[i], 0, 0, 3, 0);
+                    MultiFab::Copy(*m_anderson_G_prev[i], *Mfield[i], 0, 0, 3, 0);
+                }
+
+                if (anderson_nhist > 0){
+                    // normal equations of the least-squares problem, with a single reduction over the ranks
+                    int const n = anderson_nhist;
+                    amrex::Vector<amrex::Real> A_b(n*n + n, 0._rt);
+                    for (int i = 0; i < 3; i++){
+                        for (int p = 0; p < n; ++p){
+                            for (int q = p; q < n; ++q){
+                                A_b[p*n+q] += MultiFab::Dot(*m_anderson_dF[p][i], 0, *m_anderson_dF[q][i], 0, 3, 0, true);
+                            }
+                            A_b[n*n+p] += MultiFab::Dot(*m_anderson_dF[p][i], 0, *m_anderson_F_cur[i], 0, 3, 0, true);
+                        }
+                    }
+                    ParallelDescriptor::ReduceRealSum(A_b.data(), n*n + n);
+                    for (int p = 0; p < n; ++p){
+                        for (int q = 0; q < p; ++q) A_b[p*n+q] = A_b[q*n+p];
+                    }
+                    amrex::Vector<amrex::Real> A(A_b.begin(), A_b.begin() + n*n);
+                    amrex::Vector<amrex::Real> b(A_b.begin() + n*n, A_b.end());
+                    amrex::Vector<amrex::Real> gamma;
+                    SolveAndersonSystem(A, b, n, gamma);
+
+                    for (int p = 0; p < n; ++p){
+                        for (int i = 0; i < 3; i++){
+                            MultiFab::Saxpy(*Mfield[i], -gamma[p], *m_anderson_dG[p][i], 0, 0, 3, 0);
+                            // H depends linearly on M on magnetic faces, H = H^(old_time) + curl(E) - M + M^(old_time),
+                            // while dG vanishes on non-magnetic faces, where M is not updated
+                            if (coupling == 1){
+                                MultiFab::Saxpy(*Hfield[i], gamma[p], *m_anderson_dG[p][i], i, 0, 1, 0);
+                            }
+                        }
+                    }
+                }
+            }
+
             // Copy Mfield to Mfield_previous
             for (int i = 0; i < 3; i++){
                 MultiFab::Copy(*Mfield_prev[i], *Mfield[i], 0, 0, 3, Mfield[i]->nGrow());
@@ -829,13 +1277,26 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
         }
         else{
             M_iter++;
-            amrex::Print() << "Finish " << M_iter << " times iteration with M_iter_maxerror = " << M_iter_maxerror << " and M_tol = " << M_tol << std::endl;
+            amrex::Print() << "Finish " << M_iter << " times iteration";
+            if (M_iter_maxerror >= 0._rt){
+                amrex::Print() << " with M_iter_maxerror = " << M_iter_maxerror;
+                if (error_iter != M_iter - 1) amrex::Print() << " (of iteration " << error_iter + 1 << ")";
+            }
+            amrex::Print() << " and M_tol = " << M_tol;
+            if (use_box_masking) amrex::Print() << " (" << n_active_boxes << " of " << nboxes << " boxes still active)";
+            amrex::Print() << std::endl;
         }
 
     } // end the iteration
 
+    m_llg_iter_count += M_iter;
+    m_llg_iter_calls++;
+
     // update B
     for (MFIter mfi(*Bfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi){
+        // the fields are not updated in the boxes covered by the embedded boundary
+        if (getEBBoxType(mfi) == EBBoxType::Covered) continue;
+        BoxCostTimer box_timer(cost, mfi.index());
         // Extract field data for this grid/tile
         Array4<Real> const &Hx = Hfield[0]->array(mfi);
         Array4<Real> const &Hy = Hfield[1]->array(mfi);
@@ -853,12 +1314,10 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
         Box const &tbz = mfi.tilebox(Bfield[2]->ixType().toIntVect());
 
         // read in Ms to decide if the grid is magnetic or not
-        auto& mag_Ms_mf = macroscopic_properties->getmag_Ms_mf();
-        Array4<Real> const& mag_Ms_arr = mag_Ms_mf.array(mfi);
+        MacroPropertyArray const mag_Ms_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
 
-        // mu_mf will be imported but will only be called at grids where Ms == 0
-        auto& mu_mf = macroscopic_properties->getmu_mf();
-        Array4<Real> const& mu_arr = mu_mf.array(mfi);
+        // mu will be imported but will only be called at grids where Ms == 0
+        MacroPropertyArray const mu_arr = macroscopic_properties->getproperty_arr(mfi, MacroProp::mu);
 
         // Loop over the cells and update the fields
         amrex::ParallelFor(tbx, tby, tbz,
@@ -897,3 +1356,123 @@ void FiniteDifferenceSolver::MacroscopicEvolveHMCartesian_2nd(
     }
 }
 #endif
+
+#ifdef WARPX_MAG_LLG
+void FiniteDifferenceSolver::AllocateLLGScratchFields (
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield,
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Hfield) {
+
+    for (int i = 0; i < 3; i++){
+        // only (re)allocate if the layout of M or H has changed since the last call, e.g. after load balancing
+        bool const H_is_valid = m_Hfield_old[i]
+            && m_Hfield_old[i]->boxArray() == Hfield[i]->boxArray()
+            && m_Hfield_old[i]->DistributionMap() == Hfield[i]->DistributionMap()
+            && m_Hfield_old[i]->nGrowVect() == Hfield[i]->nGrowVect();
+        if (!H_is_valid){
+            m_Hfield_old[i] = std::make_unique<MultiFab>(Hfield[i]->boxArray(), Hfield[i]->DistributionMap(), 1, Hfield[i]->nGrowVect());
+        }
+
+        bool const M_is_valid = m_Mfield_old[i]
+            && m_Mfield_old[i]->boxArray() == Mfield[i]->boxArray()
+            && m_Mfield_old[i]->DistributionMap() == Mfield[i]->DistributionMap()
+            && m_Mfield_old[i]->nGrowVect() == Mfield[i]->nGrowVect();
+        if (!M_is_valid){
+            BoxArray const& ba = Mfield[i]->boxArray();
+            DistributionMapping const& dm = Mfield[i]->DistributionMap();
+            IntVect const ng = Mfield[i]->nGrowVect();
+            m_Mfield_old[i]    = std::make_unique<MultiFab>(ba, dm, 3, ng);
+            m_Mfield_prev[i]   = std::make_unique<MultiFab>(ba, dm, 3, ng);
+            m_Mfield_error[i]  = std::make_unique<MultiFab>(ba, dm, 3, ng);
+            m_a_temp[i]        = std::make_unique<MagMultiFab>(ba, dm, 3, ng);
+            m_a_temp_static[i] = std::make_unique<MagMultiFab>(ba, dm, 3, ng);
+            m_b_temp_static[i] = std::make_unique<MagMultiFab>(ba, dm, 3, ng);
+        }
+    }
+}
+
+void FiniteDifferenceSolver::AllocateLLGAndersonFields (
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield,
+    int const depth) {
+
+    bool is_valid = static_cast<int>(m_anderson_dF.size()) == depth;
+    for (int i = 0; i < 3; i++){
+        is_valid = is_valid && m_anderson_F_prev[i]
+            && m_anderson_F_prev[i]->boxArray() == Mfield[i]->boxArray()
+            && m_anderson_F_prev[i]->DistributionMap() == Mfield[i]->DistributionMap();
+    }
+    if (is_valid) return;
+
+    m_anderson_dF.resize(depth);
+    m_anderson_dG.resize(depth);
+    for (int i = 0; i < 3; i++){
+        BoxArray const& ba = Mfield[i]->boxArray();
+        DistributionMapping const& dm = Mfield[i]->DistributionMap();
+        // the mixing only acts on the valid cells, the guard cells of M are not read by the update
+        m_anderson_F_prev[i] = std::make_unique<MultiFab>(ba, dm, 3, 0);
+        m_anderson_G_prev[i] = std::make_unique<MultiFab>(ba, dm, 3, 0);
+        m_anderson_F_cur[i]  = std::make_unique<MultiFab>(ba, dm, 3, 0);
+        for (int p = 0; p < depth; ++p){
+            m_anderson_dF[p][i] = std::make_unique<MultiFab>(ba, dm, 3, 0);
+            m_anderson_dG[p][i] = std::make_unique<MultiFab>(ba, dm, 3, 0);
+        }
+    }
+}
+
+void FiniteDifferenceSolver::AllocateLLGHeffFields (
+    std::array<std::unique_ptr<amrex::MultiFab>, 3> const &Mfield) {
+
+    for (int i = 0; i < 3; i++){
+        bool const is_valid = m_H_eff_face[i]
+            && m_H_eff_face[i]->boxArray() == Mfield[i]->boxArray()
+            && m_H_eff_face[i]->DistributionMap() == Mfield[i]->DistributionMap();
+        if (is_valid) continue;
+        // H_eff is only read on the faces updated by the kernels, no guard cells are needed
+        m_H_bias_face[i] = std::make_unique<MagMultiFab>(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, 0);
+        m_H_eff_face[i]  = std::make_unique<MagMultiFab>(Mfield[i]->boxArray(), Mfield[i]->DistributionMap(), 3, 0);
+    }
+}
+
+void FiniteDifferenceSolver::ClearLLGScratchFields () {
+    m_anderson_dF.clear();
+    m_anderson_dG.clear();
+    for (int i = 0; i < 3; i++){
+        m_anderson_F_prev[i].reset();
+        m_anderson_G_prev[i].reset();
+        m_anderson_F_cur[i].reset();
+        m_Hfield_old[i].reset();
+        m_Mfield_old[i].reset();
+        m_Mfield_prev[i].reset();
+        m_Mfield_error[i].reset();
+        m_a_temp[i].reset();
+        m_a_temp_static[i].reset();
+        m_b_temp_static[i].reset();
+        m_H_bias_face[i].reset();
+        m_H_eff_face[i].reset();
+    }
+}
+
+amrex::Long FiniteDifferenceSolver::LLGScratchBytes () const {
+    amrex::Long nbytes = 0;
+    auto add_bytes = [&nbytes] (auto const* mf) {
+        if (mf == nullptr) return;
+        for (MFIter mfi(*mf); mfi.isValid(); ++mfi){
+            nbytes += (*mf)[mfi].nBytes();
+        }
+    };
+    for (int i = 0; i < 3; i++){
+        for (auto const* mf : {m_Hfield_old[i].get(), m_Mfield_old[i].get(), m_Mfield_prev[i].get(),
+                               m_Mfield_error[i].get(), m_anderson_F_prev[i].get(),
+                               m_anderson_G_prev[i].get(), m_anderson_F_cur[i].get(),
+                               m_llg_H_avg[i].get()}){
+            add_bytes(mf);
+        }
+        for (auto const* mf : {m_a_temp[i].get(), m_a_temp_static[i].get(), m_b_temp_static[i].get(),
+                               m_H_bias_face[i].get(), m_H_eff_face[i].get()}){
+            add_bytes(mf);
+        }
+        for (auto const& hist : m_anderson_dF) add_bytes(hist[i].get());
+        for (auto const& hist : m_anderson_dG) add_bytes(hist[i].get());
+    }
+    return nbytes;
+}
+#endif
@@ -1,10 +1,17 @@
 #include "MacroscopicProperties.H"
 #include "WarpX.H"
 #include "Utils/WarpXUtil.H"
+#include "Utils/CoarsenIO.H"
+#include "Utils/ColdFields.H"
+#include "Parallelization/WarpXMigrate.H"
 
 #include <AMReX_ParmParse.H>
+#include <AMReX_Reduce.H>
+#include <AMReX_Scan.H>
 
+#include <map>
 #include <memory>
+#include <type_traits>
 
 using namespace amrex;
 
@@ -83,6 +90,10 @@ MacroscopicProperties::ReadParameters ()
                                  makeParser(m_str_mu_function,{"x","y","z"}));
     }
 
+    pp_macroscopic.query("material_id_storage", m_material_id_storage);
+    pp_macroscopic.query("uniform_box_kernels", m_uniform_box_kernels);
+    pp_macroscopic.query("precompute_E_coefs", m_precompute_E_coefs);
+
 #ifdef WARPX_MAG_LLG
     pp_macroscopic.get("mag_Ms_init_style", m_mag_Ms_s);
     if (m_mag_Ms_s == "constant") pp_macroscopic.get("mag_Ms", m_mag_Ms);
@@ -123,6 +134,39 @@ MacroscopicProperties::ReadParameters ()
     m_mag_tol = 0.0001;
     pp_macroscopic.query("mag_tol",m_mag_tol);
 
+    m_mag_iter_box_masking = 0;
+    pp_macroscopic.query("mag_iter_box_masking",m_mag_iter_box_masking);
+
+    m_mag_iter_check_interval = 1;
+    pp_macroscopic.query("mag_iter_check_interval",m_mag_iter_check_interval);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_iter_check_interval > 0,
+        "macroscopic.mag_iter_check_interval must be positive");
+
+    m_mag_iter_async_check = 0;
+    pp_macroscopic.query("mag_iter_async_check",m_mag_iter_async_check);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_iter_async_check == 0 || m_mag_iter_box_masking == 0,
+        "macroscopic.mag_iter_async_check = 1 is not compatible with macroscopic.mag_iter_box_masking = 1");
+
+    m_mag_sparse_update = 1;
+    pp_macroscopic.query("mag_sparse_update",m_mag_sparse_update);
+
+    m_mag_precompute_face_coefs = 0;
+    pp_macroscopic.query("mag_precompute_face_coefs",m_mag_precompute_face_coefs);
+
+    m_mag_H_eff_stage = 0;
+    pp_macroscopic.query("mag_H_eff_stage",m_mag_H_eff_stage);
+
+    m_mag_iter_solver = GetAlgorithmInteger(pp_macroscopic, "mag_iter_solver");
+
+    m_mag_anderson_depth = 3;
+    pp_macroscopic.query("mag_anderson_depth",m_mag_anderson_depth);
+    if (m_mag_iter_solver == MagIterSolverAlgo::Anderson) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_anderson_depth > 0,
+            "macroscopic.mag_anderson_depth must be positive");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_mag_iter_box_masking == 0,
+            "macroscopic.mag_iter_solver = anderson is not compatible with macroscopic.mag_iter_box_masking = 1");
+    }
+
 #endif
 }
 
@@ -132,183 +176,791 @@ MacroscopicProperties::InitData ()
     amrex::Print() << "we are in init data of macro \n";
     auto & warpx = WarpX::GetInstance();
 
-    // Get BoxArray and DistributionMap of warpx instant.
-    int lev = 0;
+    // the material properties are defined on the fine patch of each level and,
+    // for lev > 0, on its coarse patch, on which the macroscopic solvers are also called
+    ResizePatches(2 * (warpx.finestLevel() + 1));
+    for (int lev = 0; lev <= warpx.finestLevel(); ++lev) {
+        InitPatchData(lev, PatchType::fine, warpx.DistributionMap(lev));
+        if (lev > 0) InitPatchData(lev, PatchType::coarse, warpx.DistributionMap(lev));
+    }
+    SetPatch(0, PatchType::fine);
+
+    // all the material properties are cell-centered, in both storage modes
+    IntVect const macro_stag = getpatch_boxArray().ixType().toIntVect();
+    IntVect sigma_stag = macro_stag;
+    IntVect epsilon_stag = macro_stag;
+    IntVect mu_stag = macro_stag;
+    IntVect Ex_stag = warpx.getEfield_fp(0,0).ixType().toIntVect();
+    IntVect Ey_stag = warpx.getEfield_fp(0,1).ixType().toIntVect();
+    IntVect Ez_stag = warpx.getEfield_fp(0,2).ixType().toIntVect();
+#ifdef WARPX_MAG_LLG
+    IntVect mag_Ms_stag = macro_stag; //cell-centered
+    IntVect mag_alpha_stag = macro_stag;
+    IntVect mag_gamma_stag = macro_stag;
+    IntVect Mx_stag = warpx.getMfield_fp(0,0).ixType().toIntVect(); // face-centered
+    IntVect My_stag = warpx.getMfield_fp(0,1).ixType().toIntVect();
+    IntVect Mz_stag = warpx.getMfield_fp(0,2).ixType().toIntVect();
+#endif
+    for ( int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        sigma_IndexType[idim]   = sigma_stag[idim];
+        epsilon_IndexType[idim] = epsilon_stag[idim];
+        mu_IndexType[idim]      = mu_stag[idim];
+        Ex_IndexType[idim]      = Ex_stag[idim];
+        Ey_IndexType[idim]      = Ey_stag[idim];
+        Ez_IndexType[idim]      = Ez_stag[idim];
+#ifdef WARPX_MAG_LLG
+        mag_Ms_IndexType[idim]    = mag_Ms_stag[idim];
+        mag_alpha_IndexType[idim] = mag_alpha_stag[idim];
+        mag_gamma_IndexType[idim] = mag_gamma_stag[idim];
+        Mx_IndexType[idim]        = Mx_stag[idim];
+        My_IndexType[idim]        = My_stag[idim];
+        Mz_IndexType[idim]        = Mz_stag[idim];
+#endif
+        macro_cr_ratio[idim]    = 1;
+    }
+#if (AMREX_SPACEDIM==2)
+        sigma_IndexType[2]   = 0;
+        epsilon_IndexType[2] = 0;
+        mu_IndexType[2]      = 0;
+        Ex_IndexType[2]      = 0;
+        Ey_IndexType[2]      = 0;
+        Ez_IndexType[2]      = 0;
+#ifdef WARPX_MAG_LLG
+        mag_Ms_IndexType[2]    = 0;
+        mag_alpha_IndexType[2] = 0;
+        mag_gamma_IndexType[2] = 0;
+        Mx_IndexType[2]        = 0;
+        My_IndexType[2]        = 0;
+        Mz_IndexType[2]        = 0;
+#endif
+        macro_cr_ratio[2]    = 1;
+#endif
+
+    for (int lev = 0; lev <= warpx.finestLevel(); ++lev) {
+        for (PatchType patch_type : {PatchType::fine, PatchType::coarse}) {
+            if (lev == 0 && patch_type == PatchType::coarse) continue;
+            SetPatch(lev, patch_type);
+            if (m_uniform_box_kernels) BuildMaterialBoxTypes();
+#ifdef WARPX_MAG_LLG
+            if (m_mag_sparse_update) BuildMagneticCellLists();
+            if (m_mag_precompute_face_coefs) InitMagFaceCoefs();
+#endif
+        }
+    }
+    SetPatch(0, PatchType::fine);
+}
+
+void
+MacroscopicProperties::ResizePatches (int npatches)
+{
+    m_sigma_mf.resize(npatches);
+    m_eps_mf.resize(npatches);
+    m_mu_mf.resize(npatches);
+    m_material_id.resize(npatches);
+    m_material_table.resize(npatches);
+    m_material_box_type.resize(npatches);
+    m_material_box_values.resize(npatches);
+    m_E_coefs_mf.resize(npatches);
+    m_E_coefs_dt.resize(npatches, 0._rt);
+    m_E_coefs_algo.resize(npatches, -1);
+#ifdef WARPX_MAG_LLG
+    m_mag_Ms_mf.resize(npatches);
+    m_mag_alpha_mf.resize(npatches);
+    m_mag_gamma_mf.resize(npatches);
+    m_mag_face_coefs_mf.resize(npatches);
+    m_mag_box_type.resize(npatches);
+    m_mag_face_cells.resize(npatches);
+#endif
+}
+
+int
+MacroscopicProperties::PatchIndex (int lev, PatchType patch_type)
+{
+    return 2*lev + ((patch_type == PatchType::coarse) ? 1 : 0);
+}
+
+void
+MacroscopicProperties::SetPatch (int lev, PatchType patch_type)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(lev > 0 || patch_type == PatchType::fine,
+        "MacroscopicProperties::SetPatch: level 0 has no coarse patch");
+    m_patch = PatchIndex(lev, patch_type);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_patch < static_cast<int>(m_material_id.size()),
+        "MacroscopicProperties::SetPatch: the macroscopic properties are not defined on this level");
+}
+
+const amrex::Geometry&
+MacroscopicProperties::getpatch_geom () const
+{
+    int const lev = m_patch / 2;
+    return WarpX::GetInstance().Geom((m_patch % 2) ? lev-1 : lev);
+}
+
+const amrex::BoxArray&
+MacroscopicProperties::getpatch_boxArray () const
+{
+    return (m_material_id_storage) ? m_material_id[m_patch]->boxArray() : m_sigma_mf[m_patch]->boxArray();
+}
+
+const amrex::DistributionMapping&
+MacroscopicProperties::getpatch_DistributionMap () const
+{
+    return (m_material_id_storage) ? m_material_id[m_patch]->DistributionMap() : m_sigma_mf[m_patch]->DistributionMap();
+}
+
+const amrex::MultiFab&
+MacroscopicProperties::getproperty_mf (int comp) const
+{
+    switch (comp) {
+        case MacroProp::sigma : return *m_sigma_mf[m_patch];
+        case MacroProp::epsilon : return *m_eps_mf[m_patch];
+        case MacroProp::mu : return *m_mu_mf[m_patch];
+#ifdef WARPX_MAG_LLG
+        case MacroProp::Ms : return *m_mag_Ms_mf[m_patch];
+        case MacroProp::alpha : return *m_mag_alpha_mf[m_patch];
+        case MacroProp::gamma : return *m_mag_gamma_mf[m_patch];
+#endif
+        default : amrex::Abort("MacroscopicProperties::getproperty_mf: unknown material property");
+    }
+    return *m_sigma_mf[m_patch];
+}
+
+MacroPropertyArray
+MacroscopicProperties::getproperty_arr (amrex::MFIter const& mfi, int comp) const
+{
+    MacroPropertyArray prop;
+    if (m_material_id_storage) {
+        prop.id = m_material_id[m_patch]->const_array(mfi);
+        prop.table = m_material_table[m_patch].dataPtr() + comp;
+    } else {
+        prop.arr = getproperty_mf(comp).const_array(mfi);
+    }
+    return prop;
+}
+
+amrex::Real
+MacroscopicProperties::getproperty_max (int comp) const
+{
+    if (!m_material_id_storage) return getproperty_mf(comp).max(0);
+
+    ReduceOps<ReduceOpMax> reduce_op;
+    ReduceData<Real> reduce_data(reduce_op);
+    using ReduceTuple = typename decltype(reduce_data)::Type;
+    for (MFIter mfi(getpatch_boxArray(), getpatch_DistributionMap()); mfi.isValid(); ++mfi) {
+        MacroPropertyArray const prop = getproperty_arr(mfi, comp);
+        reduce_op.eval(mfi.validbox(), reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                return {prop(i, j, k)};
+            });
+    }
+    Real prop_max = amrex::get<0>(reduce_data.value());
+    ParallelDescriptor::ReduceRealMax(prop_max);
+    return prop_max;
+}
+
+void
+MacroscopicProperties::RemakeLevel (int lev, const amrex::DistributionMapping& dm)
+{
+    auto remake = [&dm] (std::unique_ptr<MultiFab>& mf) { WarpXMigrate(mf, dm, true); };
+
+    int const patch = m_patch;
+    for (PatchType patch_type : {PatchType::fine, PatchType::coarse}) {
+        if (lev == 0 && patch_type == PatchType::coarse) continue;
+        int const ipatch = PatchIndex(lev, patch_type);
+        if (m_material_id_storage) {
+            // the material IDs are only meaningful with the property table of their MPI rank,
+            // so they are evaluated again on the new DistributionMapping
+            InitPatchData(lev, patch_type, dm);
+        } else {
+            remake(m_sigma_mf[ipatch]);
+            remake(m_eps_mf[ipatch]);
+            remake(m_mu_mf[ipatch]);
+#ifdef WARPX_MAG_LLG
+            remake(m_mag_Ms_mf[ipatch]);
+            remake(m_mag_alpha_mf[ipatch]);
+            remake(m_mag_gamma_mf[ipatch]);
+#endif
+        }
+        // the box classifications, lists and face coefficients are rebuilt on the new DistributionMapping,
+        // and the coefficients of the E update at the next call of UpdateECoefs
+        for (auto& E_coefs : m_E_coefs_mf[ipatch]) E_coefs.reset();
+        SetPatch(lev, patch_type);
+        if (m_uniform_box_kernels) BuildMaterialBoxTypes();
+#ifdef WARPX_MAG_LLG
+        if (m_mag_sparse_update) BuildMagneticCellLists();
+        if (m_mag_precompute_face_coefs) InitMagFaceCoefs();
+#endif
+    }
+    m_patch = patch;
+}
+
+void
+MacroscopicProperties::RegridLevel (int lev)
+{
+    auto & warpx = WarpX::GetInstance();
+    if (static_cast<int>(m_material_id.size()) < 2 * (lev + 1)) ResizePatches(2 * (lev + 1));
+
+    int const patch = m_patch;
+    for (PatchType patch_type : {PatchType::fine, PatchType::coarse}) {
+        int const ipatch = PatchIndex(lev, patch_type);
+        // the material properties are evaluated again on the new grids
+        InitPatchData(lev, patch_type, warpx.DistributionMap(lev));
+        for (auto& E_coefs : m_E_coefs_mf[ipatch]) E_coefs.reset();
+        SetPatch(lev, patch_type);
+        if (m_uniform_box_kernels) BuildMaterialBoxTypes();
+#ifdef WARPX_MAG_LLG
+        if (m_mag_sparse_update) BuildMagneticCellLists();
+        if (m_mag_precompute_face_coefs) InitMagFaceCoefs();
+#endif
+    }
+    m_patch = patch;
+}
+
+amrex::Long
+MacroscopicProperties::MemoryBytes (int lev) const
+{
+    using WarpXUtilMemory::FabArrayBytes;
+    amrex::Long nbytes = 0;
+    for (PatchType patch_type : {PatchType::fine, PatchType::coarse}) {
+        if (lev == 0 && patch_type == PatchType::coarse) continue;
+        int const ipatch = PatchIndex(lev, patch_type);
+        if (ipatch < static_cast<int>(m_sigma_mf.size())) {
+            nbytes += FabArrayBytes(m_sigma_mf[ipatch].get());
+            nbytes += FabArrayBytes(m_eps_mf[ipatch].get());
+            nbytes += FabArrayBytes(m_mu_mf[ipatch].get());
+        }
+        if (ipatch < static_cast<int>(m_E_coefs_mf.size())) {
+            for (auto const& E_coefs : m_E_coefs_mf[ipatch]) nbytes += FabArrayBytes(E_coefs.get());
+        }
+        if (ipatch < static_cast<int>(m_material_id.size())) {
+            nbytes += FabArrayBytes(m_material_id[ipatch].get());
+            nbytes += m_material_table[ipatch].size()*sizeof(amrex::Real);
+        }
+#ifdef WARPX_MAG_LLG
+        if (ipatch < static_cast<int>(m_mag_Ms_mf.size())) {
+            nbytes += FabArrayBytes(m_mag_Ms_mf[ipatch].get());
+            nbytes += FabArrayBytes(m_mag_alpha_mf[ipatch].get());
+            nbytes += FabArrayBytes(m_mag_gamma_mf[ipatch].get());
+        }
+        if (ipatch < static_cast<int>(m_mag_face_coefs_mf.size())) {
+            for (auto const& coefs : m_mag_face_coefs_mf[ipatch]) nbytes += FabArrayBytes(coefs.get());
+        }
+        if (ipatch < static_cast<int>(m_mag_face_cells.size())) {
+            for (auto const& face_cells : m_mag_face_cells[ipatch]) {
+                if (!face_cells) continue;
+                for (MFIter mfi(*face_cells); mfi.isValid(); ++mfi) {
+                    nbytes += (*face_cells)[mfi].size()*sizeof(int);
+                }
+            }
+        }
+#endif
+    }
+    return nbytes;
+}
+
+void
+MacroscopicProperties::InitPatchData (int lev, PatchType patch_type, const amrex::DistributionMapping& dm)
+{
+    auto & warpx = WarpX::GetInstance();
+    int const ipatch = PatchIndex(lev, patch_type);
+
+    // Get BoxArray of warpx instant.
     BoxArray ba = warpx.boxArray(lev);
-    DistributionMapping dmap = warpx.DistributionMap(lev);
+    DistributionMapping const& dmap = dm;
+    // the coarse patch of level lev lives on the grid of level lev-1
+    int geom_lev = lev;
+    if (patch_type == PatchType::coarse) {
+        ba.coarsen(warpx.refRatio(lev-1));
+        geom_lev = lev-1;
+    }
     int ng = 3;
+    if (m_material_id_storage) {
+        InitMaterialIDs(ipatch, ba, dmap, ng, geom_lev);
+        return;
+    }
     // Define material property multifabs using ba and dmap from WarpX instance
+    // With the precomputed coefficients of the E update, sigma and epsilon are only read
+    // when the coefficients are computed (except by the fused FDTD push)
+    const MFInfo sigma_eps_info = (m_precompute_E_coefs && !warpx.do_fused_fdtd) ?
+        ColdFields::Info() : MFInfo();
     // sigma is cell-centered MultiFab
-    m_sigma_mf = std::make_unique<MultiFab>(ba, dmap, 1, ng);
+    m_sigma_mf[ipatch] = std::make_unique<MultiFab>(ba, dmap, 1, ng, sigma_eps_info);
     // epsilon is cell-centered MultiFab
-    m_eps_mf = std::make_unique<MultiFab>(ba, dmap, 1, ng);
+    m_eps_mf[ipatch] = std::make_unique<MultiFab>(ba, dmap, 1, ng, sigma_eps_info);
     // mu is cell-centered MultiFab
-    m_mu_mf = std::make_unique<MultiFab>(ba, dmap, 1, ng);
+    m_mu_mf[ipatch] = std::make_unique<MultiFab>(ba, dmap, 1, ng);
 
 #ifdef WARPX_MAG_LLG
     // all magnetic macroparameters are stored on cell centers
-    m_mag_Ms_mf = std::make_unique<MultiFab>(ba, dmap, 1, ng);
-    m_mag_alpha_mf = std::make_unique<MultiFab>(ba, dmap, 1, ng);
-    m_mag_gamma_mf = std::make_unique<MultiFab>(ba, dmap, 1, ng);
+    m_mag_Ms_mf[ipatch] = std::make_unique<MultiFab>(ba, dmap, 1, ng);
+    m_mag_alpha_mf[ipatch] = std::make_unique<MultiFab>(ba, dmap, 1, ng);
+    m_mag_gamma_mf[ipatch] = std::make_unique<MultiFab>(ba, dmap, 1, ng);
 #endif
-
     // Initialize sigma
     if (m_sigma_s == "constant") {
 
-        m_sigma_mf->setVal(m_sigma);
+        m_sigma_mf[ipatch]->setVal(m_sigma);
 
     } else if (m_sigma_s == "parse_sigma_function") {
 
-        InitializeMacroMultiFabUsingParser(m_sigma_mf.get(), getParser(m_sigma_parser), lev);
+        InitializeMacroMultiFabUsingParser(m_sigma_mf[ipatch].get(), getParser(m_sigma_parser), geom_lev);
     }
     // Initialize epsilon
     if (m_epsilon_s == "constant") {
 
-        m_eps_mf->setVal(m_epsilon);
+        m_eps_mf[ipatch]->setVal(m_epsilon);
 
     } else if (m_epsilon_s == "parse_epsilon_function") {
 
-        InitializeMacroMultiFabUsingParser(m_eps_mf.get(), getParser(m_epsilon_parser), lev);
+        InitializeMacroMultiFabUsingParser(m_eps_mf[ipatch].get(), getParser(m_epsilon_parser), geom_lev);
 
     }
     // Initialize mu
     if (m_mu_s == "constant") {
 
-        m_mu_mf->setVal(m_mu);
+        m_mu_mf[ipatch]->setVal(m_mu);
 
     } else if (m_mu_s == "parse_mu_function") {
 
-        InitializeMacroMultiFabUsingParser(m_mu_mf.get(), getParser(m_mu_parser), lev);
+        InitializeMacroMultiFabUsingParser(m_mu_mf[ipatch].get(), getParser(m_mu_parser), geom_lev);
 
     }
 
 #ifdef WARPX_MAG_LLG
     // mag_Ms - defined at node
     if (m_mag_Ms_s == "constant") {
-        m_mag_Ms_mf->setVal(m_mag_Ms);
+        m_mag_Ms_mf[ipatch]->setVal(m_mag_Ms);
     }
     else if (m_mag_Ms_s == "parse_mag_Ms_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_Ms_mf.get(), getParser(m_mag_Ms_parser), lev);
-    }
-    // if there are regions with Ms=0, the user must provide mur value there
-    if (m_mag_Ms_mf->min(0,m_mag_Ms_mf->nGrow()) < 0._rt){
-        amrex::Abort("Ms must be non-negative values");
-    }
-    else if (m_mag_Ms_mf->min(0,m_mag_Ms_mf->nGrow()) == 0._rt){
-        if (m_mu_s != "constant" && m_mu_s != "parse_mu_function"){
-            amrex::Abort("permeability must be specified since part of the simulation domain is non-magnetic !");
-        }
+        InitializeMacroMultiFabUsingParser(m_mag_Ms_mf[ipatch].get(), getParser(m_mag_Ms_parser), geom_lev);
     }
 
     // mag_alpha - defined at node
     if (m_mag_alpha_s == "constant") {
-        m_mag_alpha_mf->setVal(m_mag_alpha);
+        m_mag_alpha_mf[ipatch]->setVal(m_mag_alpha);
     }
     else if (m_mag_alpha_s == "parse_mag_alpha_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_alpha_mf.get(), getParser(m_mag_alpha_parser), lev);
-    }
-    if (m_mag_alpha_mf->min(0,m_mag_alpha_mf->nGrow()) < 0._rt) {
-        amrex::Abort("alpha should be positive, but the user input has negative values");
+        InitializeMacroMultiFabUsingParser(m_mag_alpha_mf[ipatch].get(), getParser(m_mag_alpha_parser), geom_lev);
     }
 
     // mag_gamma - defined at node
     if (m_mag_gamma_s == "constant") {
-        m_mag_gamma_mf->setVal(m_mag_gamma);
+        m_mag_gamma_mf[ipatch]->setVal(m_mag_gamma);
 
     }
     else if (m_mag_gamma_s == "parse_mag_gamma_function"){
-        InitializeMacroMultiFabUsingParser(m_mag_gamma_mf.get(), getParser(m_mag_gamma_parser), lev);
+        InitializeMacroMultiFabUsingParser(m_mag_gamma_mf[ipatch].get(), getParser(m_mag_gamma_parser), geom_lev);
+    }
+
+    // check the magnetic properties, with a single reduction over the MPI ranks
+    bool const local = true;
+    Real mag_min[3] = {m_mag_Ms_mf[ipatch]->min(0, ng, local),
+                       m_mag_alpha_mf[ipatch]->min(0, ng, local),
+                       -m_mag_gamma_mf[ipatch]->max(0, ng, local)};
+    ParallelDescriptor::ReduceRealMin(mag_min, 3);
+    // if there are regions with Ms=0, the user must provide mur value there
+    if (mag_min[0] < 0._rt){
+        amrex::Abort("Ms must be non-negative values");
     }
-    if (m_mag_gamma_mf->max(0,m_mag_gamma_mf->nGrow()) > 0._rt) {
+    else if (mag_min[0] == 0._rt){
+        if (m_mu_s != "constant" && m_mu_s != "parse_mu_function"){
+            amrex::Abort("permeability must be specified since part of the simulation domain is non-magnetic !");
+        }
+    }
+    if (mag_min[1] < 0._rt) {
+        amrex::Abort("alpha should be positive, but the user input has negative values");
+    }
+    if (-mag_min[2] > 0._rt) {
         amrex::Abort("gamma should be negative, but the user input has positive values");
     }
 #endif
 
-    IntVect sigma_stag = m_sigma_mf->ixType().toIntVect();
-    IntVect epsilon_stag = m_eps_mf->ixType().toIntVect();
-    IntVect mu_stag = m_mu_mf->ixType().toIntVect();
-    IntVect Ex_stag = warpx.getEfield_fp(0,0).ixType().toIntVect();
-    IntVect Ey_stag = warpx.getEfield_fp(0,1).ixType().toIntVect();
-    IntVect Ez_stag = warpx.getEfield_fp(0,2).ixType().toIntVect();
+}
+
+void
+MacroscopicProperties::InitMaterialIDs (int ipatch, const amrex::BoxArray& ba, const amrex::DistributionMapping& dm,
+                                        int ng, int geom_lev)
+{
+    using MaterialIDFab = amrex::BaseFab<std::uint8_t>;
+    m_material_id[ipatch] = std::make_unique<amrex::FabArray<MaterialIDFab> >(ba, dm, 1, ng);
+    auto& material_id = *m_material_id[ipatch];
+
+    // initialization style, constant value and parser of each material property, see MacroProp
+    std::array<bool, MacroProp::ncomps> const is_constant = {
+        m_sigma_s == "constant", m_epsilon_s == "constant", m_mu_s == "constant"
 #ifdef WARPX_MAG_LLG
-    IntVect mag_Ms_stag = m_mag_Ms_mf->ixType().toIntVect(); //cell-centered
-    IntVect mag_alpha_stag = m_mag_alpha_mf->ixType().toIntVect();
-    IntVect mag_gamma_stag = m_mag_gamma_mf->ixType().toIntVect();
-    IntVect Mx_stag = warpx.getMfield_fp(0,0).ixType().toIntVect(); // face-centered
-    IntVect My_stag = warpx.getMfield_fp(0,1).ixType().toIntVect();
-    IntVect Mz_stag = warpx.getMfield_fp(0,2).ixType().toIntVect();
+        , m_mag_Ms_s == "constant", m_mag_alpha_s == "constant", m_mag_gamma_s == "constant"
 #endif
-    for ( int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
-        sigma_IndexType[idim]   = sigma_stag[idim];
-        epsilon_IndexType[idim] = epsilon_stag[idim];
-        mu_IndexType[idim]      = mu_stag[idim];
-        Ex_IndexType[idim]      = Ex_stag[idim];
-        Ey_IndexType[idim]      = Ey_stag[idim];
-        Ez_IndexType[idim]      = Ez_stag[idim];
+    };
+    std::array<Real, MacroProp::ncomps> const value = {
+        m_sigma, m_epsilon, m_mu
 #ifdef WARPX_MAG_LLG
-        mag_Ms_IndexType[idim]    = mag_Ms_stag[idim];
-        mag_alpha_IndexType[idim] = mag_alpha_stag[idim];
-        mag_gamma_IndexType[idim] = mag_gamma_stag[idim];
-        Mx_IndexType[idim]        = Mx_stag[idim];
-        My_IndexType[idim]        = My_stag[idim];
-        Mz_IndexType[idim]        = Mz_stag[idim];
+        , m_mag_Ms, m_mag_alpha, m_mag_gamma
 #endif
-        macro_cr_ratio[idim]    = 1;
+    };
+    std::array<ParserWrapper<3> const*, MacroProp::ncomps> const parser = {
+        m_sigma_parser.get(), m_epsilon_parser.get(), m_mu_parser.get()
+#ifdef WARPX_MAG_LLG
+        , m_mag_Ms_parser.get(), m_mag_alpha_parser.get(), m_mag_gamma_parser.get()
+#endif
+    };
+
+    // distinct sets of material properties found on this MPI rank, and their IDs
+    std::map<std::array<Real, MacroProp::ncomps>, int> materials;
+    Vector<Real> h_table;
+
+    for (MFIter mfi(material_id); mfi.isValid(); ++mfi) {
+        // the properties of the box, including its guard cells, are evaluated as in the full-resolution storage
+        Box const& bx = mfi.fabbox();
+        FArrayBox props(bx, MacroProp::ncomps);
+        for (int comp = 0; comp < MacroProp::ncomps; ++comp) {
+            if (is_constant[comp]) {
+                props.setVal<RunOn::Device>(value[comp], bx, comp, 1);
+            } else {
+                InitializeMacroFabUsingParser(props.array(), bx, bx.ixType().toIntVect(), comp,
+                                              getParser(parser[comp]), geom_lev);
+            }
+        }
+        FArrayBox h_props(bx, MacroProp::ncomps, The_Pinned_Arena());
+        Gpu::dtoh_memcpy(h_props.dataPtr(), props.dataPtr(), h_props.nBytes());
+
+        MaterialIDFab h_id(bx, 1, The_Pinned_Arena());
+        Array4<Real const> const& h_props_arr = h_props.const_array();
+        Array4<std::uint8_t> const& h_id_arr = h_id.array();
+        amrex::LoopOnCpu(bx, [&] (int i, int j, int k) {
+            std::array<Real, MacroProp::ncomps> material;
+            for (int comp = 0; comp < MacroProp::ncomps; ++comp) material[comp] = h_props_arr(i, j, k, comp);
+            auto it = materials.find(material);
+            if (it == materials.end()) {
+                int const id = static_cast<int>(materials.size());
+                if (id > 255) {
+                    amrex::Abort("macroscopic.material_id_storage = 1 supports at most 256 distinct materials per MPI rank,"
+                                 " use macroscopic.material_id_storage = 0 for continuously varying material properties");
+                }
+                it = materials.emplace(material, id).first;
+                h_table.insert(h_table.end(), material.begin(), material.end());
+            }
+            h_id_arr(i, j, k) = static_cast<std::uint8_t>(it->second);
+        });
+        Gpu::htod_memcpy(material_id[mfi].dataPtr(), h_id.dataPtr(), h_id.nBytes());
     }
-#if (AMREX_SPACEDIM==2)
-        sigma_IndexType[2]   = 0;
-        epsilon_IndexType[2] = 0;
-        mu_IndexType[2]      = 0;
-        Ex_IndexType[2]      = 0;
-        Ey_IndexType[2]      = 0;
-        Ez_IndexType[2]      = 0;
+
+    // same checks of the material properties as with the full-resolution storage
+    for (auto const& m : materials) {
+        amrex::ignore_unused(m);
 #ifdef WARPX_MAG_LLG
-        mag_Ms_IndexType[2]    = 0;
-        mag_alpha_IndexType[2] = 0;
-        mag_gamma_IndexType[2] = 0;
-        Mx_IndexType[2]        = 0;
-        My_IndexType[2]        = 0;
-        Mz_IndexType[2]        = 0;
+        if (m.first[MacroProp::Ms] < 0._rt) {
+            amrex::Abort("Ms must be non-negative values");
+        } else if (m.first[MacroProp::Ms] == 0._rt) {
+            if (m_mu_s != "constant" && m_mu_s != "parse_mu_function"){
+                amrex::Abort("permeability must be specified since part of the simulation domain is non-magnetic !");
+            }
+        }
+        if (m.first[MacroProp::alpha] < 0._rt) {
+            amrex::Abort("alpha should be positive, but the user input has negative values");
+        }
+        if (m.first[MacroProp::gamma] > 0._rt) {
+            amrex::Abort("gamma should be negative, but the user input has positive values");
+        }
 #endif
-        macro_cr_ratio[2]    = 1;
+    }
+
+    m_material_table[ipatch].resize(h_table.size());
+    Gpu::copyAsync(Gpu::hostToDevice, h_table.begin(), h_table.end(), m_material_table[ipatch].begin());
+    Gpu::streamSynchronize();
+
+    amrex::Long nmaterials = static_cast<amrex::Long>(materials.size());
+    ParallelDescriptor::ReduceLongMax(nmaterials);
+    amrex::Print() << "Material-ID storage of patch " << ipatch << ": at most " << nmaterials
+                   << " distinct materials per MPI rank\n";
+}
+
+#ifdef WARPX_MAG_LLG
+void
+MacroscopicProperties::InitMagFaceCoefs ()
+{
+    auto & warpx = WarpX::GetInstance();
+    amrex::GpuArray<int, 3> const& Ms_stag = mag_Ms_IndexType;
+    amrex::GpuArray<int, 3> const& alpha_stag = mag_alpha_IndexType;
+    amrex::GpuArray<int, 3> const& gamma_stag = mag_gamma_IndexType;
+    amrex::GpuArray<int, 3> const& mu_stag = mu_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr = macro_cr_ratio;
+    std::array<amrex::GpuArray<int, 3>, 3> const face_stag = {Mx_IndexType, My_IndexType, Mz_IndexType};
+
+    int const lev = m_patch / 2;
+    bool const coarse_patch = (m_patch % 2 == 1);
+
+    for (int idim = 0; idim < 3; ++idim) {
+        // same layout as M, without guard cells since the coefficients are only read on the updated faces
+        amrex::MultiFab const& Mfield = (coarse_patch) ? warpx.getMfield_cp(lev,idim) : warpx.getMfield_fp(lev,idim);
+        m_mag_face_coefs_mf[m_patch][idim] = std::make_unique<MultiFab>(Mfield.boxArray(), Mfield.DistributionMap(), MagFaceCoef::ncomps, 0);
+        amrex::GpuArray<int, 3> const stag = face_stag[idim];
+
+        for (MFIter mfi(*m_mag_face_coefs_mf[m_patch][idim], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            MacroPropertyArray const Ms_arr = getproperty_arr(mfi, MacroProp::Ms);
+            MacroPropertyArray const alpha_arr = getproperty_arr(mfi, MacroProp::alpha);
+            MacroPropertyArray const gamma_arr = getproperty_arr(mfi, MacroProp::gamma);
+            MacroPropertyArray const mu_arr = getproperty_arr(mfi, MacroProp::mu);
+            Array4<Real> const& coef = m_mag_face_coefs_mf[m_patch][idim]->array(mfi);
+            Box const& tb = mfi.tilebox();
+
+            amrex::ParallelFor(tb, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                Real const alpha = CoarsenIO::Interp(alpha_arr, alpha_stag, stag, macro_cr, i, j, k, 0);
+                Real const gamma = CoarsenIO::Interp(gamma_arr, gamma_stag, stag, macro_cr, i, j, k, 0);
+                coef(i, j, k, MagFaceCoef::Ms) = CoarsenIO::Interp(Ms_arr, Ms_stag, stag, macro_cr, i, j, k, 0);
+                coef(i, j, k, MagFaceCoef::alpha) = alpha;
+                coef(i, j, k, MagFaceCoef::gamma) = gamma;
+                coef(i, j, k, MagFaceCoef::gammaL) = gamma / (1._rt + std::pow(alpha, 2._rt));
+                coef(i, j, k, MagFaceCoef::half_mu0_abs_gamma) = PhysConst::mu0 * amrex::Math::abs(gamma) / 2._rt;
+                coef(i, j, k, MagFaceCoef::mu) = CoarsenIO::Interp(mu_arr, mu_stag, stag, macro_cr, i, j, k, 0);
+            });
+        }
+    }
+}
 #endif
 
+template <typename T_MacroAlgo>
+void
+MacroscopicProperties::UpdateECoefs (amrex::Real dt)
+{
+    int const algo = std::is_same<T_MacroAlgo, LaxWendroffAlgo>::value ? MacroscopicSolverAlgo::LaxWendroff
+                                                                       : MacroscopicSolverAlgo::BackwardEuler;
+    if (m_E_coefs_mf[m_patch][0] && m_E_coefs_dt[m_patch] == dt && m_E_coefs_algo[m_patch] == algo) return;
+
+    auto & warpx = WarpX::GetInstance();
+    amrex::GpuArray<int, 3> const& sigma_stag = sigma_IndexType;
+    amrex::GpuArray<int, 3> const& epsilon_stag = epsilon_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr = macro_cr_ratio;
+    std::array<amrex::GpuArray<int, 3>, 3> const edge_stag = {Ex_IndexType, Ey_IndexType, Ez_IndexType};
+
+    int const lev = m_patch / 2;
+    bool const coarse_patch = (m_patch % 2 == 1);
+
+    for (int idim = 0; idim < 3; ++idim) {
+        // same layout as E, without guard cells since the coefficients are only read on the updated edges
+        amrex::MultiFab const& Efield = (coarse_patch) ? warpx.getEfield_cp(lev,idim) : warpx.getEfield_fp(lev,idim);
+        m_E_coefs_mf[m_patch][idim] = std::make_unique<MultiFab>(Efield.boxArray(), Efield.DistributionMap(), MacroECoef::ncomps, 0);
+        amrex::GpuArray<int, 3> const stag = edge_stag[idim];
+
+        for (MFIter mfi(*m_E_coefs_mf[m_patch][idim], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            MacroPropertyArray const sigma_arr = getproperty_arr(mfi, MacroProp::sigma);
+            MacroPropertyArray const eps_arr = getproperty_arr(mfi, MacroProp::epsilon);
+            Array4<Real> const& coef = m_E_coefs_mf[m_patch][idim]->array(mfi);
+            Box const& tb = mfi.tilebox();
+
+            amrex::ParallelFor(tb, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                Real const sigma = CoarsenIO::Interp(sigma_arr, sigma_stag, stag, macro_cr, i, j, k, 0);
+                Real const epsilon = CoarsenIO::Interp(eps_arr, epsilon_stag, stag, macro_cr, i, j, k, 0);
+                coef(i, j, k, MacroECoef::alpha) = T_MacroAlgo::alpha(sigma, epsilon, dt);
+                coef(i, j, k, MacroECoef::beta) = T_MacroAlgo::beta(sigma, epsilon, dt);
+            });
+        }
+    }
+    m_E_coefs_dt[m_patch] = dt;
+    m_E_coefs_algo[m_patch] = algo;
+}
+
+template void MacroscopicProperties::UpdateECoefs<LaxWendroffAlgo> (amrex::Real dt);
+template void MacroscopicProperties::UpdateECoefs<BackwardEulerAlgo> (amrex::Real dt);
+
+void
+MacroscopicProperties::BuildMaterialBoxTypes ()
+{
+    BoxArray const& ba = getpatch_boxArray();
+    DistributionMapping const& dm = getpatch_DistributionMap();
+    m_material_box_type[m_patch] = std::make_unique<LayoutData<int>>(ba, dm);
+    m_material_box_values[m_patch] = std::make_unique<LayoutData<std::array<Real, 3>>>(ba, dm);
+    auto& box_type = *m_material_box_type[m_patch];
+    auto& box_values = *m_material_box_values[m_patch];
+
+    // number of vacuum, uniform and varying boxes, for information
+    amrex::Long nboxes_type[3] = {0, 0, 0};
+
+    for (MFIter mfi(ba, dm); mfi.isValid(); ++mfi) {
+        // the interpolation of the properties to the edges of E reads one more cell on each side
+        Box const bx = amrex::grow(mfi.validbox(), 1);
+        MacroPropertyArray const sigma_arr = getproperty_arr(mfi, MacroProp::sigma);
+        MacroPropertyArray const eps_arr = getproperty_arr(mfi, MacroProp::epsilon);
+        MacroPropertyArray const mu_arr = getproperty_arr(mfi, MacroProp::mu);
+
+        ReduceOps<ReduceOpMin, ReduceOpMax, ReduceOpMin, ReduceOpMax, ReduceOpMin, ReduceOpMax> reduce_op;
+        ReduceData<Real, Real, Real, Real, Real, Real> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(bx, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                Real const sigma = sigma_arr(i, j, k);
+                Real const eps = eps_arr(i, j, k);
+                Real const mu = mu_arr(i, j, k);
+                return {sigma, sigma, eps, eps, mu, mu};
+            });
+        auto const hv = reduce_data.value();
+
+        bool const uniform = (amrex::get<0>(hv) == amrex::get<1>(hv))
+                          && (amrex::get<2>(hv) == amrex::get<3>(hv))
+                          && (amrex::get<4>(hv) == amrex::get<5>(hv));
+        std::array<Real, 3> const values = {amrex::get<0>(hv), amrex::get<2>(hv), amrex::get<4>(hv)};
+        bool const vacuum = uniform && values[0] == 0._rt && values[1] == PhysConst::ep0 && values[2] == PhysConst::mu0;
+
+        int const type = vacuum ? MaterialBoxType::Vacuum : (uniform ? MaterialBoxType::Uniform : MaterialBoxType::Varying);
+        box_type[mfi] = type;
+        box_values[mfi] = values;
+        nboxes_type[type] += 1;
+    }
 
+    ParallelDescriptor::ReduceLongSum(nboxes_type, 3);
+    amrex::Print() << "Material box classification of patch " << m_patch << ": " << nboxes_type[MaterialBoxType::Vacuum] << " vacuum, "
+                   << nboxes_type[MaterialBoxType::Uniform] << " uniform, "
+                   << nboxes_type[MaterialBoxType::Varying] << " varying boxes\n";
 }
 
+#ifdef WARPX_MAG_LLG
+void
+MacroscopicProperties::BuildMagneticCellLists ()
+{
+    auto & warpx = WarpX::GetInstance();
+    BoxArray const& ba = getpatch_boxArray();
+    DistributionMapping const& dm = getpatch_DistributionMap();
+
+    auto& mag_box_type = m_mag_box_type[m_patch];
+    auto& mag_face_cells = m_mag_face_cells[m_patch];
+    mag_box_type = std::make_unique<LayoutData<int>>(ba, dm);
+    for (int idim = 0; idim < 3; ++idim) {
+        mag_face_cells[idim] = std::make_unique<LayoutData<Gpu::DeviceVector<int>>>(ba, dm);
+    }
+
+    amrex::GpuArray<int, 3> const& Ms_stag = mag_Ms_IndexType;
+    amrex::GpuArray<int, 3> const& macro_cr = macro_cr_ratio;
+    std::array<amrex::GpuArray<int, 3>, 3> const face_stag = {Mx_IndexType, My_IndexType, Mz_IndexType};
+
+    // number of vacuum, magnetic and mixed boxes, for information
+    amrex::Long nboxes_type[3] = {0, 0, 0};
+
+    for (MFIter mfi(ba, dm); mfi.isValid(); ++mfi) {
+        MacroPropertyArray const Ms_arr = getproperty_arr(mfi, MacroProp::Ms);
+        bool all_vacuum = true;
+        bool all_magnetic = true;
+        for (int idim = 0; idim < 3; ++idim) {
+            // valid box of the faces on which M is updated
+            Box const bx = amrex::convert(mfi.validbox(), warpx.getMfield_fp(0,idim).ixType());
+            int const npts = static_cast<int>(bx.numPts());
+            amrex::GpuArray<int, 3> const stag = face_stag[idim];
+
+            // flag the faces with Ms > 0, with the same interpolation as the LLG kernels
+            Gpu::DeviceVector<int> flag(npts);
+            Gpu::DeviceVector<int> offset(npts);
+            int* const AMREX_RESTRICT flag_ptr = flag.dataPtr();
+            int* const AMREX_RESTRICT offset_ptr = offset.dataPtr();
+            amrex::ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                Real const Ms = CoarsenIO::Interp(Ms_arr, Ms_stag, stag, macro_cr, i, j, k, 0);
+                flag_ptr[bx.index(IntVect(AMREX_D_DECL(i,j,k)))] = (Ms > 0._rt) ? 1 : 0;
+            });
+            int const ncells = amrex::Scan::ExclusiveSum(npts, flag_ptr, offset_ptr);
+
+            all_vacuum = all_vacuum && (ncells == 0);
+            all_magnetic = all_magnetic && (ncells == npts);
+
+            // compact the offsets of the magnetic faces
+            Gpu::DeviceVector<int>& cells = (*mag_face_cells[idim])[mfi];
+            cells.resize(ncells);
+            int* const AMREX_RESTRICT cells_ptr = cells.dataPtr();
+            amrex::ParallelFor(npts, [=] AMREX_GPU_DEVICE (int n) {
+                if (flag_ptr[n]) cells_ptr[offset_ptr[n]] = n;
+            });
+            Gpu::synchronize();
+        }
+
+        int const box_type = all_vacuum ? MagBoxType::Vacuum : (all_magnetic ? MagBoxType::Magnetic : MagBoxType::Mixed);
+        (*mag_box_type)[mfi] = box_type;
+        nboxes_type[box_type] += 1;
+        // the lists are only used on mixed boxes
+        if (box_type != MagBoxType::Mixed) {
+            for (int idim = 0; idim < 3; ++idim) {
+                (*mag_face_cells[idim])[mfi].clear();
+                (*mag_face_cells[idim])[mfi].shrink_to_fit();
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(nboxes_type, 3);
+    amrex::Print() << "Magnetic box classification of patch " << m_patch << ": " << nboxes_type[MagBoxType::Vacuum] << " vacuum, "
+                   << nboxes_type[MagBoxType::Magnetic] << " magnetic, "
+                   << nboxes_type[MagBoxType::Mixed] << " mixed boxes\n";
+}
+
+bool
+MacroscopicProperties::HasMagneticMaterial (BoxArray const& ba, DistributionMapping const& dm, int lev)
+{
+    if (m_mag_Ms_s == "constant") return m_mag_Ms > 0._rt;
+    MultiFab Ms_mf(ba, dm, 1, 0);
+    InitializeMacroMultiFabUsingParser(&Ms_mf, getParser(m_mag_Ms_parser), lev);
+    return Ms_mf.max(0) > 0._rt;
+}
+#endif
+
 void
 MacroscopicProperties::InitializeMacroMultiFabUsingParser (
                        MultiFab *macro_mf, HostDeviceParser<3> const& macro_parser,
                        int lev)
 {
-    auto& warpx = WarpX::GetInstance();
-    const auto dx_lev = warpx.Geom(lev).CellSizeArray();
-    const RealBox& real_box = warpx.Geom(lev).ProbDomain();
     IntVect iv = macro_mf->ixType().toIntVect();
     IntVect grown_iv = macro_mf->nGrowVect();
     for ( MFIter mfi(*macro_mf, TilingIfNotGPU()); mfi.isValid(); ++mfi ) {
         // Initialize ghost cells in addition to valid cells
 
         const Box& tb = mfi.growntilebox(grown_iv);
-        auto const& macro_fab =  macro_mf->array(mfi);
-        amrex::ParallelFor (tb,
-            [=] AMREX_GPU_DEVICE (int i, int j, int k) {
-                // Shift x, y, z position based on index type
-                Real fac_x = (1._rt - iv[0]) * dx_lev[0] * 0.5_rt;
-                Real x = i * dx_lev[0] + real_box.lo(0) + fac_x;
+        InitializeMacroFabUsingParser(macro_mf->array(mfi), tb, iv, 0, macro_parser, lev);
+    }
+}
+
+void
+MacroscopicProperties::InitializeMacroFabUsingParser (
+                       Array4<Real> const& macro_fab, Box const& tb, IntVect const& iv, int comp,
+                       HostDeviceParser<3> const& macro_parser, int lev)
+{
+    auto& warpx = WarpX::GetInstance();
+    const auto dx_lev = warpx.Geom(lev).CellSizeArray();
+    const RealBox& real_box = warpx.Geom(lev).ProbDomain();
+#ifndef AMREX_USE_GPU
+    // On CPU, the rows of tb along x are evaluated in batches
+    const Dim3 lo = lbound(tb);
+    const Dim3 hi = ubound(tb);
+    const int nx = hi.x - lo.x + 1;
+    Vector<Real> xs(nx);
+    for (int i = 0; i < nx; ++i) {
+        xs[i] = (lo.x + i) * dx_lev[0] + real_box.lo(0) + (1._rt - iv[0]) * dx_lev[0] * 0.5_rt;
+    }
+    for (int k = lo.z; k <= hi.z; ++k) {
+        for (int j = lo.y; j <= hi.y; ++j) {
 #if (AMREX_SPACEDIM==2)
-                amrex::Real y = 0._rt;
-                Real fac_z = (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
-                Real z = j * dx_lev[1] + real_box.lo(1) + fac_z;
+            const Real y = 0._rt;
+            const Real z = j * dx_lev[1] + real_box.lo(1) + (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
 #else
-                Real fac_y = (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
-                Real y = j * dx_lev[1] + real_box.lo(1) + fac_y;
-                Real fac_z = (1._rt - iv[2]) * dx_lev[2] * 0.5_rt;
-                Real z = k * dx_lev[2] + real_box.lo(2) + fac_z;
+            const Real y = j * dx_lev[1] + real_box.lo(1) + (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
+            const Real z = k * dx_lev[2] + real_box.lo(2) + (1._rt - iv[2]) * dx_lev[2] * 0.5_rt;
 #endif
-                // initialize the macroparameter
-                macro_fab(i,j,k) = macro_parser(x,y,z);
-        });
-
+            macro_parser.eval_batch(nx, macro_fab.ptr(lo.x,j,k,comp), xs.dataPtr(), y, z);
+        }
     }
+#else
+    amrex::ParallelFor (tb,
+        [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+            // Shift x, y, z position based on index type
+            Real fac_x = (1._rt - iv[0]) * dx_lev[0] * 0.5_rt;
+            Real x = i * dx_lev[0] + real_box.lo(0) + fac_x;
+#if (AMREX_SPACEDIM==2)
+            amrex::Real y = 0._rt;
+            Real fac_z = (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
+            Real z = j * dx_lev[1] + real_box.lo(1) + fac_z;
+#else
+            Real fac_y = (1._rt - iv[1]) * dx_lev[1] * 0.5_rt;
+            Real y = j * dx_lev[1] + real_box.lo(1) + fac_y;
+            Real fac_z = (1._rt - iv[2]) * dx_lev[2] * 0.5_rt;
+            Real z = k * dx_lev[2] + real_box.lo(2) + fac_z;
+#endif
+            // initialize the macroparameter
+            macro_fab(i,j,k,comp) = macro_parser(x,y,z);
+    });
+#endif
 }
@@ -0,0 +1,125 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+
+#include "AnyFFT.H"
+
+#include <AMReX.H>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <type_traits>
+
+namespace AnyFFT
+{
+    namespace
+    {
+        /** Key of the plan cache: shape of the real array, dimension, direction,
+         *  number of transforms in the batch, alignment of the two arrays
+         *  (FFTW requires that a plan is only executed on arrays with the same
+         *  alignment as the ones it was created with), and precision (1 for the
+         *  single-precision plans) */
+        using PlanKey = std::tuple<std::array<int,3>, int, int, int, int, int, int>;
+
+        std::map<PlanKey, FFTplan> plan_cache;
+        bool plan_cache_registered = false;
+
+        int Alignment (void const * const ptr)
+        {
+            return static_cast<int>(reinterpret_cast<std::uintptr_t>(ptr) % 64);
+        }
+
+        /** Set the arrays transformed by a copy of a cached plan */
+        void SetArrays (FFTplan& fft_plan, amrex::Real * const real_array,
+                        Complex * const complex_array)
+        {
+            fft_plan.m_real_array = real_array;
+            fft_plan.m_complex_array = complex_array;
+        }
+
+#ifndef AMREX_USE_FLOAT
+        void SetArrays (FFTplan& fft_plan, float * const real_array,
+                        FloatComplex * const complex_array)
+        {
+            fft_plan.m_real_array_float = real_array;
+            fft_plan.m_complex_array_float = complex_array;
+        }
+#endif
+
+        template <typename T, typename TComplex>
+        FFTplan GetCachedPlanR2C (const amrex::IntVect& real_size, T * const real_array,
+                                  TComplex * const complex_array, const direction dir,
+                                  const int dim, const int howmany)
+        {
+            std::array<int,3> size {1, 1, 1};
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) size[idim] = real_size[idim];
+            const int single = std::is_same<T, amrex::Real>::value ? 0 : 1;
+            const PlanKey key {size, dim, static_cast<int>(dir), howmany,
+                               Alignment(real_array), Alignment(complex_array), single};
+
+            auto it = plan_cache.find(key);
+            if (it == plan_cache.end()) {
+                if (!plan_cache_registered) {
+                    amrex::ExecOnFinalize(ClearPlanCache);
+                    plan_cache_registered = true;
+                }
+                it = plan_cache.emplace(key,
+                    CreatePlan(real_size, real_array, complex_array, dir, dim, howmany)).first;
+            }
+
+            // Copy of the cached plan, pointing to the arrays of the caller
+            FFTplan fft_plan = it->second;
+            SetArrays(fft_plan, real_array, complex_array);
+            return fft_plan;
+        }
+    }
+
+    FFTplan GetCachedPlan(const amrex::IntVect& real_size, amrex::Real * const real_array,
+                          Complex * const complex_array, const direction dir, const int dim,
+                          const int howmany)
+    {
+        return GetCachedPlanR2C(real_size, real_array, complex_array, dir, dim, howmany);
+    }
+
+#ifndef AMREX_USE_FLOAT
+    FFTplan GetCachedPlan(const amrex::IntVect& real_size, float * const real_array,
+                          FloatComplex * const complex_array, const direction dir, const int dim,
+                          const int howmany)
+    {
+        return GetCachedPlanR2C(real_size, real_array, complex_array, dir, dim, howmany);
+    }
+#endif
+
+    FFTplan GetCachedPlanC2C(const int n, Complex * const complex_array, const int stride,
+                             const int dist, const int howmany, const direction dir)
+    {
+        // The C2C plans are distinguished from the R2C/C2R plans by their direction
+        const PlanKey key {{n, stride, dist}, 1, static_cast<int>(dir), howmany,
+                           0, Alignment(complex_array), 0};
+
+        auto it = plan_cache.find(key);
+        if (it == plan_cache.end()) {
+            if (!plan_cache_registered) {
+                amrex::ExecOnFinalize(ClearPlanCache);
+                plan_cache_registered = true;
+            }
+            it = plan_cache.emplace(key,
+                CreatePlanC2C(n, complex_array, stride, dist, howmany, dir)).first;
+        }
+
+        FFTplan fft_plan = it->second;
+        fft_plan.m_complex_array = complex_array;
+        return fft_plan;
+    }
+
+    void ClearPlanCache()
+    {
+        for (auto& kv : plan_cache) DestroyPlan(kv.second);
+        plan_cache.clear();
+    }
+}
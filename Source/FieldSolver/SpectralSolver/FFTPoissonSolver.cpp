@@ -0,0 +1,207 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "FFTPoissonSolver.H"
+#include "Utils/WarpXConst.H"
+
+#include <AMReX_ParallelDescriptor.H>
+
+#include <cmath>
+
+#ifndef WARPX_DIM_RZ
+
+using namespace amrex;
+
+FFTPoissonSolver::FFTPoissonSolver (amrex::Geometry const& geom)
+    : m_geom(geom)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(geom.isAllPeriodic() || !geom.isAnyPeriodic(),
+        "warpx.poisson_solver = fft requires a domain that is either periodic "
+        "in all directions, or in none (open boundaries)");
+    m_open = !geom.isAnyPeriodic();
+
+    // Nodal points of the domain: in the periodic case, the last point is the periodic
+    // image of the first one, and is left out. With open boundaries, all the points are
+    // kept, and the domain is zero-padded to twice its number of points.
+    Box const& domain = geom.Domain();
+    IntVect const n = m_open ? domain.length() + IntVect::TheUnitVector() : domain.length();
+    IntVect const n_fft = m_open ? 2*n : n;
+    Box const real_bx(domain.smallEnd(), domain.smallEnd() + n_fft - IntVect::TheUnitVector(),
+                      IndexType::TheNodeType());
+    IntVect spectral_hi = domain.smallEnd() + n_fft - IntVect::TheUnitVector();
+    spectral_hi[0] = domain.smallEnd(0) + n_fft[0]/2;
+    Box const spectral_bx(domain.smallEnd(), spectral_hi);
+    m_real_ba = BoxArray(real_bx);
+    m_spectral_ba = BoxArray(spectral_bx);
+    m_dm = DistributionMapping(Vector<int>{ParallelDescriptor::IOProcessorNumber()});
+
+    m_real.define(m_real_ba, m_dm, 1, 0);
+    m_rho_hat.define(m_spectral_ba, m_dm, 1, 0);
+    m_green_hat.define(m_spectral_ba, m_dm, 1, 0);
+
+    m_forward_plan = AnyFFT::FFTplans(m_spectral_ba, m_dm);
+    m_backward_plan = AnyFFT::FFTplans(m_spectral_ba, m_dm);
+    for (MFIter mfi(m_real); mfi.isValid(); ++mfi) {
+        IntVect const fft_size = m_real_ba[mfi.index()].length();
+        m_forward_plan[mfi] = AnyFFT::CreatePlan(
+            fft_size, m_real[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>(m_rho_hat[mfi].dataPtr()),
+            AnyFFT::direction::R2C, AMREX_SPACEDIM);
+        m_backward_plan[mfi] = AnyFFT::CreatePlan(
+            fft_size, m_real[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>(m_rho_hat[mfi].dataPtr()),
+            AnyFFT::direction::C2R, AMREX_SPACEDIM);
+    }
+}
+
+FFTPoissonSolver::~FFTPoissonSolver ()
+{
+    for (MFIter mfi(m_real); mfi.isValid(); ++mfi) {
+        AnyFFT::DestroyPlan(m_forward_plan[mfi]);
+        AnyFFT::DestroyPlan(m_backward_plan[mfi]);
+    }
+}
+
+void
+FFTPoissonSolver::ComputeGreenFunction (std::array<amrex::Real, 3> const beta)
+{
+    // Components of beta along the axes of the grid, and the operator
+    // nabla^2 - (beta.nabla)^2 = div( (I - beta beta^T) grad )
+#if (AMREX_SPACEDIM == 2)
+    double const b[2] = {beta[0], beta[2]};  // beta_x and beta_z
+#else
+    double const b[3] = {beta[0], beta[1], beta[2]};
+#endif
+    double b2 = 0.;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) b2 += b[idim]*b[idim];
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(b2 < 1., "FFTPoissonSolver: |beta| must be smaller than 1");
+    // determinant of I - beta beta^T
+    double const det = 1. - b2;
+
+    Real const* dx_lev = m_geom.CellSize();
+    double dx[AMREX_SPACEDIM];
+    double dV = 1.;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        dx[idim] = dx_lev[idim];
+        dV *= dx[idim];
+    }
+    double const pi = MathConst::pi;
+    double const ep0 = PhysConst::ep0;
+    bool const open = m_open;
+
+    for (MFIter mfi(m_real); mfi.isValid(); ++mfi) {
+        Box const& real_bx = m_real_ba[mfi.index()];
+        Box const& spectral_bx = m_spectral_ba[mfi.index()];
+        IntVect const lo = real_bx.smallEnd();
+        IntVect const n_fft = real_bx.length();
+        double const inv_npts = 1. / static_cast<double>(real_bx.numPts());
+        Array4<Real> const& green_hat_arr = m_green_hat.array(mfi);
+
+        if (open) {
+            // Free-space Green function of div( (I - beta beta^T) grad ), wrapped around
+            // the padded box, so that the circular convolution is the open one on the domain.
+            // With q^2 = r^T (I - beta beta^T)^-1 r = r^2 + (beta.r)^2/(1-beta^2):
+            // G = 1/(4 pi sqrt(det) q) in 3D, and G = -ln(q)/(2 pi sqrt(det)) in 2D.
+            // At r = 0, G is averaged over a sphere (disk) of the volume (area) of a cell.
+#if (AMREX_SPACEDIM == 2)
+            double const R0 = std::sqrt(dV/pi);
+            double const G0 = -(std::log(R0) - 0.5) / (2.*pi*std::sqrt(det));
+#else
+            double const R0 = std::cbrt(3.*dV/(4.*pi));
+            double const G0 = 3. / (8.*pi*R0*std::sqrt(det));
+#endif
+            Array4<Real> const& real_arr = m_real.array(mfi);
+            ParallelFor(real_bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                IntVect const iv(AMREX_D_DECL(i,j,k));
+                double r2 = 0.;
+                double br = 0.;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    int const ii = iv[idim] - lo[idim];
+                    int const m = n_fft[idim]/2;
+                    double const x = ((ii < m) ? ii : ii - 2*m) * dx[idim];
+                    r2 += x*x;
+                    br += b[idim]*x;
+                }
+                double G = G0;
+                if (r2 > 0.) {
+                    double const q2 = r2 + br*br/det;
+#if (AMREX_SPACEDIM == 2)
+                    G = -0.5*std::log(q2) / (2.*pi*std::sqrt(det));
+#else
+                    G = 1. / (4.*pi*std::sqrt(det)*std::sqrt(q2));
+#endif
+                }
+                real_arr(i,j,k) = static_cast<Real>(G);
+            });
+            AnyFFT::Execute(m_forward_plan[mfi]);
+
+            // The Green function is real and even, so its Fourier transform is real
+            Array4<Complex const> const& G_hat_arr = m_rho_hat.const_array(mfi);
+            Real const coef = static_cast<Real>(dV * inv_npts / ep0);
+            ParallelFor(spectral_bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                green_hat_arr(i,j,k) = coef * G_hat_arr(i,j,k).real();
+            });
+
+        } else {
+            // Periodic domain: phi_hat = rho_hat / ( ep0 (k^2 - (beta.k)^2) ),
+            // and the mode k = 0 (i.e. the average of phi) is set to zero
+            ParallelFor(spectral_bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                IntVect const iv(AMREX_D_DECL(i,j,k));
+                double k2 = 0.;
+                double bk = 0.;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    int const nk = n_fft[idim];
+                    int ik = iv[idim] - lo[idim];
+                    // R2C along the first axis: only the positive wavenumbers are stored
+                    if (idim > 0 && ik > nk/2) ik -= nk;
+                    double const kk = 2.*pi*ik / (nk*dx[idim]);
+                    k2 += kk*kk;
+                    bk += b[idim]*kk;
+                }
+                double const denom = k2 - bk*bk;
+                green_hat_arr(i,j,k) = (k2 > 0.) ? static_cast<Real>(inv_npts / (ep0*denom)) : 0._rt;
+            });
+        }
+    }
+    Gpu::synchronize();
+
+    m_beta = beta;
+    m_green_is_valid = true;
+}
+
+void
+FFTPoissonSolver::Solve (amrex::MultiFab const& rho, amrex::MultiFab& phi,
+                         std::array<amrex::Real, 3> const beta)
+{
+    // The Green function only needs to be recomputed when beta changes
+    if (!m_green_is_valid || beta != m_beta) ComputeGreenFunction(beta);
+
+    // gather rho on the (zero-padded) box
+    m_real.setVal(0._rt);
+    m_real.ParallelCopy(rho, 0, 0, 1);
+
+    for (MFIter mfi(m_real); mfi.isValid(); ++mfi) {
+        AnyFFT::Execute(m_forward_plan[mfi]);
+        Array4<Complex> const& rho_hat_arr = m_rho_hat.array(mfi);
+        Array4<Real const> const& green_hat_arr = m_green_hat.const_array(mfi);
+        ParallelFor(m_spectral_ba[mfi.index()], [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            rho_hat_arr(i,j,k) = green_hat_arr(i,j,k) * rho_hat_arr(i,j,k);
+        });
+        AnyFFT::Execute(m_backward_plan[mfi]);
+    }
+
+    // scatter phi back to the nodes of the domain; in the periodic case, the periodic
+    // copy sets the last point of the domain, from the first one
+    phi.setVal(0._rt);
+    phi.ParallelCopy(m_real, 0, 0, 1, IntVect(0), IntVect(0), m_geom.periodicity());
+    phi.FillBoundary(m_geom.periodicity());
+}
+
+#endif // WARPX_DIM_RZ
@@ -0,0 +1,260 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "MagDemagSolver.H"
+
+#include <AMReX_ParallelDescriptor.H>
+
+#include <cmath>
+
+#if defined(WARPX_MAG_LLG) && (AMREX_SPACEDIM == 3)
+
+using namespace amrex;
+
+namespace
+{
+    /** Newell's function f, whose second differences give the diagonal of the demagnetizing tensor */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    double NewellF (double x, double y, double z)
+    {
+        x = std::abs(x); y = std::abs(y); z = std::abs(z);
+        double const x2 = x*x, y2 = y*y, z2 = z*z;
+        double const R = std::sqrt(x2 + y2 + z2);
+        double f = (2.*x2 - y2 - z2) * R / 6.;
+        if (x2 + z2 > 0.) f += 0.5 * y * (z2 - x2) * std::asinh(y / std::sqrt(x2 + z2));
+        if (x2 + y2 > 0.) f += 0.5 * z * (y2 - x2) * std::asinh(z / std::sqrt(x2 + y2));
+        if (x * R > 0.) f -= x * y * z * std::atan(y * z / (x * R));
+        return f;
+    }
+
+    /** Newell's function g, whose second differences give the off-diagonal of the demagnetizing tensor */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    double NewellG (double x, double y, double z)
+    {
+        // g is odd in x and y, and even in z
+        double const sign = ((x < 0.) ? -1. : 1.) * ((y < 0.) ? -1. : 1.);
+        x = std::abs(x); y = std::abs(y); z = std::abs(z);
+        double const x2 = x*x, y2 = y*y, z2 = z*z;
+        double const R = std::sqrt(x2 + y2 + z2);
+        double g = - x * y * R / 3.;
+        if (x2 + y2 > 0.) g += x * y * z * std::asinh(z / std::sqrt(x2 + y2));
+        if (y2 + z2 > 0.) g += y / 6. * (3.*z2 - y2) * std::asinh(x / std::sqrt(y2 + z2));
+        if (x2 + z2 > 0.) g += x / 6. * (3.*z2 - x2) * std::asinh(y / std::sqrt(x2 + z2));
+        if (z * R > 0.) g -= z*z2 / 6. * std::atan(x * y / (z * R));
+        if (y * R > 0.) g -= z * y2 / 2. * std::atan(x * z / (y * R));
+        if (x * R > 0.) g -= z * x2 / 2. * std::atan(y * z / (x * R));
+        return sign * g;
+    }
+
+    /** \brief Component comp of the demagnetizing tensor between two cells of size (dx,dy,dz)
+     * separated by (X,Y,Z), such that H = - N * M
+     *
+     * The analytical expression of Newell et al. (J. Geophys. Res. 98, 9551, 1993) loses
+     * accuracy at large distances due to cancellations, where the point dipole approximation
+     * is used instead.
+     */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    double DemagTensor (int comp, double X, double Y, double Z, double dx, double dy, double dz)
+    {
+        double const pi = 3.14159265358979323846;
+        double const r2 = X*X + Y*Y + Z*Z;
+        double const dmax = amrex::max(dx, amrex::max(dy, dz));
+        if (r2 > 32.*32.*dmax*dmax) {
+            double const r_a = (comp == MagDemagSolver::xx || comp == MagDemagSolver::xy || comp == MagDemagSolver::xz) ? X
+                             : (comp == MagDemagSolver::yy || comp == MagDemagSolver::yz) ? Y : Z;
+            double const r_b = (comp == MagDemagSolver::xx) ? X
+                             : (comp == MagDemagSolver::yy || comp == MagDemagSolver::xy) ? Y : Z;
+            double const delta = (comp < MagDemagSolver::xy) ? 1. : 0.;
+            double const r = std::sqrt(r2);
+            return dx*dy*dz / (4.*pi) * (delta / (r2*r) - 3. * r_a * r_b / (r2*r2*r));
+        }
+        // weights of the second difference along each direction
+        double const w[3] = {1., -2., 1.};
+        double N = 0.;
+        for (int c = -1; c <= 1; ++c) {
+            for (int b = -1; b <= 1; ++b) {
+                for (int a = -1; a <= 1; ++a) {
+                    double const x = X + a*dx, y = Y + b*dy, z = Z + c*dz;
+                    double F = 0.;
+                    switch (comp) {
+                        case MagDemagSolver::xx : F = NewellF(x, y, z); break;
+                        case MagDemagSolver::yy : F = NewellF(y, z, x); break;
+                        case MagDemagSolver::zz : F = NewellF(z, x, y); break;
+                        case MagDemagSolver::xy : F = NewellG(x, y, z); break;
+                        case MagDemagSolver::xz : F = NewellG(x, z, y); break;
+                        default                 : F = NewellG(y, z, x); break;
+                    }
+                    N += w[a+1] * w[b+1] * w[c+1] * F;
+                }
+            }
+        }
+        return - N / (4.*pi*dx*dy*dz);
+    }
+}
+
+MagDemagSolver::MagDemagSolver (amrex::Geometry const& geom)
+    : m_geom(geom), m_domain(geom.Domain())
+{
+    // zero-padded domain, and its R2C transform (n/2+1 points along x)
+    IntVect const n = m_domain.length();
+    Box const real_bx(m_domain.smallEnd(), m_domain.smallEnd() + 2*n - IntVect::TheUnitVector());
+    IntVect spectral_hi = real_bx.bigEnd();
+    spectral_hi[0] = m_domain.smallEnd(0) + n[0];
+    Box const spectral_bx(m_domain.smallEnd(), spectral_hi);
+    m_real_ba = BoxArray(real_bx);
+    m_spectral_ba = BoxArray(spectral_bx);
+    m_dm = DistributionMapping(Vector<int>{ParallelDescriptor::IOProcessorNumber()});
+
+    m_real.define(m_real_ba, m_dm, 3, 0);
+    m_M_hat.define(m_spectral_ba, m_dm, 3, 0);
+    m_H_hat.define(m_spectral_ba, m_dm, 3, 0);
+    m_N_hat.define(m_spectral_ba, m_dm, ncomps, 0);
+
+    for (int comp = 0; comp < 3; ++comp) {
+        m_forward_plan[comp] = AnyFFT::FFTplans(m_spectral_ba, m_dm);
+        m_backward_plan[comp] = AnyFFT::FFTplans(m_spectral_ba, m_dm);
+    }
+
+    Real const* dx_lev = geom.CellSize();
+    double const dx = dx_lev[0], dy = dx_lev[1], dz = dx_lev[2];
+    Dim3 const lo = lbound(m_domain);
+
+    for (MFIter mfi(m_real); mfi.isValid(); ++mfi) {
+        IntVect const fft_size = m_real_ba[mfi.index()].length();
+        for (int comp = 0; comp < 3; ++comp) {
+            m_forward_plan[comp][mfi] = AnyFFT::CreatePlan(
+                fft_size, m_real[mfi].dataPtr(comp),
+                reinterpret_cast<AnyFFT::Complex*>(m_M_hat[mfi].dataPtr(comp)),
+                AnyFFT::direction::R2C, 3);
+            m_backward_plan[comp][mfi] = AnyFFT::CreatePlan(
+                fft_size, m_real[mfi].dataPtr(comp),
+                reinterpret_cast<AnyFFT::Complex*>(m_H_hat[mfi].dataPtr(comp)),
+                AnyFFT::direction::C2R, 3);
+        }
+
+        // Fourier transform of the demagnetizing tensor, component by component, using the
+        // first component of m_real and m_M_hat as temporary storage. The tensor is wrapped
+        // around the padded box, so that the circular convolution is the open one on the domain.
+        Array4<Real> const& real_arr = m_real.array(mfi);
+        Array4<Complex const> const& M_hat_arr = m_M_hat.const_array(mfi);
+        Array4<Complex> const& N_hat_arr = m_N_hat.array(mfi);
+        for (int comp = 0; comp < ncomps; ++comp) {
+            ParallelFor(real_bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                int const ii = i - lo.x, jj = j - lo.y, kk = k - lo.z;
+                double const X = ((ii < n[0]) ? ii : ii - 2*n[0]) * dx;
+                double const Y = ((jj < n[1]) ? jj : jj - 2*n[1]) * dy;
+                double const Z = ((kk < n[2]) ? kk : kk - 2*n[2]) * dz;
+                real_arr(i,j,k,0) = static_cast<Real>(DemagTensor(comp, X, Y, Z, dx, dy, dz));
+            });
+            AnyFFT::Execute(m_forward_plan[0][mfi]);
+            ParallelFor(spectral_bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                N_hat_arr(i,j,k,comp) = M_hat_arr(i,j,k,0);
+            });
+        }
+    }
+}
+
+MagDemagSolver::~MagDemagSolver ()
+{
+    for (MFIter mfi(m_real); mfi.isValid(); ++mfi) {
+        for (int comp = 0; comp < 3; ++comp) {
+            AnyFFT::DestroyPlan(m_forward_plan[comp][mfi]);
+            AnyFFT::DestroyPlan(m_backward_plan[comp][mfi]);
+        }
+    }
+}
+
+void
+MagDemagSolver::ComputeDemagField (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& Mfield,
+                                   std::array<std::unique_ptr<amrex::MultiFab>, 3>& Hfield)
+{
+    // average each component of M to the cell centers, from the faces normal to this component
+    BoxArray const ba_cc = amrex::convert(Mfield[0]->boxArray(), IntVect::TheCellVector());
+    DistributionMapping const& dm = Mfield[0]->DistributionMap();
+    MultiFab M_cc(ba_cc, dm, 3, 0);
+    for (MFIter mfi(M_cc, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        Box const& bx = mfi.tilebox();
+        Array4<Real> const& M_cc_arr = M_cc.array(mfi);
+        Array4<Real const> const& M_xface = Mfield[0]->const_array(mfi);
+        Array4<Real const> const& M_yface = Mfield[1]->const_array(mfi);
+        Array4<Real const> const& M_zface = Mfield[2]->const_array(mfi);
+        ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            M_cc_arr(i,j,k,0) = 0.5_rt * (M_xface(i,j,k,0) + M_xface(i+1,j,k,0));
+            M_cc_arr(i,j,k,1) = 0.5_rt * (M_yface(i,j,k,1) + M_yface(i,j+1,k,1));
+            M_cc_arr(i,j,k,2) = 0.5_rt * (M_zface(i,j,k,2) + M_zface(i,j,k+1,2));
+        });
+    }
+
+    // gather M on the zero-padded box
+    m_real.setVal(0._rt);
+    m_real.ParallelCopy(M_cc, 0, 0, 3);
+
+    // H_hat = - N_hat * M_hat, including the normalization of the FFTs
+    Real const inv_npts = 1._rt / static_cast<Real>(m_real_ba[0].numPts());
+    for (MFIter mfi(m_real); mfi.isValid(); ++mfi) {
+        for (int comp = 0; comp < 3; ++comp) {
+            AnyFFT::Execute(m_forward_plan[comp][mfi]);
+        }
+        Array4<Complex const> const& M_hat_arr = m_M_hat.const_array(mfi);
+        Array4<Complex const> const& N_hat_arr = m_N_hat.const_array(mfi);
+        Array4<Complex> const& H_hat_arr = m_H_hat.array(mfi);
+        ParallelFor(m_spectral_ba[mfi.index()], [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+        {
+            Complex const Mx = M_hat_arr(i,j,k,0);
+            Complex const My = M_hat_arr(i,j,k,1);
+            Complex const Mz = M_hat_arr(i,j,k,2);
+            H_hat_arr(i,j,k,0) = - inv_npts * (N_hat_arr(i,j,k,xx)*Mx + N_hat_arr(i,j,k,xy)*My + N_hat_arr(i,j,k,xz)*Mz);
+            H_hat_arr(i,j,k,1) = - inv_npts * (N_hat_arr(i,j,k,xy)*Mx + N_hat_arr(i,j,k,yy)*My + N_hat_arr(i,j,k,yz)*Mz);
+            H_hat_arr(i,j,k,2) = - inv_npts * (N_hat_arr(i,j,k,xz)*Mx + N_hat_arr(i,j,k,yz)*My + N_hat_arr(i,j,k,zz)*Mz);
+        });
+        for (int comp = 0; comp < 3; ++comp) {
+            AnyFFT::Execute(m_backward_plan[comp][mfi]);
+        }
+    }
+
+    // scatter H back to the cell centers of the domain
+    MultiFab H_cc(ba_cc, dm, 3, 1);
+    H_cc.setVal(0._rt);
+    H_cc.ParallelCopy(m_real, 0, 0, 3);
+    H_cc.FillBoundary(m_geom.periodicity());
+
+    // interpolate H to the faces, one-sided on the faces of the domain boundary
+    Dim3 const lo = lbound(m_domain);
+    Dim3 const hi = ubound(m_domain);
+    for (MFIter mfi(*Hfield[0], TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+        Box const& tbx = mfi.tilebox(Hfield[0]->ixType().toIntVect());
+        Box const& tby = mfi.tilebox(Hfield[1]->ixType().toIntVect());
+        Box const& tbz = mfi.tilebox(Hfield[2]->ixType().toIntVect());
+        Array4<Real> const& Hx = Hfield[0]->array(mfi);
+        Array4<Real> const& Hy = Hfield[1]->array(mfi);
+        Array4<Real> const& Hz = Hfield[2]->array(mfi);
+        Array4<Real const> const& H_cc_arr = H_cc.const_array(mfi);
+        ParallelFor(tbx, tby, tbz,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                Hx(i,j,k) = (i == lo.x) ? H_cc_arr(i,j,k,0) : (i == hi.x+1) ? H_cc_arr(i-1,j,k,0)
+                          : 0.5_rt * (H_cc_arr(i-1,j,k,0) + H_cc_arr(i,j,k,0));
+            },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                Hy(i,j,k) = (j == lo.y) ? H_cc_arr(i,j,k,1) : (j == hi.y+1) ? H_cc_arr(i,j-1,k,1)
+                          : 0.5_rt * (H_cc_arr(i,j-1,k,1) + H_cc_arr(i,j,k,1));
+            },
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
+            {
+                Hz(i,j,k) = (k == lo.z) ? H_cc_arr(i,j,k,2) : (k == hi.z+1) ? H_cc_arr(i,j,k-1,2)
+                          : 0.5_rt * (H_cc_arr(i,j,k-1,2) + H_cc_arr(i,j,k,2));
+            });
+    }
+    for (int i = 0; i < 3; ++i) {
+        Hfield[i]->FillBoundary(m_geom.periodicity());
+    }
+}
+
+#endif // WARPX_MAG_LLG && AMREX_SPACEDIM == 3
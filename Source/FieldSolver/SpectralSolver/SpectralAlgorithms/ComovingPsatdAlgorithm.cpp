@@ -1,5 +1,6 @@
 #include "ComovingPsatdAlgorithm.H"
 #include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
 
 #if WARPX_USE_PSATD
 
@@ -501,4 +502,17 @@ ComovingPsatdAlgorithm::VayDeposition (const int /*lev*/,
     amrex::Abort("Vay deposition not implemented for comoving PSATD");
 }
 
+amrex::Long
+ComovingPsatdAlgorithm::CoefficientBytes () const
+{
+    amrex::Long nbytes = 0;
+    for (auto const* coef : {&C_coef, &S_ck_coef}) {
+        nbytes += WarpXUtilMemory::FabArrayBytes(coef);
+    }
+    for (auto const* coef : {&Theta2_coef, &X1_coef, &X2_coef, &X3_coef, &X4_coef}) {
+        nbytes += WarpXUtilMemory::FabArrayBytes(coef);
+    }
+    return nbytes;
+}
+
 #endif // WARPX_USE_PSATD
@@ -6,6 +6,7 @@
  */
 #include "PMLPsatdAlgorithm.H"
 #include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
 
 #include <cmath>
 
@@ -242,4 +243,14 @@ PMLPsatdAlgorithm::VayDeposition (const int /*lev*/,
     amrex::Abort("Vay deposition not implemented for PML PSATD");
 }
 
+amrex::Long
+PMLPsatdAlgorithm::CoefficientBytes () const
+{
+    amrex::Long nbytes = 0;
+    for (auto const* coef : {&C_coef, &S_ck_coef, &inv_k2_coef}) {
+        nbytes += WarpXUtilMemory::FabArrayBytes(coef);
+    }
+    return nbytes;
+}
+
 #endif // WARPX_USE_PSATD
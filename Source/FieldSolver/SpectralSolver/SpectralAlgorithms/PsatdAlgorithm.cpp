@@ -5,7 +5,9 @@
  * License: BSD-3-Clause-LBNL
  */
 #include "PsatdAlgorithm.H"
+#include "PsatdCoefficients.H"
 #include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
 
 #include <cmath>
 
@@ -23,7 +25,8 @@ PsatdAlgorithm::PsatdAlgorithm(
     const Array<Real,3>& v_galilean,
     const Real dt,
     const bool update_with_rho,
-    const bool time_averaging)
+    const bool time_averaging,
+    const bool on_the_fly_coefficients)
     // Initializer list
     : SpectralBaseAlgorithm(spectral_kspace, dm, norder_x, norder_y, norder_z, nodal),
     // Initialize the centered finite-order modified k vectors: these are computed
@@ -39,12 +42,17 @@ PsatdAlgorithm::PsatdAlgorithm(
     m_v_galilean(v_galilean),
     m_dt(dt),
     m_update_with_rho(update_with_rho),
-    m_time_averaging(time_averaging)
+    m_time_averaging(time_averaging),
+    m_on_the_fly_coefficients(on_the_fly_coefficients)
 {
     const BoxArray& ba = spectral_kspace.spectralspace_ba;
 
     m_is_galilean = (v_galilean[0] != 0.) || (v_galilean[1] != 0.) || (v_galilean[2] != 0.);
 
+    // With on-the-fly coefficients, nothing is stored: the coefficients are
+    // computed again in pushSpectralFields, at each time step
+    if (m_on_the_fly_coefficients) return;
+
     // Always allocate these coefficients
     C_coef = SpectralRealCoefficients(ba, dm, 1, 0);
     S_ck_coef = SpectralRealCoefficients(ba, dm, 1, 0);
@@ -61,15 +69,9 @@ PsatdAlgorithm::PsatdAlgorithm(
     // Allocate these coefficients only with averaged Galilean PSATD
     if (time_averaging)
     {
-        C1_coef = SpectralRealCoefficients(ba, dm, 1, 0);
-        S1_coef = SpectralRealCoefficients(ba, dm, 1, 0);
-        C3_coef = SpectralRealCoefficients(ba, dm, 1, 0);
-        S3_coef = SpectralRealCoefficients(ba, dm, 1, 0);
         Psi1_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
         Psi2_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
-        Psi3_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
         A1_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
-        A2_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
         Rhoold_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
         Rhonew_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
         Jcoef_coef = SpectralComplexCoefficients(ba, dm, 1, 0);
@@ -85,6 +87,15 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
     const bool update_with_rho = m_update_with_rho;
     const bool time_averaging  = m_time_averaging;
     const bool is_galilean     = m_is_galilean;
+    const bool on_the_fly      = m_on_the_fly_coefficients;
+    const Real dt = m_dt;
+
+    // Extract Galilean velocity
+    const Real vx = m_v_galilean[0];
+#if (AMREX_SPACEDIM==3)
+    const Real vy = m_v_galilean[1];
+#endif
+    const Real vz = m_v_galilean[2];
 
     // Loop over boxes
     for (MFIter mfi(f.fields); mfi.isValid(); ++mfi)
@@ -94,20 +105,16 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
         // Extract arrays for the fields to be updated
         Array4<Complex> fields = f.fields[mfi].array();
 
-        // These coefficients are always allocated
-        Array4<const Real> C_arr = C_coef[mfi].array();
-        Array4<const Real> S_ck_arr = S_ck_coef[mfi].array();
-        Array4<const Complex> X1_arr = X1_coef[mfi].array();
-        Array4<const Complex> X2_arr = X2_coef[mfi].array();
-        Array4<const Complex> X3_arr = X3_coef[mfi].array();
+        // These coefficients are allocated unless they are computed on the fly
+        Array4<const Real> C_arr;
+        Array4<const Real> S_ck_arr;
+        Array4<const Complex> X1_arr;
+        Array4<const Complex> X2_arr;
+        Array4<const Complex> X3_arr;
 
+        // These coefficients are allocated only with Galilean PSATD
         Array4<const Complex> X4_arr;
         Array4<const Complex> T2_arr;
-        if (is_galilean)
-        {
-            X4_arr = X4_coef[mfi].array();
-            T2_arr = T2_coef[mfi].array();
-        }
 
         // These coefficients are allocated only with averaged Galilean PSATD
         Array4<const Complex> Psi1_arr;
@@ -117,22 +124,40 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
         Array4<const Complex> Rhoold_arr;
         Array4<const Complex> Jcoef_arr;
 
-        if (time_averaging)
+        if (!on_the_fly)
         {
-            Psi1_arr = Psi1_coef[mfi].array();
-            Psi2_arr = Psi2_coef[mfi].array();
-            A1_arr = A1_coef[mfi].array();
-            Rhonew_arr = Rhonew_coef[mfi].array();
-            Rhoold_arr = Rhoold_coef[mfi].array();
-            Jcoef_arr = Jcoef_coef[mfi].array();
+            C_arr = C_coef[mfi].array();
+            S_ck_arr = S_ck_coef[mfi].array();
+            X1_arr = X1_coef[mfi].array();
+            X2_arr = X2_coef[mfi].array();
+            X3_arr = X3_coef[mfi].array();
+
+            if (is_galilean)
+            {
+                X4_arr = X4_coef[mfi].array();
+                T2_arr = T2_coef[mfi].array();
+            }
+
+            if (time_averaging)
+            {
+                Psi1_arr = Psi1_coef[mfi].array();
+                Psi2_arr = Psi2_coef[mfi].array();
+                A1_arr = A1_coef[mfi].array();
+                Rhonew_arr = Rhonew_coef[mfi].array();
+                Rhoold_arr = Rhoold_coef[mfi].array();
+                Jcoef_arr = Jcoef_coef[mfi].array();
+            }
         }
 
         // Extract pointers for the k vectors
         const Real* modified_kx_arr = modified_kx_vec[mfi].dataPtr();
+        const Real* modified_kx_arr_c = modified_kx_vec_centered[mfi].dataPtr();
 #if (AMREX_SPACEDIM==3)
         const Real* modified_ky_arr = modified_ky_vec[mfi].dataPtr();
+        const Real* modified_ky_arr_c = modified_ky_vec_centered[mfi].dataPtr();
 #endif
         const Real* modified_kz_arr = modified_kz_vec[mfi].dataPtr();
+        const Real* modified_kz_arr_c = modified_kz_vec_centered[mfi].dataPtr();
 
         // Loop over indices within one box
         ParallelFor(bx, [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept
@@ -170,14 +195,56 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
             constexpr Real inv_ep0 = 1._rt / PhysConst::ep0;
             constexpr Complex I = Complex{0._rt, 1._rt};
 
-            // These coefficients are initialized in the function InitializeSpectralCoefficients
-            const Real C = C_arr(i,j,k);
-            const Real S_ck = S_ck_arr(i,j,k);
-            const Complex X1 = X1_arr(i,j,k);
-            const Complex X2 = X2_arr(i,j,k);
-            const Complex X3 = X3_arr(i,j,k);
-            const Complex X4 = (is_galilean) ? X4_arr(i,j,k) : - S_ck * inv_ep0;
-            const Complex T2 = (is_galilean) ? T2_arr(i,j,k) : 1.0_rt;
+            // These coefficients are initialized in the function InitializeSpectralCoefficients,
+            // or computed here with on-the-fly coefficients
+            PsatdCoefficients coef;
+            if (on_the_fly)
+            {
+                // Norms of the k vectors and dot product of the centered k vector with the
+                // Galilean velocity (see InitializeSpectralCoefficients)
+#if (AMREX_SPACEDIM==3)
+                const Real knorm = std::sqrt(kx*kx + ky*ky + kz*kz);
+                const Real kx_c = modified_kx_arr_c[i];
+                const Real ky_c = modified_ky_arr_c[j];
+                const Real kz_c = modified_kz_arr_c[k];
+                const Real knorm_c = std::sqrt(kx_c*kx_c + ky_c*ky_c + kz_c*kz_c);
+                const Real kv = kx_c*vx + ky_c*vy + kz_c*vz;
+#else
+                const Real knorm = std::sqrt(kx*kx + kz*kz);
+                const Real kx_c = modified_kx_arr_c[i];
+                const Real kz_c = modified_kz_arr_c[j];
+                const Real knorm_c = std::sqrt(kx_c*kx_c + kz_c*kz_c);
+                const Real kv = kx_c*vx + kz_c*vz;
+#endif
+                coef = PsatdComputeCoefficients(knorm, knorm_c, kv, dt,
+                                                update_with_rho, is_galilean, time_averaging);
+            }
+            else
+            {
+                coef.C = C_arr(i,j,k);
+                coef.S_ck = S_ck_arr(i,j,k);
+                coef.X1 = X1_arr(i,j,k);
+                coef.X2 = X2_arr(i,j,k);
+                coef.X3 = X3_arr(i,j,k);
+                coef.X4 = (is_galilean) ? X4_arr(i,j,k) : - coef.S_ck * inv_ep0;
+                coef.T2 = (is_galilean) ? T2_arr(i,j,k) : 1.0_rt;
+                if (time_averaging)
+                {
+                    coef.Psi1 = Psi1_arr(i,j,k);
+                    coef.Psi2 = Psi2_arr(i,j,k);
+                    coef.A1 = A1_arr(i,j,k);
+                    coef.CRhoold = Rhoold_arr(i,j,k);
+                    coef.CRhonew = Rhonew_arr(i,j,k);
+                    coef.Jcoef = Jcoef_arr(i,j,k);
+                }
+            }
+            const Real C = coef.C;
+            const Real S_ck = coef.S_ck;
+            const Complex X1 = coef.X1;
+            const Complex X2 = coef.X2;
+            const Complex X3 = coef.X3;
+            const Complex X4 = coef.X4;
+            const Complex T2 = coef.T2;
 
             // Update equations for E in the formulation with rho
             // T2 = 1 always with standard PSATD (zero Galilean velocity)
@@ -234,13 +301,12 @@ PsatdAlgorithm::pushSpectralFields (SpectralFieldData& f) const
 
             if (time_averaging)
             {
-                // These coefficients are initialized in the function InitializeSpectralCoefficients below
-                const Complex Psi1 = Psi1_arr(i,j,k);
-                const Complex Psi2 = Psi2_arr(i,j,k);
-                const Complex A1 = A1_arr(i,j,k);
-                const Complex CRhoold = Rhoold_arr(i,j,k);
-                const Complex CRhonew = Rhonew_arr(i,j,k);
-                const Complex Jcoef = Jcoef_arr(i,j,k);
+                const Complex Psi1 = coef.Psi1;
+                const Complex Psi2 = coef.Psi2;
+                const Complex A1 = coef.A1;
+                const Complex CRhoold = coef.CRhoold;
+                const Complex CRhonew = coef.CRhonew;
+                const Complex Jcoef = coef.Jcoef;
 
                 fields(i,j,k,AvgIdx::Ex_avg) = Psi1 * Ex_old
                     - I * c2 * Psi2 * (ky * Bz_old - kz * By_old)
@@ -272,6 +338,9 @@ void PsatdAlgorithm::InitializeSpectralCoefficients (
     const amrex::DistributionMapping& dm,
     const amrex::Real dt)
 {
+    // With on-the-fly coefficients, nothing to initialize
+    if (m_on_the_fly_coefficients) return;
+
     const bool update_with_rho = m_update_with_rho;
     const bool time_averaging  = m_time_averaging;
     const bool is_galilean     = m_is_galilean;
@@ -309,30 +378,18 @@ void PsatdAlgorithm::InitializeSpectralCoefficients (
         }
 
         // Coefficients allocated only with averaged Galilean PSATD
-        Array4<Real> C1;
-        Array4<Real> S1;
-        Array4<Real> C3;
-        Array4<Real> S3;
         Array4<Complex> Psi1;
         Array4<Complex> Psi2;
-        Array4<Complex> Psi3;
         Array4<Complex> A1;
-        Array4<Complex> A2;
         Array4<Complex> CRhoold;
         Array4<Complex> CRhonew;
         Array4<Complex> Jcoef;
 
         if (time_averaging)
         {
-            C1 = C1_coef[mfi].array();
-            S1 = S1_coef[mfi].array();
-            C3 = C3_coef[mfi].array();
-            S3 = S3_coef[mfi].array();
             Psi1 = Psi1_coef[mfi].array();
             Psi2 = Psi2_coef[mfi].array();
-            Psi3 = Psi3_coef[mfi].array();
             A1 = A1_coef[mfi].array();
-            A2 = A2_coef[mfi].array();
             CRhoold = Rhoold_coef[mfi].array();
             CRhonew = Rhonew_coef[mfi].array();
             Jcoef = Jcoef_coef[mfi].array();
@@ -364,17 +421,6 @@ void PsatdAlgorithm::InitializeSpectralCoefficients (
 #else
                 std::pow(kz_c[j], 2));
 #endif
-            // Physical constants and imaginary unit
-            constexpr Real c = PhysConst::c;
-            constexpr Real c2 = c*c;
-            constexpr Real ep0 = PhysConst::ep0;
-            constexpr Complex I = Complex{0._rt, 1._rt};
-
-            // Auxiliary coefficients used when update_with_rho=false
-            const Real dt2 = dt * dt;
-            const Real dt3 = dt * dt2;
-            Complex X2_old, X3_old;
-
             // Calculate the dot product of the k vector with the Galilean velocity.
             // This has to be computed always with the centered (that is, nodal) finite-order
             // modified k vectors, to work correctly for both nodal and staggered simulations.
@@ -386,494 +432,30 @@ void PsatdAlgorithm::InitializeSpectralCoefficients (
                 kz_c[j]*vz;
 #endif
 
-            // Note that:
-            // - X1 multiplies i*(k \times J) in the update equation for B
-            // - X2 multiplies rho_new if update_with_rho = 1 or (k \dot E)
-            //      if update_with_rho = 0 in the update equation for E
-            // - X3 multiplies rho_old if update_with_rho = 1 or (k \dot J)
-            //      if update_with_rho = 0 in the update equation for E
-            // - X4 multiplies J in the update equation for E
-
-            if (knorm != 0. && knorm_c != 0.)
-            {
-                // Auxiliary coefficients
-                const Real om = c * knorm;
-                const Real om2 = om * om;
-                const Real om3 = om * om2;
-                const Real om_c = c * knorm_c;
-                const Real om2_c = om_c * om_c;
-                const Real om3_c = om_c * om2_c;
-                const Complex tmp1 = amrex::exp(  I * om * dt);
-                const Complex tmp2 = amrex::exp(- I * om * dt);
-
-                C   (i,j,k) = std::cos(om * dt);
-                S_ck(i,j,k) = std::sin(om * dt) / om;
-
-                if (time_averaging)
-                {
-                    C1(i,j,k) = std::cos(0.5_rt * om * dt);
-                    S1(i,j,k) = std::sin(0.5_rt * om * dt);
-                    C3(i,j,k) = std::cos(1.5_rt * om * dt);
-                    S3(i,j,k) = std::sin(1.5_rt * om * dt);
-                }
-
-                const Real nu = kv / om_c;
-                const Real nu2 = nu * nu;
-                const Complex theta = amrex::exp(I * nu * om_c * dt * 0.5_rt);
-                const Complex theta_star = amrex::exp(- I * nu * om_c * dt * 0.5_rt);
-
-                // T2 = 1 always with standard PSATD (zero Galilean velocity)
-                if (is_galilean)
-                {
-                    T2(i,j,k) = theta * theta;
-                }
-                const Complex T2_tmp = (is_galilean) ? T2(i,j,k) : 1.0_rt;
-
-                // nu = 0 always with standard PSATD (zero Galilean velocity): skip this block
-                if (nu != om/om_c && nu != -om/om_c && nu != 0.)
-                {
-                    // x1 is the coefficient chi_1 in equation (12c)
-                    Complex x1 = om2_c / (om2 - nu2 * om2_c)
-                        * (theta_star - theta * C(i,j,k) + I * nu * om_c * theta * S_ck(i,j,k));
-
-                    X1(i,j,k) = theta * x1 / (ep0 * om2_c);
-
-                    if (update_with_rho)
-                    {
-                        X2(i,j,k) = c2 * (x1 * om2 - theta * (1._rt - C(i,j,k)) * om2_c)
-                            / (theta_star - theta) / (ep0 * om2_c * om2);
-
-                        X3(i,j,k) = c2 * (x1 * om2 - theta_star * (1._rt - C(i,j,k)) * om2_c)
-                            / (theta_star - theta) / (ep0 * om2_c * om2);
-                    }
-
-                    else // update_with_rho = 0
-                    {
-                        X2_old = (x1 * om2 - theta * (1._rt - C(i,j,k)) * om2_c)
-                            / (theta_star - theta);
-
-                        X3_old = (x1 * om2 - theta_star * (1._rt - C(i,j,k)) * om2_c)
-                            / (theta_star - theta);
-
-                        X2(i,j,k) = c2 * T2_tmp * (X2_old - X3_old) / (om2_c * om2);
-
-                        X3(i,j,k) = I * c2 * X2_old * (T2_tmp - 1._rt) / (ep0 * nu * om3_c * om2);
-                    }
-
-                    if (is_galilean)
-                    {
-                        X4(i,j,k) = I * nu * om_c * X1(i,j,k) - T2_tmp * S_ck(i,j,k) / ep0;
-                    }
-
-                    // Averaged Galilean algorithm
-                    if (time_averaging)
-                    {
-                        Complex C_rho = I * c2 / ((1._rt - T2_tmp) * ep0);
-
-                        Psi1(i,j,k) = theta * ((om * S1(i,j,k) + I * nu * om_c * C1(i,j,k))
-                            - T2_tmp * (om * S3(i,j,k) + I * nu * om_c * C3(i,j,k)))
-                            / (dt * (nu2 * om2_c - om2));
-
-                        Psi2(i,j,k) = theta * ((om * C1(i,j,k) - I * nu * om_c * S1(i,j,k))
-                            - T2_tmp * (om * C3(i,j,k) - I * nu * om_c * S3(i,j,k)))
-                            / (om * dt * (nu2 * om2_c - om2));
-
-                        Psi3(i,j,k) = I * theta * (1._rt - T2_tmp) / (nu * om_c * dt);
-
-                        A1(i,j,k) = (Psi1(i,j,k) - 1._rt + I * nu * om_c * Psi2(i,j,k))
-                            / (nu2 * om2_c - om2);
-
-                        A2(i,j,k) = (Psi3(i,j,k) - Psi1(i,j,k)) / om2;
-
-                        CRhoold(i,j,k) = C_rho * (T2_tmp * A1(i,j,k) - A2(i,j,k));
-
-                        CRhonew(i,j,k) = C_rho * (A2(i,j,k) - A1(i,j,k));
-
-                        Jcoef(i,j,k) = (I * nu * om_c * A1(i,j,k) + Psi2(i,j,k)) / ep0;
-                    }
-                }
-
-                // nu = 0 always with standard PSATD (zero Galilean velocity)
-                if (nu == 0.)
-                {
-                    X1(i,j,k) = (1._rt - C(i,j,k)) / (ep0 * om2);
-
-                    if (update_with_rho)
-                    {
-                        X2(i,j,k) = c2 * (1._rt - S_ck(i,j,k) / dt) / (ep0 * om2);
-
-                        X3(i,j,k) = c2 * (C(i,j,k) - S_ck(i,j,k) / dt) / (ep0 * om2);
-                    }
-
-                    else // update_with_rho = 0
-                    {
-                        X2(i,j,k) = c2 * (1._rt - C(i,j,k)) / om2;
-
-                        X3(i,j,k) = c2 * (S_ck(i,j,k) / dt - 1._rt) * dt / (ep0 * om2);
-                    }
-
-                    if (is_galilean)
-                    {
-                        X4(i,j,k) = - S_ck(i,j,k) / ep0;
-                    }
-
-                    // Averaged Galilean algorithm
-                    if (time_averaging)
-                    {
-                        Psi1(i,j,k) = (S3(i,j,k) - S1(i,j,k)) / (om * dt);
-
-                        Psi2(i,j,k) = (C3(i,j,k) - C1(i,j,k)) / (om2 * dt);
-
-                        Psi3(i,j,k) = 1._rt;
-
-                        A1(i,j,k) = (om * dt + S1(i,j,k) - S3(i,j,k)) / (om3 * dt);
-
-                        A2(i,j,k) = (om * dt + S1(i,j,k) - S3(i,j,k)) / (om3 * dt);
-
-                        CRhoold(i,j,k) = 2._rt * I * c2 * S1(i,j,k) * (dt * C(i,j,k) - S_ck(i,j,k))
-                            / (om3 * dt2 * ep0);
-
-                        CRhonew(i,j,k) = - I * c2 * (om2 * dt2 - C1(i,j,k) + C3(i,j,k))
-                            / (om2 * om2 * dt2 * ep0);
-
-                        Jcoef(i,j,k) = (I * nu * om_c * A1(i,j,k) + Psi2(i,j,k)) / ep0;
-                    }
-                }
-
-                // nu = 0 always with standard PSATD (zero Galilean velocity): skip this block
-                if (nu == om/om_c)
-                {
-                    X1(i,j,k) = (1._rt - tmp1 * tmp1 + 2._rt * I * om * dt) / (4._rt * ep0 * om2);
-
-                    if (update_with_rho)
-                    {
-                        X2(i,j,k) = c2 * (- 3._rt + 4._rt * tmp1 - tmp1 * tmp1 - 2._rt * I * om * dt)
-                            / (4._rt * ep0 * om2 * (tmp1 - 1._rt));
-
-                        X3(i,j,k) = c2 * (3._rt - 2._rt * tmp2 - 2._rt * tmp1 + tmp1 * tmp1
-                            - 2._rt * I * om * dt) / (4._rt * ep0 * om2 * (tmp1 - 1._rt));
-                    }
-
-                    else // update_with_rho = 0
-                    {
-                        X2(i,j,k) = c2 * (1._rt - C(i,j,k)) * tmp1 / om2;
-
-                        X3(i,j,k) = c2 * (2._rt * om * dt - I * tmp1 * tmp1 + 4._rt * I * tmp1 - 3._rt * I)
-                            / (4._rt * ep0 * om3);
-                    }
-
-                    if (is_galilean)
-                    {
-                        X4(i,j,k) = (- I + I * tmp1 * tmp1 - 2._rt * om * dt) / (4._rt * ep0 * om);
-                    }
-
-                    // Averaged Galilean algorithm
-                    if (time_averaging)
-                    {
-                        Complex C_rho = I * c2 / ((1._rt - T2_tmp) * ep0);
-
-                        Psi1(i,j,k) = (2._rt * om * dt + I * tmp1 - I * tmp1 * tmp1 * tmp1)
-                            / (4._rt * om * dt);
-
-                        Psi2(i,j,k) = (- 2._rt * I * om * dt - tmp1 + tmp1 * tmp1 * tmp1)
-                            / (4._rt * om2 * dt);
-
-                        Psi3(i,j,k) = I * theta * (1._rt - T2_tmp) / (nu * om_c * dt);
-
-                        A1(i,j,k) = (2._rt * om * dt + I * (4._rt * om2 * dt2 - tmp1 + tmp1 * tmp1 * tmp1))
-                            / (8._rt * om3 * dt);
-
-                        A2(i,j,k) = (Psi3(i,j,k) - Psi1(i,j,k)) / om2;
-
-                        CRhoold(i,j,k) = C_rho * (T2_tmp * A1(i,j,k) - A2(i,j,k));
-
-                        CRhonew(i,j,k) = C_rho * (A2(i,j,k) - A1(i,j,k));
-
-                        Jcoef(i,j,k) = (I * nu * om_c * A1(i,j,k) + Psi2(i,j,k)) / ep0;
-                    }
-                }
-
-                // nu = 0 always with standard PSATD (zero Galilean velocity): skip this block
-                if (nu == -om/om_c)
-                {
-                    X1(i,j,k) = (1._rt - tmp2 * tmp2 - 2._rt * I * om * dt) / (4._rt * ep0 * om2);
-
-                    if (update_with_rho)
-                    {
-                        X2(i,j,k) = c2 * (- 4._rt + 3._rt * tmp1 + tmp2 - 2._rt * I * om * dt * tmp1)
-                            / (4._rt * ep0 * om2 * (tmp1 - 1._rt));
-
-                        X3(i,j,k) = c2 * (2._rt - tmp2 - 3._rt * tmp1 + 2._rt * tmp1 * tmp1
-                            - 2._rt * I * om * dt * tmp1) / (4._rt * ep0 * om2 * (tmp1 - 1._rt));
-                    }
-
-                    else // update_with_rho = 0
-                    {
-                        X2(i,j,k) = c2 * (1._rt - C(i,j,k)) * tmp2 / om2;
-
-                        X3(i,j,k) = c2 * (2._rt * om * dt + I * tmp2 * tmp2 - 4._rt * I * tmp2 + 3._rt * I)
-                            / (4._rt * ep0 * om3);
-                    }
-
-                    if (is_galilean)
-                    {
-                        X4(i,j,k) = (I - I * tmp2 * tmp2 - 2._rt * om * dt) / (4._rt * ep0 * om);
-                    }
-
-                    // Averaged Galilean algorithm
-                    if (time_averaging)
-                    {
-                        Complex C_rho = I * c2 / ((1._rt - T2_tmp) * ep0);
-
-                        Psi1(i,j,k) = (2._rt * om * dt - I * tmp2 + I * tmp2 * tmp2 * tmp2)
-                            / (4._rt * om * dt);
-
-                        Psi2(i,j,k) = (2._rt * I * om * dt - tmp2 + tmp2 * tmp2 * tmp2)
-                            / (4._rt * om2 * dt);
-
-                        Psi3(i,j,k) = I * theta * (1._rt - T2_tmp) / (nu * om_c * dt);
-
-                        A1(i,j,k) = (2._rt * om * dt * (1._rt - 2._rt * I * om * dt)
-                            + I * (tmp2 - tmp2 * tmp2 * tmp2)) / (8._rt * om3 * dt);
+            const PsatdCoefficients coef = PsatdComputeCoefficients(knorm, knorm_c, kv, dt,
+                update_with_rho, is_galilean, time_averaging);
 
-                        A2(i,j,k) = (Psi3(i,j,k) - Psi1(i,j,k)) / om2;
+            C   (i,j,k) = coef.C;
+            S_ck(i,j,k) = coef.S_ck;
+            X1  (i,j,k) = coef.X1;
+            X2  (i,j,k) = coef.X2;
+            X3  (i,j,k) = coef.X3;
 
-                        CRhoold(i,j,k) = C_rho * (T2_tmp * A1(i,j,k) - A2(i,j,k));
-
-                        CRhonew(i,j,k) = C_rho * (A2(i,j,k) - A1(i,j,k));
-
-                        Jcoef(i,j,k) = (I * nu * om_c * A1(i,j,k) + Psi2(i,j,k)) / ep0;
-                    }
-                }
-            }
-
-            else if (knorm != 0. && knorm_c == 0.)
-            {
-                const Real om = c * knorm;
-                const Real om2 = om * om;
-                const Real om3 = om * om2;
-
-                C(i,j,k) = std::cos(om * dt);
-
-                S_ck(i,j,k) = std::sin(om * dt) / om;
-
-                X1(i,j,k) = (1._rt - C(i,j,k)) / (ep0 * om2);
-
-                if (update_with_rho)
-                {
-                    X2(i,j,k) = c2 * (1._rt - S_ck(i,j,k) / dt) / (ep0 * om2);
-
-                    X3(i,j,k) = c2 * (C(i,j,k) - S_ck(i,j,k) / dt) / (ep0 * om2);
-                }
-
-                else // update_with_rho = 0
-                {
-                    X2(i,j,k) = c2 * (1._rt - C(i,j,k)) / om2;
-
-                    X3(i,j,k) = c2 * (S_ck(i,j,k) / dt - 1._rt) * dt / (ep0 * om2);
-                }
-
-                if (is_galilean)
-                {
-                    X4(i,j,k) = - S_ck(i,j,k) / ep0;
-
-                    T2(i,j,k) = 1._rt;
-                }
-
-                // Averaged Galilean algorithm
-                if (time_averaging)
-                {
-                    C1(i,j,k) = std::cos(0.5_rt * om * dt);
-                    S1(i,j,k) = std::sin(0.5_rt * om * dt);
-                    C3(i,j,k) = std::cos(1.5_rt * om * dt);
-                    S3(i,j,k) = std::sin(1.5_rt * om * dt);
-
-                    Psi1(i,j,k) = (S3(i,j,k) - S1(i,j,k)) / (om * dt);
-
-                    Psi2(i,j,k) = (C3(i,j,k) - C1(i,j,k)) / (om2 * dt);
-
-                    Psi3(i,j,k) = 1._rt;
-
-                    A1(i,j,k) = (om * dt + S1(i,j,k) - S3(i,j,k)) / (om3 * dt);
-
-                    A2(i,j,k) = (om * dt + S1(i,j,k) - S3(i,j,k)) / (om3 * dt);
-
-                    CRhoold(i,j,k) = 2._rt * I * c2 * S1(i,j,k) * (dt * C(i,j,k) - S_ck(i,j,k))
-                        / (om3 * dt2 * ep0);
-
-                    CRhonew(i,j,k) = - I * c2 * (om2 * dt2 - C1(i,j,k) + C3(i,j,k))
-                        / (om2 * om2 * dt2 * ep0);
-
-                    Jcoef(i,j,k) = Psi2(i,j,k) / ep0;
-                }
-            }
-
-            else if (knorm == 0. && knorm_c != 0.)
+            if (is_galilean)
             {
-                const Real om_c = c * knorm_c;
-                const Real om2_c = om_c * om_c;
-                const Real om3_c = om_c * om2_c;
-                const Real nu  = kv / om_c;
-                const Real nu2 = nu * nu;
-                const Complex theta = amrex::exp(I * nu * om_c * dt * 0.5_rt);
-
-                C(i,j,k) = 1._rt;
-
-                S_ck(i,j,k) = dt;
-
-                if (is_galilean)
-                {
-                    T2(i,j,k) = theta * theta;
-                }
-                const Complex T2_tmp = (is_galilean) ? T2(i,j,k) : 1.0_rt;
-
-                // nu = 0 always with standard PSATD (zero Galilean velocity): skip this block
-                if (nu != 0.)
-                {
-                    X1(i,j,k) = (- 1._rt + T2_tmp - I * nu * om_c * dt * T2_tmp) / (ep0 * nu2 * om2_c);
-
-                    if (update_with_rho)
-                    {
-                        X2(i,j,k) = c2 * (1._rt - T2_tmp + I * nu * om_c * dt * T2_tmp
-                            + 0.5_rt * nu2 * om2_c * dt2 * T2_tmp) / (ep0 * nu2 * om2_c * (T2_tmp - 1._rt));
-
-                        X3(i,j,k) = c2 * (1._rt - T2_tmp + I * nu * om_c * dt * T2_tmp
-                            + 0.5_rt * nu2 * om2_c * dt2) / (ep0 * nu2 * om2_c * (T2_tmp - 1._rt));
-                    }
-
-                    else // update_with_rho = 0
-                    {
-                        X2(i,j,k) = c2 * dt2 * T2_tmp * 0.5_rt;
-
-                        X3(i,j,k) = c2 * (2._rt * I - 2._rt * nu * om_c * dt * T2_tmp
-                            + I * nu2 * om2_c * dt2 * T2_tmp) / (2._rt * ep0 * nu2 * nu * om3_c);
-                    }
-
-                    if (is_galilean)
-                    {
-                        X4(i,j,k) = I * (T2_tmp - 1._rt) / (ep0 * nu * om_c);
-                    }
-
-                    // Averaged Galilean algorithm
-                    if (time_averaging)
-                    {
-                        Complex C_rho = I * c2 / ((1._rt - T2_tmp) * ep0);
-
-                        Psi1(i,j,k) = I * theta * (1._rt - T2_tmp) / (nu * om_c * dt);
-
-                        Psi2(i,j,k) = theta * (2._rt - I * nu * om_c * dt + T2_tmp * (3._rt * I * nu * om_c * dt - 2._rt))
-                            / (2._rt * nu2 * om2_c * dt);
-
-                        Psi3(i,j,k) = I * theta * (1._rt - T2_tmp) / (nu * om_c * dt);
-
-                        A1(i,j,k) = (Psi1(i,j,k) - 1._rt + I * nu * om_c * Psi2(i,j,k)) / (nu2 * om2_c);
-
-                        A2(i,j,k) = theta * (8._rt * I * (T2_tmp - 1._rt) + 4._rt * nu * om_c * dt
-                            * (3._rt * T2_tmp - 1._rt) + I * nu2 * om2_c * dt2 * (1._rt - 9._rt * T2_tmp))
-                            / (8._rt * nu2 * nu * om2_c * om_c * dt);
-
-                        CRhoold(i,j,k) = C_rho * (T2_tmp * A1(i,j,k) - A2(i,j,k));
-
-                        CRhonew(i,j,k) = C_rho * (A2(i,j,k) - A1(i,j,k));
-
-                        Jcoef(i,j,k) = (I * nu * om_c * A1(i,j,k) + Psi2(i,j,k)) / ep0;
-                    }
-                }
-
-                else // nu = 0
-                {
-                    X1(i,j,k) = dt2 / (2._rt * ep0);
-
-                    if (update_with_rho)
-                    {
-                        X2(i,j,k) = c2 * dt2 / (6._rt * ep0);
-
-                        X3(i,j,k) = - c2 * dt2 / (3._rt * ep0);
-                    }
-
-                    else // update_with_rho = 0
-                    {
-                        X2(i,j,k) = c2 * dt2 * 0.5_rt;
-
-                        X3(i,j,k) = - c2 * dt3 / (6._rt * ep0);
-                    }
-
-                    if (is_galilean)
-                    {
-                        X4(i,j,k) = - dt / ep0;
-                    }
-
-                    // Averaged Galilean algorithm
-                    if (time_averaging)
-                    {
-                        Psi1(i,j,k) = 1._rt;
-
-                        Psi2(i,j,k) = - dt;
-
-                        Psi3(i,j,k) = 1._rt;
-
-                        A1(i,j,k) = 13._rt * dt2 / 24._rt;
-
-                        A2(i,j,k) = 13._rt * dt2 / 24._rt;
-
-                        CRhoold(i,j,k) = - I * c2 * dt2 / (3._rt * ep0);
-
-                        CRhonew(i,j,k) = - 5._rt * I * c2 * dt2 / (24._rt * ep0);
-
-                        Jcoef(i,j,k) = - dt / ep0;
-                    }
-                }
+                X4(i,j,k) = coef.X4;
+                T2(i,j,k) = coef.T2;
             }
 
-            else if (knorm == 0. && knorm_c == 0.)
+            // Averaged Galilean algorithm
+            if (time_averaging)
             {
-                C(i,j,k) = 1._rt;
-
-                S_ck(i,j,k) = dt;
-
-                X1(i,j,k) = dt2 / (2._rt * ep0);
-
-                if (update_with_rho)
-                {
-                    X2(i,j,k) = c2 * dt2 / (6._rt * ep0);
-
-                    X3(i,j,k) = - c2 * dt2 / (3._rt * ep0);
-                }
-
-                else // update_with_rho = 0
-                {
-                    X2(i,j,k) = c2 * dt2 * 0.5_rt;
-
-                    X3(i,j,k) = - c2 * dt3 / (6._rt * ep0);
-                }
-
-                // T2 = 1 always with standard PSATD (zero Galilean velocity)
-                if (is_galilean)
-                {
-                    X4(i,j,k) = - dt / ep0;
-
-                    T2(i,j,k) = 1._rt;
-                }
-
-                // Averaged Galilean algorithm
-                if (time_averaging)
-                {
-                    Psi1(i,j,k) = 1._rt;
-
-                    Psi2(i,j,k) = - dt;
-
-                    Psi3(i,j,k) = 1._rt;
-
-                    A1(i,j,k) = 13._rt * dt2 / 24._rt;
-
-                    A2(i,j,k) = 13._rt * dt2 / 24._rt;
-
-                    CRhoold(i,j,k) = - I * c2 * dt2 / (3._rt * ep0);
-
-                    CRhonew(i,j,k) = - 5._rt * I * c2 * dt2 / (24._rt * ep0);
-
-                    Jcoef(i,j,k) = - dt / ep0;
-                }
+                Psi1   (i,j,k) = coef.Psi1;
+                Psi2   (i,j,k) = coef.Psi2;
+                A1     (i,j,k) = coef.A1;
+                CRhoold(i,j,k) = coef.CRhoold;
+                CRhonew(i,j,k) = coef.CRhonew;
+                Jcoef  (i,j,k) = coef.Jcoef;
             }
         });
     }
@@ -1072,4 +654,19 @@ PsatdAlgorithm::VayDeposition (
     field_data.BackwardTransform(lev, *current[2], Idx::Jz, 0);
 }
 
+amrex::Long
+PsatdAlgorithm::CoefficientBytes () const
+{
+    amrex::Long nbytes = 0;
+    for (auto const* coef : {&C_coef, &S_ck_coef}) {
+        nbytes += WarpXUtilMemory::FabArrayBytes(coef);
+    }
+    // the complex coefficients that are not allocated have no FABs
+    for (auto const* coef : {&T2_coef, &X1_coef, &X2_coef, &X3_coef, &X4_coef,
+                             &Psi1_coef, &Psi2_coef, &A1_coef, &Rhoold_coef, &Rhonew_coef, &Jcoef_coef}) {
+        nbytes += WarpXUtilMemory::FabArrayBytes(coef);
+    }
+    return nbytes;
+}
+
 #endif // WARPX_USE_PSATD
@@ -14,7 +14,7 @@ using namespace amrex::literals;
 
 /* \brief Initialize the general filter array */
 void
-SpectralBinomialFilter::InitFilterArray (HankelTransform::RealVector const & kvec,
+SpectralBinomialFilter::InitFilterArray (RealKVector const & kvec,
                                          amrex::Real const dels,
                                          int const npasses,
                                          bool const compensation,
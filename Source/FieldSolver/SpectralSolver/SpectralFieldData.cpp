@@ -6,9 +6,14 @@
  * License: BSD-3-Clause-LBNL
  */
 #include "SpectralFieldData.H"
+#include "SpectralBinomialFilter.H"
 #include "WarpX.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/WarpXUtil.H"
 
+#include <algorithm>
 #include <map>
+#include <type_traits>
 
 #if WARPX_USE_PSATD
 
@@ -20,7 +25,8 @@ SpectralFieldData::SpectralFieldData( const int lev,
                                       const SpectralKSpace& k_space,
                                       const amrex::DistributionMapping& dm,
                                       const int n_field_required,
-                                      const bool periodic_single_box)
+                                      const bool periodic_single_box,
+                                      const SpectralGlobalDecomposition* global_decomposition)
 {
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
@@ -34,8 +40,23 @@ SpectralFieldData::SpectralFieldData( const int lev,
 
     // Allocate temporary arrays - in real space and spectral space
     // These arrays will store the data just before/after the FFT
-    tmpRealField = MultiFab(realspace_ba, dm, 1, 0);
-    tmpSpectralField = SpectralField(spectralspace_ba, dm, 1, 0);
+    // (one component per field transformed in the same batch)
+    m_max_batch_size = std::max(1, std::min(WarpX::fft_max_batch_size, n_field_required));
+    m_fft_single = WarpX::fft_single_precision;
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!(m_fft_single && global_decomposition),
+        "psatd.fft_precision = single cannot be used with psatd.global_fft");
+    if (m_fft_single) {
+        tmpSpectralFieldFloat = SpectralFieldFloat(spectralspace_ba, dm, m_max_batch_size, 0);
+        tmpRealFieldFloat = RealFieldFloat(realspace_ba, dm, m_max_batch_size, 0);
+    } else {
+        tmpSpectralField = SpectralField(spectralspace_ba, dm, m_max_batch_size, 0);
+    }
+    if (global_decomposition) {
+        // Global FFT: the real-space data is stored in slabs of the whole domain
+        InitGlobalFFT(*global_decomposition);
+    } else if (!m_fft_single) {
+        tmpRealField = MultiFab(realspace_ba, dm, m_max_batch_size, 0);
+    }
 
     // By default, we assume the FFT is done from/to a nodal grid in real space
     // It the FFT is performed from/to a cell-centered grid in real space,
@@ -60,50 +81,37 @@ SpectralFieldData::SpectralFieldData( const int lev,
                                     ShiftType::TransformToCellCentered);
 #endif
 
-    // Allocate and initialize the FFT plans
-    forward_plan = AnyFFT::FFTplans(spectralspace_ba, dm);
-    backward_plan = AnyFFT::FFTplans(spectralspace_ba, dm);
-    // Loop over boxes and allocate the corresponding plan
-    // for each box owned by the local MPI proc
+    // With the global FFT, the plans are created at the first transform
+    if (m_global_fft) return;
+
+    // Initialize the FFT plans: the plans are cached and shared between
+    // the boxes of the same shape (including the boxes of the other levels
+    // and of the PML), so this only creates the plans of the new box shapes
     for ( MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi ){
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
+        BoxCostTimer box_timer(cost, mfi.index());
 
         // Note: the size of the real-space box and spectral-space box
         // differ when using real-to-complex FFT. When initializing
         // the FFT plan, the valid dimensions are those of the real-space box.
         IntVect fft_size = realspace_ba[mfi].length();
 
-        forward_plan[mfi] = AnyFFT::CreatePlan(
-            fft_size, tmpRealField[mfi].dataPtr(),
-            reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr()),
-            AnyFFT::direction::R2C, AMREX_SPACEDIM);
-
-        backward_plan[mfi] = AnyFFT::CreatePlan(
-            fft_size, tmpRealField[mfi].dataPtr(),
-            reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr()),
-            AnyFFT::direction::C2R, AMREX_SPACEDIM);
-
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
+        for (const int nb : {1, m_max_batch_size}) {
+            for (const auto dir : {AnyFFT::direction::R2C, AnyFFT::direction::C2R}) {
+                if (m_fft_single) {
+                    AnyFFT::GetCachedPlan(
+                        fft_size, tmpRealFieldFloat[mfi].dataPtr(),
+                        reinterpret_cast<AnyFFT::FloatComplex*>( tmpSpectralFieldFloat[mfi].dataPtr()),
+                        dir, AMREX_SPACEDIM, nb);
+                } else {
+                    AnyFFT::GetCachedPlan(
+                        fft_size, tmpRealField[mfi].dataPtr(),
+                        reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr()),
+                        dir, AMREX_SPACEDIM, nb);
+                }
+            }
         }
-    }
-}
 
-
-SpectralFieldData::~SpectralFieldData()
-{
-    if (tmpRealField.size() > 0){
-        for ( MFIter mfi(tmpRealField); mfi.isValid(); ++mfi ){
-            AnyFFT::DestroyPlan(forward_plan[mfi]);
-            AnyFFT::DestroyPlan(backward_plan[mfi]);
-        }
+        box_timer.stop();
     }
 }
 
@@ -115,162 +123,186 @@ SpectralFieldData::ForwardTransform (const int lev,
                      const MultiFab& mf, const int field_index,
                                      const int i_comp, const IntVect& stag)
 {
-    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+    const SpectralForwardComponent comp {&mf, field_index, i_comp, stag};
+    ForwardTransformBatch(lev, &comp, 1);
+}
 
-    // Check field index type, in order to apply proper shift in spectral space
-    const bool is_nodal_x = (stag[0] == amrex::IndexType::NODE) ? true : false;
-#if (AMREX_SPACEDIM == 3)
-    const bool is_nodal_y = (stag[1] == amrex::IndexType::NODE) ? true : false;
-    const bool is_nodal_z = (stag[2] == amrex::IndexType::NODE) ? true : false;
-#else
-    const bool is_nodal_z = (stag[1] == amrex::IndexType::NODE) ? true : false;
-#endif
+/* \brief Transform the components `comps` to spectral space,
+ *  by batches of at most `m_max_batch_size` components */
+void
+SpectralFieldData::ForwardTransform (const int lev,
+                                     const std::vector<SpectralForwardComponent>& comps)
+{
+    const int ncomps = static_cast<int>(comps.size());
+    for (int n = 0; n < ncomps; n += m_max_batch_size) {
+        ForwardTransformBatch(lev, comps.data() + n, std::min(m_max_batch_size, ncomps - n));
+    }
+}
+
+/* \brief Transform spectral field specified by `field_index` back to
+ * real space, and store it in the component `i_comp` of `mf` */
+void
+SpectralFieldData::BackwardTransform( const int lev,
+                                      MultiFab& mf,
+                                      const int field_index,
+                                      const int i_comp )
+{
+    const SpectralBackwardComponent comp {&mf, field_index, i_comp};
+    BackwardTransformBatch(lev, &comp, 1);
+}
+
+/* \brief Transform the spectral fields of `comps` back to real space,
+ *  by batches of at most `m_max_batch_size` components */
+void
+SpectralFieldData::BackwardTransform (const int lev,
+                                      const std::vector<SpectralBackwardComponent>& comps)
+{
+    const int ncomps = static_cast<int>(comps.size());
+    for (int n = 0; n < ncomps; n += m_max_batch_size) {
+        BackwardTransformBatch(lev, comps.data() + n, std::min(m_max_batch_size, ncomps - n));
+    }
+}
+
+/* \brief Transform the `nb` components `comps` to spectral space, with one
+ *  batched FFT per box: component n of the batch is stored in component n
+ *  of the temporary fields */
+void
+SpectralFieldData::ForwardTransformBatch (const int lev,
+                                          const SpectralForwardComponent* comps,
+                                          const int nb)
+{
+    AMREX_ALWAYS_ASSERT(nb >= 1 && nb <= m_max_batch_size);
+
+    if (m_global_fft) {
+        ForwardTransformGlobal(comps, nb);
+        return;
+    }
+
+    if (m_fft_single) {
+        ForwardTransformBatch(lev, comps, nb, tmpRealFieldFloat, tmpSpectralFieldFloat);
+    } else {
+        ForwardTransformBatch(lev, comps, nb, tmpRealField, tmpSpectralField);
+    }
+}
+
+template <typename TmpRealField, typename TmpSpectralField>
+void
+SpectralFieldData::ForwardTransformBatch (const int lev,
+                                          const SpectralForwardComponent* comps,
+                                          const int nb, TmpRealField& tmp_real,
+                                          TmpSpectralField& tmp_spectral)
+{
+    // Real type of the FFT (Real, or float with psatd.fft_precision = single)
+    using T = typename TmpRealField::value_type;
+    using FFTComplex = std::conditional_t<std::is_same<T, Real>::value,
+                                          AnyFFT::Complex, AnyFFT::FloatComplex>;
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
     // Loop over boxes
-    for ( MFIter mfi(mf); mfi.isValid(); ++mfi ){
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
+    for ( MFIter mfi(tmp_real); mfi.isValid(); ++mfi ){
+        BoxCostTimer box_timer(cost, mfi.index());
 
-        // Copy the real-space field `mf` to the temporary field `tmpRealField`
+        // Copy the real-space fields to the temporary field `tmp_real`
         // This ensures that all fields have the same number of points
         // before the Fourier transform.
         // As a consequence, the copy discards the *last* point of `mf`
         // in any direction that has *nodal* index type.
-        {
+        for (int n = 0; n < nb; ++n) {
+            const MultiFab& mf = *(comps[n].mf);
+            const int i_comp = comps[n].i_comp;
             Box realspace_bx;
             if (m_periodic_single_box) {
-                realspace_bx = mfi.validbox(); // Discard guard cells
+                realspace_bx = mf.box(mfi.index()); // Discard guard cells
             } else {
                 realspace_bx = mf[mfi].box(); // Keep guard cells
             }
             realspace_bx.enclosedCells(); // Discard last point in nodal direction
-            AMREX_ALWAYS_ASSERT( realspace_bx.contains(tmpRealField[mfi].box()) );
+            AMREX_ALWAYS_ASSERT( realspace_bx.contains(tmp_real[mfi].box()) );
             Array4<const Real> mf_arr = mf[mfi].array();
-            Array4<Real> tmp_arr = tmpRealField[mfi].array();
-            ParallelFor( tmpRealField[mfi].box(),
+            Array4<T> tmp_arr = tmp_real[mfi].array();
+            ParallelFor( tmp_real[mfi].box(),
             [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                tmp_arr(i,j,k) = mf_arr(i,j,k,i_comp);
+                tmp_arr(i,j,k,n) = static_cast<T>(mf_arr(i,j,k,i_comp));
             });
         }
 
-        // Perform Fourier transform from `tmpRealField` to `tmpSpectralField`
-        AnyFFT::Execute(forward_plan[mfi]);
-
-        // Copy the spectral-space field `tmpSpectralField` to the appropriate
-        // index of the FabArray `fields` (specified by `field_index`)
-        // and apply correcting shift factor if the real space data comes
-        // from a cell-centered grid in real space instead of a nodal grid.
-        {
-            Array4<Complex> fields_arr = SpectralFieldData::fields[mfi].array();
-            Array4<const Complex> tmp_arr = tmpSpectralField[mfi].array();
-            const Complex* xshift_arr = xshift_FFTfromCell[mfi].dataPtr();
-#if (AMREX_SPACEDIM == 3)
-            const Complex* yshift_arr = yshift_FFTfromCell[mfi].dataPtr();
-#endif
-            const Complex* zshift_arr = zshift_FFTfromCell[mfi].dataPtr();
-            // Loop over indices within one box
-            const Box spectralspace_bx = tmpSpectralField[mfi].box();
+        // Perform Fourier transform from `tmp_real` to `tmp_spectral`
+        AnyFFT::FFTplan plan = AnyFFT::GetCachedPlan(
+            tmp_real[mfi].box().length(), tmp_real[mfi].dataPtr(),
+            reinterpret_cast<FFTComplex*>( tmp_spectral[mfi].dataPtr()),
+            AnyFFT::direction::R2C, AMREX_SPACEDIM, nb);
+        AnyFFT::Execute(plan);
 
-            ParallelFor( spectralspace_bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                Complex spectral_field_value = tmp_arr(i,j,k);
-                // Apply proper shift in each dimension
-                if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
-#if (AMREX_SPACEDIM == 3)
-                if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
-#elif (AMREX_SPACEDIM == 2)
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
-#endif
-                // Copy field into the right index
-                fields_arr(i,j,k,field_index) = spectral_field_value;
-            });
-        }
+        // Copy the spectral-space field `tmp_spectral` to `fields`
+        CopyToSpectralFields(mfi, comps, nb, tmp_spectral);
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+        box_timer.stop();
     }
 }
 
-
-/* \brief Transform spectral field specified by `field_index` back to
- * real space, and store it in the component `i_comp` of `mf` */
+/* \brief Transform the `nb` spectral fields of `comps` back to real space,
+ *  with one batched FFT per box */
 void
-SpectralFieldData::BackwardTransform( const int lev,
-                                      MultiFab& mf,
-                                      const int field_index,
-                                      const int i_comp )
+SpectralFieldData::BackwardTransformBatch (const int lev,
+                                           const SpectralBackwardComponent* comps,
+                                           const int nb)
 {
-    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+    AMREX_ALWAYS_ASSERT(nb >= 1 && nb <= m_max_batch_size);
 
-    // Check field index type, in order to apply proper shift in spectral space
-    const bool is_nodal_x = mf.is_nodal(0);
-#if (AMREX_SPACEDIM == 3)
-    const bool is_nodal_y = mf.is_nodal(1);
-    const bool is_nodal_z = mf.is_nodal(2);
-#else
-    const bool is_nodal_z = mf.is_nodal(1);
-#endif
+    if (m_global_fft) {
+        BackwardTransformGlobal(comps, nb);
+        return;
+    }
 
-    // Loop over boxes
-    for ( MFIter mfi(mf); mfi.isValid(); ++mfi ){
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
+    if (m_fft_single) {
+        BackwardTransformBatch(lev, comps, nb, tmpRealFieldFloat, tmpSpectralFieldFloat);
+    } else {
+        BackwardTransformBatch(lev, comps, nb, tmpRealField, tmpSpectralField);
+    }
+}
 
-        // Copy the spectral-space field `tmpSpectralField` to the appropriate
-        // field (specified by the input argument field_index)
-        // and apply correcting shift factor if the field is to be transformed
-        // to a cell-centered grid in real space instead of a nodal grid.
-        {
-            Array4<const Complex> field_arr = SpectralFieldData::fields[mfi].array();
-            Array4<Complex> tmp_arr = tmpSpectralField[mfi].array();
-            const Complex* xshift_arr = xshift_FFTtoCell[mfi].dataPtr();
-#if (AMREX_SPACEDIM == 3)
-            const Complex* yshift_arr = yshift_FFTtoCell[mfi].dataPtr();
-#endif
-            const Complex* zshift_arr = zshift_FFTtoCell[mfi].dataPtr();
-            // Loop over indices within one box
-            const Box spectralspace_bx = tmpSpectralField[mfi].box();
+template <typename TmpRealField, typename TmpSpectralField>
+void
+SpectralFieldData::BackwardTransformBatch (const int lev,
+                                           const SpectralBackwardComponent* comps,
+                                           const int nb, TmpRealField& tmp_real,
+                                           TmpSpectralField& tmp_spectral)
+{
+    // Real type of the FFT (Real, or float with psatd.fft_precision = single)
+    using T = typename TmpRealField::value_type;
+    using FFTComplex = std::conditional_t<std::is_same<T, Real>::value,
+                                          AnyFFT::Complex, AnyFFT::FloatComplex>;
 
-            ParallelFor( spectralspace_bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                Complex spectral_field_value = field_arr(i,j,k,field_index);
-                // Apply proper shift in each dimension
-                if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
-#if (AMREX_SPACEDIM == 3)
-                if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
-#elif (AMREX_SPACEDIM == 2)
-                if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
-#endif
-                // Copy field into temporary array
-                tmp_arr(i,j,k) = spectral_field_value;
-            });
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
-        }
+    // Loop over boxes
+    for ( MFIter mfi(tmp_real); mfi.isValid(); ++mfi ){
+        BoxCostTimer box_timer(cost, mfi.index());
+
+        // Copy the spectral fields to `tmp_spectral`
+        CopyFromSpectralFields(mfi, comps, nb, tmp_spectral);
 
-        // Perform Fourier transform from `tmpSpectralField` to `tmpRealField`
-        AnyFFT::Execute(backward_plan[mfi]);
+        // Perform Fourier transform from `tmp_spectral` to `tmp_real`
+        AnyFFT::FFTplan plan = AnyFFT::GetCachedPlan(
+            tmp_real[mfi].box().length(), tmp_real[mfi].dataPtr(),
+            reinterpret_cast<FFTComplex*>( tmp_spectral[mfi].dataPtr()),
+            AnyFFT::direction::C2R, AMREX_SPACEDIM, nb);
+        AnyFFT::Execute(plan);
 
-        // Copy the temporary field `tmpRealField` to the real-space field `mf`
+        // Copy the temporary field `tmp_real` to the real-space fields
         // (only in the valid cells ; not in the guard cells)
         // Normalize (divide by 1/N) since the FFT+IFFT results in a factor N
-        {
+        for (int n = 0; n < nb; ++n) {
+            MultiFab& mf = *(comps[n].mf);
+            const int i_comp = comps[n].i_comp;
+            // Valid box of `mf` (with the index type of `mf`)
+            const Box valid_bx = mf.box(mfi.index());
             Array4<Real> mf_arr = mf[mfi].array();
-            Array4<const Real> tmp_arr = tmpRealField[mfi].array();
+            Array4<const T> tmp_arr = tmp_real[mfi].array();
             // Normalization: divide by the number of points in realspace
             // (includes the guard cells)
-            const Box realspace_bx = tmpRealField[mfi].box();
+            const Box realspace_bx = tmp_real[mfi].box();
             const Real inv_N = 1./realspace_bx.numPts();
 
             if (m_periodic_single_box) {
@@ -284,31 +316,237 @@ SpectralFieldData::BackwardTransform( const int lev,
                 int constexpr nz = 1;
 #endif
                 ParallelFor(
-                    mfi.validbox(),
+                    valid_bx,
                     /* GCC 8.1-8.2 work-around (ICE):
                      *   named capture in nonexcept lambda needed for modulo operands
                      *   https://godbolt.org/z/ppbAzd
                      */
-                    [mf_arr, i_comp, inv_N, tmp_arr, nx, ny, nz]
+                    [mf_arr, i_comp, inv_N, tmp_arr, nx, ny, nz, n]
                     AMREX_GPU_DEVICE (int i, int j, int k) noexcept {
-                        mf_arr(i,j,k,i_comp) = inv_N*tmp_arr(i%nx, j%ny, k%nz);
+                        mf_arr(i,j,k,i_comp) = inv_N*tmp_arr(i%nx, j%ny, k%nz, n);
                     });
             } else {
-                ParallelFor( mfi.validbox(),
+                ParallelFor( valid_bx,
                 [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
                     // Copy and normalize field
-                    mf_arr(i,j,k,i_comp) = inv_N*tmp_arr(i,j,k);
+                    mf_arr(i,j,k,i_comp) = inv_N*tmp_arr(i,j,k,n);
                 });
             }
+        }
+
+        box_timer.stop();
+    }
+}
+
+/* \brief Copy the spectral-space field `tmpSpectralField` (component n of the batch)
+ *  to the appropriate index of the FabArray `fields` (specified by `field_index`),
+ *  in the box `mfi` of spectral space */
+void
+SpectralFieldData::CopyToSpectralFields (const MFIter& mfi,
+                                         const SpectralForwardComponent* comps,
+                                         const int nb)
+{
+    if (m_fft_single) {
+        CopyToSpectralFields(mfi, comps, nb, tmpSpectralFieldFloat);
+    } else {
+        CopyToSpectralFields(mfi, comps, nb, tmpSpectralField);
+    }
+}
+
+template <typename TmpSpectralField>
+void
+SpectralFieldData::CopyToSpectralFields (const MFIter& mfi,
+                                         const SpectralForwardComponent* comps,
+                                         const int nb,
+                                         const TmpSpectralField& tmp_spectral)
+{
+    using TmpComplex = typename TmpSpectralField::value_type;
+
+    // Copy the spectral-space field `tmp_spectral` to the appropriate
+    // index of the FabArray `fields` (specified by `field_index`)
+    // and apply correcting shift factor if the real space data comes
+    // from a cell-centered grid in real space instead of a nodal grid.
+    for (int n = 0; n < nb; ++n) {
+        const IntVect& stag = comps[n].stag;
+        const int field_index = comps[n].field_index;
+        // Check field index type, in order to apply proper shift in spectral space
+        const bool is_nodal_x = (stag[0] == amrex::IndexType::NODE) ? true : false;
+#if (AMREX_SPACEDIM == 3)
+        const bool is_nodal_y = (stag[1] == amrex::IndexType::NODE) ? true : false;
+        const bool is_nodal_z = (stag[2] == amrex::IndexType::NODE) ? true : false;
+#else
+        const bool is_nodal_z = (stag[1] == amrex::IndexType::NODE) ? true : false;
+#endif
+        Array4<Complex> fields_arr = SpectralFieldData::fields[mfi].array();
+        Array4<const TmpComplex> tmp_arr = tmp_spectral[mfi].array();
+        const Complex* xshift_arr = xshift_FFTfromCell[mfi].dataPtr();
+#if (AMREX_SPACEDIM == 3)
+        const Complex* yshift_arr = yshift_FFTfromCell[mfi].dataPtr();
+#endif
+        const Complex* zshift_arr = zshift_FFTfromCell[mfi].dataPtr();
+        // Loop over indices within one box
+        const Box spectralspace_bx = tmp_spectral[mfi].box();
+
+        ParallelFor( spectralspace_bx,
+        [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+            const TmpComplex tmp_value = tmp_arr(i,j,k,n);
+            Complex spectral_field_value{tmp_value.real(), tmp_value.imag()};
+            // Apply proper shift in each dimension
+            if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
+#if (AMREX_SPACEDIM == 3)
+            if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
+            if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
+#elif (AMREX_SPACEDIM == 2)
+            if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
+#endif
+            // Copy field into the right index
+            fields_arr(i,j,k,field_index) = spectral_field_value;
+        });
+    }
+}
+
+/* \brief Copy the spectral fields (specified by `field_index`) to the temporary
+ *  field `tmpSpectralField` (component n of the batch), in the box `mfi` of spectral space */
+void
+SpectralFieldData::CopyFromSpectralFields (const MFIter& mfi,
+                                           const SpectralBackwardComponent* comps,
+                                           const int nb)
+{
+    if (m_fft_single) {
+        CopyFromSpectralFields(mfi, comps, nb, tmpSpectralFieldFloat);
+    } else {
+        CopyFromSpectralFields(mfi, comps, nb, tmpSpectralField);
+    }
+}
 
+template <typename TmpSpectralField>
+void
+SpectralFieldData::CopyFromSpectralFields (const MFIter& mfi,
+                                           const SpectralBackwardComponent* comps,
+                                           const int nb,
+                                           TmpSpectralField& tmp_spectral)
+{
+    using TmpComplex = typename TmpSpectralField::value_type;
+    using T = typename TmpComplex::value_type;
+
+    // Copy the spectral fields (specified by field_index) to the temporary
+    // field `tmp_spectral`, and apply correcting shift factor if the field
+    // is to be transformed to a cell-centered grid in real space instead of a nodal grid.
+    for (int n = 0; n < nb; ++n) {
+        const MultiFab& mf = *(comps[n].mf);
+        const int field_index = comps[n].field_index;
+        // Check field index type, in order to apply proper shift in spectral space
+        const bool is_nodal_x = mf.is_nodal(0);
+#if (AMREX_SPACEDIM == 3)
+        const bool is_nodal_y = mf.is_nodal(1);
+        const bool is_nodal_z = mf.is_nodal(2);
+#else
+        const bool is_nodal_z = mf.is_nodal(1);
+#endif
+        Array4<const Complex> field_arr = SpectralFieldData::fields[mfi].array();
+        Array4<TmpComplex> tmp_arr = tmp_spectral[mfi].array();
+        const Complex* xshift_arr = xshift_FFTtoCell[mfi].dataPtr();
+#if (AMREX_SPACEDIM == 3)
+        const Complex* yshift_arr = yshift_FFTtoCell[mfi].dataPtr();
+#endif
+        const Complex* zshift_arr = zshift_FFTtoCell[mfi].dataPtr();
+        // Loop over indices within one box
+        const Box spectralspace_bx = tmp_spectral[mfi].box();
+
+        ParallelFor( spectralspace_bx,
+        [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+            Complex spectral_field_value = field_arr(i,j,k,field_index);
+            // Apply proper shift in each dimension
+            if (is_nodal_x==false) spectral_field_value *= xshift_arr[i];
+#if (AMREX_SPACEDIM == 3)
+            if (is_nodal_y==false) spectral_field_value *= yshift_arr[j];
+            if (is_nodal_z==false) spectral_field_value *= zshift_arr[k];
+#elif (AMREX_SPACEDIM == 2)
+            if (is_nodal_z==false) spectral_field_value *= zshift_arr[j];
+#endif
+            // Copy field into temporary array
+            tmp_arr(i,j,k,n) = TmpComplex{static_cast<T>(spectral_field_value.real()),
+                                          static_cast<T>(spectral_field_value.imag())};
+        });
+    }
+}
+
+/* \brief Initialize the transfer function of the binomial filter in k space
+ *
+ * The filter is applied in spectral space, as a function of the actual
+ * (not the modified) k, instead of applying its real-space stencil */
+void
+SpectralFieldData::InitFilter (const IntVect& filter_npass_each_dir, const bool compensation,
+                               const SpectralKSpace& k_space)
+{
+    const BoxArray& spectralspace_ba = k_space.spectralspace_ba;
+    const DistributionMapping& dm = fields.DistributionMap();
+    const RealVect& dx = k_space.getCellSize();
+
+    for (int i_dim=0; i_dim<AMREX_SPACEDIM; i_dim++) {
+        // infinite order: the k vector itself
+        const KVectorComponent k_comp = k_space.getModifiedKComponent(dm, i_dim, -1, false);
+        m_filter[i_dim].define(spectralspace_ba, dm);
+        for (MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi) {
+            SpectralBinomialFilter::InitFilterArray(k_comp[mfi], dx[i_dim],
+                filter_npass_each_dir[i_dim], compensation, m_filter[i_dim][mfi]);
         }
+        // k_comp is freed at the end of the iteration
+        Gpu::synchronize();
+    }
+}
+
+void
+SpectralFieldData::ApplyFilter (const int field_index)
+{
+    ApplyFilter({field_index, field_index, field_index}, 1);
+}
+
+void
+SpectralFieldData::ApplyFilter (const int field_index1, const int field_index2,
+                                const int field_index3)
+{
+    ApplyFilter({field_index1, field_index2, field_index3}, 3);
+}
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+amrex::Long
+SpectralFieldData::MemoryBytes () const
+{
+    return WarpXUtilMemory::FabArrayBytes(&fields)
+        + WarpXUtilMemory::FabArrayBytes(&tmpSpectralField)
+        + WarpXUtilMemory::FabArrayBytes(&tmpRealField)
+        + WarpXUtilMemory::FabArrayBytes(&tmpSpectralFieldFloat)
+        + WarpXUtilMemory::FabArrayBytes(&tmpRealFieldFloat)
+        + WarpXUtilMemory::FabArrayBytes(&m_real_slab)
+        + WarpXUtilMemory::FabArrayBytes(&m_spectral_slab);
+}
+
+void
+SpectralFieldData::ApplyFilter (const GpuArray<int,3>& field_indices, const int ncomp)
+{
+    for (MFIter mfi(fields); mfi.isValid(); ++mfi) {
+        const Box bx = fields[mfi].box();
+        Array4<Complex> fields_arr = fields[mfi].array();
+
+        const Real* filter_x = m_filter[0][mfi].dataPtr();
+#if (AMREX_SPACEDIM == 3)
+        const Real* filter_y = m_filter[1][mfi].dataPtr();
+        const Real* filter_z = m_filter[2][mfi].dataPtr();
+#else
+        const Real* filter_z = m_filter[1][mfi].dataPtr();
+#endif
+
+        ParallelFor(bx, [=] AMREX_GPU_DEVICE (int i, int j, int k) noexcept
         {
-            amrex::Gpu::synchronize();
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+#if (AMREX_SPACEDIM == 3)
+            const Real filter = filter_x[i]*filter_y[j]*filter_z[k];
+#else
+            const Real filter = filter_x[i]*filter_z[j];
+#endif
+            for (int n = 0; n < ncomp; ++n) {
+                fields_arr(i,j,k,field_indices[n]) *= filter;
+            }
+        });
     }
 }
 
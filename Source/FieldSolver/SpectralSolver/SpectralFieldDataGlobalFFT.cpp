@@ -0,0 +1,227 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "SpectralFieldData.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Periodicity.H>
+
+#include <algorithm>
+
+#if WARPX_USE_PSATD
+
+using namespace amrex;
+
+namespace
+{
+    // Last axis (along which the real-space slabs are decomposed)
+    constexpr int last_dim = AMREX_SPACEDIM-1;
+    // Next-to-last axis (along which the spectral-space slabs are decomposed)
+    constexpr int transposed_dim = AMREX_SPACEDIM-2;
+
+    /* \brief Split `bx` in `nslabs` slabs along `idim`, and append them to `bl` */
+    void AddSlabs (BoxList& bl, Vector<int>& pmap, const Box& bx, const int idim, const int nslabs)
+    {
+        const int lo = bx.smallEnd(idim);
+        const int n = bx.length(idim);
+        for (int islab = 0; islab < nslabs; ++islab) {
+            Box slab = bx;
+            slab.setSmall(idim, lo + (islab*n)/nslabs);
+            slab.setBig(idim, lo + ((islab+1)*n)/nslabs - 1);
+            bl.push_back(slab);
+            pmap.push_back(islab); // one slab per MPI rank
+        }
+    }
+}
+
+/* \brief Decompose the domain in slabs, for the global FFT
+ *
+ * \param realspace_domain Cell-centered box of the whole domain in real space
+ */
+SpectralGlobalDecomposition::SpectralGlobalDecomposition (const Box& realspace_domain)
+    : realspace_domain(realspace_domain)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+        realspace_domain.ixType()==IndexType::TheCellType(),
+        "SpectralGlobalDecomposition expects a cell-centered box.");
+
+    const int nprocs = ParallelDescriptor::NProcs();
+
+    // Spectral space of the whole domain (starts at 0 in each direction ;
+    // real-to-complex FFT along the first axis)
+    IntVect spectral_size = realspace_domain.length();
+    spectral_size[0] = spectral_size[0]/2 + 1;
+    const Box spectral_domain = Box( IntVect::TheZeroVector(),
+                                     spectral_size - IntVect::TheUnitVector() );
+
+    // Real space: slabs along the last axis, and the same slabs in the
+    // (partial) spectral space, after the FFT along the other axes
+    {
+        const int nslabs = std::min(nprocs, realspace_domain.length(last_dim));
+        BoxList real_bl;
+        BoxList spectral_slab_bl;
+        Vector<int> pmap;
+        Vector<int> pmap_spectral;
+        AddSlabs(real_bl, pmap, realspace_domain, last_dim, nslabs);
+        AddSlabs(spectral_slab_bl, pmap_spectral, spectral_domain, last_dim, nslabs);
+        real_slab_ba.define(real_bl);
+        spectral_slab_ba.define(spectral_slab_bl);
+        real_slab_dm.define(pmap);
+    }
+
+    // Spectral space: slabs along the next-to-last axis, complete along the last axis
+    {
+        const int nslabs = std::min(nprocs, spectral_domain.length(transposed_dim));
+        BoxList spectral_bl;
+        Vector<int> pmap;
+        AddSlabs(spectral_bl, pmap, spectral_domain, transposed_dim, nslabs);
+        spectral_ba.define(spectral_bl);
+        spectral_dm.define(pmap);
+    }
+}
+
+/* \brief Allocate the slabs used by the global FFT */
+void
+SpectralFieldData::InitGlobalFFT (const SpectralGlobalDecomposition& decomposition)
+{
+    m_global_fft = true;
+    m_global_domain = decomposition.realspace_domain;
+    m_real_slab_ba = decomposition.real_slab_ba;
+    m_real_slab_dm = decomposition.real_slab_dm;
+
+    m_real_slab = MultiFab(m_real_slab_ba, m_real_slab_dm, m_max_batch_size, 0);
+    m_spectral_slab = SpectralField(decomposition.spectral_slab_ba, m_real_slab_dm,
+                                    m_max_batch_size, 0);
+}
+
+/* \brief Return a MultiFab that shares the memory of component `n` of `m_real_slab`,
+ * but has the index type `ixtype` (and the same indices). This is used to copy the
+ * points 0 to N-1 of a staggered field from/to the cell-centered slabs: along nodal
+ * directions, the last point of the field is the periodic image of the first one.
+ */
+MultiFab
+SpectralFieldData::RealSlabAlias (const IndexType ixtype, const int n)
+{
+    auto it = m_real_slab_ba_stag.find(ixtype.ixType());
+    if (it == m_real_slab_ba_stag.end()) {
+        BoxList bl(ixtype);
+        for (int i = 0; i < m_real_slab_ba.size(); ++i) {
+            const Box& bx = m_real_slab_ba[i];
+            bl.push_back(Box(bx.smallEnd(), bx.bigEnd(), ixtype));
+        }
+        it = m_real_slab_ba_stag.emplace(ixtype.ixType(), BoxArray(bl)).first;
+    }
+
+    MultiFab alias(it->second, m_real_slab_dm, 1, 0, MFInfo().SetAlloc(false));
+    for (MFIter mfi(alias); mfi.isValid(); ++mfi) {
+        alias.setFab(mfi, FArrayBox(alias.box(mfi.index()), 1,
+                                    m_real_slab[mfi.index()].dataPtr(n)));
+    }
+    return alias;
+}
+
+/* \brief Transform the `nb` components `comps` to spectral space, with the
+ * global FFT: the whole domain is transformed, without guard cells */
+void
+SpectralFieldData::ForwardTransformGlobal (const SpectralForwardComponent* comps,
+                                           const int nb)
+{
+    // Copy the real-space fields to the slabs (component n of the batch
+    // in component n of `m_real_slab`), discarding the *last* point of
+    // the domain in any direction that has *nodal* index type.
+    for (int n = 0; n < nb; ++n) {
+        MultiFab slab = RealSlabAlias(comps[n].mf->ixType(), n);
+        slab.ParallelCopy(*(comps[n].mf), comps[n].i_comp, 0, 1);
+    }
+
+    // Perform Fourier transform along all axes but the last one, in each slab:
+    // the batch contains one transform per plane of each component
+    for ( MFIter mfi(m_real_slab); mfi.isValid(); ++mfi ){
+        const IntVect fft_size = m_real_slab[mfi].box().length();
+        AnyFFT::FFTplan plan = AnyFFT::GetCachedPlan(
+            fft_size, m_real_slab[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>( m_spectral_slab[mfi].dataPtr()),
+            AnyFFT::direction::R2C, AMREX_SPACEDIM-1, nb*fft_size[last_dim]);
+        AnyFFT::Execute(plan);
+    }
+
+    // Transpose: redistribute the slabs, so that each box of spectral space
+    // contains the full last axis
+    tmpSpectralField.ParallelCopy(m_spectral_slab, 0, 0, nb);
+
+    for ( MFIter mfi(tmpSpectralField); mfi.isValid(); ++mfi ){
+        // Perform Fourier transform along the last axis
+        const Box& bx = tmpSpectralField[mfi].box();
+        const int n_last = bx.length(last_dim);
+        const int stride = static_cast<int>(bx.numPts()) / n_last;
+        for (int n = 0; n < nb; ++n) {
+            AnyFFT::FFTplan plan = AnyFFT::GetCachedPlanC2C(
+                n_last, reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr(n)),
+                stride, 1, stride, AnyFFT::direction::C2C_FORWARD);
+            AnyFFT::Execute(plan);
+        }
+
+        // Copy the spectral-space field `tmpSpectralField` to `fields`
+        CopyToSpectralFields(mfi, comps, nb);
+    }
+}
+
+/* \brief Transform the `nb` spectral fields of `comps` back to real space,
+ * with the global FFT (only the valid cells of the real-space fields are set) */
+void
+SpectralFieldData::BackwardTransformGlobal (const SpectralBackwardComponent* comps,
+                                            const int nb)
+{
+    for ( MFIter mfi(tmpSpectralField); mfi.isValid(); ++mfi ){
+        // Copy the spectral fields to `tmpSpectralField`
+        CopyFromSpectralFields(mfi, comps, nb);
+
+        // Perform inverse Fourier transform along the last axis
+        const Box& bx = tmpSpectralField[mfi].box();
+        const int n_last = bx.length(last_dim);
+        const int stride = static_cast<int>(bx.numPts()) / n_last;
+        for (int n = 0; n < nb; ++n) {
+            AnyFFT::FFTplan plan = AnyFFT::GetCachedPlanC2C(
+                n_last, reinterpret_cast<AnyFFT::Complex*>( tmpSpectralField[mfi].dataPtr(n)),
+                stride, 1, stride, AnyFFT::direction::C2C_BACKWARD);
+            AnyFFT::Execute(plan);
+        }
+    }
+
+    // Transpose back to the slabs along the last axis
+    m_spectral_slab.ParallelCopy(tmpSpectralField, 0, 0, nb);
+
+    // Normalization: divide by the number of points in the domain
+    const Real inv_N = 1._rt/m_global_domain.numPts();
+
+    for ( MFIter mfi(m_real_slab); mfi.isValid(); ++mfi ){
+        // Perform inverse Fourier transform along all axes but the last one
+        const IntVect fft_size = m_real_slab[mfi].box().length();
+        AnyFFT::FFTplan plan = AnyFFT::GetCachedPlan(
+            fft_size, m_real_slab[mfi].dataPtr(),
+            reinterpret_cast<AnyFFT::Complex*>( m_spectral_slab[mfi].dataPtr()),
+            AnyFFT::direction::C2R, AMREX_SPACEDIM-1, nb*fft_size[last_dim]);
+        AnyFFT::Execute(plan);
+
+        // Normalize (divide by 1/N) since the FFT+IFFT results in a factor N
+        Array4<Real> slab_arr = m_real_slab[mfi].array();
+        ParallelFor( m_real_slab[mfi].box(), nb,
+        [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+            slab_arr(i,j,k,n) *= inv_N;
+        });
+    }
+
+    // Copy the slabs to the valid cells of the real-space fields. The periodic
+    // copy sets the last point of nodal directions, from the first one.
+    const Periodicity period(m_global_domain.length());
+    for (int n = 0; n < nb; ++n) {
+        MultiFab& mf = *(comps[n].mf);
+        const MultiFab slab = RealSlabAlias(mf.ixType(), n);
+        mf.ParallelCopy(slab, 0, comps[n].i_comp, 1, IntVect(0), IntVect(0), period);
+    }
+}
+
+#endif // WARPX_USE_PSATD
@@ -12,8 +12,42 @@
 #include <blas.hh>
 #include <lapack.hh>
 
+#if defined(AMREX_USE_CUDA)
+#   include <cublas_v2.h>
+#elif defined(AMREX_USE_HIP)
+#   include <rocblas.h>
+#endif
+
 using amrex::operator""_rt;
 
+namespace
+{
+#if defined(AMREX_USE_CUDA)
+    using BlasHandle = cublasHandle_t;
+#elif defined(AMREX_USE_HIP)
+    using BlasHandle = rocblas_handle;
+#endif
+
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    /* \brief Return the handle of the GPU BLAS library, which is created
+     * at the first call and destroyed when AMReX is finalized */
+    BlasHandle GetBlasHandle ()
+    {
+        static BlasHandle handle = nullptr;
+        if (handle == nullptr) {
+#   if defined(AMREX_USE_CUDA)
+            cublasCreate(&handle);
+            amrex::ExecOnFinalize([](){ cublasDestroy(handle); handle = nullptr; });
+#   else
+            rocblas_create_handle(&handle);
+            amrex::ExecOnFinalize([](){ rocblas_destroy_handle(handle); handle = nullptr; });
+#   endif
+        }
+        return handle;
+    }
+#endif
+}
+
 HankelTransform::HankelTransform (int const hankel_order,
                                   int const azimuthal_mode,
                                   int const nr,
@@ -181,101 +215,65 @@ HankelTransform::HankelTransform (int const hankel_order,
 }
 
 void
-HankelTransform::HankelForwardTransform (amrex::FArrayBox const& F, int const F_icomp,
-                                         amrex::FArrayBox      & G, int const G_icomp)
+HankelTransform::BatchedTransform (int const n, int const ncols, int const batch_count,
+                                   amrex::Real const * A, int const strideA,
+                                   amrex::Real const * B, int const ldb, int const strideB,
+                                   amrex::Real       * C, int const ldc, int const strideC)
 {
-    amrex::Box const& F_box = F.box();
-    amrex::Box const& G_box = G.box();
-
-    int const nrF = F_box.length(0);
-    int const nz = F_box.length(1);
-    int const ngr = G_box.smallEnd(0) - F_box.smallEnd(0);
-
-    AMREX_ALWAYS_ASSERT(m_nr == G_box.length(0));
-    AMREX_ALWAYS_ASSERT(nz == G_box.length(1));
-    AMREX_ALWAYS_ASSERT(ngr >= 0);
-    AMREX_ALWAYS_ASSERT(F_box.bigEnd(0)+1 >= m_nr);
-
-#ifndef AMREX_USE_GPU
-    // On CPU, the blas::gemm is significantly faster
-
-    // Note that M is flagged to be transposed since it has dimensions (m_nr, m_nk)
-    blas::gemm(blas::Layout::ColMajor, blas::Op::Trans, blas::Op::NoTrans,
-               m_nk, nz, m_nr, 1._rt,
-               m_M.dataPtr(), m_nk,
-               F.dataPtr(F_icomp)+ngr, nrF, 0._rt,
-               G.dataPtr(G_icomp), m_nk);
-
-#else
-    // On GPU, the explicit loop is significantly faster
-    // It is not clear if the GPU gemm wasn't build properly, it is cycling data out and back
-    // in to the device, or if it is because gemm is launching its own threads.
-
-    amrex::Real const * M_arr = m_M.dataPtr();
-    amrex::Array4<const amrex::Real> const & F_arr = F.array();
-    amrex::Array4<      amrex::Real> const & G_arr = G.array();
-
-    int const nr = m_nr;
-
-    amrex::ParallelFor(G_box,
-    [=] AMREX_GPU_DEVICE(int ik, int iz, int inotused) noexcept {
-        G_arr(ik,iz,G_icomp) = 0.;
-        for (int ir=0 ; ir < nr ; ir++) {
-            int const ii = ir + ik*nr;
-            G_arr(ik,iz,G_icomp) += M_arr[ii]*F_arr(ir,iz,F_icomp);
+    if (batch_count <= 0) return;
+
+#if defined(AMREX_USE_CUDA)
+    // All the modes (and the real and imaginary parts) are transformed in one call
+    cublasSetStream(GetBlasHandle(), amrex::Gpu::gpuStream());
+    amrex::Real const alpha = 1._rt;
+    amrex::Real const beta = 0._rt;
+#   ifdef AMREX_USE_FLOAT
+    cublasStatus_t const result = cublasSgemmStridedBatched(
+#   else
+    cublasStatus_t const result = cublasDgemmStridedBatched(
+#   endif
+        GetBlasHandle(), CUBLAS_OP_T, CUBLAS_OP_N, n, ncols, n, &alpha,
+        A, n, strideA, B, ldb, strideB, &beta, C, ldc, strideC, batch_count);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(result == CUBLAS_STATUS_SUCCESS,
+                                     "HankelTransform: cublas gemm failed");
+
+#elif defined(AMREX_USE_HIP)
+    rocblas_set_stream(GetBlasHandle(), amrex::Gpu::gpuStream());
+    amrex::Real const alpha = 1._rt;
+    amrex::Real const beta = 0._rt;
+#   ifdef AMREX_USE_FLOAT
+    rocblas_status const result = rocblas_sgemm_strided_batched(
+#   else
+    rocblas_status const result = rocblas_dgemm_strided_batched(
+#   endif
+        GetBlasHandle(), rocblas_operation_transpose, rocblas_operation_none,
+        n, ncols, n, &alpha,
+        A, n, strideA, B, ldb, strideB, &beta, C, ldc, strideC, batch_count);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(result == rocblas_status_success,
+                                     "HankelTransform: rocblas gemm failed");
+
+#elif defined(AMREX_USE_GPU)
+    // No vendor BLAS wrapped for this GPU backend: explicit loop,
+    // with one thread per element of the output matrices
+    amrex::ParallelFor(n, ncols, batch_count,
+    [=] AMREX_GPU_DEVICE(int i, int j, int b) noexcept {
+        amrex::Real const * Ab = A + static_cast<long>(b)*strideA + static_cast<long>(i)*n;
+        amrex::Real const * Bb = B + static_cast<long>(b)*strideB + static_cast<long>(j)*ldb;
+        amrex::Real sum = 0._rt;
+        for (int l=0 ; l < n ; l++) {
+            sum += Ab[l]*Bb[l];
         }
+        C[static_cast<long>(b)*strideC + static_cast<long>(j)*ldc + i] = sum;
     });
 
-#endif
-
-}
-
-void
-HankelTransform::HankelInverseTransform (amrex::FArrayBox const& G, int const G_icomp,
-                                         amrex::FArrayBox      & F, int const F_icomp)
-{
-    amrex::Box const& G_box = G.box();
-    amrex::Box const& F_box = F.box();
-
-    int const nrF = F_box.length(0);
-    int const nz = F_box.length(1);
-    int const ngr = G_box.smallEnd(0) - F_box.smallEnd(0);
-
-    AMREX_ALWAYS_ASSERT(m_nr == G_box.length(0));
-    AMREX_ALWAYS_ASSERT(nz == G_box.length(1));
-    AMREX_ALWAYS_ASSERT(ngr >= 0);
-    AMREX_ALWAYS_ASSERT(F_box.bigEnd(0)+1 >= m_nr);
-
-#ifndef AMREX_USE_GPU
-    // On CPU, the blas::gemm is significantly faster
-
-    // Note that m_invM is flagged to be transposed since it has dimensions (m_nk, m_nr)
-    blas::gemm(blas::Layout::ColMajor, blas::Op::Trans, blas::Op::NoTrans,
-               m_nr, nz, m_nk, 1._rt,
-               m_invM.dataPtr(), m_nr,
-               G.dataPtr(G_icomp), m_nk, 0._rt,
-               F.dataPtr(F_icomp)+ngr, nrF);
-
 #else
-    // On GPU, the explicit loop is significantly faster
-    // It is not clear if the GPU gemm wasn't build properly, it is cycling data out and back
-    // in to the device, or if it is because gemm is launching its own threads.
-
-    amrex::Real const * invM_arr = m_invM.dataPtr();
-    amrex::Array4<const amrex::Real> const & G_arr = G.array();
-    amrex::Array4<      amrex::Real> const & F_arr = F.array();
-
-    int const nk = m_nk;
-
-    amrex::ParallelFor(G_box,
-    [=] AMREX_GPU_DEVICE(int ir, int iz, int inotused) noexcept {
-        F_arr(ir,iz,F_icomp) = 0.;
-        for (int ik=0 ; ik < nk ; ik++) {
-            int const ii = ik + ir*nk;
-            F_arr(ir,iz,F_icomp) += invM_arr[ii]*G_arr(ik,iz,G_icomp);
-        }
-    });
-
+    // On CPU, one blas::gemm per batch member
+    for (int b=0 ; b < batch_count ; b++) {
+        blas::gemm(blas::Layout::ColMajor, blas::Op::Trans, blas::Op::NoTrans,
+                   n, ncols, n, 1._rt,
+                   A + static_cast<long>(b)*strideA, n,
+                   B + static_cast<long>(b)*strideB, ldb, 0._rt,
+                   C + static_cast<long>(b)*strideC, ldc);
+    }
 #endif
-
 }
@@ -15,43 +15,96 @@ SpectralHankelTransformer::SpectralHankelTransformer (int const nr,
 : m_nr(nr), m_n_rz_azimuthal_modes(n_rz_azimuthal_modes)
 {
 
-    dht0.resize(m_n_rz_azimuthal_modes);
-    dhtp.resize(m_n_rz_azimuthal_modes);
-    dhtm.resize(m_n_rz_azimuthal_modes);
+    int const nmat = m_nr*m_nr;
+    m_kr.resize(m_nr*m_n_rz_azimuthal_modes);
+    for (auto* mat : {&m_M0, &m_invM0, &m_Mm, &m_invMm, &m_Mp, &m_invMp}) {
+        mat->resize(nmat*m_n_rz_azimuthal_modes);
+    }
+
+    // Copy the matrices of all of the modes (and the kr's) in contiguous arrays,
+    // with the data of each mode grouped together, so that all the modes can be
+    // transformed in one batched call.
+    auto stack = [&] (HankelTransform::RealVector const & src,
+                      HankelTransform::RealVector & dst, int const offset)
+    {
+        amrex::Gpu::copyAsync(amrex::Gpu::deviceToDevice, src.begin(), src.end(),
+                              dst.begin() + offset);
+    };
 
     for (int mode=0 ; mode < m_n_rz_azimuthal_modes ; mode++) {
-        dht0[mode] = std::make_unique<HankelTransform>(mode  , mode, m_nr, rmax);
-        dhtp[mode] = std::make_unique<HankelTransform>(mode+1, mode, m_nr, rmax);
-        dhtm[mode] = std::make_unique<HankelTransform>(mode-1, mode, m_nr, rmax);
+        HankelTransform dht0(mode  , mode, m_nr, rmax);
+        HankelTransform dhtp(mode+1, mode, m_nr, rmax);
+        HankelTransform dhtm(mode-1, mode, m_nr, rmax);
+
+        stack(dht0.getSpectralWavenumbers(), m_kr, mode*m_nr);
+        stack(dht0.getForwardMatrix(), m_M0, mode*nmat);
+        stack(dht0.getInverseMatrix(), m_invM0, mode*nmat);
+        stack(dhtp.getForwardMatrix(), m_Mp, mode*nmat);
+        stack(dhtp.getInverseMatrix(), m_invMp, mode*nmat);
+        stack(dhtm.getForwardMatrix(), m_Mm, mode*nmat);
+        stack(dhtm.getInverseMatrix(), m_invMm, mode*nmat);
+
+        // The copies must be complete before the transform objects are destroyed
+        amrex::Gpu::synchronize();
     }
 
-    ExtractKrArray();
-
 }
 
-/* \brief Extracts the kr for all of the modes
- * This needs to be separate since the ParallelFor cannot be in the constructor. */
+/* \brief Forward transform of the modes mode_start ... mode_start+nmodes-1, in one
+ * batched call. Since the FArrayBox are 2D, the ncomp_per_mode consecutive components
+ * of a mode (e.g. real and imaginary parts) can be treated as a single matrix. */
 void
-SpectralHankelTransformer::ExtractKrArray ()
+SpectralHankelTransformer::ForwardModes (HankelTransform::RealVector const & matrices,
+                                         int const mode_start, int const nmodes,
+                                         int const ncomp_per_mode,
+                                         amrex::FArrayBox const & F, int const F_icomp,
+                                         amrex::FArrayBox       & G, int const G_icomp)
 {
-    m_kr.resize(m_nr*m_n_rz_azimuthal_modes);
-
-    for (int mode=0 ; mode < m_n_rz_azimuthal_modes ; mode++) {
+    amrex::Box const& F_box = F.box();
+    amrex::Box const& G_box = G.box();
+
+    int const nrF = F_box.length(0);
+    int const nz = F_box.length(1);
+    int const ngr = G_box.smallEnd(0) - F_box.smallEnd(0);
+
+    AMREX_ALWAYS_ASSERT(m_nr == G_box.length(0));
+    AMREX_ALWAYS_ASSERT(nz == G_box.length(1));
+    AMREX_ALWAYS_ASSERT(ngr >= 0);
+    AMREX_ALWAYS_ASSERT(F_box.bigEnd(0)+1 >= m_nr);
+    AMREX_ALWAYS_ASSERT(F_box.numPts() == static_cast<long>(nrF)*nz);
+
+    HankelTransform::BatchedTransform(m_nr, ncomp_per_mode*nz, nmodes,
+        matrices.dataPtr() + mode_start*m_nr*m_nr, m_nr*m_nr,
+        F.dataPtr(F_icomp)+ngr, nrF, ncomp_per_mode*nrF*nz,
+        G.dataPtr(G_icomp), m_nr, ncomp_per_mode*m_nr*nz);
+}
 
-        // Save a copy of all of the kr's in one place to allow easy access later.
-        // They are stored with the kr's of each mode grouped together.
-        amrex::Real *kr_array = m_kr.dataPtr();
-        auto const & kr_mode = dht0[mode]->getSpectralWavenumbers();
-        auto const & kr_m_array = kr_mode.dataPtr();
-        int const nr_temp = m_nr;
-        amrex::ParallelFor(m_nr,
-        [=] AMREX_GPU_DEVICE (int ir)
-        {
-            int const ii = ir + mode*nr_temp;
-            kr_array[ii] = kr_m_array[ir];
-        });
-    }
-    amrex::Gpu::synchronize();
+/* \brief Inverse transform of the modes mode_start ... mode_start+nmodes-1, in one
+ * batched call (see ForwardModes) */
+void
+SpectralHankelTransformer::InverseModes (HankelTransform::RealVector const & matrices,
+                                         int const mode_start, int const nmodes,
+                                         int const ncomp_per_mode,
+                                         amrex::FArrayBox const & G, int const G_icomp,
+                                         amrex::FArrayBox       & F, int const F_icomp)
+{
+    amrex::Box const& G_box = G.box();
+    amrex::Box const& F_box = F.box();
+
+    int const nrF = F_box.length(0);
+    int const nz = F_box.length(1);
+    int const ngr = G_box.smallEnd(0) - F_box.smallEnd(0);
+
+    AMREX_ALWAYS_ASSERT(m_nr == G_box.length(0));
+    AMREX_ALWAYS_ASSERT(nz == G_box.length(1));
+    AMREX_ALWAYS_ASSERT(ngr >= 0);
+    AMREX_ALWAYS_ASSERT(F_box.bigEnd(0)+1 >= m_nr);
+    AMREX_ALWAYS_ASSERT(F_box.numPts() == static_cast<long>(nrF)*nz);
+
+    HankelTransform::BatchedTransform(m_nr, ncomp_per_mode*nz, nmodes,
+        matrices.dataPtr() + mode_start*m_nr*m_nr, m_nr*m_nr,
+        G.dataPtr(G_icomp), m_nr, ncomp_per_mode*m_nr*nz,
+        F.dataPtr(F_icomp)+ngr, nrF, ncomp_per_mode*nrF*nz);
 }
 
 /* \brief Converts a scalar field from the physical to the spectral space for all modes */
@@ -60,23 +113,14 @@ SpectralHankelTransformer::PhysicalToSpectral_Scalar (amrex::FArrayBox const & F
                                                       amrex::FArrayBox       & G_spectral)
 {
     // The Hankel transform is purely real, so the real and imaginary parts of
-    // F can be transformed separately, so a simple loop over components
-    // can be done.
+    // F can be transformed separately.
     // Note that F_physical does not include the imaginary part of mode 0,
     // but G_spectral does.
-    for (int mode=0 ; mode < m_n_rz_azimuthal_modes ; mode++) {
-        int const mode_r = 2*mode;
-        int const mode_i = 2*mode + 1;
-        if (mode == 0) {
-            int const icomp = 0;
-            dht0[mode]->HankelForwardTransform(F_physical, icomp, G_spectral, mode_r);
-            G_spectral.setVal<amrex::RunOn::Device>(0., mode_i);
-        } else {
-            int const icomp = 2*mode - 1;
-            dht0[mode]->HankelForwardTransform(F_physical, icomp  , G_spectral, mode_r);
-            dht0[mode]->HankelForwardTransform(F_physical, icomp+1, G_spectral, mode_i);
-        }
-    }
+    ForwardModes(m_M0, 0, 1, 1, F_physical, 0, G_spectral, 0);
+    G_spectral.setVal<amrex::RunOn::Device>(0., 1);
+
+    // All the other modes, with their real and imaginary parts, in one call
+    ForwardModes(m_M0, 1, m_n_rz_azimuthal_modes-1, 2, F_physical, 1, G_spectral, 2);
 }
 
 /* \brief Converts a vector field from the physical to the spectral space for all modes */
@@ -95,35 +139,27 @@ SpectralHankelTransformer::PhysicalToSpectral_Vector (amrex::Box const & box,
     amrex::Array4<amrex::Real> const & F_r_physical_array = F_r_physical.array();
     amrex::Array4<amrex::Real> const & F_t_physical_array = F_t_physical.array();
 
-    for (int mode=0 ; mode < m_n_rz_azimuthal_modes ; mode++) {
-
+    amrex::ParallelFor(box, m_n_rz_azimuthal_modes,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int mode)
+    {
         int const mode_r = 2*mode;
         int const mode_i = 2*mode + 1;
-
-        amrex::ParallelFor(box,
-        [=] AMREX_GPU_DEVICE (int i, int j, int k)
-        {
-            amrex::Real const r_real = F_r_physical_array(i,j,k,mode_r);
-            amrex::Real const r_imag = F_r_physical_array(i,j,k,mode_i);
-            amrex::Real const t_real = F_t_physical_array(i,j,k,mode_r);
-            amrex::Real const t_imag = F_t_physical_array(i,j,k,mode_i);
-            // Combine the values
-            // temp_p = (F_r - I*F_t)/2
-            // temp_m = (F_r + I*F_t)/2
-            F_r_physical_array(i,j,k,mode_r) = 0.5_rt*(r_real + t_imag);
-            F_r_physical_array(i,j,k,mode_i) = 0.5_rt*(r_imag - t_real);
-            F_t_physical_array(i,j,k,mode_r) = 0.5_rt*(r_real - t_imag);
-            F_t_physical_array(i,j,k,mode_i) = 0.5_rt*(r_imag + t_real);
-        });
-
-        amrex::Gpu::streamSynchronize();
-
-        dhtp[mode]->HankelForwardTransform(F_r_physical, mode_r, G_p_spectral, mode_r);
-        dhtp[mode]->HankelForwardTransform(F_r_physical, mode_i, G_p_spectral, mode_i);
-        dhtm[mode]->HankelForwardTransform(F_t_physical, mode_r, G_m_spectral, mode_r);
-        dhtm[mode]->HankelForwardTransform(F_t_physical, mode_i, G_m_spectral, mode_i);
-
-    }
+        amrex::Real const r_real = F_r_physical_array(i,j,k,mode_r);
+        amrex::Real const r_imag = F_r_physical_array(i,j,k,mode_i);
+        amrex::Real const t_real = F_t_physical_array(i,j,k,mode_r);
+        amrex::Real const t_imag = F_t_physical_array(i,j,k,mode_i);
+        // Combine the values
+        // temp_p = (F_r - I*F_t)/2
+        // temp_m = (F_r + I*F_t)/2
+        F_r_physical_array(i,j,k,mode_r) = 0.5_rt*(r_real + t_imag);
+        F_r_physical_array(i,j,k,mode_i) = 0.5_rt*(r_imag - t_real);
+        F_t_physical_array(i,j,k,mode_r) = 0.5_rt*(r_real - t_imag);
+        F_t_physical_array(i,j,k,mode_i) = 0.5_rt*(r_imag + t_real);
+    });
+
+    // The transforms are done on the same stream as the kernel above
+    ForwardModes(m_Mp, 0, m_n_rz_azimuthal_modes, 2, F_r_physical, 0, G_p_spectral, 0);
+    ForwardModes(m_Mm, 0, m_n_rz_azimuthal_modes, 2, F_t_physical, 0, G_m_spectral, 0);
 }
 
 /* \brief Converts a scalar field from the spectral to the physical space for all modes */
@@ -132,25 +168,11 @@ SpectralHankelTransformer::SpectralToPhysical_Scalar (amrex::FArrayBox const & G
                                                       amrex::FArrayBox       & F_physical)
 {
     // The Hankel inverse transform is purely real, so the real and imaginary parts of
-    // F can be transformed separately, so a simple loop over components
-    // can be done.
+    // F can be transformed separately.
     // Note that F_physical does not include the imaginary part of mode 0,
     // but G_spectral does.
-
-    amrex::Gpu::streamSynchronize();
-
-    for (int mode=0 ; mode < m_n_rz_azimuthal_modes ; mode++) {
-        int const mode_r = 2*mode;
-        int const mode_i = 2*mode + 1;
-        if (mode == 0) {
-            int const icomp = 0;
-            dht0[mode]->HankelInverseTransform(G_spectral, mode_r, F_physical, icomp);
-        } else {
-            int const icomp = 2*mode - 1;
-            dht0[mode]->HankelInverseTransform(G_spectral, mode_r, F_physical, icomp);
-            dht0[mode]->HankelInverseTransform(G_spectral, mode_i, F_physical, icomp+1);
-        }
-    }
+    InverseModes(m_invM0, 0, 1, 1, G_spectral, 0, F_physical, 0);
+    InverseModes(m_invM0, 1, m_n_rz_azimuthal_modes-1, 2, G_spectral, 2, F_physical, 1);
 }
 
 /* \brief Converts a vector field from the spectral to the physical space for all modes */
@@ -163,38 +185,27 @@ SpectralHankelTransformer::SpectralToPhysical_Vector (amrex::Box const & box,
 {
     // Note that F and G include the imaginary part of mode 0.
 
+    InverseModes(m_invMp, 0, m_n_rz_azimuthal_modes, 2, G_p_spectral, 0, F_r_physical, 0);
+    InverseModes(m_invMm, 0, m_n_rz_azimuthal_modes, 2, G_m_spectral, 0, F_t_physical, 0);
+
     amrex::Array4<amrex::Real> const & F_r_physical_array = F_r_physical.array();
     amrex::Array4<amrex::Real> const & F_t_physical_array = F_t_physical.array();
 
-    for (int mode=0 ; mode < m_n_rz_azimuthal_modes ; mode++) {
-
+    amrex::ParallelFor(box, m_n_rz_azimuthal_modes,
+    [=] AMREX_GPU_DEVICE (int i, int j, int k, int mode)
+    {
         int const mode_r = 2*mode;
         int const mode_i = 2*mode + 1;
-
-        amrex::Gpu::streamSynchronize();
-
-        dhtp[mode]->HankelInverseTransform(G_p_spectral, mode_r, F_r_physical, mode_r);
-        dhtp[mode]->HankelInverseTransform(G_p_spectral, mode_i, F_r_physical, mode_i);
-        dhtm[mode]->HankelInverseTransform(G_m_spectral, mode_r, F_t_physical, mode_r);
-        dhtm[mode]->HankelInverseTransform(G_m_spectral, mode_i, F_t_physical, mode_i);
-
-        amrex::Gpu::streamSynchronize();
-
-        amrex::ParallelFor(box,
-        [=] AMREX_GPU_DEVICE (int i, int j, int k)
-        {
-            amrex::Real const p_real = F_r_physical_array(i,j,k,mode_r);
-            amrex::Real const p_imag = F_r_physical_array(i,j,k,mode_i);
-            amrex::Real const m_real = F_t_physical_array(i,j,k,mode_r);
-            amrex::Real const m_imag = F_t_physical_array(i,j,k,mode_i);
-            // Combine the values
-            // F_r =    G_p + G_m
-            // F_t = I*(G_p - G_m)
-            F_r_physical_array(i,j,k,mode_r) =  p_real + m_real;
-            F_r_physical_array(i,j,k,mode_i) =  p_imag + m_imag;
-            F_t_physical_array(i,j,k,mode_r) = -p_imag + m_imag;
-            F_t_physical_array(i,j,k,mode_i) =  p_real - m_real;
-        });
-
-    }
+        amrex::Real const p_real = F_r_physical_array(i,j,k,mode_r);
+        amrex::Real const p_imag = F_r_physical_array(i,j,k,mode_i);
+        amrex::Real const m_real = F_t_physical_array(i,j,k,mode_r);
+        amrex::Real const m_imag = F_t_physical_array(i,j,k,mode_i);
+        // Combine the values
+        // F_r =    G_p + G_m
+        // F_t = I*(G_p - G_m)
+        F_r_physical_array(i,j,k,mode_r) =  p_real + m_real;
+        F_r_physical_array(i,j,k,mode_i) =  p_imag + m_imag;
+        F_t_physical_array(i,j,k,mode_r) = -p_imag + m_imag;
+        F_t_physical_array(i,j,k,mode_i) =  p_real - m_real;
+    });
 }
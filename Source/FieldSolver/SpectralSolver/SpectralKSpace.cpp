@@ -8,10 +8,100 @@
 #include "Utils/WarpXConst.H"
 #include "SpectralKSpace.H"
 
+#include <AMReX.H>
+
 #include <cmath>
+#include <map>
+#include <tuple>
 
 using namespace amrex;
 
+namespace
+{
+    /** Key of the cache of k vectors: number of points, number of points of the FFT
+     *  along the axis, cell size, whether the axis only contains positive k (first
+     *  axis of the real-to-complex FFTs), order of the stencil (-1 for the infinite
+     *  order, i.e. the k vector itself) and whether the stencil is nodal */
+    using KVectorKey = std::tuple<int, int, Real, bool, int, bool>;
+
+    std::map<KVectorKey, RealKVector> k_vector_cache;
+    bool k_vector_cache_registered = false;
+
+    /** \brief Get a (modified) k vector from the cache of k vectors shared by the
+     * boxes, levels and solvers with the same parameters (see KVectorKey); it is
+     * computed on the device if it is not in the cache yet. The cache is cleared
+     * at amrex::Finalize.
+     */
+    RealKVector const&
+    GetCachedKVector (const int N, const int fft_size, const Real delta_x,
+                      const bool only_positive_k, const int n_order, bool nodal)
+    {
+        // the stencil only matters at finite order
+        if (n_order == -1) nodal = false;
+        const KVectorKey key {N, fft_size, delta_x, only_positive_k, n_order, nodal};
+
+        auto it = k_vector_cache.find(key);
+        if (it != k_vector_cache.end()) return it->second;
+
+        if (!k_vector_cache_registered) {
+            amrex::ExecOnFinalize([] () { k_vector_cache.clear(); });
+            k_vector_cache_registered = true;
+        }
+
+        RealKVector k(N);
+        Real* pk = k.data();
+        const Real dk = 2*MathConst::pi/(fft_size*delta_x);
+        // FFT conventions: the first half is positive, the second half is negative,
+        // unless the axis only contains the positive k (real-to-complex FFT)
+        const int mid_point = only_positive_k ? N : (N+1)/2;
+
+        if (n_order == -1) { // Infinite-order case
+            amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
+            {
+                pk[i] = (i < mid_point) ? i*dk : (i-N)*dk;
+            });
+        } else {
+            // Compute real-space stencil coefficients
+            Vector<Real> h_stencil_coef = getFornbergStencilCoefficients(n_order, nodal);
+            Gpu::DeviceVector<Real> d_stencil_coef(h_stencil_coef.size());
+            Gpu::copyAsync(Gpu::hostToDevice, h_stencil_coef.begin(), h_stencil_coef.end(),
+                           d_stencil_coef.begin());
+            const int nstencil = d_stencil_coef.size();
+            Real const* p_stencil_coef = d_stencil_coef.data();
+
+            // By construction, at finite order and for a nodal grid,
+            // the *modified* k corresponding to the Nyquist frequency
+            // (i.e. highest *real* k) is 0. However, the calculation
+            // based on stencil coefficients does not give 0 to machine precision.
+            // Therefore, we need to enforce the fact that the modified k be 0 there:
+            // the last element of the array when the axis only contains the positive k,
+            // the middle of the array otherwise.
+            const int i_nyquist = only_positive_k ? N-1 : N/2;
+
+            amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
+            {
+                const Real k_i = (i < mid_point) ? i*dk : (i-N)*dk;
+                Real modified_k = 0;
+                for (int n=0; n<nstencil; n++){
+                    if (nodal){
+                        modified_k += p_stencil_coef[n]*
+                            std::sin( k_i*(n+1)*delta_x )/( (n+1)*delta_x );
+                    } else {
+                        modified_k += p_stencil_coef[n]*
+                            std::sin( k_i*(n+0.5)*delta_x )/( (n+0.5)*delta_x );
+                    }
+                }
+                if (nodal && i == i_nyquist) modified_k = 0.0_rt;
+                pk[i] = modified_k;
+            });
+            // d_stencil_coef is freed at the end of the scope
+            Gpu::streamSynchronize();
+        }
+
+        return k_vector_cache.emplace(key, std::move(k)).first->second;
+    }
+}
+
 /* \brief Initialize k space object.
  *
  * \param realspace_ba Box array that corresponds to the decomposition
@@ -22,7 +112,8 @@ using namespace amrex;
 SpectralKSpace::SpectralKSpace( const BoxArray& realspace_ba,
                                 const DistributionMapping& dm,
                                 const RealVect realspace_dx )
-    : dx(realspace_dx)  // Store the cell size as member `dx`
+    : dx(realspace_dx),  // Store the cell size as member `dx`
+      m_realspace_ba(realspace_ba)
 {
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
         realspace_ba.ixType()==IndexType::TheCellType(),
@@ -64,6 +155,40 @@ SpectralKSpace::SpectralKSpace( const BoxArray& realspace_ba,
     }
 }
 
+/* \brief Initialize k space object, for the global (distributed) FFT
+ *
+ * \param realspace_domain Cell-centered box of the whole domain in real space
+ * \param global_spectralspace_ba Decomposition of the spectral space of the whole domain
+ * (global indices ; see SpectralGlobalDecomposition)
+ * \param dm Indicates which MPI proc owns which box, in global_spectralspace_ba.
+ * \param realspace_dx Cell size of the grid in real space
+ */
+SpectralKSpace::SpectralKSpace( const Box& realspace_domain,
+                                const BoxArray& global_spectralspace_ba,
+                                const DistributionMapping& dm,
+                                const RealVect realspace_dx )
+    : spectralspace_ba(global_spectralspace_ba), dx(realspace_dx),
+      m_global_fft(true), m_realspace_domain(realspace_domain)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+        realspace_domain.ixType()==IndexType::TheCellType(),
+        "SpectralKSpace expects a cell-centered box.");
+
+    // Spectral space of the whole domain (real-to-complex FFT along the first axis)
+    IntVect spectral_size = realspace_domain.length();
+    spectral_size[0] = spectral_size[0]/2 + 1;
+    m_spectralspace_domain = Box( IntVect::TheZeroVector(),
+                                  spectral_size - IntVect::TheUnitVector() );
+
+    // Allocate the components of the k vector: kx, ky (only in 3D), kz
+    const BoxArray realspace_ba(realspace_domain);
+    for (int i_dim=0; i_dim<AMREX_SPACEDIM; i_dim++) {
+        // Real-to-complex FFTs: first axis contains only the positive k
+        const bool only_positive_k = (i_dim==0);
+        k_vec[i_dim] = getKComponent(dm, realspace_ba, i_dim, only_positive_k);
+    }
+}
+
 /* For each box, in `spectralspace_ba`, which is owned by the local MPI rank
  * (as indicated by the argument `dm`), compute the values of the
  * corresponding k coordinate along the dimension specified by `i_dim`
@@ -79,43 +204,25 @@ SpectralKSpace::getKComponent( const DistributionMapping& dm,
     // Loop over boxes and allocate the corresponding DeviceVector
     // for each box owned by the local MPI proc
     for ( MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi ){
-        Box bx = spectralspace_ba[mfi];
+        // With the global FFT, the k vector spans the spectral space of the whole
+        // domain, so that it is indexed with the global indices of the box
+        Box bx = m_global_fft ? m_spectralspace_domain : spectralspace_ba[mfi];
         Gpu::DeviceVector<Real>& k = k_comp[mfi];
 
         // Allocate k to the right size
         int N = bx.length( i_dim );
         k.resize( N );
-        Real* pk = k.data();
 
         // Fill the k vector
-        IntVect fft_size = realspace_ba[mfi].length();
-        const Real dk = 2*MathConst::pi/(fft_size[i_dim]*dx[i_dim]);
+        IntVect fft_size = m_global_fft ? m_realspace_domain.length()
+                                        : realspace_ba[mfi].length();
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE( bx.smallEnd(i_dim) == 0,
             "Expected box to start at 0, in spectral space.");
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE( bx.bigEnd(i_dim) == N-1,
             "Expected different box end index in spectral space.");
-        if (only_positive_k){
-            // Fill the full axis with positive k values
-            // (typically: first axis, in a real-to-complex FFT)
-            amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
-            {
-                pk[i] = i*dk;
-            });
-        } else {
-            const int mid_point = (N+1)/2;
-            amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
-            {
-                if (i < mid_point) {
-                    // Fill positive values of k
-                    // (FFT conventions: first half is positive)
-                    pk[i] = i*dk;
-                } else {
-                    // Fill negative values of k
-                    // (FFT conventions: second half is negative)
-                    pk[i] = (i-N)*dk;
-                }
-            });
-        }
+        const RealKVector& cached_k = GetCachedKVector(
+            N, fft_size[i_dim], dx[i_dim], only_positive_k, -1, false);
+        Gpu::copyAsync(Gpu::deviceToDevice, cached_k.begin(), cached_k.end(), k.begin());
     }
     return k_comp;
 }
@@ -186,79 +293,24 @@ SpectralKSpace::getModifiedKComponent( const DistributionMapping& dm,
     // Initialize an empty DeviceVector in each box
     KVectorComponent modified_k_comp(spectralspace_ba, dm);
 
-    if (n_order == -1) { // Infinite-order case
-        for ( MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi ){
-            const Gpu::DeviceVector<Real>& k = k_vec[i_dim][mfi];
-            Gpu::DeviceVector<Real>& modified_k = modified_k_comp[mfi];
-
-            // Allocate modified_k to the same size as k
-            const int N = k.size();
-            modified_k.resize(N);
+    // Loop over boxes and allocate the corresponding DeviceVector
+    // for each box owned by the local MPI proc
+    for ( MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi ){
+        Box bx = m_global_fft ? m_spectralspace_domain : spectralspace_ba[mfi];
+        Gpu::DeviceVector<Real>& modified_k = modified_k_comp[mfi];
 
-            // Fill the modified k vector
-            Gpu::copyAsync(Gpu::deviceToDevice, k.begin(), k.end(), modified_k.begin());
-        }
-    } else {
-
-        // Compute real-space stencil coefficients
-        Vector<Real> h_stencil_coef = getFornbergStencilCoefficients(n_order, nodal);
-        Gpu::DeviceVector<Real> d_stencil_coef(h_stencil_coef.size());
-        Gpu::copyAsync(Gpu::hostToDevice, h_stencil_coef.begin(), h_stencil_coef.end(),
-                       d_stencil_coef.begin());
-        Gpu::synchronize();
-        const int nstencil = d_stencil_coef.size();
-        Real const* p_stencil_coef = d_stencil_coef.data();
-
-        // Loop over boxes and allocate the corresponding DeviceVector
-        // for each box owned by the local MPI proc
-        for ( MFIter mfi(spectralspace_ba, dm); mfi.isValid(); ++mfi ){
-            Real delta_x = dx[i_dim];
-            const Gpu::DeviceVector<Real>& k = k_vec[i_dim][mfi];
-            Gpu::DeviceVector<Real>& modified_k = modified_k_comp[mfi];
-
-            // Allocate modified_k to the same size as k
-            const int N = k.size();
-            modified_k.resize(N);
-            Real const* p_k = k.data();
-            Real * p_modified_k = modified_k.data();
-
-            // Fill the modified k vector
-            amrex::ParallelFor(N, [=] AMREX_GPU_DEVICE (int i) noexcept
-            {
-                p_modified_k[i] = 0;
-                for (int n=0; n<nstencil; n++){
-                    if (nodal){
-                        p_modified_k[i] += p_stencil_coef[n]*
-                            std::sin( p_k[i]*(n+1)*delta_x )/( (n+1)*delta_x );
-                    } else {
-                        p_modified_k[i] += p_stencil_coef[n]* \
-                            std::sin( p_k[i]*(n+0.5)*delta_x )/( (n+0.5)*delta_x );
-                    }
-                }
+        // Allocate modified_k to the same size as k
+        const int N = bx.length( i_dim );
+        modified_k.resize(N);
 
-                // By construction, at finite order and for a nodal grid,
-                // the *modified* k corresponding to the Nyquist frequency
-                // (i.e. highest *real* k) is 0. However, the above calculation
-                // based on stencil coefficients does not give 0 to machine precision.
-                // Therefore, we need to enforce the fact that the modified k be 0 here.
-                if (nodal){
-                    if (i_dim == 0){
-                        // Because of the real-to-complex FFTs, the first axis (idim=0)
-                        // contains only the positive k, and the Nyquist frequency is
-                        // the last element of the array.
-                        if (i == N-1) {
-                            p_modified_k[i] = 0.0_rt;
-                        }
-                    } else {
-                        // The other axes contains both positive and negative k ;
-                        // the Nyquist frequency is in the middle of the array.
-                        if (i == N/2) {
-                            p_modified_k[i] = 0.0_rt;
-                        }
-                    }
-                }
-            });
-        }
+        // Fill the modified k vector, from the boxes of the same shape
+        // (the first axis contains only the positive k, see the constructors)
+        const int fft_size = m_global_fft ? m_realspace_domain.length(i_dim)
+                                          : m_realspace_ba[mfi].length(i_dim);
+        const RealKVector& cached_modified_k = GetCachedKVector(
+            N, fft_size, dx[i_dim], i_dim == 0, n_order, nodal);
+        Gpu::copyAsync(Gpu::deviceToDevice, cached_modified_k.begin(), cached_modified_k.end(),
+                       modified_k.begin());
     }
     return modified_k_comp;
 }
@@ -21,6 +21,7 @@ SpectralKSpaceRZ::SpectralKSpaceRZ (const amrex::BoxArray& realspace_ba,
                                     const amrex::RealVect realspace_dx)
 {
     dx = realspace_dx;  // Store the cell size as member `dx`
+    m_realspace_ba = realspace_ba;
 
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
         realspace_ba.ixType() == amrex::IndexType::TheCellType(),
@@ -31,6 +31,9 @@
  * \param dt       Time step
  * \param pml      Whether the boxes in which the solver is applied are PML boxes
  * \param periodic_single_box Whether the full simulation domain consists of a single periodic box (i.e. the global domain is not MPI parallelized)
+ * \param on_the_fly_coefficients Whether the PSATD coefficients are computed at each time step instead of being stored
+ * \param global_fft Whether the FFTs are performed over the whole (periodic) domain, distributed over the MPI ranks,
+ *                   instead of locally in each box (`realspace_ba` then only needs to cover the domain)
  */
 SpectralSolver::SpectralSolver(
                 const int lev,
@@ -43,38 +46,55 @@ SpectralSolver::SpectralSolver(
                 const amrex::RealVect dx, const amrex::Real dt,
                 const bool pml, const bool periodic_single_box,
                 const bool update_with_rho,
-                const bool fft_do_time_averaging) {
+                const bool fft_do_time_averaging,
+                const bool on_the_fly_coefficients,
+                const bool global_fft) {
 
     // Initialize all structures using the same distribution mapping dm
+    // (or, with the global FFT, the distribution mapping of the spectral slabs)
+    std::unique_ptr<SpectralGlobalDecomposition> global_decomposition;
+    if (global_fft) {
+        global_decomposition = std::make_unique<SpectralGlobalDecomposition>(
+            realspace_ba.minimalBox());
+    }
+    const amrex::DistributionMapping& spectral_dm = global_fft ?
+        global_decomposition->spectral_dm : dm;
 
     // - Initialize k space object (Contains info about the size of
     // the spectral space corresponding to each box in `realspace_ba`,
     // as well as the value of the corresponding k coordinates)
-    const SpectralKSpace k_space= SpectralKSpace(realspace_ba, dm, dx);
+    // (kept for the initialization of the k-space filter)
+    m_k_space = global_fft ?
+        std::make_unique<SpectralKSpace>(global_decomposition->realspace_domain,
+                                         global_decomposition->spectral_ba, spectral_dm, dx) :
+        std::make_unique<SpectralKSpace>(realspace_ba, dm, dx);
+    const SpectralKSpace& k_space = *m_k_space;
 
     // - Select the algorithm depending on the input parameters
     //   Initialize the corresponding coefficients over k space
 
     if (pml) {
         algorithm = std::make_unique<PMLPsatdAlgorithm>(
-            k_space, dm, norder_x, norder_y, norder_z, nodal, dt);
+            k_space, spectral_dm, norder_x, norder_y, norder_z, nodal, dt);
     }
     else {
         // Comoving PSATD algorithm
         if (v_comoving[0] != 0. || v_comoving[1] != 0. || v_comoving[2] != 0.) {
             algorithm = std::make_unique<ComovingPsatdAlgorithm>(
-                k_space, dm, norder_x, norder_y, norder_z, nodal, v_comoving, dt, update_with_rho);
+                k_space, spectral_dm, norder_x, norder_y, norder_z, nodal, v_comoving, dt, update_with_rho);
         }
         // PSATD algorithms: standard, Galilean, or averaged Galilean
         else {
             algorithm = std::make_unique<PsatdAlgorithm>(
-                k_space, dm, norder_x, norder_y, norder_z, nodal, v_galilean, dt, update_with_rho, fft_do_time_averaging);
+                k_space, spectral_dm, norder_x, norder_y, norder_z, nodal, v_galilean, dt, update_with_rho, fft_do_time_averaging,
+                on_the_fly_coefficients);
         }
     }
 
     // - Initialize arrays for fields in spectral space + FFT plans
-    field_data = SpectralFieldData( lev, realspace_ba, k_space, dm,
-                    algorithm->getRequiredNumberOfFields(), periodic_single_box);
+    field_data = SpectralFieldData( lev, realspace_ba, k_space, spectral_dm,
+                    algorithm->getRequiredNumberOfFields(), periodic_single_box,
+                    global_decomposition.get());
 
 }
 
@@ -98,6 +118,29 @@ SpectralSolver::BackwardTransform( const int lev,
     field_data.BackwardTransform( lev, mf, field_index, i_comp );
 }
 
+void
+SpectralSolver::ForwardTransform( const int lev,
+                                  const std::vector<SpectralForwardComponent>& comps )
+{
+    WARPX_PROFILE("SpectralSolver::ForwardTransform");
+    field_data.ForwardTransform( lev, comps );
+}
+
+void
+SpectralSolver::BackwardTransform( const int lev,
+                                   const std::vector<SpectralBackwardComponent>& comps )
+{
+    WARPX_PROFILE("SpectralSolver::BackwardTransform");
+    field_data.BackwardTransform( lev, comps );
+}
+
+void
+SpectralSolver::InitFilter( const amrex::IntVect& filter_npass_each_dir,
+                            const bool compensation )
+{
+    field_data.InitFilter( filter_npass_each_dir, compensation, *m_k_space );
+}
+
 void
 SpectralSolver::pushSpectralFields(){
     WARPX_PROFILE("SpectralSolver::pushSpectralFields");
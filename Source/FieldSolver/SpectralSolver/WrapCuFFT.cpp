@@ -13,42 +13,36 @@ namespace AnyFFT
 #ifdef AMREX_USE_FLOAT
     cufftType VendorR2C = CUFFT_R2C;
     cufftType VendorC2R = CUFFT_C2R;
+    cufftType VendorC2C = CUFFT_C2C;
 #else
     cufftType VendorR2C = CUFFT_D2Z;
     cufftType VendorC2R = CUFFT_Z2D;
+    cufftType VendorC2C = CUFFT_Z2Z;
 #endif
 
     std::string cufftErrorToString (const cufftResult& err);
 
     FFTplan CreatePlan(const amrex::IntVect& real_size, amrex::Real * const real_array,
-                       Complex * const complex_array, const direction dir, const int dim)
+                       Complex * const complex_array, const direction dir, const int dim,
+                       const int howmany)
     {
         FFTplan fft_plan;
 
-        // Initialize fft_plan.m_plan with the vendor fft plan.
-        cufftResult result;
-        if (dir == direction::R2C){
-            if (dim == 3) {
-                result = cufftPlan3d(
-                    &(fft_plan.m_plan), real_size[2], real_size[1], real_size[0], VendorR2C);
-            } else if (dim == 2) {
-                result = cufftPlan2d(
-                    &(fft_plan.m_plan), real_size[1], real_size[0], VendorR2C);
-            } else {
-                amrex::Abort("only dim=2 and dim=3 have been implemented");
-            }
-        } else {
-            if (dim == 3) {
-                result = cufftPlan3d(
-                    &(fft_plan.m_plan), real_size[2], real_size[1], real_size[0], VendorC2R);
-            } else if (dim == 2) {
-                result = cufftPlan2d(
-                    &(fft_plan.m_plan), real_size[1], real_size[0], VendorC2R);
-            } else {
-                amrex::Abort("only dim=2 and dim=3 have been implemented");
-            }
+        if (dim < 1 || dim > 3) {
+            amrex::Abort("only dim=1, dim=2 and dim=3 have been implemented");
         }
 
+        // Swap dimensions: AMReX FAB are Fortran-order but cuFFT is C-order
+        int n[3];
+        for (int idim = 0; idim < dim; ++idim) n[idim] = real_size[dim-1-idim];
+
+        // Initialize fft_plan.m_plan with the vendor fft plan.
+        // With null embed arrays, cuFFT uses its basic data layout, in which the
+        // howmany transforms are contiguous, as the components of a FAB.
+        cufftResult result = cufftPlanMany(
+            &(fft_plan.m_plan), dim, n, nullptr, 1, 0, nullptr, 1, 0,
+            (dir == direction::R2C) ? VendorR2C : VendorC2R, howmany);
+
         if ( result != CUFFT_SUCCESS ) {
             amrex::Print() << " cufftplan failed! Error: " <<
                 cufftErrorToString(result) << "\n";
@@ -59,20 +53,108 @@ namespace AnyFFT
         fft_plan.m_complex_array = complex_array;
         fft_plan.m_dir = dir;
         fft_plan.m_dim = dim;
+        fft_plan.m_howmany = howmany;
+
+        return fft_plan;
+    }
+
+#ifndef AMREX_USE_FLOAT
+    FFTplan CreatePlan(const amrex::IntVect& real_size, float * const real_array,
+                       FloatComplex * const complex_array, const direction dir, const int dim,
+                       const int howmany)
+    {
+        FFTplan fft_plan;
+
+        if (dim < 1 || dim > 3) {
+            amrex::Abort("only dim=1, dim=2 and dim=3 have been implemented");
+        }
+
+        // Swap dimensions: AMReX FAB are Fortran-order but cuFFT is C-order
+        int n[3];
+        for (int idim = 0; idim < dim; ++idim) n[idim] = real_size[dim-1-idim];
+
+        // Initialize fft_plan.m_plan_float with the single-precision vendor fft plan
+        cufftResult result = cufftPlanMany(
+            &(fft_plan.m_plan_float), dim, n, nullptr, 1, 0, nullptr, 1, 0,
+            (dir == direction::R2C) ? CUFFT_R2C : CUFFT_C2R, howmany);
+
+        if ( result != CUFFT_SUCCESS ) {
+            amrex::Print() << " cufftplan failed! Error: " <<
+                cufftErrorToString(result) << "\n";
+        }
+
+        // Store meta-data in fft_plan
+        fft_plan.m_single = true;
+        fft_plan.m_real_array = nullptr;
+        fft_plan.m_complex_array = nullptr;
+        fft_plan.m_real_array_float = real_array;
+        fft_plan.m_complex_array_float = complex_array;
+        fft_plan.m_dir = dir;
+        fft_plan.m_dim = dim;
+        fft_plan.m_howmany = howmany;
+
+        return fft_plan;
+    }
+#endif
+
+    FFTplan CreatePlanC2C(const int n, Complex * const complex_array, const int stride,
+                          const int dist, const int howmany, const direction dir)
+    {
+        FFTplan fft_plan;
+
+        // Non-null embed arrays are needed for cuFFT to take the stride into account
+        int nn[1] = {n};
+        cufftResult result = cufftPlanMany(
+            &(fft_plan.m_plan), 1, nn, nn, stride, dist, nn, stride, dist, VendorC2C, howmany);
+
+        if ( result != CUFFT_SUCCESS ) {
+            amrex::Print() << " cufftplan failed! Error: " <<
+                cufftErrorToString(result) << "\n";
+        }
+
+        // Store meta-data in fft_plan
+        fft_plan.m_real_array = nullptr;
+        fft_plan.m_complex_array = complex_array;
+        fft_plan.m_dir = dir;
+        fft_plan.m_dim = 1;
+        fft_plan.m_howmany = howmany;
 
         return fft_plan;
     }
 
     void DestroyPlan(FFTplan& fft_plan)
     {
+#ifndef AMREX_USE_FLOAT
+        if (fft_plan.m_single) {
+            cufftDestroy( fft_plan.m_plan_float );
+            return;
+        }
+#endif
         cufftDestroy( fft_plan.m_plan );
     }
 
     void Execute(FFTplan& fft_plan){
         // make sure that this is done on the same GPU stream as the above copy
         cudaStream_t stream = amrex::Gpu::Device::cudaStream();
-        cufftSetStream ( fft_plan.m_plan, stream);
         cufftResult result;
+#ifndef AMREX_USE_FLOAT
+        if (fft_plan.m_single){
+            cufftSetStream ( fft_plan.m_plan_float, stream);
+            if (fft_plan.m_dir == direction::R2C){
+                result = cufftExecR2C(fft_plan.m_plan_float, fft_plan.m_real_array_float,
+                                      fft_plan.m_complex_array_float);
+            } else {
+                result = cufftExecC2R(fft_plan.m_plan_float, fft_plan.m_complex_array_float,
+                                      fft_plan.m_real_array_float);
+            }
+            if ( result != CUFFT_SUCCESS ) {
+                amrex::Print() << " forward transform using cufftExec failed ! Error: " <<
+                    cufftErrorToString(result) << "\n";
+            }
+            return;
+        }
+#endif
+        cufftSetStream ( fft_plan.m_plan, stream);
         if (fft_plan.m_dir == direction::R2C){
 #ifdef AMREX_USE_FLOAT
             result = cufftExecR2C(fft_plan.m_plan, fft_plan.m_real_array, fft_plan.m_complex_array);
@@ -86,7 +168,15 @@ namespace AnyFFT
             result = cufftExecZ2D(fft_plan.m_plan, fft_plan.m_complex_array, fft_plan.m_real_array);
 #endif
         } else {
-            amrex::Abort("direction must be AnyFFT::direction::R2C or AnyFFT::direction::C2R");
+            // In-place complex-to-complex FFT
+            const int sign = (fft_plan.m_dir == direction::C2C_FORWARD) ? CUFFT_FORWARD : CUFFT_INVERSE;
+#ifdef AMREX_USE_FLOAT
+            result = cufftExecC2C(fft_plan.m_plan, fft_plan.m_complex_array,
+                                  fft_plan.m_complex_array, sign);
+#else
+            result = cufftExecZ2Z(fft_plan.m_plan, fft_plan.m_complex_array,
+                                  fft_plan.m_complex_array, sign);
+#endif
         }
         if ( result != CUFFT_SUCCESS ) {
             amrex::Print() << " forward transform using cufftExec failed ! Error: " <<
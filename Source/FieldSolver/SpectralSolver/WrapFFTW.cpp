@@ -10,44 +10,62 @@
 namespace AnyFFT
 {
 #ifdef AMREX_USE_FLOAT
-    const auto VendorCreatePlanR2C3D = fftwf_plan_dft_r2c_3d;
-    const auto VendorCreatePlanC2R3D = fftwf_plan_dft_c2r_3d;
-    const auto VendorCreatePlanR2C2D = fftwf_plan_dft_r2c_2d;
-    const auto VendorCreatePlanC2R2D = fftwf_plan_dft_c2r_2d;
+    const auto VendorCreatePlanR2CMany = fftwf_plan_many_dft_r2c;
+    const auto VendorCreatePlanC2RMany = fftwf_plan_many_dft_c2r;
+    const auto VendorExecuteR2C = fftwf_execute_dft_r2c;
+    const auto VendorExecuteC2R = fftwf_execute_dft_c2r;
+    const auto VendorCreatePlanC2CMany = fftwf_plan_many_dft;
+    const auto VendorExecuteC2C = fftwf_execute_dft;
 #else
-    const auto VendorCreatePlanR2C3D = fftw_plan_dft_r2c_3d;
-    const auto VendorCreatePlanC2R3D = fftw_plan_dft_c2r_3d;
-    const auto VendorCreatePlanR2C2D = fftw_plan_dft_r2c_2d;
-    const auto VendorCreatePlanC2R2D = fftw_plan_dft_c2r_2d;
+    const auto VendorCreatePlanR2CMany = fftw_plan_many_dft_r2c;
+    const auto VendorCreatePlanC2RMany = fftw_plan_many_dft_c2r;
+    const auto VendorExecuteR2C = fftw_execute_dft_r2c;
+    const auto VendorExecuteC2R = fftw_execute_dft_c2r;
+    const auto VendorCreatePlanC2CMany = fftw_plan_many_dft;
+    const auto VendorExecuteC2C = fftw_execute_dft;
 #endif
 
+    namespace
+    {
+        /** Sizes of the R2C/C2R transforms (n, in C order) and distances between two
+         *  components of the batch in the real and in the complex array */
+        void BatchLayout (const amrex::IntVect& real_size, const int dim,
+                          int* n, int& real_dist, int& complex_dist)
+        {
+            if (dim < 1 || dim > 3) {
+                amrex::Abort("only dim=1, dim=2 and dim=3 have been implemented.");
+            }
+
+            // Swap dimensions: AMReX FAB are Fortran-order but FFTW is C-order
+            for (int idim = 0; idim < dim; ++idim) n[idim] = real_size[dim-1-idim];
+
+            // The components of the batch are contiguous, as the components of a FAB:
+            // distance between two components, in the real and in the complex array
+            real_dist = 1;
+            for (int idim = 0; idim < dim; ++idim) real_dist *= real_size[idim];
+            complex_dist = real_dist / real_size[0] * (real_size[0]/2 + 1);
+        }
+    }
+
     FFTplan CreatePlan(const amrex::IntVect& real_size, amrex::Real * const real_array,
-                       Complex * const complex_array, const direction dir, const int dim)
+                       Complex * const complex_array, const direction dir, const int dim,
+                       const int howmany)
     {
         FFTplan fft_plan;
 
+        int n[3];
+        int real_dist, complex_dist;
+        BatchLayout(real_size, dim, n, real_dist, complex_dist);
+
         // Initialize fft_plan.m_plan with the vendor fft plan.
-        // Swap dimensions: AMReX FAB are Fortran-order but FFTW is C-order
         if (dir == direction::R2C){
-            if (dim == 3) {
-                fft_plan.m_plan = VendorCreatePlanR2C3D(
-                    real_size[2], real_size[1], real_size[0], real_array, complex_array, FFTW_ESTIMATE);
-            } else if (dim == 2) {
-                fft_plan.m_plan = VendorCreatePlanR2C2D(
-                    real_size[1], real_size[0], real_array, complex_array, FFTW_ESTIMATE);
-            } else {
-                amrex::Abort("only dim=2 and dim=3 have been implemented");
-            }
+            fft_plan.m_plan = VendorCreatePlanR2CMany(
+                dim, n, howmany, real_array, nullptr, 1, real_dist,
+                complex_array, nullptr, 1, complex_dist, FFTW_ESTIMATE);
         } else if (dir == direction::C2R){
-            if (dim == 3) {
-                fft_plan.m_plan = VendorCreatePlanC2R3D(
-                    real_size[2], real_size[1], real_size[0], complex_array, real_array, FFTW_ESTIMATE);
-            } else if (dim == 2) {
-                fft_plan.m_plan = VendorCreatePlanC2R2D(
-                    real_size[1], real_size[0], complex_array, real_array, FFTW_ESTIMATE);
-            } else {
-                amrex::Abort("only dim=2 and dim=3 have been implemented. Should be easy to add dim=1.");
-            }
+            fft_plan.m_plan = VendorCreatePlanC2RMany(
+                dim, n, howmany, complex_array, nullptr, 1, complex_dist,
+                real_array, nullptr, 1, real_dist, FFTW_ESTIMATE);
         }
 
         // Store meta-data in fft_plan
@@ -55,6 +73,64 @@ namespace AnyFFT
         fft_plan.m_complex_array = complex_array;
         fft_plan.m_dir = dir;
         fft_plan.m_dim = dim;
+        fft_plan.m_howmany = howmany;
+
+        return fft_plan;
+    }
+
+#ifndef AMREX_USE_FLOAT
+    FFTplan CreatePlan(const amrex::IntVect& real_size, float * const real_array,
+                       FloatComplex * const complex_array, const direction dir, const int dim,
+                       const int howmany)
+    {
+        FFTplan fft_plan;
+
+        int n[3];
+        int real_dist, complex_dist;
+        BatchLayout(real_size, dim, n, real_dist, complex_dist);
+
+        // Initialize fft_plan.m_plan_float with the single-precision vendor fft plan.
+        if (dir == direction::R2C){
+            fft_plan.m_plan_float = fftwf_plan_many_dft_r2c(
+                dim, n, howmany, real_array, nullptr, 1, real_dist,
+                complex_array, nullptr, 1, complex_dist, FFTW_ESTIMATE);
+        } else if (dir == direction::C2R){
+            fft_plan.m_plan_float = fftwf_plan_many_dft_c2r(
+                dim, n, howmany, complex_array, nullptr, 1, complex_dist,
+                real_array, nullptr, 1, real_dist, FFTW_ESTIMATE);
+        }
+
+        // Store meta-data in fft_plan
+        fft_plan.m_single = true;
+        fft_plan.m_real_array = nullptr;
+        fft_plan.m_complex_array = nullptr;
+        fft_plan.m_real_array_float = real_array;
+        fft_plan.m_complex_array_float = complex_array;
+        fft_plan.m_dir = dir;
+        fft_plan.m_dim = dim;
+        fft_plan.m_howmany = howmany;
+
+        return fft_plan;
+    }
+#endif
+
+    FFTplan CreatePlanC2C(const int n, Complex * const complex_array, const int stride,
+                          const int dist, const int howmany, const direction dir)
+    {
+        FFTplan fft_plan;
+
+        int nn[1] = {n};
+        fft_plan.m_plan = VendorCreatePlanC2CMany(
+            1, nn, howmany, complex_array, nullptr, stride, dist,
+            complex_array, nullptr, stride, dist,
+            (dir == direction::C2C_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD, FFTW_ESTIMATE);
+
+        // Store meta-data in fft_plan
+        fft_plan.m_real_array = nullptr;
+        fft_plan.m_complex_array = complex_array;
+        fft_plan.m_dir = dir;
+        fft_plan.m_dim = 1;
+        fft_plan.m_howmany = howmany;
 
         return fft_plan;
     }
@@ -64,15 +140,37 @@ namespace AnyFFT
 #  ifdef AMREX_USE_FLOAT
         fftwf_destroy_plan( fft_plan.m_plan );
 #  else
-        fftw_destroy_plan( fft_plan.m_plan );
+        if (fft_plan.m_single) {
+            fftwf_destroy_plan( fft_plan.m_plan_float );
+        } else {
+            fftw_destroy_plan( fft_plan.m_plan );
+        }
 #  endif
     }
 
     void Execute(FFTplan& fft_plan){
-#  ifdef AMREX_USE_FLOAT
-        fftwf_execute( fft_plan.m_plan );
-#  else
-        fftw_execute( fft_plan.m_plan );
-#  endif
+        // Use the new-array execute functions, since a plan of the cache can be
+        // executed on other arrays than the ones it was created with
+        // (with the same alignment, see GetCachedPlan)
+#ifndef AMREX_USE_FLOAT
+        if (fft_plan.m_single){
+            if (fft_plan.m_dir == direction::R2C){
+                fftwf_execute_dft_r2c( fft_plan.m_plan_float, fft_plan.m_real_array_float,
+                                       fft_plan.m_complex_array_float );
+            } else {
+                fftwf_execute_dft_c2r( fft_plan.m_plan_float, fft_plan.m_complex_array_float,
+                                       fft_plan.m_real_array_float );
+            }
+            return;
+        }
+#endif
+        if (fft_plan.m_dir == direction::R2C){
+            VendorExecuteR2C( fft_plan.m_plan, fft_plan.m_real_array, fft_plan.m_complex_array );
+        } else if (fft_plan.m_dir == direction::C2R){
+            VendorExecuteC2R( fft_plan.m_plan, fft_plan.m_complex_array, fft_plan.m_real_array );
+        } else {
+            // In-place complex-to-complex FFT
+            VendorExecuteC2C( fft_plan.m_plan, fft_plan.m_complex_array, fft_plan.m_complex_array );
+        }
     }
 }
@@ -22,7 +22,8 @@ namespace AnyFFT
     }
 
     FFTplan CreatePlan (const amrex::IntVect& real_size, amrex::Real * const real_array,
-                        Complex * const complex_array, const direction dir, const int dim)
+                        Complex * const complex_array, const direction dir, const int dim,
+                        const int howmany)
     {
         FFTplan fft_plan;
 
@@ -42,7 +43,8 @@ namespace AnyFFT
                                                   rocfft_precision_double,
 #endif
                                                   dim, lengths,
-                                                  1, // number of transforms,
+                                                  howmany, // number of transforms,
+                                                  // default (contiguous) layout of the batch
                                                   nullptr);
         assert_rocfft_status("rocfft_plan_create", result);
 
@@ -51,23 +53,127 @@ namespace AnyFFT
         fft_plan.m_complex_array = complex_array;
         fft_plan.m_dir = dir;
         fft_plan.m_dim = dim;
+        fft_plan.m_howmany = howmany;
+
+        return fft_plan;
+    }
+
+#ifndef AMREX_USE_FLOAT
+    FFTplan CreatePlan (const amrex::IntVect& real_size, float * const real_array,
+                        FloatComplex * const complex_array, const direction dir, const int dim,
+                        const int howmany)
+    {
+        FFTplan fft_plan;
+
+        const std::size_t lengths[] = {AMREX_D_DECL(std::size_t(real_size[0]),
+                                                    std::size_t(real_size[1]),
+                                                    std::size_t(real_size[2]))};
+
+        // Initialize fft_plan.m_plan_float with the single-precision vendor fft plan.
+        rocfft_status result = rocfft_plan_create(&(fft_plan.m_plan_float),
+                                                  rocfft_placement_notinplace,
+                                                  (dir == direction::R2C)
+                                                      ? rocfft_transform_type_real_forward
+                                                      : rocfft_transform_type_real_inverse,
+                                                  rocfft_precision_single,
+                                                  dim, lengths,
+                                                  howmany, // number of transforms,
+                                                  // default (contiguous) layout of the batch
+                                                  nullptr);
+        assert_rocfft_status("rocfft_plan_create", result);
+
+        // Store meta-data in fft_plan
+        fft_plan.m_single = true;
+        fft_plan.m_real_array = nullptr;
+        fft_plan.m_complex_array = nullptr;
+        fft_plan.m_real_array_float = real_array;
+        fft_plan.m_complex_array_float = complex_array;
+        fft_plan.m_dir = dir;
+        fft_plan.m_dim = dim;
+        fft_plan.m_howmany = howmany;
+
+        return fft_plan;
+    }
+#endif
+
+    FFTplan CreatePlanC2C (const int n, Complex * const complex_array, const int stride,
+                           const int dist, const int howmany, const direction dir)
+    {
+        FFTplan fft_plan;
+
+        // Strided data layout of the transforms
+        rocfft_plan_description description = nullptr;
+        rocfft_status result = rocfft_plan_description_create(&description);
+        assert_rocfft_status("rocfft_plan_description_create", result);
+        const std::size_t strides[] = {std::size_t(stride)};
+        result = rocfft_plan_description_set_data_layout(description,
+                                                         rocfft_array_type_complex_interleaved,
+                                                         rocfft_array_type_complex_interleaved,
+                                                         nullptr, nullptr,
+                                                         1, strides, std::size_t(dist),
+                                                         1, strides, std::size_t(dist));
+        assert_rocfft_status("rocfft_plan_description_set_data_layout", result);
+
+        const std::size_t lengths[] = {std::size_t(n)};
+        result = rocfft_plan_create(&(fft_plan.m_plan),
+                                    rocfft_placement_inplace,
+                                    (dir == direction::C2C_FORWARD)
+                                        ? rocfft_transform_type_complex_forward
+                                        : rocfft_transform_type_complex_inverse,
+#ifdef AMREX_USE_FLOAT
+                                    rocfft_precision_single,
+#else
+                                    rocfft_precision_double,
+#endif
+                                    1, lengths,
+                                    howmany, // number of transforms,
+                                    description);
+        assert_rocfft_status("rocfft_plan_create", result);
+
+        result = rocfft_plan_description_destroy(description);
+        assert_rocfft_status("rocfft_plan_description_destroy", result);
+
+        // Store meta-data in fft_plan
+        fft_plan.m_real_array = nullptr;
+        fft_plan.m_complex_array = complex_array;
+        fft_plan.m_dir = dir;
+        fft_plan.m_dim = 1;
+        fft_plan.m_howmany = howmany;
 
         return fft_plan;
     }
 
     void DestroyPlan (FFTplan& fft_plan)
     {
+#ifndef AMREX_USE_FLOAT
+        if (fft_plan.m_single) {
+            rocfft_plan_destroy( fft_plan.m_plan_float );
+            return;
+        }
+#endif
         rocfft_plan_destroy( fft_plan.m_plan );
     }
 
     void Execute (FFTplan& fft_plan)
     {
+        // plan and arrays of the transform (single-precision plans: see CreatePlan)
+        rocfft_plan plan = fft_plan.m_plan;
+        void* real_array = fft_plan.m_real_array;
+        void* complex_array = fft_plan.m_complex_array;
+#ifndef AMREX_USE_FLOAT
+        if (fft_plan.m_single) {
+            plan = fft_plan.m_plan_float;
+            real_array = fft_plan.m_real_array_float;
+            complex_array = fft_plan.m_complex_array_float;
+        }
+#endif
+
         rocfft_execution_info execinfo = NULL;
         rocfft_status result = rocfft_execution_info_create(&execinfo);
         assert_rocfft_status("rocfft_execution_info_create", result);
 
         std::size_t buffersize = 0;
-        result = rocfft_plan_get_work_buffer_size(fft_plan.m_plan, &buffersize);
+        result = rocfft_plan_get_work_buffer_size(plan, &buffersize);
         assert_rocfft_status("rocfft_plan_get_work_buffer_size", result);
 
         void* buffer = amrex::The_Arena()->alloc(buffersize);
@@ -78,17 +184,21 @@ namespace AnyFFT
         assert_rocfft_status("rocfft_execution_info_set_stream", result);
 
         if (fft_plan.m_dir == direction::R2C) {
-            result = rocfft_execute(fft_plan.m_plan,
-                                    (void**)&(fft_plan.m_real_array), // in
-                                    (void**)&(fft_plan.m_complex_array), // out
+            result = rocfft_execute(plan,
+                                    &real_array, // in
+                                    &complex_array, // out
                                     execinfo);
         } else if (fft_plan.m_dir == direction::C2R) {
-            result = rocfft_execute(fft_plan.m_plan,
-                                    (void**)&(fft_plan.m_complex_array), // in
-                                    (void**)&(fft_plan.m_real_array), // out
+            result = rocfft_execute(plan,
+                                    &complex_array, // in
+                                    &real_array, // out
                                     execinfo);
         } else {
-            amrex::Abort("direction must be AnyFFT::direction::R2C or AnyFFT::direction::C2R");
+            // In-place complex-to-complex FFT
+            result = rocfft_execute(plan,
+                                    &complex_array, // in and out
+                                    nullptr,
+                                    execinfo);
         }
 
         assert_rocfft_status("rocfft_execute", result);
@@ -9,8 +9,18 @@ using namespace amrex;
 void
 WarpX::ApplyExternalFieldExcitationOnGrid ()
 {
+    Efield_excitation_profile.resize(finest_level+1);
+    Bfield_excitation_profile.resize(finest_level+1);
+#ifdef WARPX_MAG_LLG
+    Hfield_excitation_profile.resize(finest_level+1);
+#endif
     for (int lev = 0; lev <= finest_level; ++lev) {
-        if (E_excitation_grid_s == "parse_e_excitation_grid_function")
+        // time-independent excitations have a spatial profile parser and are applied
+        // from their cached profile, like separable ones
+        const bool E_is_separable =
+            E_excitation_grid_s == "parse_e_excitation_grid_separable_function" ||
+            (E_excitation_grid_s == "parse_e_excitation_grid_function" && Efield_xt_space_parser[0]);
+        if (E_excitation_grid_s == "parse_e_excitation_grid_function" && !E_is_separable)
         {
             ApplyExternalFieldExcitationOnGrid(Efield_fp[lev][0].get(),
                                                Efield_fp[lev][1].get(),
@@ -23,7 +33,23 @@ WarpX::ApplyExternalFieldExcitationOnGrid ()
                                                getParser(Ezfield_flag_parser),
                                                lev );
         }
-        if (B_excitation_grid_s == "parse_b_excitation_grid_function")
+        if (E_is_separable)
+        {
+            ApplySeparableFieldExcitationOnGrid({Efield_fp[lev][0].get(),
+                                                 Efield_fp[lev][1].get(),
+                                                 Efield_fp[lev][2].get()},
+                                                Efield_excitation_profile[lev],
+                                                Efield_xt_space_parser,
+                                                Efield_xt_time_parser,
+                                                getParser(Exfield_flag_parser),
+                                                getParser(Eyfield_flag_parser),
+                                                getParser(Ezfield_flag_parser),
+                                                lev );
+        }
+        const bool B_is_separable =
+            B_excitation_grid_s == "parse_b_excitation_grid_separable_function" ||
+            (B_excitation_grid_s == "parse_b_excitation_grid_function" && Bfield_xt_space_parser[0]);
+        if (B_excitation_grid_s == "parse_b_excitation_grid_function" && !B_is_separable)
         {
             ApplyExternalFieldExcitationOnGrid(Bfield_fp[lev][0].get(),
                                                Bfield_fp[lev][1].get(),
@@ -36,9 +62,25 @@ WarpX::ApplyExternalFieldExcitationOnGrid ()
                                                getParser(Bzfield_flag_parser),
                                                lev );
         }
+        if (B_is_separable)
+        {
+            ApplySeparableFieldExcitationOnGrid({Bfield_fp[lev][0].get(),
+                                                 Bfield_fp[lev][1].get(),
+                                                 Bfield_fp[lev][2].get()},
+                                                Bfield_excitation_profile[lev],
+                                                Bfield_xt_space_parser,
+                                                Bfield_xt_time_parser,
+                                                getParser(Bxfield_flag_parser),
+                                                getParser(Byfield_flag_parser),
+                                                getParser(Bzfield_flag_parser),
+                                                lev );
+        }
 
 #ifdef WARPX_MAG_LLG
-        if (H_excitation_grid_s == "parse_h_excitation_grid_function")
+        const bool H_is_separable =
+            H_excitation_grid_s == "parse_h_excitation_grid_separable_function" ||
+            (H_excitation_grid_s == "parse_h_excitation_grid_function" && Hfield_xt_space_parser[0]);
+        if (H_excitation_grid_s == "parse_h_excitation_grid_function" && !H_is_separable)
         {
             ApplyExternalFieldExcitationOnGrid(Hfield_fp[lev][0].get(),
                                                Hfield_fp[lev][1].get(),
@@ -51,6 +93,19 @@ WarpX::ApplyExternalFieldExcitationOnGrid ()
                                                getParser(Hzfield_flag_parser),
                                                lev );
         }
+        if (H_is_separable)
+        {
+            ApplySeparableFieldExcitationOnGrid({Hfield_fp[lev][0].get(),
+                                                 Hfield_fp[lev][1].get(),
+                                                 Hfield_fp[lev][2].get()},
+                                                Hfield_excitation_profile[lev],
+                                                Hfield_xt_space_parser,
+                                                Hfield_xt_time_parser,
+                                                getParser(Hxfield_flag_parser),
+                                                getParser(Hyfield_flag_parser),
+                                                getParser(Hzfield_flag_parser),
+                                                lev );
+        }
 #endif
     } // for loop over level
 }
@@ -136,3 +191,82 @@ WarpX::ApplyExternalFieldExcitationOnGrid (
     }
 
 }
+
+void
+WarpX::ApplySeparableFieldExcitationOnGrid (
+       std::array<amrex::MultiFab*, 3> const& mf,
+       std::array<std::unique_ptr<amrex::MultiFab>, 3>& profile,
+       std::array<std::unique_ptr<ParserWrapper<3> >, 3> const& space_parser,
+       std::array<std::unique_ptr<ParserWrapper<1> >, 3> const& time_parser,
+       HostDeviceParser<3> const& xflag_parser,
+       HostDeviceParser<3> const& yflag_parser,
+       HostDeviceParser<3> const& zflag_parser, const int lev )
+{
+    // This function adds the contribution from an external excitation f(x,y,z)*g(t)
+    // to the fields, with the same flags as the non-separable excitation above.
+    // The flag and f(x,y,z) only depend on space: they are evaluated once and cached
+    // in profile (components 0 and 1), and only g(t) is evaluated at each time step.
+    amrex::Real t = gett_new(lev);
+    const auto problo = Geom(lev).ProbLoArray();
+    const auto dx = Geom(lev).CellSizeArray();
+    std::array<HostDeviceParser<3>, 3> const flag_parser = {xflag_parser, yflag_parser, zflag_parser};
+
+    for (int icomp = 0; icomp < 3; ++icomp) {
+        amrex::MultiFab* const field = mf[icomp];
+
+        // (re-)evaluate the flag and the spatial profile if the grids have changed
+        bool const profile_is_valid = profile[icomp]
+            && profile[icomp]->boxArray() == field->boxArray()
+            && profile[icomp]->DistributionMap() == field->DistributionMap();
+        if (!profile_is_valid) {
+            profile[icomp] = std::make_unique<amrex::MultiFab>(field->boxArray(), field->DistributionMap(), 2, 0);
+            GpuArray<int,3> stag;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                stag[idim] = field->ixType()[idim];
+            }
+            HostDeviceParser<3> const space = getParser(space_parser[icomp]);
+            HostDeviceParser<3> const flag = flag_parser[icomp];
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+            for ( MFIter mfi(*profile[icomp], TilingIfNotGPU()); mfi.isValid(); ++mfi)
+            {
+                amrex::Array4<amrex::Real> const& prof = profile[icomp]->array(mfi);
+                const amrex::Box& tb = mfi.tilebox();
+                amrex::ParallelFor(tb,
+                    [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                        amrex::Real x, y, z;
+                        WarpXUtilAlgo::getCellCoordinates(i, j, k, stag,
+                                                          problo, dx, x, y, z);
+                        auto flag_type = flag(x,y,z);
+                        if (flag_type != 0._rt && flag_type != 1._rt && flag_type != 2._rt) {
+                            amrex::Abort("flag type for excitation must be 0, or 1, or 2!");
+                        }
+                        prof(i, j, k, 0) = flag_type;
+                        prof(i, j, k, 1) = (flag_type > 0._rt) ? space(x,y,z) : 0._rt;
+                    }
+                );
+            }
+        }
+
+        // time factor of the excitation, evaluated on the host
+        amrex::Real const time_factor = getParser(time_parser[icomp])(t);
+#ifdef _OPENMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for ( MFIter mfi(*field, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            amrex::Array4<amrex::Real> const& F = field->array(mfi);
+            amrex::Array4<amrex::Real const> const& prof = profile[icomp]->const_array(mfi);
+            const amrex::Box& tb = mfi.tilebox( field->ixType().toIntVect() );
+            amrex::ParallelFor(tb,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) {
+                    amrex::Real const flag_type = prof(i, j, k, 0);
+                    if ( flag_type > 0._rt ) {
+                        F(i, j, k) = F(i,j,k)*(flag_type-1.0_rt) + time_factor*prof(i, j, k, 1);
+                    }
+                }
+            );
+        }
+    }
+}
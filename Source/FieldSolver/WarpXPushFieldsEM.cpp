@@ -8,6 +8,7 @@
  */
 #include "WarpX.H"
 #include "Utils/WarpXConst.H"
+#include "Utils/PhaseTimer.H"
 #include "BoundaryConditions/WarpX_PML_kernels.H"
 #include "BoundaryConditions/PML_current.H"
 #include "WarpX_FDTD.H"
@@ -19,6 +20,7 @@
 #include <AMReX.H>
 #include <AMReX_Math.H>
 #include <limits>
+#include <vector>
 
 
 using namespace amrex;
@@ -51,41 +53,50 @@ namespace {
         solver.ForwardTransform(lev,
                                 *Efield[0], Idx::Ex,
                                 *Efield[1], Idx::Ey);
-#else
-        solver.ForwardTransform(lev, *Efield[0], Idx::Ex);
-        solver.ForwardTransform(lev, *Efield[1], Idx::Ey);
-#endif
         solver.ForwardTransform(lev, *Efield[2], Idx::Ez);
-#ifdef WARPX_DIM_RZ
         solver.ForwardTransform(lev,
                                 *Bfield[0], Idx::Bx,
                                 *Bfield[1], Idx::By);
-#else
-        solver.ForwardTransform(lev, *Bfield[0], Idx::Bx);
-        solver.ForwardTransform(lev, *Bfield[1], Idx::By);
-#endif
         solver.ForwardTransform(lev, *Bfield[2], Idx::Bz);
-#ifdef WARPX_DIM_RZ
         solver.ForwardTransform(lev,
                                 *current[0], Idx::Jx,
                                 *current[1], Idx::Jy);
-#else
-        solver.ForwardTransform(lev, *current[0], Idx::Jx);
-        solver.ForwardTransform(lev, *current[1], Idx::Jy);
-#endif
         solver.ForwardTransform(lev, *current[2], Idx::Jz);
 
         if (rho) {
             solver.ForwardTransform(lev, *rho, Idx::rho_old, 0);
             solver.ForwardTransform(lev, *rho, Idx::rho_new, 1);
         }
-#ifdef WARPX_DIM_RZ
+#else
+        // All the components are transformed together, in batches
+        // of at most WarpX::fft_max_batch_size components
+        std::vector<SpectralForwardComponent> forward_comps;
+        for (int idim = 0; idim < 3; ++idim) {
+            forward_comps.push_back({Efield[idim].get(), Idx::Ex+idim, 0,
+                                     Efield[idim]->ixType().toIntVect()});
+        }
+        for (int idim = 0; idim < 3; ++idim) {
+            forward_comps.push_back({Bfield[idim].get(), Idx::Bx+idim, 0,
+                                     Bfield[idim]->ixType().toIntVect()});
+        }
+        for (int idim = 0; idim < 3; ++idim) {
+            forward_comps.push_back({current[idim].get(), Idx::Jx+idim, 0,
+                                     current[idim]->ixType().toIntVect()});
+        }
+        if (rho) {
+            forward_comps.push_back({rho.get(), Idx::rho_old, 0, rho->ixType().toIntVect()});
+            forward_comps.push_back({rho.get(), Idx::rho_new, 1, rho->ixType().toIntVect()});
+        }
+        solver.ForwardTransform(lev, forward_comps);
+#endif
+        // Filter J and rho in spectral space (instead of in real space)
         if (WarpX::use_kspace_filter) {
-            solver.ApplyFilter(Idx::rho_old);
-            solver.ApplyFilter(Idx::rho_new);
+            if (rho) {
+                solver.ApplyFilter(Idx::rho_old);
+                solver.ApplyFilter(Idx::rho_new);
+            }
             solver.ApplyFilter(Idx::Jx, Idx::Jy, Idx::Jz);
         }
-#endif
         // Advance fields in spectral space
         solver.pushSpectralFields();
         // Perform backward Fourier Transform
@@ -93,31 +104,28 @@ namespace {
         solver.BackwardTransform(lev,
                                  *Efield[0], Idx::Ex,
                                  *Efield[1], Idx::Ey);
-#else
-        solver.BackwardTransform(lev, *Efield[0], Idx::Ex);
-        solver.BackwardTransform(lev, *Efield[1], Idx::Ey);
-#endif
         solver.BackwardTransform(lev, *Efield[2], Idx::Ez);
-#ifdef WARPX_DIM_RZ
         solver.BackwardTransform(lev,
                                  *Bfield[0], Idx::Bx,
                                  *Bfield[1], Idx::By);
-#else
-        solver.BackwardTransform(lev, *Bfield[0], Idx::Bx);
-        solver.BackwardTransform(lev, *Bfield[1], Idx::By);
-#endif
         solver.BackwardTransform(lev, *Bfield[2], Idx::Bz);
-
-#ifndef WARPX_DIM_RZ
+#else
+        std::vector<SpectralBackwardComponent> backward_comps;
+        for (int idim = 0; idim < 3; ++idim) {
+            backward_comps.push_back({Efield[idim].get(), Idx::Ex+idim, 0});
+        }
+        for (int idim = 0; idim < 3; ++idim) {
+            backward_comps.push_back({Bfield[idim].get(), Idx::Bx+idim, 0});
+        }
         if (WarpX::fft_do_time_averaging){
-            solver.BackwardTransform(lev, *Efield_avg[0], Idx::Ex_avg);
-            solver.BackwardTransform(lev, *Efield_avg[1], Idx::Ey_avg);
-            solver.BackwardTransform(lev, *Efield_avg[2], Idx::Ez_avg);
-
-            solver.BackwardTransform(lev, *Bfield_avg[0], Idx::Bx_avg);
-            solver.BackwardTransform(lev, *Bfield_avg[1], Idx::By_avg);
-            solver.BackwardTransform(lev, *Bfield_avg[2], Idx::Bz_avg);
+            for (int idim = 0; idim < 3; ++idim) {
+                backward_comps.push_back({Efield_avg[idim].get(), Idx::Ex_avg+idim, 0});
+            }
+            for (int idim = 0; idim < 3; ++idim) {
+                backward_comps.push_back({Bfield_avg[idim].get(), Idx::Bx_avg+idim, 0});
+            }
         }
+        solver.BackwardTransform(lev, backward_comps);
 #endif
     }
 }
@@ -145,6 +153,7 @@ WarpX::PushPSATD (amrex::Real a_dt)
 
 void
 WarpX::PushPSATD (int lev, amrex::Real /* dt */) {
+    PhaseTimer timer(TimerPhase::FieldPush);
 #ifndef WARPX_USE_PSATD
     amrex::ignore_unused(lev);
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(false,
@@ -168,28 +177,38 @@ WarpX::PushPSATD (int lev, amrex::Real /* dt */) {
 }
 
 void
-WarpX::EvolveB (amrex::Real a_dt)
+WarpX::EvolveB (amrex::Real a_dt, bool silver_mueller)
 {
     for (int lev = 0; lev <= finest_level; ++lev) {
-        EvolveB(lev, a_dt);
+        // the Silver-Mueller boundary condition only applies to level 0
+        EvolveB(lev, a_dt, silver_mueller && lev == 0);
     }
 }
 
 void
-WarpX::EvolveB (int lev, amrex::Real a_dt)
+WarpX::EvolveB (int lev, amrex::Real a_dt, bool silver_mueller)
 {
     WARPX_PROFILE("WarpX::EvolveB()");
-    EvolveB(lev, PatchType::fine, a_dt);
-    if (lev > 0)
     {
-        EvolveB(lev, PatchType::coarse, a_dt);
+        // The patches and their PML are independent: without device synchronization at the
+        // end of each MFIter loop, their boxes run concurrently on the GPU streams
+        amrex::Gpu::NoSyncRegion no_sync;
+        EvolveB(lev, PatchType::fine, a_dt, silver_mueller);
+        if (lev > 0)
+        {
+            EvolveB(lev, PatchType::coarse, a_dt);
+        }
     }
+    // the guard cells are filled from the other streams afterwards
+    amrex::Gpu::synchronize();
 }
 
 void
-WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real a_dt)
+WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real a_dt, bool silver_mueller)
 {
 
+    PhaseTimer timer(TimerPhase::FieldPush);
+
     // Evolve B field in regular cells
     if (patch_type == PatchType::fine) {
 #ifdef WARPX_MAG_LLG
@@ -199,13 +218,38 @@ WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real a_dt)
             }
         }
 #endif
-        m_fdtd_solver_fp[lev]->EvolveB( Bfield_fp[lev], Efield_fp[lev], lev, a_dt );
+        if (silver_mueller) {
+            // Silver-Mueller boundary condition with the time step of level 0, see ApplySilverMuellerBoundary
+            SilverMuellerBoundary const sm = m_fdtd_solver_fp[lev]->GetSilverMuellerBoundary(Geom(lev).Domain(), dt[0]);
+            RunWithGpuGraph({lev, 0, 2},
+                GpuGraph::MakeKey(a_dt, {Bfield_fp[lev][0].get(), Bfield_fp[lev][1].get(), Bfield_fp[lev][2].get(),
+                                         Efield_fp[lev][0].get(), Efield_fp[lev][1].get(), Efield_fp[lev][2].get()}),
+                [&] () { m_fdtd_solver_fp[lev]->EvolveB( Bfield_fp[lev], Efield_fp[lev], lev, a_dt, &sm ); });
+        } else {
+            RunWithGpuGraph({lev, 0, 0},
+                GpuGraph::MakeKey(a_dt, {Bfield_fp[lev][0].get(), Bfield_fp[lev][1].get(), Bfield_fp[lev][2].get(),
+                                         Efield_fp[lev][0].get(), Efield_fp[lev][1].get(), Efield_fp[lev][2].get()}),
+                [&] () { m_fdtd_solver_fp[lev]->EvolveB( Bfield_fp[lev], Efield_fp[lev], lev, a_dt ); });
+        }
     } else {
-        m_fdtd_solver_cp[lev]->EvolveB( Bfield_cp[lev], Efield_cp[lev], lev, a_dt );
+        RunWithGpuGraph({lev, 1, 0},
+            GpuGraph::MakeKey(a_dt, {Bfield_cp[lev][0].get(), Bfield_cp[lev][1].get(), Bfield_cp[lev][2].get(),
+                                     Efield_cp[lev][0].get(), Efield_cp[lev][1].get(), Efield_cp[lev][2].get()}),
+            [&] () { m_fdtd_solver_cp[lev]->EvolveB( Bfield_cp[lev], Efield_cp[lev], lev, a_dt ); });
     }
 
     // Evolve B field in PML cells
-    if (do_pml && pml[lev]->ok()) {
+    if (do_pml && pml[lev]->ok() && pml[lev]->IsConvolutional()) {
+        if (patch_type == PatchType::fine) {
+            m_fdtd_solver_fp[lev]->EvolveBCPML(
+                pml[lev]->GetB_fp(), pml[lev]->GetE_fp(), pml[lev]->GetCPMLMemoryB_fp(),
+                pml[lev]->GetMultiSigmaBox_fp(), a_dt);
+        } else {
+            m_fdtd_solver_cp[lev]->EvolveBCPML(
+                pml[lev]->GetB_cp(), pml[lev]->GetE_cp(), pml[lev]->GetCPMLMemoryB_cp(),
+                pml[lev]->GetMultiSigmaBox_cp(), a_dt);
+        }
+    } else if (do_pml && pml[lev]->ok()) {
         if (patch_type == PatchType::fine) {
             m_fdtd_solver_fp[lev]->EvolveBPML(
                 pml[lev]->GetB_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning);
@@ -217,6 +261,123 @@ WarpX::EvolveB (int lev, PatchType patch_type, amrex::Real a_dt)
 
 }
 
+#ifndef WARPX_MAG_LLG
+void
+WarpX::EvolveBF (amrex::Real a_dt, DtType a_dt_type, bool silver_mueller)
+{
+    for (int lev = 0; lev <= finest_level; ++lev) {
+        // the Silver-Mueller boundary condition only applies to level 0
+        EvolveBF(lev, a_dt, a_dt_type, silver_mueller && lev == 0);
+    }
+}
+
+void
+WarpX::EvolveBF (int lev, amrex::Real a_dt, DtType a_dt_type, bool silver_mueller)
+{
+    WARPX_PROFILE("WarpX::EvolveBF()");
+    {
+        // see EvolveB
+        amrex::Gpu::NoSyncRegion no_sync;
+        EvolveBF(lev, PatchType::fine, a_dt, a_dt_type, silver_mueller);
+        if (lev > 0)
+        {
+            EvolveBF(lev, PatchType::coarse, a_dt, a_dt_type);
+        }
+    }
+    amrex::Gpu::synchronize();
+}
+
+void
+WarpX::EvolveBF (int lev, PatchType patch_type, amrex::Real a_dt, DtType a_dt_type, bool silver_mueller)
+{
+    if (!do_dive_cleaning) {
+        EvolveB(lev, patch_type, a_dt, silver_mueller);
+        return;
+    }
+
+    PhaseTimer timer(TimerPhase::FieldPush);
+
+    const int rhocomp = (a_dt_type == DtType::FirstHalf) ? 0 : 1;
+    // the kernels differ with rhocomp and with the Silver-Mueller boundary condition
+    const int graph_field = 3 + rhocomp + (silver_mueller ? 2 : 0);
+
+    // Evolve B and F fields in regular cells
+    if (patch_type == PatchType::fine) {
+        SilverMuellerBoundary sm;
+        if (silver_mueller) {
+            // with the time step of level 0, see ApplySilverMuellerBoundary
+            sm = m_fdtd_solver_fp[lev]->GetSilverMuellerBoundary(Geom(lev).Domain(), dt[0]);
+        }
+        RunWithGpuGraph({lev, 0, graph_field},
+            GpuGraph::MakeKey(a_dt, {Bfield_fp[lev][0].get(), Bfield_fp[lev][1].get(), Bfield_fp[lev][2].get(),
+                                     Efield_fp[lev][0].get(), Efield_fp[lev][1].get(), Efield_fp[lev][2].get(),
+                                     F_fp[lev].get(), rho_fp[lev].get()}),
+            [&] () {
+                m_fdtd_solver_fp[lev]->EvolveBF( Bfield_fp[lev], Efield_fp[lev], F_fp[lev], rho_fp[lev],
+                                                 rhocomp, lev, a_dt, silver_mueller ? &sm : nullptr );
+            });
+    } else {
+        RunWithGpuGraph({lev, 1, graph_field},
+            GpuGraph::MakeKey(a_dt, {Bfield_cp[lev][0].get(), Bfield_cp[lev][1].get(), Bfield_cp[lev][2].get(),
+                                     Efield_cp[lev][0].get(), Efield_cp[lev][1].get(), Efield_cp[lev][2].get(),
+                                     F_cp[lev].get(), rho_cp[lev].get()}),
+            [&] () {
+                m_fdtd_solver_cp[lev]->EvolveBF( Bfield_cp[lev], Efield_cp[lev], F_cp[lev], rho_cp[lev],
+                                                 rhocomp, lev, a_dt );
+            });
+    }
+
+    // Evolve B and F fields in PML cells
+    if (do_pml && pml[lev]->ok() && pml[lev]->IsConvolutional()) {
+        if (patch_type == PatchType::fine) {
+            m_fdtd_solver_fp[lev]->EvolveBCPML(
+                pml[lev]->GetB_fp(), pml[lev]->GetE_fp(), pml[lev]->GetCPMLMemoryB_fp(),
+                pml[lev]->GetMultiSigmaBox_fp(), a_dt);
+            m_fdtd_solver_fp[lev]->EvolveFPML(
+                pml[lev]->GetF_fp(), pml[lev]->GetE_fp(), a_dt );
+        } else {
+            m_fdtd_solver_cp[lev]->EvolveBCPML(
+                pml[lev]->GetB_cp(), pml[lev]->GetE_cp(), pml[lev]->GetCPMLMemoryB_cp(),
+                pml[lev]->GetMultiSigmaBox_cp(), a_dt);
+            m_fdtd_solver_cp[lev]->EvolveFPML(
+                pml[lev]->GetF_cp(), pml[lev]->GetE_cp(), a_dt );
+        }
+    } else if (do_pml && pml[lev]->ok()) {
+        if (patch_type == PatchType::fine) {
+            m_fdtd_solver_fp[lev]->EvolveBPML(
+                pml[lev]->GetB_fp(), pml[lev]->GetE_fp(), a_dt, WarpX::do_dive_cleaning,
+                pml[lev]->GetF_fp());
+        } else {
+            m_fdtd_solver_cp[lev]->EvolveBPML(
+                pml[lev]->GetB_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning,
+                pml[lev]->GetF_cp());
+        }
+    }
+}
+
+void
+WarpX::EvolveBEFused (amrex::Real a_dt)
+{
+    WARPX_PROFILE("WarpX::EvolveBEFused()");
+    PhaseTimer timer(TimerPhase::FieldPush);
+
+    // algo.fused_fdtd = 1 is only allowed on a single level
+    int const lev = 0;
+
+    // E is updated in one guard cell, which requires the current density there. The deposition
+    // only sums the current density into the valid cells, so that its guard cells are filled here.
+    for (int idim = 0; idim < 3; ++idim) {
+        current_fp[lev][idim]->FillBoundary(IntVect(1), Geom(lev).periodicity());
+    }
+
+    if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+        m_macroscopic_properties->SetPatch(lev, PatchType::fine);
+    }
+    m_fdtd_solver_fp[lev]->EvolveBEFused( Bfield_fp[lev], Efield_fp[lev], current_fp[lev], lev, a_dt,
+                                          m_macroscopic_properties );
+}
+#endif
+
 void
 WarpX::ApplySilverMuellerBoundary (amrex::Real a_dt) {
     // Only apply to level 0
@@ -237,27 +398,58 @@ void
 WarpX::EvolveE (int lev, amrex::Real a_dt)
 {
     WARPX_PROFILE("WarpX::EvolveE()");
-    EvolveE(lev, PatchType::fine, a_dt);
-    if (lev > 0)
     {
-        EvolveE(lev, PatchType::coarse, a_dt);
+        // see EvolveB
+        amrex::Gpu::NoSyncRegion no_sync;
+        EvolveE(lev, PatchType::fine, a_dt);
+        if (lev > 0)
+        {
+            EvolveE(lev, PatchType::coarse, a_dt);
+        }
     }
+    amrex::Gpu::synchronize();
 }
 
 void
 WarpX::EvolveE (int lev, PatchType patch_type, amrex::Real a_dt)
 {
+    PhaseTimer timer(TimerPhase::FieldPush);
+
     // Evolve E field in regular cells
     if (patch_type == PatchType::fine) {
-        m_fdtd_solver_fp[lev]->EvolveE( Efield_fp[lev], Bfield_fp[lev],
-                    current_fp[lev], F_fp[lev], lev, a_dt );
+        RunWithGpuGraph({lev, 0, 1},
+            GpuGraph::MakeKey(a_dt, {Efield_fp[lev][0].get(), Efield_fp[lev][1].get(), Efield_fp[lev][2].get(),
+                                     Bfield_fp[lev][0].get(), Bfield_fp[lev][1].get(), Bfield_fp[lev][2].get(),
+                                     current_fp[lev][0].get(), current_fp[lev][1].get(), current_fp[lev][2].get(),
+                                     F_fp[lev].get()}),
+            [&] () {
+                m_fdtd_solver_fp[lev]->EvolveE( Efield_fp[lev], Bfield_fp[lev],
+                            current_fp[lev], F_fp[lev], lev, a_dt );
+            });
     } else {
-        m_fdtd_solver_cp[lev]->EvolveE( Efield_cp[lev], Bfield_cp[lev],
-                    current_cp[lev], F_cp[lev], lev, a_dt );
+        RunWithGpuGraph({lev, 1, 1},
+            GpuGraph::MakeKey(a_dt, {Efield_cp[lev][0].get(), Efield_cp[lev][1].get(), Efield_cp[lev][2].get(),
+                                     Bfield_cp[lev][0].get(), Bfield_cp[lev][1].get(), Bfield_cp[lev][2].get(),
+                                     current_cp[lev][0].get(), current_cp[lev][1].get(), current_cp[lev][2].get(),
+                                     F_cp[lev].get()}),
+            [&] () {
+                m_fdtd_solver_cp[lev]->EvolveE( Efield_cp[lev], Bfield_cp[lev],
+                            current_cp[lev], F_cp[lev], lev, a_dt );
+            });
     }
 
     // Evolve E field in PML cells
-    if (do_pml && pml[lev]->ok()) {
+    if (do_pml && pml[lev]->ok() && pml[lev]->IsConvolutional()) {
+        if (patch_type == PatchType::fine) {
+            m_fdtd_solver_fp[lev]->EvolveECPML(
+                pml[lev]->GetE_fp(), pml[lev]->GetB_fp(), pml[lev]->GetCPMLMemoryE_fp(),
+                pml[lev]->GetMultiSigmaBox_fp(), a_dt);
+        } else {
+            m_fdtd_solver_cp[lev]->EvolveECPML(
+                pml[lev]->GetE_cp(), pml[lev]->GetB_cp(), pml[lev]->GetCPMLMemoryE_cp(),
+                pml[lev]->GetMultiSigmaBox_cp(), a_dt);
+        }
+    } else if (do_pml && pml[lev]->ok()) {
         if (patch_type == PatchType::fine) {
             m_fdtd_solver_fp[lev]->EvolveEPML(
                 pml[lev]->GetE_fp(),
@@ -301,13 +493,19 @@ WarpX::EvolveF (int lev, amrex::Real a_dt, DtType a_dt_type)
 {
     if (!do_dive_cleaning) return;
 
-    EvolveF(lev, PatchType::fine, a_dt, a_dt_type);
-    if (lev > 0) EvolveF(lev, PatchType::coarse, a_dt, a_dt_type);
+    {
+        // see EvolveB
+        amrex::Gpu::NoSyncRegion no_sync;
+        EvolveF(lev, PatchType::fine, a_dt, a_dt_type);
+        if (lev > 0) EvolveF(lev, PatchType::coarse, a_dt, a_dt_type);
+    }
+    amrex::Gpu::synchronize();
 }
 
 void
 WarpX::EvolveF (int lev, PatchType patch_type, amrex::Real a_dt, DtType a_dt_type)
 {
+    PhaseTimer timer(TimerPhase::FieldPush);
     if (!do_dive_cleaning) return;
 
     WARPX_PROFILE("WarpX::EvolveF()");
@@ -348,15 +546,25 @@ void
 WarpX::MacroscopicEvolveE (int lev, amrex::Real a_dt) {
 
     WARPX_PROFILE("WarpX::MacroscopicEvolveE()");
-    MacroscopicEvolveE(lev, PatchType::fine, a_dt);
-    if (lev > 0) {
-        amrex::Abort("Macroscopic EvolveE is not implemented for lev>0, yet.");
+    {
+        // see EvolveB
+        amrex::Gpu::NoSyncRegion no_sync;
+        MacroscopicEvolveE(lev, PatchType::fine, a_dt);
+        if (lev > 0) {
+            MacroscopicEvolveE(lev, PatchType::coarse, a_dt);
+        }
     }
+    amrex::Gpu::synchronize();
 }
 
 void
 WarpX::MacroscopicEvolveE (int lev, PatchType patch_type, amrex::Real a_dt) {
 
+    PhaseTimer timer(TimerPhase::FieldPush);
+
+    // the material properties of the patch are used by the solver
+    m_macroscopic_properties->SetPatch(lev, patch_type);
+
     // Evolve E field in regular cells
     if (patch_type == PatchType::fine) {
         m_fdtd_solver_fp[lev]->MacroscopicEvolveE( Efield_fp[lev],
@@ -365,14 +573,36 @@ WarpX::MacroscopicEvolveE (int lev, PatchType patch_type, amrex::Real a_dt) {
 #else
                                                    Hfield_fp[lev],
 #endif
-                                                   current_fp[lev], a_dt,
+                                                   current_fp[lev], lev, a_dt,
                                                    m_macroscopic_properties);
     }
     else {
-        amrex::Abort("Macroscopic EvolveE is not implemented for lev > 0, yet.");
+        m_fdtd_solver_cp[lev]->MacroscopicEvolveE( Efield_cp[lev],
+#ifndef WARPX_MAG_LLG
+                                                   Bfield_cp[lev],
+#else
+                                                   Hfield_cp[lev],
+#endif
+                                                   current_cp[lev], lev, a_dt,
+                                                   m_macroscopic_properties);
     }
 
     // Evolve E field in PML cells
+#ifndef WARPX_MAG_LLG
+    if (do_pml && pml[lev]->ok() && pml[lev]->IsConvolutional()) {
+        if (patch_type == PatchType::fine) {
+            m_fdtd_solver_fp[lev]->MacroscopicEvolveECPML(
+                pml[lev]->GetE_fp(), pml[lev]->GetB_fp(), pml[lev]->GetCPMLMemoryE_fp(),
+                pml[lev]->GetMultiSigmaBox_fp(), a_dt, m_macroscopic_properties,
+                pml[lev]->Geteps_fp(), pml[lev]->Getmu_fp(), pml[lev]->Getsigma_fp() );
+        } else {
+            m_fdtd_solver_cp[lev]->MacroscopicEvolveECPML(
+                pml[lev]->GetE_cp(), pml[lev]->GetB_cp(), pml[lev]->GetCPMLMemoryE_cp(),
+                pml[lev]->GetMultiSigmaBox_cp(), a_dt, m_macroscopic_properties,
+                pml[lev]->Geteps_cp(), pml[lev]->Getmu_cp(), pml[lev]->Getsigma_cp() );
+        }
+    } else
+#endif
     if (do_pml && pml[lev]->ok()) {
         if (patch_type == PatchType::fine) {
             m_fdtd_solver_fp[lev]->MacroscopicEvolveEPML(
@@ -406,6 +636,7 @@ WarpX::MacroscopicEvolveE (int lev, PatchType patch_type, amrex::Real a_dt) {
                 pml[lev]->Getsigma_cp() );
         }
     }
+    m_macroscopic_properties->SetPatch(0, PatchType::fine);
 }
 
 #ifdef WARPX_MAG_LLG
@@ -424,20 +655,26 @@ WarpX::MacroscopicEvolveHM (int lev, amrex::Real a_dt) {
     WARPX_PROFILE("WarpX::MacroscopicEvolveHM()");
     MacroscopicEvolveHM(lev, PatchType::fine, a_dt);
     if (lev > 0) {
-        amrex::Abort("Macroscopic EvolveHM is not implemented for lev>0, yet.");
+        MacroscopicEvolveHM(lev, PatchType::coarse, a_dt);
     }
 }
 
 void
 WarpX::MacroscopicEvolveHM (int lev, PatchType patch_type, amrex::Real a_dt) {
 
+    PhaseTimer timer(TimerPhase::LLG);
+
+    // the material properties of the patch are used by the solver
+    m_macroscopic_properties->SetPatch(lev, patch_type);
+
     // Evolve H field in regular cells
     if (patch_type == PatchType::fine) {
         m_fdtd_solver_fp[lev]->MacroscopicEvolveHM( Mfield_fp[lev], Hfield_fp[lev], Bfield_fp[lev], H_biasfield_fp[lev], Efield_fp[lev],
-                                             a_dt, m_macroscopic_properties);
+                                             lev, a_dt, m_macroscopic_properties);
     }
     else {
-        amrex::Abort("Macroscopic EvolveHM is not implemented for lev > 0 yet");
+        m_fdtd_solver_cp[lev]->MacroscopicEvolveHM( Mfield_cp[lev], Hfield_cp[lev], Bfield_cp[lev], H_biasfield_cp[lev], Efield_cp[lev],
+                                             lev, a_dt, m_macroscopic_properties);
     }
 
     // Evolve H field in PML cells
@@ -450,6 +687,7 @@ WarpX::MacroscopicEvolveHM (int lev, PatchType patch_type, amrex::Real a_dt) {
                 pml[lev]->GetH_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning );
         }
     }
+    m_macroscopic_properties->SetPatch(0, PatchType::fine);
 }
 
 // define WarpX::MacroscopicEvolveHM_2nd
@@ -467,20 +705,26 @@ WarpX::MacroscopicEvolveHM_2nd (int lev, amrex::Real a_dt) {
     WARPX_PROFILE("WarpX::MacroscopicEvolveHM_2nd()");
     MacroscopicEvolveHM_2nd(lev, PatchType::fine, a_dt);
     if (lev > 0) {
-        amrex::Abort("Macroscopic EvolveHM_2nd is not implemented for lev>0, yet.");
+        MacroscopicEvolveHM_2nd(lev, PatchType::coarse, a_dt);
     }
 }
 
 void
 WarpX::MacroscopicEvolveHM_2nd (int lev, PatchType patch_type, amrex::Real a_dt) {
 
+    PhaseTimer timer(TimerPhase::LLG);
+
+    // the material properties of the patch are used by the solver
+    m_macroscopic_properties->SetPatch(lev, patch_type);
+
     // Evolve H field in regular cells
     if (patch_type == PatchType::fine) {
         m_fdtd_solver_fp[lev]->MacroscopicEvolveHM_2nd( Mfield_fp[lev], Hfield_fp[lev], Bfield_fp[lev], H_biasfield_fp[lev],  Efield_fp[lev],
-                                             a_dt, m_macroscopic_properties);
+                                             lev, a_dt, m_macroscopic_properties);
     }
     else {
-        amrex::Abort("Macroscopic EvolveHM_2nd is not implemented for lev > 0 yet");
+        m_fdtd_solver_cp[lev]->MacroscopicEvolveHM_2nd( Mfield_cp[lev], Hfield_cp[lev], Bfield_cp[lev], H_biasfield_cp[lev],  Efield_cp[lev],
+                                             lev, a_dt, m_macroscopic_properties);
     }
 
     // Evolve H field in PML cells
@@ -493,6 +737,7 @@ WarpX::MacroscopicEvolveHM_2nd (int lev, PatchType patch_type, amrex::Real a_dt)
                 pml[lev]->GetH_cp(), pml[lev]->GetE_cp(), a_dt, WarpX::do_dive_cleaning );
         }
     }
+    m_macroscopic_properties->SetPatch(0, PatchType::fine);
 }
 
 #endif
@@ -6,6 +6,7 @@
  */
 #include "WarpX.H"
 #include "Utils/WarpXConst.H"
+#include "Utils/BoxCostTimer.H"
 #include "WarpX_QED_K.H"
 #include "BoundaryConditions/WarpX_PML_kernels.H"
 #include "BoundaryConditions/PML_current.H"
@@ -94,11 +95,7 @@ WarpX::Hybrid_QED_Push (int lev, PatchType patch_type, Real a_dt)
 #endif
     for ( MFIter mfi(*Bx, TilingIfNotGPU()); mfi.isValid(); ++mfi )
     {
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = static_cast<Real>(amrex::second());
+        BoxCostTimer box_timer(cost, mfi.index());
 
         // Get boxes for E, B, and J
 
@@ -167,11 +164,6 @@ WarpX::Hybrid_QED_Push (int lev, PatchType patch_type, Real a_dt)
             }
         );
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-            wt = static_cast<Real>(amrex::second()) - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+        box_timer.stop();
     }
 }
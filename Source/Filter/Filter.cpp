@@ -7,6 +7,9 @@
  */
 #include "Filter.H"
 #include "WarpX.H"
+#include "Utils/BoxCostTimer.H"
+
+#include <algorithm>
 
 #ifdef AMREX_USE_OMP
 #   include <omp.h>
@@ -23,18 +26,24 @@ using namespace amrex;
  * \param scomp first component of srcmf on which the filter is applied
  * \param dcomp first component of dstmf on which the filter is applied
  * \param ncomp Number of components on which the filter is applied.
+ * \param cost costs of the boxes, to which the time of the filter is added (may be null)
  */
 void
-Filter::ApplyStencil (MultiFab& dstmf, const MultiFab& srcmf, int scomp, int dcomp, int ncomp)
+Filter::ApplyStencil (MultiFab& dstmf, const MultiFab& srcmf, int scomp, int dcomp, int ncomp,
+                      LayoutData<Real>* cost)
 {
     WARPX_PROFILE("Filter::ApplyStencil(MultiFab)");
     ncomp = std::min(ncomp, srcmf.nComp());
 
     for (MFIter mfi(dstmf); mfi.isValid(); ++mfi)
     {
+        BoxCostTimer box_timer(cost, mfi.index());
         const auto& src = srcmf.array(mfi);
         const auto& dst = dstmf.array(mfi);
         const Box& tbx = mfi.growntilebox();
+
+        if (DoFilterSeparable(tbx, srcmf[mfi].box(), src, dst, scomp, dcomp, ncomp)) continue;
+
         const Box& gbx = amrex::grow(tbx,stencil_length_each_dir-1);
 
         // tmpfab has enough ghost cells for the stencil
@@ -74,6 +83,9 @@ Filter::ApplyStencil (FArrayBox& dstfab, const FArrayBox& srcfab,
     ncomp = std::min(ncomp, srcfab.nComp());
     const auto& src = srcfab.array();
     const auto& dst = dstfab.array();
+
+    if (DoFilterSeparable(tbx, srcfab.box(), src, dst, scomp, dcomp, ncomp)) return;
+
     const Box& gbx = amrex::grow(tbx,stencil_length_each_dir-1);
 
     // tmpfab has enough ghost cells for the stencil
@@ -154,6 +166,130 @@ void Filter::DoFilter (const Box& tbx,
 #endif
 }
 
+/* \brief Apply stencil as three directional passes fused in one kernel
+ * (2D/3D, CUDA and HIP). Each block filters a tile of tbx: the tile and its
+ * halo are read from src into shared memory, filtered along z, then y, then
+ * x, and written to dst.
+ */
+bool Filter::DoFilterSeparable (const Box& tbx, const Box& srcbox,
+                                Array4<Real const> const& src,
+                                Array4<Real      > const& dst,
+                                int scomp, int dcomp, int ncomp)
+{
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    // tile of a block, with one thread per cell
+#if (AMREX_SPACEDIM == 3)
+    constexpr int tx = 16, ty = 4, tz = 4;
+#else
+    constexpr int tx = 32, ty = 8, tz = 1;
+#endif
+    constexpr int nthreads = tx*ty*tz;
+    // In 2D, the second direction is z: slen = {length(stencil_x), length(stencil_z), 1}
+    const int hx = slen.x-1, hy = slen.y-1, hz = slen.z-1;
+    const int ax = tx+2*hx, ay = ty+2*hy, az = tz+2*hz;
+    // tile with the halo of the stencil, and the tile after the pass along z
+    const int na = ax*ay*az;
+    const int nb = ax*ay*tz;
+    const std::size_t shared_mem_bytes = (na+nb)*sizeof(Real);
+    constexpr std::size_t max_shared_mem_bytes = 48*1024;
+    if (shared_mem_bytes > max_shared_mem_bytes) return false;
+
+    const auto lo = amrex::lbound(tbx);
+    const auto hi = amrex::ubound(tbx);
+    const auto slo = amrex::lbound(srcbox);
+    const auto shi = amrex::ubound(srcbox);
+    const auto len = amrex::length(tbx);
+    const int ntx = (len.x+tx-1)/tx, nty = (len.y+ty-1)/ty, ntz = (len.z+tz-1)/tz;
+    const int ntiles = ntx*nty*ntz;
+
+    amrex::Real const* AMREX_RESTRICT sx = stencil_x.data();
+#if (AMREX_SPACEDIM == 3)
+    amrex::Real const* AMREX_RESTRICT sy = stencil_y.data();
+    amrex::Real const* AMREX_RESTRICT sz = stencil_z.data();
+#else
+    amrex::Real const* AMREX_RESTRICT sy = stencil_z.data();
+    amrex::Real const* AMREX_RESTRICT sz = nullptr;
+#endif
+
+    amrex::launch(ntiles*ncomp, nthreads, shared_mem_bytes, Gpu::gpuStream(),
+        [=] AMREX_GPU_DEVICE () noexcept {
+            Gpu::SharedMemory<Real> gsm;
+            Real* const a = gsm.dataPtr();
+            Real* const b = a + na;
+
+            int tile = blockIdx.x;
+            const int n = tile / ntiles;
+            tile -= n*ntiles;
+            const int bz = tile / (ntx*nty);
+            tile -= bz*ntx*nty;
+            const int by = tile / ntx;
+            const int bx = tile - by*ntx;
+            // lower corner of the tile with its halo
+            const int i0 = lo.x + bx*tx - hx;
+            const int j0 = lo.y + by*ty - hy;
+            const int k0 = lo.z + bz*tz - hz;
+
+            // read the tile and its halo, zero outside src
+            for (int m = threadIdx.x; m < na; m += blockDim.x) {
+                const int c = m / (ax*ay);
+                const int r = m - c*ax*ay;
+                const int bb = r / ax;
+                const int i = i0 + r - bb*ax, j = j0 + bb, k = k0 + c;
+                const bool inside = i >= slo.x && i <= shi.x && j >= slo.y && j <= shi.y
+                                 && k >= slo.z && k <= shi.z;
+                a[m] = inside ? src(i,j,k,scomp+n) : 0._rt;
+            }
+            __syncthreads();
+
+            // pass along z, from a to b
+            for (int m = threadIdx.x; m < nb; m += blockDim.x) {
+                const int c = m / (ax*ay);
+                const int r = m - c*ax*ay;
+                Real d = 0._rt;
+                for (int iz = 0; iz <= hz; ++iz) {
+                    // in 2D, there is no stencil along the third direction
+                    const Real w = sz ? sz[iz] : 0.5_rt;
+                    d += w*(a[r + (c+hz-iz)*ax*ay] + a[r + (c+hz+iz)*ax*ay]);
+                }
+                b[m] = d;
+            }
+            __syncthreads();
+
+            // pass along y, from b to a
+            for (int m = threadIdx.x; m < ax*ty*tz; m += blockDim.x) {
+                const int c = m / (ax*ty);
+                const int r = m - c*ax*ty;
+                const int bb = r / ax;
+                const int aa = r - bb*ax;
+                Real d = 0._rt;
+                for (int iy = 0; iy <= hy; ++iy) {
+                    d += sy[iy]*(b[aa + (bb+hy-iy)*ax + c*ax*ay] + b[aa + (bb+hy+iy)*ax + c*ax*ay]);
+                }
+                a[m] = d;
+            }
+            __syncthreads();
+
+            // pass along x, from a to dst
+            const int c = threadIdx.x / (tx*ty);
+            const int r = threadIdx.x - c*tx*ty;
+            const int bb = r / tx;
+            const int aa = r - bb*tx;
+            const int i = i0 + hx + aa, j = j0 + hy + bb, k = k0 + hz + c;
+            if (i <= hi.x && j <= hi.y && k <= hi.z) {
+                Real d = 0._rt;
+                for (int ix = 0; ix <= hx; ++ix) {
+                    d += sx[ix]*(a[aa+hx-ix + bb*ax + c*ax*ty] + a[aa+hx+ix + bb*ax + c*ax*ty]);
+                }
+                dst(i,j,k,dcomp+n) = d;
+            }
+        });
+    return true;
+#else
+    amrex::ignore_unused(tbx, srcbox, src, dst, scomp, dcomp, ncomp);
+    return false;
+#endif
+}
+
 #else
 
 /* \brief Apply stencil on MultiFab (CPU version, 2D/3D).
@@ -162,9 +298,11 @@ void Filter::DoFilter (const Box& tbx,
  * \param scomp first component of srcmf on which the filter is applied
  * \param dcomp first component of dstmf on which the filter is applied
  * \param ncomp Number of components on which the filter is applied.
+ * \param cost costs of the boxes, to which the time of the filter is added (may be null)
  */
 void
-Filter::ApplyStencil (amrex::MultiFab& dstmf, const amrex::MultiFab& srcmf, int scomp, int dcomp, int ncomp)
+Filter::ApplyStencil (amrex::MultiFab& dstmf, const amrex::MultiFab& srcmf, int scomp, int dcomp, int ncomp,
+                      amrex::LayoutData<amrex::Real>* cost)
 {
     WARPX_PROFILE("Filter::ApplyStencil(MultiFab)");
     ncomp = std::min(ncomp, srcmf.nComp());
@@ -172,22 +310,14 @@ Filter::ApplyStencil (amrex::MultiFab& dstmf, const amrex::MultiFab& srcmf, int
 // never runs on GPU since in the else branch of AMREX_USE_GPU
 #pragma omp parallel
 #endif
-    {
-        FArrayBox tmpfab;
-        for (MFIter mfi(dstmf,true); mfi.isValid(); ++mfi){
-            const auto& srcfab = srcmf[mfi];
-            auto& dstfab = dstmf[mfi];
-            const Box& tbx = mfi.growntilebox();
-            const Box& gbx = amrex::grow(tbx,stencil_length_each_dir-1);
-            // tmpfab has enough ghost cells for the stencil
-            tmpfab.resize(gbx,ncomp);
-            tmpfab.setVal(0.0, gbx, 0, ncomp);
-            // Copy values in srcfab into tmpfab
-            const Box& ibx = gbx & srcfab.box();
-            tmpfab.copy(srcfab, ibx, scomp, ibx, 0, ncomp);
-            // Apply filter
-            DoFilter(tbx, tmpfab.array(), dstfab.array(), 0, dcomp, ncomp);
-        }
+    for (MFIter mfi(dstmf,true); mfi.isValid(); ++mfi){
+        BoxCostTimer box_timer(cost, mfi.index());
+        const auto& srcfab = srcmf[mfi];
+        auto& dstfab = dstmf[mfi];
+        const Box& tbx = mfi.growntilebox();
+        // Apply filter, with zeros outside srcfab
+        DoFilterSeparable(tbx, srcfab.box(), srcfab.const_array(), dstfab.array(),
+                          scomp, dcomp, ncomp);
     }
 }
 
@@ -205,16 +335,9 @@ Filter::ApplyStencil (amrex::FArrayBox& dstfab, const amrex::FArrayBox& srcfab,
 {
     WARPX_PROFILE("Filter::ApplyStencil(FArrayBox)");
     ncomp = std::min(ncomp, srcfab.nComp());
-    FArrayBox tmpfab;
-    const Box& gbx = amrex::grow(tbx,stencil_length_each_dir-1);
-    // tmpfab has enough ghost cells for the stencil
-    tmpfab.resize(gbx,ncomp);
-    tmpfab.setVal(0.0, gbx, 0, ncomp);
-    // Copy values in srcfab into tmpfab
-    const Box& ibx = gbx & srcfab.box();
-    tmpfab.copy(srcfab, ibx, scomp, ibx, 0, ncomp);
-    // Apply filter
-    DoFilter(tbx, tmpfab.array(), dstfab.array(), 0, dcomp, ncomp);
+    // Apply filter, with zeros outside srcfab
+    DoFilterSeparable(tbx, srcfab.box(), srcfab.const_array(), dstfab.array(),
+                      scomp, dcomp, ncomp);
 }
 
 void Filter::DoFilter (const Box& tbx,
@@ -277,4 +400,90 @@ void Filter::DoFilter (const Box& tbx,
     }
 }
 
+/* \brief Apply stencil as three directional passes (2D/3D, CPU). The tile
+ * is filtered one plane at a time: the pass along z (only in 3D) fills a
+ * plane of the tile with its halo, then the pass along y fills a plane
+ * without the halo in y, and the pass along x writes dst. The planes are
+ * small enough to stay in cache.
+ */
+bool Filter::DoFilterSeparable (const Box& tbx, const Box& srcbox,
+                                Array4<Real const> const& src,
+                                Array4<Real      > const& dst,
+                                int scomp, int dcomp, int ncomp)
+{
+    const auto lo = amrex::lbound(tbx);
+    const auto hi = amrex::ubound(tbx);
+    const auto slo = amrex::lbound(srcbox);
+    const auto shi = amrex::ubound(srcbox);
+    // In 2D, the second direction is z: slen = {length(stencil_x), length(stencil_z), 1}
+    const int hx = slen.x-1, hy = slen.y-1, hz = slen.z-1;
+    amrex::Real const* AMREX_RESTRICT sx = stencil_x.data();
+#if (AMREX_SPACEDIM == 3)
+    amrex::Real const* AMREX_RESTRICT sy = stencil_y.data();
+    amrex::Real const* AMREX_RESTRICT sz = stencil_z.data();
+#else
+    amrex::Real const* AMREX_RESTRICT sy = stencil_z.data();
+    // no stencil along the third direction
+    const Real sz_2d[1] = {0.5_rt};
+    amrex::Real const* AMREX_RESTRICT sz = sz_2d;
+#endif
+
+    // planes of the tile, with the halo of the stencil along x (and y for zplane)
+    const int i0 = lo.x - hx, j0 = lo.y - hy;
+    const int nxa = hi.x - lo.x + 1 + 2*hx;
+    const int nya = hi.y - lo.y + 1 + 2*hy;
+    Vector<Real> zplane(nxa*nya);
+    Vector<Real> yplane(nxa*(hi.y - lo.y + 1));
+    // part of zplane inside src
+    const int ilo = std::max(i0, slo.x), ihi = std::min(hi.x + hx, shi.x);
+    const int jlo = std::max(j0, slo.y), jhi = std::min(hi.y + hy, shi.y);
+
+    for (int n = 0; n < ncomp; ++n) {
+        for (int k = lo.z; k <= hi.z; ++k) {
+            // pass along z
+            std::fill(zplane.begin(), zplane.end(), 0._rt);
+            for (int iz = 0; iz <= hz; ++iz) {
+                for (int kk : {k-iz, k+iz}) {
+                    if (kk < slo.z || kk > shi.z) continue;
+                    for (int j = jlo; j <= jhi; ++j) {
+                        Real* AMREX_RESTRICT zrow = zplane.data() + (j-j0)*nxa - i0;
+                        AMREX_PRAGMA_SIMD
+                        for (int i = ilo; i <= ihi; ++i) {
+                            zrow[i] += sz[iz]*src(i,j,kk,scomp+n);
+                        }
+                    }
+                }
+            }
+            // pass along y
+            for (int j = lo.y; j <= hi.y; ++j) {
+                Real* AMREX_RESTRICT yrow = yplane.data() + (j-lo.y)*nxa;
+                for (int ia = 0; ia < nxa; ++ia) yrow[ia] = 0._rt;
+                for (int iy = 0; iy <= hy; ++iy) {
+                    Real const* AMREX_RESTRICT zm = zplane.data() + (j-iy-j0)*nxa;
+                    Real const* AMREX_RESTRICT zp = zplane.data() + (j+iy-j0)*nxa;
+                    AMREX_PRAGMA_SIMD
+                    for (int ia = 0; ia < nxa; ++ia) {
+                        yrow[ia] += sy[iy]*(zm[ia] + zp[ia]);
+                    }
+                }
+            }
+            // pass along x
+            for (int j = lo.y; j <= hi.y; ++j) {
+                Real const* AMREX_RESTRICT yrow = yplane.data() + (j-lo.y)*nxa - i0;
+                AMREX_PRAGMA_SIMD
+                for (int i = lo.x; i <= hi.x; ++i) {
+                    dst(i,j,k,dcomp+n) = 0._rt;
+                }
+                for (int ix = 0; ix <= hx; ++ix) {
+                    AMREX_PRAGMA_SIMD
+                    for (int i = lo.x; i <= hi.x; ++i) {
+                        dst(i,j,k,dcomp+n) += sx[ix]*(yrow[i-ix] + yrow[i+ix]);
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
 #endif // #ifdef AMREX_USE_CUDA
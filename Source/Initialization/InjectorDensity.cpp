@@ -8,6 +8,8 @@
 #include "InjectorDensity.H"
 #include "PlasmaInjector.H"
 
+#include <limits>
+
 
 using namespace amrex;
 
@@ -20,6 +22,11 @@ void InjectorDensity::clear ()
         object.parser.m_parser.clear();
         break;
     }
+    case Type::table:
+    {
+        object.table.clear();
+        break;
+    }
     case Type::custom:
     {
         object.custom.clear();
@@ -67,3 +74,55 @@ InjectorDensityPredefined::InjectorDensityPredefined (
 void InjectorDensityPredefined::clear ()
 {
 }
+
+InjectorDensityTable::InjectorDensityTable (WarpXParser const& a_parser,
+                                            amrex::Vector<amrex::Real> const& a_lo,
+                                            amrex::Vector<amrex::Real> const& a_hi,
+                                            amrex::Vector<int> const& a_size)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(a_lo.size() == 3 && a_hi.size() == 3 && a_size.size() == 3,
+        "InjectorDensityTable: the bounds and the size of the table must have 3 components");
+    for (int d = 0; d < 3; ++d) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(a_size[d] >= 1,
+            "InjectorDensityTable: the number of points must be at least 1");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(a_size[d] == 1 ||
+            (a_hi[d] > a_lo[d] && a_hi[d] < std::numeric_limits<amrex::Real>::max() &&
+             a_lo[d] > std::numeric_limits<amrex::Real>::lowest()),
+            "InjectorDensityTable: the bounds of the table must be finite, "
+            "set the species xmin, xmax, etc. or density_table_lo and density_table_hi");
+        m_lo[d] = a_lo[d];
+        m_n[d] = a_size[d];
+        m_dxi[d] = (a_size[d] > 1) ? (a_size[d]-1)/(a_hi[d]-a_lo[d]) : 0._rt;
+    }
+
+    // Tabulate the parser once, on the host
+    const int npts = m_n[0]*m_n[1]*m_n[2];
+    amrex::Vector<amrex::Real> h_table(npts);
+    GpuParser<3> parser(a_parser);
+    const amrex::Real dx = (m_n[0] > 1) ? 1._rt/m_dxi[0] : 0._rt;
+    const amrex::Real dy = (m_n[1] > 1) ? 1._rt/m_dxi[1] : 0._rt;
+    const amrex::Real dz = (m_n[2] > 1) ? 1._rt/m_dxi[2] : 0._rt;
+    // x runs fastest in the table: the rows along x are evaluated in batches
+    amrex::Vector<amrex::Real> xs(m_n[0]);
+    for (int i = 0; i < m_n[0]; ++i) xs[i] = m_lo[0]+i*dx;
+#if defined(AMREX_USE_OMP) && !defined(AMREX_USE_GPU)
+#pragma omp parallel for
+#endif
+    for (int k = 0; k < m_n[2]; ++k) {
+        for (int j = 0; j < m_n[1]; ++j) {
+            parser.eval_batch(m_n[0], &h_table[index(0,j,k)],
+                              xs.dataPtr(), m_lo[1]+j*dy, m_lo[2]+k*dz);
+        }
+    }
+    parser.clear();
+
+    m_table = static_cast<amrex::Real*>(amrex::The_Arena()->alloc(npts*sizeof(amrex::Real)));
+    amrex::Gpu::htod_memcpy(m_table, h_table.dataPtr(), npts*sizeof(amrex::Real));
+}
+
+// Note that we are not allowed to have non-trivial destructor.
+// So we rely on clear() to free memory if needed.
+void InjectorDensityTable::clear ()
+{
+    amrex::The_Arena()->free(m_table);
+}
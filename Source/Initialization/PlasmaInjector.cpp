@@ -246,10 +246,22 @@ PlasmaInjector::PlasmaInjector (int ispecies, const std::string& name)
         queryWithParser(pp_species_name, "z_shift",z_shift);
 
 #ifdef WARPX_USE_OPENPMD
-        if (ParallelDescriptor::IOProcessor()) {
+        // The series is opened on all the MPI ranks, which each load a slice
+        // of the particles in AddPlasmaFromFile
+        if (ParallelDescriptor::NProcs() > 1) {
+#if defined(AMREX_USE_MPI)
+            m_openpmd_input_series = std::make_unique<openPMD::Series>(
+                str_injection_file, openPMD::Access::READ_ONLY,
+                ParallelDescriptor::Communicator());
+#else
+            amrex::Abort("openPMD-api not built with MPI support!");
+#endif
+        } else {
             m_openpmd_input_series = std::make_unique<openPMD::Series>(
                 str_injection_file, openPMD::Access::READ_ONLY);
+        }
 
+        if (ParallelDescriptor::IOProcessor()) {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 m_openpmd_input_series->iterations.size() == 1u,
                 "External file should contain only 1 iteration\n");
@@ -393,9 +405,22 @@ void PlasmaInjector::parseDensity (ParmParse& pp)
         h_inj_rho.reset(new InjectorDensity((InjectorDensityPredefined*)nullptr,species_name));
     } else if (rho_prof_s == "parse_density_function") {
         Store_parserString(pp, "density_function(x,y,z)", str_density_function);
-        // Construct InjectorDensity with InjectorDensityParser.
-        h_inj_rho.reset(new InjectorDensity((InjectorDensityParser*)nullptr,
-                                            makeParser(str_density_function,{"x","y","z"})));
+        amrex::Vector<int> table_size;
+        if (pp.queryarr("density_table_size", table_size)) {
+            // Construct InjectorDensity with InjectorDensityTable, which tabulates
+            // the parser once on a regular grid (by default, the injection bounds).
+            amrex::Vector<amrex::Real> table_lo = {xmin, ymin, zmin};
+            amrex::Vector<amrex::Real> table_hi = {xmax, ymax, zmax};
+            pp.queryarr("density_table_lo", table_lo);
+            pp.queryarr("density_table_hi", table_hi);
+            h_inj_rho.reset(new InjectorDensity((InjectorDensityTable*)nullptr,
+                                                makeParser(str_density_function,{"x","y","z"}),
+                                                table_lo, table_hi, table_size));
+        } else {
+            // Construct InjectorDensity with InjectorDensityParser.
+            h_inj_rho.reset(new InjectorDensity((InjectorDensityParser*)nullptr,
+                                                makeParser(str_density_function,{"x","y","z"})));
+        }
     } else {
         //No need for profile definition if external file is used
         std::string s_inj_style;
@@ -6,6 +6,7 @@
  */
 
 #include "Initialization/WarpXAMReXInit.H"
+#include "Utils/MPIInitHelpers.H"
 
 #include <AMReX_ParmParse.H>
 
@@ -25,6 +26,13 @@ namespace {
         pp_amrex.query("abort_on_out_of_gpu_memory", abort_on_out_of_gpu_memory);
         pp_amrex.add("abort_on_out_of_gpu_memory", abort_on_out_of_gpu_memory);
 
+        // With GPU-aware MPI, the guard cell exchanges and the particle redistribution send
+        // their device buffers directly, instead of staging them through host memory.
+        // AMReX' default: false; here, true if the MPI library supports it
+        bool use_gpu_aware_mpi = utils::warpx_query_gpu_aware_mpi();
+        pp_amrex.query("use_gpu_aware_mpi", use_gpu_aware_mpi);
+        pp_amrex.add("use_gpu_aware_mpi", use_gpu_aware_mpi);
+
         // Work-around:
         // If warpx.numprocs is used for the domain decomposition, we will not use blocking factor
         // to generate grids. Nonetheless, AMReX has asserts in place that validate that the
@@ -12,6 +12,7 @@
 #include "Filter/BilinearFilter.H"
 #include "Filter/NCIGodfreyFilter.H"
 #include "Parser/GpuParser.H"
+#include "Python/WarpX_py.H"
 #include "Utils/WarpXUtil.H"
 #include "Utils/WarpXAlgorithmSelection.H"
 
@@ -22,10 +23,41 @@
 #   include <AMReX_AmrMeshInSituBridge.H>
 #endif
 
+#include <array>
+#include <iomanip>
 #include <memory>
+#include <string>
 
 using namespace amrex;
 
+namespace {
+    /** If none of the excitation functions f(x,y,z,t) of the three components
+     *  depends on t, define them as separable excitations f(x,y,z)*1, so that
+     *  they are evaluated once on the grid instead of at every time step
+     *  (see WarpX::ApplySeparableFieldExcitationOnGrid).
+     *
+     * \param[in] str_functions expressions of f(x,y,z,t) for each component
+     * \param[out] space_parser spatial profiles f(x,y,z), if independent of t
+     * \param[out] time_parser time factors (1), if independent of t
+     */
+    void MakeSeparableIfTimeIndependent (
+        std::array<std::string, 3> const& str_functions,
+        std::array<std::unique_ptr<ParserWrapper<3> >, 3>& space_parser,
+        std::array<std::unique_ptr<ParserWrapper<1> >, 3>& time_parser)
+    {
+        // the profile would have to follow the moving window
+        if (WarpX::do_moving_window) return;
+        for (auto const& str : str_functions) {
+            if (makeParser(str, {"x","y","z","t"}).symbols().count("t")) return;
+        }
+        for (int icomp = 0; icomp < 3; ++icomp) {
+            space_parser[icomp].reset(new ParserWrapper<3>(
+                makeParser(str_functions[icomp], {"x","y","z"})));
+            time_parser[icomp].reset(new ParserWrapper<1>(makeParser("1", {"t"})));
+        }
+    }
+}
+
 void
 WarpX::PostProcessBaseGrids (BoxArray& ba0) const
 {
@@ -71,6 +103,18 @@ WarpX::InitData ()
 #ifdef WARPX_QED
     Print() << "PICSAR (" << WarpX::PicsarVersion() << ")\n";
 #endif
+#if defined(AMREX_USE_MPI) && defined(AMREX_USE_GPU)
+    Print() << "MPI communication: "
+            << (ParallelDescriptor::UseGpuAwareMpi() ? "GPU-aware (device buffers)"
+                                                     : "staged through host memory")
+            << " (amrex.use_gpu_aware_mpi)\n";
+#endif
+
+    m_init_phase_times.clear();
+    m_init_phase_start = static_cast<Real>(amrex::second());
+
+    // native hooks of the time step (warpx.plugins)
+    LoadCallbackPlugins();
 
     if (restart_chkfile.empty())
     {
@@ -84,9 +128,11 @@ WarpX::InitData ()
             ComputeDt();
         }
         PostRestart();
+        RecordInitPhase("restart from checkpoint");
     }
 
     ComputePMLFactors();
+    RecordInitPhase("PML factors");
 
     if (WarpX::use_fdtd_nci_corr) {
         WarpX::InitNCICorrector();
@@ -97,12 +143,24 @@ WarpX::InitData ()
     }
 
     BuildBufferMasks();
+    RecordInitPhase("filters and buffer masks");
 
     if (WarpX::em_solver_medium==1) {
         m_macroscopic_properties->InitData();
+        RecordInitPhase("material properties");
+    }
+
+#if defined(WARPX_MAG_LLG) && defined(WARPX_USE_PSATD) && (AMREX_SPACEDIM == 3)
+    if (mag_magnetostatic) {
+        // H is the demagnetizing field of the initial M
+        m_mag_demag_solver = std::make_unique<MagDemagSolver>(Geom(0));
+        m_mag_demag_solver->ComputeDemagField(Mfield_fp[0], Hfield_fp[0]);
+        RecordInitPhase("demagnetizing field");
     }
+#endif
 
     InitDiagnostics();
+    RecordInitPhase("diagnostics setup");
 
     if (ParallelDescriptor::IOProcessor()) {
         std::cout << "\nGrids Summary:\n";
@@ -119,11 +177,49 @@ WarpX::InitData ()
             reduced_diags->ComputeDiags(-1);
             reduced_diags->WriteToFile(-1);
         }
+        RecordInitPhase("initial diagnostics");
     }
 
+    mypc->PrintMemoryUsage();
+
+    if (verbose) PrintInitTimes();
+
     PerformanceHints();
 }
 
+void
+WarpX::RecordInitPhase (const std::string& name)
+{
+    // the kernels launched by the phase are attributed to it
+    amrex::Gpu::streamSynchronize();
+    const auto t = static_cast<Real>(amrex::second());
+    m_init_phase_times.emplace_back(name, t - m_init_phase_start);
+    m_init_phase_start = t;
+}
+
+void
+WarpX::PrintInitTimes ()
+{
+    // one reduction over the MPI ranks for all the phases
+    const int nphases = m_init_phase_times.size();
+    Vector<Real> tmax(nphases+1, 0._rt);
+    Vector<Real> tmin(nphases+1, 0._rt);
+    for (int i = 0; i < nphases; ++i) {
+        tmax[i] = tmin[i] = m_init_phase_times[i].second;
+        tmax[nphases] += m_init_phase_times[i].second;
+    }
+    tmin[nphases] = tmax[nphases];
+    ParallelDescriptor::ReduceRealMax(tmax.dataPtr(), nphases+1, ParallelDescriptor::IOProcessorNumber());
+    ParallelDescriptor::ReduceRealMin(tmin.dataPtr(), nphases+1, ParallelDescriptor::IOProcessorNumber());
+
+    Print() << "\nInitialization time per phase (s, max / min over MPI ranks):\n";
+    for (int i = 0; i <= nphases; ++i) {
+        const std::string& name = (i < nphases) ? m_init_phase_times[i].first : "total";
+        Print() << "  " << std::left << std::setw(28) << name
+                << std::setw(14) << tmax[i] << " / " << tmin[i] << "\n";
+    }
+}
+
 void
 WarpX::InitDiagnostics () {
     multi_diags->InitData();
@@ -156,15 +252,19 @@ WarpX::InitFromScratch ()
     const Real time = 0.0;
 
     AmrCore::InitFromScratch(time);  // This will call MakeNewLevelFromScratch
+    RecordInitPhase("grids and fields");
 
     mypc->AllocData();
     mypc->InitData();
+    RecordInitPhase("particles and QED tables");
 
     // Loop through species and calculate their space-charge field
     bool const reset_fields = false; // Do not erase previous user-specified values on the grid
     ComputeSpaceChargeField(reset_fields);
+    RecordInitPhase("space-charge fields");
 
     InitPML();
+    RecordInitPhase("PML allocation");
 }
 
 void
@@ -181,28 +281,34 @@ WarpX::InitPML ()
                              pml_ncell, pml_delta, amrex::IntVect::TheZeroVector(),
                              dt[0], nox_fft, noy_fft, noz_fft, do_nodal,
                              do_dive_cleaning, do_moving_window,
-                             pml_has_particles, do_pml_in_domain,
+                             pml_has_particles, do_pml_in_domain, pml_type,
                              do_pml_Lo_corrected, do_pml_Hi);
         for (int lev = 1; lev <= finest_level; ++lev)
         {
-            amrex::IntVect do_pml_Lo_MR = amrex::IntVect::TheUnitVector();
-#ifdef WARPX_DIM_RZ
-            //In cylindrical geometry, if the edge of the patch is at r=0, do not add PML
-            if ((max_level > 0) && (fine_tag_lo[0]==0.)) {
-                do_pml_Lo_MR[0] = 0;
-            }
-#endif
-            pml[lev] = std::make_unique<PML>(lev, boxArray(lev), DistributionMap(lev),
-                                   &Geom(lev), &Geom(lev-1),
-                                   pml_ncell, pml_delta, refRatio(lev-1),
-                                   dt[lev], nox_fft, noy_fft, noz_fft, do_nodal,
-                                   do_dive_cleaning, do_moving_window,
-                                   pml_has_particles, do_pml_in_domain,
-                                   do_pml_Lo_MR, amrex::IntVect::TheUnitVector());
+            InitPMLLevel(lev);
         }
     }
 }
 
+void
+WarpX::InitPMLLevel (int lev)
+{
+    amrex::IntVect do_pml_Lo_MR = amrex::IntVect::TheUnitVector();
+#ifdef WARPX_DIM_RZ
+    //In cylindrical geometry, if the edge of the patch is at r=0, do not add PML
+    if ((max_level > 0) && (fine_tag_lo[0]==0.)) {
+        do_pml_Lo_MR[0] = 0;
+    }
+#endif
+    pml[lev] = std::make_unique<PML>(lev, boxArray(lev), DistributionMap(lev),
+                           &Geom(lev), &Geom(lev-1),
+                           pml_ncell, pml_delta, refRatio(lev-1),
+                           dt[lev], nox_fft, noy_fft, noz_fft, do_nodal,
+                           do_dive_cleaning, do_moving_window,
+                           pml_has_particles, do_pml_in_domain, pml_type,
+                           do_pml_Lo_MR, amrex::IntVect::TheUnitVector());
+}
+
 void
 WarpX::ComputePMLFactors ()
 {
@@ -303,12 +409,6 @@ WarpX::InitLevelData (int lev, Real /*time*/)
                    H_ext_grid_s.end(),
                    H_ext_grid_s.begin(),
                    ::tolower);
-
-    pp_warpx.query("H_bias_ext_grid_init_style", H_bias_ext_grid_s); // user-defined initial M
-    std::transform(H_bias_ext_grid_s.begin(),
-                   H_bias_ext_grid_s.end(),
-                   H_bias_ext_grid_s.begin(),
-                   ::tolower);
 #endif
 
     // Query for type of external space-time (xt) varying excitation
@@ -337,7 +437,8 @@ WarpX::InitLevelData (int lev, Real /*time*/)
                    H_excitation_grid_s.begin(),
                    ::tolower);
 #endif
-    if (E_excitation_grid_s == "parse_e_excitation_grid_function") {
+    if (E_excitation_grid_s == "parse_e_excitation_grid_function" ||
+        E_excitation_grid_s == "parse_e_excitation_grid_separable_function") {
         // if E excitation type is set to parser then the corresponding
         // source type (hard=1, soft=2) must be specified for all components
         // using the flag function. Note that a flag value of 0 will not update
@@ -355,7 +456,8 @@ WarpX::InitLevelData (int lev, Real /*time*/)
         Ezfield_flag_parser.reset(new ParserWrapper<3>(
                    makeParser(str_Ez_excitation_flag_function,{"x","y","z"})));
     }
-    if (B_excitation_grid_s == "parse_b_excitation_grid_function") {
+    if (B_excitation_grid_s == "parse_b_excitation_grid_function" ||
+        B_excitation_grid_s == "parse_b_excitation_grid_separable_function") {
         // if B excitation type is set to parser then the corresponding
         // source type (hard=1, soft=2) must be specified for all components
         // using the flag function. Note that a flag value of 0 will not update
@@ -375,7 +477,8 @@ WarpX::InitLevelData (int lev, Real /*time*/)
     }
 
 #ifdef WARPX_MAG_LLG
-    if (H_excitation_grid_s == "parse_h_excitation_grid_function") {
+    if (H_excitation_grid_s == "parse_h_excitation_grid_function" ||
+        H_excitation_grid_s == "parse_h_excitation_grid_separable_function") {
         // if H excitation type is set to parser then the corresponding
         // source type (hard=1, soft=2) must be specified for all components
         // using the flag function. Note that a flag value of 0 will not update
@@ -428,6 +531,10 @@ WarpX::InitLevelData (int lev, Real /*time*/)
                    makeParser(str_By_excitation_grid_function,{"x","y","z","t"})));
        Bzfield_xt_grid_parser.reset(new ParserWrapper<4>(
                    makeParser(str_Bz_excitation_grid_function,{"x","y","z","t"})));
+       MakeSeparableIfTimeIndependent({str_Bx_excitation_grid_function,
+                                        str_By_excitation_grid_function,
+                                        str_Bz_excitation_grid_function},
+                                       Bfield_xt_space_parser, Bfield_xt_time_parser);
     }
 
     // make parser for the external E-excitation in space-time
@@ -447,6 +554,50 @@ WarpX::InitLevelData (int lev, Real /*time*/)
                    makeParser(str_Ey_excitation_grid_function,{"x","y","z","t"})));
        Ezfield_xt_grid_parser.reset(new ParserWrapper<4>(
                    makeParser(str_Ez_excitation_grid_function,{"x","y","z","t"})));
+       MakeSeparableIfTimeIndependent({str_Ex_excitation_grid_function,
+                                        str_Ey_excitation_grid_function,
+                                        str_Ez_excitation_grid_function},
+                                       Efield_xt_space_parser, Efield_xt_time_parser);
+    }
+
+    // make parsers for the separable external B-excitation f(x,y,z)*g(t)
+    if (B_excitation_grid_s == "parse_b_excitation_grid_separable_function") {
+#ifdef WARPX_DIM_RZ
+       amrex::Abort("E and B parser for external fields does not work with RZ -- TO DO");
+#endif
+       const char* const dir[3] = {"x", "y", "z"};
+       for (int icomp = 0; icomp < 3; ++icomp) {
+           std::string str_space_function;
+           std::string str_time_function;
+           Store_parserString(pp_warpx, "B" + std::string(dir[icomp]) + "_excitation_grid_spatial_function(x,y,z)",
+                                                    str_space_function);
+           Store_parserString(pp_warpx, "B" + std::string(dir[icomp]) + "_excitation_grid_time_function(t)",
+                                                    str_time_function);
+           Bfield_xt_space_parser[icomp].reset(new ParserWrapper<3>(
+                   makeParser(str_space_function,{"x","y","z"})));
+           Bfield_xt_time_parser[icomp].reset(new ParserWrapper<1>(
+                   makeParser(str_time_function,{"t"})));
+       }
+    }
+
+    // make parsers for the separable external E-excitation f(x,y,z)*g(t)
+    if (E_excitation_grid_s == "parse_e_excitation_grid_separable_function") {
+#ifdef WARPX_DIM_RZ
+       amrex::Abort("E and B parser for external fields does not work with RZ -- TO DO");
+#endif
+       const char* const dir[3] = {"x", "y", "z"};
+       for (int icomp = 0; icomp < 3; ++icomp) {
+           std::string str_space_function;
+           std::string str_time_function;
+           Store_parserString(pp_warpx, "E" + std::string(dir[icomp]) + "_excitation_grid_spatial_function(x,y,z)",
+                                                    str_space_function);
+           Store_parserString(pp_warpx, "E" + std::string(dir[icomp]) + "_excitation_grid_time_function(t)",
+                                                    str_time_function);
+           Efield_xt_space_parser[icomp].reset(new ParserWrapper<3>(
+                   makeParser(str_space_function,{"x","y","z"})));
+           Efield_xt_time_parser[icomp].reset(new ParserWrapper<1>(
+                   makeParser(str_time_function,{"t"})));
+       }
     }
 
 #ifdef WARPX_MAG_LLG
@@ -467,6 +618,30 @@ WarpX::InitLevelData (int lev, Real /*time*/)
                    makeParser(str_Hy_excitation_grid_function,{"x","y","z","t"})));
        Hzfield_xt_grid_parser.reset(new ParserWrapper<4>(
                    makeParser(str_Hz_excitation_grid_function,{"x","y","z","t"})));
+       MakeSeparableIfTimeIndependent({str_Hx_excitation_grid_function,
+                                        str_Hy_excitation_grid_function,
+                                        str_Hz_excitation_grid_function},
+                                       Hfield_xt_space_parser, Hfield_xt_time_parser);
+    }
+
+    // make parsers for the separable external H-excitation f(x,y,z)*g(t)
+    if (H_excitation_grid_s == "parse_h_excitation_grid_separable_function") {
+#ifdef WARPX_DIM_RZ
+       amrex::Abort("H parser for external fields does not work with RZ -- TO DO");
+#endif
+       const char* const dir[3] = {"x", "y", "z"};
+       for (int icomp = 0; icomp < 3; ++icomp) {
+           std::string str_space_function;
+           std::string str_time_function;
+           Store_parserString(pp_warpx, "H" + std::string(dir[icomp]) + "_excitation_grid_spatial_function(x,y,z)",
+                                                    str_space_function);
+           Store_parserString(pp_warpx, "H" + std::string(dir[icomp]) + "_excitation_grid_time_function(t)",
+                                                    str_time_function);
+           Hfield_xt_space_parser[icomp].reset(new ParserWrapper<3>(
+                   makeParser(str_space_function,{"x","y","z"})));
+           Hfield_xt_time_parser[icomp].reset(new ParserWrapper<1>(
+                   makeParser(str_time_function,{"t"})));
+       }
     }
 #endif
 
@@ -476,9 +651,6 @@ WarpX::InitLevelData (int lev, Real /*time*/)
 
     if (H_ext_grid_s == "constant")
         pp_warpx.getarr("H_external_grid", H_external_grid);
-
-    if (H_bias_ext_grid_s == "constant")
-        pp_warpx.getarr("H_bias_external_grid", H_bias_external_grid);
 #endif
     // initialize the averaged fields only if the averaged algorithm
     // is activated ('psatd.do_time_averaging=1')
@@ -545,7 +717,7 @@ WarpX::InitLevelData (int lev, Real /*time*/)
             //              int        num_comp,
             //              int        nghost = 0);
 
-            int nghost = 1;
+            int nghost = amrex::min(1, Mfield_fp[lev][i]->nGrow());
             for (int icomp = 0; icomp < 3; ++icomp){ // icomp is the index of components at each i face
                 Mfield_fp[lev][i]->setVal(M_external_grid[icomp], icomp, 1, nghost);
             }
@@ -559,13 +731,6 @@ WarpX::InitLevelData (int lev, Real /*time*/)
            }
         }
 
-        if (H_bias_ext_grid_s == "constant" || H_bias_ext_grid_s == "default") {
-           H_biasfield_fp[lev][i]->setVal(H_bias_external_grid[i]);
-           if (lev > 0) {
-              H_biasfield_aux[lev][i]->setVal(H_bias_external_grid[i]);
-              H_biasfield_cp[lev][i]->setVal(H_bias_external_grid[i]);
-           }
-        }
 
 #endif
 
@@ -669,54 +834,7 @@ WarpX::InitLevelData (int lev, Real /*time*/)
     }
 
 #ifdef WARPX_MAG_LLG
-    // if the input string for the Hbias-field is "parse_h_bias_ext_grid_function",
-    // then the analytical expression or function must be
-    // provided in the input file.
-    if (H_bias_ext_grid_s == "parse_h_bias_ext_grid_function") {
-
-#ifdef WARPX_DIM_RZ
-       amrex::Abort("H bias parser for external fields does not work with RZ -- TO DO");
-#endif
-       Store_parserString(pp_warpx, "Hx_bias_external_grid_function(x,y,z)",
-                                                    str_Hx_bias_ext_grid_function);
-       Store_parserString(pp_warpx, "Hy_bias_external_grid_function(x,y,z)",
-                                                    str_Hy_bias_ext_grid_function);
-       Store_parserString(pp_warpx, "Hz_bias_external_grid_function(x,y,z)",
-                                                    str_Hz_bias_ext_grid_function);
-
-       Hx_biasfield_parser.reset(new ParserWrapper<3>(
-                                makeParser(str_Hx_bias_ext_grid_function,{"x","y","z"})));
-       Hy_biasfield_parser.reset(new ParserWrapper<3>(
-                                makeParser(str_Hy_bias_ext_grid_function,{"x","y","z"})));
-       Hz_biasfield_parser.reset(new ParserWrapper<3>(
-                                makeParser(str_Hz_bias_ext_grid_function,{"x","y","z"})));
-
-       // Initialize Efield_fp with external function
-       InitializeExternalFieldsOnGridUsingParser(H_biasfield_fp[lev][0].get(),
-                                                 H_biasfield_fp[lev][1].get(),
-                                                 H_biasfield_fp[lev][2].get(),
-                                                 getParser(Hx_biasfield_parser),
-                                                 getParser(Hy_biasfield_parser),
-                                                 getParser(Hz_biasfield_parser),
-                                                 lev);
-       if (lev > 0) {
-          InitializeExternalFieldsOnGridUsingParser(H_biasfield_aux[lev][0].get(),
-                                                    H_biasfield_aux[lev][1].get(),
-                                                    H_biasfield_aux[lev][2].get(),
-                                                    getParser(Hx_biasfield_parser),
-                                                    getParser(Hy_biasfield_parser),
-                                                    getParser(Hz_biasfield_parser),
-                                                    lev);
-
-          InitializeExternalFieldsOnGridUsingParser(H_biasfield_cp[lev][0].get(),
-                                                    H_biasfield_cp[lev][1].get(),
-                                                    H_biasfield_cp[lev][2].get(),
-                                                    getParser(Hx_biasfield_parser),
-                                                    getParser(Hy_biasfield_parser),
-                                                    getParser(Hz_biasfield_parser),
-                                                    lev);
-       }
-    }
+    InitHBiasField(lev);
 
     if (H_ext_grid_s == "parse_h_ext_grid_function") {
 
@@ -912,6 +1030,127 @@ void WarpX::AverageParsedMtoFaces(MultiFab& Mx_cc,
 }
 #endif
 
+
+#ifdef WARPX_MAG_LLG
+void
+WarpX::InitHBiasField (int lev)
+{
+    ParmParse pp_warpx("warpx");
+
+    pp_warpx.query("H_bias_ext_grid_init_style", H_bias_ext_grid_s);
+    std::transform(H_bias_ext_grid_s.begin(),
+                   H_bias_ext_grid_s.end(),
+                   H_bias_ext_grid_s.begin(),
+                   ::tolower);
+
+    if (H_bias_ext_grid_s == "constant")
+        pp_warpx.getarr("H_bias_external_grid", H_bias_external_grid);
+
+    // with warpx.mag_H_bias_on_the_fly = 1, H_bias is not stored, and is evaluated
+    // in the LLG kernels from H_bias_external_grid or from the parsers, see GetHBias
+    if (mag_H_bias_on_the_fly) {
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            H_bias_ext_grid_s == "constant" || H_bias_ext_grid_s == "default" ||
+            H_bias_ext_grid_s == "parse_h_bias_ext_grid_function",
+            "warpx.mag_H_bias_on_the_fly = 1: unknown warpx.H_bias_ext_grid_init_style " + H_bias_ext_grid_s);
+    }
+
+    if ((H_bias_ext_grid_s == "constant" || H_bias_ext_grid_s == "default") && !mag_H_bias_on_the_fly) {
+        for (int i = 0; i < 3; ++i) {
+           H_biasfield_fp[lev][i]->setVal(H_bias_external_grid[i]);
+           if (lev > 0) {
+              H_biasfield_aux[lev][i]->setVal(H_bias_external_grid[i]);
+              H_biasfield_cp[lev][i]->setVal(H_bias_external_grid[i]);
+           }
+        }
+    }
+
+    // if the input string for the Hbias-field is "parse_h_bias_ext_grid_function",
+    // then the analytical expression or function must be
+    // provided in the input file.
+    if (H_bias_ext_grid_s == "parse_h_bias_ext_grid_function") {
+
+#ifdef WARPX_DIM_RZ
+       amrex::Abort("H bias parser for external fields does not work with RZ -- TO DO");
+#endif
+       Store_parserString(pp_warpx, "Hx_bias_external_grid_function(x,y,z)",
+                                                    str_Hx_bias_ext_grid_function);
+       Store_parserString(pp_warpx, "Hy_bias_external_grid_function(x,y,z)",
+                                                    str_Hy_bias_ext_grid_function);
+       Store_parserString(pp_warpx, "Hz_bias_external_grid_function(x,y,z)",
+                                                    str_Hz_bias_ext_grid_function);
+
+       Hx_biasfield_parser.reset(new ParserWrapper<3>(
+                                makeParser(str_Hx_bias_ext_grid_function,{"x","y","z"})));
+       Hy_biasfield_parser.reset(new ParserWrapper<3>(
+                                makeParser(str_Hy_bias_ext_grid_function,{"x","y","z"})));
+       Hz_biasfield_parser.reset(new ParserWrapper<3>(
+                                makeParser(str_Hz_bias_ext_grid_function,{"x","y","z"})));
+
+       if (mag_H_bias_on_the_fly) return;
+
+       // Initialize H_biasfield_fp with external function
+       InitializeExternalFieldsOnGridUsingParser(H_biasfield_fp[lev][0].get(),
+                                                 H_biasfield_fp[lev][1].get(),
+                                                 H_biasfield_fp[lev][2].get(),
+                                                 getParser(Hx_biasfield_parser),
+                                                 getParser(Hy_biasfield_parser),
+                                                 getParser(Hz_biasfield_parser),
+                                                 lev);
+       if (lev > 0) {
+          InitializeExternalFieldsOnGridUsingParser(H_biasfield_aux[lev][0].get(),
+                                                    H_biasfield_aux[lev][1].get(),
+                                                    H_biasfield_aux[lev][2].get(),
+                                                    getParser(Hx_biasfield_parser),
+                                                    getParser(Hy_biasfield_parser),
+                                                    getParser(Hz_biasfield_parser),
+                                                    lev);
+
+          InitializeExternalFieldsOnGridUsingParser(H_biasfield_cp[lev][0].get(),
+                                                    H_biasfield_cp[lev][1].get(),
+                                                    H_biasfield_cp[lev][2].get(),
+                                                    getParser(Hx_biasfield_parser),
+                                                    getParser(Hy_biasfield_parser),
+                                                    getParser(Hz_biasfield_parser),
+                                                    lev);
+       }
+    }
+}
+
+amrex::GpuArray<HBiasComponent, 3>
+WarpX::GetHBias (std::array<std::unique_ptr<amrex::MultiFab>, 3> const& H_biasfield,
+                 int lev, amrex::MFIter const& mfi) const
+{
+    amrex::GpuArray<HBiasComponent, 3> H_bias;
+    std::array<HostDeviceParser<3>, 3> const parsers = {getParser(Hx_biasfield_parser),
+                                                        getParser(Hy_biasfield_parser),
+                                                        getParser(Hz_biasfield_parser)};
+    const auto dx_lev = geom[lev].CellSizeArray();
+    const RealBox& real_box = geom[lev].ProbDomain();
+    for (int idir = 0; idir < 3; ++idir) {
+        HBiasComponent& comp = H_bias[idir];
+        if (H_biasfield[idir]) {
+            comp.mode = HBiasComponent::Stored;
+            comp.arr = H_biasfield[idir]->const_array(mfi);
+        } else if (H_bias_ext_grid_s == "parse_h_bias_ext_grid_function") {
+            // same positions as in InitializeExternalFieldsOnGridUsingParser
+            comp.mode = HBiasComponent::Parser;
+            comp.parser = parsers[idir];
+            amrex::IntVect const nodal_flag = Hfield_fp[lev][idir]->ixType().toIntVect();
+            for (int d = 0; d < AMREX_SPACEDIM; ++d) {
+                comp.dx[d] = dx_lev[d];
+                comp.lo[d] = real_box.lo(d);
+                comp.fac[d] = (1._rt - nodal_flag[d]) * dx_lev[d] * 0.5_rt;
+            }
+        } else {
+            comp.mode = HBiasComponent::Uniform;
+            comp.value = H_bias_external_grid[idir];
+        }
+    }
+    return H_bias;
+}
+#endif
+
 void
 WarpX::InitializeExternalFieldsOnGridUsingParser (
        MultiFab *mfx, MultiFab *mfy, MultiFab *mfz,
@@ -18,9 +18,36 @@
 #include <fstream>
 #include <cstdint>
 #include <algorithm>
+#include <future>
 
 using namespace amrex;
 
+namespace
+{
+    /** \brief Read the field data of the timesteps [i_first, i_last] of a txye file.
+     * This can run on a background thread: on failure, an empty vector is returned.
+     *
+     * \param txye_file_name: name of the file
+     * \param data_offset: size in bytes of the header of the file, before the field data
+     * \param i_first, i_last: first and last timesteps to read
+     * \param time_slice_size: number of points of each timestep (nx*ny)
+     */
+    Vector<double> read_field_data (const std::string txye_file_name,
+                                    const std::streamoff data_offset,
+                                    const int i_first, const int i_last,
+                                    const int time_slice_size)
+    {
+        std::ifstream inp(txye_file_name, std::ios::binary);
+        if(!inp) return Vector<double>{};
+        inp.seekg(data_offset + static_cast<std::streamoff>(sizeof(double))*i_first*time_slice_size);
+        if(!inp) return Vector<double>{};
+        Vector<double> buf_e((i_last - i_first + 1)*time_slice_size);
+        inp.read(reinterpret_cast<char*>(buf_e.dataPtr()), buf_e.size()*sizeof(double));
+        if(!inp) return Vector<double>{};
+        return buf_e;
+    }
+}
+
 void
 WarpXLaserProfiles::FromTXYEFileLaserProfile::init (
     const amrex::ParmParse& ppl,
@@ -249,10 +276,6 @@ WarpXLaserProfiles::FromTXYEFileLaserProfile::find_left_right_time_indices(amrex
 void
 WarpXLaserProfiles::FromTXYEFileLaserProfile::read_data_t_chuck(int t_begin, int t_end)
 {
-    amrex::Print() <<
-        "Reading [" << t_begin << ", " << t_end <<
-        ") data chunk from " << m_params.txye_file_name << "\n";
-
     //Indices of the first and last timestep to read
     auto i_first = max(0, t_begin);
     auto i_last = min(t_end-1, m_params.nt-1);
@@ -261,23 +284,30 @@ WarpXLaserProfiles::FromTXYEFileLaserProfile::read_data_t_chuck(int t_begin, int
 
     Vector<Real> h_E_data(m_params.E_data.size());
 
+    const int time_slice_size = m_params.nx*m_params.ny;
+    const auto data_offset = static_cast<std::streamoff>(1 +
+        3*sizeof(uint32_t) +
+        m_params.t_coords.size()*sizeof(double) +
+        m_params.h_x_coords.size()*sizeof(double) +
+        m_params.h_y_coords.size()*sizeof(double));
+
     if(ParallelDescriptor::IOProcessor()){
-        //Read data chunk
-        std::ifstream inp(m_params.txye_file_name, std::ios::binary);
-        if(!inp) Abort("Failed to open txye file");
-        auto skip_amount = 1 +
-            3*sizeof(uint32_t) +
-            m_params.t_coords.size()*sizeof(double) +
-            m_params.h_x_coords.size()*sizeof(double) +
-            m_params.h_y_coords.size()*sizeof(double) +
-            sizeof(double)*t_begin*m_params.nx*m_params.ny;
-        inp.seekg(skip_amount);
-        if(!inp) Abort("Failed to read field data from txye file");
-        const int read_size = (i_last - i_first + 1)*
-            m_params.nx*m_params.ny;
-        Vector<double> buf_e(read_size);
-        inp.read(reinterpret_cast<char*>(buf_e.dataPtr()), read_size*sizeof(double));
-        if(!inp) Abort("Failed to read field data from txye file");
+        Vector<double> buf_e;
+        //Use the chunk read in the background, if it is the one needed
+        if(m_params.next_E_data.valid()){
+            buf_e = m_params.next_E_data.get();
+            if(m_params.next_first_time_index != i_first ||
+               m_params.next_last_time_index != i_last) buf_e.clear();
+        }
+        if(buf_e.empty()){
+            amrex::Print() <<
+                "Reading [" << t_begin << ", " << t_end <<
+                ") data chunk from " << m_params.txye_file_name << "\n";
+            buf_e = read_field_data(m_params.txye_file_name, data_offset,
+                                    i_first, i_last, time_slice_size);
+        }
+        if(static_cast<int>(buf_e.size()) != (i_last - i_first + 1)*time_slice_size)
+            Abort("Failed to read field data from txye file");
         std::transform(buf_e.begin(), buf_e.end(), h_E_data.begin(),
             [](auto x) {return static_cast<amrex::Real>(x);} );
     }
@@ -292,6 +322,23 @@ WarpXLaserProfiles::FromTXYEFileLaserProfile::read_data_t_chuck(int t_begin, int
     //Update first and last indices
     m_params.first_time_index = i_first;
     m_params.last_time_index = i_last;
+
+    //Start reading the next chunk in the background. It starts at the last
+    //timestep of this chunk, which is where update() reads the next chunk
+    //when the simulation time advances by less than one timestep of the file.
+    if(ParallelDescriptor::IOProcessor() && i_last < m_params.nt-1){
+        m_params.next_first_time_index = i_last;
+        m_params.next_last_time_index = min(
+            i_last + m_params.time_chunk_size - 1, m_params.nt-1);
+        amrex::Print() <<
+            "Prefetching [" << m_params.next_first_time_index << ", " <<
+            m_params.next_last_time_index+1 <<
+            ") data chunk from " << m_params.txye_file_name << "\n";
+        m_params.next_E_data = std::async(std::launch::async, read_field_data,
+            m_params.txye_file_name, data_offset,
+            m_params.next_first_time_index, m_params.next_last_time_index,
+            time_slice_size);
+    }
 }
 
 void
@@ -140,3 +140,68 @@ WarpXLaserProfiles::GaussianLaserProfile::fill_amplitude (
         }
         );
 }
+
+/* \brief Without spatio-temporal couplings (zeta = beta = 0), the amplitude is the
+ * real part of the product of a temporal factor and of the complex transverse envelope.
+ */
+bool
+WarpXLaserProfiles::GaussianLaserProfile::is_separable () const
+{
+    return (m_params.zeta == 0._rt) && (m_params.beta == 0._rt);
+}
+
+/* \brief compute the complex transverse envelope of the Gaussian laser at the
+ * points Xp, Yp (in laser plane coordinate)
+ */
+void
+WarpXLaserProfiles::GaussianLaserProfile::fill_transverse_factor (
+    const int np, Real const * AMREX_RESTRICT const Xp, Real const * AMREX_RESTRICT const Yp,
+    ParticleReal * AMREX_RESTRICT const transverse_re, ParticleReal * AMREX_RESTRICT const transverse_im) const
+{
+    Complex I(0,1);
+    const Real k0 = 2._rt*MathConst::pi/m_common_params.wavelength;
+    const Complex diffract_factor =
+        1._rt + I * m_params.focal_distance * 2._rt/
+        ( k0 * m_params.waist * m_params.waist );
+    const Complex inv_complex_waist_2 =
+        1._rt /(m_params.waist*m_params.waist * diffract_factor );
+
+    amrex::ParallelFor(
+        np,
+        [=] AMREX_GPU_DEVICE (int i) {
+            const Complex exp_argument = - ( Xp[i]*Xp[i] + Yp[i]*Yp[i] ) * inv_complex_waist_2;
+            const Complex transverse = amrex::exp( exp_argument );
+            transverse_re[i] = transverse.real();
+            transverse_im[i] = transverse.imag();
+        }
+        );
+}
+
+/* \brief compute the temporal factor of the Gaussian laser at time t: the same
+ * prefactor and time envelope as in fill_amplitude, with zeta = beta = 0.
+ */
+Complex
+WarpXLaserProfiles::GaussianLaserProfile::temporal_factor (Real t) const
+{
+    Complex I(0,1);
+    const Real k0 = 2._rt*MathConst::pi/m_common_params.wavelength;
+    const Real inv_tau2 = 1._rt /(m_params.duration * m_params.duration);
+    const Real oscillation_phase = k0 * PhysConst::c * ( t - m_params.t_peak ) + m_params.phi0;
+    const Complex diffract_factor =
+        1._rt + I * m_params.focal_distance * 2._rt/
+        ( k0 * m_params.waist * m_params.waist );
+    // phi2 complex envelope (zeta = beta = 0)
+    const Complex stretch_factor = 1._rt + 2._rt *I * m_params.phi2 * inv_tau2;
+
+    Complex prefactor =
+        m_common_params.e_max * amrex::exp( I * oscillation_phase );
+#if ((AMREX_SPACEDIM == 3) || (defined WARPX_DIM_RZ))
+    prefactor = prefactor / diffract_factor;
+#elif (AMREX_SPACEDIM == 2)
+    prefactor = prefactor / amrex::sqrt(diffract_factor);
+#endif
+
+    const Real dt_peak = t - m_params.t_peak;
+    const Complex stc_exponent = 1._rt / stretch_factor * inv_tau2 * dt_peak * dt_peak;
+    return prefactor * amrex::exp( - stc_exponent );
+}
@@ -83,3 +83,67 @@ WarpXLaserProfiles::HarrisLaserProfile::fill_amplitude (
         }
         );
 }
+
+/* \brief The Harris profile is always separable: its amplitude is the real part of
+ * e_max * time_envelope * exp(i omega0 t) times the complex transverse factor
+ * exp(-r^2/wz^2) * exp(-i omega0/c r^2/(2 Rz)).
+ */
+bool
+WarpXLaserProfiles::HarrisLaserProfile::is_separable () const
+{
+    return true;
+}
+
+/* \brief compute the complex transverse factor of the Harris laser at the
+ * points Xp, Yp (in laser plane coordinate)
+ */
+void
+WarpXLaserProfiles::HarrisLaserProfile::fill_transverse_factor (
+    const int np, Real const * AMREX_RESTRICT const Xp, Real const * AMREX_RESTRICT const Yp,
+    ParticleReal * AMREX_RESTRICT const transverse_re, ParticleReal * AMREX_RESTRICT const transverse_im) const
+{
+    const Real omega0 =
+        2._rt*MathConst::pi*PhysConst::c/m_common_params.wavelength;
+    const Real zR = MathConst::pi * m_params.waist*m_params.waist
+        / m_common_params.wavelength;
+    const Real wz = m_params.waist *
+        std::sqrt(1._rt + m_params.focal_distance*m_params.focal_distance/(zR*zR));
+    const Real inv_wz_2 = 1._rt/(wz*wz);
+    Real inv_Rz;
+    if (m_params.focal_distance == 0.){
+        inv_Rz = 0.;
+    } else {
+        inv_Rz = -m_params.focal_distance /
+            ( m_params.focal_distance*m_params.focal_distance + zR*zR );
+    }
+
+    amrex::ParallelFor(
+        np,
+        [=] AMREX_GPU_DEVICE (int i) {
+            const Real r2 = Xp[i]*Xp[i] + Yp[i]*Yp[i];
+            const Real space_envelope = std::exp(- r2 * inv_wz_2);
+            const Real arg_osc = omega0/PhysConst::c * r2 * inv_Rz / 2._rt;
+            transverse_re[i] = space_envelope * std::cos(arg_osc);
+            transverse_im[i] = - space_envelope * std::sin(arg_osc);
+        }
+        );
+}
+
+/* \brief compute the temporal factor of the Harris laser at time t */
+Complex
+WarpXLaserProfiles::HarrisLaserProfile::temporal_factor (Real t) const
+{
+    const Real omega0 =
+        2._rt*MathConst::pi*PhysConst::c/m_common_params.wavelength;
+    const Real arg_env = 2._rt*MathConst::pi*t/m_params.duration;
+
+    // time envelope is given by the Harris function
+    Real time_envelope = 0.;
+    if (t < m_params.duration)
+        time_envelope = 1._rt/32._rt * (10._rt - 15._rt*std::cos(arg_env) +
+                                  6._rt*std::cos(2._rt*arg_env) -
+                                  std::cos(3._rt*arg_env));
+
+    const Real magnitude = m_common_params.e_max * time_envelope;
+    return Complex{magnitude*std::cos(omega0*t), magnitude*std::sin(omega0*t)};
+}
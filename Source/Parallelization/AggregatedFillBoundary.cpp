@@ -0,0 +1,120 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "AggregatedFillBoundary.H"
+#include "CommStats.H"
+#include "PersistentExchange.H"
+
+#include <AMReX_MFIter.H>
+
+using namespace amrex;
+
+namespace
+{
+    /* \brief Copy the `ncomp` components of `src` starting at `scomp`, to `dst` starting
+     * at `dcomp`: if `to_guards`, only the `ng` guard cells of `dst` are set, otherwise
+     * only the valid cells within `ng` (+1, for nodal boxes) cells of the boundary. */
+    void CopyShell (MultiFab& dst, MultiFab const& src, int const scomp, int const dcomp,
+                    int const ncomp, IntVect const& ng, bool const to_guards)
+    {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(dst, TilingIfNotGPU()); mfi.isValid(); ++mfi) {
+            Box const& valid_bx = mfi.validbox();
+            // cells that are not copied
+            Box const skip_bx = to_guards ? valid_bx : amrex::grow(valid_bx, -(ng+1));
+            Box const bx = to_guards ? mfi.growntilebox(ng) : mfi.tilebox();
+            Array4<Real> const& dst_arr = dst.array(mfi);
+            Array4<Real const> const& src_arr = src.const_array(mfi);
+            ParallelFor(bx, ncomp, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
+            {
+                if (skip_bx.contains(IntVect(AMREX_D_DECL(i,j,k)))) return;
+                dst_arr(i,j,k,dcomp+n) = src_arr(i,j,k,scomp+n);
+            });
+        }
+    }
+
+    /* \brief Start the exchange of the `ng` guard cells of `mf`, with the persistent
+     * requests of PersistentExchange if they are enabled */
+    void StartExchange (MultiFab& mf, IntVect const& ng, Periodicity const& period)
+    {
+        if (PersistentExchange::Enabled()) PersistentExchange::FillBoundary_nowait(mf, ng, period);
+        else mf.FillBoundary_nowait(ng, period);
+    }
+
+    /* \brief Complete the exchange started by StartExchange */
+    void FinishExchange (MultiFab& mf)
+    {
+        if (PersistentExchange::Enabled()) PersistentExchange::FillBoundary_finish(mf);
+        else mf.FillBoundary_finish();
+    }
+}
+
+void
+AggregatedFillBoundary::add (MultiFab* mf, IntVect const& ng, Periodicity const& period)
+{
+    for (Group& group : m_groups) {
+        MultiFab const& mf0 = *group.mfs[0];
+        if (!group.started && group.ng == ng && group.period == period &&
+            mf0.boxArray() == mf->boxArray() && mf0.DistributionMap() == mf->DistributionMap())
+        {
+            group.mfs.push_back(mf);
+            return;
+        }
+    }
+    Group group;
+    group.mfs.push_back(mf);
+    group.ng = ng;
+    group.period = period;
+    m_groups.push_back(std::move(group));
+}
+
+void
+AggregatedFillBoundary::FillBoundary_nowait ()
+{
+    for (Group& group : m_groups) {
+        if (group.started) continue;
+        group.started = true;
+        if (group.mfs.size() == 1) {
+            CommStats::AddFillBoundary(*group.mfs[0], group.mfs[0]->nComp(), group.ng, group.period);
+            StartExchange(*group.mfs[0], group.ng, group.period);
+            continue;
+        }
+
+        int ncomp = 0;
+        for (MultiFab const* mf : group.mfs) ncomp += mf->nComp();
+        MultiFab const& mf0 = *group.mfs[0];
+        group.packed = std::make_unique<MultiFab>(mf0.boxArray(), mf0.DistributionMap(),
+                                                  ncomp, group.ng);
+        int dcomp = 0;
+        for (MultiFab const* mf : group.mfs) {
+            CopyShell(*group.packed, *mf, 0, dcomp, mf->nComp(), group.ng, false);
+            dcomp += mf->nComp();
+        }
+        CommStats::AddFillBoundary(*group.packed, ncomp, group.ng, group.period);
+        StartExchange(*group.packed, group.ng, group.period);
+    }
+}
+
+void
+AggregatedFillBoundary::FillBoundary_finish ()
+{
+    FillBoundary_nowait();
+    for (Group& group : m_groups) {
+        if (group.mfs.size() == 1) {
+            FinishExchange(*group.mfs[0]);
+            continue;
+        }
+        FinishExchange(*group.packed);
+        int scomp = 0;
+        for (MultiFab* mf : group.mfs) {
+            CopyShell(*mf, *group.packed, scomp, 0, mf->nComp(), group.ng, true);
+            scomp += mf->nComp();
+        }
+    }
+    m_groups.clear();
+}
@@ -0,0 +1,169 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "CommStats.H"
+
+#include <AMReX_BoxArray.H>
+#include <AMReX_DistributionMapping.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_Utility.H>
+
+#ifdef AMREX_USE_OMP
+#   include <omp.h>
+#endif
+
+using namespace amrex;
+
+namespace
+{
+    constexpr int num_sites = static_cast<int>(CommSite::NumSites);
+
+    bool enabled = false;
+    /** Sites being counted, innermost last */
+    Vector<int> site_stack;
+    /** Time of the last start or stop of a site */
+    Real last_time = 0._rt;
+    Vector<Long> site_calls(num_sites, 0);
+    Vector<Long> site_bytes(num_sites, 0);
+    Vector<Long> site_messages(num_sites, 0);
+    Vector<Real> site_times(num_sites, 0._rt);
+
+    Real Now ()
+    {
+        Gpu::synchronize();
+        return static_cast<Real>(amrex::second());
+    }
+
+    /** Add the time since the last start or stop of a site to the innermost site */
+    void Update (Real now)
+    {
+        if (!site_stack.empty()) site_times[site_stack.back()] += now - last_time;
+        last_time = now;
+    }
+
+    bool Counting ()
+    {
+        if (!enabled || ParallelDescriptor::NProcs() == 1) return false;
+#ifdef AMREX_USE_OMP
+        if (omp_in_parallel()) return false;
+#endif
+        return true;
+    }
+
+    /** Add the messages that `cmd` sends to the other ranks to the innermost site */
+    void AddSends (FabArrayBase::CommMetaData const& cmd, int ncomp)
+    {
+        if (!cmd.m_SndTags) return;
+        const int site = site_stack.empty() ? static_cast<int>(CommSite::Other)
+                                            : site_stack.back();
+        for (auto const& kv : *cmd.m_SndTags) {
+            Long npts = 0;
+            for (auto const& tag : kv.second) npts += tag.sbox.numPts();
+            site_bytes[site] += npts*ncomp*static_cast<Long>(sizeof(Real));
+            site_messages[site] += 1;
+        }
+    }
+}
+
+CommStats::CommStats (CommSite site)
+{
+    if (!enabled) return;
+#ifdef AMREX_USE_OMP
+    if (omp_in_parallel()) return;
+#endif
+    Update(Now());
+    site_stack.push_back(static_cast<int>(site));
+    site_calls[static_cast<int>(site)] += 1;
+    m_active = true;
+}
+
+CommStats::~CommStats ()
+{
+    if (!m_active) return;
+    Update(Now());
+    site_stack.pop_back();
+}
+
+void
+CommStats::Enable ()
+{
+    enabled = true;
+}
+
+bool
+CommStats::Enabled ()
+{
+    return enabled;
+}
+
+void
+CommStats::AddFillBoundary (FabArrayBase const& mf, int ncomp, IntVect const& ng,
+                            Periodicity const& period)
+{
+    if (!Counting() || ng == IntVect::TheZeroVector()) return;
+    AddSends(mf.getFB(ng, period), ncomp);
+}
+
+void
+CommStats::AddFillBoundary (Vector<MultiFab*> const& mf, Periodicity const& period)
+{
+    for (MultiFab const* field : mf) {
+        AddFillBoundary(*field, field->nComp(), field->nGrowVect(), period);
+    }
+}
+
+void
+CommStats::AddSumBoundary (FabArrayBase const& mf, int ncomp, IntVect const& dst_ng,
+                           Periodicity const& period)
+{
+    // FabArray::SumBoundary adds a copy of mf, with its guard cells, to mf
+    AddParallelCopy(mf, mf, ncomp, mf.nGrowVect(), dst_ng, period);
+}
+
+void
+CommStats::AddParallelCopy (FabArrayBase const& dst, FabArrayBase const& src, int ncomp,
+                            IntVect const& src_ng, IntVect const& dst_ng,
+                            Periodicity const& period)
+{
+    if (!Counting()) return;
+    // same layout and no guard cells: local copy
+    if (src_ng == IntVect::TheZeroVector() && dst_ng == IntVect::TheZeroVector() &&
+        dst.boxArray() == src.boxArray() && dst.DistributionMap() == src.DistributionMap()) return;
+    AddSends(dst.getCPC(dst_ng, src, src_ng, period), ncomp);
+}
+
+Vector<Long>
+CommStats::Calls ()
+{
+    return site_calls;
+}
+
+Vector<Long>
+CommStats::Bytes ()
+{
+    return site_bytes;
+}
+
+Vector<Long>
+CommStats::Messages ()
+{
+    return site_messages;
+}
+
+Vector<Real>
+CommStats::Times ()
+{
+    return site_times;
+}
+
+Vector<std::string>
+CommStats::Names ()
+{
+    return {"fill_E", "fill_B", "fill_F", "fill_M", "fill_H", "fill_EBF",
+            "fill_E_avg", "fill_B_avg", "fill_aux", "fill_nowait", "fill_pml",
+            "sum_J", "sum_rho", "add_J_from_fine", "add_rho_from_fine", "redistribute", "other"};
+}
@@ -31,7 +31,8 @@ guardCellManager::Init (
     const amrex::Array<amrex::Real,3> v_galilean,
     const amrex::Array<amrex::Real,3> v_comoving,
     const bool safe_guard_cells,
-    const int do_electrostatic)
+    const int do_electrostatic,
+    const int ng_fused_fdtd)
 {
     // When using subcycling, the particles on the fine level perform two pushes
     // before being redistributed ; therefore, we need one extra guard cell
@@ -91,6 +92,10 @@ guardCellManager::Init (
     ng_alloc_J = IntVect(ngJx,ngJz);
 #endif
 
+    // The fused FDTD step (algo.fused_fdtd) updates ng_fused_fdtd guard cells of E and B
+    // (fewer for B), which are all exchanged after the step
+    ng_alloc_EB = ng_alloc_EB.max(IntVect(ng_fused_fdtd));
+
     // TODO Adding one cell for rho should not be necessary, given that the number of guard cells
     // now takes into account the time step (see code block below). However, this does seem to be
     // necessary in order to avoid some remaining instances of out-of-bound array access in
@@ -160,6 +165,17 @@ guardCellManager::Init (
         ng_alloc_F = IntVect(AMREX_D_DECL(ng_alloc_F_int, ng_alloc_F_int, ng_alloc_F_int));
     }
 
+    // H and M: the Yee update of H and M, and the curl of H in the update of E, read one
+    // guard cell. They need as many guard cells as E and B with mesh refinement (to update
+    // the aux grid), with the moving window, with PSATD or in safe mode.
+    if (maxwell_solver_id != MaxwellSolverAlgo::PSATD && max_level == 0 &&
+        !do_moving_window && !safe_guard_cells) {
+        ng_alloc_H = ng_alloc_EB.min(IntVect(AMREX_D_DECL(1, 1, 1)));
+    } else {
+        ng_alloc_H = ng_alloc_EB;
+    }
+    ng_alloc_M = ng_alloc_H;
+
     // Compute number of cells required for Field Solver
     if (maxwell_solver_id == MaxwellSolverAlgo::PSATD) {
         ng_FieldSolver = ng_alloc_EB;
@@ -182,6 +198,7 @@ guardCellManager::Init (
     } else {
 
         ng_FieldSolver = ng_FieldSolver.min(ng_alloc_EB);
+        ng_FieldSolver = ng_FieldSolver.max(IntVect(ng_fused_fdtd));
 
         // Compute number of cells required for Field Gather
         int FGcell[4] = {0,1,1,2}; // Index is nox
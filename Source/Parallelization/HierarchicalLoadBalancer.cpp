@@ -0,0 +1,280 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "HierarchicalLoadBalancer.H"
+
+#include <algorithm>
+#include <numeric>
+
+using namespace amrex;
+
+namespace
+{
+    using Halo = Vector<Vector<std::pair<int,Real>>>;
+
+    /** \brief Greedy diffusion of the boxes between bins (nodes or ranks).
+     *
+     * The load of a bin, per unit of capacity, is the cost of its boxes plus
+     * halo_factor per byte of halo with the boxes of other bins. The move of a
+     * box from the most loaded bin to the least loaded bin, to its home bin or
+     * to the bin of one of its neighbours, or its swap with a cheaper box of the
+     * least loaded bin, that most decreases the load of the most loaded bin over
+     * the horizon, net of its migration cost, is done until no move pays off.
+     *
+     * \param[in] boxes boxes to balance
+     * \param[in] capacity capacity of each bin (e.g. number of ranks of a node)
+     * \param[in,out] bin bin of each box, -1 for the boxes that are not balanced here
+     * \param[in] home bin of each box before the balancing, -1 if the box is new to
+     *            these bins (its position is then free)
+     * \param[in] cost cost of each box
+     * \param[in] move_cost cost of the migration of each box away from its home
+     */
+    void Diffuse (const Vector<int>& boxes, const Vector<Real>& capacity,
+                  Vector<int>& bin, const Vector<int>& home,
+                  const Vector<Real>& cost, const Vector<Real>& move_cost,
+                  const Halo& halo, const Real halo_factor, const Real horizon)
+    {
+        const int nbins = capacity.size();
+        if (nbins < 2) return;
+
+        Vector<Real> total(nbins, 0._rt);
+        Vector<Vector<int>> bin_boxes(nbins);
+        for (int i : boxes) {
+            total[bin[i]] += cost[i];
+            for (auto const& nb : halo[i]) {
+                const int bj = bin[nb.first];
+                if (bj >= 0 && bj != bin[i]) total[bin[i]] += nb.second*halo_factor;
+            }
+            bin_boxes[bin[i]].push_back(i);
+        }
+        auto load = [&] (int b) { return total[b]/capacity[b]; };
+        auto migration = [&] (int i, int b) {
+            return (home[i] < 0 || b == home[i]) ? 0._rt : move_cost[i];
+        };
+
+        const int max_moves = 4*static_cast<int>(boxes.size());
+        for (int imove = 0; imove < max_moves; ++imove) {
+            int s = 0;
+            int dmin = 0;
+            for (int b = 1; b < nbins; ++b) {
+                if (load(b) > load(s)) s = b;
+                if (load(b) < load(dmin)) dmin = b;
+            }
+            if (s == dmin) break;
+
+            // change of the total load of bins a and b if box i moves from a to b
+            auto move_delta = [&] (int i, int a, int b, Real& da, Real& db) {
+                Real in_a = 0._rt;
+                Real in_b = 0._rt;
+                Real out = 0._rt;
+                for (auto const& nb : halo[i]) {
+                    const int bj = bin[nb.first];
+                    if (bj < 0 || nb.first == i) continue;
+                    if (bj == a) in_a += nb.second;
+                    else out += nb.second;
+                    if (bj == b) in_b += nb.second;
+                }
+                da = -cost[i] + (in_a - out)*halo_factor;
+                db = cost[i] + (in_a + out - 2._rt*in_b)*halo_factor;
+            };
+
+            Real best_gain = 0._rt;
+            int best_box = -1;
+            int best_swap = -1;
+            int best_dst = -1;
+            Real best_ds = 0._rt;
+            Real best_dd = 0._rt;
+            auto consider = [&] (int i, int j, int d, Real ds, Real dd, Real migration_delta) {
+                const Real new_max = std::max((total[s] + ds)/capacity[s],
+                                              (total[d] + dd)/capacity[d]);
+                const Real decrease = load(s) - new_max;
+                if (decrease <= 0._rt) return;
+                const Real gain = horizon*decrease - migration_delta;
+                if (gain > best_gain) {
+                    best_gain = gain;
+                    best_box = i;
+                    best_swap = j;
+                    best_dst = d;
+                    best_ds = ds;
+                    best_dd = dd;
+                }
+            };
+            Vector<int> candidates;
+            for (int i : bin_boxes[s]) {
+                // move of box i to the least loaded bin, its home or a neighbour bin
+                candidates.clear();
+                candidates.push_back(dmin);
+                if (home[i] >= 0) candidates.push_back(home[i]);
+                for (auto const& nb : halo[i]) {
+                    if (bin[nb.first] >= 0) candidates.push_back(bin[nb.first]);
+                }
+                std::sort(candidates.begin(), candidates.end());
+                candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                                 candidates.end());
+                for (int d : candidates) {
+                    if (d == s) continue;
+                    Real ds, dd;
+                    move_delta(i, s, d, ds, dd);
+                    consider(i, -1, d, ds, dd, migration(i, d) - migration(i, s));
+                }
+
+                // swap of box i with a cheaper box of the least loaded bin, when
+                // the boxes are too coarse for a single move to pay off
+                Real ds_i, dd_i;
+                move_delta(i, s, dmin, ds_i, dd_i);
+                bin[i] = dmin;
+                for (int j : bin_boxes[dmin]) {
+                    if (cost[j] >= cost[i]) continue;
+                    Real dd_j, ds_j;
+                    move_delta(j, dmin, s, dd_j, ds_j);
+                    consider(i, j, dmin, ds_i + ds_j, dd_i + dd_j,
+                             migration(i, dmin) - migration(i, s)
+                             + migration(j, s) - migration(j, dmin));
+                }
+                bin[i] = s;
+            }
+            if (best_box < 0) break;
+
+            total[s] += best_ds;
+            total[best_dst] += best_dd;
+            bin[best_box] = best_dst;
+            auto& src_boxes = bin_boxes[s];
+            auto& dst_boxes = bin_boxes[best_dst];
+            src_boxes.erase(std::find(src_boxes.begin(), src_boxes.end(), best_box));
+            dst_boxes.push_back(best_box);
+            if (best_swap >= 0) {
+                bin[best_swap] = s;
+                dst_boxes.erase(std::find(dst_boxes.begin(), dst_boxes.end(), best_swap));
+                src_boxes.push_back(best_swap);
+            }
+        }
+    }
+}
+
+HierarchicalLoadBalancer::HierarchicalLoadBalancer (Real cost_per_byte, Real intranode_factor)
+    : m_cost_per_byte(cost_per_byte), m_intranode_factor(intranode_factor)
+{}
+
+bool
+HierarchicalLoadBalancer::Balance (const Vector<int>& pmap, const Vector<int>& rank_node,
+                                   const Vector<Real>& cost, const Vector<Real>& bytes,
+                                   const Halo& halo, Real horizon, Vector<int>& new_pmap,
+                                   Real& current_efficiency, Real& proposed_efficiency) const
+{
+    const int nboxes = pmap.size();
+    const int nranks = rank_node.size();
+    const int nnodes = *std::max_element(rank_node.begin(), rank_node.end()) + 1;
+    const Real intranode_cost_per_byte = m_intranode_factor*m_cost_per_byte;
+
+    Vector<Vector<int>> node_ranks(nnodes);
+    for (int r = 0; r < nranks; ++r) node_ranks[rank_node[r]].push_back(r);
+
+    // Balance between the nodes, with the inter-node halo exchanges
+    Vector<int> all_boxes(nboxes);
+    std::iota(all_boxes.begin(), all_boxes.end(), 0);
+    Vector<int> node(nboxes);
+    for (int i = 0; i < nboxes; ++i) node[i] = rank_node[pmap[i]];
+    const Vector<int> old_node = node;
+    {
+        Vector<Real> capacity(nnodes);
+        for (int n = 0; n < nnodes; ++n) capacity[n] = node_ranks[n].size();
+        Vector<Real> move_cost(nboxes);
+        for (int i = 0; i < nboxes; ++i) move_cost[i] = bytes[i]*m_cost_per_byte;
+        Diffuse(all_boxes, capacity, node, old_node, cost, move_cost,
+                halo, m_cost_per_byte, horizon);
+    }
+
+    // Balance between the ranks of each node, with the intra-node halo exchanges
+    new_pmap.resize(nboxes);
+    for (int n = 0; n < nnodes; ++n) {
+        const Vector<int>& ranks = node_ranks[n];
+        const int nr = ranks.size();
+        Vector<int> boxes;
+        Vector<int> incoming;
+        Vector<int> rank(nboxes, -1);
+        Vector<int> home(nboxes, -1);
+        // the halo exchanges with the other nodes do not depend on the rank
+        Vector<Real> node_cost(nboxes, 0._rt);
+        Vector<Real> total(nr, 0._rt);
+        for (int i = 0; i < nboxes; ++i) {
+            if (node[i] != n) continue;
+            boxes.push_back(i);
+            node_cost[i] = cost[i];
+            for (auto const& nb : halo[i]) {
+                if (node[nb.first] != n) node_cost[i] += nb.second*m_cost_per_byte;
+            }
+            if (old_node[i] == n) {
+                home[i] = std::find(ranks.begin(), ranks.end(), pmap[i]) - ranks.begin();
+                rank[i] = home[i];
+                total[rank[i]] += node_cost[i];
+            } else {
+                incoming.push_back(i);
+            }
+        }
+        // the boxes from other nodes go to the least loaded ranks, largest first
+        std::sort(incoming.begin(), incoming.end(),
+                  [&] (int a, int b) { return node_cost[a] > node_cost[b]; });
+        for (int i : incoming) {
+            rank[i] = std::min_element(total.begin(), total.end()) - total.begin();
+            total[rank[i]] += node_cost[i];
+        }
+
+        const Vector<Real> capacity(nr, 1._rt);
+        Vector<Real> move_cost(nboxes);
+        for (int i = 0; i < nboxes; ++i) move_cost[i] = bytes[i]*intranode_cost_per_byte;
+        Diffuse(boxes, capacity, rank, home, node_cost, move_cost,
+                halo, intranode_cost_per_byte, horizon);
+
+        for (int i : boxes) new_pmap[i] = ranks[rank[i]];
+    }
+
+    // Cost/benefit of the new mapping over the horizon
+    const Vector<Real> old_times = StepTimes(pmap, rank_node, cost, halo);
+    const Vector<Real> new_times = StepTimes(new_pmap, rank_node, cost, halo);
+    const Real old_max = *std::max_element(old_times.begin(), old_times.end());
+    const Real new_max = *std::max_element(new_times.begin(), new_times.end());
+    const Real old_avg = std::accumulate(old_times.begin(), old_times.end(), 0._rt)/nranks;
+    const Real new_avg = std::accumulate(new_times.begin(), new_times.end(), 0._rt)/nranks;
+    current_efficiency = (old_max > 0._rt) ? old_avg/old_max : 1._rt;
+    proposed_efficiency = (new_max > 0._rt) ? new_avg/new_max : 1._rt;
+
+    return horizon*(old_max - new_max) > MigrationTime(pmap, new_pmap, rank_node, bytes);
+}
+
+Vector<Real>
+HierarchicalLoadBalancer::StepTimes (const Vector<int>& pmap, const Vector<int>& rank_node,
+                                     const Vector<Real>& cost, const Halo& halo) const
+{
+    Vector<Real> times(rank_node.size(), 0._rt);
+    for (int i = 0, nboxes = pmap.size(); i < nboxes; ++i) {
+        const int r = pmap[i];
+        times[r] += cost[i];
+        for (auto const& nb : halo[i]) {
+            const int rj = pmap[nb.first];
+            if (rj == r) continue;
+            const Real factor = (rank_node[rj] == rank_node[r]) ? m_intranode_factor : 1._rt;
+            times[r] += nb.second*factor*m_cost_per_byte;
+        }
+    }
+    return times;
+}
+
+Real
+HierarchicalLoadBalancer::MigrationTime (const Vector<int>& pmap, const Vector<int>& new_pmap,
+                                         const Vector<int>& rank_node,
+                                         const Vector<Real>& bytes) const
+{
+    Vector<Real> times(rank_node.size(), 0._rt);
+    for (int i = 0, nboxes = pmap.size(); i < nboxes; ++i) {
+        const int r = pmap[i];
+        const int rn = new_pmap[i];
+        if (r == rn) continue;
+        const Real factor = (rank_node[rn] == rank_node[r]) ? m_intranode_factor : 1._rt;
+        times[r] += bytes[i]*factor*m_cost_per_byte;
+        times[rn] += bytes[i]*factor*m_cost_per_byte;
+    }
+    return *std::max_element(times.begin(), times.end());
+}
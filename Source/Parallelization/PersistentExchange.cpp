@@ -0,0 +1,443 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "PersistentExchange.H"
+
+#include <AMReX.H>
+#include <AMReX_Arena.H>
+#include <AMReX_BoxList.H>
+#include <AMReX_Gpu.H>
+#include <AMReX_GpuContainers.H>
+#include <AMReX_MFIter.H>
+#include <AMReX_ParallelDescriptor.H>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <vector>
+
+using namespace amrex;
+
+namespace
+{
+    enum struct Op { Copy, Add };
+
+    /** Region `dbox` of a destination box, set from (or added to by) the region
+     *  `dbox` shifted by `shift` of a source box */
+    struct Tag
+    {
+        Box dbox;
+        IntVect shift;
+        int src = -1;     //!< local index of the source box, -1 if it is on another rank
+        int dst = -1;     //!< local index of the destination box, -1 if it is on another rank
+        Long offset = 0;  //!< first cell of the region in its buffer
+    };
+
+    /** Tag on the host, with what orders the tags of a message identically on its two ranks */
+    struct HostTag
+    {
+        Tag tag;
+        int peer;     //!< other rank of the message
+        int src_box;  //!< global indices of the boxes
+        int dst_box;
+        int ishift;   //!< index of the periodic shift
+    };
+
+    Box Shifted (Box bx, IntVect const& shift) { return bx.shift(shift); }
+
+    /** Regions of the destination box `vk` set from the source box `vj` shifted by `-shift`:
+     *  for a copy, the `ng` guard cells of `vk` (outside of `vk`) covered by `vj`; for an
+     *  addition, the cells within `ng` of `vk` covered by `vj` grown by `src_ng` */
+    BoxList Regions (Box const& vk, Box const& vj, IntVect const& shift,
+                     IntVect const& ng, IntVect const& src_ng, Op op)
+    {
+        Box const region = amrex::grow(vk, ng) & Shifted(amrex::grow(vj, src_ng), -shift);
+        if (!region.ok()) return BoxList(vk.ixType());
+        if (op == Op::Copy) return amrex::boxDiff(region, vk);
+        return BoxList(region);
+    }
+
+    /** Call f(tag, iv, icell) for the cells iv of the regions of `tags`, where icell is the
+     *  index of the cell in the buffer of the tags, in a single kernel launch */
+    template <typename F>
+    void ForEachCell (Gpu::DeviceVector<Tag> const& tags, Long const ncells, F const& f)
+    {
+        if (ncells == 0) return;
+        Tag const* p_tags = tags.dataPtr();
+        int const ntags = tags.size();
+        amrex::ParallelFor(ncells, [=] AMREX_GPU_DEVICE (Long icell) noexcept
+        {
+            // last tag whose first cell is not after icell
+            int lo = 0;
+            int hi = ntags-1;
+            while (lo < hi) {
+                int const mid = (lo+hi+1)/2;
+                if (p_tags[mid].offset <= icell) lo = mid;
+                else hi = mid-1;
+            }
+            Tag const& tag = p_tags[lo];
+            f(tag, tag.dbox.atOffset(icell - tag.offset), icell);
+        });
+    }
+
+    /** Copy the components [scomp, scomp+ncomp) of the source regions of `tags` to `buf` */
+    void Pack (Gpu::DeviceVector<Tag> const& tags, Long const ncells,
+               Array4<Real> const* arrays, int const scomp, int const ncomp, Real* buf)
+    {
+        ForEachCell(tags, ncells,
+            [=] AMREX_GPU_DEVICE (Tag const& tag, IntVect const& iv, Long icell) noexcept
+            {
+                Array4<Real> const& src = arrays[tag.src];
+                for (int n = 0; n < ncomp; ++n) buf[icell*ncomp+n] = src(iv + tag.shift, scomp+n);
+            });
+    }
+
+    /** Messages of a list of tags, sorted by peer: first cell and number of cells */
+    struct Message
+    {
+        int peer;
+        Long offset;
+        Long ncells;
+    };
+
+    /** Sort `tags`, set their offsets, and copy them to `d_tags`.
+     *  \return the messages of the tags, and the total number of cells in `ncells` */
+    Vector<Message> Finalize (Vector<HostTag>& tags, Gpu::DeviceVector<Tag>& d_tags, Long& ncells)
+    {
+        std::sort(tags.begin(), tags.end(), [] (HostTag const& a, HostTag const& b)
+        {
+            if (a.peer != b.peer) return a.peer < b.peer;
+            if (a.dst_box != b.dst_box) return a.dst_box < b.dst_box;
+            if (a.src_box != b.src_box) return a.src_box < b.src_box;
+            if (a.ishift != b.ishift) return a.ishift < b.ishift;
+            return a.tag.dbox.smallEnd().lexLT(b.tag.dbox.smallEnd());
+        });
+        Vector<Message> messages;
+        Vector<Tag> h_tags;
+        ncells = 0;
+        for (HostTag& t : tags) {
+            if (messages.empty() || messages.back().peer != t.peer) {
+                messages.push_back({t.peer, ncells, 0});
+            }
+            t.tag.offset = ncells;
+            ncells += t.tag.dbox.numPts();
+            messages.back().ncells += t.tag.dbox.numPts();
+            h_tags.push_back(t.tag);
+        }
+        d_tags.resize(h_tags.size());
+        Gpu::copy(Gpu::hostToDevice, h_tags.begin(), h_tags.end(), d_tags.begin());
+        return messages;
+    }
+
+    /** Pattern, buffers and persistent requests of the exchanges of a layout */
+    class Plan
+    {
+    public:
+        Plan (MultiFab const& mf, IntVect const& ng, IntVect const& src_ng,
+              Periodicity const& period, Op op, int ncomp);
+        ~Plan ();
+
+        Plan (Plan const&) = delete;
+        Plan& operator= (Plan const&) = delete;
+
+        /** Whether the exchange of `mf` with these parameters uses this pattern */
+        bool Matches (MultiFab const& mf, IntVect const& ng, IntVect const& src_ng,
+                      Periodicity const& period, Op op, int ncomp) const
+        {
+            return mf.boxArray().getRefID() == m_ba.getRefID() &&
+                mf.boxArray().ixType() == m_ba.ixType() &&
+                mf.DistributionMap().getRefID() == m_dm.getRefID() &&
+                ng == m_ng && src_ng == m_src_ng && period == m_period &&
+                op == m_op && ncomp == m_ncomp;
+        }
+
+        /** Start the exchange of the components [scomp, scomp+ncomp) of `mf` */
+        void Start (MultiFab& mf, int scomp);
+        /** Complete the exchange */
+        void Finish ();
+
+    private:
+        Real* Allocate (Long ncells)
+        {
+            if (ncells == 0) return nullptr;
+            return static_cast<Real*>(m_arena->alloc(ncells*m_ncomp*sizeof(Real)));
+        }
+
+        // the BoxArray and DistributionMapping are kept, so that their references are not reused
+        BoxArray m_ba;
+        DistributionMapping m_dm;
+        IntVect m_ng;
+        IntVect m_src_ng;
+        Periodicity m_period;
+        Op m_op;
+        int m_ncomp;
+
+        Gpu::DeviceVector<Tag> m_send_tags, m_recv_tags, m_local_tags;
+        Long m_send_cells = 0, m_recv_cells = 0, m_local_cells = 0;
+        Arena* m_arena = nullptr;
+        Real* m_send_buf = nullptr;
+        Real* m_recv_buf = nullptr;
+        Real* m_local_buf = nullptr;
+#ifdef AMREX_USE_MPI
+        Vector<MPI_Request> m_send_reqs, m_recv_reqs;
+#endif
+        //! arrays of the local boxes of the MultiFab being exchanged
+        Gpu::PinnedVector<Array4<Real>> m_h_arrays;
+        Gpu::DeviceVector<Array4<Real>> m_d_arrays;
+        int m_scomp = 0;
+        //! the exchange was started and not finished
+        bool m_in_flight = false;
+    };
+
+    Plan::Plan (MultiFab const& mf, IntVect const& ng, IntVect const& src_ng,
+                Periodicity const& period, Op op, int ncomp)
+        : m_ba(mf.boxArray()), m_dm(mf.DistributionMap()), m_ng(ng), m_src_ng(src_ng),
+          m_period(period), m_op(op), m_ncomp(ncomp)
+    {
+        int const myproc = ParallelDescriptor::MyProc();
+        std::vector<IntVect> const shifts = period.shiftIntVect();
+        int const nshifts = shifts.size();
+        Vector<HostTag> sends, recvs, locals;
+
+        // regions received by the local boxes k
+        for (int k : mf.IndexArray()) {
+            Box const vk = m_ba[k];
+            for (int is = 0; is < nshifts; ++is) {
+                IntVect const& s = shifts[is];
+                Box const search = amrex::grow(Shifted(amrex::grow(vk, ng), s), src_ng);
+                for (auto const& isect : m_ba.intersections(search)) {
+                    int const j = isect.first;
+                    if (j == k && s == IntVect::TheZeroVector()) continue;
+                    for (Box const& region : Regions(vk, m_ba[j], s, ng, src_ng, op)) {
+                        HostTag t{Tag{region, s, -1, mf.localindex(k), 0}, m_dm[j], j, k, is};
+                        if (m_dm[j] == myproc) {
+                            t.tag.src = mf.localindex(j);
+                            locals.push_back(t);
+                        } else {
+                            recvs.push_back(t);
+                        }
+                    }
+                }
+            }
+        }
+        // regions sent by the local boxes j to the boxes k of the other ranks
+        for (int j : mf.IndexArray()) {
+            Box const vj = m_ba[j];
+            for (int is = 0; is < nshifts; ++is) {
+                IntVect const& s = shifts[is];
+                Box const search = amrex::grow(Shifted(amrex::grow(vj, src_ng), -s), ng);
+                for (auto const& isect : m_ba.intersections(search)) {
+                    int const k = isect.first;
+                    if (m_dm[k] == myproc) continue;
+                    for (Box const& region : Regions(m_ba[k], vj, s, ng, src_ng, op)) {
+                        sends.push_back(HostTag{Tag{region, s, mf.localindex(j), -1, 0},
+                                                m_dm[k], j, k, is});
+                    }
+                }
+            }
+        }
+
+        Vector<Message> const send_msgs = Finalize(sends, m_send_tags, m_send_cells);
+        Vector<Message> const recv_msgs = Finalize(recvs, m_recv_tags, m_recv_cells);
+        Finalize(locals, m_local_tags, m_local_cells);
+
+        m_arena = ParallelDescriptor::UseGpuAwareMpi() ? The_Arena() : The_Pinned_Arena();
+        m_send_buf = Allocate(m_send_cells);
+        m_recv_buf = Allocate(m_recv_cells);
+        if (op == Op::Add && m_local_cells > 0) {
+            m_local_buf = static_cast<Real*>(The_Arena()->alloc(m_local_cells*ncomp*sizeof(Real)));
+        }
+
+        m_h_arrays.resize(mf.local_size());
+        m_d_arrays.resize(mf.local_size());
+
+#ifdef AMREX_USE_MPI
+        // the patterns are built in the same order on all the ranks
+        int const mpi_tag = ParallelDescriptor::SeqNum();
+        MPI_Comm const comm = ParallelDescriptor::Communicator();
+        MPI_Datatype const mpi_type = ParallelDescriptor::Mpi_typemap<Real>::type();
+        for (Message const& msg : recv_msgs) {
+            m_recv_reqs.push_back(MPI_REQUEST_NULL);
+            MPI_Recv_init(m_recv_buf + msg.offset*ncomp, static_cast<int>(msg.ncells*ncomp),
+                          mpi_type, msg.peer, mpi_tag, comm, &m_recv_reqs.back());
+        }
+        for (Message const& msg : send_msgs) {
+            m_send_reqs.push_back(MPI_REQUEST_NULL);
+            MPI_Send_init(m_send_buf + msg.offset*ncomp, static_cast<int>(msg.ncells*ncomp),
+                          mpi_type, msg.peer, mpi_tag, comm, &m_send_reqs.back());
+        }
+#else
+        amrex::ignore_unused(send_msgs, recv_msgs);
+#endif
+    }
+
+    Plan::~Plan ()
+    {
+#ifdef AMREX_USE_MPI
+        for (MPI_Request& req : m_send_reqs) MPI_Request_free(&req);
+        for (MPI_Request& req : m_recv_reqs) MPI_Request_free(&req);
+#endif
+        if (m_send_buf) m_arena->free(m_send_buf);
+        if (m_recv_buf) m_arena->free(m_recv_buf);
+        if (m_local_buf) The_Arena()->free(m_local_buf);
+    }
+
+    void
+    Plan::Start (MultiFab& mf, int scomp)
+    {
+        // the requests and buffers of a layout are shared by the MultiFabs of this layout
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_in_flight,
+            "PersistentExchange: two MultiFabs with the same layout are exchanged at the same time");
+        m_in_flight = true;
+        m_scomp = scomp;
+        for (MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            m_h_arrays[mfi.LocalIndex()] = mf.array(mfi);
+        }
+        Gpu::copyAsync(Gpu::hostToDevice, m_h_arrays.begin(), m_h_arrays.end(),
+                       m_d_arrays.begin());
+
+#ifdef AMREX_USE_MPI
+        if (!m_recv_reqs.empty()) {
+            MPI_Startall(static_cast<int>(m_recv_reqs.size()), m_recv_reqs.data());
+        }
+#endif
+
+        Array4<Real> const* arrays = m_d_arrays.dataPtr();
+        int const ncomp = m_ncomp;
+        Pack(m_send_tags, m_send_cells, arrays, scomp, ncomp, m_send_buf);
+        // the additions read the local sources before they are modified
+        if (m_op == Op::Add) Pack(m_local_tags, m_local_cells, arrays, scomp, ncomp, m_local_buf);
+        Gpu::streamSynchronize();
+
+#ifdef AMREX_USE_MPI
+        if (!m_send_reqs.empty()) {
+            MPI_Startall(static_cast<int>(m_send_reqs.size()), m_send_reqs.data());
+        }
+#endif
+
+        // the exchanges between the local boxes, while the messages are in flight
+        if (m_op == Op::Copy) {
+            ForEachCell(m_local_tags, m_local_cells,
+                [=] AMREX_GPU_DEVICE (Tag const& tag, IntVect const& iv, Long) noexcept
+                {
+                    Array4<Real> const& src = arrays[tag.src];
+                    Array4<Real> const& dst = arrays[tag.dst];
+                    for (int n = 0; n < ncomp; ++n) dst(iv, scomp+n) = src(iv + tag.shift, scomp+n);
+                });
+        } else {
+            Real const* buf = m_local_buf;
+            ForEachCell(m_local_tags, m_local_cells,
+                [=] AMREX_GPU_DEVICE (Tag const& tag, IntVect const& iv, Long icell) noexcept
+                {
+                    Array4<Real> const& dst = arrays[tag.dst];
+                    for (int n = 0; n < ncomp; ++n) {
+                        Gpu::Atomic::AddNoRet(&dst(iv, scomp+n), buf[icell*ncomp+n]);
+                    }
+                });
+        }
+    }
+
+    void
+    Plan::Finish ()
+    {
+#ifdef AMREX_USE_MPI
+        if (!m_recv_reqs.empty()) {
+            MPI_Waitall(static_cast<int>(m_recv_reqs.size()), m_recv_reqs.data(),
+                        MPI_STATUSES_IGNORE);
+        }
+#endif
+
+        Array4<Real> const* arrays = m_d_arrays.dataPtr();
+        Real const* buf = m_recv_buf;
+        int const ncomp = m_ncomp;
+        int const scomp = m_scomp;
+        bool const add = (m_op == Op::Add);
+        ForEachCell(m_recv_tags, m_recv_cells,
+            [=] AMREX_GPU_DEVICE (Tag const& tag, IntVect const& iv, Long icell) noexcept
+            {
+                Array4<Real> const& dst = arrays[tag.dst];
+                for (int n = 0; n < ncomp; ++n) {
+                    // several regions of a box may add to the same cell
+                    if (add) Gpu::Atomic::AddNoRet(&dst(iv, scomp+n), buf[icell*ncomp+n]);
+                    else dst(iv, scomp+n) = buf[icell*ncomp+n];
+                }
+            });
+
+#ifdef AMREX_USE_MPI
+        if (!m_send_reqs.empty()) {
+            MPI_Waitall(static_cast<int>(m_send_reqs.size()), m_send_reqs.data(),
+                        MPI_STATUSES_IGNORE);
+        }
+#endif
+        // the buffers and arrays are reused by the next exchange
+        Gpu::streamSynchronize();
+        m_in_flight = false;
+    }
+
+    bool s_enabled = false;
+    Vector<std::unique_ptr<Plan>> s_plans;
+    //! exchanges started by FillBoundary_nowait
+    std::map<MultiFab const*, Plan*> s_pending;
+
+    Plan& GetPlan (MultiFab const& mf, IntVect const& ng, IntVect const& src_ng,
+                   Periodicity const& period, Op op, int ncomp)
+    {
+        for (auto const& plan : s_plans) {
+            if (plan->Matches(mf, ng, src_ng, period, op, ncomp)) return *plan;
+        }
+        s_plans.push_back(std::make_unique<Plan>(mf, ng, src_ng, period, op, ncomp));
+        return *s_plans.back();
+    }
+}
+
+void
+PersistentExchange::Enable (bool enable)
+{
+    // the requests and buffers are freed before MPI and the arenas
+    if (enable && !s_enabled) amrex::ExecOnFinalize(PersistentExchange::Clear);
+    s_enabled = enable;
+}
+
+bool
+PersistentExchange::Enabled ()
+{
+    return s_enabled;
+}
+
+void
+PersistentExchange::FillBoundary_nowait (MultiFab& mf, IntVect const& ng,
+                                         Periodicity const& period)
+{
+    Plan& plan = GetPlan(mf, ng, IntVect::TheZeroVector(), period, Op::Copy, mf.nComp());
+    plan.Start(mf, 0);
+    s_pending[&mf] = &plan;
+}
+
+void
+PersistentExchange::FillBoundary_finish (MultiFab& mf)
+{
+    auto it = s_pending.find(&mf);
+    if (it == s_pending.end()) return;
+    it->second->Finish();
+    s_pending.erase(it);
+}
+
+void
+PersistentExchange::SumBoundary (MultiFab& mf, int scomp, int ncomp, IntVect const& dst_ng,
+                                 Periodicity const& period)
+{
+    Plan& plan = GetPlan(mf, dst_ng, mf.nGrowVect(), period, Op::Add, ncomp);
+    plan.Start(mf, scomp);
+    plan.Finish();
+}
+
+void
+PersistentExchange::Clear ()
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(s_pending.empty(),
+        "PersistentExchange::Clear: an exchange is pending");
+    s_plans.clear();
+}
@@ -9,7 +9,9 @@
 #include "WarpXComm_K.H"
 #include "WarpX.H"
 #include "WarpXSumGuardCells.H"
+#include "CommStats.H"
 #include "Utils/CoarsenMR.H"
+#include "Utils/PhaseTimer.H"
 #ifdef WARPX_USE_PSATD
 #include "FieldSolver/SpectralSolver/SpectralKSpace.H"
 #endif
@@ -20,6 +22,23 @@
 
 using namespace amrex;
 
+namespace
+{
+    /** (Re)allocate the components of buf, with one component and ng guard cells,
+     *  if they are not defined on the boxes ba and dm */
+    void DefineCoarseBuffers (std::array<std::unique_ptr<MultiFab>,3>& buf,
+                              BoxArray const& ba, DistributionMapping const& dm,
+                              IntVect const& ng)
+    {
+        for (auto& mf : buf) {
+            if (!mf || mf->boxArray() != ba || mf->DistributionMap() != dm ||
+                mf->nGrowVect() != ng) {
+                mf = std::make_unique<MultiFab>(ba, dm, 1, ng);
+            }
+        }
+    }
+}
+
 void
 WarpX::UpdateAuxilaryData ()
 {
@@ -132,103 +151,67 @@ WarpX::UpdateAuxilaryDataStagToNodal ()
         DistributionMapping const& dm = Bfield_aux[lev][0]->DistributionMap();
         auto const& cperiod = Geom(lev-1).periodicity();
 
-        // Bfield
-        {
-            Array<std::unique_ptr<MultiFab>,3> Btmp;
-            if (Bfield_cax[lev][0]) {
-                for (int i = 0; i < 3; ++i) {
-                    Btmp[i] = std::make_unique<MultiFab>(
-                        *Bfield_cax[lev][i], amrex::make_alias, 0, 1);
-                }
-            } else {
-                IntVect ngtmp = Bfield_aux[lev-1][0]->nGrowVect();
-                for (int i = 0; i < 3; ++i) {
-                    Btmp[i] = std::make_unique<MultiFab>(cnba, dm, 1, ngtmp);
-                }
-            }
-            // ParallelCopy from coarse level
-            for (int i = 0; i < 3; ++i) {
-                IntVect ng = Btmp[i]->nGrowVect();
-                Btmp[i]->ParallelCopy(*Bfield_aux[lev-1][i], 0, 0, 1, ng, ng, cperiod);
-            }
-
-#ifdef AMREX_USE_OMP
-#pragma omp parallel if (Gpu::notInLaunchRegion())
-#endif
-            for (MFIter mfi(*Bfield_aux[lev][0]); mfi.isValid(); ++mfi)
-            {
-                Array4<Real> const& bx_aux = Bfield_aux[lev][0]->array(mfi);
-                Array4<Real> const& by_aux = Bfield_aux[lev][1]->array(mfi);
-                Array4<Real> const& bz_aux = Bfield_aux[lev][2]->array(mfi);
-                Array4<Real const> const& bx_fp = Bfield_fp[lev][0]->const_array(mfi);
-                Array4<Real const> const& by_fp = Bfield_fp[lev][1]->const_array(mfi);
-                Array4<Real const> const& bz_fp = Bfield_fp[lev][2]->const_array(mfi);
-                Array4<Real const> const& bx_cp = Bfield_cp[lev][0]->const_array(mfi);
-                Array4<Real const> const& by_cp = Bfield_cp[lev][1]->const_array(mfi);
-                Array4<Real const> const& bz_cp = Bfield_cp[lev][2]->const_array(mfi);
-                Array4<Real const> const& bx_c = Btmp[0]->const_array(mfi);
-                Array4<Real const> const& by_c = Btmp[1]->const_array(mfi);
-                Array4<Real const> const& bz_c = Btmp[2]->const_array(mfi);
-
-                const Box& bx = mfi.fabbox();
-                amrex::ParallelFor(bx,
-                [=] AMREX_GPU_DEVICE (int j, int k, int l) noexcept
-                {
-                    warpx_interp_nd_bfield_x(j,k,l, bx_aux, bx_fp, bx_cp, bx_c);
-                    warpx_interp_nd_bfield_y(j,k,l, by_aux, by_fp, by_cp, by_c);
-                    warpx_interp_nd_bfield_z(j,k,l, bz_aux, bz_fp, bz_cp, bz_c);
-                });
-            }
+        // Coarse aux on the coarsened boxes of this level: the copy of the coarse aux
+        // if there is one, persistent buffers otherwise
+        if (!Bfield_cax[lev][0]) {
+            DefineCoarseBuffers(Bfield_aux_ctmp[lev], cnba, dm, Bfield_aux[lev-1][0]->nGrowVect());
+            DefineCoarseBuffers(Efield_aux_ctmp[lev], cnba, dm, Efield_aux[lev-1][0]->nGrowVect());
+        }
+        auto const& Btmp = Bfield_cax[lev][0] ? Bfield_cax[lev] : Bfield_aux_ctmp[lev];
+        auto const& Etmp = Efield_cax[lev][0] ? Efield_cax[lev] : Efield_aux_ctmp[lev];
+
+        // ParallelCopy from coarse level
+        for (int i = 0; i < 3; ++i) {
+            IntVect ngb = Btmp[i]->nGrowVect();
+            IntVect nge = Etmp[i]->nGrowVect();
+            Btmp[i]->ParallelCopy(*Bfield_aux[lev-1][i], 0, 0, 1, ngb, ngb, cperiod);
+            Etmp[i]->ParallelCopy(*Efield_aux[lev-1][i], 0, 0, 1, nge, nge, cperiod);
         }
 
-        // Efield
-        {
-            Array<std::unique_ptr<MultiFab>,3> Etmp;
-            if (Efield_cax[lev][0]) {
-                for (int i = 0; i < 3; ++i) {
-                    Etmp[i] = std::make_unique<MultiFab>(
-                        *Efield_cax[lev][i], amrex::make_alias, 0, 1);
-                }
-            } else {
-                IntVect ngtmp = Efield_aux[lev-1][0]->nGrowVect();
-                for (int i = 0; i < 3; ++i) {
-                    Etmp[i] = std::make_unique<MultiFab>(
-                        cnba, dm, 1, ngtmp);
-                }
-            }
-            // ParallelCopy from coarse level
-            for (int i = 0; i < 3; ++i) {
-                IntVect ng = Etmp[i]->nGrowVect();
-                Etmp[i]->ParallelCopy(*Efield_aux[lev-1][i], 0, 0, 1, ng, ng, cperiod);
-            }
-
+        // E and B, fine and coarse, are interpolated to the nodes by the same kernel
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
-            for (MFIter mfi(*Efield_aux[lev][0]); mfi.isValid(); ++mfi)
+        for (MFIter mfi(*Bfield_aux[lev][0]); mfi.isValid(); ++mfi)
+        {
+            Array4<Real> const& bx_aux = Bfield_aux[lev][0]->array(mfi);
+            Array4<Real> const& by_aux = Bfield_aux[lev][1]->array(mfi);
+            Array4<Real> const& bz_aux = Bfield_aux[lev][2]->array(mfi);
+            Array4<Real const> const& bx_fp = Bfield_fp[lev][0]->const_array(mfi);
+            Array4<Real const> const& by_fp = Bfield_fp[lev][1]->const_array(mfi);
+            Array4<Real const> const& bz_fp = Bfield_fp[lev][2]->const_array(mfi);
+            Array4<Real const> const& bx_cp = Bfield_cp[lev][0]->const_array(mfi);
+            Array4<Real const> const& by_cp = Bfield_cp[lev][1]->const_array(mfi);
+            Array4<Real const> const& bz_cp = Bfield_cp[lev][2]->const_array(mfi);
+            Array4<Real const> const& bx_c = Btmp[0]->const_array(mfi);
+            Array4<Real const> const& by_c = Btmp[1]->const_array(mfi);
+            Array4<Real const> const& bz_c = Btmp[2]->const_array(mfi);
+
+            Array4<Real> const& ex_aux = Efield_aux[lev][0]->array(mfi);
+            Array4<Real> const& ey_aux = Efield_aux[lev][1]->array(mfi);
+            Array4<Real> const& ez_aux = Efield_aux[lev][2]->array(mfi);
+            Array4<Real const> const& ex_fp = Efield_fp[lev][0]->const_array(mfi);
+            Array4<Real const> const& ey_fp = Efield_fp[lev][1]->const_array(mfi);
+            Array4<Real const> const& ez_fp = Efield_fp[lev][2]->const_array(mfi);
+            Array4<Real const> const& ex_cp = Efield_cp[lev][0]->const_array(mfi);
+            Array4<Real const> const& ey_cp = Efield_cp[lev][1]->const_array(mfi);
+            Array4<Real const> const& ez_cp = Efield_cp[lev][2]->const_array(mfi);
+            Array4<Real const> const& ex_c = Etmp[0]->const_array(mfi);
+            Array4<Real const> const& ey_c = Etmp[1]->const_array(mfi);
+            Array4<Real const> const& ez_c = Etmp[2]->const_array(mfi);
+
+            // E and B aux have the same nodal boxes and guard cells
+            const Box& bx = mfi.fabbox();
+            amrex::ParallelFor(bx,
+            [=] AMREX_GPU_DEVICE (int j, int k, int l) noexcept
             {
-                Array4<Real> const& ex_aux = Efield_aux[lev][0]->array(mfi);
-                Array4<Real> const& ey_aux = Efield_aux[lev][1]->array(mfi);
-                Array4<Real> const& ez_aux = Efield_aux[lev][2]->array(mfi);
-                Array4<Real const> const& ex_fp = Efield_fp[lev][0]->const_array(mfi);
-                Array4<Real const> const& ey_fp = Efield_fp[lev][1]->const_array(mfi);
-                Array4<Real const> const& ez_fp = Efield_fp[lev][2]->const_array(mfi);
-                Array4<Real const> const& ex_cp = Efield_cp[lev][0]->const_array(mfi);
-                Array4<Real const> const& ey_cp = Efield_cp[lev][1]->const_array(mfi);
-                Array4<Real const> const& ez_cp = Efield_cp[lev][2]->const_array(mfi);
-                Array4<Real const> const& ex_c = Etmp[0]->const_array(mfi);
-                Array4<Real const> const& ey_c = Etmp[1]->const_array(mfi);
-                Array4<Real const> const& ez_c = Etmp[2]->const_array(mfi);
-
-                const Box& bx = mfi.fabbox();
-                amrex::ParallelFor(bx,
-                [=] AMREX_GPU_DEVICE (int j, int k, int l) noexcept
-                {
-                    warpx_interp_nd_efield_x(j,k,l, ex_aux, ex_fp, ex_cp, ex_c);
-                    warpx_interp_nd_efield_y(j,k,l, ey_aux, ey_fp, ey_cp, ey_c);
-                    warpx_interp_nd_efield_z(j,k,l, ez_aux, ez_fp, ez_cp, ez_c);
-                });
-            }
+                warpx_interp_nd_bfield_x(j,k,l, bx_aux, bx_fp, bx_cp, bx_c);
+                warpx_interp_nd_bfield_y(j,k,l, by_aux, by_fp, by_cp, by_c);
+                warpx_interp_nd_bfield_z(j,k,l, bz_aux, bz_fp, bz_cp, bz_c);
+                warpx_interp_nd_efield_x(j,k,l, ex_aux, ex_fp, ex_cp, ex_c);
+                warpx_interp_nd_efield_y(j,k,l, ey_aux, ey_fp, ey_cp, ey_c);
+                warpx_interp_nd_efield_z(j,k,l, ez_aux, ez_fp, ez_cp, ez_c);
+            });
         }
     }
 }
@@ -357,8 +340,61 @@ WarpX::UpdateAuxilaryDataSameType ()
                 });
             }
         }
+
+#ifdef WARPX_MAG_LLG
+        // H and M fields, advanced on the fine and coarse patches by the macroscopic solver
+        UpdateAuxilaryDataSameTypeFace(lev, Hfield_aux, Hfield_fp, Hfield_cp);
+        UpdateAuxilaryDataSameTypeFace(lev, Mfield_aux, Mfield_fp, Mfield_cp);
+#endif
+    }
+}
+
+#ifdef WARPX_MAG_LLG
+void
+WarpX::UpdateAuxilaryDataSameTypeFace (int lev,
+                                       amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>>& field_aux,
+                                       amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>> const& field_fp,
+                                       amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>> const& field_cp)
+{
+    const auto& crse_period = Geom(lev-1).periodicity();
+    const amrex::IntVect& refinement_ratio = refRatio(lev-1);
+
+    for (int idir = 0; idir < 3; ++idir)
+    {
+        // M may have no guard cells (warpx.mag_M_compact_storage = 1)
+        const IntVect& ng = field_cp[lev][idir]->nGrowVect();
+        const IntVect ng_src = amrex::min(ng, field_aux[lev-1][idir]->nGrowVect());
+        const int ncomp = field_cp[lev][idir]->nComp();
+
+        MultiFab dF(field_cp[lev][idir]->boxArray(), field_cp[lev][idir]->DistributionMap(), ncomp, ng);
+        dF.setVal(0.0);
+        dF.ParallelCopy(*field_aux[lev-1][idir], 0, 0, ncomp, ng_src, ng, crse_period);
+        MultiFab::Subtract(dF, *field_cp[lev][idir], 0, 0, ncomp, ng);
+
+        const amrex::IntVect& F_stag = field_aux[lev-1][idir]->ixType().toIntVect();
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(*field_aux[lev][idir]); mfi.isValid(); ++mfi)
+        {
+            for (int n = 0; n < ncomp; ++n)
+            {
+                // warpx_interp works on the first component of the arrays
+                Array4<Real> const f_aux(field_aux[lev][idir]->array(mfi), n);
+                Array4<Real const> const f_fp(field_fp[lev][idir]->const_array(mfi), n);
+                Array4<Real const> const f_c(dF.const_array(mfi), n);
+
+                amrex::ParallelFor(Box(f_aux),
+                [=] AMREX_GPU_DEVICE (int j, int k, int l) noexcept
+                {
+                    warpx_interp(j, k, l, f_aux, f_fp, f_c, F_stag, refinement_ratio);
+                });
+            }
+        }
     }
 }
+#endif
 
 void
 WarpX::FillBoundaryB (IntVect ng)
@@ -378,6 +414,78 @@ WarpX::FillBoundaryE (IntVect ng)
     }
 }
 
+void
+WarpX::FillBoundaryB_nowait (IntVect ng)
+{
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        FillBoundaryB(lev, PatchType::fine, ng, true);
+        if (lev > 0) FillBoundaryB(lev, PatchType::coarse, ng, true);
+    }
+}
+
+void
+WarpX::FillBoundaryE_nowait (IntVect ng)
+{
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        FillBoundaryE(lev, PatchType::fine, ng, true);
+        if (lev > 0) FillBoundaryE(lev, PatchType::coarse, ng, true);
+    }
+}
+
+#ifdef WARPX_MAG_LLG
+void
+WarpX::FillBoundaryM_nowait (IntVect ng)
+{
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        FillBoundaryM(lev, PatchType::fine, ng, true);
+        if (lev > 0) FillBoundaryM(lev, PatchType::coarse, ng, true);
+    }
+}
+
+void
+WarpX::FillBoundaryH_nowait (IntVect ng)
+{
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        FillBoundaryH(lev, PatchType::fine, ng, true);
+        if (lev > 0) FillBoundaryH(lev, PatchType::coarse, ng, true);
+    }
+}
+#endif
+
+void
+WarpX::FillBoundary_start ()
+{
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryNowait);
+    m_fill_boundary_pending.FillBoundary_nowait();
+}
+
+void
+WarpX::FillBoundary_finish ()
+{
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryNowait);
+    m_fill_boundary_pending.FillBoundary_finish();
+}
+
+void
+WarpX::FillBoundaryComponents (std::array<std::unique_ptr<amrex::MultiFab>,3> const& field,
+                               IntVect ng, amrex::Periodicity const& period, bool nowait)
+{
+    if (nowait) {
+        for (auto const& mf : field) m_fill_boundary_pending.add(mf.get(), ng, period);
+    } else {
+        // the components are exchanged together, when they have the same layout
+        AggregatedFillBoundary exchange;
+        for (auto const& mf : field) exchange.add(mf.get(), ng, period);
+        exchange.FillBoundary();
+    }
+}
+
 void
 WarpX::FillBoundaryF (IntVect ng)
 {
@@ -387,6 +495,15 @@ WarpX::FillBoundaryF (IntVect ng)
     }
 }
 
+void
+WarpX::FillBoundaryEBF (IntVect ng)
+{
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        FillBoundaryEBF(lev, ng);
+    }
+}
+
 void
 WarpX::FillBoundaryB_avg (IntVect ng)
 {
@@ -414,8 +531,10 @@ WarpX::FillBoundaryE(int lev, IntVect ng)
 }
 
 void
-WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
+WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng, bool nowait)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryE);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -431,14 +550,13 @@ WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Efield_fp[lev][0].get(),Efield_fp[lev][1].get(),Efield_fp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, period);
             amrex::FillBoundary(mf, period);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Efield_fp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryE, requested more guard cells than allocated");
-            Efield_fp[lev][0]->FillBoundary(ng, period);
-            Efield_fp[lev][1]->FillBoundary(ng, period);
-            Efield_fp[lev][2]->FillBoundary(ng, period);
+            FillBoundaryComponents(Efield_fp[lev], ng, period, nowait);
         }
     }
     else if (patch_type == PatchType::coarse)
@@ -455,15 +573,14 @@ WarpX::FillBoundaryE (int lev, PatchType patch_type, IntVect ng)
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Efield_cp[lev][0].get(),Efield_cp[lev][1].get(),Efield_cp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, cperiod);
             amrex::FillBoundary(mf, cperiod);
 
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Efield_cp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryE, requested more guard cells than allocated");
-            Efield_cp[lev][0]->FillBoundary(ng, cperiod);
-            Efield_cp[lev][1]->FillBoundary(ng, cperiod);
-            Efield_cp[lev][2]->FillBoundary(ng, cperiod);
+            FillBoundaryComponents(Efield_cp[lev], ng, cperiod, nowait);
         }
     }
 }
@@ -476,8 +593,10 @@ WarpX::FillBoundaryB (int lev, IntVect ng)
 }
 
 void
-WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
+WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng, bool nowait)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryB);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -492,14 +611,13 @@ WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Bfield_fp[lev][0].get(),Bfield_fp[lev][1].get(),Bfield_fp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, period);
             amrex::FillBoundary(mf, period);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_fp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryB, requested more guard cells than allocated");
-            Bfield_fp[lev][0]->FillBoundary(ng, period);
-            Bfield_fp[lev][1]->FillBoundary(ng, period);
-            Bfield_fp[lev][2]->FillBoundary(ng, period);
+            FillBoundaryComponents(Bfield_fp[lev], ng, period, nowait);
         }
     }
     else if (patch_type == PatchType::coarse)
@@ -516,14 +634,13 @@ WarpX::FillBoundaryB (int lev, PatchType patch_type, IntVect ng)
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Bfield_cp[lev][0].get(),Bfield_cp[lev][1].get(),Bfield_cp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, cperiod);
             amrex::FillBoundary(mf, cperiod);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_cp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryB, requested more guard cells than allocated");
-            Bfield_cp[lev][0]->FillBoundary(ng, cperiod);
-            Bfield_cp[lev][1]->FillBoundary(ng, cperiod);
-            Bfield_cp[lev][2]->FillBoundary(ng, cperiod);
+            FillBoundaryComponents(Bfield_cp[lev], ng, cperiod, nowait);
         }
     }
 }
@@ -546,53 +663,47 @@ WarpX::FillBoundaryM (int lev, IntVect ng)
 }
 
 void
-WarpX::FillBoundaryM (int lev, PatchType patch_type, IntVect ng)
+WarpX::FillBoundaryM (int lev, PatchType patch_type, IntVect ng, bool nowait)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryM);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
         {
             // ExchangeM not needed for PML algorithm
         }
+        // no guard cells to fill with the compact storage of M (warpx.mag_M_compact_storage = 1)
+        if (Mfield_fp[lev][0]->nGrowVect() == IntVect::TheZeroVector()) return;
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Mfield_fp[lev][0].get(),Mfield_fp[lev][1].get(),Mfield_fp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, period);
             amrex::FillBoundary(mf, period);
         } else {
-            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
-                ng <= Mfield_fp[lev][0]->nGrowVect(),
-                "Error: in FillBoundaryM, requested more guard cells than allocated");
-            Mfield_fp[lev][0]->FillBoundary(ng, period);
-            Mfield_fp[lev][1]->FillBoundary(ng, period);
-            Mfield_fp[lev][2]->FillBoundary(ng, period); //Mfield_fp is an amrex object
+            // M may have fewer guard cells than E and B (guard_cells.ng_alloc_M)
+            FillBoundaryComponents(Mfield_fp[lev], ng.min(Mfield_fp[lev][0]->nGrowVect()),
+                                   period, nowait);
         }
     }
     else if (patch_type == PatchType::coarse)
     {
-        amrex::Abort("EvolveHM does not come with coarse patch yet");
-        /*
         if (do_pml && pml[lev]->ok())
         {
-        pml[lev]->ExchangeM(patch_type,
-                      { Mfield_cp[lev][0].get(),
-                        Mfield_cp[lev][1].get(),
-                        Mfield_cp[lev][2].get() },
-                        do_pml_in_domain);
-        pml[lev]->FillBoundaryM(patch_type);
+            // ExchangeM not needed for PML algorithm
         }
+        // no guard cells to fill with the compact storage of M (warpx.mag_M_compact_storage = 1)
+        if (Mfield_cp[lev][0]->nGrowVect() == IntVect::TheZeroVector()) return;
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Mfield_cp[lev][0].get(),Mfield_cp[lev][1].get(),Mfield_cp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, cperiod);
             amrex::FillBoundary(mf, cperiod);
         } else {
-            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
-                ng <= Mfield_cp[lev][0]->nGrowVect(),
-                "Error: in FillBoundaryM, requested more guard cells than allocated");
-            Mfield_cp[lev][0]->FillBoundary(ng, cperiod);
-            Mfield_cp[lev][1]->FillBoundary(ng, cperiod);
-            Mfield_cp[lev][2]->FillBoundary(ng, cperiod);
+            // M may have fewer guard cells than E and B (guard_cells.ng_alloc_M)
+            FillBoundaryComponents(Mfield_cp[lev], ng.min(Mfield_cp[lev][0]->nGrowVect()),
+                                   cperiod, nowait);
         }
-        */
     }
 }
 
@@ -613,8 +724,10 @@ WarpX::FillBoundaryH (int lev, IntVect ng)
 }
 
 void
-WarpX::FillBoundaryH (int lev, PatchType patch_type, IntVect ng)
+WarpX::FillBoundaryH (int lev, PatchType patch_type, IntVect ng, bool nowait)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryH);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -629,42 +742,35 @@ WarpX::FillBoundaryH (int lev, PatchType patch_type, IntVect ng)
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Hfield_fp[lev][0].get(),Hfield_fp[lev][1].get(),Hfield_fp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, period);
             amrex::FillBoundary(mf, period);
         } else {
-            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
-                ng <= Hfield_fp[lev][0]->nGrowVect(),
-                "Error: in FillBoundaryH, requested more guard cells than allocated");
-            Hfield_fp[lev][0]->FillBoundary(ng, period);
-            Hfield_fp[lev][1]->FillBoundary(ng, period);
-            Hfield_fp[lev][2]->FillBoundary(ng, period); //Hfield_fp is an amrex object
+            // H may have fewer guard cells than E and B (guard_cells.ng_alloc_H)
+            FillBoundaryComponents(Hfield_fp[lev], ng.min(Hfield_fp[lev][0]->nGrowVect()),
+                                   period, nowait);
         }
     }
     else if (patch_type == PatchType::coarse)
     {
-        amrex::Abort("EvolveHM does not come with coarse patch yet");
-        /*
         if (do_pml && pml[lev]->ok())
         {
-        pml[lev]->ExchangeH(patch_type,
-                      { Hfield_cp[lev][0].get(),
-                        Hfield_cp[lev][1].get(),
-                        Hfield_cp[lev][2].get() },
-                        do_pml_in_domain);
-        pml[lev]->FillBoundaryH(patch_type);
+            pml[lev]->ExchangeH(patch_type,
+                            { Hfield_cp[lev][0].get(),
+                              Hfield_cp[lev][1].get(),
+                              Hfield_cp[lev][2].get() },
+                              do_pml_in_domain);
+            pml[lev]->FillBoundaryH(patch_type);
         }
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Hfield_cp[lev][0].get(),Hfield_cp[lev][1].get(),Hfield_cp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, cperiod);
             amrex::FillBoundary(mf, cperiod);
         } else {
-            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
-                ng <= Hfield_cp[lev][0]->nGrowVect(),
-                "Error: in FillBoundaryH, requested more guard cells than allocated");
-            Hfield_cp[lev][0]->FillBoundary(ng, cperiod);
-            Hfield_cp[lev][1]->FillBoundary(ng, cperiod);
-            Hfield_cp[lev][2]->FillBoundary(ng, cperiod);
+            // H may have fewer guard cells than E and B (guard_cells.ng_alloc_H)
+            FillBoundaryComponents(Hfield_cp[lev], ng.min(Hfield_cp[lev][0]->nGrowVect()),
+                                   cperiod, nowait);
         }
-        */
     }
 }
 #endif
@@ -679,6 +785,8 @@ WarpX::FillBoundaryE_avg(int lev, IntVect ng)
 void
 WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryE_avg);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -689,13 +797,17 @@ WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Efield_avg_fp[lev][0].get(),Efield_avg_fp[lev][1].get(),Efield_avg_fp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, period);
             amrex::FillBoundary(mf, period);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Efield_avg_fp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryE_avg, requested more guard cells than allocated");
+            CommStats::AddFillBoundary(*Efield_avg_fp[lev][0], Efield_avg_fp[lev][0]->nComp(), ng, period);
             Efield_avg_fp[lev][0]->FillBoundary(ng, period);
+            CommStats::AddFillBoundary(*Efield_avg_fp[lev][1], Efield_avg_fp[lev][1]->nComp(), ng, period);
             Efield_avg_fp[lev][1]->FillBoundary(ng, period);
+            CommStats::AddFillBoundary(*Efield_avg_fp[lev][2], Efield_avg_fp[lev][2]->nComp(), ng, period);
             Efield_avg_fp[lev][2]->FillBoundary(ng, period);
         }
     }
@@ -709,14 +821,18 @@ WarpX::FillBoundaryE_avg (int lev, PatchType patch_type, IntVect ng)
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Efield_avg_cp[lev][0].get(),Efield_avg_cp[lev][1].get(),Efield_avg_cp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, cperiod);
             amrex::FillBoundary(mf, cperiod);
 
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Efield_avg_cp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryE, requested more guard cells than allocated");
+            CommStats::AddFillBoundary(*Efield_avg_cp[lev][0], Efield_avg_cp[lev][0]->nComp(), ng, cperiod);
             Efield_avg_cp[lev][0]->FillBoundary(ng, cperiod);
+            CommStats::AddFillBoundary(*Efield_avg_cp[lev][1], Efield_avg_cp[lev][1]->nComp(), ng, cperiod);
             Efield_avg_cp[lev][1]->FillBoundary(ng, cperiod);
+            CommStats::AddFillBoundary(*Efield_avg_cp[lev][2], Efield_avg_cp[lev][2]->nComp(), ng, cperiod);
             Efield_avg_cp[lev][2]->FillBoundary(ng, cperiod);
         }
     }
@@ -733,6 +849,8 @@ WarpX::FillBoundaryB_avg (int lev, IntVect ng)
 void
 WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryB_avg);
     if (patch_type == PatchType::fine)
     {
         if (do_pml && pml[lev]->ok())
@@ -742,13 +860,17 @@ WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ) {
             Vector<MultiFab*> mf{Bfield_avg_fp[lev][0].get(),Bfield_avg_fp[lev][1].get(),Bfield_avg_fp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, period);
             amrex::FillBoundary(mf, period);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_fp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryB, requested more guard cells than allocated");
+            CommStats::AddFillBoundary(*Bfield_avg_fp[lev][0], Bfield_avg_fp[lev][0]->nComp(), ng, period);
             Bfield_avg_fp[lev][0]->FillBoundary(ng, period);
+            CommStats::AddFillBoundary(*Bfield_avg_fp[lev][1], Bfield_avg_fp[lev][1]->nComp(), ng, period);
             Bfield_avg_fp[lev][1]->FillBoundary(ng, period);
+            CommStats::AddFillBoundary(*Bfield_avg_fp[lev][2], Bfield_avg_fp[lev][2]->nComp(), ng, period);
             Bfield_avg_fp[lev][2]->FillBoundary(ng, period);
         }
     }
@@ -762,19 +884,82 @@ WarpX::FillBoundaryB_avg (int lev, PatchType patch_type, IntVect ng)
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ){
             Vector<MultiFab*> mf{Bfield_avg_cp[lev][0].get(),Bfield_avg_cp[lev][1].get(),Bfield_avg_cp[lev][2].get()};
+            CommStats::AddFillBoundary(mf, cperiod);
             amrex::FillBoundary(mf, cperiod);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= Bfield_avg_cp[lev][0]->nGrowVect(),
                 "Error: in FillBoundaryB_avg, requested more guard cells than allocated");
+            CommStats::AddFillBoundary(*Bfield_avg_cp[lev][0], Bfield_avg_cp[lev][0]->nComp(), ng, cperiod);
             Bfield_avg_cp[lev][0]->FillBoundary(ng, cperiod);
+            CommStats::AddFillBoundary(*Bfield_avg_cp[lev][1], Bfield_avg_cp[lev][1]->nComp(), ng, cperiod);
             Bfield_avg_cp[lev][1]->FillBoundary(ng, cperiod);
+            CommStats::AddFillBoundary(*Bfield_avg_cp[lev][2], Bfield_avg_cp[lev][2]->nComp(), ng, cperiod);
             Bfield_avg_cp[lev][2]->FillBoundary(ng, cperiod);
         }
     }
 }
 
 
+void
+WarpX::FillBoundaryEBF (int lev, IntVect ng)
+{
+    FillBoundaryEBF(lev, PatchType::fine, ng);
+    if (lev > 0) FillBoundaryEBF(lev, PatchType::coarse, ng);
+}
+
+void
+WarpX::FillBoundaryEBF (int lev, PatchType patch_type, IntVect ng)
+{
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryEBF);
+    bool const fine = (patch_type == PatchType::fine);
+    const auto& E = (fine) ? Efield_fp[lev] : Efield_cp[lev];
+    const auto& B = (fine) ? Bfield_fp[lev] : Bfield_cp[lev];
+    const auto& F = (fine) ? F_fp[lev] : F_cp[lev];
+#ifdef WARPX_MAG_LLG
+    const auto& H = (fine) ? Hfield_fp[lev] : Hfield_cp[lev];
+#endif
+
+    if (do_pml && pml[lev]->ok())
+    {
+        pml[lev]->ExchangeE(patch_type, {E[0].get(), E[1].get(), E[2].get()}, do_pml_in_domain);
+        pml[lev]->ExchangeB(patch_type, {B[0].get(), B[1].get(), B[2].get()}, do_pml_in_domain);
+#ifdef WARPX_MAG_LLG
+        pml[lev]->ExchangeH(patch_type, {H[0].get(), H[1].get(), H[2].get()}, do_pml_in_domain);
+#endif
+        pml[lev]->ExchangeF(patch_type, F.get(), do_pml_in_domain);
+        pml[lev]->FillBoundary(patch_type);
+    }
+
+    Vector<MultiFab*> mf{E[0].get(), E[1].get(), E[2].get(), B[0].get(), B[1].get(), B[2].get()};
+    if (F) mf.push_back(F.get());
+
+    const auto& period = (fine) ? Geom(lev).periodicity() : Geom(lev-1).periodicity();
+    if ( safe_guard_cells ) {
+#ifdef WARPX_MAG_LLG
+        mf.insert(mf.end(), {H[0].get(), H[1].get(), H[2].get()});
+#endif
+        CommStats::AddFillBoundary(mf, period);
+        amrex::FillBoundary(mf, period);
+    } else {
+        for (MultiFab* field : mf) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+                ng <= field->nGrowVect(),
+                "Error: in FillBoundaryEBF, requested more guard cells than allocated");
+            CommStats::AddFillBoundary(*field, field->nComp(), ng, period);
+            field->FillBoundary(ng, period);
+        }
+#ifdef WARPX_MAG_LLG
+        // H may have fewer guard cells than E and B (guard_cells.ng_alloc_H)
+        for (auto const& field : H) {
+            CommStats::AddFillBoundary(*field, field->nComp(), ng.min(field->nGrowVect()), period);
+            field->FillBoundary(ng.min(field->nGrowVect()), period);
+        }
+#endif
+    }
+}
+
 void
 WarpX::FillBoundaryF (int lev, IntVect ng)
 {
@@ -785,6 +970,8 @@ WarpX::FillBoundaryF (int lev, IntVect ng)
 void
 WarpX::FillBoundaryF (int lev, PatchType patch_type, IntVect ng)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryF);
     if (patch_type == PatchType::fine && F_fp[lev])
     {
         if (do_pml && pml[lev]->ok())
@@ -796,11 +983,13 @@ WarpX::FillBoundaryF (int lev, PatchType patch_type, IntVect ng)
 
         const auto& period = Geom(lev).periodicity();
         if ( safe_guard_cells ) {
+            CommStats::AddFillBoundary(*F_fp[lev], F_fp[lev]->nComp(), F_fp[lev]->nGrowVect(), period);
             F_fp[lev]->FillBoundary(period);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= F_fp[lev]->nGrowVect(),
                 "Error: in FillBoundaryF, requested more guard cells than allocated");
+            CommStats::AddFillBoundary(*F_fp[lev], F_fp[lev]->nComp(), ng, period);
             F_fp[lev]->FillBoundary(ng, period);
         }
     }
@@ -815,11 +1004,13 @@ WarpX::FillBoundaryF (int lev, PatchType patch_type, IntVect ng)
 
         const auto& cperiod = Geom(lev-1).periodicity();
         if ( safe_guard_cells ) {
+            CommStats::AddFillBoundary(*F_cp[lev], F_cp[lev]->nComp(), F_cp[lev]->nGrowVect(), cperiod);
             F_cp[lev]->FillBoundary(cperiod);
         } else {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
                 ng <= F_cp[lev]->nGrowVect(),
                 "Error: in FillBoundaryF, requested more guard cells than allocated");
+            CommStats::AddFillBoundary(*F_cp[lev], F_cp[lev]->nComp(), ng, cperiod);
             F_cp[lev]->FillBoundary(ng, cperiod);
         }
     }
@@ -837,24 +1028,30 @@ WarpX::FillBoundaryAux (IntVect ng)
 void
 WarpX::FillBoundaryAux (int lev, IntVect ng)
 {
+    PhaseTimer timer(TimerPhase::FillBoundary);
+    CommStats comm_stats(CommSite::FillBoundaryAux);
     const auto& period = Geom(lev).periodicity();
-    Efield_aux[lev][0]->FillBoundary(ng, period);
-    Efield_aux[lev][1]->FillBoundary(ng, period);
-    Efield_aux[lev][2]->FillBoundary(ng, period);
-    Bfield_aux[lev][0]->FillBoundary(ng, period);
-    Bfield_aux[lev][1]->FillBoundary(ng, period);
-    Bfield_aux[lev][2]->FillBoundary(ng, period);
+    // e.g. with a nodal aux grid, all the components of E and B are exchanged together
+    AggregatedFillBoundary exchange;
+    for (int i = 0; i < 3; ++i) {
+        exchange.add(Efield_aux[lev][i].get(), ng, period);
+        exchange.add(Bfield_aux[lev][i].get(), ng, period);
+    }
 #ifdef WARPX_MAG_LLG
-    Mfield_aux[lev][0]->FillBoundary(ng, period);
-    Mfield_aux[lev][1]->FillBoundary(ng, period);
-    Mfield_aux[lev][2]->FillBoundary(ng, period);
+    // M may have fewer guard cells than E and B (warpx.mag_M_compact_storage = 1)
+    const IntVect ngM = amrex::min(ng, Mfield_aux[lev][0]->nGrowVect());
+    for (int i = 0; i < 3; ++i) {
+        exchange.add(Mfield_aux[lev][i].get(), ngM, period);
+    }
 #endif
+    exchange.FillBoundary();
 }
 
 void
 WarpX::SyncCurrent ()
 {
     WARPX_PROFILE("WarpX::SyncCurrent()");
+    PhaseTimer timer(TimerPhase::SumBoundary);
 
     // Restrict fine patch current onto the coarse patch, before
     // summing the guard cells of the fine patch
@@ -882,17 +1079,26 @@ WarpX::SyncCurrent ()
     // - add the coarse patch/buffer of `lev+1` into the fine patch of `lev`
     // - sum guard cells of the coarse patch of `lev+1` and fine patch of `lev`
     for (int lev=0; lev <= finest_level; ++lev) {
+        if (lev == 0 && m_current_is_summed) {
+            // the guard cells were summed with the deposition (PushParticlesandDeposePipelined)
+            NodalSyncJ(lev, PatchType::fine);
+            m_current_is_summed = false;
+            continue;
+        }
         AddCurrentFromFineLevelandSumBoundary(lev);
     }
 }
 
 void
-WarpX::SyncRho ()
+WarpX::SyncRho (bool skip_rho_old)
 {
     WARPX_PROFILE("WarpX::SyncRho()");
+    PhaseTimer timer(TimerPhase::SumBoundary);
 
     if (!rho_fp[0]) return;
-    const int ncomp = rho_fp[0]->nComp();
+    // rho_old is the first half of the components
+    const int icomp = skip_rho_old ? rho_fp[0]->nComp()/2 : 0;
+    const int ncomp = rho_fp[0]->nComp() - icomp;
 
     // Restrict fine patch onto the coarse patch,
     // before summing the guard cells of the fine patch
@@ -908,7 +1114,9 @@ WarpX::SyncRho ()
     // - add the coarse patch/buffer of `lev+1` into the fine patch of `lev`
     // - sum guard cells of the coarse patch of `lev+1` and fine patch of `lev`
     for (int lev=0; lev <= finest_level; ++lev) {
-        AddRhoFromFineLevelandSumBoundary(lev, 0, ncomp);
+        AddRhoFromFineLevelandSumBoundary(lev, icomp, ncomp);
+        // the nodal points of rho_old may only be due for synchronization at this step
+        if (skip_rho_old) NodalSyncRho(lev, PatchType::fine, 0, icomp);
     }
 }
 
@@ -938,6 +1146,8 @@ WarpX::RestrictCurrentFromFineToCoarsePatch (int lev)
 void
 WarpX::ApplyFilterandSumBoundaryJ (int lev, PatchType patch_type)
 {
+    PhaseTimer timer(TimerPhase::SumBoundary);
+    CommStats comm_stats(CommSite::SumBoundaryJ);
     const int glev = (patch_type == PatchType::fine) ? lev : lev-1;
     const auto& period = Geom(glev).periodicity();
     auto& j = (patch_type == PatchType::fine) ? current_fp[lev] : current_cp[lev];
@@ -946,7 +1156,7 @@ WarpX::ApplyFilterandSumBoundaryJ (int lev, PatchType patch_type)
             IntVect ng = j[idim]->nGrowVect();
             ng += bilinear_filter.stencil_length_each_dir-1;
             MultiFab jf(j[idim]->boxArray(), j[idim]->DistributionMap(), j[idim]->nComp(), ng);
-            bilinear_filter.ApplyStencil(jf, *j[idim]);
+            bilinear_filter.ApplyStencil(jf, *j[idim], 0, 0, j[idim]->nComp(), WarpX::getCosts(lev));
             WarpXSumGuardCells(*(j[idim]), jf, period, 0, (j[idim])->nComp());
         } else {
             WarpXSumGuardCells(*(j[idim]), period, 0, (j[idim])->nComp());
@@ -970,6 +1180,8 @@ WarpX::ApplyFilterandSumBoundaryJ (int lev, PatchType patch_type)
 void
 WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
 {
+    PhaseTimer timer(TimerPhase::SumBoundary);
+    CommStats comm_stats(CommSite::AddJFromFineLevel);
     ApplyFilterandSumBoundaryJ(lev, PatchType::fine);
 
     if (lev < finest_level) {
@@ -996,6 +1208,8 @@ WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
                 bilinear_filter.ApplyStencil(jfb, *current_buf[lev+1][idim]);
 
                 MultiFab::Add(jfb, jfc, 0, 0, current_buf[lev+1][idim]->nComp(), ng);
+                CommStats::AddParallelCopy(mf, jfb, current_buf[lev+1][idim]->nComp(),
+                                           ng, IntVect::TheZeroVector(), period);
                 mf.ParallelAdd(jfb, 0, 0, current_buf[lev+1][idim]->nComp(), ng, IntVect::TheZeroVector(), period);
 
                 WarpXSumGuardCells(*current_cp[lev+1][idim], jfc, period, 0, current_cp[lev+1][idim]->nComp());
@@ -1008,6 +1222,8 @@ WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
                 MultiFab jf(current_cp[lev+1][idim]->boxArray(),
                             current_cp[lev+1][idim]->DistributionMap(), current_cp[lev+1][idim]->nComp(), ng);
                 bilinear_filter.ApplyStencil(jf, *current_cp[lev+1][idim]);
+                CommStats::AddParallelCopy(mf, jf, current_cp[lev+1][idim]->nComp(),
+                                           ng, IntVect::TheZeroVector(), period);
                 mf.ParallelAdd(jf, 0, 0, current_cp[lev+1][idim]->nComp(), ng, IntVect::TheZeroVector(), period);
                 WarpXSumGuardCells(*current_cp[lev+1][idim], jf, period, 0, current_cp[lev+1][idim]->nComp());
             }
@@ -1016,6 +1232,8 @@ WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
                 MultiFab::Add(*current_buf[lev+1][idim],
                                *current_cp [lev+1][idim], 0, 0, current_buf[lev+1][idim]->nComp(),
                                current_cp[lev+1][idim]->nGrowVect());
+                CommStats::AddParallelCopy(mf, *current_buf[lev+1][idim], current_buf[lev+1][idim]->nComp(),
+                                           current_buf[lev+1][idim]->nGrowVect(), IntVect::TheZeroVector(), period);
                 mf.ParallelAdd(*current_buf[lev+1][idim], 0, 0, current_buf[lev+1][idim]->nComp(),
                                current_buf[lev+1][idim]->nGrowVect(), IntVect::TheZeroVector(),
                                period);
@@ -1023,6 +1241,8 @@ WarpX::AddCurrentFromFineLevelandSumBoundary (int lev)
             }
             else // no filter, no buffer
             {
+                CommStats::AddParallelCopy(mf, *current_cp[lev+1][idim], current_cp[lev+1][idim]->nComp(),
+                                           current_cp[lev+1][idim]->nGrowVect(), IntVect::TheZeroVector(), period);
                 mf.ParallelAdd(*current_cp[lev+1][idim], 0, 0, current_cp[lev+1][idim]->nComp(),
                                current_cp[lev+1][idim]->nGrowVect(), IntVect::TheZeroVector(),
                                period);
@@ -1055,14 +1275,16 @@ WarpX::ApplyFilterandSumBoundaryRho (int lev, PatchType patch_type, int icomp, i
 }
 
 void
-WarpX::ApplyFilterandSumBoundaryRho (int /*lev*/, int glev, amrex::MultiFab& rho, int icomp, int ncomp)
+WarpX::ApplyFilterandSumBoundaryRho (int lev, int glev, amrex::MultiFab& rho, int icomp, int ncomp)
 {
+    PhaseTimer timer(TimerPhase::SumBoundary);
+    CommStats comm_stats(CommSite::SumBoundaryRho);
     const auto& period = Geom(glev).periodicity();
     if (use_filter) {
         IntVect ng = rho.nGrowVect();
         ng += bilinear_filter.stencil_length_each_dir-1;
         MultiFab rf(rho.boxArray(), rho.DistributionMap(), ncomp, ng);
-        bilinear_filter.ApplyStencil(rf, rho, icomp, 0, ncomp);
+        bilinear_filter.ApplyStencil(rf, rho, icomp, 0, ncomp, WarpX::getCosts(lev));
         WarpXSumGuardCells(rho, rf, period, icomp, ncomp );
     } else {
         WarpXSumGuardCells(rho, period, icomp, ncomp);
@@ -1085,6 +1307,8 @@ WarpX::ApplyFilterandSumBoundaryRho (int /*lev*/, int glev, amrex::MultiFab& rho
 void
 WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
 {
+    PhaseTimer timer(TimerPhase::SumBoundary);
+    CommStats comm_stats(CommSite::AddRhoFromFineLevel);
     if (!rho_fp[lev]) return;
 
     ApplyFilterandSumBoundaryRho(lev, PatchType::fine, icomp, ncomp);
@@ -1111,6 +1335,8 @@ WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
             bilinear_filter.ApplyStencil(rhofb, *charge_buf[lev+1], icomp, 0, ncomp);
 
             MultiFab::Add(rhofb, rhofc, 0, 0, ncomp, ng);
+            CommStats::AddParallelCopy(mf, rhofb, ncomp,
+                                       ng, IntVect::TheZeroVector(), period);
             mf.ParallelAdd(rhofb, 0, 0, ncomp, ng, IntVect::TheZeroVector(), period);
             WarpXSumGuardCells( *rho_cp[lev+1], rhofc, period, icomp, ncomp );
         }
@@ -1120,6 +1346,8 @@ WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
             ng += bilinear_filter.stencil_length_each_dir-1;
             MultiFab rf(rho_cp[lev+1]->boxArray(), rho_cp[lev+1]->DistributionMap(), ncomp, ng);
             bilinear_filter.ApplyStencil(rf, *rho_cp[lev+1], icomp, 0, ncomp);
+            CommStats::AddParallelCopy(mf, rf, ncomp,
+                                       ng, IntVect::TheZeroVector(), period);
             mf.ParallelAdd(rf, 0, 0, ncomp, ng, IntVect::TheZeroVector(), period);
             WarpXSumGuardCells( *rho_cp[lev+1], rf, period, icomp, ncomp );
         }
@@ -1128,6 +1356,8 @@ WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
             MultiFab::Add(*charge_buf[lev+1],
                            *rho_cp[lev+1], icomp, icomp, ncomp,
                            rho_cp[lev+1]->nGrowVect());
+            CommStats::AddParallelCopy(mf, *charge_buf[lev+1], ncomp,
+                                       charge_buf[lev+1]->nGrowVect(), IntVect::TheZeroVector(), period);
             mf.ParallelAdd(*charge_buf[lev+1], icomp, 0,
                            ncomp,
                            charge_buf[lev+1]->nGrowVect(), IntVect::TheZeroVector(),
@@ -1136,6 +1366,8 @@ WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
         }
         else // no filter, no buffer
         {
+            CommStats::AddParallelCopy(mf, *rho_cp[lev+1], ncomp,
+                                       rho_cp[lev+1]->nGrowVect(), IntVect::TheZeroVector(), period);
             mf.ParallelAdd(*rho_cp[lev+1], icomp, 0, ncomp,
                            rho_cp[lev+1]->nGrowVect(), IntVect::TheZeroVector(),
                            period);
@@ -1151,6 +1383,7 @@ WarpX::AddRhoFromFineLevelandSumBoundary(int lev, int icomp, int ncomp)
 void
 WarpX::NodalSyncJ (int lev, PatchType patch_type)
 {
+    PhaseTimer timer(TimerPhase::SumBoundary);
     if (!override_sync_intervals.contains(istep[0])) return;
 
     if (patch_type == PatchType::fine)
@@ -1172,6 +1405,7 @@ WarpX::NodalSyncJ (int lev, PatchType patch_type)
 void
 WarpX::NodalSyncRho (int lev, PatchType patch_type, int icomp, int ncomp)
 {
+    PhaseTimer timer(TimerPhase::SumBoundary);
     if (!override_sync_intervals.contains(istep[0])) return;
 
     if (patch_type == PatchType::fine && rho_fp[lev])
@@ -1214,9 +1448,12 @@ void WarpX::NodalSyncPML (int lev, PatchType patch_type)
         pml_E[0]->OverrideSync(period);
         pml_E[1]->OverrideSync(period);
         pml_E[2]->OverrideSync(period);
-        pml_B[0]->OverrideSync(period);
-        pml_B[1]->OverrideSync(period);
-        pml_B[2]->OverrideSync(period);
+        // with LLG, B may not be stored in the PML (see PML::ExchangeB)
+        if (pml_B[0]) {
+            pml_B[0]->OverrideSync(period);
+            pml_B[1]->OverrideSync(period);
+            pml_B[2]->OverrideSync(period);
+        }
         if (pml_F) {
             pml_F->OverrideSync(period);
         }
@@ -7,20 +7,149 @@
  * License: BSD-3-Clause-LBNL
  */
 #include "WarpX.H"
+#include "HierarchicalLoadBalancer.H"
+#include "PersistentExchange.H"
+#include "WarpXMigrate.H"
+#include "WarpXComm_K.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/PhaseTimer.H"
 
 #include <AMReX_BLProfiler.H>
+#include <AMReX_Reduce.H>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
 #include <memory>
 #include <cstddef>
 
 using namespace amrex;
 
+namespace
+{
+    /** Fill mf with the field crse of the coarser level, interpolated with the refinement
+     *  ratio rr, and then, where they overlap, with old, the same field before the regrid */
+    void FillFromCoarse (MultiFab& mf, MultiFab const& crse, MultiFab const* old,
+                         IntVect const& rr, Periodicity const& crse_period,
+                         Periodicity const& period)
+    {
+        const int ncomp = mf.nComp();
+        const IntVect stag = mf.ixType().toIntVect();
+
+        // the coarse field on the coarsened grids of mf, with the guard cell used
+        // by the linear interpolation of the nodal directions
+        BoxArray cba = mf.boxArray();
+        cba.coarsen(rr);
+        MultiFab ctmp(cba, mf.DistributionMap(), ncomp, 1);
+        ctmp.setVal(0._rt);
+        ctmp.ParallelCopy(crse, 0, 0, ncomp, IntVect(0), IntVect(1), crse_period);
+
+        mf.setVal(0._rt);
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi(mf, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            Array4<Real> const& arr = mf.array(mfi);
+            // mf is 0 here, so that it only receives the interpolated coarse field
+            Array4<Real const> const& arr_zero = mf.const_array(mfi);
+            Array4<Real const> const& arr_crse = ctmp.const_array(mfi);
+            amrex::ParallelFor(mfi.tilebox(), ncomp,
+            [=] AMREX_GPU_DEVICE (int j, int k, int l, int n)
+            {
+                warpx_interp(j, k, l, arr, arr_zero, arr_crse, stag, rr, n);
+            });
+        }
+
+        if (old) mf.ParallelCopy(*old, 0, 0, ncomp, IntVect(0), IntVect(0), period);
+        mf.FillBoundary(period);
+    }
+
+    /** Weights `wt` of the heuristic costs terms fitted by least squares, from the normal
+     *  equations (A^T A) wt = A^T b, where A^T A is `ata` (row-major) and A^T b is `atb`.
+     *  The terms that are 0 on all the boxes, collinear with other terms, or whose weight
+     *  would not be positive, are left out one by one, with a weight 0.
+     *  \return whether a weight is positive */
+    bool FitCostsHeuristicWeights (std::array<double,CostsHeuristicTerm::N*CostsHeuristicTerm::N> const& ata,
+                                   std::array<double,CostsHeuristicTerm::N> const& atb,
+                                   std::array<double,CostsHeuristicTerm::N>& wt)
+    {
+        constexpr int nt = CostsHeuristicTerm::N;
+        std::array<bool,nt> active;
+        for (int a = 0; a < nt; ++a) active[a] = ata[a*nt+a] > 0.;
+
+        while (true)
+        {
+            wt.fill(0.);
+            Vector<int> terms;
+            for (int a = 0; a < nt; ++a) {
+                if (active[a]) terms.push_back(a);
+            }
+            const int n = static_cast<int>(terms.size());
+            if (n == 0) return false;
+
+            // augmented matrix of the equations of the active terms, scaled by their diagonal
+            Vector<double> m(n*(n+1));
+            Vector<double> scale(n);
+            for (int r = 0; r < n; ++r) scale[r] = std::sqrt(ata[terms[r]*nt+terms[r]]);
+            for (int r = 0; r < n; ++r) {
+                for (int c = 0; c < n; ++c) {
+                    m[r*(n+1)+c] = ata[terms[r]*nt+terms[c]]/(scale[r]*scale[c]);
+                }
+                m[r*(n+1)+n] = atb[terms[r]]/scale[r];
+            }
+
+            // Gaussian elimination with partial pivoting
+            int collinear = -1;
+            for (int k = 0; k < n && collinear < 0; ++k) {
+                int p = k;
+                for (int r = k+1; r < n; ++r) {
+                    if (std::abs(m[r*(n+1)+k]) > std::abs(m[p*(n+1)+k])) p = r;
+                }
+                if (std::abs(m[p*(n+1)+k]) < 1.e-12) {
+                    collinear = k;
+                    break;
+                }
+                for (int c = 0; c <= n; ++c) std::swap(m[k*(n+1)+c], m[p*(n+1)+c]);
+                for (int r = k+1; r < n; ++r) {
+                    const double f = m[r*(n+1)+k]/m[k*(n+1)+k];
+                    for (int c = k; c <= n; ++c) m[r*(n+1)+c] -= f*m[k*(n+1)+c];
+                }
+            }
+            if (collinear >= 0) {
+                active[terms[collinear]] = false;
+                continue;
+            }
+            Vector<double> x(n);
+            for (int r = n-1; r >= 0; --r) {
+                double sum = m[r*(n+1)+n];
+                for (int c = r+1; c < n; ++c) sum -= m[r*(n+1)+c]*x[c];
+                x[r] = sum/m[r*(n+1)+r];
+            }
+
+            // leave out the term with the most negative weight, if any
+            int most_negative = -1;
+            for (int r = 0; r < n; ++r) {
+                wt[terms[r]] = x[r]/scale[r];
+                if (wt[terms[r]] <= 0. &&
+                    (most_negative < 0 || wt[terms[r]] < wt[terms[most_negative]])) {
+                    most_negative = r;
+                }
+            }
+            if (most_negative < 0) return true;
+            active[terms[most_negative]] = false;
+        }
+    }
+}
+
 void
 WarpX::LoadBalance ()
 {
     WARPX_PROFILE_REGION("LoadBalance");
     WARPX_PROFILE("WarpX::LoadBalance()");
+    PhaseTimer timer(TimerPhase::LoadBalance);
 
     AMREX_ALWAYS_ASSERT(costs[0] != nullptr);
 
@@ -48,23 +177,36 @@ WarpX::LoadBalance ()
         amrex::Real currentEfficiency = 0.0;
         amrex::Real proposedEfficiency = 0.0;
 
-        newdm = (load_balance_with_sfc)
-            ? DistributionMapping::makeSFC(*costs[lev],
-                                           currentEfficiency, proposedEfficiency,
-                                           false,
-                                           ParallelDescriptor::IOProcessorNumber())
-            : DistributionMapping::makeKnapSack(*costs[lev],
-                                                currentEfficiency, proposedEfficiency,
-                                                nmax,
-                                                false,
-                                                ParallelDescriptor::IOProcessorNumber());
-        // As specified in the above calls to makeSFC and makeKnapSack, the new
-        // distribution mapping is NOT communicated to all ranks; the loadbalanced
-        // dm is up-to-date only on root, and we can decide whether to broadcast
-        if ((load_balance_efficiency_ratio_threshold > 0.0)
-            && (ParallelDescriptor::MyProc() == ParallelDescriptor::IOProcessorNumber()))
+        if (load_balance_hierarchical)
+        {
+            const bool pays_off = HierarchicalDistributionMapping(lev, newdm,
+                                                                  currentEfficiency,
+                                                                  proposedEfficiency);
+            if (ParallelDescriptor::MyProc() == ParallelDescriptor::IOProcessorNumber())
+            {
+                doLoadBalance = pays_off;
+            }
+        }
+        else
         {
-            doLoadBalance = (proposedEfficiency > load_balance_efficiency_ratio_threshold*currentEfficiency);
+            newdm = (load_balance_with_sfc)
+                ? DistributionMapping::makeSFC(*costs[lev],
+                                               currentEfficiency, proposedEfficiency,
+                                               false,
+                                               ParallelDescriptor::IOProcessorNumber())
+                : DistributionMapping::makeKnapSack(*costs[lev],
+                                                    currentEfficiency, proposedEfficiency,
+                                                    nmax,
+                                                    false,
+                                                    ParallelDescriptor::IOProcessorNumber());
+            // As specified in the above calls to makeSFC and makeKnapSack, the new
+            // distribution mapping is NOT communicated to all ranks; the loadbalanced
+            // dm is up-to-date only on root, and we can decide whether to broadcast
+            if ((load_balance_efficiency_ratio_threshold > 0.0)
+                && (ParallelDescriptor::MyProc() == ParallelDescriptor::IOProcessorNumber()))
+            {
+                doLoadBalance = (proposedEfficiency > load_balance_efficiency_ratio_threshold*currentEfficiency);
+            }
         }
 
         ParallelDescriptor::Bcast(&doLoadBalance, 1,
@@ -97,14 +239,129 @@ WarpX::LoadBalance ()
     {
         mypc->Redistribute();
         mypc->defineAllParticleTiles();
+        m_rho_old_is_valid = false;
+    }
+#endif
+}
+
+
+bool
+WarpX::HierarchicalDistributionMapping (int lev, DistributionMapping& newdm,
+                                        Real& currentEfficiency, Real& proposedEfficiency)
+{
+    const int ioproc = ParallelDescriptor::IOProcessorNumber();
+    const BoxArray& ba = boxArray(lev);
+    const int nboxes = ba.size();
+
+    // Cost of each box per step: the timers costs are a running average,
+    // decayed by (1 - 2/period) at each step
+    Real cost_factor = 1._rt;
+    if (load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+    {
+        const int period = load_balance_intervals.localPeriod(istep[0]+1);
+        if (period > 2) cost_factor = 2._rt/period;
+    }
+    Vector<Real> cost(nboxes, 0._rt);
+    for (int i : costs[lev]->IndexArray())
+    {
+        cost[i] = (*costs[lev])[i]*cost_factor;
+    }
+    ParallelDescriptor::ReduceRealSum(cost.data(), nboxes, ioproc);
+
+    // Size of the particle data of each box
+    Vector<Real> bytes(nboxes, 0._rt);
+    for (int ispecies = 0; ispecies < mypc->nSpecies(); ++ispecies)
+    {
+        const auto& pc = mypc->GetParticleContainer(ispecies);
+        const Real particle_bytes = sizeof(WarpXParticleContainer::ParticleType)
+            + pc.NumRealComps()*sizeof(ParticleReal) + pc.NumIntComps()*sizeof(int);
+        const bool only_valid = true, only_local = true;
+        const Vector<Long> np = pc.NumberOfParticlesInGrid(lev, only_valid, only_local);
+        for (int i = 0; i < nboxes; ++i) bytes[i] += np[i]*particle_bytes;
+    }
+    ParallelDescriptor::ReduceRealSum(bytes.data(), nboxes, ioproc);
+
+    // Node of each rank, numbered by the order of their lowest rank
+    const int nprocs = ParallelDescriptor::NProcs();
+    Vector<int> rank_node(nprocs, 0);
+#ifdef AMREX_USE_MPI
+    {
+        MPI_Comm node_comm;
+        MPI_Comm_split_type(ParallelDescriptor::Communicator(), MPI_COMM_TYPE_SHARED,
+                            ParallelDescriptor::MyProc(), MPI_INFO_NULL, &node_comm);
+        int leader = ParallelDescriptor::MyProc();
+        MPI_Allreduce(MPI_IN_PLACE, &leader, 1, MPI_INT, MPI_MIN, node_comm);
+        MPI_Comm_free(&node_comm);
+        MPI_Allgather(&leader, 1, MPI_INT, rank_node.data(), 1, MPI_INT,
+                      ParallelDescriptor::Communicator());
+        std::map<int,int> node_of_leader;
+        for (int& node : rank_node)
+        {
+            node = node_of_leader.emplace(node, node_of_leader.size()).first->second;
+        }
     }
 #endif
+
+    if (ParallelDescriptor::MyProc() != ioproc) return false;
+
+    // Size of the field data of each box, and size of the field data of one cell
+    // exchanged with the neighbours at each step (guard cells of E, B and J)
+    Real cell_bytes = 0._rt;
+    for (int idim = 0; idim < 3; ++idim)
+    {
+        for (const MultiFab* mf : {Efield_fp[lev][idim].get(), Bfield_fp[lev][idim].get(),
+                                   Efield_cp[lev][idim].get(), Bfield_cp[lev][idim].get(),
+                                   current_fp[lev][idim].get()})
+        {
+            if (mf == nullptr) continue;
+            for (int i = 0; i < nboxes; ++i)
+            {
+                bytes[i] += mf->fabbox(i).numPts()*mf->nComp()*sizeof(Real);
+            }
+        }
+        cell_bytes += (Efield_fp[lev][idim]->nComp() + Bfield_fp[lev][idim]->nComp()
+                       + current_fp[lev][idim]->nComp())*sizeof(Real);
+    }
+
+    // Halo of each box: the cells of its neighbours in its guard cells
+    // (the exchanges across periodic boundaries are not included)
+    const IntVect ng = Efield_fp[lev][0]->nGrowVect();
+    Vector<Vector<std::pair<int,Real>>> halo(nboxes);
+    for (int i = 0; i < nboxes; ++i)
+    {
+        for (auto const& isect : ba.intersections(amrex::grow(ba[i], ng)))
+        {
+            if (isect.first == i) continue;
+            halo[i].emplace_back(isect.first, isect.second.numPts()*cell_bytes);
+        }
+    }
+
+    // Number of steps until the next load balancing
+    const int step = istep[0];
+    const Real horizon = std::max(1, std::min(load_balance_intervals.nextContains(step+1),
+                                              max_step) - (step+1));
+
+    const HierarchicalLoadBalancer balancer(load_balance_cost_per_byte,
+                                            load_balance_intranode_factor);
+    Vector<int> pmap;
+    const bool pays_off = balancer.Balance(DistributionMap(lev).ProcessorMap(), rank_node,
+                                           cost, bytes, halo, horizon, pmap,
+                                           currentEfficiency, proposedEfficiency);
+    newdm = DistributionMapping(pmap);
+    return pays_off;
 }
 
 
 void
 WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const DistributionMapping& dm)
 {
+    // the recorded kernels of the field push refer to the fields before the regrid
+    m_gpu_graphs.clear();
+    // so do the patterns of the persistent exchanges
+    PersistentExchange::Clear();
+    // rho_fp is not migrated, so rho_new of the last step cannot be reused (see ReuseRhoOld)
+    m_rho_old_is_valid = false;
+
     if (ba == boxArray(lev))
     {
         if (ParallelDescriptor::NProcs() == 1) return;
@@ -117,54 +374,32 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
         m_field_factory[lev] = std::make_unique<FArrayBoxFactory>();
 #endif
 
+        // The fields are migrated in place: only the boxes that change rank are
+        // allocated again, and their data is sent if it is needed after the load balance
         // Fine patch
         for (int idim=0; idim < 3; ++idim)
         {
+            WarpXMigrate(Bfield_fp[lev][idim], dm, true);
+            WarpXMigrate(Efield_fp[lev][idim], dm, true);
+            WarpXMigrate(current_fp[lev][idim], dm, false);
+            if (current_store[lev][idim]) WarpXMigrate(current_store[lev][idim], dm, false);
+            // The time-averaged fields are recomputed by the PSATD push
+            WarpXMigrate(Bfield_avg_fp[lev][idim], dm, false);
+            WarpXMigrate(Efield_avg_fp[lev][idim], dm, false);
+#ifdef WARPX_MAG_LLG
+            WarpXMigrate(Mfield_fp[lev][idim], dm, true);
+            WarpXMigrate(Hfield_fp[lev][idim], dm, true);
+            if (H_biasfield_fp[lev][idim]) WarpXMigrate(H_biasfield_fp[lev][idim], dm, true);
+            if (lev < static_cast<int>(Hfield_excitation_profile.size())
+                && Hfield_excitation_profile[lev][idim])
             {
-                const IntVect& ng = Bfield_fp[lev][idim]->nGrowVect();
-                auto pmf = std::make_unique<MultiFab>(Bfield_fp[lev][idim]->boxArray(),
-                                                                  dm, Bfield_fp[lev][idim]->nComp(), ng);
-                pmf->Redistribute(*Bfield_fp[lev][idim], 0, 0, Bfield_fp[lev][idim]->nComp(), ng);
-                Bfield_fp[lev][idim] = std::move(pmf);
-            }
-            {
-                const IntVect& ng = Efield_fp[lev][idim]->nGrowVect();
-                auto pmf = std::make_unique<MultiFab>(Efield_fp[lev][idim]->boxArray(),
-                                                                  dm, Efield_fp[lev][idim]->nComp(), ng);
-                pmf->Redistribute(*Efield_fp[lev][idim], 0, 0, Efield_fp[lev][idim]->nComp(), ng);
-                Efield_fp[lev][idim] = std::move(pmf);
-            }
-            {
-                const IntVect& ng = current_fp[lev][idim]->nGrowVect();
-                auto pmf = std::make_unique<MultiFab>(current_fp[lev][idim]->boxArray(),
-                                                                  dm, current_fp[lev][idim]->nComp(), ng);
-                current_fp[lev][idim] = std::move(pmf);
-            }
-            if (current_store[lev][idim])
-            {
-                const IntVect& ng = current_store[lev][idim]->nGrowVect();
-                auto pmf = std::make_unique<MultiFab>(current_store[lev][idim]->boxArray(),
-                                                                  dm, current_store[lev][idim]->nComp(), ng);
-                // no need to redistribute
-                current_store[lev][idim] = std::move(pmf);
+                WarpXMigrate(Hfield_excitation_profile[lev][idim], dm, true);
             }
+#endif
         }
 
-        if (F_fp[lev] != nullptr) {
-            const IntVect& ng = F_fp[lev]->nGrowVect();
-            auto pmf = std::make_unique<MultiFab>(F_fp[lev]->boxArray(),
-                                                              dm, F_fp[lev]->nComp(), ng);
-            pmf->Redistribute(*F_fp[lev], 0, 0, F_fp[lev]->nComp(), ng);
-            F_fp[lev] = std::move(pmf);
-        }
-
-        if (rho_fp[lev] != nullptr) {
-            const int nc = rho_fp[lev]->nComp();
-            const IntVect& ng = rho_fp[lev]->nGrowVect();
-            auto pmf = std::make_unique<MultiFab>(rho_fp[lev]->boxArray(),
-                                                              dm, nc, ng);
-            rho_fp[lev] = std::move(pmf);
-        }
+        if (F_fp[lev] != nullptr) WarpXMigrate(F_fp[lev], dm, true);
+        if (rho_fp[lev] != nullptr) WarpXMigrate(rho_fp[lev], dm, false);
 
         // Aux patch
         if (lev == 0 && Bfield_aux[0][0]->ixType() == Bfield_fp[0][0]->ixType())
@@ -172,23 +407,33 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
             for (int idim = 0; idim < 3; ++idim) {
                 Bfield_aux[lev][idim] = std::make_unique<MultiFab>(*Bfield_fp[lev][idim], amrex::make_alias, 0, Bfield_aux[lev][idim]->nComp());
                 Efield_aux[lev][idim] = std::make_unique<MultiFab>(*Efield_fp[lev][idim], amrex::make_alias, 0, Efield_aux[lev][idim]->nComp());
+                Bfield_avg_aux[lev][idim] = std::make_unique<MultiFab>(*Bfield_avg_fp[lev][idim], amrex::make_alias, 0, Bfield_avg_aux[lev][idim]->nComp());
+                Efield_avg_aux[lev][idim] = std::make_unique<MultiFab>(*Efield_avg_fp[lev][idim], amrex::make_alias, 0, Efield_avg_aux[lev][idim]->nComp());
+#ifdef WARPX_MAG_LLG
+                Mfield_aux[lev][idim] = std::make_unique<MultiFab>(*Mfield_fp[lev][idim], amrex::make_alias, 0, Mfield_aux[lev][idim]->nComp());
+                Hfield_aux[lev][idim] = std::make_unique<MultiFab>(*Hfield_fp[lev][idim], amrex::make_alias, 0, Hfield_aux[lev][idim]->nComp());
+                if (H_biasfield_fp[lev][idim]) H_biasfield_aux[lev][idim] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][idim], amrex::make_alias, 0, H_biasfield_aux[lev][idim]->nComp());
+#endif
             }
         } else {
             for (int idim=0; idim < 3; ++idim)
             {
+#ifdef WARPX_MAG_LLG
+                WarpXMigrate(Mfield_aux[lev][idim], dm, false);
+                WarpXMigrate(Hfield_aux[lev][idim], dm, false);
+                if (H_biasfield_aux[lev][idim]) WarpXMigrate(H_biasfield_aux[lev][idim], dm, false);
+#endif
+                WarpXMigrate(Bfield_aux[lev][idim], dm, false);
+                WarpXMigrate(Efield_aux[lev][idim], dm, false);
+                // On a nodal aux grid, the time-averaged aux fields alias the aux fields
+                if (field_gathering_algo == GatheringAlgo::MomentumConserving && !do_nodal)
                 {
-                    const IntVect& ng = Bfield_aux[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(Bfield_aux[lev][idim]->boxArray(),
-                                                                      dm, Bfield_aux[lev][idim]->nComp(), ng);
-                    // pmf->Redistribute(*Bfield_aux[lev][idim], 0, 0, Bfield_aux[lev][idim]->nComp(), ng);
-                    Bfield_aux[lev][idim] = std::move(pmf);
-                }
+                    Bfield_avg_aux[lev][idim] = std::make_unique<MultiFab>(*Bfield_aux[lev][idim], amrex::make_alias, 0, Bfield_aux[lev][idim]->nComp());
+                    Efield_avg_aux[lev][idim] = std::make_unique<MultiFab>(*Efield_aux[lev][idim], amrex::make_alias, 0, Efield_aux[lev][idim]->nComp());
+                } else
                 {
-                    const IntVect& ng = Efield_aux[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(Efield_aux[lev][idim]->boxArray(),
-                                                                      dm, Efield_aux[lev][idim]->nComp(), ng);
-                    // pmf->Redistribute(*Efield_aux[lev][idim], 0, 0, Efield_aux[lev][idim]->nComp(), ng);
-                    Efield_aux[lev][idim] = std::move(pmf);
+                    WarpXMigrate(Bfield_avg_aux[lev][idim], dm, false);
+                    WarpXMigrate(Efield_avg_aux[lev][idim], dm, false);
                 }
             }
         }
@@ -197,101 +442,69 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
         if (lev > 0) {
             for (int idim=0; idim < 3; ++idim)
             {
-                {
-                    const IntVect& ng = Bfield_cp[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(Bfield_cp[lev][idim]->boxArray(),
-                                                                      dm, Bfield_cp[lev][idim]->nComp(), ng);
-                    pmf->Redistribute(*Bfield_cp[lev][idim], 0, 0, Bfield_cp[lev][idim]->nComp(), ng);
-                    Bfield_cp[lev][idim] = std::move(pmf);
-                }
-                {
-                    const IntVect& ng = Efield_cp[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(Efield_cp[lev][idim]->boxArray(),
-                                                                      dm, Efield_cp[lev][idim]->nComp(), ng);
-                    pmf->Redistribute(*Efield_cp[lev][idim], 0, 0, Efield_cp[lev][idim]->nComp(), ng);
-                    Efield_cp[lev][idim] = std::move(pmf);
-                }
-                {
-                    const IntVect& ng = current_cp[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(current_cp[lev][idim]->boxArray(),
-                                                                       dm, current_cp[lev][idim]->nComp(), ng);
-                    current_cp[lev][idim] = std::move(pmf);
-                }
-            }
-
-            if (F_cp[lev] != nullptr) {
-                const IntVect& ng = F_cp[lev]->nGrowVect();
-                auto pmf = std::make_unique<MultiFab>(F_cp[lev]->boxArray(),
-                                                                  dm, F_cp[lev]->nComp(), ng);
-                pmf->Redistribute(*F_cp[lev], 0, 0, F_cp[lev]->nComp(), ng);
-                F_cp[lev] = std::move(pmf);
+                WarpXMigrate(Bfield_cp[lev][idim], dm, true);
+                WarpXMigrate(Efield_cp[lev][idim], dm, true);
+                WarpXMigrate(current_cp[lev][idim], dm, false);
+                WarpXMigrate(Bfield_avg_cp[lev][idim], dm, false);
+                WarpXMigrate(Efield_avg_cp[lev][idim], dm, false);
+#ifdef WARPX_MAG_LLG
+                WarpXMigrate(Mfield_cp[lev][idim], dm, true);
+                WarpXMigrate(Hfield_cp[lev][idim], dm, true);
+                if (H_biasfield_cp[lev][idim]) WarpXMigrate(H_biasfield_cp[lev][idim], dm, true);
+#endif
             }
 
-            if (rho_cp[lev] != nullptr) {
-                const int nc = rho_cp[lev]->nComp();
-                const IntVect& ng = rho_cp[lev]->nGrowVect();
-                auto pmf  = std::make_unique<MultiFab>(rho_cp[lev]->boxArray(),
-                                                                  dm, nc, ng);
-                rho_cp[lev] = std::move(pmf);
-            }
+            if (F_cp[lev] != nullptr) WarpXMigrate(F_cp[lev], dm, true);
+            if (rho_cp[lev] != nullptr) WarpXMigrate(rho_cp[lev], dm, false);
         }
 
         if (lev > 0 && (n_field_gather_buffer > 0 || n_current_deposition_buffer > 0)) {
             for (int idim=0; idim < 3; ++idim)
             {
-                if (Bfield_cax[lev][idim])
-                {
-                    const IntVect& ng = Bfield_cax[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(Bfield_cax[lev][idim]->boxArray(),
-                                                                      dm, Bfield_cax[lev][idim]->nComp(), ng);
-                    // pmf->ParallelCopy(*Bfield_cax[lev][idim], 0, 0, Bfield_cax[lev][idim]->nComp(), ng, ng);
-                    Bfield_cax[lev][idim] = std::move(pmf);
-                }
-                if (Efield_cax[lev][idim])
-                {
-                    const IntVect& ng = Efield_cax[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(Efield_cax[lev][idim]->boxArray(),
-                                                                      dm, Efield_cax[lev][idim]->nComp(), ng);
-                    // pmf->ParallelCopy(*Efield_cax[lev][idim], 0, 0, Efield_cax[lev][idim]->nComp(), ng, ng);
-                    Efield_cax[lev][idim] = std::move(pmf);
-                }
-                if (current_buf[lev][idim])
-                {
-                    const IntVect& ng = current_buf[lev][idim]->nGrowVect();
-                    auto pmf = std::make_unique<MultiFab>(current_buf[lev][idim]->boxArray(),
-                                                                      dm, current_buf[lev][idim]->nComp(), ng);
-                    // pmf->ParallelCopy(*current_buf[lev][idim], 0, 0, current_buf[lev][idim]->nComp(), ng, ng);
-                    current_buf[lev][idim] = std::move(pmf);
-                }
+                if (Bfield_cax[lev][idim]) WarpXMigrate(Bfield_cax[lev][idim], dm, false);
+                if (Efield_cax[lev][idim]) WarpXMigrate(Efield_cax[lev][idim], dm, false);
+                if (current_buf[lev][idim]) WarpXMigrate(current_buf[lev][idim], dm, false);
             }
-            if (charge_buf[lev])
-            {
-                const IntVect& ng = charge_buf[lev]->nGrowVect();
-                auto pmf = std::make_unique<MultiFab>(charge_buf[lev]->boxArray(),
-                                                                  dm, charge_buf[lev]->nComp(), ng);
-                // pmf->ParallelCopy(*charge_buf[lev][idim], 0, 0, charge_buf[lev]->nComp(), ng, ng);
-                charge_buf[lev] = std::move(pmf);
-            }
-            if (current_buffer_masks[lev])
-            {
-                const IntVect& ng = current_buffer_masks[lev]->nGrowVect();
-                auto pmf = std::make_unique<iMultiFab>(current_buffer_masks[lev]->boxArray(),
-                                                                    dm, current_buffer_masks[lev]->nComp(), ng);
-                // pmf->ParallelCopy(*current_buffer_masks[lev], 0, 0, current_buffer_masks[lev]->nComp(), ng, ng);
-                current_buffer_masks[lev] = std::move(pmf);
+            if (charge_buf[lev]) WarpXMigrate(charge_buf[lev], dm, false);
+            if (current_buffer_masks[lev]) WarpXMigrate(current_buffer_masks[lev], dm, false);
+            if (gather_buffer_masks[lev]) WarpXMigrate(gather_buffer_masks[lev], dm, false);
+        }
+
+#ifdef WARPX_USE_PSATD
+        // The spectral solvers (FFT plans, k vectors and PSATD coefficients) are defined
+        // on the local boxes, and are thus rebuilt on the new DistributionMapping
+        if (WarpX::maxwell_solver_id == MaxwellSolverAlgo::PSATD)
+        {
+            if (spectral_solver_fp[lev] != nullptr) {
+                AllocLevelSpectralSolver(lev, PatchType::fine, ba, dm, CellSize(lev));
             }
-            if (gather_buffer_masks[lev])
-            {
-                const IntVect& ng = gather_buffer_masks[lev]->nGrowVect();
-                auto pmf = std::make_unique<iMultiFab>(gather_buffer_masks[lev]->boxArray(),
-                                                                    dm, gather_buffer_masks[lev]->nComp(), ng);
-                // pmf->ParallelCopy(*gather_buffer_masks[lev], 0, 0, gather_buffer_masks[lev]->nComp(), ng, ng);
-                gather_buffer_masks[lev] = std::move(pmf);
+            if (lev > 0 && spectral_solver_cp[lev] != nullptr) {
+                BoxArray cba = ba;
+                cba.coarsen(refRatio(lev-1));
+                AllocLevelSpectralSolver(lev, PatchType::coarse, cba, dm, CellSize(lev-1));
             }
         }
+#endif
+
+#ifdef AMREX_USE_EB
+        // The classification of the boxes by the embedded boundary follows the new factory
+        if (m_fdtd_solver_fp[lev]) m_fdtd_solver_fp[lev]->SetEB(fieldEBFactory(lev));
+#endif
+
+#ifdef WARPX_MAG_LLG
+        // The scratch fields of the 2nd-order LLG scheme are re-allocated on the new
+        // DistributionMapping at the next call of MacroscopicEvolveHM_2nd
+        if (m_fdtd_solver_fp[lev]) m_fdtd_solver_fp[lev]->ClearLLGScratchFields();
+        if (lev > 0 && m_fdtd_solver_cp[lev]) m_fdtd_solver_cp[lev]->ClearLLGScratchFields();
+#endif
+
+        // The material properties are redistributed like the fields
+        if (m_macroscopic_properties) m_macroscopic_properties->RemakeLevel(lev, dm);
 
         if (costs[lev] != nullptr)
         {
+            // No pending timer may refer to the old costs
+            BoxCostTimer::Flush();
             costs[lev] = std::make_unique<LayoutData<Real>>(ba, dm);
             for (int i : costs[lev]->IndexArray())
             {
@@ -304,39 +517,245 @@ WarpX::RemakeLevel (int lev, Real /*time*/, const BoxArray& ba, const Distributi
 
     } else
     {
-        amrex::Abort("RemakeLevel: to be implemented");
+        // The grids of the level changed in a regrid, see Regrid
+        RegridLevel(lev, ba, dm, false);
     }
     // Re-initialize diagnostic functors that stores pointers to the user-requested fields at level, lev.
     multi_diags->InitializeFieldFunctors( lev );
 }
 
 void
-WarpX::ComputeCostsHeuristic (amrex::Vector<std::unique_ptr<amrex::LayoutData<amrex::Real> > >& a_costs)
+WarpX::MakeNewLevelFromCoarse (int lev, Real time, const BoxArray& ba, const DistributionMapping& dm)
 {
-    for (int lev = 0; lev <= finest_level; ++lev)
+    m_gpu_graphs.clear();
+
+    RegridLevel(lev, ba, dm, true);
+
+    t_new[lev] = time;
+    t_old[lev] = time - dt[lev];
+    istep[lev] = istep[lev-1];
+
+    multi_diags->InitializeFieldFunctors( lev );
+}
+
+void
+WarpX::RegridLevel (int lev, const BoxArray& ba, const DistributionMapping& dm, bool is_new)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(lev > 0, "RegridLevel: the grids of level 0 are fixed");
+
+    // The fields of the fine or coarse patch of a level that are carried over;
+    // the current, charge and time-averaged fields are recomputed at each step
+    auto const patch_fields = [this] (int l, PatchType patch_type)
+    {
+        const bool fine = (patch_type == PatchType::fine);
+        Vector<std::unique_ptr<MultiFab>*> fields;
+        for (int idim = 0; idim < 3; ++idim)
+        {
+            fields.push_back(fine ? &Efield_fp[l][idim] : &Efield_cp[l][idim]);
+            fields.push_back(fine ? &Bfield_fp[l][idim] : &Bfield_cp[l][idim]);
+#ifdef WARPX_MAG_LLG
+            fields.push_back(fine ? &Mfield_fp[l][idim] : &Mfield_cp[l][idim]);
+            fields.push_back(fine ? &Hfield_fp[l][idim] : &Hfield_cp[l][idim]);
+            fields.push_back(fine ? &H_biasfield_fp[l][idim] : &H_biasfield_cp[l][idim]);
+#endif
+        }
+        fields.push_back(fine ? &F_fp[l] : &F_cp[l]);
+        return fields;
+    };
+
+    // The old fields are kept until the new ones are filled
+    Vector<std::unique_ptr<MultiFab> > old_fp, old_cp;
+    if (!is_new)
+    {
+        for (auto* field : patch_fields(lev, PatchType::fine)) old_fp.push_back(std::move(*field));
+        for (auto* field : patch_fields(lev, PatchType::coarse)) old_cp.push_back(std::move(*field));
+    }
+
+    // rho_fp is reset below, so rho_new of the last step cannot be reused (see ReuseRhoOld)
+    m_rho_old_is_valid = false;
+
+    SetBoxArray(lev, ba);
+    SetDistributionMap(lev, dm);
+    ClearLevel(lev);
+    AllocLevelData(lev, ba, dm);
+
+    // The coarse patch has the resolution of level lev-1, and is thus copied from its fine patch
+    auto const crse = patch_fields(lev-1, PatchType::fine);
+    auto const fp = patch_fields(lev, PatchType::fine);
+    auto const cp = patch_fields(lev, PatchType::coarse);
+    const Periodicity crse_period = Geom(lev-1).periodicity();
+    const Periodicity fine_period = Geom(lev).periodicity();
+    for (int i = 0; i < static_cast<int>(crse.size()); ++i)
+    {
+        if (*crse[i] == nullptr) continue;
+        if (*fp[i]) {
+            FillFromCoarse(**fp[i], **crse[i], (is_new) ? nullptr : old_fp[i].get(),
+                           refRatio(lev-1), crse_period, fine_period);
+        }
+        if (*cp[i]) {
+            FillFromCoarse(**cp[i], **crse[i], (is_new) ? nullptr : old_cp[i].get(),
+                           IntVect(1), crse_period, crse_period);
+        }
+    }
+
+    // The aux fields are computed at the start of the next step, see UpdateAuxilaryData
+    for (int idim = 0; idim < 3; ++idim)
     {
-        const auto & mypc_ref = WarpX::GetInstance().GetPartContainer();
-        const auto nSpecies = mypc_ref.nSpecies();
+        current_fp[lev][idim]->setVal(0._rt);
+        if (current_cp[lev][idim]) current_cp[lev][idim]->setVal(0._rt);
+        if (current_buf[lev][idim]) current_buf[lev][idim]->setVal(0._rt);
+        if (current_store[lev][idim]) current_store[lev][idim]->setVal(0._rt);
+        Efield_aux[lev][idim]->setVal(0._rt);
+        Bfield_aux[lev][idim]->setVal(0._rt);
+    }
+    if (rho_fp[lev]) rho_fp[lev]->setVal(0._rt);
+    if (rho_cp[lev]) rho_cp[lev]->setVal(0._rt);
+    if (charge_buf[lev]) charge_buf[lev]->setVal(0._rt);
+}
+
+void
+WarpX::Regrid ()
+{
+    WARPX_PROFILE("WarpX::Regrid()");
+    // the regridding moves the data between the MPI ranks like the load balancing
+    PhaseTimer timer(TimerPhase::LoadBalance);
+
+    const int old_finest_level = finest_level;
+    Vector<BoxArray> old_grids(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev) old_grids[lev] = boxArray(lev);
 
-        // Species loop
-        for (int i_s = 0; i_s < nSpecies; ++i_s)
+    // Tag the cells with ErrorEst, and remake, create or delete the levels above 0
+    regrid(0, t_new[0]);
+
+    bool changed = (finest_level != old_finest_level);
+    for (int lev = 1; lev <= finest_level; ++lev)
+    {
+        if (lev <= old_finest_level && boxArray(lev) == old_grids[lev]) continue;
+        changed = true;
+        if (do_pml)
         {
-            auto & myspc = mypc_ref.GetParticleContainer(i_s);
+            InitPMLLevel(lev);
+            pml[lev]->ComputePMLFactors(dt[lev]);
+        }
+        if (m_macroscopic_properties) m_macroscopic_properties->RegridLevel(lev);
+    }
+    for (int lev = finest_level+1; lev <= old_finest_level; ++lev)
+    {
+        if (do_pml) pml[lev].reset();
+    }
+    if (!changed) return;
 
-            // Particle loop
-            for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti)
+    if (verbose) {
+        for (int lev = 1; lev <= finest_level; ++lev) {
+            amrex::Print() << "Regrid: level " << lev << " has " << boxArray(lev).size()
+                           << " boxes and " << boxArray(lev).numPts() << " cells\n";
+        }
+    }
+
+    // The particles are moved to their new levels and boxes
+    mypc->Redistribute();
+    mypc->defineAllParticleTiles();
+
+    BuildBufferMasks();
+
+    // The output buffers are defined on the new grids
+    multi_diags->RemakeLevels();
+}
+
+void
+WarpX::ComputeCostsHeuristic (amrex::Vector<std::unique_ptr<amrex::LayoutData<amrex::Real> > >& a_costs)
+{
+    std::array<Real,CostsHeuristicTerm::N> wt;
+    wt[CostsHeuristicTerm::Particles] = costs_heuristic_particles_wt;
+    wt[CostsHeuristicTerm::Cells] = costs_heuristic_cells_wt;
+    wt[CostsHeuristicTerm::MacroscopicCells] = costs_heuristic_macroscopic_cells_wt;
+#ifdef WARPX_MAG_LLG
+    wt[CostsHeuristicTerm::MagCells] = costs_heuristic_mag_cells_wt;
+#else
+    wt[CostsHeuristicTerm::MagCells] = 0._rt;
+#endif
+
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        LayoutData<std::array<Real,CostsHeuristicTerm::N> > terms(
+            a_costs[lev]->boxArray(), a_costs[lev]->DistributionMap());
+        ComputeCostsHeuristicTerms(lev, terms);
+        for (int i : a_costs[lev]->IndexArray())
+        {
+            for (int it = 0; it < CostsHeuristicTerm::N; ++it)
             {
-                (*a_costs[lev])[pti.index()] += costs_heuristic_particles_wt*pti.numParticles();
+                // the terms that do not apply (e.g. without the macroscopic solver) are 0
+                if (terms[i][it] > 0._rt) (*a_costs[lev])[i] += wt[it]*terms[i][it];
             }
         }
+    }
+}
+
+void
+WarpX::ComputeCostsHeuristicTerms (
+    int lev, amrex::LayoutData<std::array<amrex::Real,CostsHeuristicTerm::N> >& terms)
+{
+    for (int i : terms.IndexArray()) terms[i].fill(0._rt);
+
+    const auto & mypc_ref = WarpX::GetInstance().GetPartContainer();
+    const auto nSpecies = mypc_ref.nSpecies();
+
+    // Species loop
+    for (int i_s = 0; i_s < nSpecies; ++i_s)
+    {
+        auto & myspc = mypc_ref.GetParticleContainer(i_s);
+
+        // Particle loop
+        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti)
+        {
+            terms[pti.index()][CostsHeuristicTerm::Particles] += pti.numParticles();
+        }
+    }
 
-        //Cell loop
-        MultiFab* Ex = Efield_fp[lev][0].get();
+    //Cell loop
+    MultiFab* Ex = Efield_fp[lev][0].get();
+    for (MFIter mfi(*Ex, false); mfi.isValid(); ++mfi)
+    {
+        const Box& gbx = mfi.growntilebox();
+        terms[mfi.index()][CostsHeuristicTerm::Cells] += gbx.numPts();
+    }
+
+    if (em_solver_medium == MediumForEM::Macroscopic)
+    {
+        // the macroscopic E update is done on all the cells
         for (MFIter mfi(*Ex, false); mfi.isValid(); ++mfi)
         {
             const Box& gbx = mfi.growntilebox();
-            (*a_costs[lev])[mfi.index()] += costs_heuristic_cells_wt*gbx.numPts();
+            terms[mfi.index()][CostsHeuristicTerm::MacroscopicCells] += gbx.numPts();
         }
+#ifdef WARPX_MAG_LLG
+        // the LLG update is done on the magnetic cells only (with macroscopic.mag_sparse_update = 1),
+        // as many times as the 2nd-order scheme iterates
+        Real iter_factor = 1._rt;
+        FiniteDifferenceSolver const * fdtd_solver = m_fdtd_solver_fp[lev].get();
+        if (mag_time_scheme_order == 2 && fdtd_solver && fdtd_solver->LLGIterationCalls() > 0) {
+            iter_factor = static_cast<Real>(fdtd_solver->LLGIterationCount())
+                          / static_cast<Real>(fdtd_solver->LLGIterationCalls());
+        }
+        m_macroscopic_properties->SetPatch(lev, PatchType::fine);
+        for (MFIter mfi(m_macroscopic_properties->getpatch_boxArray(),
+                        m_macroscopic_properties->getpatch_DistributionMap(), false); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.validbox();
+            MacroPropertyArray const Ms_arr = m_macroscopic_properties->getproperty_arr(mfi, MacroProp::Ms);
+            ReduceOps<ReduceOpSum> reduce_op;
+            ReduceData<Long> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(bx, reduce_data,
+                [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+                {
+                    return {(Ms_arr(i,j,k) > 0._rt) ? 1 : 0};
+                });
+            const Long n_mag_cells = amrex::get<0>(reduce_data.value());
+            terms[mfi.index()][CostsHeuristicTerm::MagCells] += iter_factor*n_mag_cells;
+        }
+        m_macroscopic_properties->SetPatch(0, PatchType::fine);
+#endif
     }
 }
 
@@ -352,3 +771,82 @@ WarpX::ResetCosts ()
         }
     }
 }
+
+void
+WarpX::CostsCalibrationBeginStep ()
+{
+    if (m_costs_calibration_steps_left <= 0) return;
+
+    m_costs_calibration_terms.resize(finest_level+1);
+    m_costs_calibration_start.resize(finest_level+1);
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        const LayoutData<Real>& cost = *costs[lev];
+        m_costs_calibration_terms[lev] = std::make_unique<LayoutData<std::array<Real,CostsHeuristicTerm::N> > >(
+            cost.boxArray(), cost.DistributionMap());
+        ComputeCostsHeuristicTerms(lev, *m_costs_calibration_terms[lev]);
+        m_costs_calibration_start[lev] = std::make_unique<LayoutData<Real> >(
+            cost.boxArray(), cost.DistributionMap());
+        for (int i : cost.IndexArray()) (*m_costs_calibration_start[lev])[i] = cost[i];
+    }
+}
+
+void
+WarpX::CostsCalibrationEndStep ()
+{
+    if (m_costs_calibration_steps_left <= 0) return;
+    constexpr int nt = CostsHeuristicTerm::N;
+
+    // the time of each box in this step is the increase of its cost
+    BoxCostTimer::Flush();
+    for (int lev = 0; lev <= finest_level; ++lev)
+    {
+        const LayoutData<Real>& cost = *costs[lev];
+        const auto& terms = *m_costs_calibration_terms[lev];
+        for (int i : cost.IndexArray())
+        {
+            const double time = cost[i] - (*m_costs_calibration_start[lev])[i];
+            for (int a = 0; a < nt; ++a)
+            {
+                m_costs_calibration_atb[a] += terms[i][a]*time;
+                for (int b = 0; b < nt; ++b)
+                {
+                    m_costs_calibration_ata[a*nt+b] += terms[i][a]*terms[i][b];
+                }
+            }
+        }
+    }
+    if (--m_costs_calibration_steps_left > 0) return;
+
+    ParallelDescriptor::ReduceRealSum(m_costs_calibration_ata.data(), nt*nt);
+    ParallelDescriptor::ReduceRealSum(m_costs_calibration_atb.data(), nt);
+    std::array<double,nt> wt;
+    if (FitCostsHeuristicWeights(m_costs_calibration_ata, m_costs_calibration_atb, wt))
+    {
+        costs_heuristic_particles_wt = static_cast<Real>(wt[CostsHeuristicTerm::Particles]);
+        costs_heuristic_cells_wt = static_cast<Real>(wt[CostsHeuristicTerm::Cells]);
+        costs_heuristic_macroscopic_cells_wt = static_cast<Real>(wt[CostsHeuristicTerm::MacroscopicCells]);
+#ifdef WARPX_MAG_LLG
+        costs_heuristic_mag_cells_wt = static_cast<Real>(wt[CostsHeuristicTerm::MagCells]);
+#endif
+        amrex::Print() << "Heuristic costs weights fitted over " << costs_heuristic_calibration_steps
+                       << " steps (s): particles " << costs_heuristic_particles_wt
+                       << ", cells " << costs_heuristic_cells_wt
+                       << ", macroscopic cells " << costs_heuristic_macroscopic_cells_wt
+#ifdef WARPX_MAG_LLG
+                       << ", magnetic cells " << costs_heuristic_mag_cells_wt
+#endif
+                       << "\n";
+    }
+    else
+    {
+        amrex::Print() << "WARNING: the heuristic costs weights could not be fitted to the timers;"
+                       << " the default weights are used\n";
+    }
+
+    // the costs are now computed with the heuristic at each load balancing
+    load_balance_costs_update_algo = LoadBalanceCostsUpdateAlgo::Heuristic;
+    ResetCosts();
+    m_costs_calibration_terms.clear();
+    m_costs_calibration_start.clear();
+}
@@ -17,92 +17,85 @@
 
 struct wp_parser* wp_c_parser_new (char const* function_body);
 
-#ifdef AMREX_USE_GPU
-
-template <int Depth, std::enable_if_t<(Depth<WARPX_PARSER_DEPTH), int> = 0>
-AMREX_GPU_DEVICE AMREX_NO_INLINE
-void wp_ast_update_device_ptr (struct wp_node* node, char* droot, char* hroot)
+/** Evaluate the bytecode compiled by wp_ast_compile, with a stack of at most
+ *  WARPX_PARSER_DEPTH values and at most wp_max_temps temporaries.
+ *
+ * \param[in] code instructions
+ * \param[in] ncode number of instructions
+ * \param[in] x values of the variables
+ */
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+amrex::Real
+wp_bytecode_eval (struct wp_instr const* code, int ncode, amrex::Real const* x)
 {
-    switch (node->type)
-    {
-    case WP_NUMBER:
-        break;
-    case WP_SYMBOL:
-    {
-        auto p = (struct wp_symbol*)node;
-        p->name = droot + (p->name - hroot);
-        break;
-    }
-    case WP_ADD:
-    case WP_SUB:
-    case WP_MUL:
-    case WP_DIV:
-    {
-        node->l = (wp_node*)(droot + ((char*)node->l - hroot));
-        node->r = (wp_node*)(droot + ((char*)node->r - hroot));
-        wp_ast_update_device_ptr<Depth+1>(node->l, droot, hroot);
-        wp_ast_update_device_ptr<Depth+1>(node->r, droot, hroot);
-        break;
-    }
-    case WP_NEG:
-    {
-        node->l = (wp_node*)(droot + ((char*)node->l - hroot));
-        wp_ast_update_device_ptr<Depth+1>(node->l, droot, hroot);
-        break;
-    }
-    case WP_F1:
-    {
-        auto p = (struct wp_f1*)node;
-        p->l = (wp_node*)(droot + ((char*)p->l - hroot));
-        wp_ast_update_device_ptr<Depth+1>(p->l, droot, hroot);
-        break;
-    }
-    case WP_F2:
-    {
-        auto p = (struct wp_f2*)node;
-        p->l = (wp_node*)(droot + ((char*)p->l - hroot));
-        p->r = (wp_node*)(droot + ((char*)p->r - hroot));
-        wp_ast_update_device_ptr<Depth+1>(p->l, droot, hroot);
-        wp_ast_update_device_ptr<Depth+1>(p->r, droot, hroot);
-        break;
-    }
-    case WP_ADD_VP:
-    case WP_ADD_PP:
-    case WP_SUB_VP:
-    case WP_SUB_PP:
-    case WP_MUL_VP:
-    case WP_MUL_PP:
-    case WP_DIV_VP:
-    case WP_DIV_PP:
-    case WP_NEG_P:
-    {
-        // No need to update node->l and node->r that contain a string for
-        // variable name because we don't need them for device code.
-        break;
-    }
-    default:
+    amrex::Real stack[WARPX_PARSER_DEPTH];
+    amrex::Real temps[wp_max_temps];
+    int sp = 0; // number of values on the stack
+
+    for (int n = 0; n < ncode; ++n)
     {
+        struct wp_instr const& c = code[n];
+        switch (c.op)
+        {
+        case WP_OP_NUMBER: stack[sp++] = c.v; break;
+        case WP_OP_VAR:    stack[sp++] = x[c.i]; break;
+        case WP_OP_ADD:    --sp; stack[sp-1] += stack[sp]; break;
+        case WP_OP_SUB:    --sp; stack[sp-1] -= stack[sp]; break;
+        case WP_OP_MUL:    --sp; stack[sp-1] *= stack[sp]; break;
+        case WP_OP_DIV:    --sp; stack[sp-1] /= stack[sp]; break;
+        case WP_OP_NEG:    stack[sp-1] = -stack[sp-1]; break;
+        case WP_OP_F1:
+            stack[sp-1] = wp_call_f1(static_cast<enum wp_f1_t>(c.i), stack[sp-1]);
+            break;
+        case WP_OP_F2:
+            --sp;
+            stack[sp-1] = wp_call_f2(static_cast<enum wp_f2_t>(c.i), stack[sp-1], stack[sp]);
+            break;
+        case WP_OP_ADD_VP: stack[sp++] = c.v + x[c.i]; break;
+        case WP_OP_SUB_VP: stack[sp++] = c.v - x[c.i]; break;
+        case WP_OP_MUL_VP: stack[sp++] = c.v * x[c.i]; break;
+        case WP_OP_DIV_VP: stack[sp++] = c.v / x[c.i]; break;
+        case WP_OP_ADD_PP: stack[sp++] = x[c.i] + x[c.j]; break;
+        case WP_OP_SUB_PP: stack[sp++] = x[c.i] - x[c.j]; break;
+        case WP_OP_MUL_PP: stack[sp++] = x[c.i] * x[c.j]; break;
+        case WP_OP_DIV_PP: stack[sp++] = x[c.i] / x[c.j]; break;
+        case WP_OP_NEG_P:  stack[sp++] = -x[c.i]; break;
+        case WP_OP_POWI:   stack[sp-1] = wp_call_powi(stack[sp-1], c.i); break;
+        case WP_OP_STORE:  temps[c.i] = stack[sp-1]; break;
+        case WP_OP_LOAD:   stack[sp++] = temps[c.i]; break;
+        default:
+        {
 #if AMREX_DEVICE_COMPILE
-        AMREX_DEVICE_PRINTF("wp_ast_update_device_ptr: unknown node type %d\n",
-                            static_cast<int>(node->type));
-        amrex::Abort();
+            AMREX_DEVICE_PRINTF("wp_bytecode_eval: unknown instruction %d\n", c.op);
+#else
+            amrex::AllPrint() << "wp_bytecode_eval: unknown instruction " << c.op << "\n";
 #endif
+            return 0.;
+        }
+        }
     }
-    }
+
+    return stack[0];
 }
 
-template <int Depth, std::enable_if_t<Depth == WARPX_PARSER_DEPTH,int> = 0>
-AMREX_GPU_DEVICE AMREX_NO_INLINE
-void wp_ast_update_device_ptr (struct wp_node*, char*, char*)
+/** Pointer and stride of an argument of the eval_batch functions of the
+ *  parsers: either an array with the values of the variable at all the
+ *  points, or a single value used at all the points.
+ */
+inline void
+wp_batch_arg (amrex::Real const* a, amrex::Real const*& p, int& stride)
 {
-#if AMREX_DEVICE_COMPILE
-    AMREX_DEVICE_PRINTF("wp_ast_update_device_ptr: WARPX_PARSER_DEPTH %d not big enough\n",
-                        WARPX_PARSER_DEPTH);
-    amrex::Abort();
-#endif
+    p = a;
+    stride = 1;
 }
 
-#endif
+template <typename T, std::enable_if_t<std::is_same<T,amrex::Real>::value,int> = 0>
+void
+wp_batch_arg (T const& a, amrex::Real const*& p, int& stride)
+{
+    p = &a;
+    stride = 0;
+}
 
 template <int Depth, std::enable_if_t<(Depth<WARPX_PARSER_DEPTH), int> = 0>
 AMREX_GPU_HOST_DEVICE
@@ -1,6 +1,9 @@
 #include "wp_parser_y.h"
 #include "wp_parser.tab.h"
+#include <algorithm>
 #include <cstdarg>
+#include <cmath>
+#include <vector>
 
 static struct wp_node* wp_root = NULL;
 
@@ -727,6 +730,7 @@ wp_ast_print_f1 (struct wp_f1* f1)
     case WP_POW_P1:      std::printf("POW(,1)\n");     break;
     case WP_POW_P2:      std::printf("POW(,2)\n");     break;
     case WP_POW_P3:      std::printf("POW(,3)\n");     break;
+    case WP_RSQRT:       std::printf("RSQRT\n");       break;
     default:
         amrex::AllPrint() << "wp_ast+print_f1: Unknow function " << f1->ftype << "\n";
     }
@@ -1032,6 +1036,483 @@ wp_ast_regvar_gpu (struct wp_node* node, char const* name, int i)
     }
 }
 
+namespace {
+
+/* State of the compilation of an AST into bytecode */
+struct wp_compiler {
+    std::vector<struct wp_instr> code;
+    std::vector<struct wp_node*> candidates; // nodes that may be shared
+    std::vector<struct wp_node*> temps;      // node kept in each temporary
+    int sp = 0;
+    int max_sp = 0;
+};
+
+void
+wp_emit (wp_compiler& c, enum wp_op_t op, int dsp, int i = 0, int j = 0, amrex_real v = 0.0)
+{
+    struct wp_instr instr;
+    instr.op = op;
+    instr.i = i;
+    instr.j = j;
+    instr.v = v;
+    c.code.push_back(instr);
+    c.sp += dsp;
+    if (c.sp > c.max_sp) c.max_sp = c.sp;
+}
+
+char const*
+wp_symbol_name (struct wp_node* node)
+{
+    return ((struct wp_symbol*)node)->name;
+}
+
+/* Whether a node costs more than one instruction, so that keeping it in a
+ * temporary is worth it if it appears several times */
+bool
+wp_ast_is_cse_candidate (struct wp_node* node)
+{
+    switch (node->type)
+    {
+    case WP_ADD:
+    case WP_SUB:
+    case WP_MUL:
+    case WP_DIV:
+    case WP_NEG:
+    case WP_F1:
+    case WP_F2:
+        return true;
+    default:
+        return false;
+    }
+}
+
+/* Whether the ASTs a and b compute the same expression */
+bool
+wp_ast_equal (struct wp_node* a, struct wp_node* b)
+{
+    if (a->type != b->type) return false;
+    switch (a->type)
+    {
+    case WP_NUMBER:
+        return ((struct wp_number*)a)->value == ((struct wp_number*)b)->value;
+    case WP_SYMBOL:
+        return strcmp(wp_symbol_name(a), wp_symbol_name(b)) == 0;
+    case WP_ADD:
+    case WP_SUB:
+    case WP_MUL:
+    case WP_DIV:
+        return wp_ast_equal(a->l, b->l) && wp_ast_equal(a->r, b->r);
+    case WP_NEG:
+        return wp_ast_equal(a->l, b->l);
+    case WP_F1:
+        return ((struct wp_f1*)a)->ftype == ((struct wp_f1*)b)->ftype
+            && wp_ast_equal(((struct wp_f1*)a)->l, ((struct wp_f1*)b)->l);
+    case WP_F2:
+        return ((struct wp_f2*)a)->ftype == ((struct wp_f2*)b)->ftype
+            && wp_ast_equal(((struct wp_f2*)a)->l, ((struct wp_f2*)b)->l)
+            && wp_ast_equal(((struct wp_f2*)a)->r, ((struct wp_f2*)b)->r);
+    case WP_ADD_VP:
+    case WP_SUB_VP:
+    case WP_MUL_VP:
+    case WP_DIV_VP:
+        return a->lvp.v == b->lvp.v
+            && strcmp(wp_symbol_name(a->r), wp_symbol_name(b->r)) == 0;
+    case WP_ADD_PP:
+    case WP_SUB_PP:
+    case WP_MUL_PP:
+    case WP_DIV_PP:
+        return strcmp(wp_symbol_name(a->l), wp_symbol_name(b->l)) == 0
+            && strcmp(wp_symbol_name(a->r), wp_symbol_name(b->r)) == 0;
+    case WP_NEG_P:
+        return strcmp(wp_symbol_name(a->l), wp_symbol_name(b->l)) == 0;
+    default:
+        return false;
+    }
+}
+
+void
+wp_ast_collect_candidates (struct wp_node* node, std::vector<struct wp_node*>& candidates)
+{
+    if (!wp_ast_is_cse_candidate(node)) return;
+    candidates.push_back(node);
+    switch (node->type)
+    {
+    case WP_NEG:
+        wp_ast_collect_candidates(node->l, candidates);
+        break;
+    case WP_F1:
+        wp_ast_collect_candidates(((struct wp_f1*)node)->l, candidates);
+        break;
+    case WP_F2:
+        wp_ast_collect_candidates(((struct wp_f2*)node)->l, candidates);
+        wp_ast_collect_candidates(((struct wp_f2*)node)->r, candidates);
+        break;
+    default:
+        wp_ast_collect_candidates(node->l, candidates);
+        wp_ast_collect_candidates(node->r, candidates);
+    }
+}
+
+/* Number of occurrences of node in the AST */
+int
+wp_ast_count (struct wp_node* node, std::vector<struct wp_node*> const& candidates)
+{
+    int count = 0;
+    for (auto other : candidates) {
+        if (wp_ast_equal(node, other)) ++count;
+    }
+    return count;
+}
+
+/* Whether node should be kept in a temporary: it must appear more than
+ * once, and more often than its parent (otherwise, only the parent is
+ * reused) */
+bool
+wp_ast_is_worth_keeping (struct wp_node* node, struct wp_node* parent,
+                         std::vector<struct wp_node*> const& candidates)
+{
+    const int count = wp_ast_count(node, candidates);
+    if (count < 2) return false;
+    return !parent || !wp_ast_is_cse_candidate(parent)
+        || count > wp_ast_count(parent, candidates);
+}
+
+void
+wp_ast_compile_node (struct wp_node* node, struct wp_node* parent, wp_compiler& c)
+{
+    const bool is_candidate = wp_ast_is_cse_candidate(node);
+
+    // The operands are evaluated from left to right, so an expression equal
+    // to one kept in a temporary has always been computed before.
+    if (is_candidate) {
+        for (int t = 0, n = c.temps.size(); t < n; ++t) {
+            if (wp_ast_equal(c.temps[t], node)) {
+                wp_emit(c, WP_OP_LOAD, 1, t);
+                return;
+            }
+        }
+    }
+
+    switch (node->type)
+    {
+    case WP_NUMBER:
+        wp_emit(c, WP_OP_NUMBER, 1, 0, 0, ((struct wp_number*)node)->value);
+        break;
+    case WP_SYMBOL:
+        wp_emit(c, WP_OP_VAR, 1, ((struct wp_symbol*)node)->ip.i);
+        break;
+    case WP_ADD:
+    case WP_SUB:
+    case WP_MUL:
+        wp_ast_compile_node(node->l, node, c);
+        wp_ast_compile_node(node->r, node, c);
+        wp_emit(c, (node->type == WP_ADD) ? WP_OP_ADD :
+                   (node->type == WP_SUB) ? WP_OP_SUB : WP_OP_MUL, -1);
+        break;
+    case WP_DIV:
+        if (node->l->type == WP_NUMBER && node->r->type == WP_F1 &&
+            ((struct wp_f1*)(node->r))->ftype == WP_SQRT)
+        {
+            // c/sqrt(a) -> c*rsqrt(a)
+            wp_ast_compile_node(((struct wp_f1*)(node->r))->l, node->r, c);
+            wp_emit(c, WP_OP_F1, 0, WP_RSQRT);
+            amrex_real v = ((struct wp_number*)(node->l))->value;
+            if (v != 1.0) {
+                wp_emit(c, WP_OP_NUMBER, 1, 0, 0, v);
+                wp_emit(c, WP_OP_MUL, -1);
+            }
+        }
+        else
+        {
+            wp_ast_compile_node(node->l, node, c);
+            wp_ast_compile_node(node->r, node, c);
+            wp_emit(c, WP_OP_DIV, -1);
+        }
+        break;
+    case WP_NEG:
+        wp_ast_compile_node(node->l, node, c);
+        wp_emit(c, WP_OP_NEG, 0);
+        break;
+    case WP_F1:
+        wp_ast_compile_node(((struct wp_f1*)node)->l, node, c);
+        wp_emit(c, WP_OP_F1, 0, ((struct wp_f1*)node)->ftype);
+        break;
+    case WP_F2:
+    {
+        struct wp_f2* f2 = (struct wp_f2*)node;
+        if (f2->ftype == WP_POW && f2->r->type == WP_NUMBER)
+        {
+            amrex_real v = ((struct wp_number*)(f2->r))->value;
+            wp_ast_compile_node(f2->l, node, c);
+            if (v == 0.5) {
+                wp_emit(c, WP_OP_F1, 0, WP_SQRT);
+            } else if (v == -0.5) {
+                wp_emit(c, WP_OP_F1, 0, WP_RSQRT);
+            } else if (v == std::floor(v) && std::abs(v) <= 64.0) {
+                wp_emit(c, WP_OP_POWI, 0, static_cast<int>(v));
+            } else {
+                wp_emit(c, WP_OP_NUMBER, 1, 0, 0, v);
+                wp_emit(c, WP_OP_F2, -1, WP_POW);
+            }
+        }
+        else
+        {
+            wp_ast_compile_node(f2->l, node, c);
+            wp_ast_compile_node(f2->r, node, c);
+            wp_emit(c, WP_OP_F2, -1, f2->ftype);
+        }
+        break;
+    }
+    case WP_ADD_VP:
+    case WP_SUB_VP:
+    case WP_MUL_VP:
+    case WP_DIV_VP:
+        wp_emit(c, (node->type == WP_ADD_VP) ? WP_OP_ADD_VP :
+                   (node->type == WP_SUB_VP) ? WP_OP_SUB_VP :
+                   (node->type == WP_MUL_VP) ? WP_OP_MUL_VP : WP_OP_DIV_VP,
+                1, node->rip.i, 0, node->lvp.v);
+        break;
+    case WP_ADD_PP:
+    case WP_SUB_PP:
+    case WP_MUL_PP:
+    case WP_DIV_PP:
+        wp_emit(c, (node->type == WP_ADD_PP) ? WP_OP_ADD_PP :
+                   (node->type == WP_SUB_PP) ? WP_OP_SUB_PP :
+                   (node->type == WP_MUL_PP) ? WP_OP_MUL_PP : WP_OP_DIV_PP,
+                1, node->lvp.ip.i, node->rip.i);
+        break;
+    case WP_NEG_P:
+        wp_emit(c, WP_OP_NEG_P, 1, node->lvp.ip.i);
+        break;
+    default:
+        amrex::AllPrint() << "wp_ast_compile: unknown node type " << node->type << "\n";
+        amrex::Abort();
+    }
+
+    if (is_candidate && static_cast<int>(c.temps.size()) < wp_max_temps &&
+        wp_ast_is_worth_keeping(node, parent, c.candidates))
+    {
+        wp_emit(c, WP_OP_STORE, 0, static_cast<int>(c.temps.size()));
+        c.temps.push_back(node);
+    }
+}
+
+}
+
+std::vector<struct wp_instr>
+wp_ast_compile (struct wp_node* node, int* max_sp)
+{
+    wp_compiler c;
+    wp_ast_collect_candidates(node, c.candidates);
+    wp_ast_compile_node(node, nullptr, c);
+    *max_sp = c.max_sp;
+    return c.code;
+}
+
+namespace {
+
+    template <typename F>
+    void wp_batch_apply1 (amrex_real* AMREX_RESTRICT a, int nb, F const& f)
+    {
+        for (int p = 0; p < nb; ++p) { a[p] = f(a[p]); }
+    }
+
+    template <typename F>
+    void wp_batch_apply2 (amrex_real* AMREX_RESTRICT a, amrex_real const* AMREX_RESTRICT b,
+                          int nb, F const& f)
+    {
+        for (int p = 0; p < nb; ++p) { a[p] = f(a[p], b[p]); }
+    }
+
+    void wp_batch_f1 (enum wp_f1_t type, amrex_real* AMREX_RESTRICT a, int nb)
+    {
+        // The switch is taken out of the loop over the points for the
+        // functions commonly found in the input files
+        switch (type) {
+        case WP_SQRT:   wp_batch_apply1(a, nb, [] (amrex_real x) { return std::sqrt(x); }); break;
+        case WP_EXP:    wp_batch_apply1(a, nb, [] (amrex_real x) { return std::exp(x); }); break;
+        case WP_LOG:    wp_batch_apply1(a, nb, [] (amrex_real x) { return std::log(x); }); break;
+        case WP_SIN:    wp_batch_apply1(a, nb, [] (amrex_real x) { return std::sin(x); }); break;
+        case WP_COS:    wp_batch_apply1(a, nb, [] (amrex_real x) { return std::cos(x); }); break;
+        case WP_TANH:   wp_batch_apply1(a, nb, [] (amrex_real x) { return std::tanh(x); }); break;
+        case WP_ABS:    wp_batch_apply1(a, nb, [] (amrex_real x) { return std::abs(x); }); break;
+        case WP_POW_M1: wp_batch_apply1(a, nb, [] (amrex_real x) { return amrex_real(1.0)/x; }); break;
+        case WP_POW_P2: wp_batch_apply1(a, nb, [] (amrex_real x) { return x*x; }); break;
+        case WP_RSQRT:  wp_batch_apply1(a, nb, [] (amrex_real x) { return amrex_real(1.0)/std::sqrt(x); }); break;
+        default:        wp_batch_apply1(a, nb, [=] (amrex_real x) { return wp_call_f1(type, x); });
+        }
+    }
+
+    void wp_batch_f2 (enum wp_f2_t type, amrex_real* AMREX_RESTRICT a,
+                      amrex_real const* AMREX_RESTRICT b, int nb)
+    {
+        switch (type) {
+        case WP_POW: wp_batch_apply2(a, b, nb, [] (amrex_real x, amrex_real y) { return std::pow(x,y); }); break;
+        case WP_MIN: wp_batch_apply2(a, b, nb, [] (amrex_real x, amrex_real y) { return (x < y) ? x : y; }); break;
+        case WP_MAX: wp_batch_apply2(a, b, nb, [] (amrex_real x, amrex_real y) { return (x > y) ? x : y; }); break;
+        default:     wp_batch_apply2(a, b, nb, [=] (amrex_real x, amrex_real y) { return wp_call_f2(type, x, y); });
+        }
+    }
+}
+
+void
+wp_bytecode_eval_batch (struct wp_instr const* code, int ncode, int nvars,
+                        amrex_real const* const* var, int const* stride,
+                        int n, amrex_real* out)
+{
+    constexpr int nbmax = wp_batch_size;
+    amrex_real stack[WARPX_PARSER_DEPTH][nbmax];
+    amrex_real temps[wp_max_temps][nbmax];
+
+    // The variables with a stride of 0 are broadcast once for all the blocks
+    std::vector<amrex_real> bcast(nvars*nbmax);
+    for (int iv = 0; iv < nvars; ++iv) {
+        if (stride[iv] == 0) {
+            std::fill(bcast.begin()+iv*nbmax, bcast.begin()+(iv+1)*nbmax, var[iv][0]);
+        }
+    }
+    std::vector<amrex_real const*> x(nvars);
+
+    for (int start = 0; start < n; start += nbmax)
+    {
+        int const nb = std::min(nbmax, n-start);
+        for (int iv = 0; iv < nvars; ++iv) {
+            x[iv] = (stride[iv] == 0) ? bcast.data()+iv*nbmax : var[iv]+start;
+        }
+
+        int sp = 0;
+        for (int ic = 0; ic < ncode; ++ic)
+        {
+            struct wp_instr const& c = code[ic];
+            switch (c.op)
+            {
+            case WP_OP_NUMBER:
+            {
+                amrex_real* AMREX_RESTRICT r = stack[sp++];
+                for (int p = 0; p < nb; ++p) { r[p] = c.v; }
+                break;
+            }
+            case WP_OP_VAR:
+            {
+                std::copy(x[c.i], x[c.i]+nb, stack[sp++]);
+                break;
+            }
+            case WP_OP_ADD:
+            {
+                --sp;
+                wp_batch_apply2(stack[sp-1], stack[sp], nb,
+                                [] (amrex_real a, amrex_real b) { return a+b; });
+                break;
+            }
+            case WP_OP_SUB:
+            {
+                --sp;
+                wp_batch_apply2(stack[sp-1], stack[sp], nb,
+                                [] (amrex_real a, amrex_real b) { return a-b; });
+                break;
+            }
+            case WP_OP_MUL:
+            {
+                --sp;
+                wp_batch_apply2(stack[sp-1], stack[sp], nb,
+                                [] (amrex_real a, amrex_real b) { return a*b; });
+                break;
+            }
+            case WP_OP_DIV:
+            {
+                --sp;
+                wp_batch_apply2(stack[sp-1], stack[sp], nb,
+                                [] (amrex_real a, amrex_real b) { return a/b; });
+                break;
+            }
+            case WP_OP_NEG:
+            {
+                wp_batch_apply1(stack[sp-1], nb, [] (amrex_real a) { return -a; });
+                break;
+            }
+            case WP_OP_F1:
+            {
+                wp_batch_f1(static_cast<enum wp_f1_t>(c.i), stack[sp-1], nb);
+                break;
+            }
+            case WP_OP_F2:
+            {
+                --sp;
+                wp_batch_f2(static_cast<enum wp_f2_t>(c.i), stack[sp-1], stack[sp], nb);
+                break;
+            }
+            case WP_OP_ADD_VP:
+            case WP_OP_SUB_VP:
+            case WP_OP_MUL_VP:
+            case WP_OP_DIV_VP:
+            {
+                amrex_real* AMREX_RESTRICT r = stack[sp++];
+                amrex_real const* AMREX_RESTRICT a = x[c.i];
+                amrex_real const v = c.v;
+                if (c.op == WP_OP_ADD_VP) {
+                    for (int p = 0; p < nb; ++p) { r[p] = v + a[p]; }
+                } else if (c.op == WP_OP_SUB_VP) {
+                    for (int p = 0; p < nb; ++p) { r[p] = v - a[p]; }
+                } else if (c.op == WP_OP_MUL_VP) {
+                    for (int p = 0; p < nb; ++p) { r[p] = v * a[p]; }
+                } else {
+                    for (int p = 0; p < nb; ++p) { r[p] = v / a[p]; }
+                }
+                break;
+            }
+            case WP_OP_ADD_PP:
+            case WP_OP_SUB_PP:
+            case WP_OP_MUL_PP:
+            case WP_OP_DIV_PP:
+            {
+                amrex_real* AMREX_RESTRICT r = stack[sp++];
+                amrex_real const* AMREX_RESTRICT a = x[c.i];
+                amrex_real const* AMREX_RESTRICT b = x[c.j];
+                if (c.op == WP_OP_ADD_PP) {
+                    for (int p = 0; p < nb; ++p) { r[p] = a[p] + b[p]; }
+                } else if (c.op == WP_OP_SUB_PP) {
+                    for (int p = 0; p < nb; ++p) { r[p] = a[p] - b[p]; }
+                } else if (c.op == WP_OP_MUL_PP) {
+                    for (int p = 0; p < nb; ++p) { r[p] = a[p] * b[p]; }
+                } else {
+                    for (int p = 0; p < nb; ++p) { r[p] = a[p] / b[p]; }
+                }
+                break;
+            }
+            case WP_OP_NEG_P:
+            {
+                amrex_real* AMREX_RESTRICT r = stack[sp++];
+                amrex_real const* AMREX_RESTRICT a = x[c.i];
+                for (int p = 0; p < nb; ++p) { r[p] = -a[p]; }
+                break;
+            }
+            case WP_OP_POWI:
+            {
+                int const e = c.i;
+                wp_batch_apply1(stack[sp-1], nb, [=] (amrex_real a) { return wp_call_powi(a, e); });
+                break;
+            }
+            case WP_OP_STORE:
+            {
+                std::copy(stack[sp-1], stack[sp-1]+nb, temps[c.i]);
+                break;
+            }
+            case WP_OP_LOAD:
+            {
+                std::copy(temps[c.i], temps[c.i]+nb, stack[sp++]);
+                break;
+            }
+            default:
+            {
+                amrex::Abort("wp_bytecode_eval_batch: unknown instruction");
+            }
+            }
+        }
+
+        std::copy(stack[0], stack[0]+nb, out+start);
+    }
+}
+
 void wp_ast_setconst (struct wp_node* node, char const* name, amrex_real c)
 {
     switch (node->type)
@@ -1,6 +1,7 @@
 #ifndef WP_PARSER_Y_H_
 #define WP_PARSER_Y_H_
 
+#include <AMReX_Extension.H>
 #include <AMReX_GpuQualifiers.H>
 #include <AMReX_GpuPrint.H>
 #include <AMReX_REAL.H>
@@ -12,6 +13,7 @@
 #include <cstring>
 #include <iostream>
 #include <type_traits>
+#include <vector>
 
 enum wp_f1_t {  // Bulit-in functions with one argument
     WP_SQRT = 1,
@@ -33,7 +35,8 @@ enum wp_f1_t {  // Bulit-in functions with one argument
     WP_POW_M1,
     WP_POW_P1,
     WP_POW_P2,
-    WP_POW_P3
+    WP_POW_P3,
+    WP_RSQRT      // generated by wp_ast_compile
 };
 
 enum wp_f2_t {  // Built-in functions with two arguments
@@ -72,6 +75,46 @@ enum wp_node_t {
     WP_NEG_P
 };
 
+/* Instructions of the bytecode compiled from the optimized AST (see
+ * wp_ast_compile).  The bytecode is evaluated on a stack of values: the
+ * instructions either push a value or replace the values on top of the
+ * stack by the result of an operation on them.
+ */
+enum wp_op_t {
+    WP_OP_NUMBER = 1, // push v
+    WP_OP_VAR,        // push x[i]
+    WP_OP_ADD,        // pop b, pop a, push a+b
+    WP_OP_SUB,
+    WP_OP_MUL,
+    WP_OP_DIV,
+    WP_OP_NEG,        // pop a, push -a
+    WP_OP_F1,         // pop a, push f1(a), with f1 of type i
+    WP_OP_F2,         // pop b, pop a, push f2(a,b), with f2 of type i
+    WP_OP_ADD_VP,     // push v+x[i]
+    WP_OP_SUB_VP,
+    WP_OP_MUL_VP,
+    WP_OP_DIV_VP,
+    WP_OP_ADD_PP,     // push x[i]+x[j]
+    WP_OP_SUB_PP,
+    WP_OP_MUL_PP,
+    WP_OP_DIV_PP,
+    WP_OP_NEG_P,      // push -x[i]
+    WP_OP_POWI,       // pop a, push a^i, with integer i
+    WP_OP_STORE,      // copy the top of the stack to temporary i
+    WP_OP_LOAD        // push temporary i
+};
+
+/* Maximum number of temporaries holding common subexpressions in the
+ * bytecode */
+constexpr int wp_max_temps = 16;
+
+struct wp_instr {
+    enum wp_op_t op;
+    int i;
+    int j;
+    amrex_real v;
+};
+
 /* In C, the address of the first member of a struct is the same as
  * the address of the struct itself.  Because of this, all struct wp_*
  * pointers can be passed around as struct wp_node pointer and enum
@@ -168,6 +211,30 @@ void wp_ast_regvar (struct wp_node* node, char const* name, amrex_real* p);
 void wp_ast_regvar_gpu (struct wp_node* node, char const* name, int i);
 void wp_ast_setconst (struct wp_node* node, char const* name, amrex_real c);
 
+/* Compile the AST, whose variables must have been registered with
+ * wp_ast_regvar_gpu, into bytecode.  On top of the optimizations of
+ * wp_ast_optimize, the compilation
+ *   - evaluates the repeated subexpressions only once, and keeps them in
+ *     temporaries (at most wp_max_temps),
+ *   - expands the powers with integer exponents into multiplications,
+ *   - rewrites the powers 1/2 and -1/2 and c/sqrt(a) with sqrt and rsqrt.
+ * *max_sp is set to the maximum size of the stack during the evaluation.
+ */
+std::vector<struct wp_instr> wp_ast_compile (struct wp_node* node, int* max_sp);
+
+/* Number of points evaluated together by wp_bytecode_eval_batch */
+constexpr int wp_batch_size = 64;
+
+/* Evaluate the bytecode on the host at n points.  The instructions are
+ * applied to blocks of wp_batch_size points at a time, so that the loops
+ * over the points of a block can be vectorized by the compiler.  The
+ * value of variable i at point p is var[i][p*stride[i]]: a stride of 0
+ * gives the same value at all the points (e.g. the time).
+ */
+void wp_bytecode_eval_batch (struct wp_instr const* code, int ncode, int nvars,
+                             amrex_real const* const* var, int const* stride,
+                             int n, amrex_real* out);
+
 template <typename T, std::enable_if_t<std::is_floating_point<T>::value,int> = 0>
 AMREX_GPU_HOST_DEVICE
 #ifdef AMREX_USE_GPU
@@ -197,6 +264,7 @@ wp_call_f1 (enum wp_f1_t type, T a)
     case WP_POW_P1:      return a;
     case WP_POW_P2:      return a*a;
     case WP_POW_P3:      return a*a*a;
+    case WP_RSQRT:       return amrex::Real(1.0)/std::sqrt(a);
     default:
 #if AMREX_DEVICE_COMPILE
         AMREX_DEVICE_PRINTF("wp_call_f1: Unknown function %d\n", type);
@@ -252,4 +320,20 @@ wp_call_f2 (enum wp_f2_t type, T a, T b)
     }
 }
 
+/* Integer power of a, by binary exponentiation */
+template <typename T, std::enable_if_t<std::is_floating_point<T>::value,int> = 0>
+AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+T
+wp_call_powi (T a, int n)
+{
+    unsigned int m = (n < 0) ? -static_cast<unsigned int>(n) : n;
+    T r = T(1.0);
+    while (m) {
+        if (m & 1u) r *= a;
+        a *= a;
+        m >>= 1;
+    }
+    return (n < 0) ? T(1.0)/r : r;
+}
+
 #endif
@@ -46,7 +46,9 @@ void CollisionHandler::doCollisions ( amrex::Real cur_time, MultiParticleContain
 {
 
     for (auto& collision : allcollisions) {
-        collision->doCollisions(cur_time, mypc);
+        collision->doCollisions(cur_time, mypc, m_bins_cache);
     }
+    // The particles move before the next collisions
+    m_bins_cache.clear();
 
 }
@@ -9,8 +9,12 @@
 #include "ElasticCollisionPerez.H"
 #include "Utils/ParticleUtils.H"
 #include "Utils/WarpXUtil.H"
+#include "Utils/BoxCostTimer.H"
 #include "WarpX.H"
 
+#include <AMReX_GpuContainers.H>
+#include <AMReX_Scan.H>
+
 using namespace amrex::literals;
 
 PairWiseCoulombCollision::PairWiseCoulombCollision (std::string const collision_name)
@@ -34,7 +38,8 @@ PairWiseCoulombCollision::PairWiseCoulombCollision (std::string const collision_
 }
 
 void
-PairWiseCoulombCollision::doCollisions (amrex::Real cur_time, MultiParticleContainer* mypc)
+PairWiseCoulombCollision::doCollisions (amrex::Real cur_time, MultiParticleContainer* mypc,
+                                        ParticleBinsCache& bins_cache)
 {
     const amrex::Real dt = WarpX::GetInstance().getdt(0);
     if ( int(std::floor(cur_time/dt)) % m_ndt != 0 ) return;
@@ -57,20 +62,11 @@ PairWiseCoulombCollision::doCollisions (amrex::Real cur_time, MultiParticleConta
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
         for (amrex::MFIter mfi = species1.MakeMFIter(lev, info); mfi.isValid(); ++mfi){
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-            }
-            amrex::Real wt = amrex::second();
+            BoxCostTimer box_timer(cost, mfi.index());
 
-            doCoulombCollisionsWithinTile( lev, mfi, species1, species2 );
+            doCoulombCollisionsWithinTile( lev, mfi, species1, species2, bins_cache );
 
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-                wt = amrex::second() - wt;
-                amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-            }
+            box_timer.stop();
         }
     }
 }
@@ -84,18 +80,127 @@ using index_type = ParticleBins::index_type;
 
 using namespace ParticleUtils;
 
+/** Perform the binary collisions of the particles of each cell of a tile, with the
+ * Perez algorithm (see ElasticCollisionPerez)
+ *
+ * A first kernel with one thread per cell shuffles the particles of the
+ * cell and computes the quantities common to all its pairs. A second kernel
+ * then collides the pairs, with one thread per particle of the species with
+ * fewer particles in the cell (see ElasticCollisionPerezPairs), so that the
+ * dense cells are spread over many threads instead of one.
+ *
+ * @param n_cells number of cells of the tile
+ * @param same_species whether the two species are the same, in which case
+ *        the first half of the particles of a cell collide with the second half
+ * @param indices_1/2 permutation of the particles of species 1/2 (see DenseBins)
+ * @param cell_offsets_1/2 offsets of the cells in indices_1/2
+ * @param cell_volume callable returning the volume of a cell, from its index
+ */
+template <typename CellVolume>
+void CollideParticlesInCells (
+    int const n_cells, bool const same_species,
+    index_type* indices_1, index_type const* cell_offsets_1,
+    index_type* indices_2, index_type const* cell_offsets_2,
+    amrex::Real* ux_1, amrex::Real* uy_1, amrex::Real* uz_1,
+    amrex::Real* ux_2, amrex::Real* uy_2, amrex::Real* uz_2,
+    amrex::Real const* w_1, amrex::Real const* w_2,
+    amrex::Real const q1, amrex::Real const q2,
+    amrex::Real const m1, amrex::Real const m2,
+    amrex::Real const dt, amrex::Real const CoulombLog,
+    CellVolume const& cell_volume)
+{
+    if (n_cells == 0) return;
+
+    amrex::Gpu::DeviceVector<PerezCellParams<amrex::Real>> params(n_cells);
+    amrex::Gpu::DeviceVector<int> num_pairs(n_cells);
+    amrex::Gpu::DeviceVector<int> pair_offsets(n_cells);
+    PerezCellParams<amrex::Real>* p_params = params.dataPtr();
+    int* p_num_pairs = num_pairs.dataPtr();
+    int* p_pair_offsets = pair_offsets.dataPtr();
+
+    // Particles of species 1 and 2 in the cell `i_cell`
+    auto cell_ranges = [=] AMREX_GPU_HOST_DEVICE (int i_cell,
+        index_type& I1s, index_type& I1e, index_type& I2s, index_type& I2e) noexcept
+    {
+        if (same_species) {
+            I1s = cell_offsets_1[i_cell];
+            I2e = cell_offsets_1[i_cell+1];
+            I1e = (I1s+I2e)/2;
+            I2s = I1e;
+        } else {
+            I1s = cell_offsets_1[i_cell];
+            I1e = cell_offsets_1[i_cell+1];
+            I2s = cell_offsets_2[i_cell];
+            I2e = cell_offsets_2[i_cell+1];
+        }
+    };
+
+    // Shuffle the particles and compute the quantities of each cell
+    amrex::ParallelForRNG( n_cells,
+        [=] AMREX_GPU_DEVICE (int i_cell, amrex::RandomEngine const& engine) noexcept
+        {
+            index_type I1s, I1e, I2s, I2e;
+            cell_ranges(i_cell, I1s, I1e, I2s, I2e);
+            p_num_pairs[i_cell] = 0;
+
+            // Do not collide if one species is missing in the cell
+            // (or if there is only one particle for the same species)
+            if ( I1e - I1s < 1 || I2e - I2s < 1 ) return;
+
+            // shuffle
+            ShuffleFisherYates(indices_1, I1s, I1e, engine);
+            if (!same_species) ShuffleFisherYates(indices_2, I2s, I2e, engine);
+
+            p_params[i_cell] = ElasticCollisionPerezCellParams(
+                I1s, I1e, I2s, I2e, indices_1, indices_2,
+                ux_1, uy_1, uz_1, ux_2, uy_2, uz_2, w_1, w_2, q1, q2, m1, m2, amrex::Real(-1.0), amrex::Real(-1.0),
+                CoulombLog, cell_volume(i_cell));
+            p_num_pairs[i_cell] = amrex::min(I1e - I1s, I2e - I2s);
+        }
+    );
+
+    const int total_pairs = amrex::Scan::ExclusiveSum(n_cells, p_num_pairs, p_pair_offsets);
+
+    // Collide the pairs
+    amrex::ParallelForRNG( total_pairs,
+        [=] AMREX_GPU_DEVICE (int i_pair, amrex::RandomEngine const& engine) noexcept
+        {
+            // last cell whose first pair is not after i_pair
+            // (the cells without pairs have the same offset as the next cell)
+            int lo = 0;
+            int hi = n_cells-1;
+            while (lo < hi) {
+                int const mid = (lo+hi+1)/2;
+                if (p_pair_offsets[mid] <= i_pair) lo = mid;
+                else hi = mid-1;
+            }
+            index_type I1s, I1e, I2s, I2e;
+            cell_ranges(lo, I1s, I1e, I2s, I2e);
+
+            ElasticCollisionPerezPairs(
+                i_pair - p_pair_offsets[lo],
+                I1s, I1e, I2s, I2e, indices_1, indices_2,
+                ux_1, uy_1, uz_1, ux_2, uy_2, uz_2, w_1, w_2,
+                q1, q2, m1, m2, dt, CoulombLog, p_params[lo], engine );
+        }
+    );
+
+    amrex::Gpu::synchronize();
+}
+
 /** Perform all binary collisions within a tile
  *
  * @param lev AMR level of the tile
  * @param mfi iterator for multifab
  * @param species1/2 pointer to species container
- * @param ndt user input number of time stpes between collisions
+ * @param bins_cache Particles of each cell of the species, shared with the other collisions
  *
  */
 void PairWiseCoulombCollision::doCoulombCollisionsWithinTile
     ( int const lev, amrex::MFIter const& mfi,
     WarpXParticleContainer& species_1,
-    WarpXParticleContainer& species_2)
+    WarpXParticleContainer& species_2,
+    ParticleBinsCache& bins_cache)
 {
 
     int const ndt = m_ndt;
@@ -107,7 +212,8 @@ void PairWiseCoulombCollision::doCoulombCollisionsWithinTile
         ParticleTileType& ptile_1 = species_1.ParticlesAt(lev, mfi);
 
         // Find the particles that are in each cell of this tile
-        ParticleBins bins_1 = findParticlesInEachCell( lev, mfi, ptile_1 );
+        // (or reuse the bins of a previous collision of this step)
+        ParticleBins& bins_1 = bins_cache.getBins( species_1, lev, mfi );
 
         // Loop over cells, and collide the particles in each cell
 
@@ -143,36 +249,22 @@ void PairWiseCoulombCollision::doCoulombCollisionsWithinTile
         auto dV = geom.CellSize(0) * geom.CellSize(1) * geom.CellSize(2);
 #endif
 
-        // Loop over cells
-        amrex::ParallelForRNG( n_cells,
-            [=] AMREX_GPU_DEVICE (int i_cell, amrex::RandomEngine const& engine) noexcept
-            {
-                // The particles from species1 that are in the cell `i_cell` are
-                // given by the `indices_1[cell_start_1:cell_stop_1]`
-                index_type const cell_start_1 = cell_offsets_1[i_cell];
-                index_type const cell_stop_1  = cell_offsets_1[i_cell+1];
-                index_type const cell_half_1 = (cell_start_1+cell_stop_1)/2;
-
-                // Do not collide if there is only one particle in the cell
-                if ( cell_stop_1 - cell_start_1 <= 1 ) return;
-
-                // shuffle
-                ShuffleFisherYates(
-                    indices_1, cell_start_1, cell_half_1, engine );
 #if defined WARPX_DIM_RZ
-                int ri = (i_cell - i_cell%nz) / nz;
-                auto dV = MathConst::pi*(2.0_rt*ri+1.0_rt)*dr*dr*dz;
+        auto cell_volume = [=] AMREX_GPU_HOST_DEVICE (int i_cell) noexcept
+        {
+            int ri = (i_cell - i_cell%nz) / nz;
+            return MathConst::pi*(2.0_rt*ri+1.0_rt)*dr*dr*dz;
+        };
+#else
+        auto cell_volume = [=] AMREX_GPU_HOST_DEVICE (int) noexcept { return dV; };
 #endif
-                // Call the function in order to perform collisions
-                ElasticCollisionPerez(
-                    cell_start_1, cell_half_1,
-                    cell_half_1, cell_stop_1,
-                    indices_1, indices_1,
-                    ux_1, uy_1, uz_1, ux_1, uy_1, uz_1, w_1, w_1,
-                    q1, q1, m1, m1, amrex::Real(-1.0), amrex::Real(-1.0),
-                    dt*ndt, CoulombLog, dV, engine );
-            }
-        );
+
+        // Collide the first half of the particles of each cell with the second half
+        CollideParticlesInCells(
+            n_cells, true,
+            indices_1, cell_offsets_1, indices_1, cell_offsets_1,
+            ux_1, uy_1, uz_1, ux_1, uy_1, uz_1, w_1, w_1,
+            q1, q1, m1, m1, dt*ndt, CoulombLog, cell_volume );
     }
     else // species_1 != species_2
     {
@@ -181,8 +273,9 @@ void PairWiseCoulombCollision::doCoulombCollisionsWithinTile
         ParticleTileType& ptile_2 = species_2.ParticlesAt(lev, mfi);
 
         // Find the particles that are in each cell of this tile
-        ParticleBins bins_1 = findParticlesInEachCell( lev, mfi, ptile_1 );
-        ParticleBins bins_2 = findParticlesInEachCell( lev, mfi, ptile_2 );
+        // (or reuse the bins of a previous collision of this step)
+        ParticleBins& bins_1 = bins_cache.getBins( species_1, lev, mfi );
+        ParticleBins& bins_2 = bins_cache.getBins( species_2, lev, mfi );
 
         // Loop over cells, and collide the particles in each cell
 
@@ -228,42 +321,22 @@ void PairWiseCoulombCollision::doCoulombCollisionsWithinTile
         auto dV = geom.CellSize(0) * geom.CellSize(1) * geom.CellSize(2);
 #endif
 
-        // Loop over cells
-        amrex::ParallelForRNG( n_cells,
-            [=] AMREX_GPU_DEVICE (int i_cell, amrex::RandomEngine const& engine) noexcept
-            {
-                // The particles from species1 that are in the cell `i_cell` are
-                // given by the `indices_1[cell_start_1:cell_stop_1]`
-                index_type const cell_start_1 = cell_offsets_1[i_cell];
-                index_type const cell_stop_1  = cell_offsets_1[i_cell+1];
-                // Same for species 2
-                index_type const cell_start_2 = cell_offsets_2[i_cell];
-                index_type const cell_stop_2  = cell_offsets_2[i_cell+1];
-
-                // ux from species1 can be accessed like this:
-                // ux_1[ indices_1[i] ], where i is between
-                // cell_start_1 (inclusive) and cell_start_2 (exclusive)
-
-                // Do not collide if one species is missing in the cell
-                if ( cell_stop_1 - cell_start_1 < 1 ||
-                     cell_stop_2 - cell_start_2 < 1 ) return;
-
-                // shuffle
-                ShuffleFisherYates(indices_1, cell_start_1, cell_stop_1, engine);
-                ShuffleFisherYates(indices_2, cell_start_2, cell_stop_2, engine);
 #if defined WARPX_DIM_RZ
-                int ri = (i_cell - i_cell%nz) / nz;
-                auto dV = MathConst::pi*(2.0_rt*ri+1.0_rt)*dr*dr*dz;
+        auto cell_volume = [=] AMREX_GPU_HOST_DEVICE (int i_cell) noexcept
+        {
+            int ri = (i_cell - i_cell%nz) / nz;
+            return MathConst::pi*(2.0_rt*ri+1.0_rt)*dr*dr*dz;
+        };
+#else
+        auto cell_volume = [=] AMREX_GPU_HOST_DEVICE (int) noexcept { return dV; };
 #endif
-                // Call the function in order to perform collisions
-                ElasticCollisionPerez(
-                    cell_start_1, cell_stop_1, cell_start_2, cell_stop_2,
-                    indices_1, indices_2,
-                    ux_1, uy_1, uz_1, ux_2, uy_2, uz_2, w_1, w_2,
-                    q1, q2, m1, m2, amrex::Real(-1.0), amrex::Real(-1.0),
-                    dt*ndt, CoulombLog, dV, engine );
-            }
-        );
+
+        // Collide the particles of species 1 with those of species 2, in each cell
+        CollideParticlesInCells(
+            n_cells, false,
+            indices_1, cell_offsets_1, indices_2, cell_offsets_2,
+            ux_1, uy_1, uz_1, ux_2, uy_2, uz_2, w_1, w_2,
+            q1, q2, m1, m2, dt*ndt, CoulombLog, cell_volume );
     } // end if ( m_isSameSpecies)
 
 }
@@ -0,0 +1,32 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "ParticleBinsCache.H"
+#include "Utils/ParticleUtils.H"
+
+ParticleBinsCache::ParticleBins&
+ParticleBinsCache::getBins (WarpXParticleContainer& pc, int lev, amrex::MFIter const& mfi)
+{
+    const Key key{&pc, lev, mfi.index(), mfi.LocalTileIndex()};
+    Entry* entry = nullptr;
+#ifdef AMREX_USE_OMP
+#pragma omp critical (particle_bins_cache)
+#endif
+    {
+        entry = &m_bins[key];
+    }
+
+    auto& ptile = pc.ParticlesAt(lev, mfi);
+    const amrex::Box box = mfi.tilebox(amrex::IntVect::TheZeroVector());
+    const long np = ptile.numParticles();
+    // Bin the particles if this tile was not binned yet, or with a different tiling
+    if (entry->np != np || entry->box != box) {
+        entry->bins = ParticleUtils::findParticlesInEachCell(lev, mfi, ptile);
+        entry->box = box;
+        entry->np = np;
+    }
+    return entry->bins;
+}
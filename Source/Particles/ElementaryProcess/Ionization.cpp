@@ -23,6 +23,7 @@ IonizationFilterFunc::IonizationFilterFunc (const WarpXParIter& a_pti, int lev,
                                             const amrex::Real* const AMREX_RESTRICT a_adk_power,
                                             int a_comp,
                                             int a_atomic_number,
+                                            IonizationRateTableView a_rate_table,
                                             int a_offset) noexcept
 {
     m_ionization_energies = a_ionization_energies;
@@ -31,6 +32,7 @@ IonizationFilterFunc::IonizationFilterFunc (const WarpXParIter& a_pti, int lev,
     m_adk_power = a_adk_power;
     comp = a_comp;
     m_atomic_number = a_atomic_number;
+    m_rate_table = a_rate_table;
 
     m_get_position  = GetParticlePosition(a_pti, a_offset);
     m_get_externalE = GetExternalEField  (a_pti, a_offset);
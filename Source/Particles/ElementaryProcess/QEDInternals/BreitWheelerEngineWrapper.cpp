@@ -98,6 +98,14 @@ void BreitWheelerEngine::init_builtin_tables(
     m_lookup_tables_initialized = true;
 }
 
+std::size_t BreitWheelerEngine::get_lookup_tables_memory () const
+{
+    if(!m_lookup_tables_initialized)
+        return 0;
+
+    return m_dndt_table.serialize().size() + m_pair_prod_table.serialize().size();
+}
+
 vector<char> BreitWheelerEngine::export_lookup_tables_data () const
 {
    if(!m_lookup_tables_initialized)
@@ -123,8 +131,8 @@ BreitWheelerEngine::get_default_ctrl() const
 {
     namespace pxr_bw = picsar::multi_physics::phys::breit_wheeler;
     return PicsarBreitWheelerCtrl{
-        pxr_bw::default_dndt_lookup_table_params<amrex::Real>,
-        pxr_bw::default_pair_prod_lookup_table_params<amrex::Real>
+        pxr_bw::default_dndt_lookup_table_params<QedTableReal>,
+        pxr_bw::default_pair_prod_lookup_table_params<QedTableReal>
     };
 }
 
@@ -161,7 +169,7 @@ void BreitWheelerEngine::init_builtin_dndt_table()
     dndt_params.chi_phot_max = 200.0_rt;
     dndt_params.chi_phot_how_many = 64;
 
-    const auto vals = amrex::Gpu::DeviceVector<amrex::Real>{
+    const auto vals = amrex::Gpu::DeviceVector<QedTableReal>{
         -1.34808e+02_rt, -1.16674e+02_rt, -1.01006e+02_rt, -8.74694e+01_rt,
         -7.57742e+01_rt, -6.56699e+01_rt, -5.69401e+01_rt, -4.93981e+01_rt,
         -4.28821e+01_rt, -3.72529e+01_rt, -3.23897e+01_rt, -2.81885e+01_rt,
@@ -192,7 +200,7 @@ void BreitWheelerEngine::init_builtin_pair_prod_table()
     pair_prod_params.chi_phot_how_many = 64;
     pair_prod_params.frac_how_many = 64;
 
-    const auto vals = amrex::Gpu::DeviceVector<amrex::Real>{
+    const auto vals = amrex::Gpu::DeviceVector<QedTableReal>{
         0.00000e+00_rt, 0.00000e+00_rt, 0.00000e+00_rt, 0.00000e+00_rt,
         0.00000e+00_rt, 0.00000e+00_rt, 0.00000e+00_rt, 3.35120e-221_rt,
         1.13067e-188_rt, 2.14228e-163_rt, 3.39948e-143_rt, 1.09215e-126_rt,
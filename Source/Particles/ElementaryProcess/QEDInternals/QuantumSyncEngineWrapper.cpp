@@ -95,6 +95,14 @@ void QuantumSynchrotronEngine::init_builtin_tables(
     m_lookup_tables_initialized = true;
 }
 
+std::size_t QuantumSynchrotronEngine::get_lookup_tables_memory () const
+{
+    if(!m_lookup_tables_initialized)
+        return 0;
+
+    return m_dndt_table.serialize().size() + m_phot_em_table.serialize().size();
+}
+
 vector<char> QuantumSynchrotronEngine::export_lookup_tables_data () const
 {
    if(!m_lookup_tables_initialized)
@@ -120,8 +128,8 @@ QuantumSynchrotronEngine::get_default_ctrl() const
 {
     namespace pxr_qs = picsar::multi_physics::phys::quantum_sync;
     return PicsarQuantumSyncCtrl{
-        pxr_qs::default_dndt_lookup_table_params<amrex::Real>,
-        pxr_qs::default_photon_emission_lookup_table_params<amrex::Real>
+        pxr_qs::default_dndt_lookup_table_params<QedTableReal>,
+        pxr_qs::default_photon_emission_lookup_table_params<QedTableReal>
     };
 }
 
@@ -159,7 +167,7 @@ void QuantumSynchrotronEngine::init_builtin_dndt_table()
     dndt_params.chi_part_how_many = 64;
 
 
-    const auto vals = amrex::Gpu::DeviceVector<amrex::Real>{
+    const auto vals = amrex::Gpu::DeviceVector<QedTableReal>{
         -6.13623e+00_rt, -5.94268e+00_rt, -5.74917e+00_rt, -5.55571e+00_rt,
         -5.36231e+00_rt, -5.16898e+00_rt, -4.97575e+00_rt, -4.78262e+00_rt,
         -4.58961e+00_rt, -4.39677e+00_rt, -4.20410e+00_rt, -4.01166e+00_rt,
@@ -193,7 +201,7 @@ void QuantumSynchrotronEngine::init_builtin_phot_em_table()
     phot_em_params.frac_how_many = 64;
 
 
-const auto vals = amrex::Gpu::DeviceVector<amrex::Real>{
+const auto vals = amrex::Gpu::DeviceVector<QedTableReal>{
 -6.83368e+00_rt, -6.68749e+00_rt, -6.54129e+00_rt, -6.39510e+00_rt,
 -6.24890e+00_rt, -6.10271e+00_rt, -5.95651e+00_rt, -5.81031e+00_rt,
 -5.66412e+00_rt, -5.51792e+00_rt, -5.37173e+00_rt, -5.22554e+00_rt,
@@ -9,10 +9,12 @@
 #include "WarpX.H"
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpX_Complex.H"
+#include "Utils/BoxCostTimer.H"
 #include "Particles/MultiParticleContainer.H"
 #include "Particles/Pusher/GetAndSetPosition.H"
 
 #include <AMReX.H>
+#include <AMReX_Scan.H>
 
 #include <limits>
 #include <cmath>
@@ -69,6 +71,20 @@ LaserParticleContainer::LaserParticleContainer (AmrCore* amr_core, int ispecies,
     pp_laser_name.query("do_continuous_injection", do_continuous_injection);
     pp_laser_name.query("min_particles_per_mode", m_min_particles_per_mode);
 
+    std::string injection_method = "particles";
+    pp_laser_name.query("injection_method", injection_method);
+    if (injection_method == "current") {
+        m_current_injection = true;
+#ifdef WARPX_DIM_RZ
+        amrex::Abort("<laser_name>.injection_method = current is not implemented in RZ geometry");
+#endif
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(maxLevel() == 0,
+            "<laser_name>.injection_method = current is not implemented with mesh refinement");
+    } else if (injection_method != "particles") {
+        amrex::Abort("Unknown laser injection method: " + injection_method);
+    }
+    pp_laser_name.query("precompute_transverse_profile", m_precompute_transverse);
+
     if (m_e_max == amrex::Real(0.)){
         amrex::Print() << m_laser_name << " with zero amplitude disabled.\n";
         return; // Disable laser if amplitude is 0
@@ -176,6 +192,19 @@ LaserParticleContainer::LaserParticleContainer (AmrCore* amr_core, int ispecies,
     common_params.p_X = m_p_X;
     common_params.nvec = m_nvec;
     m_up_laser_profile->init(pp_laser_name, ParmParse{"my_constants"}, common_params);
+
+    // The transverse factor of the antenna particles is stored with them
+    if (m_precompute_transverse && !m_current_injection) {
+        if (m_up_laser_profile->is_separable()) {
+            AddRealComp("laser_transverse_re");
+            AddRealComp("laser_transverse_im");
+        } else {
+            amrex::Print() << m_laser_name << ".precompute_transverse_profile is ignored:"
+                           << " the profile is not separable.\n";
+            m_precompute_transverse = false;
+        }
+    }
+    m_transverse_factor_computed.resize(maxLevel()+1, 0);
 }
 
 /* \brief Check if laser particles enter the box, and inject if necessary.
@@ -246,6 +275,9 @@ LaserParticleContainer::InitData (int lev)
 {
     if (m_e_max == amrex::Real(0.)) return; // Disable laser if amplitude is 0
 
+    // No antenna particles if the current is injected directly onto the grid
+    if (m_current_injection) return;
+
     // spacing of laser particles in the laser plane.
     // has to be done after geometry is set up.
     Real S_X, S_Y;
@@ -407,6 +439,9 @@ LaserParticleContainer::InitData (int lev)
                   np, particle_x.dataPtr(), particle_y.dataPtr(), particle_z.dataPtr(),
                   particle_ux.dataPtr(), particle_uy.dataPtr(), particle_uz.dataPtr(),
                   1, particle_w.dataPtr(), 1);
+
+    // The transverse factor of the new particles is computed at the next push
+    std::fill(m_transverse_factor_computed.begin(), m_transverse_factor_computed.end(), 0);
 }
 
 void
@@ -420,7 +455,8 @@ LaserParticleContainer::Evolve (int lev,
                                 MultiFab* rho, MultiFab* crho,
                                 const MultiFab*, const MultiFab*, const MultiFab*,
                                 const MultiFab*, const MultiFab*, const MultiFab*,
-                                Real t, Real dt, DtType /*a_dt_type*/)
+                                Real t, Real dt, DtType /*a_dt_type*/,
+                                bool skip_rho_old)
 {
     WARPX_PROFILE("LaserParticleContainer::Evolve()");
     WARPX_PROFILE_VAR_NS("LaserParticleContainer::Evolve::ParticlePush", blp_pp);
@@ -438,10 +474,19 @@ LaserParticleContainer::Evolve (int lev,
     // Update laser profile
     m_up_laser_profile->update(t);
 
+    if (m_current_injection) {
+        DepositLaserCurrentOnGrid(lev, jx, jy, jz, t, t_lab);
+        return;
+    }
+
     BL_ASSERT(OnSameGrids(lev,jx));
 
     amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
 
+    const bool compute_transverse = m_precompute_transverse && !m_transverse_factor_computed[lev];
+    const int transverse_re_comp = m_precompute_transverse ? particle_comps["laser_transverse_re"] : 0;
+    const int transverse_im_comp = m_precompute_transverse ? particle_comps["laser_transverse_im"] : 0;
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
@@ -456,11 +501,7 @@ LaserParticleContainer::Evolve (int lev,
 
         for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
         {
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-            }
-            Real wt = static_cast<Real>(amrex::second());
+            BoxCostTimer box_timer(cost, pti.index());
 
             auto& attribs = pti.GetAttribs();
 
@@ -477,7 +518,7 @@ LaserParticleContainer::Evolve (int lev,
             plane_Yp.resize(np);
             amplitude_E.resize(np);
 
-            if (rho) {
+            if (rho && !skip_rho_old) {
                 int* AMREX_RESTRICT ion_lev = nullptr;
                 DepositCharge(pti, wp, ion_lev, rho, 0, 0,
                               np_current, thread_num, lev, lev);
@@ -491,16 +532,34 @@ LaserParticleContainer::Evolve (int lev,
             // Particle Push
             //
             WARPX_PROFILE_VAR_START(blp_pp);
-            // Find the coordinates of the particles in the emission plane
-            calculate_laser_plane_coordinates(pti, np,
-                                              plane_Xp.dataPtr(),
-                                              plane_Yp.dataPtr());
+            if (m_precompute_transverse) {
+                ParticleReal* const transverse_re = pti.GetAttribs(transverse_re_comp).dataPtr();
+                ParticleReal* const transverse_im = pti.GetAttribs(transverse_im_comp).dataPtr();
+                if (compute_transverse) {
+                    calculate_laser_plane_coordinates(pti, np,
+                                                      plane_Xp.dataPtr(),
+                                                      plane_Yp.dataPtr());
+                    m_up_laser_profile->fill_transverse_factor(
+                        np, plane_Xp.dataPtr(), plane_Yp.dataPtr(),
+                        transverse_re, transverse_im);
+                }
 
-            // Calculate the laser amplitude to be emitted,
-            // at the position of the emission plane
-            m_up_laser_profile->fill_amplitude(
-                np, plane_Xp.dataPtr(), plane_Yp.dataPtr(),
-                t_lab, amplitude_E.dataPtr());
+                // Only the temporal factor changes from one step to the next
+                m_up_laser_profile->fill_amplitude_separable(
+                    np, transverse_re, transverse_im,
+                    t_lab, amplitude_E.dataPtr());
+            } else {
+                // Find the coordinates of the particles in the emission plane
+                calculate_laser_plane_coordinates(pti, np,
+                                                  plane_Xp.dataPtr(),
+                                                  plane_Yp.dataPtr());
+
+                // Calculate the laser amplitude to be emitted,
+                // at the position of the emission plane
+                m_up_laser_profile->fill_amplitude(
+                    np, plane_Xp.dataPtr(), plane_Yp.dataPtr(),
+                    t_lab, amplitude_E.dataPtr());
+            }
 
             // Calculate the corresponding momentum and position for the particles
             update_laser_particle(pti, np, uxp.dataPtr(), uyp.dataPtr(),
@@ -540,13 +599,226 @@ LaserParticleContainer::Evolve (int lev,
             // This is necessary because of plane_Xp, plane_Yp and amplitude_E
             amrex::Gpu::synchronize();
 
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
+            box_timer.stop();
+        }
+    }
+
+    if (compute_transverse) m_transverse_factor_computed[lev] = 1;
+}
+
+void
+LaserParticleContainer::DepositLaserCurrentOnGrid (const int lev,
+                                                   MultiFab& jx, MultiFab& jy, MultiFab& jz,
+                                                   const Real t, const Real t_lab)
+{
+    WARPX_PROFILE("LaserParticleContainer::DepositLaserCurrentOnGrid()");
+
+    const auto dx = Geom(lev).CellSizeArray();
+    const auto problo = Geom(lev).ProbLoArray();
+
+    // Thickness of the antenna along its normal, over which the
+    // current is spread with a linear shape
+    const std::array<Real,3>& dx3 = WarpX::CellSize(lev);
+    const Real eps = static_cast<Real>(dx3[0]*1.e-50);
+#if (AMREX_SPACEDIM == 3)
+    const Real dn = std::min(std::min(dx3[0]/(std::abs(m_nvec[0])+eps),
+                                      dx3[1]/(std::abs(m_nvec[1])+eps)),
+                                      dx3[2]/(std::abs(m_nvec[2])+eps));
+#else
+    const Real dn = std::min(dx3[0]/(std::abs(m_nvec[0])+eps),
+                             dx3[2]/(std::abs(m_nvec[2])+eps));
+#endif
+
+    // Position of the antenna. In the boosted frame, the antenna moves at -beta_boost*c.
+    Real r0[3] = {m_position[0], m_position[1], m_position[2]};
+    if (WarpX::gamma_boost > 1.) {
+        for (int idim = 0; idim < 3; ++idim) {
+            r0[idim] -= WarpX::beta_boost*PhysConst::c*t*m_nvec[idim];
+        }
+    }
+    const Real r0_x = r0[0], r0_y = r0[1], r0_z = r0[2];
+    const Real n_x = m_nvec[0], n_y = m_nvec[1], n_z = m_nvec[2];
+    const Real uX_x = m_u_X[0], uX_y = m_u_X[1], uX_z = m_u_X[2];
+    const Real uY_x = m_u_Y[0], uY_y = m_u_Y[1], uY_z = m_u_Y[2];
+#if (AMREX_SPACEDIM == 2)
+    amrex::ignore_unused(r0_y, uX_y, uY_x, uY_y, uY_z);
+#endif
+
+    // A current sheet K along p_X emits the field E = mu0*c*K/2 on both sides (the
+    // same current as the pairs of antenna particles). The amplitude is given in the
+    // lab frame, and is reduced by gamma_boost in the boosted frame (see ComputeWeightMobility).
+    const Real current_factor = 2._rt/(PhysConst::mu0*PhysConst::c*WarpX::gamma_boost);
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    const std::array<MultiFab*,3> j_fields = {&jx, &jy, &jz};
+
+    // For a separable profile and an antenna that does not move, the points of the grid on
+    // the antenna and their transverse factor are computed once, and only the temporal
+    // factor is computed at each step. They are computed again if the grids change.
+    const bool use_antenna_points = m_up_laser_profile->is_separable() && (WarpX::gamma_boost <= 1.);
+    if (use_antenna_points) {
+        const std::array<Real,AMREX_SPACEDIM> problo_arr = {AMREX_D_DECL(problo[0], problo[1], problo[2])};
+        const std::array<Real,3> r0_arr = {r0[0], r0[1], r0[2]};
+        if (!m_antenna_points_computed
+            || m_antenna_points_ba != jx.boxArray()
+            || m_antenna_points_dm != jx.DistributionMap()
+            || m_antenna_points_problo != problo_arr
+            || m_antenna_points_r0 != r0_arr)
+        {
+            m_antenna_points_computed = false;
+            m_antenna_points_ba = jx.boxArray();
+            m_antenna_points_dm = jx.DistributionMap();
+            m_antenna_points_problo = problo_arr;
+            m_antenna_points_r0 = r0_arr;
+            m_antenna_points.clear();
+            m_antenna_points.resize(MFIter(jx, TilingIfNotGPU()).length());
+        }
+    }
+    const bool compute_antenna_points = !use_antenna_points || !m_antenna_points_computed;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
+    {
+        Gpu::DeviceVector<int> cell_index;
+        Gpu::DeviceVector<Real> plane_Xp, plane_Yp, amplitude_E;
+
+        for (MFIter mfi(jx, TilingIfNotGPU()); mfi.isValid(); ++mfi)
+        {
+            BoxCostTimer box_timer(cost, mfi.index());
+
+            // Each point of the grid is owned by the tile of the cell of same index,
+            // so that the points shared by several boxes are only filled once
+            const Box bx = mfi.tilebox(IntVect::TheZeroVector());
+            const auto lo = amrex::lbound(bx);
+            const auto len = amrex::length(bx);
+            const int ncells = static_cast<int>(bx.numPts());
+
+            for (int icomp = 0; icomp < 3; ++icomp)
             {
-                wt = static_cast<Real>(amrex::second()) - wt;
-                amrex::HostDevice::Atomic::Add( &(*cost)[pti.index()], wt);
+                const Real p_X = m_p_X[icomp];
+                if (p_X == 0._rt) continue;
+
+                const IntVect nodal = j_fields[icomp]->ixType().toIntVect();
+                amrex::GpuArray<Real,AMREX_SPACEDIM> shift;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    shift[idim] = nodal[idim] ? 0._rt : 0.5_rt;
+                }
+
+                // Position of the point of index `icell` of the box, relative to the antenna
+                auto get_position = [=] AMREX_GPU_HOST_DEVICE (int icell, int& i, int& j, int& k,
+                                                              Real& x, Real& y, Real& z) noexcept
+                {
+                    i = lo.x + icell%len.x;
+                    j = lo.y + (icell/len.x)%len.y;
+                    k = lo.z + icell/(len.x*len.y);
+#if (AMREX_SPACEDIM == 3)
+                    x = problo[0] + (i + shift[0])*dx[0] - r0_x;
+                    y = problo[1] + (j + shift[1])*dx[1] - r0_y;
+                    z = problo[2] + (k + shift[2])*dx[2] - r0_z;
+#else
+                    x = problo[0] + (i + shift[0])*dx[0] - r0_x;
+                    y = 0._rt;
+                    z = problo[1] + (j + shift[1])*dx[1] - r0_z;
+#endif
+                };
+
+                AntennaPoints* const points = use_antenna_points ?
+                    &m_antenna_points[mfi.LocalTileIndex()][icomp] : nullptr;
+                Gpu::DeviceVector<int>& plane_index = points ? points->cell_index : cell_index;
+
+                if (compute_antenna_points) {
+                    // Find the points within one cell of the antenna plane
+                    plane_index.resize(ncells);
+                    int* const AMREX_RESTRICT p_plane_index = plane_index.dataPtr();
+                    const int nplane = amrex::Scan::PrefixSum<int>(ncells,
+                        [=] AMREX_GPU_DEVICE (int icell) -> int
+                        {
+                            int i, j, k;
+                            Real x, y, z;
+                            get_position(icell, i, j, k, x, y, z);
+                            return std::abs(n_x*x + n_y*y + n_z*z) < dn;
+                        },
+                        [=] AMREX_GPU_DEVICE (int icell, int const& s)
+                        {
+                            int i, j, k;
+                            Real x, y, z;
+                            get_position(icell, i, j, k, x, y, z);
+                            if (std::abs(n_x*x + n_y*y + n_z*z) < dn) p_plane_index[s] = icell;
+                        },
+                        amrex::Scan::Type::exclusive);
+                    plane_index.resize(nplane);
+                    if (nplane == 0) continue;
+
+                    // Coordinates of these points in the antenna plane
+                    plane_Xp.resize(nplane);
+                    plane_Yp.resize(nplane);
+                    Real* const AMREX_RESTRICT pplane_Xp = plane_Xp.dataPtr();
+                    Real* const AMREX_RESTRICT pplane_Yp = plane_Yp.dataPtr();
+                    amrex::ParallelFor(nplane,
+                        [=] AMREX_GPU_DEVICE (int ip) noexcept
+                        {
+                            int i, j, k;
+                            Real x, y, z;
+                            get_position(p_plane_index[ip], i, j, k, x, y, z);
+#if (AMREX_SPACEDIM == 3)
+                            pplane_Xp[ip] = uX_x*x + uX_y*y + uX_z*z;
+                            pplane_Yp[ip] = uY_x*x + uY_y*y + uY_z*z;
+#else
+                            pplane_Xp[ip] = uX_x*x + uX_z*z;
+                            pplane_Yp[ip] = 0._rt;
+#endif
+                        });
+
+                    if (points) {
+                        points->transverse_re.resize(nplane);
+                        points->transverse_im.resize(nplane);
+                        m_up_laser_profile->fill_transverse_factor(
+                            nplane, plane_Xp.dataPtr(), plane_Yp.dataPtr(),
+                            points->transverse_re.dataPtr(), points->transverse_im.dataPtr());
+                    }
+                }
+
+                const int nplane = static_cast<int>(plane_index.size());
+                if (nplane == 0) continue;
+                int const* const AMREX_RESTRICT p_cell_index = plane_index.dataPtr();
+
+                // Calculate the laser amplitude to be emitted at these points
+                amplitude_E.resize(nplane);
+                if (points) {
+                    m_up_laser_profile->fill_amplitude_separable(
+                        nplane, points->transverse_re.dataPtr(), points->transverse_im.dataPtr(),
+                        t_lab, amplitude_E.dataPtr());
+                } else {
+                    m_up_laser_profile->fill_amplitude(
+                        nplane, plane_Xp.dataPtr(), plane_Yp.dataPtr(),
+                        t_lab, amplitude_E.dataPtr());
+                }
+
+                // Add the current, spread along the normal of the antenna with a linear shape
+                Real const* const AMREX_RESTRICT amplitude = amplitude_E.dataPtr();
+                amrex::Array4<Real> const& j_arr = j_fields[icomp]->array(mfi);
+                amrex::ParallelFor(nplane,
+                    [=] AMREX_GPU_DEVICE (int ip) noexcept
+                    {
+                        int i, j, k;
+                        Real x, y, z;
+                        get_position(p_cell_index[ip], i, j, k, x, y, z);
+                        const Real d = std::abs(n_x*x + n_y*y + n_z*z);
+                        const Real shape = (1._rt - d/dn)/dn;
+                        j_arr(i, j, k) += current_factor*amplitude[ip]*shape*p_X;
+                    });
             }
+
+            // This is necessary because of cell_index, plane_Xp, plane_Yp and amplitude_E
+            amrex::Gpu::synchronize();
+
+            box_timer.stop();
         }
     }
+
+    if (use_antenna_points) m_antenna_points_computed = true;
 }
 
 void
@@ -557,6 +829,7 @@ LaserParticleContainer::PostRestart ()
     const int lev = finestLevel();
     ComputeSpacing(lev, Sx, Sy);
     ComputeWeightMobility(Sx, Sy);
+    std::fill(m_transverse_factor_computed.begin(), m_transverse_factor_computed.end(), 0);
 }
 
 void
@@ -12,16 +12,24 @@
 #include "MultiParticleContainer.H"
 #include "SpeciesPhysicalProperties.H"
 #include "WarpX.H"
+#include "Parallelization/CommStats.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/PhaseTimer.H"
 #ifdef WARPX_QED
     #include "Particles/ElementaryProcess/QEDInternals/SchwingerProcessWrapper.H"
     #include "Particles/ElementaryProcess/QEDSchwingerProcess.H"
     #include "Particles/ParticleCreation/FilterCreateTransformFromFAB.H"
 #endif
 
+#include <AMReX_Utility.H>
 #include <AMReX_Vector.H>
 
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
 #include <limits>
 #include <algorithm>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -252,6 +260,12 @@ MultiParticleContainer::ReadParameters ()
             amrex::Abort("unknown particle BC type");
         }
 
+        pp_particles.query("print_memory_usage", m_print_memory_usage);
+
+        std::vector<std::string> tile_shrink_intervals_string_vec = {"0"};
+        pp_particles.queryarr("tile_shrink_intervals", tile_shrink_intervals_string_vec);
+        m_tile_shrink_intervals = IntervalsParser(tile_shrink_intervals_string_vec);
+
         ParmParse pp_lasers("lasers");
         pp_lasers.queryarr("names", lasers_names);
 
@@ -267,6 +281,7 @@ MultiParticleContainer::ReadParameters ()
             getWithParser(pp_qed_schwinger, "y_size",m_qed_schwinger_y_size);
 #endif
             pp_qed_schwinger.query("threshold_poisson_gaussian", m_qed_schwinger_threshold_poisson_gaussian);
+            queryWithParser(pp_qed_schwinger, "threshold_field", m_qed_schwinger_threshold_field);
             queryWithParser(pp_qed_schwinger, "xmin", m_qed_schwinger_xmin);
             queryWithParser(pp_qed_schwinger, "xmax", m_qed_schwinger_xmax);
 #if (AMREX_SPACEDIM == 3)
@@ -321,7 +336,7 @@ MultiParticleContainer::Evolve (int lev,
                                 MultiFab* rho, MultiFab* crho,
                                 const MultiFab* cEx, const MultiFab* cEy, const MultiFab* cEz,
                                 const MultiFab* cBx, const MultiFab* cBy, const MultiFab* cBz,
-                                Real t, Real dt, DtType a_dt_type)
+                                Real t, Real dt, DtType a_dt_type, bool skip_rho_old)
 {
     jx.setVal(0.0);
     jy.setVal(0.0);
@@ -329,11 +344,16 @@ MultiParticleContainer::Evolve (int lev,
     if (cjx) cjx->setVal(0.0);
     if (cjy) cjy->setVal(0.0);
     if (cjz) cjz->setVal(0.0);
-    if (rho) rho->setVal(0.0);
-    if (crho) crho->setVal(0.0);
+    // With skip_rho_old, the charge before the push (the first half of the components)
+    // is kept, and only the charge after the push is reset
+    for (MultiFab* r : {rho, crho}) {
+        if (!r) continue;
+        const int icomp = skip_rho_old ? r->nComp()/2 : 0;
+        r->setVal(0.0, icomp, r->nComp()-icomp, r->nGrowVect());
+    }
     for (auto& pc : allcontainers) {
         pc->Evolve(lev, Ex, Ey, Ez, Bx, By, Bz, Ex_avg, Ey_avg, Ez_avg, Bx_avg, By_avg, Bz_avg, jx, jy, jz, cjx, cjy, cjz,
-                   rho, crho, cEx, cEy, cEz, cBx, cBy, cBz, t, dt, a_dt_type);
+                   rho, crho, cEx, cEy, cEz, cBx, cBy, cBz, t, dt, a_dt_type, skip_rho_old);
     }
 }
 
@@ -370,6 +390,21 @@ MultiParticleContainer::GetZeroChargeDensity (const int lev)
     return zero_rho;
 }
 
+std::unique_ptr<MultiFab>
+MultiParticleContainer::MakeChargeDensity (int lev)
+{
+    if (allcontainers.size() == 0) return GetZeroChargeDensity(lev);
+    return allcontainers[0]->MakeChargeDensity(lev);
+}
+
+void
+MultiParticleContainer::AddChargeDensity (MultiFab& rho, int lev)
+{
+    for (auto& pc : allcontainers) {
+        pc->AddChargeDensity(rho, lev);
+    }
+}
+
 std::unique_ptr<MultiFab>
 MultiParticleContainer::GetChargeDensity (int lev, bool local)
 {
@@ -380,11 +415,13 @@ MultiParticleContainer::GetChargeDensity (int lev, bool local)
     }
     else
     {
-        std::unique_ptr<MultiFab> rho = allcontainers[0]->GetChargeDensity(lev, true);
-        for (unsigned i = 1, n = allcontainers.size(); i < n; ++i) {
-            std::unique_ptr<MultiFab> rhoi = allcontainers[i]->GetChargeDensity(lev, true);
-            MultiFab::Add(*rho, *rhoi, 0, 0, rho->nComp(), rho->nGrowVect());
-        }
+        // All the species deposit on the same MultiFab
+        std::unique_ptr<MultiFab> rho = MakeChargeDensity(lev);
+        rho->setVal(0.0);
+        AddChargeDensity(*rho, lev);
+#ifdef WARPX_DIM_RZ
+        WarpX::GetInstance().ApplyInverseVolumeScalingToChargeDensity(rho.get(), lev);
+#endif
         if (!local) {
             const Geometry& gm = allcontainers[0]->Geom(lev);
             rho->SumBoundary(gm.periodicity());
@@ -404,6 +441,8 @@ MultiParticleContainer::SortParticlesByBin (amrex::IntVect bin_size)
 void
 MultiParticleContainer::Redistribute ()
 {
+    PhaseTimer timer(TimerPhase::Redistribute);
+    CommStats comm_stats(CommSite::Redistribute);
     for (auto& pc : allcontainers) {
         pc->Redistribute();
     }
@@ -417,9 +456,29 @@ MultiParticleContainer::defineAllParticleTiles ()
     }
 }
 
+void
+MultiParticleContainer::PrintMemoryUsage () const
+{
+    if (!m_print_memory_usage) return;
+    for (int i = 0; i < nSpecies(); ++i) {
+        allcontainers[i]->PrintMemoryUsage(species_names[i]);
+    }
+}
+
+void
+MultiParticleContainer::ShrinkParticleTiles (int step)
+{
+    if (!m_tile_shrink_intervals.contains(step)) return;
+    for (auto& pc : allcontainers) {
+        pc->ShrinkParticleTiles();
+    }
+}
+
 void
 MultiParticleContainer::RedistributeLocal (const int num_ghost)
 {
+    PhaseTimer timer(TimerPhase::Redistribute);
+    CommStats comm_stats(CommSite::Redistribute);
     for (auto& pc : allcontainers) {
         pc->Redistribute(0, 0, 0, num_ghost);
     }
@@ -513,50 +572,8 @@ MultiParticleContainer
     for (int i = 0; i < nspecies_back_transformed_diagnostics; ++i){
         int isp = map_species_back_transformed_diagnostics[i];
         WarpXParticleContainer* pc = allcontainers[isp].get();
-        WarpXParticleContainer::DiagnosticParticles diagnostic_particles;
-        pc->GetParticleSlice(direction, z_old, z_new, t_boost, t_lab, dt, diagnostic_particles);
-        // Here, diagnostic_particles[lev][index] is a WarpXParticleContainer::DiagnosticParticleData
-        // where "lev" is the AMR level and "index" is a [grid index][tile index] pair.
-
-        // Loop over AMR levels
-        for (int lev = 0; lev <= pc->finestLevel(); ++lev){
-            // Loop over [grid index][tile index] pairs
-            // and Fills parts[species number i] with particle data from all grids and
-            // tiles in diagnostic_particles. parts contains particles from all
-            // AMR levels indistinctly.
-            for (auto it = diagnostic_particles[lev].begin(); it != diagnostic_particles[lev].end(); ++it){
-                // it->first is the [grid index][tile index] key
-                // it->second is the corresponding
-                // WarpXParticleContainer::DiagnosticParticleData value
-                parts[i].GetRealData(DiagIdx::w).insert(  parts[i].GetRealData(DiagIdx::w  ).end(),
-                                                          it->second.GetRealData(DiagIdx::w  ).begin(),
-                                                          it->second.GetRealData(DiagIdx::w  ).end());
-
-                parts[i].GetRealData(DiagIdx::x).insert(  parts[i].GetRealData(DiagIdx::x  ).end(),
-                                                          it->second.GetRealData(DiagIdx::x  ).begin(),
-                                                          it->second.GetRealData(DiagIdx::x  ).end());
-
-                parts[i].GetRealData(DiagIdx::y).insert(  parts[i].GetRealData(DiagIdx::y  ).end(),
-                                                          it->second.GetRealData(DiagIdx::y  ).begin(),
-                                                          it->second.GetRealData(DiagIdx::y  ).end());
-
-                parts[i].GetRealData(DiagIdx::z).insert(  parts[i].GetRealData(DiagIdx::z  ).end(),
-                                                          it->second.GetRealData(DiagIdx::z  ).begin(),
-                                                          it->second.GetRealData(DiagIdx::z  ).end());
-
-                parts[i].GetRealData(DiagIdx::ux).insert(  parts[i].GetRealData(DiagIdx::ux).end(),
-                                                           it->second.GetRealData(DiagIdx::ux).begin(),
-                                                           it->second.GetRealData(DiagIdx::ux).end());
-
-                parts[i].GetRealData(DiagIdx::uy).insert(  parts[i].GetRealData(DiagIdx::uy).end(),
-                                                           it->second.GetRealData(DiagIdx::uy).begin(),
-                                                           it->second.GetRealData(DiagIdx::uy).end());
-
-                parts[i].GetRealData(DiagIdx::uz).insert(  parts[i].GetRealData(DiagIdx::uz).end(),
-                                                           it->second.GetRealData(DiagIdx::uz).begin(),
-                                                           it->second.GetRealData(DiagIdx::uz).end());
-            }
-        }
+        // parts contains particles from all AMR levels indistinctly
+        pc->GetParticleSlice(direction, z_old, z_new, t_boost, t_lab, dt, parts[i]);
     }
 }
 
@@ -602,6 +619,19 @@ MultiParticleContainer::doContinuousInjection () const
     return warpx_do_continuous_injection;
 }
 
+bool
+MultiParticleContainer::ParticlesChangeOutsideOfPush () const
+{
+#ifdef WARPX_QED
+    if (m_do_qed_schwinger) return true;
+#endif
+    for (auto const& pc : allcontainers) {
+        if (pc->DoFieldIonization() || pc->DoQED() || pc->do_resampling ||
+            pc->do_continuous_injection) return true;
+    }
+    return false;
+}
+
 /* \brief Get ID of product species of each species.
  * The users specifies the name of the product species,
  * this routine get its ID.
@@ -712,11 +742,7 @@ MultiParticleContainer::doFieldIonization (int lev,
 #endif
         for (WarpXParIter pti(*pc_source, lev, info); pti.isValid(); ++pti)
         {
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-            }
-            Real wt = amrex::second();
+            BoxCostTimer box_timer(cost, pti.index());
 
             auto& src_tile = pc_source ->ParticlesAt(lev, pti);
             auto& dst_tile = pc_product->ParticlesAt(lev, pti);
@@ -729,14 +755,9 @@ MultiParticleContainer::doFieldIonization (int lev,
             const auto num_added = filterCopyTransformParticles<1>(dst_tile, src_tile, np_dst,
                                                                    Filter, Copy, Transform);
 
-            setNewParticleIDs(dst_tile, np_dst, num_added);
+            setNewParticleIDs(dst_tile, np_dst, num_added, !pc_product->do_not_assign_ids);
 
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-                wt = amrex::second() - wt;
-                amrex::HostDevice::Atomic::Add( &(*cost)[pti.index()], wt);
-            }
+            box_timer.stop();
         }
     }
 }
@@ -861,6 +882,8 @@ void MultiParticleContainer::InitQuantumSync ()
     if(!m_shr_p_qs_engine->are_lookup_tables_initialized()){
         amrex::Abort("Table initialization has failed!");
     }
+    amrex::Print() << "Quantum Synchrotron tables: " << m_shr_p_qs_engine->get_lookup_tables_memory()
+                   << " bytes, " << 8*sizeof(QedTableReal) << "-bit values\n";
 }
 
 void MultiParticleContainer::InitBreitWheeler ()
@@ -912,6 +935,80 @@ void MultiParticleContainer::InitBreitWheeler ()
     if(!m_shr_p_bw_engine->are_lookup_tables_initialized()){
         amrex::Abort("Table initialization has failed!");
     }
+    amrex::Print() << "Breit Wheeler tables: " << m_shr_p_bw_engine->get_lookup_tables_memory()
+                   << " bytes, " << 8*sizeof(QedTableReal) << "-bit values\n";
+}
+
+namespace
+{
+    /** \brief Name of the file of the QED lookup table with the parameters `key`
+     * in the cache directory `cache_dir`: the name contains a 64-bit FNV-1a hash of `key` */
+    std::string QEDTableCacheFile (std::string const& cache_dir, std::string const& prefix,
+                                   std::string const& key)
+    {
+        std::uint64_t hash = 14695981039346656037ull;
+        for (char const c : key) {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        std::ostringstream name;
+        name << cache_dir << "/" << prefix << "_table_" << std::hex << hash << ".bin";
+        return name.str();
+    }
+
+    /** \brief Read the QED lookup table with the parameters `key` from the cache directory
+     * `cache_dir` (if not empty) on all the ranks. The cache files start with their key, so
+     * that a table is only used with the parameters and the format it was generated with.
+     * Returns whether the table was found. */
+    bool LoadQEDTableFromCache (std::string const& cache_dir, std::string const& prefix,
+                                std::string const& key, Vector<char>& table_data)
+    {
+        if (cache_dir.empty()) return false;
+        const std::string file_name = QEDTableCacheFile(cache_dir, prefix, key);
+        int found = 0;
+        if (ParallelDescriptor::IOProcessor()) {
+            found = std::ifstream(file_name, std::ios::binary).good() ? 1 : 0;
+        }
+        ParallelDescriptor::Bcast(&found, 1, ParallelDescriptor::IOProcessorNumber());
+        if (!found) return false;
+
+        Vector<char> file_data;
+        ParallelDescriptor::ReadAndBcastFile(file_name, file_data, false);
+        const std::size_t key_size = key.size() + 1;
+        if (file_data.size() < key_size ||
+            std::string(file_data.data(), key.size()) != key || file_data[key.size()] != '\0') {
+            amrex::Print() << "WARNING: ignoring the QED table " << file_name
+                           << ", which does not match the table parameters\n";
+            return false;
+        }
+        table_data = Vector<char>(file_data.begin() + key_size, file_data.end());
+        amrex::Print() << "QED table read from the cache " << file_name << "\n";
+        return true;
+    }
+
+    /** \brief Store the QED lookup table `data` with the parameters `key` in the cache
+     * directory `cache_dir` (if not empty). Must be called on the IO processor only. */
+    void StoreQEDTableInCache (std::string const& cache_dir, std::string const& prefix,
+                               std::string const& key, std::vector<char> const& data)
+    {
+        if (cache_dir.empty()) return;
+        if (!amrex::UtilCreateDirectory(cache_dir, 0755)) {
+            amrex::CreateDirectoryFailed(cache_dir);
+        }
+        Vector<char> file_data(key.begin(), key.end());
+        file_data.push_back('\0');
+        file_data.insert(file_data.end(), data.begin(), data.end());
+        WarpXUtilIO::WriteBinaryDataOnFile(QEDTableCacheFile(cache_dir, prefix, key), file_data);
+    }
+
+    /** \brief getWithParser for a parameter of the QED lookup tables, which are stored
+     * with QedTableReal (float with QED_TABLES_SINGLE=TRUE) */
+    void getQEDTableParam (const ParmParse& pp, char const * const str, QedTableReal& val)
+    {
+        amrex::Real tmp;
+        getWithParser(pp, str, tmp);
+        val = static_cast<QedTableReal>(tmp);
+    }
 }
 
 void
@@ -929,7 +1026,8 @@ MultiParticleContainer::QuantumSyncGenerateTable ()
     amrex::Real qs_minimum_chi_part;
     getWithParser(pp_qed_qs, "chi_min", qs_minimum_chi_part);
 
-    if(ParallelDescriptor::IOProcessor()){
+    {
+        // The parameters are read on all the ranks, to look for the table in the cache
         PicsarQuantumSyncCtrl ctrl;
 
         //==Table parameters==
@@ -940,11 +1038,11 @@ MultiParticleContainer::QuantumSyncGenerateTable ()
 
         //Minimun chi for the table. If a lepton has chi < tab_dndt_chi_min,
         //chi is considered as if it were equal to tab_dndt_chi_min
-        getWithParser(pp_qed_qs, "tab_dndt_chi_min", ctrl.dndt_params.chi_part_min);
+        getQEDTableParam(pp_qed_qs, "tab_dndt_chi_min", ctrl.dndt_params.chi_part_min);
 
         //Maximum chi for the table. If a lepton has chi > tab_dndt_chi_max,
         //chi is considered as if it were equal to tab_dndt_chi_max
-        getWithParser(pp_qed_qs, "tab_dndt_chi_max", ctrl.dndt_params.chi_part_max);
+        getQEDTableParam(pp_qed_qs, "tab_dndt_chi_max", ctrl.dndt_params.chi_part_max);
 
         //How many points should be used for chi in the table
         pp_qed_qs.get("tab_dndt_how_many", ctrl.dndt_params.chi_part_how_many);
@@ -957,11 +1055,11 @@ MultiParticleContainer::QuantumSyncGenerateTable ()
 
         //Minimun chi for the table. If a lepton has chi < tab_em_chi_min,
         //chi is considered as if it were equal to tab_em_chi_min
-        getWithParser(pp_qed_qs, "tab_em_chi_min", ctrl.phot_em_params.chi_part_min);
+        getQEDTableParam(pp_qed_qs, "tab_em_chi_min", ctrl.phot_em_params.chi_part_min);
 
         //Maximum chi for the table. If a lepton has chi > tab_em_chi_max,
         //chi is considered as if it were equal to tab_em_chi_max
-        getWithParser(pp_qed_qs, "tab_em_chi_max", ctrl.phot_em_params.chi_part_max);
+        getQEDTableParam(pp_qed_qs, "tab_em_chi_max", ctrl.phot_em_params.chi_part_max);
 
         //How many points should be used for chi in the table
         pp_qed_qs.get("tab_em_chi_how_many", ctrl.phot_em_params.chi_part_how_many);
@@ -969,17 +1067,41 @@ MultiParticleContainer::QuantumSyncGenerateTable ()
         //The other axis of the table is the ratio between the quantum
         //parameter of the emitted photon and the quantum parameter of the
         //lepton. This parameter is the minimum ratio to consider for the table.
-        getWithParser(pp_qed_qs, "tab_em_frac_min", ctrl.phot_em_params.frac_min);
+        getQEDTableParam(pp_qed_qs, "tab_em_frac_min", ctrl.phot_em_params.frac_min);
 
         //This parameter is the number of different points to consider for the second
         //axis
         pp_qed_qs.get("tab_em_frac_how_many", ctrl.phot_em_params.frac_how_many);
         //====================
 
-        m_shr_p_qs_engine->compute_lookup_tables(ctrl, qs_minimum_chi_part);
-        const auto data = m_shr_p_qs_engine->export_lookup_tables_data();
-        WarpXUtilIO::WriteBinaryDataOnFile(table_name,
-            Vector<char>{data.begin(), data.end()});
+        std::ostringstream key;
+        key << std::setprecision(17) << "WarpX quantum synchrotron table v1, " << sizeof(QedTableReal)
+            << " " << qs_minimum_chi_part
+            << " " << ctrl.dndt_params.chi_part_min << " " << ctrl.dndt_params.chi_part_max
+            << " " << ctrl.dndt_params.chi_part_how_many
+            << " " << ctrl.phot_em_params.chi_part_min << " " << ctrl.phot_em_params.chi_part_max
+            << " " << ctrl.phot_em_params.chi_part_how_many
+            << " " << ctrl.phot_em_params.frac_min << " " << ctrl.phot_em_params.frac_how_many;
+        std::string cache_dir;
+        pp_qed_qs.query("table_cache_dir", cache_dir);
+
+        Vector<char> table_data;
+        if (LoadQEDTableFromCache(cache_dir, "qs", key.str(), table_data)) {
+            m_shr_p_qs_engine->init_lookup_tables_from_raw_data(
+                table_data, qs_minimum_chi_part);
+            if (ParallelDescriptor::IOProcessor()) {
+                WarpXUtilIO::WriteBinaryDataOnFile(table_name, table_data);
+            }
+            return;
+        }
+
+        if(ParallelDescriptor::IOProcessor()){
+            m_shr_p_qs_engine->compute_lookup_tables(ctrl, qs_minimum_chi_part);
+            const auto data = m_shr_p_qs_engine->export_lookup_tables_data();
+            WarpXUtilIO::WriteBinaryDataOnFile(table_name,
+                Vector<char>{data.begin(), data.end()});
+            StoreQEDTableInCache(cache_dir, "qs", key.str(), data);
+        }
     }
 
     ParallelDescriptor::Barrier();
@@ -1010,7 +1132,8 @@ MultiParticleContainer::BreitWheelerGenerateTable ()
     amrex::Real bw_minimum_chi_part;
     getWithParser(pp_qed_bw, "chi_min", bw_minimum_chi_part);
 
-    if(ParallelDescriptor::IOProcessor()){
+    {
+        // The parameters are read on all the ranks, to look for the table in the cache
         PicsarBreitWheelerCtrl ctrl;
 
         //==Table parameters==
@@ -1021,11 +1144,11 @@ MultiParticleContainer::BreitWheelerGenerateTable ()
 
         //Minimun chi for the table. If a photon has chi < tab_dndt_chi_min,
         //an analytical approximation is used.
-        getWithParser(pp_qed_bw, "tab_dndt_chi_min", ctrl.dndt_params.chi_phot_min);
+        getQEDTableParam(pp_qed_bw, "tab_dndt_chi_min", ctrl.dndt_params.chi_phot_min);
 
         //Maximum chi for the table. If a photon has chi > tab_dndt_chi_max,
         //an analytical approximation is used.
-        getWithParser(pp_qed_bw, "tab_dndt_chi_max", ctrl.dndt_params.chi_phot_max);
+        getQEDTableParam(pp_qed_bw, "tab_dndt_chi_max", ctrl.dndt_params.chi_phot_max);
 
         //How many points should be used for chi in the table
         pp_qed_bw.get("tab_dndt_how_many", ctrl.dndt_params.chi_phot_how_many);
@@ -1038,11 +1161,11 @@ MultiParticleContainer::BreitWheelerGenerateTable ()
 
         //Minimun chi for the table. If a photon has chi < tab_pair_chi_min
         //chi is considered as it were equal to chi_phot_tpair_min
-        getWithParser(pp_qed_bw, "tab_pair_chi_min", ctrl.pair_prod_params.chi_phot_min);
+        getQEDTableParam(pp_qed_bw, "tab_pair_chi_min", ctrl.pair_prod_params.chi_phot_min);
 
         //Maximum chi for the table. If a photon has chi > tab_pair_chi_max
         //chi is considered as it were equal to chi_phot_tpair_max
-        getWithParser(pp_qed_bw, "tab_pair_chi_max", ctrl.pair_prod_params.chi_phot_max);
+        getQEDTableParam(pp_qed_bw, "tab_pair_chi_max", ctrl.pair_prod_params.chi_phot_max);
 
         //How many points should be used for chi in the table
         pp_qed_bw.get("tab_pair_chi_how_many", ctrl.pair_prod_params.chi_phot_how_many);
@@ -1053,10 +1176,34 @@ MultiParticleContainer::BreitWheelerGenerateTable ()
         pp_qed_bw.get("tab_pair_frac_how_many", ctrl.pair_prod_params.frac_how_many);
         //====================
 
-        m_shr_p_bw_engine->compute_lookup_tables(ctrl, bw_minimum_chi_part);
-        const auto data = m_shr_p_bw_engine->export_lookup_tables_data();
-        WarpXUtilIO::WriteBinaryDataOnFile(table_name,
-            Vector<char>{data.begin(), data.end()});
+        std::ostringstream key;
+        key << std::setprecision(17) << "WarpX Breit-Wheeler table v1, " << sizeof(QedTableReal)
+            << " " << bw_minimum_chi_part
+            << " " << ctrl.dndt_params.chi_phot_min << " " << ctrl.dndt_params.chi_phot_max
+            << " " << ctrl.dndt_params.chi_phot_how_many
+            << " " << ctrl.pair_prod_params.chi_phot_min << " " << ctrl.pair_prod_params.chi_phot_max
+            << " " << ctrl.pair_prod_params.chi_phot_how_many
+            << " " << ctrl.pair_prod_params.frac_how_many;
+        std::string cache_dir;
+        pp_qed_bw.query("table_cache_dir", cache_dir);
+
+        Vector<char> table_data;
+        if (LoadQEDTableFromCache(cache_dir, "bw", key.str(), table_data)) {
+            m_shr_p_bw_engine->init_lookup_tables_from_raw_data(
+                table_data, bw_minimum_chi_part);
+            if (ParallelDescriptor::IOProcessor()) {
+                WarpXUtilIO::WriteBinaryDataOnFile(table_name, table_data);
+            }
+            return;
+        }
+
+        if(ParallelDescriptor::IOProcessor()){
+            m_shr_p_bw_engine->compute_lookup_tables(ctrl, bw_minimum_chi_part);
+            const auto data = m_shr_p_bw_engine->export_lookup_tables_data();
+            WarpXUtilIO::WriteBinaryDataOnFile(table_name,
+                Vector<char>{data.begin(), data.end()});
+            StoreQEDTableInCache(cache_dir, "bw", key.str(), data);
+        }
     }
 
     ParallelDescriptor::Barrier();
@@ -1124,6 +1271,14 @@ MultiParticleContainer::doQEDSchwinger ()
     const MultiFab & By = warpx.getBfield(level_0,1);
     const MultiFab & Bz = warpx.getBfield(level_0,2);
 
+    // The electric field in the frame where E and B are parallel, which sets the pair
+    // production rate, is at most |E|: no pair is created where |E| is well below the
+    // Schwinger field
+    const amrex::Real schwinger_field = PhysConst::m_e*PhysConst::m_e*PhysConst::c*PhysConst::c*
+        PhysConst::c/(PhysConst::q_e*PhysConst::hbar);
+    const amrex::Real threshold_E = m_qed_schwinger_threshold_field*schwinger_field;
+    const amrex::Real threshold_E2 = threshold_E*threshold_E;
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
@@ -1147,6 +1302,20 @@ MultiParticleContainer::doQEDSchwinger ()
         const auto& arrBy = By[mfi].array();
         const auto& arrBz = Bz[mfi].array();
 
+        // Cheap pass over the tile: skip it if no cell has a field above the threshold
+        if (threshold_E2 > 0._rt) {
+            ReduceOps<ReduceOpMax> reduce_op;
+            ReduceData<amrex::Real> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(box, reduce_data,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k) -> ReduceTuple
+            {
+                return {arrEx(i,j,k)*arrEx(i,j,k) + arrEy(i,j,k)*arrEy(i,j,k) +
+                        arrEz(i,j,k)*arrEz(i,j,k)};
+            });
+            if (amrex::get<0>(reduce_data.value()) < threshold_E2) {continue;}
+        }
+
         const Array4<const amrex::Real> array_EMFAB [] = {arrEx,arrEy,arrEz,
                                            arrBx,arrBy,arrBz};
 
@@ -1158,7 +1327,7 @@ MultiParticleContainer::doQEDSchwinger ()
 
         const auto Filter  = SchwingerFilterFunc{
                               m_qed_schwinger_threshold_poisson_gaussian,
-                              dV, dt};
+                              dV, dt, threshold_E2};
 
         const SmartCreateFactory create_factory_ele(*pc_product_ele);
         const SmartCreateFactory create_factory_pos(*pc_product_pos);
@@ -1173,8 +1342,8 @@ MultiParticleContainer::doQEDSchwinger ()
                                np_pos_dst,Filter, CreateEle, CreatePos,
                                 Transform);
 
-        setNewParticleIDs(dst_ele_tile, np_ele_dst, num_added);
-        setNewParticleIDs(dst_pos_tile, np_pos_dst, num_added);
+        setNewParticleIDs(dst_ele_tile, np_ele_dst, num_added, !pc_product_ele->do_not_assign_ids);
+        setNewParticleIDs(dst_pos_tile, np_pos_dst, num_added, !pc_product_pos->do_not_assign_ids);
 
     }
 }
@@ -1302,11 +1471,7 @@ void MultiParticleContainer::doQedBreitWheeler (int lev,
 #endif
         for (WarpXParIter pti(*pc_source, lev, info); pti.isValid(); ++pti)
         {
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-            }
-            Real wt = amrex::second();
+            BoxCostTimer box_timer(cost, pti.index());
 
             auto Transform = PairGenerationTransformFunc(pair_gen_functor,
                                                          pti, lev, Ex.nGrowVect(),
@@ -1320,20 +1485,28 @@ void MultiParticleContainer::doQedBreitWheeler (int lev,
 
             const auto np_dst_ele = dst_ele_tile.numParticles();
             const auto np_dst_pos = dst_pos_tile.numParticles();
-            const auto num_added = filterCopyTransformParticles<1>(
+
+            // Only the photons flagged during the push are tested, if possible
+            int const* event_list = nullptr;
+            const int num_events = pc_source->TakeQEDEvents(
+                lev, pti.GetPairIndex(), src_tile.numParticles(), event_list);
+            const auto num_added = (num_events >= 0) ?
+                filterCopyTransformParticlesFromList<1>(
+                                                      dst_ele_tile, dst_pos_tile,
+                                                      src_tile, event_list, num_events,
+                                                      np_dst_ele, np_dst_pos,
+                                                      Filter, CopyEle, CopyPos, Transform) :
+                filterCopyTransformParticles<1>(
                                                       dst_ele_tile, dst_pos_tile,
                                                       src_tile, np_dst_ele, np_dst_pos,
                                                       Filter, CopyEle, CopyPos, Transform);
 
-            setNewParticleIDs(dst_ele_tile, np_dst_ele, num_added);
-            setNewParticleIDs(dst_pos_tile, np_dst_pos, num_added);
+            setNewParticleIDs(dst_ele_tile, np_dst_ele, num_added,
+                              !pc_product_ele->do_not_assign_ids);
+            setNewParticleIDs(dst_pos_tile, np_dst_pos, num_added,
+                              !pc_product_pos->do_not_assign_ids);
 
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-                wt = amrex::second() - wt;
-                amrex::HostDevice::Atomic::Add( &(*cost)[pti.index()], wt);
-            }
+            box_timer.stop();
         }
     }
 }
@@ -1378,11 +1551,7 @@ void MultiParticleContainer::doQedQuantumSync (int lev,
 #endif
         for (WarpXParIter pti(*pc_source, lev, info); pti.isValid(); ++pti)
         {
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-            }
-            Real wt = amrex::second();
+            BoxCostTimer box_timer(cost, pti.index());
 
             auto Transform = PhotonEmissionTransformFunc(
                   m_shr_p_qs_engine->build_optical_depth_functor(),
@@ -1398,22 +1567,24 @@ void MultiParticleContainer::doQedQuantumSync (int lev,
 
             const auto np_dst = dst_tile.numParticles();
 
-            const auto num_added =
+            // Only the particles flagged during the push are tested, if possible
+            int const* event_list = nullptr;
+            const int num_events = pc_source->TakeQEDEvents(
+                lev, pti.GetPairIndex(), src_tile.numParticles(), event_list);
+            const auto num_added = (num_events >= 0) ?
+                filterCopyTransformParticlesFromList<1>(dst_tile, src_tile,
+                                                        event_list, num_events, np_dst,
+                                                        Filter, CopyPhot, Transform) :
                 filterCopyTransformParticles<1>(dst_tile, src_tile, np_dst,
                                                 Filter, CopyPhot, Transform);
 
-            setNewParticleIDs(dst_tile, np_dst, num_added);
+            setNewParticleIDs(dst_tile, np_dst, num_added, !pc_product_phot->do_not_assign_ids);
 
             cleanLowEnergyPhotons(
                                   dst_tile, np_dst, num_added,
                                   m_quantum_sync_photon_creation_energy_threshold);
 
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-                wt = amrex::second() - wt;
-                amrex::HostDevice::Atomic::Add( &(*cost)[pti.index()], wt);
-            }
+            box_timer.stop();
         }
     }
 }
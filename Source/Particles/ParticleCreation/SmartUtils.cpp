@@ -7,6 +7,8 @@
  */
 #include "SmartUtils.H"
 
+#include <AMReX_ParmParse.H>
+
 PolicyVec getPolicies (const NameMap& names) noexcept
 {
     PolicyVec policies;
@@ -50,3 +52,26 @@ SmartCopyTag getSmartCopyTag (const NameMap& src, const NameMap& dst) noexcept
 
     return tag;
 }
+
+amrex::Real ParticleTileCapacity::growth_factor = 1.5;
+amrex::Long ParticleTileCapacity::max_growth = 0;
+amrex::Real ParticleTileCapacity::free_memory_fraction = 0.5;
+amrex::Real ParticleTileCapacity::shrink_threshold = 0.25;
+
+void ParticleTileCapacity::ReadParameters ()
+{
+    static bool initialized = false;
+    if (initialized) return;
+
+    amrex::ParmParse pp_particles("particles");
+    pp_particles.query("tile_growth_factor", growth_factor);
+    pp_particles.query("tile_max_growth", max_growth);
+    pp_particles.query("tile_growth_free_memory_fraction", free_memory_fraction);
+    pp_particles.query("tile_shrink_threshold", shrink_threshold);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(growth_factor >= 1.,
+        "particles.tile_growth_factor must be >= 1");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(shrink_threshold >= 0. && shrink_threshold <= 1.,
+        "particles.tile_shrink_threshold must be between 0 and 1");
+
+    initialized = true;
+}
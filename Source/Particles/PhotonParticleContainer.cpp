@@ -7,6 +7,8 @@
  */
 #include "PhotonParticleContainer.H"
 #include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+#include "Utils/BoxCostTimer.H"
 #include "WarpX.H"
 
 // Import low-level single-particle kernels
@@ -53,6 +55,17 @@ PhotonParticleContainer::PhotonParticleContainer (AmrCore* amr_core, int ispecie
         //_________________________________________________________
 #endif
 
+    // Photons only carry w, ux, uy, uz (and optical_depth_BW with QED):
+    // reject the options that would add runtime attributes or deposition
+    WarpXUtilMsg::AlwaysAssert(
+        !do_field_ionization,
+        "ERROR: can't enable field ionization for photon species '" + species_name + "'."
+    );
+    WarpXUtilMsg::AlwaysAssert(
+        !do_splitting,
+        "ERROR: can't enable splitting for photon species '" + species_name + "'."
+    );
+
 }
 
 void PhotonParticleContainer::InitData()
@@ -75,7 +88,8 @@ PhotonParticleContainer::PushPX (WarpXParIter& pti,
                                  const long offset,
                                  const long np_to_push,
                                  int lev, int gather_lev,
-                                 amrex::Real dt, ScaleFields /*scaleFields*/, DtType a_dt_type)
+                                 amrex::Real dt, ScaleFields /*scaleFields*/, DtType a_dt_type,
+                                 const long* pid)
 {
     // Get cell size on gather_lev
     const std::array<Real,3>& dx = WarpX::CellSize(std::max(gather_lev,0));
@@ -104,21 +118,28 @@ PhotonParticleContainer::PushPX (WarpXParIter& pti,
     BreitWheelerEvolveOpticalDepth evolve_opt;
     amrex::ParticleReal* AMREX_RESTRICT p_optical_depth_BW = nullptr;
     const bool local_has_breit_wheeler = has_breit_wheeler();
+    QEDEventListView qed_events;
     if (local_has_breit_wheeler) {
         evolve_opt = m_shr_p_bw_engine->build_evolve_functor();
         p_optical_depth_BW = pti.GetAttribs(particle_comps["optical_depth_BW"]).dataPtr();
+        qed_events = GetQEDEventListView(pti);
     }
 #endif
 
-    auto copyAttribs = CopyParticleAttribs(pti, tmp_particle_data);
     int do_copy = (WarpX::do_back_transformed_diagnostics &&
                    do_back_transformed_diagnostics && a_dt_type!=DtType::SecondHalf);
 
-    const auto GetPosition = GetParticlePosition(pti, offset);
-    auto SetPosition = SetParticlePosition(pti, offset);
+    // With the particle indices pid, the particles that are pushed are pid[offset:offset+np_to_push]
+    const long p_offset = pid ? 0 : offset;
+    const long* const p_pid = pid ? pid + offset : nullptr;
 
-    const auto getExternalE = GetExternalEField(pti, offset);
-    const auto getExternalB = GetExternalBField(pti, offset);
+    auto copyAttribs = CopyParticleAttribs(pti, tmp_particle_data, p_offset);
+
+    const auto GetPosition = GetParticlePosition(pti, p_offset);
+    auto SetPosition = SetParticlePosition(pti, p_offset);
+
+    const auto getExternalE = GetExternalEField(pti, p_offset);
+    const auto getExternalB = GetExternalBField(pti, p_offset);
 
     // Lower corner of tile box physical domain (take into account Galilean shift)
     amrex::Real cur_time = WarpX::GetInstance().gett_new(lev);
@@ -157,7 +178,8 @@ PhotonParticleContainer::PushPX (WarpXParIter& pti,
 
     amrex::ParallelFor(
         np_to_push,
-        [=] AMREX_GPU_DEVICE (long i) {
+        [=] AMREX_GPU_DEVICE (long ip) {
+            const long i = p_pid ? p_pid[ip] : ip;
             if (do_copy) copyAttribs(i);
             ParticleReal x, y, z;
             GetPosition(i, x, y, z);
@@ -176,14 +198,19 @@ PhotonParticleContainer::PushPX (WarpXParIter& pti,
             getExternalE(i, Exp, Eyp, Ezp);
             getExternalB(i, Bxp, Byp, Bzp);
 
+            const long it = i + p_offset;
 #ifdef WARPX_QED
             if (local_has_breit_wheeler) {
-                evolve_opt(ux[i], uy[i], uz[i], Exp, Eyp, Ezp, Bxp, Byp, Bzp,
-                    dt, p_optical_depth_BW[i]);
+                evolve_opt(ux[it], uy[it], uz[it], Exp, Eyp, Ezp, Bxp, Byp, Bzp,
+                    dt, p_optical_depth_BW[it]);
+                // Pair generation candidate, see MultiParticleContainer::doQedBreitWheeler
+                if (qed_events.m_idx && p_optical_depth_BW[it] < 0._rt) {
+                    qed_events.flag(static_cast<int>(it));
+                }
             }
 #endif
 
-            UpdatePositionPhoton( x, y, z, ux[i], uy[i], uz[i], dt );
+            UpdatePositionPhoton( x, y, z, ux[it], uy[it], uz[it], dt );
             SetPosition(i, x, y, z);
         }
     );
@@ -195,25 +222,127 @@ PhotonParticleContainer::Evolve (int lev,
                                  const MultiFab& Bx, const MultiFab& By, const MultiFab& Bz,
                                  const MultiFab& Ex_avg, const MultiFab& Ey_avg, const MultiFab& Ez_avg,
                                  const MultiFab& Bx_avg, const MultiFab& By_avg, const MultiFab& Bz_avg,
-                                 MultiFab& jx, MultiFab& jy, MultiFab& jz,
-                                 MultiFab* cjx, MultiFab* cjy, MultiFab* cjz,
-                                 MultiFab* rho, MultiFab* crho,
+                                 MultiFab& /*jx*/, MultiFab& /*jy*/, MultiFab& /*jz*/,
+                                 MultiFab* cjx, MultiFab* /*cjy*/, MultiFab* /*cjz*/,
+                                 MultiFab* /*rho*/, MultiFab* /*crho*/,
                                  const MultiFab* cEx, const MultiFab* cEy, const MultiFab* cEz,
                                  const MultiFab* cBx, const MultiFab* cBy, const MultiFab* cBz,
-                                 Real t, Real dt, DtType /*a_dt_type*/)
+                                 Real /*t*/, Real dt, DtType a_dt_type,
+                                 bool /*skip_rho_old*/)
 {
-    // This does gather, push and depose.
-    // Push and depose have been re-written for photons
-    PhysicalParticleContainer::Evolve (lev,
-                                       Ex, Ey, Ez,
-                                       Bx, By, Bz,
-                                       Ex_avg, Ey_avg, Ez_avg,
-                                       Bx_avg, By_avg, Bz_avg,
-                                       jx, jy, jz,
-                                       cjx, cjy, cjz,
-                                       rho, crho,
-                                       cEx, cEy, cEz,
-                                       cBx, cBy, cBz,
-                                       t, dt);
+    // Photons carry no charge: this only gathers and pushes. Unlike
+    // PhysicalParticleContainer::Evolve, there is no charge/current deposition,
+    // no fused push-deposit kernel and no splitting.
+    WARPX_PROFILE("PhotonParticleContainer::Evolve()");
+    WARPX_PROFILE_VAR_NS("PhotonParticleContainer::Evolve::GatherAndPush", blp_fg);
+
+    amrex::LayoutData<amrex::Real>* cost = WarpX::getCosts(lev);
+
+    const iMultiFab* current_masks = WarpX::CurrentBufferMasks(lev);
+    const iMultiFab* gather_masks = WarpX::GatherBufferMasks(lev);
+
+    const bool has_buffer = cEx || cjx;
+
+    if (WarpX::do_back_transformed_diagnostics && do_back_transformed_diagnostics)
+    {
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            const auto np = pti.numParticles();
+            const auto t_lev = pti.GetLevel();
+            const auto index = pti.GetPairIndex();
+            tmp_particle_data.resize(finestLevel()+1);
+            for (int i = 0; i < TmpIdx::nattribs; ++i) {
+                auto& tmp = tmp_particle_data[t_lev][index][i];
+                tmp.resize(np);
+                // release the copies of the tiles that no longer have particles
+                if (np == 0) tmp.shrink_to_fit();
+            }
+        }
+    }
+
+    if (do_not_push) return;
+
+    InitSoAPositions(lev);
+#ifdef WARPX_QED
+    // The push flags the particles that undergo a QED event at this step
+    ResetQEDEventLists(lev);
+#endif
 
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+    {
+        // Order of the particles of a tile for the gather buffers
+        Gpu::DeviceVector<long> buffer_pid;
+
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            BoxCostTimer box_timer(cost, pti.index());
+
+            const long np = pti.numParticles();
+
+            // Data on the grid
+            FArrayBox const* exfab = WarpX::fft_do_time_averaging ? &(Ex_avg[pti]) : &(Ex[pti]);
+            FArrayBox const* eyfab = WarpX::fft_do_time_averaging ? &(Ey_avg[pti]) : &(Ey[pti]);
+            FArrayBox const* ezfab = WarpX::fft_do_time_averaging ? &(Ez_avg[pti]) : &(Ez[pti]);
+            FArrayBox const* bxfab = WarpX::fft_do_time_averaging ? &(Bx_avg[pti]) : &(Bx[pti]);
+            FArrayBox const* byfab = WarpX::fft_do_time_averaging ? &(By_avg[pti]) : &(By[pti]);
+            FArrayBox const* bzfab = WarpX::fft_do_time_averaging ? &(Bz_avg[pti]) : &(Bz[pti]);
+
+            if (WarpX::use_fdtd_nci_corr)
+            {
+                applyNCIFilter(lev, false, pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab);
+            }
+
+            // Determine which particles gather in the buffer (only the
+            // gather partition is used, since photons do not deposit)
+            long nfine_current = np;
+            long nfine_gather = np;
+            const long* pid = nullptr;
+            if (has_buffer) {
+                PartitionParticlesInBuffers( nfine_current, nfine_gather, np,
+                    pti, lev, current_masks, gather_masks, buffer_pid );
+                if (nfine_gather != np) pid = buffer_pid.dataPtr();
+            }
+
+            CopyPositionsToSoA(pti);
+
+            const long np_gather = (cEx) ? nfine_gather : np;
+
+            WARPX_PROFILE_VAR_START(blp_fg);
+            PushPX(pti, exfab, eyfab, ezfab,
+                   bxfab, byfab, bzfab,
+                   Ex.nGrowVect(), 0,
+                   0, np_gather, lev, lev, dt, ScaleFields(false), a_dt_type, pid);
+
+            if (np_gather < np)
+            {
+                FArrayBox const* cexfab = &(*cEx)[pti];
+                FArrayBox const* ceyfab = &(*cEy)[pti];
+                FArrayBox const* cezfab = &(*cEz)[pti];
+                FArrayBox const* cbxfab = &(*cBx)[pti];
+                FArrayBox const* cbyfab = &(*cBy)[pti];
+                FArrayBox const* cbzfab = &(*cBz)[pti];
+
+                if (WarpX::use_fdtd_nci_corr)
+                {
+                    applyNCIFilter(lev, true, pti,
+                                   cexfab, ceyfab, cezfab, cbxfab, cbyfab, cbzfab);
+                }
+
+                // Field gather and push for particles in gather buffers
+                PushPX(pti, cexfab, ceyfab, cezfab,
+                       cbxfab, cbyfab, cbzfab,
+                       cEx->nGrowVect(), 0,
+                       nfine_gather, np-nfine_gather,
+                       lev, lev-1, dt, ScaleFields(false), a_dt_type, pid);
+            }
+            WARPX_PROFILE_VAR_STOP(blp_fg);
+
+            amrex::Gpu::synchronize();
+
+            box_timer.stop();
+        }
+    }
+    InvalidateSoAPositions(lev);
 }
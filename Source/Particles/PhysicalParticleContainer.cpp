@@ -14,14 +14,20 @@
 #include "WarpX.H"
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpXUtil.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/HardwareCounters.H"
 #include "Python/WarpXWrappers.h"
 #include "Utils/IonizationEnergiesTable.H"
 #include "Particles/Gather/FieldGather.H"
 #include "Particles/Pusher/GetAndSetPosition.H"
 #include "Particles/Pusher/CopyParticleAttribs.H"
 #include "Particles/Pusher/PushSelector.H"
+#include "Particles/ParticleCreation/FilterCopyTransform.H"
+#include "Particles/ParticleCreation/SmartCopy.H"
 #include "Particles/Gather/GetExternalFields.H"
+#include "Particles/Deposition/CurrentDeposition.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/CounterRNG.H"
 
 #include <AMReX_Geometry.H>
 #include <AMReX_Print.H>
@@ -31,10 +37,17 @@
 #   include <openPMD/openPMD.hpp>
 #endif
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
+#include <cstdint>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <string>
+#include <thread>
+#include <utility>
 
 using namespace amrex;
 
@@ -66,6 +79,54 @@ namespace
         return z0;
     }
 
+    // Map the particles from the lab frame to the boosted frame.
+    // This boosts the particle to the lab frame and calculates
+    // the particle time in the boosted frame. It then maps
+    // the position to the time in the boosted frame.
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void mapParticleToBoostedFrame (Real& x, Real& y, Real& z, Real& ux, Real& uy, Real& uz,
+                                    Real gamma_boost, Real beta_boost,
+                                    bool do_backward_propagation,
+                                    bool boost_adjust_transverse_positions) noexcept
+    {
+        // For now, start with the assumption that this will only happen
+        // at the start of the simulation.
+        const Real t_lab = 0._rt;
+
+        const Real uz_boost = gamma_boost*beta_boost*PhysConst::c;
+
+        // tpr is the particle's time in the boosted frame
+        Real tpr = gamma_boost*t_lab - uz_boost*z/(PhysConst::c*PhysConst::c);
+
+        // The particle's transformed location in the boosted frame
+        Real xpr = x;
+        Real ypr = y;
+        Real zpr = gamma_boost*z - uz_boost*t_lab;
+
+        // transform u and gamma to the boosted frame
+        Real gamma_lab = std::sqrt(1._rt + (ux*ux + uy*uy + uz*uz)/(PhysConst::c*PhysConst::c));
+        // ux = ux;
+        // uy = uy;
+        uz = gamma_boost*uz - uz_boost*gamma_lab;
+        Real gammapr = std::sqrt(1._rt + (ux*ux + uy*uy + uz*uz)/(PhysConst::c*PhysConst::c));
+
+        Real vxpr = ux/gammapr;
+        Real vypr = uy/gammapr;
+        Real vzpr = uz/gammapr;
+
+        if (do_backward_propagation){
+            uz = -uz;
+        }
+
+        // Move the particles to where they will be at t = 0 in the boosted frame
+        if (boost_adjust_transverse_positions) {
+            x = xpr - tpr*vxpr;
+            y = ypr - tpr*vypr;
+        }
+
+        z = zpr - tpr*vzpr;
+    }
+
     AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
     XDim3 getCellCoords (const GpuArray<Real, AMREX_SPACEDIM>& lo_corner,
                          const GpuArray<Real, AMREX_SPACEDIM>& dx,
@@ -88,6 +149,83 @@ namespace
 #endif
         return pos;
     }
+
+    /** \brief Transform used by SplitParticles: the `nsplit` copies of the parent
+     * particle `i_src` (at `i_dst`, ..., `i_dst+nsplit-1`) are shifted by `split_offset`
+     * along each diagonal (`split_type` = 0) or along each axis (`split_type` = 1), and
+     * share the weight of the parent, which is invalidated. */
+    template <int nsplit, int split_type>
+    struct SplitParticleTransform
+    {
+        amrex::GpuArray<ParticleReal,3> split_offset;
+
+        template <typename DstData, typename SrcData>
+        AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+        void operator() (DstData& dst, SrcData& src, int i_src, int i_dst,
+                         amrex::RandomEngine const& /*engine*/) const noexcept
+        {
+            auto& p = src.m_aos[i_src];
+#if defined(WARPX_DIM_RZ)
+            const ParticleReal theta = src.m_rdata[PIdx::theta][i_src];
+            const ParticleReal xp = p.pos(0)*std::cos(theta);
+            const ParticleReal yp = p.pos(0)*std::sin(theta);
+            const ParticleReal zp = p.pos(1);
+#elif (AMREX_SPACEDIM == 3)
+            const ParticleReal xp = p.pos(0);
+            const ParticleReal yp = p.pos(1);
+            const ParticleReal zp = p.pos(2);
+#else
+            const ParticleReal xp = p.pos(0);
+            const ParticleReal yp = 0._rt;
+            const ParticleReal zp = p.pos(1);
+#endif
+            const ParticleReal w = src.m_rdata[PIdx::w][i_src]/nsplit;
+
+            for (int j = 0; j < nsplit; ++j) {
+                // shifts (-1, 0 or 1) of the split particle j
+                int ishift = 0, jshift = 0, kshift = 0;
+                if (split_type == 0) {
+#if (AMREX_SPACEDIM == 3)
+                    ishift = 2*((j >> 2) & 1) - 1;
+                    jshift = 2*((j >> 1) & 1) - 1;
+#else
+                    ishift = 2*((j >> 1) & 1) - 1;
+#endif
+                    kshift = 2*(j & 1) - 1;
+                } else {
+                    const int shift = (j < AMREX_SPACEDIM) ? -1 : 1;
+                    const int axis = j % AMREX_SPACEDIM;
+                    if (axis == 0) ishift = shift;
+#if (AMREX_SPACEDIM == 3)
+                    else if (axis == 1) jshift = shift;
+#endif
+                    else kshift = shift;
+                }
+                const ParticleReal x = xp + ishift*split_offset[0];
+                const ParticleReal y = yp + jshift*split_offset[1];
+                const ParticleReal z = zp + kshift*split_offset[2];
+
+                auto& q = dst.m_aos[i_dst+j];
+#if defined(WARPX_DIM_RZ)
+                q.pos(0) = std::sqrt(x*x + y*y);
+                q.pos(1) = z;
+                dst.m_rdata[PIdx::theta][i_dst+j] = std::atan2(y, x);
+#elif (AMREX_SPACEDIM == 3)
+                q.pos(0) = x;
+                q.pos(1) = y;
+                q.pos(2) = z;
+#else
+                amrex::ignore_unused(y);
+                q.pos(0) = x;
+                q.pos(1) = z;
+#endif
+                q.id() = NoSplitParticleID;
+                dst.m_rdata[PIdx::w][i_dst+j] = w;
+            }
+            // invalidate the parent particle
+            p.id() = -p.id();
+        }
+    };
 }
 
 PhysicalParticleContainer::PhysicalParticleContainer (AmrCore* amr_core, int ispecies,
@@ -113,6 +251,7 @@ PhysicalParticleContainer::PhysicalParticleContainer (AmrCore* amr_core, int isp
     pp_species_name.query("do_not_deposit", do_not_deposit);
     pp_species_name.query("do_not_gather", do_not_gather);
     pp_species_name.query("do_not_push", do_not_push);
+    pp_species_name.query("do_not_assign_ids", do_not_assign_ids);
 
     pp_species_name.query("do_continuous_injection", do_continuous_injection);
     pp_species_name.query("initialize_self_fields", initialize_self_fields);
@@ -210,48 +349,8 @@ void PhysicalParticleContainer::InitData ()
 void PhysicalParticleContainer::MapParticletoBoostedFrame (
     Real& x, Real& y, Real& z, Real& ux, Real& uy, Real& uz)
 {
-    // Map the particles from the lab frame to the boosted frame.
-    // This boosts the particle to the lab frame and calculates
-    // the particle time in the boosted frame. It then maps
-    // the position to the time in the boosted frame.
-
-    // For now, start with the assumption that this will only happen
-    // at the start of the simulation.
-    const Real t_lab = 0._rt;
-
-    const Real uz_boost = WarpX::gamma_boost*WarpX::beta_boost*PhysConst::c;
-
-    // tpr is the particle's time in the boosted frame
-    Real tpr = WarpX::gamma_boost*t_lab - uz_boost*z/(PhysConst::c*PhysConst::c);
-
-    // The particle's transformed location in the boosted frame
-    Real xpr = x;
-    Real ypr = y;
-    Real zpr = WarpX::gamma_boost*z - uz_boost*t_lab;
-
-    // transform u and gamma to the boosted frame
-    Real gamma_lab = std::sqrt(1._rt + (ux*ux + uy*uy + uz*uz)/(PhysConst::c*PhysConst::c));
-    // ux = ux;
-    // uy = uy;
-    uz = WarpX::gamma_boost*uz - uz_boost*gamma_lab;
-    Real gammapr = std::sqrt(1._rt + (ux*ux + uy*uy + uz*uz)/(PhysConst::c*PhysConst::c));
-
-    Real vxpr = ux/gammapr;
-    Real vypr = uy/gammapr;
-    Real vzpr = uz/gammapr;
-
-    if (do_backward_propagation){
-        uz = -uz;
-    }
-
-    // Move the particles to where they will be at t = 0 in the boosted frame
-    if (boost_adjust_transverse_positions) {
-        x = xpr - tpr*vxpr;
-        y = ypr - tpr*vypr;
-    }
-
-    z = zpr - tpr*vzpr;
-
+    mapParticleToBoostedFrame(x, y, z, ux, uy, uz, WarpX::gamma_boost, WarpX::beta_boost,
+                              do_backward_propagation, boost_adjust_transverse_positions);
 }
 
 void
@@ -262,80 +361,142 @@ PhysicalParticleContainer::AddGaussianBeam (
     const Real q_tot, long npart,
     const int do_symmetrize) {
 
-    std::mt19937_64 mt(0451);
-    std::normal_distribution<double> distx(x_m, x_rms);
-    std::normal_distribution<double> disty(y_m, y_rms);
-    std::normal_distribution<double> distz(z_m, z_rms);
+    WARPX_PROFILE("PhysicalParticleContainer::AddGaussianBeam()");
 
-    // Declare temporary vectors on the CPU
-    Gpu::HostVector<ParticleReal> particle_x;
-    Gpu::HostVector<ParticleReal> particle_y;
-    Gpu::HostVector<ParticleReal> particle_z;
-    Gpu::HostVector<ParticleReal> particle_ux;
-    Gpu::HostVector<ParticleReal> particle_uy;
-    Gpu::HostVector<ParticleReal> particle_uz;
-    Gpu::HostVector<ParticleReal> particle_w;
-    int np = 0;
+    // If do_symmetrize, create 4x fewer particles, and
+    // Replicate each particle 4 times (x,y) (x,-y) (-x,y) (-x,-y)
+    if (do_symmetrize){
+        npart /= 4;
+    }
+    const int nsym = do_symmetrize ? 4 : 1;
+#if (defined WARPX_DIM_3D) || (defined WARPX_DIM_RZ)
+    const Real weight = q_tot/(npart*charge*nsym);
+#elif (defined WARPX_DIM_XZ)
+    const Real weight = q_tot/(npart*charge*y_rms*nsym);
+#endif
 
-    if (ParallelDescriptor::IOProcessor()) {
-        // If do_symmetrize, create 4x fewer particles, and
-        // Replicate each particle 4 times (x,y) (-x,y) (x,-y) (-x,-y)
-        if (do_symmetrize){
-            npart /= 4;
-        }
-        for (long i = 0; i < npart; ++i) {
+    // Each MPI rank draws a contiguous slice of the particles on the device,
+    // which are then sent to the ranks that own them by the Redistribute below.
+    // The positions are counter-based random numbers of the index of the particle
+    // in the beam, and thus do not depend on the number of MPI ranks.
+    const Long nprocs = ParallelDescriptor::NProcs();
+    const Long myproc = ParallelDescriptor::MyProc();
+    const Long navg = npart/nprocs;
+    const Long nleft = npart - navg*nprocs;
+    const Long ibegin = myproc*navg + std::min(myproc, nleft);
+    const Long nslice = navg + ((myproc < nleft) ? 1 : 0);
+    const Long np = nslice*nsym;
+
+    // Add to grid 0 and tile 0
+    auto& particle_tile = DefineAndReturnParticleTile(0, 0, 0);
+    auto old_size = particle_tile.GetArrayOfStructs().size();
+    resizeParticleTile(particle_tile, old_size + np);
+
+    // Reserve the ids of the particles created in this function
+    const Long pid = do_not_assign_ids ? UnassignedParticleID :
+        reserveParticleIDs<ParticleType>(np);
+    const int id_stride = do_not_assign_ids ? 0 : 1;
+    const int cpuid = ParallelDescriptor::MyProc();
+
+    ParticleType* pp = particle_tile.GetArrayOfStructs()().data() + old_size;
+    auto& soa = particle_tile.GetStructOfArrays();
+    GpuArray<ParticleReal*,PIdx::nattribs> pa;
+    for (int ia = 0; ia < PIdx::nattribs; ++ia) {
+        pa[ia] = soa.GetRealData(ia).data() + old_size;
+    }
+
+    InjectorMomentum* inj_mom = plasma_injector->getInjectorMomentum();
+    const Real xmin = plasma_injector->xmin;
+    const Real xmax = plasma_injector->xmax;
+    const Real ymin = plasma_injector->ymin;
+    const Real ymax = plasma_injector->ymax;
+    const Real zmin = plasma_injector->zmin;
+    const Real zmax = plasma_injector->zmax;
+    const Real gamma_boost = WarpX::gamma_boost;
+    const Real beta_boost = WarpX::beta_boost;
+    const bool backward_propagation = do_backward_propagation;
+    const bool adjust_transverse_positions = boost_adjust_transverse_positions;
+    const std::uint64_t seed = 0451;
+
+    // The particles out of the bounds or of the cuts are given negative ID
+    // and are deleted during the redistribute.
+    amrex::ParallelForRNG(nslice,
+    [=] AMREX_GPU_DEVICE (Long i, amrex::RandomEngine const& engine) noexcept
+    {
+        const auto counter = static_cast<std::uint64_t>(ibegin + i);
+        const Real x = x_m + x_rms*static_cast<Real>(CounterRNG::Normal(seed, counter, 0));
 #if (defined WARPX_DIM_3D) || (defined WARPX_DIM_RZ)
-            const Real weight = q_tot/(npart*charge);
-            const Real x = distx(mt);
-            const Real y = disty(mt);
-            const Real z = distz(mt);
+        const Real y = y_m + y_rms*static_cast<Real>(CounterRNG::Normal(seed, counter, 1));
 #elif (defined WARPX_DIM_XZ)
-            const Real weight = q_tot/(npart*charge*y_rms);
-            const Real x = distx(mt);
-            constexpr Real y = 0._prt;
-            const Real z = distz(mt);
+        constexpr Real y = 0._prt;
 #endif
-            if (plasma_injector->insideBounds(x, y, z)  &&
-                std::abs( x - x_m ) < x_cut * x_rms     &&
-                std::abs( y - y_m ) < y_cut * y_rms     &&
-                std::abs( z - z_m ) < z_cut * z_rms   ) {
-                XDim3 u = plasma_injector->getMomentum(x, y, z);
-                u.x *= PhysConst::c;
-                u.y *= PhysConst::c;
-                u.z *= PhysConst::c;
-                if (do_symmetrize){
-                    // Add four particles to the beam:
-                    CheckAndAddParticle(x, y, z, u.x, u.y, u.z, weight/4._rt,
-                                        particle_x,  particle_y,  particle_z,
-                                        particle_ux, particle_uy, particle_uz,
-                                        particle_w);
-                    CheckAndAddParticle(x, -y, z, u.x, -u.y, u.z, weight/4._rt,
-                                        particle_x,  particle_y,  particle_z,
-                                        particle_ux, particle_uy, particle_uz,
-                                        particle_w);
-                    CheckAndAddParticle(-x, y, z, -u.x, u.y, u.z, weight/4._rt,
-                                        particle_x,  particle_y,  particle_z,
-                                        particle_ux, particle_uy, particle_uz,
-                                        particle_w);
-                    CheckAndAddParticle(-x, -y, z, -u.x, -u.y, u.z, weight/4._rt,
-                                        particle_x,  particle_y,  particle_z,
-                                        particle_ux, particle_uy, particle_uz,
-                                        particle_w);
-                } else {
-                    CheckAndAddParticle(x, y, z, u.x, u.y, u.z, weight,
-                                        particle_x,  particle_y,  particle_z,
-                                        particle_ux, particle_uy, particle_uz,
-                                        particle_w);
-                }
+        const Real z = z_m + z_rms*static_cast<Real>(CounterRNG::Normal(seed, counter, 2));
+
+        const bool valid = x < xmax && x >= xmin &&
+                           y < ymax && y >= ymin &&
+                           z < zmax && z >= zmin &&
+                           std::abs( x - x_m ) < x_cut * x_rms &&
+                           std::abs( y - y_m ) < y_cut * y_rms &&
+                           std::abs( z - z_m ) < z_cut * z_rms;
+        XDim3 u = {0._rt, 0._rt, 0._rt};
+        if (valid) {
+            u = inj_mom->getMomentum(x, y, z, engine);
+            u.x *= PhysConst::c;
+            u.y *= PhysConst::c;
+            u.z *= PhysConst::c;
+        }
+
+        for (int isym = 0; isym < nsym; ++isym) {
+            const Long ip = i*nsym + isym;
+            ParticleType& p = pp[ip];
+            p.id() = valid ? pid + id_stride*ip : -1;
+            p.cpu() = cpuid;
+
+            const Real sign_x = (isym < 2) ? 1._rt : -1._rt;
+            const Real sign_y = (isym % 2 == 0) ? 1._rt : -1._rt;
+            Real xp = sign_x*x;
+            Real yp = sign_y*y;
+            Real zp = z;
+            Real uxp = sign_x*u.x;
+            Real uyp = sign_y*u.y;
+            Real uzp = u.z;
+            if (gamma_boost > 1._rt) {
+                mapParticleToBoostedFrame(xp, yp, zp, uxp, uyp, uzp, gamma_boost, beta_boost,
+                                          backward_propagation, adjust_transverse_positions);
             }
+
+            pa[PIdx::w ][ip] = weight;
+            pa[PIdx::ux][ip] = uxp;
+            pa[PIdx::uy][ip] = uyp;
+            pa[PIdx::uz][ip] = uzp;
+#if (AMREX_SPACEDIM == 3)
+            p.pos(0) = xp;
+            p.pos(1) = yp;
+            p.pos(2) = zp;
+#elif defined(WARPX_DIM_RZ)
+            pa[PIdx::theta][ip] = std::atan2(yp, xp);
+            p.pos(0) = std::sqrt(xp*xp + yp*yp);
+            p.pos(1) = zp;
+#else
+            amrex::ignore_unused(yp);
+            p.pos(0) = xp;
+            p.pos(1) = zp;
+#endif
         }
+    });
+
+    // The other attributes of the new particles are set to zero
+    for (int ic = PIdx::nattribs; ic < NumRealComps(); ++ic) {
+        ParticleReal* AMREX_RESTRICT data = soa.GetRealData(ic).data() + old_size;
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (Long i) noexcept { data[i] = 0._prt; });
     }
-    // Add the temporary CPU vectors to the particle structure
-    np = particle_z.size();
-    AddNParticles(0,np,
-                  particle_x.dataPtr(),  particle_y.dataPtr(),  particle_z.dataPtr(),
-                  particle_ux.dataPtr(), particle_uy.dataPtr(), particle_uz.dataPtr(),
-                  1, particle_w.dataPtr(),1);
+    for (int ic = 0; ic < NumIntComps(); ++ic) {
+        int* AMREX_RESTRICT data = soa.GetIntData(ic).data() + old_size;
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (Long i) noexcept { data[i] = 0; });
+    }
+    amrex::Gpu::synchronize();
+
+    Redistribute();
 }
 
 void
@@ -352,8 +513,7 @@ PhysicalParticleContainer::AddPlasmaFromFile(ParticleReal q_tot,
     Gpu::HostVector<ParticleReal> particle_uy;
 
 #ifdef WARPX_USE_OPENPMD
-    //TODO: Make changes for read/write in multiple MPI ranks
-    if (ParallelDescriptor::IOProcessor()) {
+    {
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE(plasma_injector,
                                          "AddPlasmaFromFile: plasma injector not initialized.\n");
         // take ownership of the series and close it when done
@@ -364,24 +524,38 @@ PhysicalParticleContainer::AddPlasmaFromFile(ParticleReal q_tot,
         std::string const ps_name = it.particles.begin()->first;
         openPMD::ParticleSpecies ps = it.particles.begin()->second;
 
+        // Each MPI rank loads a contiguous slice of the particles, which are
+        // then sent to the ranks that own them by the Redistribute in AddNParticles
         auto const npart = ps["position"]["x"].getExtent()[0];
-        std::shared_ptr<ParticleReal> ptr_x = ps["position"]["x"].loadChunk<ParticleReal>();
+        const auto nprocs = static_cast<decltype(npart)>(ParallelDescriptor::NProcs());
+        const auto myproc = static_cast<decltype(npart)>(ParallelDescriptor::MyProc());
+        auto const navg = npart/nprocs;
+        auto const nleft = npart - navg*nprocs;
+        const openPMD::Offset slice_offset = {myproc*navg + std::min(myproc, nleft)};
+        const openPMD::Extent slice_extent = {navg + ((myproc < nleft) ? 1 : 0)};
+        auto const nslice = slice_extent[0];
+
+        std::shared_ptr<ParticleReal> ptr_x, ptr_z, ptr_ux, ptr_uz, ptr_y, ptr_uy;
         double const position_unit_x = ps["position"]["x"].unitSI();
-        std::shared_ptr<ParticleReal> ptr_z = ps["position"]["z"].loadChunk<ParticleReal>();
         double const position_unit_z = ps["position"]["z"].unitSI();
-        std::shared_ptr<ParticleReal> ptr_ux = ps["momentum"]["x"].loadChunk<ParticleReal>();
         double const momentum_unit_x = ps["momentum"]["x"].unitSI();
-        std::shared_ptr<ParticleReal> ptr_uz = ps["momentum"]["z"].loadChunk<ParticleReal>();
         double const momentum_unit_z = ps["momentum"]["z"].unitSI();
 #   ifndef WARPX_DIM_XZ
-        std::shared_ptr<ParticleReal> ptr_y = ps["position"]["y"].loadChunk<ParticleReal>();
         double const position_unit_y = ps["position"]["y"].unitSI();
 #   endif
-        std::shared_ptr<ParticleReal> ptr_uy = nullptr;
-        double momentum_unit_y = 1.0;
-        if (ps["momentum"].contains("y")) {
-            ptr_uy = ps["momentum"]["y"].loadChunk<ParticleReal>();
-             momentum_unit_y = ps["momentum"]["y"].unitSI();
+        bool const has_uy = ps["momentum"].contains("y");
+        double const momentum_unit_y = has_uy ? ps["momentum"]["y"].unitSI() : 1.0;
+        if (nslice > 0) {
+            ptr_x = ps["position"]["x"].loadChunk<ParticleReal>(slice_offset, slice_extent);
+            ptr_z = ps["position"]["z"].loadChunk<ParticleReal>(slice_offset, slice_extent);
+            ptr_ux = ps["momentum"]["x"].loadChunk<ParticleReal>(slice_offset, slice_extent);
+            ptr_uz = ps["momentum"]["z"].loadChunk<ParticleReal>(slice_offset, slice_extent);
+#   ifndef WARPX_DIM_XZ
+            ptr_y = ps["position"]["y"].loadChunk<ParticleReal>(slice_offset, slice_extent);
+#   endif
+            if (has_uy) {
+                ptr_uy = ps["momentum"]["y"].loadChunk<ParticleReal>(slice_offset, slice_extent);
+            }
         }
         series->flush();  // shared_ptr data can be read now
 
@@ -398,12 +572,21 @@ PhysicalParticleContainer::AddPlasmaFromFile(ParticleReal q_tot,
         else if (ps.contains("weighting")) {
             // TODO: Add ASSERT_WITH_MESSAGE to test if weighting is a constant record
             // TODO: Add ASSERT_WITH_MESSAGE for macroWeighted value in ED-PIC
-            ParticleReal w = ps["weighting"][openPMD::RecordComponent::SCALAR].loadChunk<ParticleReal>().get()[0];
+            auto ptr_w = ps["weighting"][openPMD::RecordComponent::SCALAR].loadChunk<ParticleReal>(
+                openPMD::Offset{0}, openPMD::Extent{1});
+            series->flush();
             double const w_unit = ps["weighting"][openPMD::RecordComponent::SCALAR].unitSI();
-            weight = w * w_unit;
+            weight = ptr_w.get()[0] * w_unit;
         }
 
-        for (auto i = decltype(npart){0}; i<npart; ++i){
+        particle_x.reserve(nslice);
+        particle_y.reserve(nslice);
+        particle_z.reserve(nslice);
+        particle_ux.reserve(nslice);
+        particle_uy.reserve(nslice);
+        particle_uz.reserve(nslice);
+        particle_w.reserve(nslice);
+        for (auto i = decltype(nslice){0}; i<nslice; ++i){
             ParticleReal const x = ptr_x.get()[i]*position_unit_x;
             ParticleReal const z = ptr_z.get()[i]*position_unit_z+z_shift;
 #   if (defined WARPX_DIM_3D) || (defined WARPX_DIM_RZ)
@@ -415,7 +598,7 @@ PhysicalParticleContainer::AddPlasmaFromFile(ParticleReal q_tot,
                 ParticleReal const ux = ptr_ux.get()[i]*momentum_unit_x/PhysConst::m_e;
                 ParticleReal const uz = ptr_uz.get()[i]*momentum_unit_z/PhysConst::m_e;
                 ParticleReal uy = 0.0_prt;
-                if (ps["momentum"].contains("y")) {
+                if (has_uy) {
                     uy = ptr_uy.get()[i]*momentum_unit_y/PhysConst::m_e;
                 }
                 CheckAndAddParticle(x, y, z, ux, uy, uz, weight,
@@ -424,11 +607,12 @@ PhysicalParticleContainer::AddPlasmaFromFile(ParticleReal q_tot,
                                     particle_w);
             }
         }
-        auto const np = particle_z.size();
-        if (np < npart) {
+        Long np_added = particle_z.size();
+        ParallelDescriptor::ReduceLongSum(np_added);
+        if (np_added < static_cast<Long>(npart)) {
             Print() << "WARNING: Simulation box doesn't cover all particles\n";
         }
-    } // IO Processor
+    }
     auto const np = particle_z.size();
     AddNParticles(0, np,
                   particle_x.dataPtr(),  particle_y.dataPtr(),  particle_z.dataPtr(),
@@ -614,11 +798,7 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
 #endif
     for (MFIter mfi = MakeMFIter(lev, info); mfi.isValid(); ++mfi)
     {
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            amrex::Gpu::synchronize();
-        }
-        Real wt = amrex::second();
+        BoxCostTimer box_timer(cost, mfi.index());
 
         const Box& tile_box = mfi.tilebox();
         const RealBox tile_realbox = WarpX::getRealBox(tile_box, lev);
@@ -703,17 +883,10 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
         // and invalid ones are then discarded
         int max_new_particles = Scan::ExclusiveSum(counts.size(), counts.data(), offset.data());
 
-        // Update NextID to include particles created in this function
-        Long pid;
-#ifdef AMREX_USE_OMP
-#pragma omp critical (add_plasma_nextid)
-#endif
-        {
-            pid = ParticleType::NextID();
-            ParticleType::NextID(pid+max_new_particles);
-        }
-        WarpXUtilMsg::AlwaysAssert(static_cast<Long>(pid + max_new_particles) < LastParticleID,
-                                   "ERROR: overflow on particle id numbers");
+        // Reserve the ids of the particles created in this function
+        const Long pid = do_not_assign_ids ? UnassignedParticleID :
+            reserveParticleIDs<ParticleType>(max_new_particles);
+        const int id_stride = do_not_assign_ids ? 0 : 1;
 
         const int cpuid = ParallelDescriptor::MyProc();
 
@@ -725,7 +898,7 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
 
         auto old_size = particle_tile.GetArrayOfStructs().size();
         auto new_size = old_size + max_new_particles;
-        particle_tile.resize(new_size);
+        resizeParticleTile(particle_tile, new_size);
 
         ParticleType* pp = particle_tile.GetArrayOfStructs()().data() + old_size;
         auto& soa = particle_tile.GetStructOfArrays();
@@ -785,7 +958,7 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
             {
                 long ip = poffset[index] + i_part;
                 ParticleType& p = pp[ip];
-                p.id() = pid+ip;
+                p.id() = pid + id_stride*ip;
                 p.cpu() = cpuid;
 
                 const XDim3 r =
@@ -934,11 +1107,7 @@ PhysicalParticleContainer::AddPlasma (int lev, RealBox part_realbox)
 
         amrex::Gpu::synchronize();
 
-        if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-        {
-            wt = amrex::second() - wt;
-            amrex::HostDevice::Atomic::Add( &(*cost)[mfi.index()], wt);
-        }
+        box_timer.stop();
     }
 
     // The function that calls this is responsible for redistributing particles.
@@ -955,10 +1124,12 @@ PhysicalParticleContainer::Evolve (int lev,
                                    MultiFab* rho, MultiFab* crho,
                                    const MultiFab* cEx, const MultiFab* cEy, const MultiFab* cEz,
                                    const MultiFab* cBx, const MultiFab* cBy, const MultiFab* cBz,
-                                   Real /*t*/, Real dt, DtType a_dt_type)
+                                   Real /*t*/, Real dt, DtType a_dt_type,
+                                   bool skip_rho_old)
 {
 
     WARPX_PROFILE("PhysicalParticleContainer::Evolve()");
+    WARPX_PROFILE_RANGE("PhysicalParticleContainer::Evolve " + species_name);
     WARPX_PROFILE_VAR_NS("PhysicalParticleContainer::Evolve::GatherAndPush", blp_fg);
 
     BL_ASSERT(OnSameGrids(lev,jx));
@@ -978,8 +1149,53 @@ PhysicalParticleContainer::Evolve (int lev,
             const auto t_lev = pti.GetLevel();
             const auto index = pti.GetPairIndex();
             tmp_particle_data.resize(finestLevel()+1);
-            for (int i = 0; i < TmpIdx::nattribs; ++i)
-                tmp_particle_data[t_lev][index][i].resize(np);
+            for (int i = 0; i < TmpIdx::nattribs; ++i) {
+                auto& tmp = tmp_particle_data[t_lev][index][i];
+                tmp.resize(np);
+                // release the copies of the tiles that no longer have particles
+                if (np == 0) tmp.shrink_to_fit();
+            }
+        }
+    }
+
+    InitSoAPositions(lev);
+#ifdef WARPX_QED
+    // The push flags the particles that undergo a QED event at this step
+    ResetQEDEventLists(lev);
+#endif
+
+    // Gather, push and deposit the current in a single kernel (except for the
+    // particles in the mesh refinement buffers, for which this is not supported)
+#ifdef AMREX_USE_GPU
+    const bool fuse_push_deposit = do_fused_push_deposit && m_allow_fused_push_deposit &&
+        !has_buffer && !do_not_deposit &&
+        WarpX::do_electrostatic == ElectrostaticSolverAlgo::None &&
+        (WarpX::current_deposition_algo == CurrentDepositionAlgo::Direct ||
+         WarpX::current_deposition_algo == CurrentDepositionAlgo::Esirkepov);
+#else
+    const bool fuse_push_deposit = false;
+#endif
+
+    // On CPU, the tiles deposit directly into J and rho, one color after the other, when
+    // the tiles of a color are far enough apart (see DepositionTileColors)
+    std::map<std::pair<int,int>, int> tile_colors;
+    const int num_colors = DepositionTileColors(lev, tile_colors);
+    m_deposit_in_place = (num_colors > 0);
+
+    // With particles.tile_dependencies, the tiles are statically distributed over the threads,
+    // and each tile only waits for the tiles of the previous colors that deposit around it
+    // (tile_done), instead of all the threads waiting for each other after each color
+    const bool use_tile_deps = do_tile_dependencies && num_colors > 1;
+    std::map<std::pair<int,int>, int> tile_ids;
+    Vector<Vector<int>> tile_deps;
+    std::unique_ptr<std::atomic<int>[]> tile_done;
+    if (use_tile_deps) {
+        DepositionTileDependencies(lev, tile_colors, tile_ids, tile_deps);
+        tile_done.reset(new std::atomic<int>[tile_ids.size()]);
+        for (std::size_t i = 0; i < tile_ids.size(); ++i) tile_done[i] = 1;
+        // only the tiles with particles are pushed
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti) {
+            tile_done[tile_ids.at(std::make_pair(pti.index(), pti.LocalTileIndex()))] = 0;
         }
     }
 
@@ -993,190 +1209,210 @@ PhysicalParticleContainer::Evolve (int lev,
         int thread_num = 0;
 #endif
 
-        FArrayBox filtered_Ex, filtered_Ey, filtered_Ez;
-        FArrayBox filtered_Bx, filtered_By, filtered_Bz;
+        // Order of the particles of a tile for the gather and deposition buffers
+        Gpu::DeviceVector<long> buffer_pid;
 
-        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        for (int color = 0; color < std::max(num_colors, 1); ++color)
         {
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-            }
-            Real wt = amrex::second();
-
-            const Box& box = pti.validbox();
-
-            auto& attribs = pti.GetAttribs();
-
-            auto&  wp = attribs[PIdx::w];
-            auto& uxp = attribs[PIdx::ux];
-            auto& uyp = attribs[PIdx::uy];
-            auto& uzp = attribs[PIdx::uz];
-
-            const long np = pti.numParticles();
-
-            // Data on the grid
-            FArrayBox const* exfab = WarpX::fft_do_time_averaging ? &(Ex_avg[pti]) : &(Ex[pti]);
-            FArrayBox const* eyfab = WarpX::fft_do_time_averaging ? &(Ey_avg[pti]) : &(Ey[pti]);
-            FArrayBox const* ezfab = WarpX::fft_do_time_averaging ? &(Ez_avg[pti]) : &(Ez[pti]);
-            FArrayBox const* bxfab = WarpX::fft_do_time_averaging ? &(Bx_avg[pti]) : &(Bx[pti]);
-            FArrayBox const* byfab = WarpX::fft_do_time_averaging ? &(By_avg[pti]) : &(By[pti]);
-            FArrayBox const* bzfab = WarpX::fft_do_time_averaging ? &(Bz_avg[pti]) : &(Bz[pti]);
-
-            Elixir exeli, eyeli, ezeli, bxeli, byeli, bzeli;
-
-            if (WarpX::use_fdtd_nci_corr)
+            for (WarpXParIter pti(*this, lev, WarpX::do_dynamic_scheduling && !use_tile_deps);
+                 pti.isValid(); ++pti)
             {
-                // Filter arrays Ex[pti], store the result in
-                // filtered_Ex and update pointer exfab so that it
-                // points to filtered_Ex (and do the same for all
-                // components of E and B).
-                applyNCIFilter(lev, pti.tilebox(), exeli, eyeli, ezeli, bxeli, byeli, bzeli,
-                               filtered_Ex, filtered_Ey, filtered_Ez,
-                               filtered_Bx, filtered_By, filtered_Bz,
-                               Ex[pti], Ey[pti], Ez[pti], Bx[pti], By[pti], Bz[pti],
-                               exfab, eyfab, ezfab, bxfab, byfab, bzfab);
-            }
+                if (num_colors > 1 &&
+                    tile_colors.at(std::make_pair(pti.index(), pti.LocalTileIndex())) != color) {
+                    continue;
+                }
 
-            // Determine which particles deposit/gather in the buffer, and
-            // which particles deposit/gather in the fine patch
-            long nfine_current = np;
-            long nfine_gather = np;
-            if (has_buffer && !do_not_push) {
-                // - Modify `nfine_current` and `nfine_gather` (in place)
-                //    so that they correspond to the number of particles
-                //    that deposit/gather in the fine patch respectively.
-                // - Reorder the particle arrays,
-                //    so that the `nfine_current`/`nfine_gather` first particles
-                //    deposit/gather in the fine patch
-                //    and (thus) the `np-nfine_current`/`np-nfine_gather` last particles
-                //    deposit/gather in the buffer
-                PartitionParticlesInBuffers( nfine_current, nfine_gather, np,
-                    pti, lev, current_masks, gather_masks, uxp, uyp, uzp, wp );
-            }
+                int tile_id = -1;
+                if (use_tile_deps) {
+                    tile_id = tile_ids.at(std::make_pair(pti.index(), pti.LocalTileIndex()));
+                    for (int const dep : tile_deps[tile_id]) {
+                        while (!tile_done[dep].load(std::memory_order_acquire)) std::this_thread::yield();
+                    }
+                }
 
-            const long np_current = (cjx) ? nfine_current : np;
+                BoxCostTimer box_timer(cost, pti.index());
+                WARPX_PROFILE_RANGE("PhysicalParticleContainer::Evolve " + species_name + " box " + std::to_string(pti.index()));
 
-            if (rho) {
-                // Deposit charge before particle push, in component 0 of MultiFab rho.
-                int* AMREX_RESTRICT ion_lev;
-                if (do_field_ionization){
-                    ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
-                } else {
-                    ion_lev = nullptr;
-                }
-                DepositCharge(pti, wp, ion_lev, rho, 0, 0,
-                              np_current, thread_num, lev, lev);
-                if (has_buffer){
-                    DepositCharge(pti, wp, ion_lev, crho, 0, np_current,
-                                  np-np_current, thread_num, lev, lev-1);
-                }
-            }
+                auto& attribs = pti.GetAttribs();
 
-            if (! do_not_push)
-            {
-                const long np_gather = (cEx) ? nfine_gather : np;
+                auto&  wp = attribs[PIdx::w];
+                auto& uxp = attribs[PIdx::ux];
+                auto& uyp = attribs[PIdx::uy];
+                auto& uzp = attribs[PIdx::uz];
 
-                int e_is_nodal = Ex.is_nodal() and Ey.is_nodal() and Ez.is_nodal();
+                const long np = pti.numParticles();
 
-                //
-                // Gather and push for particles not in the buffer
-                //
-                WARPX_PROFILE_VAR_START(blp_fg);
-                PushPX(pti, exfab, eyfab, ezfab,
-                       bxfab, byfab, bzfab,
-                       Ex.nGrowVect(), e_is_nodal,
-                       0, np_gather, lev, lev, dt, ScaleFields(false), a_dt_type);
+                // Data on the grid
+                FArrayBox const* exfab = WarpX::fft_do_time_averaging ? &(Ex_avg[pti]) : &(Ex[pti]);
+                FArrayBox const* eyfab = WarpX::fft_do_time_averaging ? &(Ey_avg[pti]) : &(Ey[pti]);
+                FArrayBox const* ezfab = WarpX::fft_do_time_averaging ? &(Ez_avg[pti]) : &(Ez[pti]);
+                FArrayBox const* bxfab = WarpX::fft_do_time_averaging ? &(Bx_avg[pti]) : &(Bx[pti]);
+                FArrayBox const* byfab = WarpX::fft_do_time_averaging ? &(By_avg[pti]) : &(By[pti]);
+                FArrayBox const* bzfab = WarpX::fft_do_time_averaging ? &(Bz_avg[pti]) : &(Bz[pti]);
 
-                if (np_gather < np)
+                if (WarpX::use_fdtd_nci_corr)
                 {
-                    const IntVect& ref_ratio = WarpX::RefRatio(lev-1);
-                    const Box& cbox = amrex::coarsen(box,ref_ratio);
-
-                    // Data on the grid
-                    FArrayBox const* cexfab = &(*cEx)[pti];
-                    FArrayBox const* ceyfab = &(*cEy)[pti];
-                    FArrayBox const* cezfab = &(*cEz)[pti];
-                    FArrayBox const* cbxfab = &(*cBx)[pti];
-                    FArrayBox const* cbyfab = &(*cBy)[pti];
-                    FArrayBox const* cbzfab = &(*cBz)[pti];
-
-                    if (WarpX::use_fdtd_nci_corr)
-                    {
-                        // Filter arrays (*cEx)[pti], store the result in
-                        // filtered_Ex and update pointer cexfab so that it
-                        // points to filtered_Ex (and do the same for all
-                        // components of E and B)
-                        applyNCIFilter(lev-1, cbox, exeli, eyeli, ezeli, bxeli, byeli, bzeli,
-                                       filtered_Ex, filtered_Ey, filtered_Ez,
-                                       filtered_Bx, filtered_By, filtered_Bz,
-                                       (*cEx)[pti], (*cEy)[pti], (*cEz)[pti],
-                                       (*cBx)[pti], (*cBy)[pti], (*cBz)[pti],
-                                       cexfab, ceyfab, cezfab, cbxfab, cbyfab, cbzfab);
-                    }
+                    // Update pointer exfab so that it points to the filtered
+                    // Ex (and do the same for all components of E and B).
+                    applyNCIFilter(lev, false, pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab);
+                }
 
-                    // Field gather and push for particles in gather buffers
-                    e_is_nodal = cEx->is_nodal() and cEy->is_nodal() and cEz->is_nodal();
-                    PushPX(pti, cexfab, ceyfab, cezfab,
-                           cbxfab, cbyfab, cbzfab,
-                           cEx->nGrowVect(), e_is_nodal,
-                           nfine_gather, np-nfine_gather,
-                           lev, lev-1, dt, ScaleFields(false), a_dt_type);
+                // Determine which particles deposit/gather in the buffer, and
+                // which particles deposit/gather in the fine patch
+                long nfine_current = np;
+                long nfine_gather = np;
+                const long* pid = nullptr;
+                if (has_buffer && !do_not_push) {
+                    // - Modify `nfine_current` and `nfine_gather` (in place)
+                    //    so that they correspond to the number of particles
+                    //    that deposit/gather in the fine patch respectively.
+                    // - Compute the order of the particles `pid`,
+                    //    so that the `nfine_current`/`nfine_gather` first particles
+                    //    in this order deposit/gather in the fine patch
+                    //    and (thus) the `np-nfine_current`/`np-nfine_gather` last particles
+                    //    deposit/gather in the buffer.
+                    //    The particles are not reordered: the gather and deposition
+                    //    read them through `pid`.
+                    PartitionParticlesInBuffers( nfine_current, nfine_gather, np,
+                        pti, lev, current_masks, gather_masks, buffer_pid );
+                    if (nfine_current != np || nfine_gather != np) pid = buffer_pid.dataPtr();
                 }
 
-                WARPX_PROFILE_VAR_STOP(blp_fg);
+                // Gather, push and deposit read the positions from contiguous arrays
+                // (particles.soa_positions)
+                CopyPositionsToSoA(pti);
 
-                //
-                // Current Deposition (only needed for electromagnetic solver)
-                //
-                if (WarpX::do_electrostatic == ElectrostaticSolverAlgo::None) {
+                const long np_current = (cjx) ? nfine_current : np;
+
+                if (rho && !skip_rho_old) {
+                    // Deposit charge before particle push, in component 0 of MultiFab rho.
                     int* AMREX_RESTRICT ion_lev;
                     if (do_field_ionization){
                         ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
                     } else {
                         ion_lev = nullptr;
                     }
-                    // Deposit inside domains
-                    DepositCurrent(pti, wp, uxp, uyp, uzp, ion_lev, &jx, &jy, &jz,
-                                   0, np_current, thread_num,
-                                   lev, lev, dt, -0.5_rt); // Deposit current at t_{n+1/2}
+                    DepositCharge(pti, wp, ion_lev, rho, 0, 0,
+                                  np_current, thread_num, lev, lev, pid);
                     if (has_buffer){
-                        // Deposit in buffers
-                        DepositCurrent(pti, wp, uxp, uyp, uzp, ion_lev, cjx, cjy, cjz,
-                                       np_current, np-np_current, thread_num,
-                                       lev, lev-1, dt, -0.5_rt);  // Deposit current at t_{n+1/2}
+                        DepositCharge(pti, wp, ion_lev, crho, 0, np_current,
+                                      np-np_current, thread_num, lev, lev-1, pid);
                     }
-                } // end of "if do_electrostatic == ElectrostaticSolverAlgo::None"
-            } // end of "if do_not_push"
+                }
 
-            if (rho) {
-                // Deposit charge after particle push, in component 1 of MultiFab rho.
-                // (Skipped for electrostatic solver, as this may lead to out-of-bounds)
-                if (WarpX::do_electrostatic == ElectrostaticSolverAlgo::None) {
-                    int* AMREX_RESTRICT ion_lev;
-                    if (do_field_ionization){
-                        ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
+                if (! do_not_push)
+                {
+                    const long np_gather = (cEx) ? nfine_gather : np;
+
+                    int e_is_nodal = Ex.is_nodal() and Ey.is_nodal() and Ez.is_nodal();
+
+                    //
+                    // Gather and push for particles not in the buffer
+                    //
+                    WARPX_PROFILE_VAR_START(blp_fg);
+                    if (fuse_push_deposit) {
+                        // Also deposits the current at t_{n+1/2}
+                        PushPXDepositCurrent(pti, exfab, eyfab, ezfab,
+                                             bxfab, byfab, bzfab,
+                                             Ex.nGrowVect(), &jx, &jy, &jz,
+                                             np_gather, lev, dt, a_dt_type);
                     } else {
-                        ion_lev = nullptr;
+                        PushPX(pti, exfab, eyfab, ezfab,
+                               bxfab, byfab, bzfab,
+                               Ex.nGrowVect(), e_is_nodal,
+                               0, np_gather, lev, lev, dt, ScaleFields(false), a_dt_type, pid);
                     }
-                    DepositCharge(pti, wp, ion_lev, rho, 1, 0,
-                                  np_current, thread_num, lev, lev);
-                    if (has_buffer){
-                        DepositCharge(pti, wp, ion_lev, crho, 1, np_current,
-                                      np-np_current, thread_num, lev, lev-1);
+
+                    if (np_gather < np)
+                    {
+                        // Data on the grid
+                        FArrayBox const* cexfab = &(*cEx)[pti];
+                        FArrayBox const* ceyfab = &(*cEy)[pti];
+                        FArrayBox const* cezfab = &(*cEz)[pti];
+                        FArrayBox const* cbxfab = &(*cBx)[pti];
+                        FArrayBox const* cbyfab = &(*cBy)[pti];
+                        FArrayBox const* cbzfab = &(*cBz)[pti];
+
+                        if (WarpX::use_fdtd_nci_corr)
+                        {
+                            // Update pointer cexfab so that it points to the
+                            // filtered (*cEx)[pti] (and do the same for all
+                            // components of E and B)
+                            applyNCIFilter(lev, true, pti,
+                                           cexfab, ceyfab, cezfab, cbxfab, cbyfab, cbzfab);
+                        }
+
+                        // Field gather and push for particles in gather buffers
+                        e_is_nodal = cEx->is_nodal() and cEy->is_nodal() and cEz->is_nodal();
+                        PushPX(pti, cexfab, ceyfab, cezfab,
+                               cbxfab, cbyfab, cbzfab,
+                               cEx->nGrowVect(), e_is_nodal,
+                               nfine_gather, np-nfine_gather,
+                               lev, lev-1, dt, ScaleFields(false), a_dt_type, pid);
+                    }
+
+                    WARPX_PROFILE_VAR_STOP(blp_fg);
+
+                    //
+                    // Current Deposition (only needed for electromagnetic solver)
+                    //
+                    if (WarpX::do_electrostatic == ElectrostaticSolverAlgo::None && !fuse_push_deposit) {
+                        int* AMREX_RESTRICT ion_lev;
+                        if (do_field_ionization){
+                            ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
+                        } else {
+                            ion_lev = nullptr;
+                        }
+                        // Deposit inside domains
+                        DepositCurrent(pti, wp, uxp, uyp, uzp, ion_lev, &jx, &jy, &jz,
+                                       0, np_current, thread_num,
+                                       lev, lev, dt, -0.5_rt, pid); // Deposit current at t_{n+1/2}
+                        if (has_buffer){
+                            // Deposit in buffers
+                            DepositCurrent(pti, wp, uxp, uyp, uzp, ion_lev, cjx, cjy, cjz,
+                                           np_current, np-np_current, thread_num,
+                                           lev, lev-1, dt, -0.5_rt, pid);  // Deposit current at t_{n+1/2}
+                        }
+                    } // end of "if do_electrostatic == ElectrostaticSolverAlgo::None"
+                } // end of "if do_not_push"
+
+                if (rho) {
+                    // Deposit charge after particle push, in component 1 of MultiFab rho.
+                    // (Skipped for electrostatic solver, as this may lead to out-of-bounds)
+                    if (WarpX::do_electrostatic == ElectrostaticSolverAlgo::None) {
+                        int* AMREX_RESTRICT ion_lev;
+                        if (do_field_ionization){
+                            ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
+                        } else {
+                            ion_lev = nullptr;
+                        }
+                        DepositCharge(pti, wp, ion_lev, rho, 1, 0,
+                                      np_current, thread_num, lev, lev, pid);
+                        if (has_buffer){
+                            DepositCharge(pti, wp, ion_lev, crho, 1, np_current,
+                                          np-np_current, thread_num, lev, lev-1, pid);
+                        }
                     }
                 }
-            }
 
-            amrex::Gpu::synchronize();
+                amrex::Gpu::synchronize();
 
-            if (cost && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                wt = amrex::second() - wt;
-                amrex::HostDevice::Atomic::Add( &(*cost)[pti.index()], wt);
+                box_timer.stop();
+
+                if (use_tile_deps) tile_done[tile_id].store(1, std::memory_order_release);
+            }
+
+#ifdef AMREX_USE_OMP
+            // the tiles of the next color deposit around those of this color
+            if (num_colors > 1 && !use_tile_deps) {
+#pragma omp barrier
             }
+#endif
         }
     }
+    m_deposit_in_place = false;
+    InvalidateSoAPositions(lev);
+
     // Split particles at the end of the timestep.
     // When subcycling is ON, the splitting is done on the last call to
     // PhysicalParticleContainer::Evolve on the finest level, i.e., at the
@@ -1191,75 +1427,22 @@ PhysicalParticleContainer::Evolve (int lev,
 
 void
 PhysicalParticleContainer::applyNCIFilter (
-    int lev, const Box& box,
-    Elixir& exeli, Elixir& eyeli, Elixir& ezeli,
-    Elixir& bxeli, Elixir& byeli, Elixir& bzeli,
-    FArrayBox& filtered_Ex, FArrayBox& filtered_Ey, FArrayBox& filtered_Ez,
-    FArrayBox& filtered_Bx, FArrayBox& filtered_By, FArrayBox& filtered_Bz,
-    const FArrayBox& Ex, const FArrayBox& Ey, const FArrayBox& Ez,
-    const FArrayBox& Bx, const FArrayBox& By, const FArrayBox& Bz,
+    int lev, bool coarse, const MFIter& mfi,
     FArrayBox const * & ex_ptr, FArrayBox const * & ey_ptr,
     FArrayBox const * & ez_ptr, FArrayBox const * & bx_ptr,
     FArrayBox const * & by_ptr, FArrayBox const * & bz_ptr)
 {
-
-    // Get instances of NCI Godfrey filters
-    const auto& nci_godfrey_filter_exeybz = WarpX::GetInstance().nci_godfrey_filter_exeybz;
-    const auto& nci_godfrey_filter_bxbyez = WarpX::GetInstance().nci_godfrey_filter_bxbyez;
-
-#if (AMREX_SPACEDIM == 2)
-    const Box& tbox = amrex::grow(box,{static_cast<int>(WarpX::nox),
-                static_cast<int>(WarpX::noz)});
-#else
-    const Box& tbox = amrex::grow(box,{static_cast<int>(WarpX::nox),
-                static_cast<int>(WarpX::noy),
-                static_cast<int>(WarpX::noz)});
-#endif
-
-    // Filter Ex (Both 2D and 3D)
-    filtered_Ex.resize(amrex::convert(tbox,Ex.box().ixType()));
-    // Safeguard for GPU
-    exeli = filtered_Ex.elixir();
-    // Apply filter on Ex, result stored in filtered_Ex
-
-    nci_godfrey_filter_exeybz[lev]->ApplyStencil(filtered_Ex, Ex, filtered_Ex.box());
-    // Update ex_ptr reference
-    ex_ptr = &filtered_Ex;
-
-    // Filter Ez
-    filtered_Ez.resize(amrex::convert(tbox,Ez.box().ixType()));
-    ezeli = filtered_Ez.elixir();
-    nci_godfrey_filter_bxbyez[lev]->ApplyStencil(filtered_Ez, Ez, filtered_Ez.box());
-    ez_ptr = &filtered_Ez;
-
-    // Filter By
-    filtered_By.resize(amrex::convert(tbox,By.box().ixType()));
-    byeli = filtered_By.elixir();
-    nci_godfrey_filter_bxbyez[lev]->ApplyStencil(filtered_By, By, filtered_By.box());
-    by_ptr = &filtered_By;
-#if (AMREX_SPACEDIM == 3)
-    // Filter Ey
-    filtered_Ey.resize(amrex::convert(tbox,Ey.box().ixType()));
-    eyeli = filtered_Ey.elixir();
-    nci_godfrey_filter_exeybz[lev]->ApplyStencil(filtered_Ey, Ey, filtered_Ey.box());
-    ey_ptr = &filtered_Ey;
-
-    // Filter Bx
-    filtered_Bx.resize(amrex::convert(tbox,Bx.box().ixType()));
-    bxeli = filtered_Bx.elixir();
-    nci_godfrey_filter_bxbyez[lev]->ApplyStencil(filtered_Bx, Bx, filtered_Bx.box());
-    bx_ptr = &filtered_Bx;
-
-    // Filter Bz
-    filtered_Bz.resize(amrex::convert(tbox,Bz.box().ixType()));
-    bzeli = filtered_Bz.elixir();
-    nci_godfrey_filter_exeybz[lev]->ApplyStencil(filtered_Bz, Bz, filtered_Bz.box());
-    bz_ptr = &filtered_Bz;
-#else
-    amrex::ignore_unused(eyeli, bxeli, bzeli,
-        filtered_Ey, filtered_Bx, filtered_Bz,
-        Ey, Bx, Bz, ey_ptr, bx_ptr, bz_ptr);
-#endif
+    const auto& warpx = WarpX::GetInstance();
+    FArrayBox const * * E_ptr[3] = {&ex_ptr, &ey_ptr, &ez_ptr};
+    FArrayBox const * * B_ptr[3] = {&bx_ptr, &by_ptr, &bz_ptr};
+    for (int idir = 0; idir < 3; ++idir) {
+        if (const MultiFab* E_nci = warpx.get_pointer_Efield_nci(lev, idir, coarse)) {
+            *E_ptr[idir] = &(*E_nci)[mfi];
+        }
+        if (const MultiFab* B_nci = warpx.get_pointer_Bfield_nci(lev, idir, coarse)) {
+            *B_ptr[idir] = &(*B_nci)[mfi];
+        }
+    }
 }
 
 // Loop over all particles in the particle container and
@@ -1267,167 +1450,56 @@ PhysicalParticleContainer::applyNCIFilter (
 void
 PhysicalParticleContainer::SplitParticles (int lev)
 {
-    auto& mypc = WarpX::GetInstance().GetPartContainer();
-    auto& pctmp_split = mypc.GetPCtmp();
-    RealVector psplit_x, psplit_y, psplit_z, psplit_w;
-    RealVector psplit_ux, psplit_uy, psplit_uz;
-    long np_split_to_add = 0;
-    long np_split;
-    if(split_type==0)
-    {
-        np_split = (AMREX_SPACEDIM == 3) ? 8 : 4;
-    } else {
-        np_split = 2*AMREX_SPACEDIM;
+    const amrex::Vector<int> ppc_nd = plasma_injector->num_particles_per_cell_each_dim;
+    const std::array<Real,3>& dx = WarpX::CellSize(lev);
+    amrex::GpuArray<ParticleReal,3> split_offset = {{dx[0]/2._rt,
+                                                     dx[1]/2._rt,
+                                                     dx[2]/2._rt}};
+    if (ppc_nd[0] > 0){
+        // offset for split particles is computed as a function of cell size
+        // and number of particles per cell, so that a uniform distribution
+        // before splitting results in a uniform distribution after splitting
+        split_offset[0] /= ppc_nd[0];
+        split_offset[1] /= ppc_nd[1];
+        split_offset[2] /= ppc_nd[2];
     }
 
+    // The split particles copy all the attributes of their parent,
+    // including the runtime attributes
+    SmartCopyFactory copy_factory(*this, *this);
+    auto copy_parent = copy_factory.getSmartCopy();
+
     // Loop over particle interator
     for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
     {
-        const auto GetPosition = GetParticlePosition(pti);
-
-        const amrex::Vector<int> ppc_nd = plasma_injector->num_particles_per_cell_each_dim;
-        const std::array<Real,3>& dx = WarpX::CellSize(lev);
-        amrex::Vector<Real> split_offset = {dx[0]/2._rt,
-                                            dx[1]/2._rt,
-                                            dx[2]/2._rt};
-        if (ppc_nd[0] > 0){
-            // offset for split particles is computed as a function of cell size
-            // and number of particles per cell, so that a uniform distribution
-            // before splitting results in a uniform distribution after splitting
-            split_offset[0] /= ppc_nd[0];
-            split_offset[1] /= ppc_nd[1];
-            split_offset[2] /= ppc_nd[2];
-        }
-        // particle Array Of Structs data
-        auto& particles = pti.GetArrayOfStructs();
-        // particle Struct Of Arrays data
-        auto& attribs = pti.GetAttribs();
-        auto& wp  = attribs[PIdx::w ];
-        auto& uxp = attribs[PIdx::ux];
-        auto& uyp = attribs[PIdx::uy];
-        auto& uzp = attribs[PIdx::uz];
+        auto& ptile = ParticlesAt(lev, pti);
         const long np = pti.numParticles();
-        for(int i=0; i<np; i++){
-            ParticleReal xp, yp, zp;
-            GetPosition(i, xp, yp, zp);
-            auto& p = particles[i];
-            if (p.id() == DoSplitParticleID){
-                // If particle is tagged, split it and put the
-                // split particles in local arrays psplit_x etc.
-                np_split_to_add += np_split;
-#if (AMREX_SPACEDIM==2)
-                if (split_type==0){
-                    // Split particle in two along each diagonals
-                    // 4 particles in 2d
-                    for (int ishift = -1; ishift < 2; ishift +=2 ){
-                        for (int kshift = -1; kshift < 2; kshift +=2 ){
-                            // Add one particle with offset in x and z
-                            psplit_x.push_back( xp + ishift*split_offset[0] );
-                            psplit_y.push_back( yp );
-                            psplit_z.push_back( zp + kshift*split_offset[2] );
-                            psplit_ux.push_back( uxp[i] );
-                            psplit_uy.push_back( uyp[i] );
-                            psplit_uz.push_back( uzp[i] );
-                            psplit_w.push_back( wp[i]/np_split );
-                        }
-                    }
-                } else {
-                    // Split particle in two along each axis
-                    // 4 particles in 2d
-                    for (int ishift = -1; ishift < 2; ishift +=2 ){
-                        // Add one particle with offset in x
-                        psplit_x.push_back( xp + ishift*split_offset[0] );
-                        psplit_y.push_back( yp );
-                        psplit_z.push_back( zp );
-                        psplit_ux.push_back( uxp[i] );
-                        psplit_uy.push_back( uyp[i] );
-                        psplit_uz.push_back( uzp[i] );
-                        psplit_w.push_back( wp[i]/np_split );
-                        // Add one particle with offset in z
-                        psplit_x.push_back( xp );
-                        psplit_y.push_back( yp );
-                        psplit_z.push_back( zp + ishift*split_offset[2] );
-                        psplit_ux.push_back( uxp[i] );
-                        psplit_uy.push_back( uyp[i] );
-                        psplit_uz.push_back( uzp[i] );
-                        psplit_w.push_back( wp[i]/np_split );
-                    }
-                }
-#elif (AMREX_SPACEDIM==3)
-                if (split_type==0){
-                    // Split particle in two along each diagonals
-                    // 8 particles in 3d
-                    for (int ishift = -1; ishift < 2; ishift +=2 ){
-                        for (int jshift = -1; jshift < 2; jshift +=2 ){
-                            for (int kshift = -1; kshift < 2; kshift +=2 ){
-                                // Add one particle with offset in x, y and z
-                                psplit_x.push_back( xp + ishift*split_offset[0] );
-                                psplit_y.push_back( yp + jshift*split_offset[1] );
-                                psplit_z.push_back( zp + kshift*split_offset[2] );
-                                psplit_ux.push_back( uxp[i] );
-                                psplit_uy.push_back( uyp[i] );
-                                psplit_uz.push_back( uzp[i] );
-                                psplit_w.push_back( wp[i]/np_split );
-                            }
-                        }
-                    }
-                } else {
-                    // Split particle in two along each axis
-                    // 6 particles in 3d
-                    for (int ishift = -1; ishift < 2; ishift +=2 ){
-                        // Add one particle with offset in x
-                        psplit_x.push_back( xp + ishift*split_offset[0] );
-                        psplit_y.push_back( yp );
-                        psplit_z.push_back( zp );
-                        psplit_ux.push_back( uxp[i] );
-                        psplit_uy.push_back( uyp[i] );
-                        psplit_uz.push_back( uzp[i] );
-                        psplit_w.push_back( wp[i]/np_split );
-                        // Add one particle with offset in y
-                        psplit_x.push_back( xp );
-                        psplit_y.push_back( yp + ishift*split_offset[1] );
-                        psplit_z.push_back( zp );
-                        psplit_ux.push_back( uxp[i] );
-                        psplit_uy.push_back( uyp[i] );
-                        psplit_uz.push_back( uzp[i] );
-                        psplit_w.push_back( wp[i]/np_split );
-                        // Add one particle with offset in z
-                        psplit_x.push_back( xp );
-                        psplit_y.push_back( yp );
-                        psplit_z.push_back( zp + ishift*split_offset[2] );
-                        psplit_ux.push_back( uxp[i] );
-                        psplit_uy.push_back( uyp[i] );
-                        psplit_uz.push_back( uzp[i] );
-                        psplit_w.push_back( wp[i]/np_split );
-                    }
-                }
-#endif
-                // invalidate the particle
-                p.id() = -p.id();
-            }
+        if (np == 0) continue;
+
+        // flag the tagged particles
+        Gpu::DeviceVector<int> mask(np);
+        int* AMREX_RESTRICT p_mask = mask.dataPtr();
+        ParticleType const* AMREX_RESTRICT pp = ptile.GetArrayOfStructs()().dataPtr();
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (long i) noexcept
+        {
+            p_mask[i] = (pp[i].id() == DoSplitParticleID) ? 1 : 0;
+        });
+
+        // Split the tagged particles, and append the split particles
+        // to the tile, directly on the device. They are tagged with
+        // p.id()=NoSplitParticleID so that they are not re-split when
+        // entering a higher level, and moved to their proper grids
+        // and tiles at the next Redistribute
+        if (split_type == 0) {
+            constexpr int nsplit = (AMREX_SPACEDIM == 3) ? 8 : 4;
+            filterCopyTransformParticles<nsplit>(ptile, ptile, p_mask, static_cast<int>(np),
+                copy_parent, SplitParticleTransform<nsplit, 0>{split_offset});
+        } else {
+            constexpr int nsplit = 2*AMREX_SPACEDIM;
+            filterCopyTransformParticles<nsplit>(ptile, ptile, p_mask, static_cast<int>(np),
+                copy_parent, SplitParticleTransform<nsplit, 1>{split_offset});
         }
     }
-    // Add local arrays psplit_x etc. to the temporary
-    // particle container pctmp_split. Split particles
-    // are tagged with p.id()=NoSplitParticleID so that
-    // they are not re-split when entering a higher level
-    // AddNParticles calls Redistribute, so that particles
-    // in pctmp_split are in the proper grids and tiles
-    pctmp_split.AddNParticles(lev,
-                              np_split_to_add,
-                              psplit_x.dataPtr(),
-                              psplit_y.dataPtr(),
-                              psplit_z.dataPtr(),
-                              psplit_ux.dataPtr(),
-                              psplit_uy.dataPtr(),
-                              psplit_uz.dataPtr(),
-                              1,
-                              psplit_w.dataPtr(),
-                              1, NoSplitParticleID);
-    // Copy particles from tmp to current particle container
-    addParticles(pctmp_split,1);
-    // Clear tmp container
-    pctmp_split.clearParticles();
 }
 
 void
@@ -1567,7 +1639,7 @@ PhysicalParticleContainer::GetParticleSlice (
     const int direction, const Real z_old,
     const Real z_new, const Real t_boost,
     const Real t_lab, const Real dt,
-    DiagnosticParticles& diagnostic_particles)
+    DiagnosticParticleData& slice)
 {
     WARPX_PROFILE("PhysicalParticleContainer::GetParticleSlice()");
 
@@ -1584,63 +1656,43 @@ PhysicalParticleContainer::GetParticleSlice (
     AMREX_ALWAYS_ASSERT(do_back_transformed_diagnostics == 1);
 
     const int nlevs = std::max(0, finestLevel()+1);
-    diagnostic_particles.resize(finestLevel()+1);
 
     for (int lev = 0; lev < nlevs; ++lev) {
+        // For each tile: index of the particles that cross the z-slice among those of the
+        // tile (exclusive sum of the copy flags), and offset of the tile in the slice
+        std::map<std::pair<int,int>, amrex::Gpu::DeviceVector<int>> slice_index;
+        std::map<std::pair<int,int>, long> slice_offset;
+
         // first we touch each map entry in serial
         for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
         {
             auto index = std::make_pair(pti.index(), pti.LocalTileIndex());
-            diagnostic_particles[lev][index];
+            slice_index[index];
+            slice_offset[index] = 0;
         }
 
+        // Count the particles that cross the z-slice on each tile
 #ifdef AMREX_USE_OMP
 #pragma omp parallel
 #endif
         {
-            // Temporary arrays to store copy_flag and copy_index
-            // for particles that cross the z-slice
-            // These arrays are defined before the WarpXParIter to prevent them
-            // from going out of scope after each iteration, while the kernels
-            // may still need access to them.
-            // Note that the destructor for WarpXParIter is synchronized.
+            // Temporary array to store the copy_flag of the particles
             amrex::Gpu::DeviceVector<int> FlagForPartCopy;
-            amrex::Gpu::DeviceVector<int> IndexForPartCopy;
             for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
             {
                 auto index = std::make_pair(pti.index(), pti.LocalTileIndex());
 
                 const auto GetPosition = GetParticlePosition(pti);
-
-                auto& attribs = pti.GetAttribs();
-                Real* const AMREX_RESTRICT wpnew = attribs[PIdx::w].dataPtr();
-                Real* const AMREX_RESTRICT uxpnew = attribs[PIdx::ux].dataPtr();
-                Real* const AMREX_RESTRICT uypnew = attribs[PIdx::uy].dataPtr();
-                Real* const AMREX_RESTRICT uzpnew = attribs[PIdx::uz].dataPtr();
-
-                Real* const AMREX_RESTRICT
-                  xpold = tmp_particle_data[lev][index][TmpIdx::xold].dataPtr();
-                Real* const AMREX_RESTRICT
-                  ypold = tmp_particle_data[lev][index][TmpIdx::yold].dataPtr();
                 Real* const AMREX_RESTRICT
                   zpold = tmp_particle_data[lev][index][TmpIdx::zold].dataPtr();
-                Real* const AMREX_RESTRICT
-                  uxpold = tmp_particle_data[lev][index][TmpIdx::uxold].dataPtr();
-                Real* const AMREX_RESTRICT
-                  uypold = tmp_particle_data[lev][index][TmpIdx::uyold].dataPtr();
-                Real* const AMREX_RESTRICT
-                  uzpold = tmp_particle_data[lev][index][TmpIdx::uzold].dataPtr();
 
                 const long np = pti.numParticles();
 
-                Real uzfrm = -WarpX::gamma_boost*WarpX::beta_boost*PhysConst::c;
-                Real inv_c2 = 1.0/PhysConst::c/PhysConst::c;
-
                 FlagForPartCopy.resize(np);
-                IndexForPartCopy.resize(np);
+                slice_index[index].resize(np);
 
                 int* const AMREX_RESTRICT Flag = FlagForPartCopy.dataPtr();
-                int* const AMREX_RESTRICT IndexLocation = IndexForPartCopy.dataPtr();
+                int* const AMREX_RESTRICT IndexLocation = slice_index[index].dataPtr();
 
                 //Flag particles that need to be copied if they cross the z_slice
                 amrex::ParallelFor(np,
@@ -1659,89 +1711,130 @@ PhysicalParticleContainer::GetParticleSlice (
                 // exclusive scan to obtain location indices using flag values
                 // These location indices are used to copy data from
                 // src to dst when the copy-flag is set to 1.
-                const int total_partdiag_size = amrex::Scan::ExclusiveSum(np,Flag,IndexLocation);
-
-                // allocate array size for diagnostic particle array
-                diagnostic_particles[lev][index].resize(total_partdiag_size);
-
-                amrex::Real gammaboost = WarpX::gamma_boost;
-                amrex::Real betaboost = WarpX::beta_boost;
-                amrex::Real Phys_c = PhysConst::c;
-
-                Real* const AMREX_RESTRICT diag_wp =
-                diagnostic_particles[lev][index].GetRealData(DiagIdx::w).data();
-                Real* const AMREX_RESTRICT diag_xp =
-                diagnostic_particles[lev][index].GetRealData(DiagIdx::x).data();
-                Real* const AMREX_RESTRICT diag_yp =
-                diagnostic_particles[lev][index].GetRealData(DiagIdx::y).data();
-                Real* const AMREX_RESTRICT diag_zp =
-                diagnostic_particles[lev][index].GetRealData(DiagIdx::z).data();
-                Real* const AMREX_RESTRICT diag_uxp =
-                diagnostic_particles[lev][index].GetRealData(DiagIdx::ux).data();
-                Real* const AMREX_RESTRICT diag_uyp =
-                diagnostic_particles[lev][index].GetRealData(DiagIdx::uy).data();
-                Real* const AMREX_RESTRICT diag_uzp =
-                diagnostic_particles[lev][index].GetRealData(DiagIdx::uz).data();
-
-                // Copy particle data to diagnostic particle array on the GPU
-                //  using flag and index values
-                amrex::ParallelFor(np,
-                [=] AMREX_GPU_DEVICE(int i)
-                {
-                    ParticleReal xp_new, yp_new, zp_new;
-                    GetPosition(i, xp_new, yp_new, zp_new);
-                    if (Flag[i] == 1)
-                    {
-                         // Lorentz Transform particles to lab-frame
-                         const Real gamma_new_p = std::sqrt(1.0 + inv_c2*
-                                                  (uxpnew[i]*uxpnew[i]
-                                                 + uypnew[i]*uypnew[i]
-                                                 + uzpnew[i]*uzpnew[i]));
-                         const Real t_new_p = gammaboost*t_boost - uzfrm*zp_new*inv_c2;
-                         const Real z_new_p = gammaboost*(zp_new + betaboost*Phys_c*t_boost);
-                         const Real uz_new_p = gammaboost*uzpnew[i] - gamma_new_p*uzfrm;
-
-                         const Real gamma_old_p = std::sqrt(1.0 + inv_c2*
-                                                  (uxpold[i]*uxpold[i]
-                                                 + uypold[i]*uypold[i]
-                                                 + uzpold[i]*uzpold[i]));
-                         const Real t_old_p = gammaboost*(t_boost - dt)
-                                              - uzfrm*zpold[i]*inv_c2;
-                         const Real z_old_p = gammaboost*(zpold[i]
-                                              + betaboost*Phys_c*(t_boost-dt));
-                         const Real uz_old_p = gammaboost*uzpold[i]
-                                              - gamma_old_p*uzfrm;
-
-                         // interpolate in time to t_lab
-                         const Real weight_old = (t_new_p - t_lab)
-                                               / (t_new_p - t_old_p);
-                         const Real weight_new = (t_lab - t_old_p)
-                                               / (t_new_p - t_old_p);
-
-                         const Real xp = xpold[i]*weight_old + xp_new*weight_new;
-                         const Real yp = ypold[i]*weight_old + yp_new*weight_new;
-                         const Real zp = z_old_p*weight_old  + z_new_p*weight_new;
-
-                         const Real uxp = uxpold[i]*weight_old
-                                        + uxpnew[i]*weight_new;
-                         const Real uyp = uypold[i]*weight_old
-                                        + uypnew[i]*weight_new;
-                         const Real uzp = uz_old_p*weight_old
-                                        + uz_new_p  *weight_new;
-
-                         const int loc = IndexLocation[i];
-                         diag_wp[loc] = wpnew[i];
-                         diag_xp[loc] = xp;
-                         diag_yp[loc] = yp;
-                         diag_zp[loc] = zp;
-                         diag_uxp[loc] = uxp;
-                         diag_uyp[loc] = uyp;
-                         diag_uzp[loc] = uzp;
-                    }
-                });
-                Gpu::synchronize(); // because of FlagForPartCopy & IndexForPartCopy
+                // (The scan returns once the kernels are done, so that FlagForPartCopy can be reused.)
+                slice_offset[index] = amrex::Scan::ExclusiveSum(np,Flag,IndexLocation);
             }
         }
+
+        // The particles of the tiles are appended to the slice in the order of the tiles,
+        // with a single resize of the slice
+        long slice_size = slice.GetRealData(DiagIdx::w).size();
+        for (auto& tile : slice_offset) {
+            const long np_slice = tile.second;
+            tile.second = slice_size;
+            slice_size += np_slice;
+        }
+        slice.resize(slice_size);
+
+        ParticleReal* const AMREX_RESTRICT diag_wp = slice.GetRealData(DiagIdx::w).data();
+        ParticleReal* const AMREX_RESTRICT diag_xp = slice.GetRealData(DiagIdx::x).data();
+        ParticleReal* const AMREX_RESTRICT diag_yp = slice.GetRealData(DiagIdx::y).data();
+        ParticleReal* const AMREX_RESTRICT diag_zp = slice.GetRealData(DiagIdx::z).data();
+        ParticleReal* const AMREX_RESTRICT diag_uxp = slice.GetRealData(DiagIdx::ux).data();
+        ParticleReal* const AMREX_RESTRICT diag_uyp = slice.GetRealData(DiagIdx::uy).data();
+        ParticleReal* const AMREX_RESTRICT diag_uzp = slice.GetRealData(DiagIdx::uz).data();
+
+        // Transform the particles that cross the z-slice and copy them to the slice
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            auto index = std::make_pair(pti.index(), pti.LocalTileIndex());
+
+            const auto GetPosition = GetParticlePosition(pti);
+
+            auto& attribs = pti.GetAttribs();
+            Real* const AMREX_RESTRICT wpnew = attribs[PIdx::w].dataPtr();
+            Real* const AMREX_RESTRICT uxpnew = attribs[PIdx::ux].dataPtr();
+            Real* const AMREX_RESTRICT uypnew = attribs[PIdx::uy].dataPtr();
+            Real* const AMREX_RESTRICT uzpnew = attribs[PIdx::uz].dataPtr();
+
+            Real* const AMREX_RESTRICT
+              xpold = tmp_particle_data[lev][index][TmpIdx::xold].dataPtr();
+            Real* const AMREX_RESTRICT
+              ypold = tmp_particle_data[lev][index][TmpIdx::yold].dataPtr();
+            Real* const AMREX_RESTRICT
+              zpold = tmp_particle_data[lev][index][TmpIdx::zold].dataPtr();
+            Real* const AMREX_RESTRICT
+              uxpold = tmp_particle_data[lev][index][TmpIdx::uxold].dataPtr();
+            Real* const AMREX_RESTRICT
+              uypold = tmp_particle_data[lev][index][TmpIdx::uyold].dataPtr();
+            Real* const AMREX_RESTRICT
+              uzpold = tmp_particle_data[lev][index][TmpIdx::uzold].dataPtr();
+
+            const long np = pti.numParticles();
+
+            Real uzfrm = -WarpX::gamma_boost*WarpX::beta_boost*PhysConst::c;
+            Real inv_c2 = 1.0/PhysConst::c/PhysConst::c;
+
+            int const* const AMREX_RESTRICT IndexLocation = slice_index.at(index).dataPtr();
+            const long offset = slice_offset.at(index);
+
+            amrex::Real gammaboost = WarpX::gamma_boost;
+            amrex::Real betaboost = WarpX::beta_boost;
+            amrex::Real Phys_c = PhysConst::c;
+
+            // Copy particle data to diagnostic particle array on the GPU
+            //  using the same flag as above and the index values
+            amrex::ParallelFor(np,
+            [=] AMREX_GPU_DEVICE(int i)
+            {
+                ParticleReal xp_new, yp_new, zp_new;
+                GetPosition(i, xp_new, yp_new, zp_new);
+                if ( (((zp_new >= z_new) && (zpold[i] <= z_old)) ||
+                      ((zp_new <= z_new) && (zpold[i] >= z_old))) )
+                {
+                     // Lorentz Transform particles to lab-frame
+                     const Real gamma_new_p = std::sqrt(1.0 + inv_c2*
+                                              (uxpnew[i]*uxpnew[i]
+                                             + uypnew[i]*uypnew[i]
+                                             + uzpnew[i]*uzpnew[i]));
+                     const Real t_new_p = gammaboost*t_boost - uzfrm*zp_new*inv_c2;
+                     const Real z_new_p = gammaboost*(zp_new + betaboost*Phys_c*t_boost);
+                     const Real uz_new_p = gammaboost*uzpnew[i] - gamma_new_p*uzfrm;
+
+                     const Real gamma_old_p = std::sqrt(1.0 + inv_c2*
+                                              (uxpold[i]*uxpold[i]
+                                             + uypold[i]*uypold[i]
+                                             + uzpold[i]*uzpold[i]));
+                     const Real t_old_p = gammaboost*(t_boost - dt)
+                                          - uzfrm*zpold[i]*inv_c2;
+                     const Real z_old_p = gammaboost*(zpold[i]
+                                          + betaboost*Phys_c*(t_boost-dt));
+                     const Real uz_old_p = gammaboost*uzpold[i]
+                                          - gamma_old_p*uzfrm;
+
+                     // interpolate in time to t_lab
+                     const Real weight_old = (t_new_p - t_lab)
+                                           / (t_new_p - t_old_p);
+                     const Real weight_new = (t_lab - t_old_p)
+                                           / (t_new_p - t_old_p);
+
+                     const Real xp = xpold[i]*weight_old + xp_new*weight_new;
+                     const Real yp = ypold[i]*weight_old + yp_new*weight_new;
+                     const Real zp = z_old_p*weight_old  + z_new_p*weight_new;
+
+                     const Real uxp = uxpold[i]*weight_old
+                                    + uxpnew[i]*weight_new;
+                     const Real uyp = uypold[i]*weight_old
+                                    + uypnew[i]*weight_new;
+                     const Real uzp = uz_old_p*weight_old
+                                    + uz_new_p  *weight_new;
+
+                     const long loc = offset + IndexLocation[i];
+                     diag_wp[loc] = wpnew[i];
+                     diag_xp[loc] = xp;
+                     diag_yp[loc] = yp;
+                     diag_zp[loc] = zp;
+                     diag_uxp[loc] = uxp;
+                     diag_uyp[loc] = uyp;
+                     diag_uzp[loc] = uzp;
+                }
+            });
+        }
+        // slice_index is freed at the end of the level
+        Gpu::synchronize();
     }
 }
 
@@ -1759,20 +1852,21 @@ PhysicalParticleContainer::ContinuousInjection (const RealBox& injection_box)
 /* \brief Perform the field gather and particle push operations in one fused kernel
  *
  */
+template <int depos_order, int galerkin_interpolation, int push_algo, bool do_ionization>
 void
-PhysicalParticleContainer::PushPX (WarpXParIter& pti,
-                                   amrex::FArrayBox const * exfab,
-                                   amrex::FArrayBox const * eyfab,
-                                   amrex::FArrayBox const * ezfab,
-                                   amrex::FArrayBox const * bxfab,
-                                   amrex::FArrayBox const * byfab,
-                                   amrex::FArrayBox const * bzfab,
-                                   const amrex::IntVect ngE, const int /*e_is_nodal*/,
-                                   const long offset,
-                                   const long np_to_push,
-                                   int lev, int gather_lev,
-                                   amrex::Real dt, ScaleFields scaleFields,
-                                   DtType a_dt_type)
+PhysicalParticleContainer::PushPXShapeN (WarpXParIter& pti,
+                                         amrex::FArrayBox const * exfab,
+                                         amrex::FArrayBox const * eyfab,
+                                         amrex::FArrayBox const * ezfab,
+                                         amrex::FArrayBox const * bxfab,
+                                         amrex::FArrayBox const * byfab,
+                                         amrex::FArrayBox const * bzfab,
+                                         const amrex::IntVect ngE, const int /*e_is_nodal*/,
+                                         const long offset,
+                                         const long np_to_push,
+                                         int lev, int gather_lev,
+                                         amrex::Real dt, ScaleFields scaleFields,
+                                         DtType a_dt_type, const long* pid)
 {
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE((gather_lev==(lev-1)) ||
                                      (gather_lev==(lev  )),
@@ -1796,11 +1890,15 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
     // Add guard cells to the box.
     box.grow(ngE);
 
-    const auto getPosition = GetParticlePosition(pti, offset);
-          auto setPosition = SetParticlePosition(pti, offset);
+    // With the particle indices pid, the particles that are pushed are pid[offset:offset+np_to_push]
+    const long p_offset = pid ? 0 : offset;
+    const long* const p_pid = pid ? pid + offset : nullptr;
 
-    const auto getExternalE = GetExternalEField(pti, offset);
-    const auto getExternalB = GetExternalBField(pti, offset);
+    const auto getPosition = GetParticlePosition(pti, p_offset);
+          auto setPosition = SetParticlePosition(pti, p_offset);
+
+    const auto getExternalE = GetExternalEField(pti, p_offset);
+    const auto getExternalB = GetExternalBField(pti, p_offset);
 
     // Lower corner of tile box physical domain (take into account Galilean shift)
     Real cur_time = WarpX::GetInstance().gett_new(lev);
@@ -1814,6 +1912,302 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
 
     const Dim3 lo = lbound(box);
 
+    int n_rz_azimuthal_modes = WarpX::n_rz_azimuthal_modes;
+
+    amrex::GpuArray<amrex::Real, 3> dx_arr = {dx[0], dx[1], dx[2]};
+    amrex::GpuArray<amrex::Real, 3> xyzmin_arr = {xyzmin[0], xyzmin[1], xyzmin[2]};
+
+    amrex::Array4<const amrex::Real> const& ex_arr = exfab->array();
+    amrex::Array4<const amrex::Real> const& ey_arr = eyfab->array();
+    amrex::Array4<const amrex::Real> const& ez_arr = ezfab->array();
+    amrex::Array4<const amrex::Real> const& bx_arr = bxfab->array();
+    amrex::Array4<const amrex::Real> const& by_arr = byfab->array();
+    amrex::Array4<const amrex::Real> const& bz_arr = bzfab->array();
+
+    amrex::IndexType const ex_type = exfab->box().ixType();
+    amrex::IndexType const ey_type = eyfab->box().ixType();
+    amrex::IndexType const ez_type = ezfab->box().ixType();
+    amrex::IndexType const bx_type = bxfab->box().ixType();
+    amrex::IndexType const by_type = byfab->box().ixType();
+    amrex::IndexType const bz_type = bzfab->box().ixType();
+
+    auto& attribs = pti.GetAttribs();
+    ParticleReal* const AMREX_RESTRICT ux = attribs[PIdx::ux].dataPtr();
+    ParticleReal* const AMREX_RESTRICT uy = attribs[PIdx::uy].dataPtr();
+    ParticleReal* const AMREX_RESTRICT uz = attribs[PIdx::uz].dataPtr();
+
+    auto copyAttribs = CopyParticleAttribs(pti, tmp_particle_data, p_offset);
+    int do_copy = (WarpX::do_back_transformed_diagnostics &&
+                          do_back_transformed_diagnostics &&
+                   (a_dt_type!=DtType::SecondHalf));
+
+    int* AMREX_RESTRICT ion_lev = nullptr;
+    if (do_ionization) {
+        ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
+    }
+
+    // Loop over the particles and update their momentum
+    const amrex::Real q = this->charge;
+    const amrex::Real m = this-> mass;
+
+#ifdef WARPX_QED
+    const auto do_sync = m_do_qed_quantum_sync;
+    amrex::Real t_chi_max = 0.0;
+    if (do_sync) t_chi_max = m_shr_p_qs_engine->get_minimum_chi_part();
+
+    QuantumSynchrotronEvolveOpticalDepth evolve_opt;
+    amrex::ParticleReal* AMREX_RESTRICT p_optical_depth_QSR = nullptr;
+    const bool local_has_quantum_sync = has_quantum_sync();
+    QEDEventListView qed_events;
+    if (local_has_quantum_sync) {
+        evolve_opt = m_shr_p_qs_engine->build_evolve_functor();
+        p_optical_depth_QSR = pti.GetAttribs(particle_comps["optical_depth_QSR"]).dataPtr();
+        qed_events = GetQEDEventListView(pti);
+    }
+#endif
+
+    const auto t_do_not_gather = do_not_gather;
+
+#ifdef AMREX_USE_GPU
+    amrex::ParallelFor( np_to_push, [=] AMREX_GPU_DEVICE (long i)
+    {
+        const long ip = p_pid ? p_pid[i] : i;
+
+        amrex::ParticleReal xp, yp, zp;
+        getPosition(ip, xp, yp, zp);
+
+        amrex::ParticleReal Exp = 0._rt, Eyp = 0._rt, Ezp = 0._rt;
+        amrex::ParticleReal Bxp = 0._rt, Byp = 0._rt, Bzp = 0._rt;
+
+        if(!t_do_not_gather){
+            // first gather E and B to the particle positions
+            doGatherShapeN<depos_order, galerkin_interpolation>(
+                xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp,
+                ex_arr, ey_arr, ez_arr, bx_arr, by_arr, bz_arr,
+                ex_type, ey_type, ez_type, bx_type, by_type, bz_type,
+                dx_arr, xyzmin_arr, lo, n_rz_azimuthal_modes);
+        }
+        // Externally applied E-field in Cartesian co-ordinates
+        getExternalE(ip, Exp, Eyp, Ezp);
+        // Externally applied B-field in Cartesian co-ordinates
+        getExternalB(ip, Bxp, Byp, Bzp);
+
+        scaleFields(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp);
+
+        doParticlePushCT<push_algo, do_ionization>(
+                       getPosition, setPosition, copyAttribs, ip,
+                       ux[ip+p_offset], uy[ip+p_offset], uz[ip+p_offset],
+                       Exp, Eyp, Ezp, Bxp, Byp, Bzp,
+                       do_ionization ? ion_lev[ip] : 0,
+                       m, q, do_copy,
+#ifdef WARPX_QED
+                       do_sync,
+                       t_chi_max,
+#endif
+                       dt);
+
+#ifdef WARPX_QED
+    if (local_has_quantum_sync) {
+        const long it = ip + p_offset;
+        evolve_opt(ux[it], uy[it], uz[it],
+                   Exp, Eyp, Ezp,Bxp, Byp, Bzp,
+                   dt, p_optical_depth_QSR[it]);
+        // Photon emission candidate, see MultiParticleContainer::doQedQuantumSync
+        if (qed_events.m_idx && p_optical_depth_QSR[it] < 0._rt) {
+            qed_events.flag(static_cast<int>(it));
+        }
+    }
+#endif
+
+    });
+#else
+    // On CPU, the particles are pushed by blocks: the fields are gathered for the particles
+    // of a block into local arrays, and the momenta of the block are then pushed in a loop
+    // without gather, indirection or branch, which the compiler vectorizes
+    constexpr int block_size = 16;
+    for (long ib = 0; ib < np_to_push; ib += block_size)
+    {
+        const int nb = static_cast<int>(std::min(static_cast<long>(block_size), np_to_push - ib));
+        long ipb[block_size];
+        int ion_levb[block_size];
+        amrex::ParticleReal uxb[block_size], uyb[block_size], uzb[block_size];
+        amrex::ParticleReal Exb[block_size], Eyb[block_size], Ezb[block_size];
+        amrex::ParticleReal Bxb[block_size], Byb[block_size], Bzb[block_size];
+
+        for (int k = 0; k < nb; ++k)
+        {
+            const long ip = p_pid ? p_pid[ib+k] : ib+k;
+            ipb[k] = ip;
+
+            amrex::ParticleReal xp, yp, zp;
+            getPosition(ip, xp, yp, zp);
+
+            amrex::ParticleReal Exp = 0._rt, Eyp = 0._rt, Ezp = 0._rt;
+            amrex::ParticleReal Bxp = 0._rt, Byp = 0._rt, Bzp = 0._rt;
+
+            if(!t_do_not_gather){
+                doGatherShapeN<depos_order, galerkin_interpolation>(
+                    xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp,
+                    ex_arr, ey_arr, ez_arr, bx_arr, by_arr, bz_arr,
+                    ex_type, ey_type, ez_type, bx_type, by_type, bz_type,
+                    dx_arr, xyzmin_arr, lo, n_rz_azimuthal_modes);
+            }
+            getExternalE(ip, Exp, Eyp, Ezp);
+            getExternalB(ip, Bxp, Byp, Bzp);
+
+            scaleFields(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp);
+
+            Exb[k] = Exp; Eyb[k] = Eyp; Ezb[k] = Ezp;
+            Bxb[k] = Bxp; Byb[k] = Byp; Bzb[k] = Bzp;
+            uxb[k] = ux[ip+p_offset];
+            uyb[k] = uy[ip+p_offset];
+            uzb[k] = uz[ip+p_offset];
+            ion_levb[k] = do_ionization ? ion_lev[ip] : 0;
+
+            if (do_copy) copyAttribs(ip);
+        }
+
+        AMREX_PRAGMA_SIMD
+        for (int k = 0; k < nb; ++k)
+        {
+            doParticleMomentumPushCT<push_algo, do_ionization>(
+                uxb[k], uyb[k], uzb[k],
+                Exb[k], Eyb[k], Ezb[k], Bxb[k], Byb[k], Bzb[k],
+                ion_levb[k], m, q,
+#ifdef WARPX_QED
+                do_sync, t_chi_max,
+#endif
+                dt);
+        }
+
+        for (int k = 0; k < nb; ++k)
+        {
+            const long ip = ipb[k];
+            const long it = ip + p_offset;
+            ux[it] = uxb[k];
+            uy[it] = uyb[k];
+            uz[it] = uzb[k];
+
+            amrex::ParticleReal x, y, z;
+            getPosition(ip, x, y, z);
+            UpdatePosition(x, y, z, uxb[k], uyb[k], uzb[k], dt);
+            setPosition(ip, x, y, z);
+
+#ifdef WARPX_QED
+            if (local_has_quantum_sync) {
+                evolve_opt(ux[it], uy[it], uz[it],
+                           Exb[k], Eyb[k], Ezb[k], Bxb[k], Byb[k], Bzb[k],
+                           dt, p_optical_depth_QSR[it]);
+                // Photon emission candidate, see MultiParticleContainer::doQedQuantumSync
+                if (qed_events.m_idx && p_optical_depth_QSR[it] < 0._rt) {
+                    qed_events.flag(static_cast<int>(it));
+                }
+            }
+#endif
+        }
+    }
+#endif
+}
+
+namespace
+{
+    using PushPXShapeNPtr = void (PhysicalParticleContainer::*) (
+        WarpXParIter&,
+        amrex::FArrayBox const *, amrex::FArrayBox const *, amrex::FArrayBox const *,
+        amrex::FArrayBox const *, amrex::FArrayBox const *, amrex::FArrayBox const *,
+        const amrex::IntVect, const int, const long, const long, int, int,
+        amrex::Real, ScaleFields, DtType, const long*);
+
+    // Number of kernels for each shape order, and shape order of the kernel ik
+    constexpr int n_push_kernels_per_order = 2*PushAlgoCT::N*2;
+    constexpr int push_kernel_order (int ik) { return ik/n_push_kernels_per_order + 1; }
+
+    /** \brief Table of the PushPX kernels specialized for the shape orders 1 to 3,
+     * with or without Galerkin interpolation, pushers of PushAlgoCT, and with or without
+     * ionization. The kernel ik is for ((nox-1)*2 + galerkin)*PushAlgoCT::N*2 + pusher*2 + ionization. */
+    template <std::size_t... ik>
+    std::array<PushPXShapeNPtr, sizeof...(ik)>
+    MakePushPXTable (std::index_sequence<ik...>)
+    {
+        return {{ &PhysicalParticleContainer::PushPXShapeN<
+                      push_kernel_order(ik),
+                      (ik/(PushAlgoCT::N*2))%2,
+                      (ik/2)%PushAlgoCT::N,
+                      ik%2 == 1>... }};
+    }
+
+    const auto push_px_kernels = MakePushPXTable(std::make_index_sequence<3*n_push_kernels_per_order>());
+}
+
+void
+PhysicalParticleContainer::PushPX (WarpXParIter& pti,
+                                   amrex::FArrayBox const * exfab,
+                                   amrex::FArrayBox const * eyfab,
+                                   amrex::FArrayBox const * ezfab,
+                                   amrex::FArrayBox const * bxfab,
+                                   amrex::FArrayBox const * byfab,
+                                   amrex::FArrayBox const * bzfab,
+                                   const amrex::IntVect ngE, const int e_is_nodal,
+                                   const long offset,
+                                   const long np_to_push,
+                                   int lev, int gather_lev,
+                                   amrex::Real dt, ScaleFields scaleFields,
+                                   DtType a_dt_type, const long* pid)
+{
+    // Select the kernel compiled for the shape order, the interpolation,
+    // the pusher and the ionization, so that the particle loop has no branch on them
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::nox >= 1 && WarpX::nox <= 3,
+                                     "The particle shape order must be 1, 2 or 3");
+    int const push_algo = (do_classical_radiation_reaction) ?
+        static_cast<int>(PushAlgoCT::BorisRadiationReaction) : WarpX::particle_pusher_algo;
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(push_algo >= 0 && push_algo < PushAlgoCT::N,
+                                     "Unknown particle pusher");
+    int const ik = (((WarpX::nox-1)*2 + (WarpX::galerkin_interpolation ? 1 : 0))*PushAlgoCT::N
+                    + push_algo)*2 + (do_field_ionization ? 1 : 0);
+
+    HardwareCounterRegion counters("PushPX");
+    (this->*push_px_kernels[ik])(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab,
+                                 ngE, e_is_nodal, offset, np_to_push, lev, gather_lev,
+                                 dt, scaleFields, a_dt_type, pid);
+}
+
+template <typename DepositFunc>
+void
+PhysicalParticleContainer::PushPXDepositCurrentKernel (WarpXParIter& pti,
+                                                       amrex::FArrayBox const * exfab,
+                                                       amrex::FArrayBox const * eyfab,
+                                                       amrex::FArrayBox const * ezfab,
+                                                       amrex::FArrayBox const * bxfab,
+                                                       amrex::FArrayBox const * byfab,
+                                                       amrex::FArrayBox const * bzfab,
+                                                       const amrex::IntVect ngE,
+                                                       const long np_to_push, int lev,
+                                                       amrex::Real dt, DtType a_dt_type,
+                                                       DepositFunc const& deposit)
+{
+    // Get cell size and box from which field is gathered, as in PushPX
+    const std::array<Real,3>& dx = WarpX::CellSize(lev);
+    Box box = pti.tilebox();
+    box.grow(ngE);
+
+    const auto getPosition = GetParticlePosition(pti);
+          auto setPosition = SetParticlePosition(pti);
+
+    const auto getExternalE = GetExternalEField(pti);
+    const auto getExternalB = GetExternalBField(pti);
+
+    // Lower corner of tile box physical domain (take into account Galilean shift)
+    Real cur_time = WarpX::GetInstance().gett_new(lev);
+    const auto& time_of_last_gal_shift = WarpX::GetInstance().time_of_last_gal_shift;
+    Real time_shift = (cur_time - time_of_last_gal_shift);
+    amrex::Array<amrex::Real,3> galilean_shift ={
+        m_v_galilean[0]*time_shift,
+        m_v_galilean[1]*time_shift,
+        m_v_galilean[2]*time_shift };
+    const std::array<Real, 3>& xyzmin = WarpX::LowerCorner(box, galilean_shift, lev);
+
+    const Dim3 lo = lbound(box);
+
     bool galerkin_interpolation = WarpX::galerkin_interpolation;
     int nox = WarpX::nox;
     int n_rz_azimuthal_modes = WarpX::n_rz_azimuthal_modes;
@@ -1839,8 +2233,9 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
     ParticleReal* const AMREX_RESTRICT ux = attribs[PIdx::ux].dataPtr();
     ParticleReal* const AMREX_RESTRICT uy = attribs[PIdx::uy].dataPtr();
     ParticleReal* const AMREX_RESTRICT uz = attribs[PIdx::uz].dataPtr();
+    const ParticleReal* const AMREX_RESTRICT wp = attribs[PIdx::w].dataPtr();
 
-    auto copyAttribs = CopyParticleAttribs(pti, tmp_particle_data, offset);
+    auto copyAttribs = CopyParticleAttribs(pti, tmp_particle_data);
     int do_copy = (WarpX::do_back_transformed_diagnostics &&
                           do_back_transformed_diagnostics &&
                    (a_dt_type!=DtType::SecondHalf));
@@ -1850,7 +2245,6 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
         ion_lev = pti.GetiAttribs(particle_icomps["ionization_level"]).dataPtr();
     }
 
-    // Loop over the particles and update their momentum
     const amrex::Real q = this->charge;
     const amrex::Real m = this-> mass;
 
@@ -1864,9 +2258,11 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
     QuantumSynchrotronEvolveOpticalDepth evolve_opt;
     amrex::ParticleReal* AMREX_RESTRICT p_optical_depth_QSR = nullptr;
     const bool local_has_quantum_sync = has_quantum_sync();
+    QEDEventListView qed_events;
     if (local_has_quantum_sync) {
         evolve_opt = m_shr_p_qs_engine->build_evolve_functor();
         p_optical_depth_QSR = pti.GetAttribs(particle_comps["optical_depth_QSR"]).dataPtr();
+        qed_events = GetQEDEventListView(pti);
     }
 #endif
 
@@ -1893,10 +2289,11 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
         // Externally applied B-field in Cartesian co-ordinates
         getExternalB(ip, Bxp, Byp, Bzp);
 
-        scaleFields(xp, yp, zp, Exp, Eyp, Ezp, Bxp, Byp, Bzp);
-
+        amrex::ParticleReal uxp = ux[ip];
+        amrex::ParticleReal uyp = uy[ip];
+        amrex::ParticleReal uzp = uz[ip];
         doParticlePush(getPosition, setPosition, copyAttribs, ip,
-                       ux[ip+offset], uy[ip+offset], uz[ip+offset],
+                       uxp, uyp, uzp,
                        Exp, Eyp, Ezp, Bxp, Byp, Bzp,
                        ion_lev ? ion_lev[ip] : 0,
                        m, q, pusher_algo, do_crr, do_copy,
@@ -1907,16 +2304,129 @@ PhysicalParticleContainer::PushPX (WarpXParIter& pti,
                        dt);
 
 #ifdef WARPX_QED
-    if (local_has_quantum_sync) {
-        evolve_opt(ux[ip], uy[ip], uz[ip],
-                   Exp, Eyp, Ezp,Bxp, Byp, Bzp,
-                   dt, p_optical_depth_QSR[ip]);
-    }
+        if (local_has_quantum_sync) {
+            evolve_opt(uxp, uyp, uzp,
+                       Exp, Eyp, Ezp,Bxp, Byp, Bzp,
+                       dt, p_optical_depth_QSR[ip]);
+            if (qed_events.m_idx && p_optical_depth_QSR[ip] < 0._rt) {
+                qed_events.flag(static_cast<int>(ip));
+            }
+        }
 #endif
-
+        ux[ip] = uxp;
+        uy[ip] = uyp;
+        uz[ip] = uzp;
+
+        // Deposit the current of the pushed particle,
+        // from the registers rather than from the particle arrays
+        amrex::Real wq = q*wp[ip];
+        if (ion_lev) {
+            wq *= ion_lev[ip];
+        }
+        getPosition(ip, xp, yp, zp);
+        deposit(xp, yp, zp, uxp, uyp, uzp, wq);
     });
 }
 
+void
+PhysicalParticleContainer::PushPXDepositCurrent (WarpXParIter& pti,
+                                                 amrex::FArrayBox const * exfab,
+                                                 amrex::FArrayBox const * eyfab,
+                                                 amrex::FArrayBox const * ezfab,
+                                                 amrex::FArrayBox const * bxfab,
+                                                 amrex::FArrayBox const * byfab,
+                                                 amrex::FArrayBox const * bzfab,
+                                                 const amrex::IntVect ngE,
+                                                 amrex::MultiFab* jx, amrex::MultiFab* jy,
+                                                 amrex::MultiFab* jz,
+                                                 const long np_to_push, int lev,
+                                                 amrex::Real dt, DtType a_dt_type)
+{
+    // If no particles, do not do anything
+    if (np_to_push == 0) return;
+
+    WarpX& warpx = WarpX::GetInstance();
+
+    // Tile box where the current is deposited, with the guard cells, and its
+    // lower corner (take into account Galilean shift), as in DepositCurrent
+    Box tilebox = pti.tilebox();
+    tilebox.grow(warpx.get_ng_depos_J());
+    const Dim3 lo = lbound(tilebox);
+    Real cur_time = warpx.gett_new(lev);
+    Real time_shift = (cur_time + 0.5_rt*dt - warpx.time_of_last_gal_shift);
+    amrex::Array<amrex::Real,3> galilean_shift = {
+        m_v_galilean[0]*time_shift,
+        m_v_galilean[1]*time_shift,
+        m_v_galilean[2]*time_shift };
+    const std::array<Real, 3>& xyzmin = WarpX::LowerCorner(tilebox, galilean_shift, lev);
+    const std::array<Real,3>& dx = WarpX::CellSize(lev);
+    const int n_rz_azimuthal_modes = WarpX::n_rz_azimuthal_modes;
+
+    if (WarpX::current_deposition_algo == CurrentDepositionAlgo::Esirkepov) {
+        if (WarpX::do_nodal==1) {
+          amrex::Abort("The Esirkepov algorithm cannot be used with a nodal grid.");
+        }
+        if ( (m_v_galilean[0]!=0) or (m_v_galilean[1]!=0) or (m_v_galilean[2]!=0)){
+            amrex::Abort("The Esirkepov algorithm cannot be used with the Galilean algorithm.");
+        }
+        Array4<Real> const& jx_arr = jx->array(pti);
+        Array4<Real> const& jy_arr = jy->array(pti);
+        Array4<Real> const& jz_arr = jz->array(pti);
+        if        (WarpX::nox == 1){
+            PushPXDepositCurrentKernel(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngE,
+                np_to_push, lev, dt, a_dt_type,
+                DepositCurrentEsirkepov<1>(jx_arr, jy_arr, jz_arr, dt, dx, xyzmin, lo,
+                                           n_rz_azimuthal_modes));
+        } else if (WarpX::nox == 2){
+            PushPXDepositCurrentKernel(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngE,
+                np_to_push, lev, dt, a_dt_type,
+                DepositCurrentEsirkepov<2>(jx_arr, jy_arr, jz_arr, dt, dx, xyzmin, lo,
+                                           n_rz_azimuthal_modes));
+        } else if (WarpX::nox == 3){
+            PushPXDepositCurrentKernel(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngE,
+                np_to_push, lev, dt, a_dt_type,
+                DepositCurrentEsirkepov<3>(jx_arr, jy_arr, jz_arr, dt, dx, xyzmin, lo,
+                                           n_rz_azimuthal_modes));
+        }
+    } else {
+        auto & jx_fab = jx->get(pti);
+        auto & jy_fab = jy->get(pti);
+        auto & jz_fab = jz->get(pti);
+        // Deposit current at t_{n+1/2}
+        const Real relative_t = -0.5_rt*dt;
+        if        (WarpX::nox == 1){
+            PushPXDepositCurrentKernel(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngE,
+                np_to_push, lev, dt, a_dt_type,
+                DepositCurrentDirect<1>(jx_fab, jy_fab, jz_fab, relative_t, dx, xyzmin, lo,
+                                        n_rz_azimuthal_modes));
+        } else if (WarpX::nox == 2){
+            PushPXDepositCurrentKernel(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngE,
+                np_to_push, lev, dt, a_dt_type,
+                DepositCurrentDirect<2>(jx_fab, jy_fab, jz_fab, relative_t, dx, xyzmin, lo,
+                                        n_rz_azimuthal_modes));
+        } else if (WarpX::nox == 3){
+            PushPXDepositCurrentKernel(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab, ngE,
+                np_to_push, lev, dt, a_dt_type,
+                DepositCurrentDirect<3>(jx_fab, jy_fab, jz_fab, relative_t, dx, xyzmin, lo,
+                                        n_rz_azimuthal_modes));
+        }
+    }
+
+    // Check, after the deposition, that the particles shape fits within the guard
+    // cells of J (this is done before the deposition in DepositCurrent)
+#if   (AMREX_SPACEDIM == 2)
+    const amrex::IntVect shape_extent = amrex::IntVect(static_cast<int>(WarpX::nox/2),
+                                                       static_cast<int>(WarpX::noz/2));
+#elif (AMREX_SPACEDIM == 3)
+    const amrex::IntVect shape_extent = amrex::IntVect(static_cast<int>(WarpX::nox/2),
+                                                       static_cast<int>(WarpX::noy/2),
+                                                       static_cast<int>(WarpX::noz/2));
+#endif
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+        amrex::numParticlesOutOfRange(pti, jx->nGrowVect() - shape_extent) == 0,
+        "Particles shape does not fit within guard cells used for current deposition");
+}
+
 void
 PhysicalParticleContainer::InitIonizationModule ()
 {
@@ -1978,6 +2488,37 @@ PhysicalParticleContainer::InitIonizationModule ()
         p_adk_exp_prefactor[i] = -2./3 * std::pow( Uion/UH,3./2) * Ea;
     });
 
+    // Optional table of the logarithm of the ADK rate of each ionization level,
+    // log-spaced in the field amplitude, used instead of the power law and
+    // exponential of each particle (see IonizationFilterFunc)
+    int points_per_decade = 0;
+    pp_species_name.query("ionization_table_points_per_decade", points_per_decade);
+    if (points_per_decade > 0) {
+        Real emin = 1.e9_rt;
+        Real emax = 1.e16_rt;
+        queryWithParser(pp_species_name, "ionization_table_emin", emin);
+        queryWithParser(pp_species_name, "ionization_table_emax", emax);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(emin > 0._rt && emax > emin,
+            "ionization_table_emin and ionization_table_emax must satisfy 0 < emin < emax");
+        const Real log_emin = std::log(emin);
+        const Real log_emax = std::log(emax);
+        const int npts = static_cast<int>(std::ceil(points_per_decade*std::log10(emax/emin))) + 1;
+        const Real dlogE = (log_emax - log_emin)/(npts - 1);
+        m_ionization_table.npts = npts;
+        m_ionization_table.log_emin = log_emin;
+        m_ionization_table.log_emax = log_emax;
+        m_ionization_table.inv_dlogE = 1._rt/dlogE;
+        m_ionization_table.log_rate.resize(ion_atomic_number*npts);
+        Real * AMREX_RESTRICT p_log_rate = m_ionization_table.log_rate.data();
+        amrex::ParallelFor(ion_atomic_number*npts, [=] AMREX_GPU_DEVICE (int n) noexcept
+        {
+            const int i = n / npts;
+            const Real logE = log_emin + (n % npts)*dlogE;
+            p_log_rate[n] = std::log(p_adk_prefactor[i]) + p_adk_power[i]*logE
+                + p_adk_exp_prefactor[i]*std::exp(-logE);
+        });
+    }
+
     Gpu::synchronize();
 }
 
@@ -2001,7 +2542,8 @@ PhysicalParticleContainer::getIonizationFunc (const WarpXParIter& pti,
                                 adk_exp_prefactor.dataPtr(),
                                 adk_power.dataPtr(),
                                 particle_icomps["ionization_level"],
-                                ion_atomic_number);
+                                ion_atomic_number,
+                                m_ionization_table.getView());
 }
 
 void PhysicalParticleContainer::resample (const int timestep)
@@ -0,0 +1,236 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "ParticleMerging.H"
+#include "Utils/ParticleUtils.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX_Particles.H>
+
+#include <cmath>
+
+namespace
+{
+    using index_type = amrex::DenseBins<WarpXParticleContainer::ParticleType>::index_type;
+
+    /** \brief Restore the max-heap property of the `n` indices `a`, ordered by `key[a[i]]`,
+     * below the element `root` */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void siftDown (index_type* a, int root, const int n, const int* key) noexcept
+    {
+        while (true) {
+            int child = 2*root + 1;
+            if (child >= n) return;
+            if (child+1 < n && key[a[child+1]] > key[a[child]]) ++child;
+            if (key[a[root]] >= key[a[child]]) return;
+            const index_type tmp = a[root];
+            a[root] = a[child];
+            a[child] = tmp;
+            root = child;
+        }
+    }
+
+    /** \brief In-place heap sort of the `n` indices `a` by increasing `key[a[i]]` */
+    AMREX_GPU_HOST_DEVICE AMREX_FORCE_INLINE
+    void sortByKey (index_type* a, const int n, const int* key) noexcept
+    {
+        for (int start = n/2-1; start >= 0; --start) siftDown(a, start, n, key);
+        for (int end = n-1; end > 0; --end) {
+            const index_type tmp = a[0];
+            a[0] = a[end];
+            a[end] = tmp;
+            siftDown(a, 0, end, key);
+        }
+    }
+}
+
+ParticleMerging::ParticleMerging (const std::string species_name)
+{
+    amrex::ParmParse pp_species_name(species_name);
+    pp_species_name.query("resampling_algorithm_n_momentum_bins", m_n_momentum_bins);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_n_momentum_bins >= 1,
+        "Resampling n_momentum_bins should be greater than or equal to 1");
+
+    pp_species_name.query("resampling_algorithm_min_ppc", m_min_ppc);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_min_ppc >= 1,
+                                     "Resampling min_ppc should be greater than or equal to 1");
+}
+
+void ParticleMerging::operator() (WarpXParIter& pti, const int lev,
+                                  WarpXParticleContainer * const pc) const
+{
+    using namespace amrex::literals;
+
+    auto& ptile = pc->ParticlesAt(lev, pti);
+    auto& soa = ptile.GetStructOfArrays();
+    const int np = ptile.numParticles();
+    if (np == 0) return;
+
+    amrex::ParticleReal * const AMREX_RESTRICT w = soa.GetRealData(PIdx::w).data();
+    amrex::ParticleReal * const AMREX_RESTRICT ux = soa.GetRealData(PIdx::ux).data();
+    amrex::ParticleReal * const AMREX_RESTRICT uy = soa.GetRealData(PIdx::uy).data();
+    amrex::ParticleReal * const AMREX_RESTRICT uz = soa.GetRealData(PIdx::uz).data();
+    WarpXParticleContainer::ParticleType * const AMREX_RESTRICT
+                                 particle_ptr = ptile.GetArrayOfStructs()().data();
+
+    // Particles with different ionization levels are not merged, to conserve the charge
+    const int* AMREX_RESTRICT ion_lev = nullptr;
+    if (pc->DoFieldIonization()) {
+        ion_lev = soa.GetIntData(pc->getParticleiComps().at("ionization_level")).data();
+    }
+
+    auto bins = ParticleUtils::findParticlesInEachCell(lev, pti, ptile);
+
+    const int n_cells = bins.numBins();
+    const auto indices = bins.permutationPtr();
+    const auto cell_offsets = bins.offsetsPtr();
+
+    // Momentum bin of each particle (-1 for the particles that are not merged)
+    amrex::Gpu::DeviceVector<int> momentum_bin(np);
+    int * const AMREX_RESTRICT key = momentum_bin.dataPtr();
+
+    const int nb = m_n_momentum_bins;
+    const int nb3 = nb*nb*nb;
+    const int min_ppc = m_min_ppc;
+    const bool is_photon = pc->AmIA<PhysicalSpecies::photon>();
+    constexpr amrex::ParticleReal inv_c = 1._prt/PhysConst::c;
+
+    // Loop over cells
+    amrex::ParallelFor( n_cells,
+        [=] AMREX_GPU_DEVICE (int i_cell) noexcept
+        {
+            // The particles that are in the cell `i_cell` are
+            // given by the `indices[cell_start:cell_stop]`
+            const auto cell_start = static_cast<int>(cell_offsets[i_cell]);
+            const auto cell_stop  = static_cast<int>(cell_offsets[i_cell+1]);
+            const int cell_numparts = cell_stop - cell_start;
+
+            // do nothing for cells with less particles than min_ppc, or too few
+            // particles to reduce their number
+            if (cell_numparts < min_ppc || cell_numparts < 3)
+                return;
+
+            // First loop over cell particles to find the range of the momenta in the cell
+            amrex::ParticleReal umin[3] = {ux[indices[cell_start]], uy[indices[cell_start]],
+                                           uz[indices[cell_start]]};
+            amrex::ParticleReal umax[3] = {umin[0], umin[1], umin[2]};
+            for (int i = cell_start+1; i < cell_stop; ++i)
+            {
+                const amrex::ParticleReal u[3] = {ux[indices[i]], uy[indices[i]], uz[indices[i]]};
+                for (int d = 0; d < 3; ++d) {
+                    umin[d] = amrex::min(umin[d], u[d]);
+                    umax[d] = amrex::max(umax[d], u[d]);
+                }
+            }
+
+            // Second loop to find the momentum bin of the cell particles
+            for (int i = cell_start; i < cell_stop; ++i)
+            {
+                const auto ip = indices[i];
+                if (particle_ptr[ip].id() < 0) {
+                    key[ip] = -1;
+                    continue;
+                }
+                const amrex::ParticleReal u[3] = {ux[ip], uy[ip], uz[ip]};
+                int ib[3] = {0, 0, 0};
+                for (int d = 0; d < 3; ++d) {
+                    if (umax[d] > umin[d]) {
+                        ib[d] = amrex::min(static_cast<int>((u[d]-umin[d])/(umax[d]-umin[d])*nb),
+                                           nb-1);
+                    }
+                }
+                key[ip] = ib[0] + nb*(ib[1] + nb*ib[2]);
+                if (ion_lev) key[ip] += nb3*ion_lev[ip];
+            }
+
+            // Group the cell particles of each momentum bin
+            sortByKey(indices + cell_start, cell_numparts, key);
+
+            // Merge the particles of each momentum bin
+            int group_start = cell_start;
+            while (group_start < cell_stop)
+            {
+                const int group_key = key[indices[group_start]];
+                int group_stop = group_start + 1;
+                while (group_stop < cell_stop && key[indices[group_stop]] == group_key) ++group_stop;
+                const int group_numparts = group_stop - group_start;
+                const int first = group_start;
+                group_start = group_stop;
+                if (group_key < 0 || group_numparts < 3) continue;
+
+                // Total weight, momentum (in units of mc) and energy (in units of mc^2)
+                amrex::ParticleReal wtot = 0._prt;
+                amrex::ParticleReal ptot[3] = {0._prt, 0._prt, 0._prt};
+                amrex::ParticleReal etot = 0._prt;
+                for (int i = first; i < group_stop; ++i)
+                {
+                    const auto ip = indices[i];
+                    const amrex::ParticleReal p[3] = {ux[ip]*inv_c, uy[ip]*inv_c, uz[ip]*inv_c};
+                    const amrex::ParticleReal p2 = p[0]*p[0] + p[1]*p[1] + p[2]*p[2];
+                    wtot += w[ip];
+                    for (int d = 0; d < 3; ++d) ptot[d] += w[ip]*p[d];
+                    etot += w[ip]*(is_photon ? std::sqrt(p2) : std::sqrt(1._prt + p2));
+                }
+                if (wtot <= 0._prt) continue;
+
+                // Energy and momentum of each of the two merged particles
+                const amrex::ParticleReal e_merged = etot/wtot;
+                const amrex::ParticleReal p_merged = is_photon ? e_merged :
+                    std::sqrt(amrex::max(e_merged*e_merged - 1._prt, 0._prt));
+                const amrex::ParticleReal ptot_norm = std::sqrt(ptot[0]*ptot[0] + ptot[1]*ptot[1] +
+                                                                ptot[2]*ptot[2]);
+                // Angle between the momenta of the merged particles and the total momentum
+                const amrex::ParticleReal cos_theta = (p_merged > 0._prt) ?
+                    amrex::min(ptot_norm/(wtot*p_merged), 1._prt) : 1._prt;
+                const amrex::ParticleReal sin_theta = std::sqrt(1._prt - cos_theta*cos_theta);
+
+                // Unit vector e1 along the total momentum, and e2 orthogonal to e1 in the plane
+                // of the total momentum and of the momentum of the first particle
+                amrex::ParticleReal e1[3] = {1._prt, 0._prt, 0._prt};
+                if (ptot_norm > 0._prt) {
+                    for (int d = 0; d < 3; ++d) e1[d] = ptot[d]/ptot_norm;
+                }
+                const auto ip0 = indices[first];
+                amrex::ParticleReal e2[3] = {ux[ip0]*inv_c, uy[ip0]*inv_c, uz[ip0]*inv_c};
+                amrex::ParticleReal e2_dot_e1 = e2[0]*e1[0] + e2[1]*e1[1] + e2[2]*e1[2];
+                for (int d = 0; d < 3; ++d) e2[d] -= e2_dot_e1*e1[d];
+                amrex::ParticleReal e2_norm = std::sqrt(e2[0]*e2[0] + e2[1]*e2[1] + e2[2]*e2[2]);
+                const amrex::ParticleReal p0_norm = std::sqrt(ux[ip0]*ux[ip0] + uy[ip0]*uy[ip0] +
+                                                              uz[ip0]*uz[ip0])*inv_c;
+                if (e2_norm <= 1.e-6_prt*p0_norm || e2_norm == 0._prt) {
+                    // The first particle is along e1: use the coordinate axis which is
+                    // the least aligned with e1
+                    const int axis = (std::abs(e1[0]) < 0.9_prt) ? 0 : 1;
+                    for (int d = 0; d < 3; ++d) e2[d] = (d == axis) ? 1._prt : 0._prt;
+                    e2_dot_e1 = e1[axis];
+                    for (int d = 0; d < 3; ++d) e2[d] -= e2_dot_e1*e1[d];
+                    e2_norm = std::sqrt(e2[0]*e2[0] + e2[1]*e2[1] + e2[2]*e2[2]);
+                }
+                for (int d = 0; d < 3; ++d) e2[d] /= e2_norm;
+
+                // The first two particles of the bin become the merged particles,
+                // and the others are removed
+                const auto ip1 = indices[first+1];
+                const amrex::ParticleReal u_merged = p_merged*PhysConst::c;
+                w[ip0] = 0.5_prt*wtot;
+                w[ip1] = 0.5_prt*wtot;
+                ux[ip0] = u_merged*(cos_theta*e1[0] + sin_theta*e2[0]);
+                uy[ip0] = u_merged*(cos_theta*e1[1] + sin_theta*e2[1]);
+                uz[ip0] = u_merged*(cos_theta*e1[2] + sin_theta*e2[2]);
+                ux[ip1] = u_merged*(cos_theta*e1[0] - sin_theta*e2[0]);
+                uy[ip1] = u_merged*(cos_theta*e1[1] - sin_theta*e2[1]);
+                uz[ip1] = u_merged*(cos_theta*e1[2] - sin_theta*e2[2]);
+                for (int i = first+2; i < group_stop; ++i)
+                {
+                    particle_ptr[indices[i]].id() = -1;
+                }
+            }
+        }
+    );
+
+    amrex::Gpu::synchronize();
+}
@@ -6,6 +6,7 @@
  */
 #include "Resampling.H"
 #include "LevelingThinning.H"
+#include "ParticleMerging.H"
 
 Resampling::Resampling (const std::string species_name)
 {
@@ -17,6 +18,10 @@ Resampling::Resampling (const std::string species_name)
     {
         m_resampling_algorithm = std::make_unique<LevelingThinning>(species_name);
     }
+    else if (resampling_algorithm_string.compare("merging") == 0)
+    {
+        m_resampling_algorithm = std::make_unique<ParticleMerging>(species_name);
+    }
     else
     { amrex::Abort("Unknown resampling algorithm."); }
 
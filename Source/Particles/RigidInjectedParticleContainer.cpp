@@ -24,6 +24,7 @@
 #include "Gather/FieldGather.H"
 
 #include <AMReX_Geometry.H>
+#include <AMReX_Scan.H>
 
 #include <limits>
 #include <sstream>
@@ -44,6 +45,8 @@ RigidInjectedParticleContainer::RigidInjectedParticleContainer (AmrCore* amr_cor
     pp_species_name.query("focused", focused);
     pp_species_name.query("rigid_advance", rigid_advance);
 
+    // The particles not injected yet are not pushed by PushPX
+    m_allow_fused_push_deposit = false;
 }
 
 void RigidInjectedParticleContainer::InitData()
@@ -240,102 +243,134 @@ RigidInjectedParticleContainer::PushPX (WarpXParIter& pti,
                                         const long np_to_push,
                                         int lev, int gather_lev,
                                         amrex::Real dt, ScaleFields /*scaleFields*/,
-                                        DtType a_dt_type)
+                                        DtType a_dt_type, const long* pid)
 {
-    auto& attribs = pti.GetAttribs();
-    auto& uxp = attribs[PIdx::ux];
-    auto& uyp = attribs[PIdx::uy];
-    auto& uzp = attribs[PIdx::uz];
+    const Real v_boost = WarpX::beta_boost*PhysConst::c;
+
+    if (done_injecting_lev) {
+        PhysicalParticleContainer::PushPX(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab,
+                                          ngE, e_is_nodal, offset, np_to_push, lev, gather_lev, dt,
+                                          ScaleFields(false, dt, zinject_plane_lev_previous,
+                                                      vzbeam_ave_boosted, v_boost),
+                                          a_dt_type, pid);
+        return;
+    }
 
-    // Save the position and momenta, making copies
-    Gpu::DeviceVector<ParticleReal> xp_save, yp_save, zp_save;
-    RealVector uxp_save, uyp_save, uzp_save;
+    if (np_to_push == 0) return;
+
+    auto& attribs = pti.GetAttribs();
+    ParticleReal* const AMREX_RESTRICT ux = attribs[PIdx::ux].dataPtr();
+    ParticleReal* const AMREX_RESTRICT uy = attribs[PIdx::uy].dataPtr();
+    ParticleReal* const AMREX_RESTRICT uz = attribs[PIdx::uz].dataPtr();
 
     const auto GetPosition = GetParticlePosition(pti);
           auto SetPosition = SetParticlePosition(pti);
 
-    ParticleReal* const AMREX_RESTRICT ux = uxp.dataPtr();
-    ParticleReal* const AMREX_RESTRICT uy = uyp.dataPtr();
-    ParticleReal* const AMREX_RESTRICT uz = uzp.dataPtr();
-
-    if (!done_injecting_lev)
+    // Velocity along z of the particles not injected yet
+    const Real vz_ave_boosted = vzbeam_ave_boosted;
+    const bool rigid = rigid_advance;
+    const Real inv_csq = 1./(PhysConst::c*PhysConst::c);
+    auto ballistic_vz = [=] AMREX_GPU_HOST_DEVICE (long ip) -> Real
     {
-        // If the old values are not already saved, create copies here.
-        const auto np = pti.numParticles();
-
-        xp_save.resize(np);
-        yp_save.resize(np);
-        zp_save.resize(np);
-
-        uxp_save.resize(np);
-        uyp_save.resize(np);
-        uzp_save.resize(np);
-
-        amrex::Real* const AMREX_RESTRICT xp_save_ptr = xp_save.dataPtr();
-        amrex::Real* const AMREX_RESTRICT yp_save_ptr = yp_save.dataPtr();
-        amrex::Real* const AMREX_RESTRICT zp_save_ptr = zp_save.dataPtr();
-
-        amrex::Real* const AMREX_RESTRICT uxp_save_ptr = uxp_save.dataPtr();
-        amrex::Real* const AMREX_RESTRICT uyp_save_ptr = uyp_save.dataPtr();
-        amrex::Real* const AMREX_RESTRICT uzp_save_ptr = uzp_save.dataPtr();
-
-        amrex::ParallelFor( np,
-                            [=] AMREX_GPU_DEVICE (long i) {
-                                ParticleReal xp, yp, zp;
-                                GetPosition(i, xp, yp, zp);
-                                xp_save_ptr[i] = xp;
-                                yp_save_ptr[i] = yp;
-                                zp_save_ptr[i] = zp;
-                                uxp_save_ptr[i] = ux[i];
-                                uyp_save_ptr[i] = uy[i];
-                                uzp_save_ptr[i] = uz[i];
-                            });
-    }
-
-    const bool do_scale = not done_injecting_lev;
-    const Real v_boost = WarpX::beta_boost*PhysConst::c;
+        if (rigid) return vz_ave_boosted;
+        const Real gi = 1./std::sqrt(1. + (ux[ip]*ux[ip] + uy[ip]*uy[ip] + uz[ip]*uz[ip])*inv_csq);
+        return uz[ip]*gi;
+    };
+
+    // Partition the particles to push: those that are still behind the injection plane
+    // after a ballistic push are not injected yet, and only advance ballistically,
+    // without gathering the fields
+    const Real z_plane_lev = zinject_plane_lev;
+    auto is_ballistic = [=] AMREX_GPU_HOST_DEVICE (long ip) -> bool
+    {
+        ParticleReal xp, yp, zp;
+        GetPosition(ip, xp, yp, zp);
+        return zp + dt*ballistic_vz(ip) <= z_plane_lev;
+    };
+    const long* const p_pid = pid ? pid + offset : nullptr;
+    Gpu::DeviceVector<long> active_pid(np_to_push);
+    Gpu::DeviceVector<long> ballistic_pid(np_to_push);
+    long* const AMREX_RESTRICT p_active = active_pid.dataPtr();
+    long* const AMREX_RESTRICT p_ballistic = ballistic_pid.dataPtr();
+    const long n_active = amrex::Scan::PrefixSum<long>(np_to_push,
+        [=] AMREX_GPU_DEVICE (long i) -> long
+        {
+            const long ip = p_pid ? p_pid[i] : offset + i;
+            return !is_ballistic(ip);
+        },
+        [=] AMREX_GPU_DEVICE (long i, long const& s)
+        {
+            const long ip = p_pid ? p_pid[i] : offset + i;
+            if (is_ballistic(ip)) {
+                p_ballistic[i-s] = ip;
+            } else {
+                p_active[s] = ip;
+            }
+        },
+        amrex::Scan::Type::exclusive);
+    const long n_ballistic = np_to_push - n_active;
+
+    // The particles not injected yet are advanced a fixed amount
+    amrex::ParallelFor( n_ballistic,
+                        [=] AMREX_GPU_DEVICE (long k) {
+                            const long ip = p_ballistic[k];
+                            ParticleReal xp, yp, zp;
+                            GetPosition(ip, xp, yp, zp);
+                            zp += dt*ballistic_vz(ip);
+                            SetPosition(ip, xp, yp, zp);
+                        });
+
+    if (n_active == 0) return;
+
+    // Save the position and momenta of the other particles, which cross the injection
+    // plane or are already injected, making copies
+    Gpu::DeviceVector<ParticleReal> xp_save(n_active), yp_save(n_active), zp_save(n_active);
+    Gpu::DeviceVector<ParticleReal> uxp_save(n_active), uyp_save(n_active), uzp_save(n_active);
+    ParticleReal* const AMREX_RESTRICT x_save = xp_save.dataPtr();
+    ParticleReal* const AMREX_RESTRICT y_save = yp_save.dataPtr();
+    ParticleReal* const AMREX_RESTRICT z_save = zp_save.dataPtr();
+    ParticleReal* const AMREX_RESTRICT ux_save = uxp_save.dataPtr();
+    ParticleReal* const AMREX_RESTRICT uy_save = uyp_save.dataPtr();
+    ParticleReal* const AMREX_RESTRICT uz_save = uzp_save.dataPtr();
+    amrex::ParallelFor( n_active,
+                        [=] AMREX_GPU_DEVICE (long k) {
+                            const long ip = p_active[k];
+                            ParticleReal xp, yp, zp;
+                            GetPosition(ip, xp, yp, zp);
+                            x_save[k] = xp;
+                            y_save[k] = yp;
+                            z_save[k] = zp;
+                            ux_save[k] = ux[ip];
+                            uy_save[k] = uy[ip];
+                            uz_save[k] = uz[ip];
+                        });
+
+    // Only these particles gather the fields and are pushed
     PhysicalParticleContainer::PushPX(pti, exfab, eyfab, ezfab, bxfab, byfab, bzfab,
-                                      ngE, e_is_nodal, offset, np_to_push, lev, gather_lev, dt,
-                                      ScaleFields(do_scale, dt, zinject_plane_lev_previous,
+                                      ngE, e_is_nodal, 0, n_active, lev, gather_lev, dt,
+                                      ScaleFields(true, dt, zinject_plane_lev_previous,
                                                   vzbeam_ave_boosted, v_boost),
-                                      a_dt_type);
-
-    if (!done_injecting_lev) {
-
-        ParticleReal* AMREX_RESTRICT x_save = xp_save.dataPtr();
-        ParticleReal* AMREX_RESTRICT y_save = yp_save.dataPtr();
-        ParticleReal* AMREX_RESTRICT z_save = zp_save.dataPtr();
-        ParticleReal* AMREX_RESTRICT ux_save = uxp_save.dataPtr();
-        ParticleReal* AMREX_RESTRICT uy_save = uyp_save.dataPtr();
-        ParticleReal* AMREX_RESTRICT uz_save = uzp_save.dataPtr();
-
-        // Undo the push for particles not injected yet.
-        // The zp are advanced a fixed amount.
-        const Real z_plane_lev = zinject_plane_lev;
-        const Real vz_ave_boosted = vzbeam_ave_boosted;
-        const bool rigid = rigid_advance;
-        const Real inv_csq = 1./(PhysConst::c*PhysConst::c);
-        amrex::ParallelFor( pti.numParticles(),
-                            [=] AMREX_GPU_DEVICE (long i) {
-                                ParticleReal xp, yp, zp;
-                                GetPosition(i, xp, yp, zp);
-                                if (zp <= z_plane_lev) {
-                                    ux[i] = ux_save[i];
-                                    uy[i] = uy_save[i];
-                                    uz[i] = uz_save[i];
-                                    xp = x_save[i];
-                                    yp = y_save[i];
-                                    if (rigid) {
-                                        zp = z_save[i] + dt*vz_ave_boosted;
-                                    }
-                                    else {
-                                        const Real gi = 1./std::sqrt(1. + (ux[i]*ux[i] + uy[i]*uy[i] + uz[i]*uz[i])*inv_csq);
-                                        zp = z_save[i] + dt*uz[i]*gi;
-                                    }
-                                    SetPosition(i, xp, yp, zp);
-                                }
-                            });
-    }
+                                      a_dt_type, p_active);
+
+    // Undo the push for the particles that are still behind the injection plane
+    amrex::ParallelFor( n_active,
+                        [=] AMREX_GPU_DEVICE (long k) {
+                            const long ip = p_active[k];
+                            ParticleReal xp, yp, zp;
+                            GetPosition(ip, xp, yp, zp);
+                            if (zp <= z_plane_lev) {
+                                ux[ip] = ux_save[k];
+                                uy[ip] = uy_save[k];
+                                uz[ip] = uz_save[k];
+                                xp = x_save[k];
+                                yp = y_save[k];
+                                zp = z_save[k] + dt*ballistic_vz(ip);
+                                SetPosition(ip, xp, yp, zp);
+                            }
+                        });
+
+    // This is necessary because of active_pid, ballistic_pid and the saved copies
+    amrex::Gpu::synchronize();
 }
 
 void
@@ -349,7 +384,8 @@ RigidInjectedParticleContainer::Evolve (int lev,
                                         MultiFab* rho, MultiFab* crho,
                                         const MultiFab* cEx, const MultiFab* cEy, const MultiFab* cEz,
                                         const MultiFab* cBx, const MultiFab* cBy, const MultiFab* cBz,
-                                        Real t, Real dt, DtType a_dt_type)
+                                        Real t, Real dt, DtType a_dt_type,
+                                        bool skip_rho_old)
 {
 
     // Update location of injection plane in the boosted frame
@@ -378,7 +414,7 @@ RigidInjectedParticleContainer::Evolve (int lev,
                                        rho, crho,
                                        cEx, cEy, cEz,
                                        cBx, cBy, cBz,
-                                       t, dt, a_dt_type);
+                                       t, dt, a_dt_type, skip_rho_old);
 }
 
 void
@@ -14,17 +14,19 @@
 using namespace amrex;
 
 /* \brief Determine which particles deposit/gather in the buffer, and
- *        and reorder the particle arrays accordingly
+ *        and compute the order of the particles accordingly
  *
  *  More specifically:
  *  - Modify `nfine_current` and `nfine_gather` (in place)
  *     so that they correspond to the number of particles
  *     that deposit/gather in the fine patch respectively.
- *  - Reorder the particle arrays,
- *     so that the `nfine_current`/`nfine_gather` first particles
- *     deposit/gather in the fine patch
+ *  - Fill `pid` with the indices of the particles of the tile,
+ *     in an order such that the `nfine_current`/`nfine_gather` first
+ *     particles deposit/gather in the fine patch
  *     and (thus) the `np-nfine_current`/`np-nfine_gather` last particles
- *     deposit/gather in the buffer
+ *     deposit/gather in the buffer.
+ *  The particle arrays are not reordered: the gather and deposition
+ *  kernels read the particles through `pid` instead.
  *
  * \param nfine_current number of particles that deposit to the fine patch
  *         (modified by this function)
@@ -37,7 +39,7 @@ using namespace amrex;
  *       in the deposition buffers or in the interior of the fine patch
  * \param gather_masks indicates, for each cell, whether that cell is
  *       in the gather buffers or in the interior of the fine patch
- * \param uxp, uyp, uzp, wp references to the particle momenta and weight
+ * \param pid indices of the particles, in the order described above
  *         (modified by this function)
  */
 void
@@ -46,14 +48,13 @@ PhysicalParticleContainer::PartitionParticlesInBuffers(
     WarpXParIter& pti, int const lev,
     iMultiFab const* current_masks,
     iMultiFab const* gather_masks,
-    RealVector& uxp, RealVector& uyp, RealVector& uzp, RealVector& wp)
+    Gpu::DeviceVector<long>& pid)
 {
     WARPX_PROFILE("PhysicalParticleContainer::PartitionParticlesInBuffers");
 
     // Initialize temporary arrays
     Gpu::DeviceVector<int> inexflag;
     inexflag.resize(np);
-    Gpu::DeviceVector<long> pid;
     pid.resize(np);
 
     // First, partition particles into the larger buffer
@@ -120,37 +121,6 @@ PhysicalParticleContainer::PartitionParticlesInBuffers(
         nfine_gather = 0;
     }
 
-    // Reorder the actual particle array, using the `pid` indices
-    if (nfine_current != np || nfine_gather != np)
-    {
-        // Temporary array for particle AoS
-        ParticleVector particle_tmp;
-        particle_tmp.resize(np);
-
-        // Copy particle AoS
-        auto& aos = pti.GetArrayOfStructs();
-        amrex::ParallelFor( np,
-            copyAndReorder<ParticleType>( aos(), particle_tmp, pid ) );
-        std::swap(aos(), particle_tmp);
-
-        // Temporary array for particle individual attributes
-        RealVector tmp;
-        tmp.resize(np);
-
-        // Copy individual attributes
-        amrex::ParallelFor( np, copyAndReorder<Real>( wp, tmp, pid ) );
-        std::swap(wp, tmp);
-        amrex::ParallelFor( np, copyAndReorder<Real>( uxp, tmp, pid ) );
-        std::swap(uxp, tmp);
-        amrex::ParallelFor( np, copyAndReorder<Real>( uyp, tmp, pid ) );
-        std::swap(uyp, tmp);
-        amrex::ParallelFor( np, copyAndReorder<Real>( uzp, tmp, pid ) );
-        std::swap(uzp, tmp);
-
-        // Make sure that the temporary arrays are not destroyed before
-        // the GPU kernels finish running
-        Gpu::streamSynchronize();
-    }
     // Make sure that the temporary arrays are not destroyed before
     // the GPU kernels finish running
     Gpu::streamSynchronize();
@@ -11,7 +11,12 @@
 #include "WarpXParticleContainer.H"
 #include "WarpX.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/BoxCostTimer.H"
+#include "Utils/PhaseTimer.H"
+#include "Utils/HardwareCounters.H"
 #include "Utils/CoarsenMR.H"
+#include "Utils/ParticleUtils.H"
+#include "ParticleCreation/SmartUtils.H"
 // Import low-level single-particle kernels
 #include "Pusher/GetAndSetPosition.H"
 #include "Pusher/UpdatePosition.H"
@@ -19,25 +24,54 @@
 #include "Deposition/ChargeDeposition.H"
 
 #include <AMReX_AmrParGDB.H>
+#include <AMReX_DenseBins.H>
 #include <AMReX.H>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <set>
 
 
 using namespace amrex;
 
+bool WarpXParticleContainer::do_soa_positions = false;
+bool WarpXParticleContainer::do_fused_push_deposit = false;
+bool WarpXParticleContainer::do_colored_deposition = true;
+bool WarpXParticleContainer::do_tile_dependencies = false;
+
+amrex::Vector<amrex::FArrayBox> WarpXParticleContainer::local_rho;
+amrex::Vector<amrex::FArrayBox> WarpXParticleContainer::local_jx;
+amrex::Vector<amrex::FArrayBox> WarpXParticleContainer::local_jy;
+amrex::Vector<amrex::FArrayBox> WarpXParticleContainer::local_jz;
+
 WarpXParIter::WarpXParIter (ContainerType& pc, int level)
     : amrex::ParIter<0,0,PIdx::nattribs>(pc, level,
-             MFItInfo().SetDynamic(WarpX::do_dynamic_scheduling))
+             MFItInfo().SetDynamic(WarpX::do_dynamic_scheduling)),
+      m_warpx_pc(dynamic_cast<WarpXParticleContainer*>(&pc))
 {
 }
 
 WarpXParIter::WarpXParIter (ContainerType& pc, int level, MFItInfo& info)
     : amrex::ParIter<0,0,PIdx::nattribs>(pc, level,
-                   info.SetDynamic(WarpX::do_dynamic_scheduling))
+                   info.SetDynamic(WarpX::do_dynamic_scheduling)),
+      m_warpx_pc(dynamic_cast<WarpXParticleContainer*>(&pc))
 {
 }
 
+WarpXParIter::WarpXParIter (ContainerType& pc, int level, bool dynamic)
+    : amrex::ParIter<0,0,PIdx::nattribs>(pc, level, MFItInfo().SetDynamic(dynamic)),
+      m_warpx_pc(dynamic_cast<WarpXParticleContainer*>(&pc))
+{
+}
+
+amrex::ParticleReal*
+WarpXParIter::GetSoAPosition (int dim) const
+{
+    if (!m_warpx_pc) return nullptr;
+    return m_warpx_pc->GetSoAPosition(GetLevel(), GetPairIndex(), numParticles(), dim);
+}
+
 WarpXParticleContainer::WarpXParticleContainer (AmrCore* amr_core, int ispecies)
     : ParticleContainer<0,0,PIdx::nattribs>(amr_core->GetParGDB())
     , species_id(ispecies)
@@ -54,17 +88,125 @@ WarpXParticleContainer::WarpXParticleContainer (AmrCore* amr_core, int ispecies)
     particle_comps["theta"] = PIdx::theta;
 #endif
 
-    // Initialize temporary local arrays for charge/current deposition
-    int num_threads = 1;
+    // Initialize temporary local arrays for charge/current deposition, shared by all species
+    if (local_rho.empty()) {
+        int num_threads = 1;
 #ifdef AMREX_USE_OMP
 #pragma omp parallel
 #pragma omp single
-    num_threads = omp_get_num_threads();
+        num_threads = omp_get_num_threads();
 #endif
-    local_rho.resize(num_threads);
-    local_jx.resize(num_threads);
-    local_jy.resize(num_threads);
-    local_jz.resize(num_threads);
+        local_rho.resize(num_threads);
+        local_jx.resize(num_threads);
+        local_jy.resize(num_threads);
+        local_jz.resize(num_threads);
+        // their memory must be freed before AMReX is finalized
+        amrex::ExecOnFinalize(ClearDepositionBuffers);
+    }
+}
+
+void
+WarpXParticleContainer::ClearDepositionBuffers ()
+{
+    local_rho.clear();
+    local_jx.clear();
+    local_jy.clear();
+    local_jz.clear();
+}
+
+int
+WarpXParticleContainer::DepositionTileColors (int lev, std::map<std::pair<int,int>, int>& colors) const
+{
+    colors.clear();
+#ifdef AMREX_USE_GPU
+    amrex::ignore_unused(lev);
+    // no tiling: each box is deposited by a single kernel, directly into J and rho
+    return 1;
+#else
+    if (!do_colored_deposition) return 0;
+    if (!do_tiling || local_rho.size() == 1) return 1;
+
+    // The tiles of a color deposit in their cells and guard cells (plus one nodal point):
+    // those of two tiles of the same color must not overlap, so that the tile between them
+    // must be longer than twice the guard cells
+    WarpX& warpx = WarpX::GetInstance();
+    const IntVect ng = amrex::max(warpx.get_ng_depos_J(), warpx.get_ng_depos_rho());
+
+    // tiles of each box, as in WarpXParIter
+    std::map<int, std::vector<std::pair<int, Box>>> box_tiles;
+    for (MFIter mfi(ParticleBoxArray(lev), ParticleDistributionMap(lev),
+                    MFItInfo().EnableTiling(tile_size)); mfi.isValid(); ++mfi)
+    {
+        const Box& vbx = mfi.validbox();
+        const Box& tbx = mfi.tilebox();
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            // a tile with a neighbor in this direction
+            if (tbx.length(idim) < vbx.length(idim) && tbx.length(idim) <= 2*ng[idim]) return 0;
+        }
+        box_tiles[mfi.index()].emplace_back(mfi.LocalTileIndex(), tbx);
+    }
+
+    for (auto const& box : box_tiles)
+    {
+        // index of the tile in each direction, from the positions of the tiles of its box
+        std::array<std::set<int>, AMREX_SPACEDIM> starts;
+        for (auto const& tile : box.second) {
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                starts[idim].insert(tile.second.smallEnd(idim));
+            }
+        }
+        for (auto const& tile : box.second) {
+            int color = 0;
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                const auto& s = starts[idim];
+                const auto index = std::distance(s.begin(), s.find(tile.second.smallEnd(idim)));
+                color += static_cast<int>(index % 2) << idim;
+            }
+            colors[std::make_pair(box.first, tile.first)] = color;
+        }
+    }
+    return 1 << AMREX_SPACEDIM;
+#endif
+}
+
+void
+WarpXParticleContainer::DepositionTileDependencies (int lev,
+                                                    std::map<std::pair<int,int>, int> const& colors,
+                                                    std::map<std::pair<int,int>, int>& ids,
+                                                    amrex::Vector<amrex::Vector<int>>& deps) const
+{
+    ids.clear();
+    deps.clear();
+    if (colors.empty()) return;
+
+    // The tiles deposit in their cells and guard cells, plus one nodal point
+    WarpX& warpx = WarpX::GetInstance();
+    const IntVect ng = amrex::max(warpx.get_ng_depos_J(), warpx.get_ng_depos_rho()) + IntVect::TheUnitVector();
+
+    // tiles of each box, as in WarpXParIter, with their deposition region
+    std::map<int, std::vector<std::pair<std::pair<int,int>, Box>>> box_tiles;
+    for (MFIter mfi(ParticleBoxArray(lev), ParticleDistributionMap(lev),
+                    MFItInfo().EnableTiling(tile_size)); mfi.isValid(); ++mfi)
+    {
+        const auto key = std::make_pair(mfi.index(), mfi.LocalTileIndex());
+        const int id = static_cast<int>(ids.size());
+        ids[key] = id;
+        box_tiles[mfi.index()].emplace_back(key, amrex::grow(mfi.tilebox(), ng));
+    }
+
+    deps.resize(ids.size());
+    for (auto const& box : box_tiles)
+    {
+        for (auto const& tile : box.second) {
+            const int color = colors.at(tile.first);
+            auto& tile_deps = deps[ids.at(tile.first)];
+            for (auto const& other : box.second) {
+                if (colors.at(other.first) < color && tile.second.intersects(other.second)) {
+                    tile_deps.push_back(ids.at(other.first));
+                }
+            }
+        }
+    }
 }
 
 void
@@ -81,6 +223,12 @@ WarpXParticleContainer::ReadParameters ()
         do_tiling = true;
 #endif
         pp_particles.query("do_tiling", do_tiling);
+        pp_particles.query("soa_positions", do_soa_positions);
+        pp_particles.query("fuse_gather_push_deposit", do_fused_push_deposit);
+        pp_particles.query("colored_deposition", do_colored_deposition);
+        pp_particles.query("tile_dependencies", do_tile_dependencies);
+
+        ParticleTileCapacity::ReadParameters();
 
         initialized = true;
     }
@@ -141,15 +289,18 @@ WarpXParticleContainer::AddNParticles (int /*lev*/,
     Vector<ParticleReal> theta(np);
 #endif
 
+    // the ids of the new particles are reserved at once
+    Long pid = id;
+    int id_stride = 0;
+    if (id == -1 && np > 0) {
+        pid = do_not_assign_ids ? UnassignedParticleID : reserveParticleIDs<ParticleType>(np);
+        id_stride = do_not_assign_ids ? 0 : 1;
+    }
+
     for (int i = ibegin; i < iend; ++i)
     {
         ParticleType p;
-        if (id==-1)
-        {
-            p.id() = ParticleType::NextID();
-        } else {
-            p.id() = id;
-        }
+        p.id() = pid + id_stride*(i-ibegin);
         p.cpu() = ParallelDescriptor::MyProc();
 #if (AMREX_SPACEDIM == 3)
         p.pos(0) = x[i];
@@ -210,6 +361,87 @@ WarpXParticleContainer::AddNParticles (int /*lev*/,
     Redistribute();
 }
 
+void
+WarpXParticleContainer::AddNParticlesFromDevice (int /*lev*/, Long n,
+                                                 const ParticleReal* x, const ParticleReal* y,
+                                                 const ParticleReal* z, const ParticleReal* vx,
+                                                 const ParticleReal* vy, const ParticleReal* vz,
+                                                 int nattr, const ParticleReal* attr, int uniqueparticles)
+{
+    WARPX_PROFILE("WarpXParticleContainer::AddNParticlesFromDevice()");
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(nattr == 1,
+        "AddNParticlesFromDevice: the only attribute is the weight");
+
+    Long ibegin = 0;
+    Long np = n;
+    if (!uniqueparticles) {
+        const Long myproc = ParallelDescriptor::MyProc();
+        const Long nprocs = ParallelDescriptor::NProcs();
+        const Long navg = n/nprocs;
+        const Long nleft = n - navg*nprocs;
+        ibegin = myproc*navg + std::min(myproc, nleft);
+        np = navg + ((myproc < nleft) ? 1 : 0);
+    }
+
+    //  Add to grid 0 and tile 0
+    // Redistribute() will move them to proper places.
+    auto& particle_tile = DefineAndReturnParticleTile(0, 0, 0);
+    auto old_size = particle_tile.GetArrayOfStructs().size();
+    particle_tile.resize(old_size + np);
+
+    // the ids of the new particles are reserved at once
+    const Long pid = do_not_assign_ids ? UnassignedParticleID :
+        reserveParticleIDs<ParticleType>(np);
+    const int id_stride = do_not_assign_ids ? 0 : 1;
+    const int cpuid = ParallelDescriptor::MyProc();
+
+    ParticleType* pp = particle_tile.GetArrayOfStructs()().data() + old_size;
+    auto& soa = particle_tile.GetStructOfArrays();
+    GpuArray<ParticleReal*,PIdx::nattribs> pa;
+    for (int ia = 0; ia < PIdx::nattribs; ++ia) {
+        pa[ia] = soa.GetRealData(ia).data() + old_size;
+    }
+
+    amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (Long i) noexcept
+    {
+        const Long is = ibegin + i;
+        ParticleType& p = pp[i];
+        p.id() = pid + id_stride*i;
+        p.cpu() = cpuid;
+#if (AMREX_SPACEDIM == 3)
+        p.pos(0) = x[is];
+        p.pos(1) = y[is];
+        p.pos(2) = z[is];
+#elif defined(WARPX_DIM_RZ)
+        pa[PIdx::theta][i] = std::atan2(y[is], x[is]);
+        p.pos(0) = std::sqrt(x[is]*x[is] + y[is]*y[is]);
+        p.pos(1) = z[is];
+#else
+        amrex::ignore_unused(y);
+        p.pos(0) = x[is];
+        p.pos(1) = z[is];
+#endif
+        pa[PIdx::w ][i] = attr[is];
+        pa[PIdx::ux][i] = vx[is];
+        pa[PIdx::uy][i] = vy[is];
+        pa[PIdx::uz][i] = vz[is];
+    });
+
+    // The other attributes of the new particles are set to zero
+    for (int ic = PIdx::nattribs; ic < NumRealComps(); ++ic) {
+        ParticleReal* AMREX_RESTRICT data = soa.GetRealData(ic).data() + old_size;
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (Long i) noexcept { data[i] = 0._prt; });
+    }
+    for (int ic = 0; ic < NumIntComps(); ++ic) {
+        int* AMREX_RESTRICT data = soa.GetIntData(ic).data() + old_size;
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (Long i) noexcept { data[i] = 0; });
+    }
+    amrex::Gpu::synchronize();
+
+    Redistribute();
+}
+
 /* \brief Current Deposition for thread thread_num
  * \param pti         : Particle iterator
  * \param wp          : Array of particle weights
@@ -231,6 +463,9 @@ WarpXParticleContainer::AddNParticles (int /*lev*/,
  *                       a fraction of dt). When different than 0, the particle
  *                       position will be temporarily modified to match the
  *                       time of the deposition.
+ * \param pid         : If not null, indices of the particles of the tile, in the
+ *                      order given by PartitionParticlesInBuffers: the particles
+ *                      pid[offset,offset+np_to_depose] deposit current
  */
 void
 WarpXParticleContainer::DepositCurrent(WarpXParIter& pti,
@@ -240,7 +475,7 @@ WarpXParticleContainer::DepositCurrent(WarpXParIter& pti,
                                        MultiFab* jx, MultiFab* jy, MultiFab* jz,
                                        const long offset, const long np_to_depose,
                                        int thread_num, int lev, int depos_lev,
-                                       Real dt, Real relative_time)
+                                       Real dt, Real relative_time, const long* pid)
 {
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE((depos_lev==(lev-1)) ||
                                      (depos_lev==(lev  )),
@@ -252,6 +487,9 @@ WarpXParticleContainer::DepositCurrent(WarpXParIter& pti,
     // If user decides not to deposit
     if (do_not_deposit) return;
 
+    PhaseTimer timer(TimerPhase::Deposition);
+    HardwareCounterRegion counters("DepositCurrent");
+
     // Number of guard cells for local deposition of J
     WarpX& warpx = WarpX::GetInstance();
 
@@ -325,25 +563,33 @@ WarpXParticleContainer::DepositCurrent(WarpXParIter& pti,
     tby.grow(ng_J);
     tbz.grow(ng_J);
 
-    // CPU, tiling: j<xyz>_arr point to the local_j<xyz>[thread_num] arrays
-    local_jx[thread_num].resize(tbx, jx->nComp());
-    local_jy[thread_num].resize(tby, jy->nComp());
-    local_jz[thread_num].resize(tbz, jz->nComp());
-
-    // local_jx[thread_num] is set to zero
-    local_jx[thread_num].setVal(0.0);
-    local_jy[thread_num].setVal(0.0);
-    local_jz[thread_num].setVal(0.0);
-
-    auto & jx_fab = local_jx[thread_num];
-    auto & jy_fab = local_jy[thread_num];
-    auto & jz_fab = local_jz[thread_num];
-    Array4<Real> const& jx_arr = local_jx[thread_num].array();
-    Array4<Real> const& jy_arr = local_jy[thread_num].array();
-    Array4<Real> const& jz_arr = local_jz[thread_num].array();
+    // CPU, tiling: j<xyz>_arr point to the local_j<xyz>[thread_num] arrays, or to the full
+    // j<xyz> arrays when no other thread deposits around this tile (m_deposit_in_place)
+    const bool in_place = m_deposit_in_place && (lev == depos_lev);
+    if (!in_place) {
+        local_jx[thread_num].resize(tbx, jx->nComp());
+        local_jy[thread_num].resize(tby, jy->nComp());
+        local_jz[thread_num].resize(tbz, jz->nComp());
+
+        // local_jx[thread_num] is set to zero
+        local_jx[thread_num].setVal(0.0);
+        local_jy[thread_num].setVal(0.0);
+        local_jz[thread_num].setVal(0.0);
+    }
+
+    FArrayBox& jx_fab = in_place ? jx->get(pti) : local_jx[thread_num];
+    FArrayBox& jy_fab = in_place ? jy->get(pti) : local_jy[thread_num];
+    FArrayBox& jz_fab = in_place ? jz->get(pti) : local_jz[thread_num];
+    Array4<Real> const& jx_arr = jx_fab.array();
+    Array4<Real> const& jy_arr = jy_fab.array();
+    Array4<Real> const& jz_arr = jz_fab.array();
 #endif
 
-    const auto GetPosition = GetParticlePosition(pti, offset);
+    // With the particle indices pid, the particles that deposit are pid[offset:offset+np_to_depose]
+    const long p_offset = pid ? 0 : offset;
+    const long* const p_pid = pid ? pid + offset : nullptr;
+
+    const auto GetPosition = GetParticlePosition(pti, p_offset);
 
     // Lower corner of tile box physical domain
     // Note that this includes guard cells since it is after tilebox.ngrow
@@ -382,82 +628,107 @@ WarpXParticleContainer::DepositCurrent(WarpXParIter& pti,
     if (WarpX::current_deposition_algo == CurrentDepositionAlgo::Esirkepov) {
         if        (WarpX::nox == 1){
             doEsirkepovDepositionShapeN<1>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_arr, jy_arr, jz_arr, np_to_depose, dt, dx, xyzmin, lo, q,
                 WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         } else if (WarpX::nox == 2){
             doEsirkepovDepositionShapeN<2>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_arr, jy_arr, jz_arr, np_to_depose, dt, dx, xyzmin, lo, q,
                 WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         } else if (WarpX::nox == 3){
             doEsirkepovDepositionShapeN<3>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_arr, jy_arr, jz_arr, np_to_depose, dt, dx, xyzmin, lo, q,
                 WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         }
     } else if (WarpX::current_deposition_algo == CurrentDepositionAlgo::Vay) {
         if        (WarpX::nox == 1){
             doVayDepositionShapeN<1>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_fab, jy_fab, jz_fab, np_to_depose, dt, dx, xyzmin, lo, q,
                 WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         } else if (WarpX::nox == 2){
             doVayDepositionShapeN<2>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_fab, jy_fab, jz_fab, np_to_depose, dt, dx, xyzmin, lo, q,
                 WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         } else if (WarpX::nox == 3){
             doVayDepositionShapeN<3>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_fab, jy_fab, jz_fab, np_to_depose, dt, dx, xyzmin, lo, q,
                 WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
+        }
+    } else if (WarpX::current_deposition_algo == CurrentDepositionAlgo::DirectShared) {
+        if        (WarpX::nox == 1){
+            doDepositionSharedShapeN<1>(
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
+                jx_fab, jy_fab, jz_fab, np_to_depose, dt*relative_time, dx,
+                xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
+                WarpX::load_balance_costs_update_algo, tilebox, p_pid);
+        } else if (WarpX::nox == 2){
+            doDepositionSharedShapeN<2>(
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
+                jx_fab, jy_fab, jz_fab, np_to_depose, dt*relative_time, dx,
+                xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
+                WarpX::load_balance_costs_update_algo, tilebox, p_pid);
+        } else if (WarpX::nox == 3){
+            doDepositionSharedShapeN<3>(
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
+                jx_fab, jy_fab, jz_fab, np_to_depose, dt*relative_time, dx,
+                xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
+                WarpX::load_balance_costs_update_algo, tilebox, p_pid);
         }
     } else {
         if        (WarpX::nox == 1){
             doDepositionShapeN<1>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_fab, jy_fab, jz_fab, np_to_depose, dt*relative_time, dx,
                 xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         } else if (WarpX::nox == 2){
             doDepositionShapeN<2>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_fab, jy_fab, jz_fab, np_to_depose, dt*relative_time, dx,
                 xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         } else if (WarpX::nox == 3){
             doDepositionShapeN<3>(
-                GetPosition, wp.dataPtr() + offset, uxp.dataPtr() + offset,
-                uyp.dataPtr() + offset, uzp.dataPtr() + offset, ion_lev,
+                GetPosition, wp.dataPtr() + p_offset, uxp.dataPtr() + p_offset,
+                uyp.dataPtr() + p_offset, uzp.dataPtr() + p_offset, ion_lev,
                 jx_fab, jy_fab, jz_fab, np_to_depose, dt*relative_time, dx,
                 xyzmin, lo, q, WarpX::n_rz_azimuthal_modes, cost,
-                WarpX::load_balance_costs_update_algo);
+                WarpX::load_balance_costs_update_algo, p_pid);
         }
     }
     WARPX_PROFILE_VAR_STOP(blp_deposit);
 
 #ifndef AMREX_USE_GPU
     // CPU, tiling: atomicAdd local_j<xyz> into j<xyz>
-    WARPX_PROFILE_VAR_START(blp_accumulate);
-    (*jx)[pti].atomicAdd(local_jx[thread_num], tbx, tbx, 0, 0, jx->nComp());
-    (*jy)[pti].atomicAdd(local_jy[thread_num], tby, tby, 0, 0, jy->nComp());
-    (*jz)[pti].atomicAdd(local_jz[thread_num], tbz, tbz, 0, 0, jz->nComp());
-    WARPX_PROFILE_VAR_STOP(blp_accumulate);
+    if (!in_place) {
+        WARPX_PROFILE_VAR_START(blp_accumulate);
+        (*jx)[pti].atomicAdd(local_jx[thread_num], tbx, tbx, 0, 0, jx->nComp());
+        (*jy)[pti].atomicAdd(local_jy[thread_num], tby, tby, 0, 0, jy->nComp());
+        (*jz)[pti].atomicAdd(local_jz[thread_num], tbz, tbz, 0, 0, jz->nComp());
+        WARPX_PROFILE_VAR_STOP(blp_accumulate);
+    }
 #endif
 }
 
@@ -478,13 +749,17 @@ WarpXParticleContainer::DepositCurrent(WarpXParIter& pti,
  * \param thread_num  : Thread number (if tiling)
  * \param lev         : Level of box that contains particles
  * \param depos_lev   : Level on which particles deposit (if buffers are used)
+ * \param pid         : If not null, indices of the particles of the tile, in the
+ *                      order given by PartitionParticlesInBuffers: the particles
+ *                      pid[offset,offset+np_to_depose] deposit charge
  */
 void
 WarpXParticleContainer::DepositCharge (WarpXParIter& pti, RealVector& wp,
                                        const int * const ion_lev,
                                        amrex::MultiFab* rho, int icomp,
                                        const long offset, const long np_to_depose,
-                                       int thread_num, int lev, int depos_lev)
+                                       int thread_num, int lev, int depos_lev,
+                                       const long* pid)
 {
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE((depos_lev==(lev-1)) ||
                                      (depos_lev==(lev  )),
@@ -496,6 +771,8 @@ WarpXParticleContainer::DepositCharge (WarpXParIter& pti, RealVector& wp,
     // If user decides not to deposit
     if (do_not_deposit) return;
 
+    PhaseTimer timer(TimerPhase::Deposition);
+
     // Number of guard cells for local deposition of rho
     WarpX& warpx = WarpX::GetInstance();
     const amrex::IntVect& ng_rho = warpx.get_ng_depos_rho();
@@ -560,16 +837,27 @@ WarpXParticleContainer::DepositCharge (WarpXParIter& pti, RealVector& wp,
 #else
     tb.grow(ng_rho);
 
-    // CPU, tiling: rho_fab points to local_rho[thread_num]
-    local_rho[thread_num].resize(tb, nc);
+    // CPU, tiling: rho_fab points to local_rho[thread_num], or to the components icomp*nc
+    // of the full rho array when no other thread deposits around this tile (m_deposit_in_place)
+    const bool in_place = m_deposit_in_place && (lev == depos_lev);
+    FArrayBox rho_in_place;
+    if (in_place) {
+        rho_in_place = FArrayBox((*rho)[pti], amrex::make_alias, icomp*nc, nc);
+    } else {
+        local_rho[thread_num].resize(tb, nc);
 
-    // local_rho[thread_num] is set to zero
-    local_rho[thread_num].setVal(0.0);
+        // local_rho[thread_num] is set to zero
+        local_rho[thread_num].setVal(0.0);
+    }
 
-    auto & rho_fab = local_rho[thread_num];
+    auto & rho_fab = in_place ? rho_in_place : local_rho[thread_num];
 #endif
 
-    const auto GetPosition = GetParticlePosition(pti, offset);
+    // With the particle indices pid, the particles that deposit are pid[offset:offset+np_to_depose]
+    const long p_offset = pid ? 0 : offset;
+    const long* const p_pid = pid ? pid + offset : nullptr;
+
+    const auto GetPosition = GetParticlePosition(pti, p_offset);
 
     // Lower corner of tile box physical domain
     // Note that this includes guard cells since it is after tilebox.ngrow
@@ -601,28 +889,30 @@ WarpXParticleContainer::DepositCharge (WarpXParIter& pti, RealVector& wp,
     amrex::Real* cost = costs ? &((*costs)[pti.index()]) : nullptr;
 
     if        (WarpX::nox == 1){
-        doChargeDepositionShapeN<1>(GetPosition, wp.dataPtr()+offset, ion_lev,
+        doChargeDepositionShapeN<1>(GetPosition, wp.dataPtr()+p_offset, ion_lev,
                                     rho_fab, np_to_depose, dx, xyzmin, lo, q,
                                     WarpX::n_rz_azimuthal_modes, cost,
-                                    WarpX::load_balance_costs_update_algo);
+                                    WarpX::load_balance_costs_update_algo, p_pid);
     } else if (WarpX::nox == 2){
-        doChargeDepositionShapeN<2>(GetPosition, wp.dataPtr()+offset, ion_lev,
+        doChargeDepositionShapeN<2>(GetPosition, wp.dataPtr()+p_offset, ion_lev,
                                     rho_fab, np_to_depose, dx, xyzmin, lo, q,
                                     WarpX::n_rz_azimuthal_modes, cost,
-                                    WarpX::load_balance_costs_update_algo);
+                                    WarpX::load_balance_costs_update_algo, p_pid);
     } else if (WarpX::nox == 3){
-        doChargeDepositionShapeN<3>(GetPosition, wp.dataPtr()+offset, ion_lev,
+        doChargeDepositionShapeN<3>(GetPosition, wp.dataPtr()+p_offset, ion_lev,
                                     rho_fab, np_to_depose, dx, xyzmin, lo, q,
                                     WarpX::n_rz_azimuthal_modes, cost,
-                                    WarpX::load_balance_costs_update_algo);
+                                    WarpX::load_balance_costs_update_algo, p_pid);
     }
     WARPX_PROFILE_VAR_STOP(blp_ppc_chd);
 
 #ifndef AMREX_USE_GPU
     // CPU, tiling: atomicAdd local_rho into rho
-    WARPX_PROFILE_VAR_START(blp_accumulate);
-    (*rho)[pti].atomicAdd(local_rho[thread_num], tb, tb, 0, icomp*nc, nc);
-    WARPX_PROFILE_VAR_STOP(blp_accumulate);
+    if (!in_place) {
+        WARPX_PROFILE_VAR_START(blp_accumulate);
+        (*rho)[pti].atomicAdd(local_rho[thread_num], tb, tb, 0, icomp*nc, nc);
+        WARPX_PROFILE_VAR_STOP(blp_accumulate);
+    }
 #endif
 }
 
@@ -696,9 +986,8 @@ WarpXParticleContainer::DepositCharge (amrex::Vector<std::unique_ptr<amrex::Mult
 }
 
 std::unique_ptr<MultiFab>
-WarpXParticleContainer::GetChargeDensity (int lev, bool local)
+WarpXParticleContainer::MakeChargeDensity (int lev) const
 {
-    const auto& gm = m_gdb->Geom(lev);
     const auto& ba = m_gdb->ParticleBoxArray(lev);
     const auto& dm = m_gdb->DistributionMap(lev);
     BoxArray nba = ba;
@@ -715,9 +1004,12 @@ WarpXParticleContainer::GetChargeDensity (int lev, bool local)
     WarpX& warpx = WarpX::GetInstance();
     const int ng_rho = warpx.get_ng_depos_rho().max();
 
-    auto rho = std::make_unique<MultiFab>(nba,dm,WarpX::ncomps,ng_rho);
-    rho->setVal(0.0);
+    return std::make_unique<MultiFab>(nba,dm,WarpX::ncomps,ng_rho);
+}
 
+void
+WarpXParticleContainer::AddChargeDensity (MultiFab& rho, int lev)
+{
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
     {
@@ -740,12 +1032,23 @@ WarpXParticleContainer::GetChargeDensity (int lev, bool local)
                 ion_lev = nullptr;
             }
 
-            DepositCharge(pti, wp, ion_lev, rho.get(), 0, 0, np,
+            DepositCharge(pti, wp, ion_lev, &rho, 0, 0, np,
                           thread_num, lev, lev);
         }
 #ifdef AMREX_USE_OMP
     }
 #endif
+}
+
+std::unique_ptr<MultiFab>
+WarpXParticleContainer::GetChargeDensity (int lev, bool local)
+{
+    const auto& gm = m_gdb->Geom(lev);
+
+    auto rho = MakeChargeDensity(lev);
+    rho->setVal(0.0);
+
+    AddChargeDensity(*rho, lev);
 
 #ifdef WARPX_DIM_RZ
     WarpX::GetInstance().ApplyInverseVolumeScalingToChargeDensity(rho.get(), lev);
@@ -920,11 +1223,7 @@ WarpXParticleContainer::PushX (int lev, amrex::Real dt)
 
         for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
         {
-            if (costs && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-            }
-            Real wt = amrex::second();
+            BoxCostTimer box_timer(costs, pti.index());
 
             //
             // Particle Push
@@ -949,12 +1248,7 @@ WarpXParticleContainer::PushX (int lev, amrex::Real dt)
                 }
             );
 
-            if (costs && WarpX::load_balance_costs_update_algo == LoadBalanceCostsUpdateAlgo::Timers)
-            {
-                amrex::Gpu::synchronize();
-                wt = amrex::second() - wt;
-                amrex::HostDevice::Atomic::Add( &(*costs)[pti.index()], wt);
-            }
+            box_timer.stop();
         }
     }
 }
@@ -1004,8 +1298,13 @@ WarpXParticleContainer::particlePostLocate(ParticleType& p,
 void
 WarpXParticleContainer::ApplyBoundaryConditions (ParticleBC boundary_conditions){
     WARPX_PROFILE("WarpXParticleContainer::ApplyBoundaryConditions()");
+    if (boundary_conditions != ParticleBC::absorbing) return;
+
     for (int lev = 0; lev <= finestLevel(); ++lev)
     {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
+#endif
         for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
         {
             auto GetPosition = GetParticlePosition(pti);
@@ -1030,15 +1329,296 @@ WarpXParticleContainer::ApplyBoundaryConditions (ParticleBC boundary_conditions)
                     GetPosition(i, x, y, z);
 #ifdef WARPX_DIM_3D
                     if (x < xmin || x > xmax || y < ymin || y > ymax || z < zmin || z > zmax){
-                        if (boundary_conditions == ParticleBC::absorbing) p.id() = -1;
+                        p.id() = -1;
                     }
 #else
                     if (x < xmin || x > xmax || z < zmin || z > zmax){
-                        if (boundary_conditions == ParticleBC::absorbing) p.id() = -1;
+                        p.id() = -1;
                     }
 #endif
                 }
             );
+
+            // Remove the absorbed particles (and the other invalid ones) from the tile now,
+            // rather than at the next Redistribute
+            ParticleUtils::removeInvalidParticles(ptile);
+        }
+    }
+}
+
+void
+WarpXParticleContainer::SortParticlesByBin (amrex::IntVect bin_size)
+{
+    WARPX_PROFILE("WarpXParticleContainer::SortParticlesByBin()");
+
+    if (bin_size == IntVect::TheZeroVector()) return;
+    const auto bs = bin_size.dim3();
+
+    for (int lev = 0; lev <= finestLevel(); ++lev)
+    {
+        const auto dxi = Geom(lev).InvCellSizeArray();
+        const auto plo = Geom(lev).ProbLoArray();
+
+        for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+        {
+            ParticleTileType& ptile = ParticlesAt(lev, pti);
+            const int np = ptile.numParticles();
+            if (np < 2) continue;
+            ParticleType const* particle_ptr = ptile.GetArrayOfStructs()().data();
+
+            // Bins of bin_size cells, covering the cells of the tile
+            Box const& cbx = pti.tilebox(IntVect::TheZeroVector());
+            const auto lo = lbound(cbx);
+            Box const bin_box(IntVect::TheZeroVector(), (cbx.length() - 1) / bin_size);
+            auto const get_bin = [=] AMREX_GPU_HOST_DEVICE (const ParticleType& p) noexcept -> IntVect
+            {
+                return IntVect(AMREX_D_DECL(
+                                   static_cast<int>((p.pos(0)-plo[0])*dxi[0] - lo.x) / bs.x,
+                                   static_cast<int>((p.pos(1)-plo[1])*dxi[1] - lo.y) / bs.y,
+                                   static_cast<int>((p.pos(2)-plo[2])*dxi[2] - lo.z) / bs.z));
+            };
+
+            // Count the particles that are in a lower bin than the previous particle
+            ReduceOps<ReduceOpSum> reduce_op;
+            ReduceData<int> reduce_data(reduce_op);
+            using ReduceTuple = typename decltype(reduce_data)::Type;
+            reduce_op.eval(np-1, reduce_data,
+                           [=] AMREX_GPU_DEVICE (int i) -> ReduceTuple
+                           {
+                               return {bin_box.index(get_bin(particle_ptr[i+1])) <
+                                       bin_box.index(get_bin(particle_ptr[i])) ? 1 : 0};
+                           });
+            if (amrex::get<0>(reduce_data.value()) == 0) continue;
+
+            DenseBins<ParticleType> bins;
+            bins.build(np, particle_ptr, bin_box, get_bin);
+            ReorderParticles(lev, pti, bins.permutationPtr());
+        }
+    }
+}
+
+void
+WarpXParticleContainer::InitSoAPositions (int lev)
+{
+    if (!do_soa_positions) return;
+
+    m_soa_positions.resize(finestLevel()+1);
+    for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+    {
+        auto& tile = m_soa_positions[lev][pti.GetPairIndex()];
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) tile.pos[idim].resize(pti.numParticles());
+        tile.valid = false;
+    }
+}
+
+void
+WarpXParticleContainer::CopyPositionsToSoA (WarpXParIter& pti)
+{
+    const int lev = pti.GetLevel();
+    if (lev >= static_cast<int>(m_soa_positions.size())) return;
+    auto it = m_soa_positions[lev].find(pti.GetPairIndex());
+    if (it == m_soa_positions[lev].end()) return;
+    auto& tile = it->second;
+    const long np = pti.numParticles();
+    if (static_cast<long>(tile.pos[0].size()) != np) return;
+
+    ParticleType const* AMREX_RESTRICT pp = pti.GetArrayOfStructs()().dataPtr();
+    AMREX_D_TERM(ParticleReal* AMREX_RESTRICT xp = tile.pos[0].dataPtr();,
+                 ParticleReal* AMREX_RESTRICT yp = tile.pos[1].dataPtr();,
+                 ParticleReal* AMREX_RESTRICT zp = tile.pos[2].dataPtr();)
+    amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (long i) noexcept
+    {
+        AMREX_D_TERM(xp[i] = pp[i].pos(0);,
+                     yp[i] = pp[i].pos(1);,
+                     zp[i] = pp[i].pos(2);)
+    });
+    tile.valid = true;
+}
+
+void
+WarpXParticleContainer::InvalidateSoAPositions (int lev)
+{
+    if (lev >= static_cast<int>(m_soa_positions.size())) return;
+    for (auto& tile : m_soa_positions[lev]) tile.second.valid = false;
+}
+
+amrex::ParticleReal*
+WarpXParticleContainer::GetSoAPosition (int lev, std::pair<int,int> const& index,
+                                        long np, int dim)
+{
+    if (lev >= static_cast<int>(m_soa_positions.size())) return nullptr;
+    auto it = m_soa_positions[lev].find(index);
+    if (it == m_soa_positions[lev].end() || !it->second.valid) return nullptr;
+    auto& pos = it->second.pos[dim];
+    // particles were added or removed since the copy
+    if (static_cast<long>(pos.size()) != np) return nullptr;
+    return pos.dataPtr();
+}
+
+#ifdef WARPX_QED
+void
+WarpXParticleContainer::ResetQEDEventLists (int lev)
+{
+    if (!DoQED()) return;
+
+    m_qed_event_lists.resize(finestLevel()+1);
+    for (auto& list : m_qed_event_lists[lev]) list.second.np = -1;
+    for (WarpXParIter pti(*this, lev); pti.isValid(); ++pti)
+    {
+        auto& list = m_qed_event_lists[lev][pti.GetPairIndex()];
+        const long np = pti.numParticles();
+        list.idx.resize(np);
+        list.count.resize(1);
+        int* p_count = list.count.dataPtr();
+        amrex::ParallelFor(1, [=] AMREX_GPU_DEVICE (int) noexcept { *p_count = 0; });
+        list.np = np;
+    }
+}
+
+QEDEventListView
+WarpXParticleContainer::GetQEDEventListView (WarpXParIter& pti)
+{
+    const int lev = pti.GetLevel();
+    if (lev >= static_cast<int>(m_qed_event_lists.size())) return QEDEventListView{};
+    auto it = m_qed_event_lists[lev].find(pti.GetPairIndex());
+    if (it == m_qed_event_lists[lev].end() || it->second.np != pti.numParticles()) {
+        return QEDEventListView{};
+    }
+    return it->second.getView();
+}
+
+int
+WarpXParticleContainer::TakeQEDEvents (int lev, std::pair<int,int> const& index, long np,
+                                       int const*& idx)
+{
+    idx = nullptr;
+    if (lev >= static_cast<int>(m_qed_event_lists.size())) return -1;
+    auto it = m_qed_event_lists[lev].find(index);
+    if (it == m_qed_event_lists[lev].end()) return -1;
+    auto& list = it->second;
+    // particles were added or removed since the push
+    if (list.np != np) return -1;
+    list.np = -1;
+
+    int count = 0;
+    amrex::Gpu::dtoh_memcpy(&count, list.count.dataPtr(), sizeof(int));
+    if (count > static_cast<int>(list.idx.size())) return -1;
+    idx = list.idx.dataPtr();
+    return count;
+}
+#endif
+
+amrex::Long
+WarpXParticleContainer::MemoryBytes () const
+{
+    amrex::Long nbytes = 0;
+    for (int lev = 0; lev <= finestLevel(); ++lev) {
+        for (auto const& kv : GetParticles(lev)) {
+            auto const& ptile = kv.second;
+            nbytes += ptile.GetArrayOfStructs()().capacity()*sizeof(ParticleType);
+            auto const& soa = ptile.GetStructOfArrays();
+            for (int i = 0; i < NumRealComps(); ++i) {
+                nbytes += soa.GetRealData(i).capacity()*sizeof(ParticleReal);
+            }
+            for (int i = 0; i < NumIntComps(); ++i) {
+                nbytes += soa.GetIntData(i).capacity()*sizeof(int);
+            }
+        }
+        if (lev < static_cast<int>(tmp_particle_data.size())) {
+            for (auto const& kv : tmp_particle_data[lev]) {
+                for (auto const& v : kv.second) nbytes += v.capacity()*sizeof(ParticleReal);
+            }
         }
+        if (lev < static_cast<int>(m_soa_positions.size())) {
+            for (auto const& kv : m_soa_positions[lev]) {
+                for (auto const& v : kv.second.pos) nbytes += v.capacity()*sizeof(ParticleReal);
+            }
+        }
+    }
+    return nbytes;
+}
+
+void
+WarpXParticleContainer::ShrinkParticleTiles ()
+{
+    WARPX_PROFILE("WarpXParticleContainer::ShrinkParticleTiles()");
+    for (int lev = 0; lev <= finestLevel(); ++lev) {
+        for (auto& kv : GetParticles(lev)) {
+            shrinkParticleTile(kv.second);
+        }
+    }
+}
+
+void
+WarpXParticleContainer::PrintMemoryUsage (const std::string& name) const
+{
+    // Bytes allocated for the particle structs, the components and the temporary data
+    amrex::Long nparticles = 0;
+    amrex::Long aos_bytes = 0;
+    amrex::Vector<amrex::Long> real_bytes(NumRealComps(), 0);
+    amrex::Vector<amrex::Long> int_bytes(NumIntComps(), 0);
+    amrex::Long tmp_bytes = 0;
+    amrex::Long soa_pos_bytes = 0;
+
+    for (int lev = 0; lev <= finestLevel(); ++lev) {
+        for (auto const& kv : GetParticles(lev)) {
+            auto const& ptile = kv.second;
+            nparticles += ptile.numParticles();
+            aos_bytes += ptile.GetArrayOfStructs()().capacity()*sizeof(ParticleType);
+            auto const& soa = ptile.GetStructOfArrays();
+            for (int i = 0; i < NumRealComps(); ++i) {
+                real_bytes[i] += soa.GetRealData(i).capacity()*sizeof(ParticleReal);
+            }
+            for (int i = 0; i < NumIntComps(); ++i) {
+                int_bytes[i] += soa.GetIntData(i).capacity()*sizeof(int);
+            }
+        }
+        if (lev < static_cast<int>(tmp_particle_data.size())) {
+            for (auto const& kv : tmp_particle_data[lev]) {
+                for (auto const& v : kv.second) tmp_bytes += v.capacity()*sizeof(ParticleReal);
+            }
+        }
+        if (lev < static_cast<int>(m_soa_positions.size())) {
+            for (auto const& kv : m_soa_positions[lev]) {
+                for (auto const& v : kv.second.pos) soa_pos_bytes += v.capacity()*sizeof(ParticleReal);
+            }
+        }
+    }
+
+    ParallelDescriptor::ReduceLongSum(nparticles);
+    ParallelDescriptor::ReduceLongSum(aos_bytes);
+    ParallelDescriptor::ReduceLongSum(real_bytes.dataPtr(), real_bytes.size());
+    ParallelDescriptor::ReduceLongSum(int_bytes.dataPtr(), int_bytes.size());
+    ParallelDescriptor::ReduceLongSum(tmp_bytes);
+    ParallelDescriptor::ReduceLongSum(soa_pos_bytes);
+
+    // Names of the components, ordered by index
+    amrex::Vector<std::string> real_names(NumRealComps(), "?");
+    amrex::Vector<std::string> int_names(NumIntComps(), "?");
+    for (auto const& kv : particle_comps) {
+        if (kv.second < NumRealComps()) real_names[kv.second] = kv.first;
+    }
+    for (auto const& kv : particle_icomps) {
+        if (kv.second < NumIntComps()) int_names[kv.second] = kv.first;
+    }
+
+    constexpr amrex::Real MB = 1024._rt*1024._rt;
+    amrex::Long total = aos_bytes + tmp_bytes + soa_pos_bytes;
+    amrex::Print() << "Particle memory of species " << name << " (" << nparticles << " particles):\n"
+                   << "    particle structs: " << aos_bytes/MB << " MB\n";
+    for (int i = 0; i < NumRealComps(); ++i) {
+        amrex::Print() << "    " << real_names[i] << ": " << real_bytes[i]/MB << " MB\n";
+        total += real_bytes[i];
+    }
+    for (int i = 0; i < NumIntComps(); ++i) {
+        amrex::Print() << "    " << int_names[i] << ": " << int_bytes[i]/MB << " MB\n";
+        total += int_bytes[i];
+    }
+    if (tmp_bytes > 0) {
+        amrex::Print() << "    back-transformed diagnostics copies: " << tmp_bytes/MB << " MB\n";
+    }
+    if (soa_pos_bytes > 0) {
+        amrex::Print() << "    SoA positions: " << soa_pos_bytes/MB << " MB\n";
     }
+    amrex::Print() << "    total: " << total/MB << " MB\n";
 }
@@ -15,69 +15,83 @@
 
 #include <AMReX.H>
 #include <AMReX_BLProfiler.H>
+#include <AMReX_Gpu.H>
+#include <AMReX_Vector.H>
 
+#include <algorithm>
+#include <array>
 
 namespace
 {
+    // The descriptors of the arrays returned to Python (data pointers,
+    // shapes, lo vectors, ...) are kept in these buffers, reused from call to
+    // call instead of being allocated each time. They stay valid until the
+    // next call of the same kind, and must not be freed by the caller.
+    amrex::Vector<amrex::Real*> field_pointers;
+    amrex::Vector<int> field_shapes;
+    amrex::Vector<int> field_lovects;
+    std::array<int, AMREX_SPACEDIM> field_ngrowvect;
+    std::array<int, AMREX_SPACEDIM> nodal_flag_data;
+    amrex::Vector<amrex::ParticleReal*> particle_pointers;
+    amrex::Vector<int> particles_per_tile_data;
+
     amrex::Real** getMultiFabPointers(const amrex::MultiFab& mf, int *num_boxes, int *ncomps, int **ngrowvect, int **shapes)
     {
         *ncomps = mf.nComp();
         *num_boxes = mf.local_size();
         int shapesize = AMREX_SPACEDIM;
-        *ngrowvect = static_cast<int*>(malloc(sizeof(int)*shapesize));
         for (int j = 0; j < AMREX_SPACEDIM; ++j) {
-            (*ngrowvect)[j] = mf.nGrow(j);
+            field_ngrowvect[j] = mf.nGrow(j);
         }
+        *ngrowvect = field_ngrowvect.data();
         if (mf.nComp() > 1) shapesize += 1;
-        *shapes = static_cast<int*>(malloc(sizeof(int)*shapesize * (*num_boxes)));
-        auto data =
-            static_cast<amrex::Real**>(malloc((*num_boxes) * sizeof(amrex::Real*)));
+        field_shapes.resize(shapesize * (*num_boxes));
+        field_pointers.resize(*num_boxes);
 
-#ifdef AMREX_USE_OMP
-#pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
-#endif
         for ( amrex::MFIter mfi(mf, false); mfi.isValid(); ++mfi ) {
             int i = mfi.LocalIndex();
-            data[i] = (amrex::Real*) mf[mfi].dataPtr();
+            field_pointers[i] = (amrex::Real*) mf[mfi].dataPtr();
             for (int j = 0; j < AMREX_SPACEDIM; ++j) {
-                (*shapes)[shapesize*i+j] = mf[mfi].box().length(j);
+                field_shapes[shapesize*i+j] = mf[mfi].box().length(j);
             }
-            if (mf.nComp() > 1) (*shapes)[shapesize*i+AMREX_SPACEDIM] = mf.nComp();
+            if (mf.nComp() > 1) field_shapes[shapesize*i+AMREX_SPACEDIM] = mf.nComp();
         }
-        return data;
+        *shapes = field_shapes.data();
+        // The arrays may be read or modified in place from Python, on the
+        // host or on the device (see pywarpx._libwarpx.use_device_arrays)
+        amrex::Gpu::streamSynchronize();
+        return field_pointers.data();
     }
     int* getMultiFabLoVects(const amrex::MultiFab& mf, int *num_boxes, int **ngrowvect)
     {
-        int shapesize = AMREX_SPACEDIM;
-        *ngrowvect = static_cast<int*>(malloc(sizeof(int)*shapesize));
         for (int j = 0; j < AMREX_SPACEDIM; ++j) {
-            (*ngrowvect)[j] = mf.nGrow(j);
+            field_ngrowvect[j] = mf.nGrow(j);
         }
+        *ngrowvect = field_ngrowvect.data();
         *num_boxes = mf.local_size();
-        int *loVects = (int*) malloc((*num_boxes)*AMREX_SPACEDIM * sizeof(int));
+        field_lovects.resize((*num_boxes)*AMREX_SPACEDIM);
 
         int i = 0;
         for ( amrex::MFIter mfi(mf, false); mfi.isValid(); ++mfi, ++i ) {
             const int* loVect = mf[mfi].loVect();
             for (int j = 0; j < AMREX_SPACEDIM; ++j) {
-                loVects[AMREX_SPACEDIM*i+j] = loVect[j];
+                field_lovects[AMREX_SPACEDIM*i+j] = loVect[j];
             }
         }
-        return loVects;
+        return field_lovects.data();
     }
     // Copy the nodal flag data and return the copy:
     // the nodal flag data should not be modifiable from Python.
     int* getFieldNodalFlagData ( const amrex::MultiFab& mf )
     {
         const amrex::IntVect nodal_flag( mf.ixType().toIntVect() );
-        int *nodal_flag_data = (int*) malloc(AMREX_SPACEDIM * sizeof(int));
 
         constexpr int NODE = amrex::IndexType::NODE;
 
         for (int i=0 ; i < AMREX_SPACEDIM ; i++) {
             nodal_flag_data[i] = (nodal_flag[i] == NODE ? 1 : 0);
         }
-        return nodal_flag_data;
+        return nodal_flag_data.data();
     }
 }
 
@@ -120,6 +134,15 @@ extern "C"
         return AMREX_SPACEDIM;
     }
 
+    int warpx_use_gpu()
+    {
+#ifdef AMREX_USE_GPU
+        return 1;
+#else
+        return 0;
+#endif
+    }
+
     void amrex_init (int argc, char* argv[])
     {
         warpx_amrex_init(argc, argv);
@@ -205,6 +228,22 @@ extern "C"
         warpx.Evolve(numsteps);
     }
 
+    void warpx_evolve_batched (int numsteps, int callback_interval,
+                               WARPX_CALLBACK_PY_FUNC_0 callback)
+    {
+        WarpX& warpx = WarpX::GetInstance();
+        const int interval = std::max(callback_interval, 1);
+        const int step_end = (numsteps < 0) ? warpx.maxStep() :
+            std::min(warpx.getistep(0) + numsteps, warpx.maxStep());
+        while (warpx.getistep(0) < step_end && warpx.gett_new(0) < warpx.stopTime()) {
+            const int step_begin = warpx.getistep(0);
+            warpx.Evolve(std::min(interval, step_end - step_begin));
+            // stop if no step was taken
+            if (warpx.getistep(0) == step_begin) break;
+            if (callback) callback();
+        }
+    }
+
     void warpx_addNParticles(int speciesnumber, int lenx,
                              amrex::ParticleReal const * x, amrex::ParticleReal const * y, amrex::ParticleReal const * z,
                              amrex::ParticleReal const * vx, amrex::ParticleReal const * vy, amrex::ParticleReal const * vz,
@@ -216,6 +255,17 @@ extern "C"
         myspc.AddNParticles(lev, lenx, x, y, z, vx, vy, vz, nattr, attr, uniqueparticles);
     }
 
+    void warpx_addNParticlesFromDevice(int speciesnumber, long lenx,
+                                       amrex::ParticleReal const * x, amrex::ParticleReal const * y, amrex::ParticleReal const * z,
+                                       amrex::ParticleReal const * vx, amrex::ParticleReal const * vy, amrex::ParticleReal const * vz,
+                                       int nattr, amrex::ParticleReal const * attr, int uniqueparticles)
+    {
+        auto & mypc = WarpX::GetInstance().GetPartContainer();
+        auto & myspc = mypc.GetParticleContainer(speciesnumber);
+        const int lev = 0;
+        myspc.AddNParticlesFromDevice(lev, lenx, x, y, z, vx, vy, vz, nattr, attr, uniqueparticles);
+    }
+
     void warpx_ConvertLabParamsToBoost()
     {
       ConvertLabParamsToBoost();
@@ -324,7 +374,7 @@ extern "C"
     amrex::Real** FIELD(int lev, int direction, \
                         int *return_size, int *ncomps, int **ngrowvect, int **shapes) { \
         auto * pml = WarpX::GetInstance().GetPML(lev); \
-        if (pml) { \
+        if (pml && pml->GETTER()[direction]) { \
             auto & mf = *(pml->GETTER()[direction]); \
             return getMultiFabPointers(mf, return_size, ncomps, ngrowvect, shapes); \
         } else { \
@@ -336,7 +386,7 @@ extern "C"
     int* FIELD(int lev, int direction, \
                int *return_size, int **ngrowvect) { \
         auto * pml = WarpX::GetInstance().GetPML(lev); \
-        if (pml) { \
+        if (pml && pml->GETTER()[direction]) { \
             auto & mf = *(pml->GETTER()[direction]); \
             return getMultiFabLoVects(mf, return_size, ngrowvect); \
         } else { \
@@ -362,21 +412,17 @@ extern "C"
         const auto & mypc = WarpX::GetInstance().GetPartContainer();
         auto & myspc = mypc.GetParticleContainer(speciesnumber);
 
-        int i = 0;
-        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti, ++i) {}
-
-        // *num_tiles = myspc.numLocalTilesAtLevel(lev);
-        *num_tiles = i;
-        *particles_per_tile = (int*) malloc(*num_tiles*sizeof(int));
-
-        amrex::ParticleReal** data = (amrex::ParticleReal**) malloc(*num_tiles*sizeof(typename WarpXParticleContainer::ParticleType*));
-        i = 0;
-        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti, ++i) {
+        particle_pointers.clear();
+        particles_per_tile_data.clear();
+        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti) {
             auto& aos = pti.GetArrayOfStructs();
-            data[i] = (amrex::ParticleReal*) aos.data();
-            (*particles_per_tile)[i] = pti.numParticles();
+            particle_pointers.push_back((amrex::ParticleReal*) aos.data());
+            particles_per_tile_data.push_back(pti.numParticles());
         }
-        return data;
+        *num_tiles = particle_pointers.size();
+        *particles_per_tile = particles_per_tile_data.data();
+        amrex::Gpu::streamSynchronize();
+        return particle_pointers.data();
     }
 
     amrex::ParticleReal** warpx_getParticleArrays(int speciesnumber, int comp, int lev,
@@ -384,21 +430,17 @@ extern "C"
         const auto & mypc = WarpX::GetInstance().GetPartContainer();
         auto & myspc = mypc.GetParticleContainer(speciesnumber);
 
-        int i = 0;
-        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti, ++i) {}
-
-        // *num_tiles = myspc.numLocalTilesAtLevel(lev);
-        *num_tiles = i;
-        *particles_per_tile = (int*) malloc(*num_tiles*sizeof(int));
-
-        amrex::ParticleReal** data = (amrex::ParticleReal**) malloc(*num_tiles*sizeof(amrex::ParticleReal*));
-        i = 0;
-        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti, ++i) {
+        particle_pointers.clear();
+        particles_per_tile_data.clear();
+        for (WarpXParIter pti(myspc, lev); pti.isValid(); ++pti) {
             auto& soa = pti.GetStructOfArrays();
-            data[i] = (amrex::ParticleReal*) soa.GetRealData(comp).dataPtr();
-            (*particles_per_tile)[i] = pti.numParticles();
+            particle_pointers.push_back((amrex::ParticleReal*) soa.GetRealData(comp).dataPtr());
+            particles_per_tile_data.push_back(pti.numParticles());
         }
-        return data;
+        *num_tiles = particle_pointers.size();
+        *particles_per_tile = particles_per_tile_data.data();
+        amrex::Gpu::streamSynchronize();
+        return particle_pointers.data();
     }
 
     void warpx_ComputeDt () {
@@ -35,6 +35,8 @@ extern "C" {
 
     int warpx_SpaceDim();
 
+    int warpx_use_gpu();
+
     void amrex_init (int argc, char* argv[]);
 
 #ifdef BL_USE_MPI
@@ -62,8 +64,29 @@ extern "C" {
     void warpx_set_callback_py_particleinjection (WARPX_CALLBACK_PY_FUNC_0);
     void warpx_set_callback_py_appliedfields (WARPX_CALLBACK_PY_FUNC_0);
 
+    /* Restrict the Python callback name (e.g. "afterstep") to the steps in
+     * intervals (IntervalsParser syntax), every step if intervals is empty.
+     * Returns 0 if name is unknown. */
+    int warpx_set_callback_py_intervals (const char* name, const char* intervals);
+
+    /* Native hook, called with the number of the current step */
+    typedef void(*WARPX_CALLBACK_NATIVE)(int step);
+    typedef int(*WARPX_ADD_CALLBACK)(const char*, WARPX_CALLBACK_NATIVE, const char*);
+
+    /* Install the native hook callback at the callback point name, called at
+     * the steps in intervals (every step if null or empty). This is passed to
+     * the function warpx_plugin_init of the plugins (warpx.plugins).
+     * Returns 0 if name is unknown. */
+    int warpx_add_callback (const char* name, WARPX_CALLBACK_NATIVE callback,
+                            const char* intervals);
+
     void warpx_evolve (int numsteps);  // -1 means the inputs parameter will be used.
 
+    /* Evolve numsteps steps (-1 for the inputs parameter), by batches of
+     * callback_interval steps, calling callback (if not null) after each batch */
+    void warpx_evolve_batched (int numsteps, int callback_interval,
+                               WARPX_CALLBACK_PY_FUNC_0 callback);
+
     void warpx_addNParticles(int speciesnumber,
                              int lenx,
                              amrex::ParticleReal const * x,
@@ -76,6 +99,19 @@ extern "C" {
                              amrex::ParticleReal const * attr,
                              int uniqueparticles);
 
+    /* Same as warpx_addNParticles, with arrays in device memory */
+    void warpx_addNParticlesFromDevice(int speciesnumber,
+                                       long lenx,
+                                       amrex::ParticleReal const * x,
+                                       amrex::ParticleReal const * y,
+                                       amrex::ParticleReal const * z,
+                                       amrex::ParticleReal const * vx,
+                                       amrex::ParticleReal const * vy,
+                                       amrex::ParticleReal const * vz,
+                                       int nattr,
+                                       amrex::ParticleReal const * attr,
+                                       int uniqueparticles);
+
     void warpx_ConvertLabParamsToBoost();
 
     void warpx_CheckGriddingForRZSpectral();
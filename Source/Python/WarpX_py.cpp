@@ -6,6 +6,20 @@
  * License: BSD-3-Clause-LBNL
  */
 #include "WarpX_py.H"
+#include "Utils/IntervalsParser.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#if defined(__unix__) || defined(__APPLE__)
+#   include <dlfcn.h>
+#endif
+
+#include <array>
+#include <string>
+#include <vector>
 
 
 extern "C" {
@@ -25,3 +39,130 @@ extern "C" {
 
 }
 
+
+namespace
+{
+    constexpr int ncallbacks = static_cast<int>(CallbackPoint::count);
+
+    /** Names of the callback points, in the order of CallbackPoint */
+    const std::array<std::string, ncallbacks> callback_names {{
+        "afterinit", "beforeEsolve", "afterEsolve", "beforedeposition", "afterdeposition",
+        "particlescraper", "particleloader", "beforestep", "afterstep", "afterrestart",
+        "particleinjection", "appliedfields"}};
+
+    /** Python callbacks, in the order of CallbackPoint */
+    const std::array<WARPX_CALLBACK_PY_FUNC_0*, ncallbacks> py_callbacks {{
+        &warpx_py_afterinit, &warpx_py_beforeEsolve, &warpx_py_afterEsolve,
+        &warpx_py_beforedeposition, &warpx_py_afterdeposition, &warpx_py_particlescraper,
+        &warpx_py_particleloader, &warpx_py_beforestep, &warpx_py_afterstep,
+        &warpx_py_afterrestart, &warpx_py_particleinjection, &warpx_py_appliedfields}};
+
+    /** Native hook and the steps at which it is called */
+    struct NativeCallback
+    {
+        WARPX_CALLBACK_NATIVE func;
+        IntervalsParser intervals;
+    };
+
+    /** What is called at a callback point */
+    struct CallbackSchedule
+    {
+        /** Steps at which the Python callback is called, if restricted */
+        bool has_py_intervals = false;
+        IntervalsParser py_intervals;
+        std::vector<NativeCallback> native;
+    };
+
+    std::array<CallbackSchedule, ncallbacks> callback_schedules;
+
+    /** Number of callbacks executed so far */
+    long num_callbacks_executed = 0;
+
+    /** Index of the callback point name, -1 if unknown */
+    int CallbackIndex (const char* name)
+    {
+        for (int i = 0; i < ncallbacks; ++i) {
+            if (callback_names[i] == name) return i;
+        }
+        return -1;
+    }
+
+    /** Intervals of the string intervals, every step if null or empty */
+    IntervalsParser MakeIntervals (const char* intervals)
+    {
+        const std::string str = (intervals && intervals[0] != '\0') ? intervals : "1";
+        return IntervalsParser({str});
+    }
+}
+
+extern "C" {
+
+    int warpx_add_callback (const char* name, WARPX_CALLBACK_NATIVE callback,
+                            const char* intervals)
+    {
+        const int i = CallbackIndex(name);
+        if (i < 0 || !callback) return 0;
+        callback_schedules[i].native.push_back({callback, MakeIntervals(intervals)});
+        return 1;
+    }
+
+    int warpx_set_callback_py_intervals (const char* name, const char* intervals)
+    {
+        const int i = CallbackIndex(name);
+        if (i < 0) return 0;
+        callback_schedules[i].has_py_intervals = (intervals && intervals[0] != '\0');
+        callback_schedules[i].py_intervals = MakeIntervals(intervals);
+        return 1;
+    }
+
+}
+
+void
+ExecuteCallbacks (CallbackPoint point, int step)
+{
+    const int i = static_cast<int>(point);
+    const CallbackSchedule& schedule = callback_schedules[i];
+    WARPX_CALLBACK_PY_FUNC_0 py_callback = *py_callbacks[i];
+    if (py_callback && (!schedule.has_py_intervals || schedule.py_intervals.contains(step))) {
+        py_callback();
+        ++num_callbacks_executed;
+    }
+    for (auto const& callback : schedule.native) {
+        if (callback.intervals.contains(step)) {
+            callback.func(step);
+            ++num_callbacks_executed;
+        }
+    }
+}
+
+long
+NumCallbacksExecuted ()
+{
+    return num_callbacks_executed;
+}
+
+void
+LoadCallbackPlugins ()
+{
+    amrex::ParmParse pp_warpx("warpx");
+    std::vector<std::string> plugins;
+    pp_warpx.queryarr("plugins", plugins);
+
+    for (auto const& plugin : plugins) {
+#if defined(__unix__) || defined(__APPLE__)
+        // the plugins stay loaded until the end of the run
+        void* handle = dlopen(plugin.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle) {
+            amrex::Abort("Cannot load the plugin " + plugin + ": " + dlerror());
+        }
+        using PluginInit = void(*)(WARPX_ADD_CALLBACK);
+        auto init = reinterpret_cast<PluginInit>(dlsym(handle, "warpx_plugin_init"));
+        WarpXUtilMsg::AlwaysAssert(init != nullptr,
+            "The plugin " + plugin + " does not define warpx_plugin_init");
+        init(&warpx_add_callback);
+        amrex::Print() << "Loaded the plugin " << plugin << "\n";
+#else
+        amrex::Abort("warpx.plugins: cannot load " + plugin + ", shared libraries are not supported on this platform");
+#endif
+    }
+}
@@ -0,0 +1,217 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "Autotune.H"
+
+#include "WarpX.H"
+#include "Particles/WarpXParticleContainer.H"
+#include "Utils/PhaseTimer.H"
+
+#include <AMReX.H>
+#include <AMReX_IntVect.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Vector.H>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+using namespace amrex;
+
+namespace
+{
+    /** Candidate parameters of a trial; 0 (or an empty tile size) keeps the value of the inputs */
+    struct Candidate
+    {
+        int max_grid_size = 0;
+        int blocking_factor = 0;
+        Vector<int> tile_size;
+    };
+
+    /** Inputs lines setting the parameters of candidate c */
+    std::string InputsLines (Candidate const& c)
+    {
+        std::stringstream ss;
+        if (c.max_grid_size > 0) ss << "amr.max_grid_size = " << c.max_grid_size << "\n";
+        if (c.blocking_factor > 0) ss << "amr.blocking_factor = " << c.blocking_factor << "\n";
+        if (!c.tile_size.empty()) {
+            ss << "particles.tile_size =";
+            for (int n : c.tile_size) ss << " " << n;
+            ss << "\n";
+        }
+        return ss.str();
+    }
+
+    /** Set the parameters of candidate c, which override those of the inputs (the last
+     *  occurrence of a parameter is the one read) */
+    void SetParameters (Candidate const& c)
+    {
+        ParmParse pp_amr("amr");
+        if (c.max_grid_size > 0) pp_amr.add("max_grid_size", c.max_grid_size);
+        if (c.blocking_factor > 0) pp_amr.add("blocking_factor", c.blocking_factor);
+        if (!c.tile_size.empty()) {
+            ParmParse pp_particles("particles");
+            pp_particles.addarr("tile_size", c.tile_size);
+            // the particle containers read particles.tile_size only once
+            WarpXParticleContainer::tile_size = IntVect(c.tile_size.data());
+        }
+    }
+
+    /** Whether the grids of candidate c can be made: max_grid_size must be a multiple of
+     *  blocking_factor, and blocking_factor must divide the number of cells of the domain */
+    bool IsValid (Candidate const& c)
+    {
+        ParmParse pp_amr("amr");
+        Vector<int> n_cell(AMREX_SPACEDIM);
+        pp_amr.getarr("n_cell", n_cell, 0, AMREX_SPACEDIM);
+        int max_grid_size = c.max_grid_size;
+        if (max_grid_size == 0) pp_amr.query("max_grid_size", max_grid_size);
+        int blocking_factor = c.blocking_factor;
+        if (blocking_factor == 0) {
+            blocking_factor = 8;
+            pp_amr.query("blocking_factor", blocking_factor);
+        }
+        if (max_grid_size > 0 && max_grid_size % blocking_factor != 0) return false;
+        for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+            if (n_cell[idim] % blocking_factor != 0) return false;
+        }
+        return true;
+    }
+
+    /** Wall time per step of the simulation with the parameters of candidate c, maximum
+     *  over the MPI ranks (infinite if no step was timed) */
+    Real TimeTrial (Candidate const& c, int warmup_steps, int steps)
+    {
+        SetParameters(c);
+
+        Real time_per_step = std::numeric_limits<Real>::max();
+        {
+            WarpX warpx;
+            warpx.InitData();
+            if (warmup_steps > 0) warpx.Evolve(warmup_steps);
+
+            const int first_step = PhaseTimer::NumSteps();
+            const Real first_time = PhaseTimer::Times().back();
+            warpx.Evolve(steps);
+            const int timed_steps = PhaseTimer::NumSteps() - first_step;
+            if (timed_steps > 0) {
+                time_per_step = (PhaseTimer::Times().back() - first_time)/timed_steps;
+            }
+        }
+        ParallelDescriptor::ReduceRealMax(time_per_step);
+        return time_per_step;
+    }
+}
+
+namespace utils
+{
+    bool
+    warpx_autotune ()
+    {
+        ParmParse pp_autotune("autotune");
+        int enable = 0;
+        pp_autotune.query("enable", enable);
+        if (!enable) return true;
+
+        // these parameters would override the candidates
+        ParmParse pp_amr("amr");
+        for (std::string const name : {"max_grid_size_x", "max_grid_size_y", "max_grid_size_z",
+                                       "blocking_factor_x", "blocking_factor_y", "blocking_factor_z"}) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!pp_amr.contains(name.c_str()),
+                "autotune.enable: amr." + name + " cannot be used with autotune "
+                "(nor the RZ PSATD solver, which sets it)");
+        }
+
+        Vector<int> max_grid_sizes, blocking_factors, tile_sizes;
+        pp_autotune.queryarr("max_grid_size", max_grid_sizes);
+        pp_autotune.queryarr("blocking_factor", blocking_factors);
+        pp_autotune.queryarr("tile_size", tile_sizes);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(tile_sizes.size() % AMREX_SPACEDIM == 0,
+            "autotune.tile_size must give the tile sizes as groups of AMREX_SPACEDIM integers");
+        // a parameter without candidates keeps its value
+        if (max_grid_sizes.empty()) max_grid_sizes.push_back(0);
+        if (blocking_factors.empty()) blocking_factors.push_back(0);
+        const int n_tile_sizes = std::max(static_cast<int>(tile_sizes.size())/AMREX_SPACEDIM, 1);
+
+        int warmup_steps = 1;
+        int steps = 5;
+        int run_simulation = 1;
+        std::string output = "autotune_inputs";
+        pp_autotune.query("warmup_steps", warmup_steps);
+        pp_autotune.query("steps", steps);
+        pp_autotune.query("run_simulation", run_simulation);
+        pp_autotune.query("output", output);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(warmup_steps >= 0 && steps > 0,
+            "autotune.warmup_steps must be >= 0 and autotune.steps > 0");
+
+        Vector<Candidate> candidates;
+        for (int max_grid_size : max_grid_sizes) {
+            for (int blocking_factor : blocking_factors) {
+                for (int it = 0; it < n_tile_sizes; ++it) {
+                    Candidate c;
+                    c.max_grid_size = max_grid_size;
+                    c.blocking_factor = blocking_factor;
+                    if (!tile_sizes.empty()) {
+                        c.tile_size.assign(tile_sizes.begin() + it*AMREX_SPACEDIM,
+                                           tile_sizes.begin() + (it+1)*AMREX_SPACEDIM);
+                    }
+                    if (IsValid(c)) {
+                        candidates.push_back(c);
+                    } else {
+                        Print() << "Autotune: skipping amr.max_grid_size = " << c.max_grid_size
+                                << ", amr.blocking_factor = " << c.blocking_factor
+                                << " (inconsistent with each other or with amr.n_cell)\n";
+                    }
+                }
+            }
+        }
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!candidates.empty(),
+            "autotune.enable: none of the candidates is consistent with amr.n_cell");
+
+        // the trials run without the full diagnostics
+        ParmParse pp_diagnostics("diagnostics");
+        int enable_diags = 1;
+        pp_diagnostics.query("enable", enable_diags);
+        pp_diagnostics.add("enable", 0);
+
+        PhaseTimer::Enable();
+
+        int best = 0;
+        Vector<Real> times(candidates.size());
+        for (int ic = 0; ic < static_cast<int>(candidates.size()); ++ic) {
+            Print() << "Autotune: trial " << ic+1 << " of " << candidates.size() << "\n"
+                    << InputsLines(candidates[ic]);
+            times[ic] = TimeTrial(candidates[ic], warmup_steps, steps);
+            Print() << "Autotune: " << times[ic] << " s per step\n";
+            if (times[ic] < times[best]) best = ic;
+        }
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(times[best] < std::numeric_limits<Real>::max(),
+            "autotune.enable: no step was timed (max_step or stop_time reached)");
+
+        Print() << "Autotune: the fastest configuration, at " << times[best]
+                << " s per step, is\n" << InputsLines(candidates[best]);
+        if (ParallelDescriptor::IOProcessor()) {
+            std::ofstream ofs(output);
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ofs.good(),
+                "autotune.output: could not open " + output);
+            ofs << "# autotune: " << times[best] << " s per step with "
+                << ParallelDescriptor::NProcs() << " MPI ranks, fastest of "
+                << candidates.size() << " configurations\n"
+                << InputsLines(candidates[best]);
+        }
+
+        SetParameters(candidates[best]);
+        pp_diagnostics.add("enable", enable_diags);
+        // the timers are enabled again by the Timing reduced diagnostics, if any
+        PhaseTimer::Disable();
+
+        return run_simulation;
+    }
+} // namespace utils
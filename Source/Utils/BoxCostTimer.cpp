@@ -0,0 +1,122 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "BoxCostTimer.H"
+#include "WarpX.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+
+#include <AMReX_GpuAtomic.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_Vector.H>
+
+using namespace amrex;
+
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+namespace
+{
+#if defined(AMREX_USE_CUDA)
+    using GpuEvent = cudaEvent_t;
+#else
+    using GpuEvent = hipEvent_t;
+#endif
+
+    /** Events at both ends of a timer, and box whose cost they measure */
+    struct TimerEvents
+    {
+        GpuEvent start;
+        GpuEvent stop;
+        LayoutData<Real>* cost;
+        int box_index;
+    };
+
+    /** The events are created once, and reused after each Flush: the first
+     *  n_pending ones are those of the timers since the last Flush */
+    Vector<TimerEvents> timer_events;
+    int n_pending = 0;
+
+    void CreateEvent (GpuEvent& event)
+    {
+#if defined(AMREX_USE_CUDA)
+        AMREX_CUDA_SAFE_CALL(cudaEventCreate(&event));
+#else
+        AMREX_HIP_SAFE_CALL(hipEventCreate(&event));
+#endif
+    }
+
+    void RecordEvent (GpuEvent event)
+    {
+#if defined(AMREX_USE_CUDA)
+        AMREX_CUDA_SAFE_CALL(cudaEventRecord(event, Gpu::gpuStream()));
+#else
+        AMREX_HIP_SAFE_CALL(hipEventRecord(event, Gpu::gpuStream()));
+#endif
+    }
+
+    /** Time in seconds between start and stop, once stop is completed */
+    Real ElapsedTime (GpuEvent start, GpuEvent stop)
+    {
+        float ms = 0.f;
+#if defined(AMREX_USE_CUDA)
+        AMREX_CUDA_SAFE_CALL(cudaEventSynchronize(stop));
+        AMREX_CUDA_SAFE_CALL(cudaEventElapsedTime(&ms, start, stop));
+#else
+        AMREX_HIP_SAFE_CALL(hipEventSynchronize(stop));
+        AMREX_HIP_SAFE_CALL(hipEventElapsedTime(&ms, start, stop));
+#endif
+        return Real(1.e-3)*ms;
+    }
+}
+#endif
+
+BoxCostTimer::BoxCostTimer (LayoutData<Real>* cost, int box_index)
+    : m_box_index(box_index)
+{
+    if (cost == nullptr ||
+        WarpX::load_balance_costs_update_algo != LoadBalanceCostsUpdateAlgo::Timers) return;
+    m_cost = cost;
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    if (n_pending == static_cast<int>(timer_events.size())) {
+        TimerEvents events;
+        CreateEvent(events.start);
+        CreateEvent(events.stop);
+        timer_events.push_back(events);
+    }
+    m_events = n_pending++;
+    TimerEvents& events = timer_events[m_events];
+    events.cost = cost;
+    events.box_index = box_index;
+    RecordEvent(events.start);
+#else
+    Gpu::synchronize();
+    m_wt = static_cast<Real>(amrex::second());
+#endif
+}
+
+void
+BoxCostTimer::stop ()
+{
+    if (m_cost == nullptr) return;
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    RecordEvent(timer_events[m_events].stop);
+#else
+    Gpu::synchronize();
+    m_wt = static_cast<Real>(amrex::second()) - m_wt;
+    HostDevice::Atomic::Add( &(*m_cost)[m_box_index], m_wt);
+#endif
+    m_cost = nullptr;
+}
+
+void
+BoxCostTimer::Flush ()
+{
+#if defined(AMREX_USE_CUDA) || defined(AMREX_USE_HIP)
+    for (int i = 0; i < n_pending; ++i) {
+        TimerEvents const& events = timer_events[i];
+        (*events.cost)[events.box_index] += ElapsedTime(events.start, events.stop);
+    }
+    n_pending = 0;
+#endif
+}
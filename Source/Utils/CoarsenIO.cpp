@@ -1,7 +1,28 @@
 #include "CoarsenIO.H"
 
+#include <algorithm>
+#include <utility>
+
 using namespace amrex;
 
+namespace
+{
+    /** Copy an IntVect to a 3D array, filling the missing dimension with \c fill */
+    GpuArray<int,3> ToArray3 ( const IntVect& iv, const int fill )
+    {
+        GpuArray<int,3> a;
+        a[0] = iv[0];
+        a[1] = iv[1];
+#if   (AMREX_SPACEDIM == 2)
+        a[2] = fill;
+#elif (AMREX_SPACEDIM == 3)
+        amrex::ignore_unused(fill);
+        a[2] = iv[2];
+#endif
+        return a;
+    }
+}
+
 void
 CoarsenIO::Loop ( MultiFab& mf_dst,
                   const MultiFab& mf_src,
@@ -9,7 +30,8 @@ CoarsenIO::Loop ( MultiFab& mf_dst,
                   const int scomp,
                   const int ncomp,
                   const IntVect ngrowvect,
-                  const IntVect crse_ratio )
+                  const IntVect crse_ratio,
+                  const Vector<int>& src_index )
 {
     // Staggering of source fine MultiFab and destination coarse MultiFab
     const IntVect stag_src = mf_src.boxArray().ixType().toIntVect();
@@ -22,33 +44,9 @@ CoarsenIO::Loop ( MultiFab& mf_dst,
         "source fine MultiFab does not have enough guard cells for this interpolation" );
 
     // Auxiliary integer arrays (always 3D)
-    GpuArray<int,3> sf; // staggering of source fine MultiFab
-    GpuArray<int,3> sc; // staggering of destination coarse MultiFab
-    GpuArray<int,3> cr; // coarsening ratio
-
-    sf[0] = stag_src[0];
-    sf[1] = stag_src[1];
-#if   (AMREX_SPACEDIM == 2)
-    sf[2] = 0;
-#elif (AMREX_SPACEDIM == 3)
-    sf[2] = stag_src[2];
-#endif
-
-    sc[0] = stag_dst[0];
-    sc[1] = stag_dst[1];
-#if   (AMREX_SPACEDIM == 2)
-    sc[2] = 0;
-#elif (AMREX_SPACEDIM == 3)
-    sc[2] = stag_dst[2];
-#endif
-
-    cr[0] = crse_ratio[0];
-    cr[1] = crse_ratio[1];
-#if   (AMREX_SPACEDIM == 2)
-    cr[2] = 1;
-#elif (AMREX_SPACEDIM == 3)
-    cr[2] = crse_ratio[2];
-#endif
+    GpuArray<int,3> const sf = ToArray3( stag_src, 0 ); // staggering of source fine MultiFab
+    GpuArray<int,3> const sc = ToArray3( stag_dst, 0 ); // staggering of destination coarse MultiFab
+    GpuArray<int,3> const cr = ToArray3( crse_ratio, 1 ); // coarsening ratio
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
@@ -59,7 +57,8 @@ CoarsenIO::Loop ( MultiFab& mf_dst,
         // Tiles defined at the coarse level
         const Box& bx = mfi.growntilebox( ngrowvect );
         Array4<Real> const& arr_dst = mf_dst.array( mfi );
-        Array4<Real const> const& arr_src = mf_src.const_array( mfi );
+        const int isrc = src_index.empty() ? mfi.index() : src_index[mfi.index()];
+        Array4<Real const> const& arr_src = mf_src.const_array( isrc );
         ParallelFor( bx, ncomp,
                      [=] AMREX_GPU_DEVICE( int i, int j, int k, int n )
                      {
@@ -69,6 +68,59 @@ CoarsenIO::Loop ( MultiFab& mf_dst,
     }
 }
 
+void
+CoarsenIO::FusedLoop ( MultiFab& mf_dst,
+                       const Vector<const MultiFab*>& mf_src,
+                       const Vector<int>& scomp,
+                       const Vector<int>& dcomp,
+                       const IntVect crse_ratio )
+{
+    BL_PROFILE("CoarsenIO::FusedLoop()");
+
+    // Maximum number of fields interpolated by one kernel
+    constexpr int max_fused = 16;
+
+    GpuArray<int,3> const sc = ToArray3( mf_dst.boxArray().ixType().toIntVect(), 0 );
+    GpuArray<int,3> const cr = ToArray3( crse_ratio, 1 );
+
+    const IntVect ngrowvect = mf_dst.nGrowVect();
+    if ( crse_ratio > IntVect(1) ) AMREX_ALWAYS_ASSERT_WITH_MESSAGE( ngrowvect == IntVect(0),
+        "option of filling guard cells of destination MultiFab with coarsening not supported for this interpolation" );
+
+    const int nsrc = mf_src.size();
+    for ( int first = 0; first < nsrc; first += max_fused )
+    {
+        const int nf = std::min( max_fused, nsrc-first );
+        GpuArray<GpuArray<int,3>,max_fused> sf; // staggering of each source fine MultiFab
+        GpuArray<int,max_fused> sfirst; // component of each source
+        GpuArray<int,max_fused> dfirst; // component of the destination
+        for ( int f = 0; f < nf; ++f ) {
+            sf[f] = ToArray3( mf_src[first+f]->boxArray().ixType().toIntVect(), 0 );
+            sfirst[f] = scomp[first+f];
+            dfirst[f] = dcomp[first+f];
+        }
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel if (Gpu::notInLaunchRegion())
+#endif
+        for (MFIter mfi( mf_dst, TilingIfNotGPU() ); mfi.isValid(); ++mfi)
+        {
+            const Box& bx = mfi.growntilebox( ngrowvect );
+            Array4<Real> const& arr_dst = mf_dst.array( mfi );
+            GpuArray<Array4<Real const>,max_fused> arr_src;
+            for ( int f = 0; f < nf; ++f ) arr_src[f] = mf_src[first+f]->const_array( mfi );
+            ParallelFor( bx,
+                         [=] AMREX_GPU_DEVICE( int i, int j, int k )
+                         {
+                             for ( int f = 0; f < nf; ++f ) {
+                                 arr_dst(i,j,k,dfirst[f]) = CoarsenIO::Interp(
+                                     arr_src[f], sf[f], sc, cr, i, j, k, sfirst[f] );
+                             }
+                         } );
+        }
+    }
+}
+
 void
 CoarsenIO::Coarsen ( MultiFab& mf_dst,
                      const MultiFab& mf_src,
@@ -110,10 +162,26 @@ CoarsenIO::Coarsen ( MultiFab& mf_dst,
     else
     {
         // Cannot coarsen into MultiFab with different BoxArray or DistributionMapping:
-        // 1) create temporary MultiFab on coarsened version of source BoxArray with same DistributionMapping
-        MultiFab mf_tmp( ba_tmp, mf_src.DistributionMap(), ncomp, 0, MFInfo(), FArrayBoxFactory() );
+        // 1) create temporary MultiFab on the coarsened boxes of the source BoxArray,
+        //    restricted to the region covered by mf_dst, with the same owners
+        const Box dst_region = mf_dst.boxArray().minimalBox();
+        const DistributionMapping& dm_src = mf_src.DistributionMap();
+        BoxList bl_roi( ba_tmp.ixType() );
+        Vector<int> procs_roi;
+        Vector<int> src_index;
+        for ( int i = 0; i < ba_tmp.size(); ++i ) {
+            const Box b = ba_tmp[i] & dst_region;
+            if ( b.ok() ) {
+                bl_roi.push_back( b );
+                procs_roi.push_back( dm_src[i] );
+                src_index.push_back( i );
+            }
+        }
+        if ( bl_roi.isEmpty() ) return;
+        MultiFab mf_tmp( BoxArray( std::move(bl_roi) ), DistributionMapping( std::move(procs_roi) ),
+                         ncomp, 0, MFInfo(), FArrayBoxFactory() );
         // 2) interpolate from mf_src to mf_tmp (start writing into component 0)
-        CoarsenIO::Loop( mf_tmp, mf_src, 0, scomp, ncomp, ngrowvect, crse_ratio );
+        CoarsenIO::Loop( mf_tmp, mf_src, 0, scomp, ncomp, ngrowvect, crse_ratio, src_index );
         // 3) copy from mf_tmp to mf_dst (with different BoxArray or DistributionMapping)
         mf_dst.copy( mf_tmp, 0, dcomp, ncomp );
     }
@@ -0,0 +1,26 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "ColdFields.H"
+
+#include "WarpX.H"
+
+using namespace amrex;
+
+Arena*
+ColdFields::GetArena ()
+{
+#ifdef AMREX_USE_GPU
+    if (WarpX::cold_fields_on_host) return The_Pinned_Arena();
+#endif
+    return The_Arena();
+}
+
+MFInfo
+ColdFields::Info ()
+{
+    return MFInfo().SetArena(GetArena());
+}
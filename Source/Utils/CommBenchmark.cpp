@@ -0,0 +1,246 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "CommBenchmark.H"
+
+#include "WarpX.H"
+#include "BoundaryConditions/PML.H"
+#include "Parallelization/CommStats.H"
+
+#include <AMReX.H>
+#include <AMReX_GpuDevice.H>
+#include <AMReX_MultiFab.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+#include <AMReX_Vector.H>
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <numeric>
+#include <sstream>
+#include <string>
+
+using namespace amrex;
+
+namespace
+{
+    /** A communication pattern of the time step, and the exchange that reproduces it */
+    struct Pattern
+    {
+        std::string name;
+        std::function<void(WarpX&)> exchange;
+    };
+
+    /** The patterns of the simulation `warpx` (those of the fields it does not have are left out) */
+    Vector<Pattern> Patterns (WarpX& warpx)
+    {
+        Vector<Pattern> patterns;
+        // staggered E and B, with the guard cells used by the field solver
+        patterns.push_back({"fill_E", [] (WarpX& w) { w.FillBoundaryE(w.getngFieldSolver()); }});
+        patterns.push_back({"fill_B", [] (WarpX& w) { w.FillBoundaryB(w.getngFieldSolver()); }});
+#ifdef WARPX_MAG_LLG
+        // H and M, with all their guard cells, as after the update of M
+        patterns.push_back({"fill_H", [] (WarpX& w) { w.FillBoundaryH(w.getngE()); }});
+        patterns.push_back({"fill_M", [] (WarpX& w) { w.FillBoundaryM(w.getngE()); }});
+#endif
+        // sum of the current guard cells (and addition of the current of the finer levels)
+        patterns.push_back({"sum_J", [] (WarpX& w) { w.SyncCurrent(); }});
+        // synchronization of the nodal points of the current (and of the PML fields)
+        patterns.push_back({"nodal_sync", [] (WarpX& w) {
+            for (int lev = 0; lev <= w.finestLevel(); ++lev) {
+                for (int idim = 0; idim < 3; ++idim) {
+                    w.get_pointer_current_fp(lev, idim)->OverrideSync(w.Geom(lev).periodicity());
+                }
+            }
+            if (w.DoPML()) w.NodalSyncPML();
+        }});
+        if (warpx.DoPML()) {
+            patterns.push_back({"pml", [] (WarpX& w) {
+                for (int lev = 0; lev <= w.finestLevel(); ++lev) {
+                    PML* pml = w.GetPML(lev);
+                    if (pml && pml->ok()) pml->FillBoundary();
+                }
+            }});
+        }
+        patterns.push_back({"redistribute", [] (WarpX& w) { w.GetPartContainer().Redistribute(); }});
+        return patterns;
+    }
+
+    /** Timing of a pattern: time per call, maximum over the MPI ranks, and messages and bytes
+     *  sent per call, summed over the ranks */
+    struct Result
+    {
+        std::string name;
+        Real time = 0._rt;
+        Real messages = 0._rt;
+        Real bytes = 0._rt;
+    };
+
+    /** Time the patterns `names` (all of them if empty) of the simulation, initialized with
+     *  the decomposition of the inputs */
+    Vector<Result> TimePatterns (Vector<std::string> const& names, int warmup, int repeat,
+                                 int& nboxes)
+    {
+        WarpX warpx;
+        warpx.InitData();
+        nboxes = warpx.boxArray(0).size();
+
+        // the sums of the current guard cells do not grow from zero
+        for (int lev = 0; lev <= warpx.finestLevel(); ++lev) {
+            for (int idim = 0; idim < 3; ++idim) {
+                warpx.get_pointer_current_fp(lev, idim)->setVal(0._rt);
+            }
+        }
+
+        Vector<Result> results;
+        Vector<Long> messages, bytes;
+        for (Pattern const& pattern : Patterns(warpx)) {
+            if (!names.empty() &&
+                std::find(names.begin(), names.end(), pattern.name) == names.end()) continue;
+
+            for (int i = 0; i < warmup; ++i) pattern.exchange(warpx);
+            Gpu::synchronize();
+            ParallelDescriptor::Barrier();
+
+            const Vector<Long> bytes0 = CommStats::Bytes();
+            const Vector<Long> messages0 = CommStats::Messages();
+            const auto t0 = static_cast<Real>(amrex::second());
+            for (int i = 0; i < repeat; ++i) pattern.exchange(warpx);
+            Gpu::synchronize();
+            Result result;
+            result.name = pattern.name;
+            result.time = (static_cast<Real>(amrex::second()) - t0)/repeat;
+            results.push_back(result);
+
+            // all the sites within the pattern
+            const Vector<Long> bytes1 = CommStats::Bytes();
+            const Vector<Long> messages1 = CommStats::Messages();
+            bytes.push_back(std::accumulate(bytes1.begin(), bytes1.end(), Long(0)) -
+                            std::accumulate(bytes0.begin(), bytes0.end(), Long(0)));
+            messages.push_back(std::accumulate(messages1.begin(), messages1.end(), Long(0)) -
+                               std::accumulate(messages0.begin(), messages0.end(), Long(0)));
+        }
+
+        for (std::string const& name : names) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+                std::any_of(results.begin(), results.end(),
+                            [&name] (Result const& r) { return r.name == name; }),
+                "comm_benchmark.patterns: " + name + " is not a pattern of this simulation");
+        }
+
+        const int npatterns = results.size();
+        Vector<Real> times(npatterns);
+        for (int ip = 0; ip < npatterns; ++ip) times[ip] = results[ip].time;
+        ParallelDescriptor::ReduceRealMax(times.data(), npatterns);
+        ParallelDescriptor::ReduceLongSum(bytes.data(), npatterns);
+        ParallelDescriptor::ReduceLongSum(messages.data(), npatterns);
+        for (int ip = 0; ip < npatterns; ++ip) {
+            results[ip].time = times[ip];
+            results[ip].bytes = static_cast<Real>(bytes[ip])/repeat;
+            results[ip].messages = static_cast<Real>(messages[ip])/repeat;
+        }
+        return results;
+    }
+}
+
+namespace utils
+{
+    bool
+    warpx_comm_benchmark ()
+    {
+        ParmParse pp_benchmark("comm_benchmark");
+        int enable = 0;
+        pp_benchmark.query("enable", enable);
+        if (!enable) return true;
+
+        ParmParse pp_amr("amr");
+        for (std::string const name : {"max_grid_size_x", "max_grid_size_y", "max_grid_size_z"}) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!pp_amr.contains(name.c_str()),
+                "comm_benchmark.enable: amr." + name + " cannot be used with the benchmark");
+        }
+
+        Vector<int> max_grid_sizes;
+        Vector<std::string> names;
+        pp_benchmark.queryarr("max_grid_size", max_grid_sizes);
+        pp_benchmark.queryarr("patterns", names);
+        // no candidate keeps the decomposition of the inputs
+        if (max_grid_sizes.empty()) max_grid_sizes.push_back(0);
+
+        int warmup = 5;
+        int repeat = 100;
+        int run_simulation = 0;
+        std::string output = "comm_benchmark.txt";
+        pp_benchmark.query("warmup", warmup);
+        pp_benchmark.query("repeat", repeat);
+        pp_benchmark.query("run_simulation", run_simulation);
+        pp_benchmark.query("output", output);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(warmup >= 0 && repeat > 0,
+            "comm_benchmark.warmup must be >= 0 and comm_benchmark.repeat > 0");
+
+        Vector<int> max_grid_size_inputs;
+        pp_amr.queryarr("max_grid_size", max_grid_size_inputs);
+        int blocking_factor = 8;
+        pp_amr.query("blocking_factor", blocking_factor);
+
+        // the benchmark runs without the full diagnostics
+        ParmParse pp_diagnostics("diagnostics");
+        int enable_diags = 1;
+        pp_diagnostics.query("enable", enable_diags);
+        pp_diagnostics.add("enable", 0);
+
+        CommStats::Enable();
+
+        std::stringstream ss;
+        ss << "# comm_benchmark: " << ParallelDescriptor::NProcs() << " MPI ranks, "
+           << repeat << " calls per pattern\n"
+           << "# max_grid_size nboxes pattern time_per_call(s) messages_per_call "
+           << "bytes_per_call bandwidth_per_rank(B/s)\n";
+        for (int max_grid_size : max_grid_sizes) {
+            if (max_grid_size > 0) {
+                AMREX_ALWAYS_ASSERT_WITH_MESSAGE(max_grid_size % blocking_factor == 0,
+                    "comm_benchmark.max_grid_size must be multiples of amr.blocking_factor");
+                pp_amr.add("max_grid_size", max_grid_size);
+            }
+
+            int nboxes = 0;
+            const Vector<Result> results = TimePatterns(names, warmup, repeat, nboxes);
+            Print() << "Communication benchmark: amr.max_grid_size = ";
+            if (max_grid_size > 0) Print() << max_grid_size;
+            else Print() << "(inputs)";
+            Print() << ", " << nboxes << " boxes on level 0\n";
+
+            for (Result const& r : results) {
+                // bytes sent by a rank per second of the exchange
+                const Real bandwidth = r.time > 0._rt ?
+                    r.bytes/ParallelDescriptor::NProcs()/r.time : 0._rt;
+                Print() << "  " << std::left << std::setw(14) << r.name << std::right
+                        << " time " << std::setw(12) << r.time << " s"
+                        << "  messages " << std::setw(8) << r.messages
+                        << "  bytes " << std::setw(12) << r.bytes
+                        << "  bandwidth " << std::setw(12) << bandwidth << " B/s per rank\n";
+                ss << max_grid_size << " " << nboxes << " " << r.name << " " << r.time << " "
+                   << r.messages << " " << r.bytes << " " << bandwidth << "\n";
+            }
+        }
+
+        if (ParallelDescriptor::IOProcessor()) {
+            std::ofstream ofs(output);
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ofs.good(),
+                "comm_benchmark.output: could not open " + output);
+            ofs << ss.str();
+        }
+
+        // the simulation, if any, uses the decomposition of the inputs
+        if (!max_grid_size_inputs.empty()) pp_amr.addarr("max_grid_size", max_grid_size_inputs);
+        pp_diagnostics.add("enable", enable_diags);
+
+        return run_simulation;
+    }
+} // namespace utils
@@ -0,0 +1,90 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "GpuGraph.H"
+
+#include <AMReX_MFIter.H>
+
+#include <cstring>
+
+using namespace amrex;
+
+GpuGraph::Key
+GpuGraph::MakeKey (amrex::Real a, amrex::Vector<amrex::MultiFab const*> const& mfs)
+{
+    Key key;
+    std::uintptr_t a_bits = 0;
+    std::memcpy(&a_bits, &a, sizeof(a));
+    key.push_back(a_bits);
+    for (MultiFab const* mf : mfs) {
+        if (!mf) {
+            key.push_back(0);
+            continue;
+        }
+        for (MFIter mfi(*mf); mfi.isValid(); ++mfi) {
+            FArrayBox const& fab = (*mf)[mfi];
+            key.push_back(reinterpret_cast<std::uintptr_t>(fab.dataPtr()));
+            Box const& bx = fab.box();
+            for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                key.push_back(static_cast<std::uintptr_t>(bx.smallEnd(idim)));
+                key.push_back(static_cast<std::uintptr_t>(bx.bigEnd(idim)));
+            }
+            key.push_back(static_cast<std::uintptr_t>(fab.nComp()));
+        }
+    }
+    return key;
+}
+
+void
+GpuGraph::Reset ()
+{
+    m_key.clear();
+    if (!m_is_recorded) return;
+#if defined(AMREX_USE_CUDA)
+    AMREX_CUDA_SAFE_CALL(cudaGraphExecDestroy(m_graph_exec));
+#elif defined(AMREX_USE_HIP)
+    AMREX_HIP_SAFE_CALL(hipGraphExecDestroy(m_graph_exec));
+#endif
+    m_is_recorded = false;
+}
+
+void
+GpuGraph::BeginRecording ()
+{
+#if defined(AMREX_USE_CUDA)
+    AMREX_CUDA_SAFE_CALL(cudaStreamBeginCapture(Gpu::gpuStream(), cudaStreamCaptureModeGlobal));
+#elif defined(AMREX_USE_HIP)
+    AMREX_HIP_SAFE_CALL(hipStreamBeginCapture(Gpu::gpuStream(), hipStreamCaptureModeGlobal));
+#endif
+}
+
+void
+GpuGraph::EndRecording ()
+{
+#if defined(AMREX_USE_CUDA)
+    cudaGraph_t graph;
+    AMREX_CUDA_SAFE_CALL(cudaStreamEndCapture(Gpu::gpuStream(), &graph));
+    AMREX_CUDA_SAFE_CALL(cudaGraphInstantiate(&m_graph_exec, graph, nullptr, nullptr, 0));
+    AMREX_CUDA_SAFE_CALL(cudaGraphDestroy(graph));
+    m_is_recorded = true;
+#elif defined(AMREX_USE_HIP)
+    hipGraph_t graph;
+    AMREX_HIP_SAFE_CALL(hipStreamEndCapture(Gpu::gpuStream(), &graph));
+    AMREX_HIP_SAFE_CALL(hipGraphInstantiate(&m_graph_exec, graph, nullptr, nullptr, 0));
+    AMREX_HIP_SAFE_CALL(hipGraphDestroy(graph));
+    m_is_recorded = true;
+#endif
+}
+
+void
+GpuGraph::Launch ()
+{
+#if defined(AMREX_USE_CUDA)
+    AMREX_CUDA_SAFE_CALL(cudaGraphLaunch(m_graph_exec, Gpu::gpuStream()));
+#elif defined(AMREX_USE_HIP)
+    AMREX_HIP_SAFE_CALL(hipGraphLaunch(m_graph_exec, Gpu::gpuStream()));
+#endif
+}
@@ -0,0 +1,94 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "HardwareCounters.H"
+
+#ifdef WARPX_USE_LIKWID
+#   if __has_include(<likwid-marker.h>)
+#       include <likwid-marker.h>
+#   else
+#       include <likwid.h>
+#   endif
+#   ifdef AMREX_USE_OMP
+#       include <omp.h>
+#   endif
+#endif
+
+namespace
+{
+#ifdef WARPX_USE_LIKWID
+    /** Regions measured in WarpX, registered at initialization to reduce the cost of their first call */
+    const char* const region_names[] = {"EvolveE", "EvolveB", "PushPX", "DepositCurrent", "LLG"};
+
+    bool InParallel ()
+    {
+#ifdef AMREX_USE_OMP
+        return omp_in_parallel();
+#else
+        return false;
+#endif
+    }
+#endif
+}
+
+HardwareCounterRegion::HardwareCounterRegion (const char* name)
+    : m_name(name)
+{
+#ifdef WARPX_USE_LIKWID
+    m_all_threads = !InParallel();
+    if (m_all_threads) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+        {
+            LIKWID_MARKER_START(m_name);
+        }
+    } else {
+        LIKWID_MARKER_START(m_name);
+    }
+#endif
+}
+
+HardwareCounterRegion::~HardwareCounterRegion ()
+{
+#ifdef WARPX_USE_LIKWID
+    if (m_all_threads) {
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+        {
+            LIKWID_MARKER_STOP(m_name);
+        }
+    } else {
+        LIKWID_MARKER_STOP(m_name);
+    }
+#endif
+}
+
+void
+HardwareCounterRegion::Initialize ()
+{
+#ifdef WARPX_USE_LIKWID
+    LIKWID_MARKER_INIT;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+    {
+        LIKWID_MARKER_THREADINIT;
+        for (const char* name : region_names) {
+            LIKWID_MARKER_REGISTER(name);
+        }
+    }
+#endif
+}
+
+void
+HardwareCounterRegion::Finalize ()
+{
+#ifdef WARPX_USE_LIKWID
+    LIKWID_MARKER_CLOSE;
+#endif
+}
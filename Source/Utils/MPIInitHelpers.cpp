@@ -8,10 +8,73 @@
 
 #include <AMReX.H>
 #include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
 #include <AMReX_Print.H>
 
+#if defined(AMREX_USE_MPI) && defined(AMREX_USE_GPU) && defined(__has_include)
+#   if __has_include(<mpi-ext.h>)
+#       include <mpi-ext.h>  // Open MPI extensions: MPIX_Query_cuda_support
+#   endif
+#endif
+
+#ifdef AMREX_USE_OMP
+#   include <omp.h>
+#endif
+#if defined(__linux__)
+#   include <sched.h>
+#endif
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <iostream>
+#include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
+
+#if defined(__linux__)
+namespace
+{
+    /** CPUs of a list in the format of the Linux sysfs, e.g. "0-15,32-47" */
+    std::vector<int> ParseCpuList (std::string const& list)
+    {
+        std::vector<int> cpus;
+        std::stringstream ss(list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            if (range.empty()) continue;
+            auto const dash = range.find('-');
+            int const first = std::stoi(range.substr(0, dash));
+            int const last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash+1));
+            for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+
+    /** CPUs of each NUMA domain of the node, empty if the sysfs does not list them */
+    std::vector<std::vector<int>> NumaDomainCpus ()
+    {
+        std::vector<std::vector<int>> domains;
+        for (int node = 0; ; ++node) {
+            std::ifstream ifs("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!ifs) break;
+            std::string list;
+            std::getline(ifs, list);
+            domains.push_back(ParseCpuList(list));
+        }
+        return domains;
+    }
+
+    std::string CpuListString (std::vector<int> const& cpus)
+    {
+        std::string s;
+        for (auto const cpu : cpus) s += (s.empty() ? "" : ",") + std::to_string(cpu);
+        return s;
+    }
+}
+#endif
 
 
 namespace utils
@@ -55,4 +118,178 @@ namespace utils
 #endif
     }
 
+    std::pair< MPI_Comm, int >
+    warpx_ensemble_init (int& argc, char**& argv)
+    {
+        if (argc < 2 || std::string(argv[1]) != "--ensemble") return {MPI_COMM_WORLD, -1};
+
+        // AMReX is not initialized yet
+        auto abort = [] (std::string const& msg) {
+            std::cerr << "ERROR: --ensemble: " << msg << std::endl;
+#ifdef AMREX_USE_MPI
+            MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
+            std::exit(EXIT_FAILURE);
+        };
+        if (argc < 3) abort("the file listing the input files of the members is missing");
+
+        std::vector<std::string> inputs;
+        std::ifstream ifs(argv[2]);
+        if (!ifs) abort("cannot read " + std::string(argv[2]));
+        std::string line;
+        while (std::getline(ifs, line)) {
+            auto const first = line.find_first_not_of(" \t");
+            if (first == std::string::npos || line[first] == '#') continue;
+            inputs.push_back(line.substr(first, line.find_last_not_of(" \t") - first + 1));
+        }
+        int const num_members = static_cast<int>(inputs.size());
+        if (num_members == 0) abort(std::string(argv[2]) + " lists no input file");
+
+        int rank = 0;
+        int num_ranks = 1;
+#ifdef AMREX_USE_MPI
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+#endif
+        if (num_ranks % num_members != 0) {
+            abort("the number of MPI ranks (" + std::to_string(num_ranks) + ") is not a multiple "
+                  "of the number of members (" + std::to_string(num_members) + ")");
+        }
+        int const member = rank / (num_ranks / num_members);
+
+        MPI_Comm comm = MPI_COMM_WORLD;
+#ifdef AMREX_USE_MPI
+        MPI_Comm_split(MPI_COMM_WORLD, member, rank, &comm);
+#endif
+
+        // the member runs in the directory of its input file
+        std::string const& input = inputs[member];
+        auto const slash = input.rfind('/');
+        if (slash != std::string::npos && chdir(input.substr(0, slash+1).c_str()) != 0) {
+            abort("cannot change to the directory of " + input);
+        }
+
+        // argv of AMReX: executable, input file of the member, other arguments
+        static std::vector<std::string> args;
+        static std::vector<char*> args_ptr;
+        args.assign({argv[0], (slash == std::string::npos) ? input : input.substr(slash+1)});
+        for (int i = 3; i < argc; ++i) args.emplace_back(argv[i]);
+        for (auto& arg : args) args_ptr.push_back(&arg[0]);
+        args_ptr.push_back(nullptr);
+        argc = static_cast<int>(args.size());
+        argv = args_ptr.data();
+
+        return {comm, member};
+    }
+
+    bool
+    warpx_query_gpu_aware_mpi ()
+    {
+#if defined(AMREX_USE_MPI) && defined(AMREX_USE_GPU)
+#   if defined(AMREX_USE_CUDA) && defined(MPIX_CUDA_AWARE_SUPPORT) && MPIX_CUDA_AWARE_SUPPORT
+        if (MPIX_Query_cuda_support() == 1) return true;
+#   endif
+#   if defined(AMREX_USE_HIP) && defined(MPIX_ROCM_AWARE_SUPPORT) && MPIX_ROCM_AWARE_SUPPORT
+        if (MPIX_Query_rocm_support() == 1) return true;
+#   endif
+        // MPI libraries without a query function enable the GPU support in their environment
+        for (char const * const name : {"MPICH_GPU_SUPPORT_ENABLED", "MV2_USE_CUDA"}) {
+            char const * const value = std::getenv(name);
+            if (value && std::string(value) == "1") return true;
+        }
+#endif
+        return false;
+    }
+
+    void
+    warpx_bind_threads ()
+    {
+        amrex::ParmParse pp_warpx("warpx");
+        bool bind_threads = false;
+        pp_warpx.query("bind_threads", bind_threads);
+        if (!bind_threads) return;
+
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+            amrex::Print() << "WARNING: warpx.bind_threads: the CPUs of the process are unknown, "
+                           << "the threads are not bound.\n";
+            return;
+        }
+
+        // CPUs available to the process, ordered by NUMA domain
+        auto const domains = NumaDomainCpus();
+        std::vector<int> cpus;
+        int num_cpus_node = 0;
+        for (auto const& domain : domains) {
+            num_cpus_node += static_cast<int>(domain.size());
+            for (auto const cpu : domain) {
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            }
+        }
+        if (cpus.empty()) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+            }
+            num_cpus_node = static_cast<int>(cpus.size());
+        }
+
+        int local_rank = 0;
+        int local_size = 1;
+#ifdef AMREX_USE_MPI
+        MPI_Comm local_comm;
+        // all the ranks of the node, including those of the other members of an ensemble run
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &local_comm);
+        MPI_Comm_rank(local_comm, &local_rank);
+        MPI_Comm_size(local_comm, &local_size);
+        MPI_Comm_free(&local_comm);
+#endif
+
+        // the ranks share the CPUs of the node, unless the launcher already bound them
+        std::vector<int> block = cpus;
+        bool const bound_by_launcher = static_cast<int>(cpus.size()) < num_cpus_node;
+        if (!bound_by_launcher && local_size > 1) {
+            int const block_size = static_cast<int>(cpus.size()) / local_size;
+            if (block_size == 0) {
+                amrex::Print() << "WARNING: warpx.bind_threads: more MPI ranks than CPUs on the "
+                               << "node, the threads are not bound.\n";
+                return;
+            }
+            block.assign(cpus.begin() + local_rank*block_size,
+                         cpus.begin() + (local_rank+1)*block_size);
+        }
+
+        int num_threads = 1;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+        {
+            cpu_set_t cpu;
+            CPU_ZERO(&cpu);
+            CPU_SET(block[omp_get_thread_num() % block.size()], &cpu);
+            sched_setaffinity(0, sizeof(cpu), &cpu);  // 0: the calling thread
+#pragma omp master
+            num_threads = omp_get_num_threads();
+        }
+#else
+        cpu_set_t cpu;
+        CPU_ZERO(&cpu);
+        for (auto const c : block) CPU_SET(c, &cpu);
+        sched_setaffinity(0, sizeof(cpu), &cpu);
+#endif
+
+        amrex::Print() << "Thread binding: " << local_size << " MPI rank(s) per node, "
+                       << (domains.empty() ? 1 : domains.size()) << " NUMA domain(s), "
+                       << num_threads << " thread(s) per rank"
+                       << (bound_by_launcher ? " (ranks bound by the launcher)" : "") << "\n"
+                       << "Thread binding: rank 0 on CPUs " << CpuListString(block) << "\n";
+        if (num_threads > static_cast<int>(block.size())) {
+            amrex::Print() << "WARNING: warpx.bind_threads: more threads than CPUs per rank, "
+                           << "some threads share a CPU.\n";
+        }
+#else
+        amrex::Print() << "WARNING: warpx.bind_threads is only supported on Linux.\n";
+#endif
+    }
+
 } // namespace utils
@@ -7,6 +7,9 @@
 #include "ParticleUtils.H"
 #include "WarpX.H"
 
+#include <AMReX_ParticleTransformation.H>
+#include <AMReX_Scan.H>
+
 namespace ParticleUtils {
 
     using namespace amrex;
@@ -49,4 +52,50 @@ namespace ParticleUtils {
         return bins;
     }
 
+    int
+    removeInvalidParticles (ParticleTileType& ptile)
+    {
+        int const np = ptile.numParticles();
+        if (np == 0) return 0;
+
+        ParticleType const* particle_ptr = ptile.GetArrayOfStructs()().data();
+
+        // Number of valid particles before each particle
+        Gpu::DeviceVector<int> is_valid(np);
+        Gpu::DeviceVector<int> offsets(np);
+        int* const p_is_valid = is_valid.dataPtr();
+        int* const p_offsets = offsets.dataPtr();
+        amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (int i) noexcept
+        {
+            p_is_valid[i] = (particle_ptr[i].id() >= 0) ? 1 : 0;
+        });
+        int const n_valid = Scan::ExclusiveSum(np, p_is_valid, p_offsets);
+        if (n_valid == np) return 0;
+
+        if (n_valid > 0) {
+            // The k-th invalid particle among the first n_valid ones is replaced by the k-th
+            // valid particle after them (there are as many of both)
+            Gpu::DeviceVector<int> holes(np - n_valid);
+            int* const p_holes = holes.dataPtr();
+            amrex::ParallelFor(n_valid, [=] AMREX_GPU_DEVICE (int i) noexcept
+            {
+                if (!p_is_valid[i]) p_holes[i - p_offsets[i]] = i;
+            });
+
+            auto const dst = ptile.getParticleTileData();
+            auto const src = ptile.getConstParticleTileData();
+            amrex::ParallelFor(np - n_valid, [=] AMREX_GPU_DEVICE (int j) noexcept
+            {
+                int const i = n_valid + j;
+                if (p_is_valid[i]) {
+                    amrex::copyParticle(dst, src, i, p_holes[p_offsets[i] - p_offsets[n_valid]]);
+                }
+            });
+            Gpu::streamSynchronize();
+        }
+
+        ptile.resize(n_valid);
+        return np - n_valid;
+    }
+
 }
@@ -0,0 +1,139 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "PhaseTimer.H"
+
+#include <AMReX_GpuDevice.H>
+#include <AMReX_Utility.H>
+
+#ifdef AMREX_USE_OMP
+#   include <omp.h>
+#endif
+
+using namespace amrex;
+
+namespace
+{
+    constexpr int num_phases = static_cast<int>(TimerPhase::NumPhases);
+
+    bool enabled = false;
+    /** Phases being timed, innermost last */
+    Vector<int> phase_stack;
+    /** Time of the last start or stop of a phase, and of the start of the step */
+    Real last_time = 0._rt;
+    Real step_start_time = 0._rt;
+    /** Times of the phases, summed since the first step, and the same at the end
+     *  of the last ended step */
+    Vector<Real> phase_times(num_phases, 0._rt);
+    Vector<Real> ended_phase_times(num_phases, 0._rt);
+    /** Time of the ended steps, and their number */
+    Real step_times = 0._rt;
+    int num_steps = 0;
+
+    Real Now ()
+    {
+        Gpu::synchronize();
+        return static_cast<Real>(amrex::second());
+    }
+
+    /** Add the time since the last start or stop of a phase to the innermost phase */
+    void Update (Real now)
+    {
+        if (!phase_stack.empty()) phase_times[phase_stack.back()] += now - last_time;
+        last_time = now;
+    }
+
+    bool InParallelRegion ()
+    {
+#ifdef AMREX_USE_OMP
+        return omp_in_parallel();
+#else
+        return false;
+#endif
+    }
+}
+
+PhaseTimer::PhaseTimer (TimerPhase phase)
+{
+    if (!enabled || InParallelRegion()) return;
+    Update(Now());
+    phase_stack.push_back(static_cast<int>(phase));
+    m_active = true;
+}
+
+PhaseTimer::~PhaseTimer ()
+{
+    if (!m_active) return;
+    Update(Now());
+    phase_stack.pop_back();
+}
+
+void
+PhaseTimer::Enable ()
+{
+    if (enabled) return;
+    enabled = true;
+    Restart();
+}
+
+void
+PhaseTimer::Disable ()
+{
+    enabled = false;
+}
+
+bool
+PhaseTimer::Enabled ()
+{
+    return enabled;
+}
+
+void
+PhaseTimer::Restart ()
+{
+    if (!enabled) return;
+    // the time since the end of the last step is not part of any step
+    phase_times = ended_phase_times;
+    last_time = Now();
+    step_start_time = last_time;
+}
+
+void
+PhaseTimer::EndStep ()
+{
+    if (!enabled) return;
+    const Real now = Now();
+    Update(now);
+    ended_phase_times = phase_times;
+    step_times += now - step_start_time;
+    step_start_time = now;
+    ++num_steps;
+}
+
+int
+PhaseTimer::NumSteps ()
+{
+    return num_steps;
+}
+
+Vector<Real>
+PhaseTimer::Times ()
+{
+    Vector<Real> times = ended_phase_times;
+    Real other = step_times;
+    for (Real t : ended_phase_times) other -= t;
+    times.push_back(other);
+    times.push_back(step_times);
+    return times;
+}
+
+Vector<std::string>
+PhaseTimer::Names ()
+{
+    return {"field_push", "llg", "particle_push", "deposition", "fill_boundary",
+            "sum_boundary", "redistribute", "diagnostics", "load_balance",
+            "other", "step"};
+}
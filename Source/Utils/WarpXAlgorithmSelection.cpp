@@ -31,6 +31,12 @@ const std::map<std::string, int> electrostatic_solver_algo_to_int = {
     {"default", ElectrostaticSolverAlgo::None }
 };
 
+const std::map<std::string, int> poisson_solver_algo_to_int = {
+    {"multigrid", PoissonSolverAlgo::Multigrid },
+    {"fft",       PoissonSolverAlgo::FFT },
+    {"default",   PoissonSolverAlgo::Multigrid }
+};
+
 const std::map<std::string, int> particle_pusher_algo_to_int = {
     {"boris",   ParticlePusherAlgo::Boris },
     {"vay",     ParticlePusherAlgo::Vay },
@@ -42,6 +48,7 @@ const std::map<std::string, int> current_deposition_algo_to_int = {
     {"esirkepov", CurrentDepositionAlgo::Esirkepov },
     {"direct",    CurrentDepositionAlgo::Direct },
     {"vay",       CurrentDepositionAlgo::Vay },
+    {"direct_shared", CurrentDepositionAlgo::DirectShared },
     {"default",   CurrentDepositionAlgo::Esirkepov } // NOTE: overwritten for PSATD below
 };
 
@@ -75,6 +82,18 @@ const std::map<std::string, int> MacroscopicSolver_algo_to_int = {
     {"default", MacroscopicSolverAlgo::BackwardEuler}
 };
 
+const std::map<std::string, int> MagIterSolver_algo_to_int = {
+    {"picard", MagIterSolverAlgo::Picard},
+    {"anderson", MagIterSolverAlgo::Anderson},
+    {"default", MagIterSolverAlgo::Picard}
+};
+
+const std::map<std::string, int> pml_type_to_int = {
+    {"split",   PMLType::Split},
+    {"cpml",    PMLType::Convolutional},
+    {"default", PMLType::Split}
+};
+
 const std::map<std::string, int> FieldBCType_algo_to_int = {
     {"pec",      FieldBoundaryType::PEC},
     {"periodic", FieldBoundaryType::Periodic},
@@ -106,6 +125,8 @@ GetAlgorithmInteger( amrex::ParmParse& pp, const char* pp_search_key ){
         algo_to_int = maxwell_solver_algo_to_int;
     } else if (0 == std::strcmp(pp_search_key, "do_electrostatic")) {
         algo_to_int = electrostatic_solver_algo_to_int;
+    } else if (0 == std::strcmp(pp_search_key, "poisson_solver")) {
+        algo_to_int = poisson_solver_algo_to_int;
     } else if (0 == std::strcmp(pp_search_key, "particle_pusher")) {
         algo_to_int = particle_pusher_algo_to_int;
     } else if (0 == std::strcmp(pp_search_key, "current_deposition")) {
@@ -122,6 +143,10 @@ GetAlgorithmInteger( amrex::ParmParse& pp, const char* pp_search_key ){
         algo_to_int = MaxwellSolver_medium_algo_to_int;
     } else if (0 == std::strcmp(pp_search_key, "macroscopic_sigma_method")) {
         algo_to_int = MacroscopicSolver_algo_to_int;
+    } else if (0 == std::strcmp(pp_search_key, "mag_iter_solver")) {
+        algo_to_int = MagIterSolver_algo_to_int;
+    } else if (0 == std::strcmp(pp_search_key, "pml_type")) {
+        algo_to_int = pml_type_to_int;
     } else {
         std::string pp_search_string = pp_search_key;
         amrex::Abort("Unknown algorithm type: " + pp_search_string);
@@ -137,7 +137,8 @@ WarpX::MoveWindow (bool move_j)
             if (do_pml && pml[lev]->ok()) {
                 const std::array<MultiFab*, 3>& pml_B = pml[lev]->GetB_fp();
                 const std::array<MultiFab*, 3>& pml_E = pml[lev]->GetE_fp();
-                shiftMF(*pml_B[dim], geom[lev], num_shift, dir);
+                // with LLG, B may not be stored in the PML (see PML::ExchangeB)
+                if (pml_B[dim]) shiftMF(*pml_B[dim], geom[lev], num_shift, dir);
                 shiftMF(*pml_E[dim], geom[lev], num_shift, dir);
             }
 
@@ -159,7 +160,7 @@ WarpX::MoveWindow (bool move_j)
                 if (do_pml && pml[lev]->ok()) {
                     const std::array<MultiFab*, 3>& pml_B = pml[lev]->GetB_cp();
                     const std::array<MultiFab*, 3>& pml_E = pml[lev]->GetE_cp();
-                    shiftMF(*pml_B[dim], geom[lev-1], num_shift_crse, dir);
+                    if (pml_B[dim]) shiftMF(*pml_B[dim], geom[lev-1], num_shift_crse, dir);
                     shiftMF(*pml_E[dim], geom[lev-1], num_shift_crse, dir);
                 }
             }
@@ -245,18 +246,15 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir,
 {
     WARPX_PROFILE("WarpX::shiftMF()");
     const BoxArray& ba = mf.boxArray();
-    const DistributionMapping& dm = mf.DistributionMap();
     const int nc = mf.nComp();
     const IntVect& ng = mf.nGrowVect();
 
     AMREX_ALWAYS_ASSERT(ng.min() >= num_shift);
 
-    MultiFab tmpmf(ba, dm, nc, ng);
-    MultiFab::Copy(tmpmf, mf, 0, 0, nc, ng);
-
+    // The fields are shifted in place: fill the guard cells that are read by the shift
     if ( WarpX::safe_guard_cells ) {
         // Fill guard cells.
-        tmpmf.FillBoundary(geom.periodicity());
+        mf.FillBoundary(geom.periodicity());
     } else {
         IntVect ng_mw = IntVect::TheUnitVector();
         // Enough guard cells in the MW direction
@@ -264,7 +262,7 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir,
         // Make sure we don't exceed number of guard cells allocated
         ng_mw = ng_mw.min(ng);
         // Fill guard cells.
-        tmpmf.FillBoundary(ng_mw, geom.periodicity());
+        mf.FillBoundary(ng_mw, geom.periodicity());
     }
 
     // Make a box that covers the region that the window moved into
@@ -294,6 +292,7 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir,
     IntVect shiftiv(0);
     shiftiv[dir] = num_shift;
     Dim3 shift = shiftiv.dim3();
+    Dim3 const step = IntVect::TheDimensionVector(dir).dim3();
 
     const RealBox& real_box = geom.ProbDomain();
     const auto dx = geom.CellSizeArray();
@@ -301,12 +300,9 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir,
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (Gpu::notInLaunchRegion())
 #endif
-
-
-    for (MFIter mfi(tmpmf); mfi.isValid(); ++mfi )
+    for (MFIter mfi(mf); mfi.isValid(); ++mfi )
     {
-        auto const& dstfab = mf.array(mfi);
-        auto const& srcfab = tmpmf.array(mfi);
+        auto const& fab = mf.array(mfi);
 
         const Box& outbox = mfi.fabbox() & adjBox;
 
@@ -314,11 +310,11 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir,
             if (useparser == false) {
                 AMREX_PARALLEL_FOR_4D ( outbox, nc, i, j, k, n,
                 {
-                    srcfab(i,j,k,n) = external_field;
+                    fab(i,j,k,n) = external_field;
                 })
             } else if (useparser == true) {
                 // index type of the src mf
-                auto const& mf_IndexType = (tmpmf).ixType();
+                auto const& mf_IndexType = mf.ixType();
                 IntVect mf_type(AMREX_D_DECL(0,0,0));
                 for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
                     mf_type[idim] = mf_IndexType.nodeCentered(idim);
@@ -340,7 +336,7 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir,
                       Real fac_z = (1.0 - mf_type[2]) * dx[2]*0.5;
                       Real z = k*dx[2] + real_box.lo(2) + fac_z;
 #endif
-                      srcfab(i,j,k,n) = field_parser(x,y,z);
+                      fab(i,j,k,n) = field_parser(x,y,z);
                 });
             }
 
@@ -352,10 +348,21 @@ WarpX::shiftMF (MultiFab& mf, const Geometry& geom, int num_shift, int dir,
         } else {
             dstBox.growLo(dir,  num_shift);
         }
-        AMREX_PARALLEL_FOR_4D ( dstBox, nc, i, j, k, n,
+        // Each thread shifts one column of cells along dir, in the order in which
+        // every cell is read before it is overwritten (no temporary copy is needed)
+        Box colBox = dstBox;
+        colBox.setBig(dir, dstBox.smallEnd(dir));
+        int const ncol = dstBox.length(dir);
+        amrex::ParallelFor(colBox, nc, [=] AMREX_GPU_DEVICE (int i, int j, int k, int n) noexcept
         {
-            dstfab(i,j,k,n) = srcfab(i+shift.x,j+shift.y,k+shift.z,n);
-        })
+            for (int l = 0; l < ncol; ++l) {
+                int const m = (num_shift > 0) ? l : ncol-1-l;
+                int const ii = i + m*step.x;
+                int const jj = j + m*step.y;
+                int const kk = k + m*step.z;
+                fab(ii,jj,kk,n) = fab(ii+shift.x,jj+shift.y,kk+shift.z,n);
+            }
+        });
     }
 }
 
@@ -7,34 +7,226 @@
  */
 
 #include <WarpX.H>
-#include <AMReX_BoxIterator.H>
+#include "Particles/Pusher/GetAndSetPosition.H"
+#include "Utils/CoarsenIO.H"
+#include "Utils/WarpXConst.H"
+
+#include <AMReX_GpuAtomic.H>
+
 #include <array>
 #include <algorithm>
 
 using namespace amrex;
 
+namespace
+{
+    GpuArray<int,3> ToArray3 (const IntVect& iv)
+    {
+        GpuArray<int,3> a;
+        a[0] = iv[0];
+        a[1] = iv[1];
+#if   (AMREX_SPACEDIM == 2)
+        a[2] = 0;
+#elif (AMREX_SPACEDIM == 3)
+        a[2] = iv[2];
+#endif
+        return a;
+    }
+
+    /** Sum of the weights of the macroparticles of the species names in each cell of level lev */
+    MultiFab DepositWeights (MultiParticleContainer const& mypc,
+                             std::vector<std::string> const& names, int lev,
+                             const Geometry& geom, const BoxArray& ba,
+                             const DistributionMapping& dm)
+    {
+        MultiFab weights(ba, dm, 1, 0);
+        weights.setVal(0._rt);
+
+        const auto problo = geom.ProbLoArray();
+        const auto dxi = geom.InvCellSizeArray();
+
+        for (auto const& name : names)
+        {
+            auto& pc = mypc.GetParticleContainerFromName(name);
+            // at initialization, the grids are made before the particles are added
+            if (lev >= static_cast<int>(pc.GetParticles().size())) continue;
+            for (WarpXParIter pti(pc, lev); pti.isValid(); ++pti)
+            {
+                auto const GetPosition = GetParticlePosition(pti);
+                const ParticleReal* const AMREX_RESTRICT wp = pti.GetAttribs(PIdx::w).dataPtr();
+                Array4<Real> const& w_arr = weights.array(pti);
+                const Box bx = pti.validbox();
+                const long np = pti.numParticles();
+
+                // particles that left the box since the last redistribution are not counted
+                amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (long ip)
+                {
+                    const int i = static_cast<int>(amrex::Math::floor(
+                        (GetPosition.pos(ip, 0) - problo[0])*dxi[0]));
+                    const int j = static_cast<int>(amrex::Math::floor(
+                        (GetPosition.pos(ip, 1) - problo[1])*dxi[1]));
+#if (AMREX_SPACEDIM == 3)
+                    const int k = static_cast<int>(amrex::Math::floor(
+                        (GetPosition.pos(ip, 2) - problo[2])*dxi[2]));
+#else
+                    const int k = 0;
+#endif
+                    if (bx.contains(IntVect(AMREX_D_DECL(i,j,k)))) {
+                        amrex::Gpu::Atomic::Add(&w_arr(i,j,k), static_cast<Real>(wp[ip]));
+                    }
+                });
+            }
+        }
+        return weights;
+    }
+}
+
 void
-WarpX::ErrorEst (int lev, TagBoxArray& tags, Real /*time*/, int /*ngrow*/)
+WarpX::ErrorEst (int lev, TagBoxArray& tags, Real time, int /*ngrow*/)
 {
-    const Real* problo = Geom(lev).ProbLo();
-    const Real* dx = Geom(lev).CellSize();
+    WARPX_PROFILE("WarpX::ErrorEst()");
+
+    const auto problo = Geom(lev).ProbLoArray();
+    const auto dx = Geom(lev).CellSizeArray();
+    const auto dxi = Geom(lev).InvCellSizeArray();
+    const TagBox::TagType tagval = TagBox::SET;
+
+    GpuArray<Real,AMREX_SPACEDIM> tag_lo, tag_hi;
+    for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+        tag_lo[idim] = fine_tag_lo[idim];
+        tag_hi[idim] = fine_tag_hi[idim];
+    }
+    const bool do_tag_box = m_do_fine_tag_box;
+
+    // Criteria evaluated on the valid cells of the level
+    const bool do_tag_function = (m_refine_tag_parser != nullptr);
+    const auto tag_function = getParser(m_refine_tag_parser);
+    const bool do_tag_density = (m_refine_tag_density > 0._rt);
+    const Real density_threshold = m_refine_tag_density;
+    MultiFab weights;
+    if (do_tag_density) {
+        weights = DepositWeights(*mypc, m_refine_tag_species, lev, Geom(lev),
+                                 tags.boxArray(), tags.DistributionMap());
+    }
+#ifdef WARPX_MAG_LLG
+    const bool do_tag_M_gradient = (m_refine_tag_M_gradient > 0._rt);
+    const Real M_gradient_threshold2 = m_refine_tag_M_gradient*m_refine_tag_M_gradient;
+#endif
+
+    // The fields are interpolated to the cell centers
+    GpuArray<int,3> const cc{0, 0, 0};
+    GpuArray<int,3> const cr{1, 1, 1};
+    GpuArray<int,3> const Ex_stag = ToArray3(Efield_fp[lev][0]->ixType().toIntVect());
+    GpuArray<int,3> const Ey_stag = ToArray3(Efield_fp[lev][1]->ixType().toIntVect());
+    GpuArray<int,3> const Ez_stag = ToArray3(Efield_fp[lev][2]->ixType().toIntVect());
+    GpuArray<int,3> const Bx_stag = ToArray3(Bfield_fp[lev][0]->ixType().toIntVect());
+    GpuArray<int,3> const By_stag = ToArray3(Bfield_fp[lev][1]->ixType().toIntVect());
+    GpuArray<int,3> const Bz_stag = ToArray3(Bfield_fp[lev][2]->ixType().toIntVect());
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
 #endif
-    for (MFIter mfi(tags); mfi.isValid(); ++mfi)
+    for (MFIter mfi(tags, TilingIfNotGPU()); mfi.isValid(); ++mfi)
     {
-        auto& fab = tags[mfi];
-        const Box& bx = fab.box();
-        for (BoxIterator bi(bx); bi.ok(); ++bi)
+        auto const& tag = tags.array(mfi);
+
+        if (do_tag_box)
         {
-            const IntVect& cell = bi();
-            RealVect pos {AMREX_D_DECL((cell[0]+0.5_rt)*dx[0]+problo[0],
-                                       (cell[1]+0.5_rt)*dx[1]+problo[1],
-                                       (cell[2]+0.5_rt)*dx[2]+problo[2])};
-            if (pos > fine_tag_lo && pos < fine_tag_hi) {
-                fab(cell) = TagBox::SET;
-            }
+            amrex::ParallelFor(mfi.growntilebox(),
+            [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+                const int iv[3] = {i, j, k};
+                bool inside = true;
+                for (int idim = 0; idim < AMREX_SPACEDIM; ++idim) {
+                    const Real pos = (iv[idim] + 0.5_rt)*dx[idim] + problo[idim];
+                    inside = inside && (pos > tag_lo[idim]) && (pos < tag_hi[idim]);
+                }
+                if (inside) tag(i,j,k) = tagval;
+            });
         }
+
+        if (!do_tag_function && !do_tag_density
+#ifdef WARPX_MAG_LLG
+            && !do_tag_M_gradient
+#endif
+            ) continue;
+
+        const Box& bx = mfi.tilebox();
+
+        if (do_tag_function)
+        {
+            Array4<Real const> const& Ex = Efield_fp[lev][0]->const_array(mfi);
+            Array4<Real const> const& Ey = Efield_fp[lev][1]->const_array(mfi);
+            Array4<Real const> const& Ez = Efield_fp[lev][2]->const_array(mfi);
+            Array4<Real const> const& Bx = Bfield_fp[lev][0]->const_array(mfi);
+            Array4<Real const> const& By = Bfield_fp[lev][1]->const_array(mfi);
+            Array4<Real const> const& Bz = Bfield_fp[lev][2]->const_array(mfi);
+            amrex::ParallelFor(bx,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+                const Real x = (i + 0.5_rt)*dx[0] + problo[0];
+#if (AMREX_SPACEDIM == 3)
+                const Real y = (j + 0.5_rt)*dx[1] + problo[1];
+                const Real z = (k + 0.5_rt)*dx[2] + problo[2];
+#else
+                const Real y = 0._rt;
+                const Real z = (j + 0.5_rt)*dx[1] + problo[1];
+#endif
+                const Real f = tag_function(x, y, z, time,
+                    CoarsenIO::Interp(Ex, Ex_stag, cc, cr, i, j, k, 0),
+                    CoarsenIO::Interp(Ey, Ey_stag, cc, cr, i, j, k, 0),
+                    CoarsenIO::Interp(Ez, Ez_stag, cc, cr, i, j, k, 0),
+                    CoarsenIO::Interp(Bx, Bx_stag, cc, cr, i, j, k, 0),
+                    CoarsenIO::Interp(By, By_stag, cc, cr, i, j, k, 0),
+                    CoarsenIO::Interp(Bz, Bz_stag, cc, cr, i, j, k, 0));
+                if (f > 0._rt) tag(i,j,k) = tagval;
+            });
+        }
+
+        if (do_tag_density)
+        {
+            Array4<Real const> const& w_arr = weights.const_array(mfi);
+            amrex::ParallelFor(bx,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+#if (defined WARPX_DIM_RZ)
+                const Real r = (i + 0.5_rt)*dx[0] + problo[0];
+                const Real inv_vol = dxi[0]*dxi[1]/(2._rt*MathConst::pi*r);
+#else
+                const Real inv_vol = AMREX_D_TERM(dxi[0], *dxi[1], *dxi[2]);
+#endif
+                if (w_arr(i,j,k)*inv_vol > density_threshold) tag(i,j,k) = tagval;
+            });
+        }
+
+#ifdef WARPX_MAG_LLG
+        if (do_tag_M_gradient)
+        {
+            // |grad M| at the cell center, from the differences of M between the two
+            // faces of the cell on which each component of the gradient is staggered
+            Array4<Real const> const& Mx = Mfield_fp[lev][0]->const_array(mfi);
+            Array4<Real const> const& My = Mfield_fp[lev][1]->const_array(mfi);
+            Array4<Real const> const& Mz = Mfield_fp[lev][2]->const_array(mfi);
+            amrex::ParallelFor(bx,
+            [=] AMREX_GPU_DEVICE (int i, int j, int k)
+            {
+                Real grad2 = 0._rt;
+                for (int comp = 0; comp < 3; ++comp) {
+#if (AMREX_SPACEDIM == 3)
+                    const Real dMdx = (Mx(i+1,j,k,comp) - Mx(i,j,k,comp))*dxi[0];
+                    const Real dMdy = (My(i,j+1,k,comp) - My(i,j,k,comp))*dxi[1];
+                    const Real dMdz = (Mz(i,j,k+1,comp) - Mz(i,j,k,comp))*dxi[2];
+                    grad2 += dMdx*dMdx + dMdy*dMdy + dMdz*dMdz;
+#else
+                    amrex::ignore_unused(My);
+                    const Real dMdx = (Mx(i+1,j,k,comp) - Mx(i,j,k,comp))*dxi[0];
+                    const Real dMdz = (Mz(i,j+1,k,comp) - Mz(i,j,k,comp))*dxi[1];
+                    grad2 += dMdx*dMdx + dMdz*dMdz;
+#endif
+                }
+                if (grad2 > M_gradient_threshold2) tag(i,j,k) = tagval;
+            });
+        }
+#endif
     }
 }
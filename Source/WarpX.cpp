@@ -13,12 +13,15 @@
 #include "FieldSolver/WarpX_FDTD.H"
 #ifdef WARPX_USE_PSATD
 #include "FieldSolver/SpectralSolver/SpectralKSpace.H"
+#include "FieldSolver/SpectralSolver/SpectralFieldData.H"
 #endif
 #include "Python/WarpXWrappers.h"
 #include "Utils/WarpXConst.H"
 #include "Utils/WarpXUtil.H"
 #include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/BoxCostTimer.H"
 #include "Utils/WarpXProfilerWrapper.H"
+#include "Parallelization/PersistentExchange.H"
 
 #include <AMReX_ParmParse.H>
 #include <AMReX_MultiFabUtil.H>
@@ -35,6 +38,7 @@
 #include <cmath>
 #include <limits>
 #include <numeric>
+#include <set>
 #include <string>
 #include <utility>
 
@@ -124,6 +128,9 @@ int WarpX::moving_window_dir = -1;
 Real WarpX::moving_window_v = std::numeric_limits<amrex::Real>::max();
 
 bool WarpX::fft_do_time_averaging = false;
+bool WarpX::fft_on_the_fly_coefficients = false;
+int WarpX::fft_max_batch_size = 1;
+bool WarpX::fft_single_precision = false;
 
 Real WarpX::quantum_xi_c2 = PhysConst::xi_c2;
 Real WarpX::gamma_boost = 1._rt;
@@ -189,11 +196,16 @@ Real WarpX::particle_slice_width_lab = 0.0_rt;
 bool WarpX::do_dynamic_scheduling = true;
 
 int WarpX::do_electrostatic;
+int WarpX::poisson_solver_id = PoissonSolverAlgo::Multigrid;
 Real WarpX::self_fields_required_precision = 1.e-11_rt;
 int WarpX::self_fields_max_iters = 200;
+Real WarpX::self_fields_beta_tolerance = 0._rt;
 
 int WarpX::do_subcycling = 0;
 bool WarpX::safe_guard_cells = 0;
+bool WarpX::pipeline_current_sum = false;
+bool WarpX::use_gpu_graph = false;
+bool WarpX::cold_fields_on_host = false;
 
 IntVect WarpX::filter_npass_each_dir(1);
 
@@ -202,7 +214,7 @@ int WarpX::n_current_deposition_buffer = -1;
 
 int WarpX::do_nodal = false;
 
-#ifdef AMREX_USE_GPU
+#if defined(AMREX_USE_GPU) && !defined(WARPX_USE_GPU_RANGES)
 bool WarpX::do_device_synchronize_before_profile = true;
 #else
 bool WarpX::do_device_synchronize_before_profile = false;
@@ -318,6 +330,12 @@ WarpX::WarpX ()
 
     Efield_cax.resize(nlevs_max);
     Bfield_cax.resize(nlevs_max);
+    Efield_aux_ctmp.resize(nlevs_max);
+    Bfield_aux_ctmp.resize(nlevs_max);
+    Efield_nci.resize(nlevs_max);
+    Bfield_nci.resize(nlevs_max);
+    Efield_nci_cax.resize(nlevs_max);
+    Bfield_nci_cax.resize(nlevs_max);
 #ifdef WARPX_MAG_LLG
     Mfield_cax.resize(nlevs_max);
     Hfield_cax.resize(nlevs_max);
@@ -385,6 +403,26 @@ WarpX::WarpX ()
         costs_heuristic_particles_wt = 0.9_rt;
 #endif // AMREX_USE_GPU
     }
+    if (em_solver_medium == MediumForEM::Macroscopic
+        && WarpX::load_balance_costs_update_algo==LoadBalanceCostsUpdateAlgo::Heuristic)
+    {
+        if (costs_heuristic_macroscopic_cells_wt < 0.) {
+            costs_heuristic_macroscopic_cells_wt = amrex::max(costs_heuristic_cells_wt, 0._rt);
+        }
+#ifdef WARPX_MAG_LLG
+        if (costs_heuristic_mag_cells_wt < 0.) {
+            costs_heuristic_mag_cells_wt = 3._rt*amrex::max(costs_heuristic_cells_wt, 0._rt);
+        }
+#endif
+    }
+    // The weights are fitted to the costs measured with the timers during the first steps,
+    // the defaults above are only used if the fit fails
+    if (costs_heuristic_calibration_steps > 0 && load_balance_intervals.isActivated()
+        && WarpX::load_balance_costs_update_algo==LoadBalanceCostsUpdateAlgo::Heuristic)
+    {
+        WarpX::load_balance_costs_update_algo = LoadBalanceCostsUpdateAlgo::Timers;
+        m_costs_calibration_steps_left = costs_heuristic_calibration_steps;
+    }
 
     // Allocate field solver objects
 #ifdef WARPX_USE_PSATD
@@ -487,6 +525,16 @@ WarpX::ReadParameters ()
         pp_warpx.query("do_subcycling", do_subcycling);
         pp_warpx.query("use_hybrid_QED", use_hybrid_QED);
         pp_warpx.query("safe_guard_cells", safe_guard_cells);
+        pp_warpx.query("pipeline_current_sum", pipeline_current_sum);
+        pp_warpx.query("use_gpu_graph", use_gpu_graph);
+        int persistent_exchange = 0;
+        pp_warpx.query("persistent_exchange", persistent_exchange);
+        PersistentExchange::Enable(persistent_exchange);
+        pp_warpx.query("cold_fields_on_host", cold_fields_on_host);
+#ifdef AMREX_USE_GPU
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!use_gpu_graph || Gpu::numGpuStreams() == 1,
+            "warpx.use_gpu_graph = 1 requires amrex.max_gpu_streams = 1");
+#endif
         std::vector<std::string> override_sync_intervals_string_vec = {"1"};
         pp_warpx.queryarr("override_sync_intervals", override_sync_intervals_string_vec);
         override_sync_intervals = IntervalsParser(override_sync_intervals_string_vec);
@@ -575,6 +623,17 @@ WarpX::ReadParameters ()
 
         do_electrostatic = GetAlgorithmInteger(pp_warpx, "do_electrostatic");
 
+        // (also used for the initialization of the self fields of the species)
+        poisson_solver_id = GetAlgorithmInteger(pp_warpx, "poisson_solver");
+        if (poisson_solver_id == PoissonSolverAlgo::FFT) {
+#if !defined(WARPX_USE_PSATD) || defined(WARPX_DIM_RZ)
+            amrex::Abort("warpx.poisson_solver = fft requires compiling with USE_PSATD=TRUE, "
+                         "in Cartesian geometry");
+#endif
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(maxLevel() == 0,
+                "warpx.poisson_solver = fft only works with a single level (max_level = 0)");
+        }
+
         if (do_electrostatic == ElectrostaticSolverAlgo::LabFrame) {
             queryWithParser(pp_warpx, "self_fields_required_precision", self_fields_required_precision);
             pp_warpx.query("self_fields_max_iters", self_fields_max_iters);
@@ -582,6 +641,10 @@ WarpX::ReadParameters ()
             // input for each species.
         }
 
+        queryWithParser(pp_warpx, "self_fields_beta_tolerance", self_fields_beta_tolerance);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(self_fields_beta_tolerance >= 0._rt,
+            "warpx.self_fields_beta_tolerance must be >= 0");
+
         pp_warpx.query("n_buffer", n_buffer);
         pp_warpx.query("const_dt", const_dt);
 
@@ -645,6 +708,7 @@ WarpX::ReadParameters ()
 
         pp_warpx.query("do_pml", do_pml);
         pp_warpx.query("do_silver_mueller", do_silver_mueller);
+        pp_warpx.query("do_silver_mueller_fused", do_silver_mueller_fused);
         if ( (do_pml==1)&&(do_silver_mueller==1) ) {
             amrex::Abort("PML and Silver-Mueller boundary conditions cannot be activated at the same time.");
         }
@@ -660,14 +724,57 @@ WarpX::ReadParameters ()
 #ifdef WARPX_MAG_LLG
         // Read the value of the time advancement scheme of M field
         pp_warpx.query("mag_time_scheme_order", mag_time_scheme_order);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_time_scheme_order >= 1 && mag_time_scheme_order <= 3,
+            "warpx.mag_time_scheme_order must be 1 (explicit), 2 (trapezoidal) or 3 (implicit midpoint)");
         // turn on LLG + Maxwell coupling
         pp_warpx.query("mag_LLG_coupling",mag_LLG_coupling);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_coupling == 0 || mag_LLG_coupling == 1,
+            "warpx.mag_LLG_coupling must be 0 or 1");
+        // number of Maxwell steps per LLG step (multi-rate time stepping)
+        pp_warpx.query("mag_LLG_multirate_ratio", mag_LLG_multirate_ratio);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_multirate_ratio >= 1,
+            "warpx.mag_LLG_multirate_ratio must be a positive integer");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_multirate_ratio == 1 || mag_time_scheme_order != 2,
+            "warpx.mag_LLG_multirate_ratio > 1 is only implemented for warpx.mag_time_scheme_order = 1 or 3");
+        // store M without guard cells
+        pp_warpx.query("mag_M_compact_storage", mag_M_compact_storage);
+        // evaluate H_bias in the LLG kernels instead of storing it
+        pp_warpx.query("mag_H_bias_on_the_fly", mag_H_bias_on_the_fly);
+        // magnetostatic mode: H is the demagnetizing field of M, computed with FFTs, and dt is warpx.const_dt
+        pp_warpx.query("mag_magnetostatic", mag_magnetostatic);
+        if (mag_magnetostatic) {
+#if !defined(WARPX_USE_PSATD) || (AMREX_SPACEDIM != 3)
+            amrex::Abort("warpx.mag_magnetostatic = 1 requires USE_PSATD=TRUE (for the FFT library) and DIM=3");
+#endif
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(maxLevel() == 0,
+                "warpx.mag_magnetostatic = 1 is only implemented for a single level");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_time_scheme_order != 2 && mag_LLG_multirate_ratio == 1,
+                "warpx.mag_magnetostatic = 1 is only implemented for warpx.mag_time_scheme_order = 1 or 3 and warpx.mag_LLG_multirate_ratio = 1");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_LLG_coupling == 1,
+                "warpx.mag_magnetostatic = 1 requires warpx.mag_LLG_coupling = 1");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(do_pml == 0 && do_electrostatic == ElectrostaticSolverAlgo::None,
+                "warpx.mag_magnetostatic = 1 is incompatible with PML and the electrostatic solver");
+        }
+        // adaptive time step of the magnetostatic mode
+        pp_warpx.query("mag_adaptive_dt", mag_adaptive_dt);
+        if (mag_adaptive_dt) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_magnetostatic,
+                "warpx.mag_adaptive_dt = 1 requires warpx.mag_magnetostatic = 1");
+            queryWithParser(pp_warpx, "mag_adaptive_dt_angle", mag_adaptive_dt_angle);
+            mag_adaptive_dt_min = 0.1_rt*const_dt;
+            mag_adaptive_dt_max = 10._rt*const_dt;
+            queryWithParser(pp_warpx, "mag_adaptive_dt_min", mag_adaptive_dt_min);
+            queryWithParser(pp_warpx, "mag_adaptive_dt_max", mag_adaptive_dt_max);
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_adaptive_dt_angle > 0._rt,
+                "warpx.mag_adaptive_dt_angle must be positive");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(0._rt < mag_adaptive_dt_min && mag_adaptive_dt_min <= mag_adaptive_dt_max,
+                "warpx.mag_adaptive_dt_min and warpx.mag_adaptive_dt_max must satisfy 0 < mag_adaptive_dt_min <= mag_adaptive_dt_max");
+        }
         // magnetization M magnitude normalization strategy
         pp_warpx.get("mag_M_normalization", mag_M_normalization);
-        if (mag_M_normalization < 0){
-            printf("mag_M_normalization = %d \n", mag_M_normalization);
-            amrex::Abort("Caution: mag_M_normalization must be a non-negative number !");
-        }
+        // the LLG kernels are compiled for each of the values 0, 1 and 2
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(mag_M_normalization >= 0 && mag_M_normalization <= 2,
+            "warpx.mag_M_normalization must be 0, 1 or 2");
 #endif
 
         Vector<int> parse_do_pml_Lo(AMREX_SPACEDIM,1);
@@ -714,10 +821,35 @@ WarpX::ReadParameters ()
 
         if (maxLevel() > 0) {
             Vector<Real> lo, hi;
-            pp_warpx.getarr("fine_tag_lo", lo);
-            pp_warpx.getarr("fine_tag_hi", hi);
-            fine_tag_lo = RealVect{lo};
-            fine_tag_hi = RealVect{hi};
+            if (pp_warpx.queryarr("fine_tag_lo", lo)) {
+                pp_warpx.getarr("fine_tag_hi", hi);
+                fine_tag_lo = RealVect{lo};
+                fine_tag_hi = RealVect{hi};
+                m_do_fine_tag_box = true;
+            }
+            // physical refinement criteria, evaluated at each regrid (see ErrorEst)
+            std::string str_tag_function;
+            if (pp_warpx.query("refine_tag_function(x,y,z,t,Ex,Ey,Ez,Bx,By,Bz)", str_tag_function)) {
+                Store_parserString(pp_warpx, "refine_tag_function(x,y,z,t,Ex,Ey,Ez,Bx,By,Bz)",
+                                   str_tag_function);
+                m_refine_tag_parser = std::make_unique<ParserWrapper<10>>(
+                    makeParser(str_tag_function, {"x","y","z","t","Ex","Ey","Ez","Bx","By","Bz"}));
+            }
+            if (queryWithParser(pp_warpx, "refine_tag_density", m_refine_tag_density)) {
+                pp_warpx.getarr("refine_tag_species", m_refine_tag_species);
+            }
+#ifdef WARPX_MAG_LLG
+            queryWithParser(pp_warpx, "refine_tag_M_gradient", m_refine_tag_M_gradient);
+#endif
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+                m_do_fine_tag_box || m_refine_tag_parser || m_refine_tag_density > 0._rt
+#ifdef WARPX_MAG_LLG
+                || m_refine_tag_M_gradient > 0._rt
+#endif
+                , "With mesh refinement, warpx.fine_tag_lo and warpx.fine_tag_hi or a warpx.refine_tag_* criterion must be given");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+                regrid_int <= 0 || maxwell_solver_id != MaxwellSolverAlgo::PSATD,
+                "warpx.regrid_int is not supported with the PSATD solver");
         }
 
         pp_warpx.query("do_dynamic_scheduling", do_dynamic_scheduling);
@@ -772,6 +904,46 @@ WarpX::ReadParameters ()
         em_solver_medium = GetAlgorithmInteger(pp_algo, "em_solver_medium");
         if (em_solver_medium == MediumForEM::Macroscopic ) {
             macroscopic_solver_algo = GetAlgorithmInteger(pp_algo,"macroscopic_sigma_method");
+            // the macroscopic solvers are called on the fine and coarse patches of all the levels
+            // in the time step without subcycling only
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(maxLevel() == 0 || do_subcycling == 0,
+                "algo.em_solver_medium = macroscopic with mesh refinement requires warpx.do_subcycling = 0");
+        }
+
+        pp_algo.query("fused_fdtd", do_fused_fdtd);
+        if (do_fused_fdtd) {
+#ifdef WARPX_MAG_LLG
+            amrex::Abort("algo.fused_fdtd = 1 is not implemented with the LLG solver (USE_LLG)");
+#endif
+#ifdef WARPX_DIM_RZ
+            amrex::Abort("algo.fused_fdtd = 1 is not implemented in RZ geometry");
+#endif
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+                (maxwell_solver_id == MaxwellSolverAlgo::Yee || maxwell_solver_id == MaxwellSolverAlgo::CKC)
+                && !do_nodal,
+                "algo.fused_fdtd = 1 requires algo.maxwell_solver = yee or ckc on a staggered grid");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(maxLevel() == 0 && do_electrostatic == ElectrostaticSolverAlgo::None,
+                "algo.fused_fdtd = 1 requires amr.max_level = 0 and warpx.do_electrostatic = none");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!do_pml && !do_silver_mueller && !do_dive_cleaning && !do_moving_window,
+                "algo.fused_fdtd = 1 is not implemented with warpx.do_pml, warpx.do_silver_mueller,"
+                " warpx.do_dive_cleaning or warpx.do_moving_window");
+        }
+
+        {
+            ParmParse pp_warpx("warpx");
+            pml_type = GetAlgorithmInteger(pp_warpx, "pml_type");
+        }
+        if (do_pml && pml_type == PMLType::Convolutional) {
+#ifdef WARPX_MAG_LLG
+            amrex::Abort("warpx.pml_type = cpml is not implemented with the LLG solver (USE_LLG)");
+#endif
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+                (maxwell_solver_id == MaxwellSolverAlgo::Yee || maxwell_solver_id == MaxwellSolverAlgo::CKC)
+                && !do_nodal,
+                "warpx.pml_type = cpml requires algo.maxwell_solver = yee or ckc on a staggered grid");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!do_dive_cleaning && !pml_has_particles && !do_moving_window,
+                "warpx.pml_type = cpml is not implemented with warpx.do_dive_cleaning,"
+                " warpx.pml_has_particles or warpx.do_moving_window");
         }
 
         // Load balancing parameters
@@ -782,9 +954,17 @@ WarpX::ReadParameters ()
         pp_algo.query("load_balance_knapsack_factor", load_balance_knapsack_factor);
         queryWithParser(pp_algo, "load_balance_efficiency_ratio_threshold",
                         load_balance_efficiency_ratio_threshold);
+        pp_algo.query("load_balance_hierarchical", load_balance_hierarchical);
+        queryWithParser(pp_algo, "load_balance_cost_per_byte", load_balance_cost_per_byte);
+        queryWithParser(pp_algo, "load_balance_intranode_factor", load_balance_intranode_factor);
         load_balance_costs_update_algo = GetAlgorithmInteger(pp_algo, "load_balance_costs_update");
         queryWithParser(pp_algo, "costs_heuristic_cells_wt", costs_heuristic_cells_wt);
         queryWithParser(pp_algo, "costs_heuristic_particles_wt", costs_heuristic_particles_wt);
+        queryWithParser(pp_algo, "costs_heuristic_macroscopic_cells_wt", costs_heuristic_macroscopic_cells_wt);
+#ifdef WARPX_MAG_LLG
+        queryWithParser(pp_algo, "costs_heuristic_mag_cells_wt", costs_heuristic_mag_cells_wt);
+#endif
+        pp_algo.query("costs_heuristic_calibration_steps", costs_heuristic_calibration_steps);
     }
     {
         ParmParse pp_interpolation("interpolation");
@@ -870,6 +1050,7 @@ WarpX::ReadParameters ()
     {
         ParmParse pp_psatd("psatd");
         pp_psatd.query("periodic_single_box_fft", fft_periodic_single_box);
+        pp_psatd.query("global_fft", fft_global);
         pp_psatd.query("fftw_plan_measure", fftw_plan_measure);
 
         std::string nox_str;
@@ -897,24 +1078,52 @@ WarpX::ReadParameters ()
         }
 
 
-        if (!fft_periodic_single_box) {
-            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(nox_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft is used");
-            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(noy_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft is used");
-            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(noz_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft is used");
+        if (fft_global) {
+#   ifdef WARPX_DIM_RZ
+            amrex::Abort("psatd.global_fft is not implemented in RZ geometry");
+#   endif
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!fft_periodic_single_box,
+                "psatd.global_fft and psatd.periodic_single_box_fft cannot be used together");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(Geom(0).isAllPeriodic() && maxLevel() == 0,
+                "psatd.global_fft can only be used for a periodic domain, without mesh refinement");
+        }
+
+        if (!fft_periodic_single_box && !fft_global) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(nox_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft or psatd.global_fft is used");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(noy_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft or psatd.global_fft is used");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(noz_fft > 0, "PSATD order must be finite unless psatd.periodic_single_box_fft or psatd.global_fft is used");
         }
 
         pp_psatd.query("current_correction", current_correction);
+        pp_psatd.query("reuse_rho_old", reuse_rho_old);
         pp_psatd.query("v_comoving", m_v_comoving);
         pp_psatd.query("do_time_averaging", fft_do_time_averaging);
+        pp_psatd.query("on_the_fly_coefficients", fft_on_the_fly_coefficients);
+        pp_psatd.query("fft_max_batch_size", fft_max_batch_size);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fft_max_batch_size >= 1,
+            "psatd.fft_max_batch_size must be at least 1");
+
+        std::string fft_precision = "double";
+        pp_psatd.query("fft_precision", fft_precision);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(fft_precision == "double" || fft_precision == "single",
+            "psatd.fft_precision must be double or single");
+        fft_single_precision = (fft_precision == "single");
+        if (fft_single_precision) {
+#   ifdef WARPX_DIM_RZ
+            amrex::Abort("psatd.fft_precision = single is not implemented in RZ geometry");
+#   endif
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!fft_global,
+                "psatd.fft_precision = single cannot be used with psatd.global_fft");
+        }
 
-        if (!fft_periodic_single_box && current_correction)
+        if (!fft_periodic_single_box && !fft_global && current_correction)
             amrex::Abort(
                     "\nCurrent correction does not guarantee charge conservation with local FFTs over guard cells:\n"
-                    "set psatd.periodic_single_box_fft=1 too, in order to guarantee charge conservation");
-        if (!fft_periodic_single_box && (WarpX::current_deposition_algo == CurrentDepositionAlgo::Vay))
+                    "set psatd.periodic_single_box_fft=1 or psatd.global_fft=1 too, in order to guarantee charge conservation");
+        if (!fft_periodic_single_box && !fft_global && (WarpX::current_deposition_algo == CurrentDepositionAlgo::Vay))
             amrex::Abort(
                     "\nVay current deposition does not guarantee charge conservation with local FFTs over guard cells:\n"
-                    "set psatd.periodic_single_box_fft=1 too, in order to guarantee charge conservation");
+                    "set psatd.periodic_single_box_fft=1 or psatd.global_fft=1 too, in order to guarantee charge conservation");
 
         // Check whether the default Galilean velocity should be used
         bool use_default_v_galilean = false;
@@ -964,11 +1173,29 @@ WarpX::ReadParameters ()
         // Overwrite update_with_rho with value set in input file
         pp_psatd.query("update_with_rho", update_with_rho);
 
+#   ifndef WARPX_DIM_RZ
+        // Filter J and rho in k space, in the PSATD push, instead of in real space
+        // (with RZ spectral, only k-space filtering is used)
+        bool kspace_filter = false;
+        pp_psatd.query("kspace_filter", kspace_filter);
+        if (kspace_filter) {
+            use_kspace_filter = use_filter;
+            use_filter = false;
+        }
+#   endif
+
         if (m_v_comoving[0] != 0. || m_v_comoving[1] != 0. || m_v_comoving[2] != 0.) {
             AMREX_ALWAYS_ASSERT_WITH_MESSAGE(update_with_rho,
                 "psatd.update_with_rho must be equal to 1 for comoving PSATD");
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!fft_on_the_fly_coefficients,
+                "psatd.on_the_fly_coefficients is not implemented for comoving PSATD");
         }
 
+#   ifdef WARPX_DIM_RZ
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!fft_on_the_fly_coefficients,
+            "psatd.on_the_fly_coefficients is not implemented in RZ geometry");
+#   endif
+
 #   ifdef WARPX_DIM_RZ
         if (!Geom(0).isPeriodic(1)) {
             use_damp_fields_in_z_guard = true;
@@ -1119,6 +1346,8 @@ WarpX::MakeNewLevelFromScratch (int lev, Real time, const BoxArray& new_grids,
 void
 WarpX::ClearLevel (int lev)
 {
+    m_gpu_graphs.clear();
+    PersistentExchange::Clear();
     for (int i = 0; i < 3; ++i) {
         Efield_aux[lev][i].reset();
         Bfield_aux[lev][i].reset();
@@ -1148,6 +1377,12 @@ WarpX::ClearLevel (int lev)
 #endif
         Efield_cax[lev][i].reset();
         Bfield_cax[lev][i].reset();
+        Efield_aux_ctmp[lev][i].reset();
+        Bfield_aux_ctmp[lev][i].reset();
+        Efield_nci[lev][i].reset();
+        Bfield_nci[lev][i].reset();
+        Efield_nci_cax[lev][i].reset();
+        Bfield_nci_cax[lev][i].reset();
 #ifdef WARPX_MAG_LLG
         Mfield_cax[lev][i].reset();
         Hfield_cax[lev][i].reset();
@@ -1167,6 +1402,7 @@ WarpX::ClearLevel (int lev)
     F_cp  [lev].reset();
     rho_cp[lev].reset();
 
+    BoxCostTimer::Flush();
     costs[lev].reset();
     load_balance_efficiency[lev] = -1;
 }
@@ -1199,14 +1435,16 @@ WarpX::AllocLevelData (int lev, const BoxArray& ba, const DistributionMapping& d
         do_moving_window,
         moving_window_dir,
         WarpX::nox,
-        nox_fft, noy_fft, noz_fft,
+        // The global FFT does not require guard cells for the stencil of the solver
+        fft_global ? 0 : nox_fft, fft_global ? 0 : noy_fft, fft_global ? 0 : noz_fft,
         NCIGodfreyFilter::m_stencil_width,
         maxwell_solver_id,
         maxLevel(),
         WarpX::m_v_galilean,
         WarpX::m_v_comoving,
         safe_guard_cells,
-        WarpX::do_electrostatic);
+        WarpX::do_electrostatic,
+        (do_fused_fdtd) ? int(FiniteDifferenceSolver::FusedHalo) : 0);
 
     if (mypc->nSpeciesDepositOnMainGrid() && n_current_deposition_buffer == 0) {
         n_current_deposition_buffer = 1;
@@ -1243,6 +1481,14 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
     IntVect rho_nodal_flag;
     IntVect phi_nodal_flag;
 
+#ifdef WARPX_MAG_LLG
+    // the LLG kernels only read M on the face they update, so that M needs no guard cells
+    // with the compact storage (warpx.mag_M_compact_storage = 1)
+    IntVect const ngM = (mag_M_compact_storage) ? IntVect::TheZeroVector() : guard_cells.ng_alloc_M;
+    // H may have fewer guard cells than E and B (see guardCellManager::ng_alloc_H)
+    IntVect const ngH = guard_cells.ng_alloc_H;
+#endif
+
     // Set nodal flags
 #if   (AMREX_SPACEDIM == 2)
     // AMReX convention: x = first dimension, y = missing dimension, z = second dimension
@@ -1361,17 +1607,19 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
     Bfield_fp_old[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,By_nodal_flag),dm,ncomps,ngE);
     Bfield_fp_old[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Bz_nodal_flag),dm,ncomps,ngE);
     // each Mfield[] is three components
-    Mfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngE);
-    Mfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngE);
-    Mfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngE);
+    Mfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngM);
+    Mfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngM);
+    Mfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngM);
 
-    Hfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngE);
-    Hfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngE);
-    Hfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngE);
+    Hfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngH);
+    Hfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngH);
+    Hfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngH);
 
-    H_biasfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngE);
-    H_biasfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngE);
-    H_biasfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngE);
+    if (!mag_H_bias_on_the_fly) {
+        H_biasfield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngH);
+        H_biasfield_fp[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngH);
+        H_biasfield_fp[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngH);
+    }
 #endif
 
     Efield_fp[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Ex_nodal_flag),dm,ncomps,ngE,tag("Efield_fp[x]"));
@@ -1425,11 +1673,6 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
             "WarpX::AllocLevelMFs: PSATD solver requires WarpX build with spectral solver support.");
 #else
 
-#   if (AMREX_SPACEDIM == 3)
-        RealVect dx_vect(dx[0], dx[1], dx[2]);
-#   elif (AMREX_SPACEDIM == 2)
-        RealVect dx_vect(dx[0], dx[2]);
-#   endif
         // Check whether the option periodic, single box is valid here
         if (fft_periodic_single_box) {
 #   ifdef WARPX_DIM_RZ
@@ -1444,32 +1687,16 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
                 "The option `psatd.periodic_single_box_fft` can only be used for a periodic domain, decomposed in a single box");
 #   endif
         }
-        // Get the cell-centered box
-        BoxArray realspace_ba = ba;  // Copy box
-        realspace_ba.enclosedCells(); // Make it cell-centered
         // Define spectral solver
-#   ifdef WARPX_DIM_RZ
-        if ( fft_periodic_single_box == false ) {
-            realspace_ba.grow(1, ngE[1]); // add guard cells only in z
-        }
-        spectral_solver_fp[lev] = std::make_unique<SpectralSolverRZ>( lev, realspace_ba, dm,
-            n_rz_azimuthal_modes, noz_fft, do_nodal, m_v_galilean, dx_vect, dt[lev], update_with_rho );
-        if (use_kspace_filter) {
-            spectral_solver_fp[lev]->InitFilter(filter_npass_each_dir, use_filter_compensation);
-        }
-#   else
-        if ( fft_periodic_single_box == false ) {
-            realspace_ba.grow(ngE); // add guard cells
-        }
-        bool const pml_flag_false = false;
-        spectral_solver_fp[lev] = std::make_unique<SpectralSolver>( lev, realspace_ba, dm,
-            nox_fft, noy_fft, noz_fft, do_nodal, m_v_galilean, m_v_comoving, dx_vect, dt[lev],
-            pml_flag_false, fft_periodic_single_box, update_with_rho, fft_do_time_averaging );
-#   endif
+        AllocLevelSpectralSolver(lev, PatchType::fine, ba, dm, dx);
 #endif
     } // MaxwellSolverAlgo::PSATD
     else {
         m_fdtd_solver_fp[lev] = std::make_unique<FiniteDifferenceSolver>(maxwell_solver_id, dx, do_nodal);
+#ifdef AMREX_USE_EB
+        // The coarse patch does not use the embedded boundary
+        m_fdtd_solver_fp[lev]->SetEB(fieldEBFactory(lev));
+#endif
     }
 
     //
@@ -1481,17 +1708,19 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         BoxArray const nba = amrex::convert(ba,IntVect::TheNodeVector());
 
 #ifdef WARPX_MAG_LLG
-        Mfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,3     ,ngE);
-        Mfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,3     ,ngE);
-        Mfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,3     ,ngE);
-
-        Hfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE);
-        Hfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE);
-        Hfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE);
-
-        H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE);
-        H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE);
-        H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE);
+        Mfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,3     ,ngM);
+        Mfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,3     ,ngM);
+        Mfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,3     ,ngM);
+
+        Hfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngH);
+        Hfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngH);
+        Hfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,ncomps,ngH);
+
+        if (!mag_H_bias_on_the_fly) {
+            H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngH);
+            H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngH);
+            H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(nba,dm,ncomps,ngH);
+        }
 #endif
         Bfield_aux[lev][0] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE,tag("Bfield_aux[x]"));
         Bfield_aux[lev][1] = std::make_unique<MultiFab>(nba,dm,ncomps,ngE,tag("Bfield_aux[y]"));
@@ -1513,7 +1742,9 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
     {
         for (int idir = 0; idir < 3; ++idir) {
 #ifdef WARPX_MAG_LLG
-            H_biasfield_aux[lev][idir] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][idir], amrex::make_alias, 0, ncomps);
+            if (H_biasfield_fp[lev][idir]) {
+                H_biasfield_aux[lev][idir] = std::make_unique<MultiFab>(*H_biasfield_fp[lev][idir], amrex::make_alias, 0, ncomps);
+            }
             Hfield_aux[lev][idir] = std::make_unique<MultiFab>(*Hfield_fp[lev][idir], amrex::make_alias, 0, ncomps);
             Mfield_aux[lev][idir] = std::make_unique<MultiFab>(*Mfield_fp[lev][idir], amrex::make_alias, 0, 3);
 #endif
@@ -1540,17 +1771,19 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         Bfield_avg_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Bz_nodal_flag),dm,ncomps,ngE,tag("Bfield_avg_aux[z]"));
 
 #ifdef WARPX_MAG_LLG
-        Mfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngE);
-        Mfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngE);
-        Mfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngE);
-
-        Hfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngE);
-        Hfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngE);
-        Hfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngE);
-
-        H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngE);
-        H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngE);
-        H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngE);
+        Mfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Mx_nodal_flag),dm,3     ,ngM);
+        Mfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,My_nodal_flag),dm,3     ,ngM);
+        Mfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Mz_nodal_flag),dm,3     ,ngM);
+
+        Hfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_nodal_flag),dm,ncomps,ngH);
+        Hfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_nodal_flag),dm,ncomps,ngH);
+        Hfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_nodal_flag),dm,ncomps,ngH);
+
+        if (!mag_H_bias_on_the_fly) {
+            H_biasfield_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Hx_bias_nodal_flag),dm,ncomps,ngH);
+            H_biasfield_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Hy_bias_nodal_flag),dm,ncomps,ngH);
+            H_biasfield_aux[lev][2] = std::make_unique<MultiFab>(amrex::convert(ba,Hz_bias_nodal_flag),dm,ncomps,ngH);
+        }
 #endif
         Efield_avg_aux[lev][0] = std::make_unique<MultiFab>(amrex::convert(ba,Ex_nodal_flag),dm,ncomps,ngE,tag("Efield_avg_aux[x]"));
         Efield_avg_aux[lev][1] = std::make_unique<MultiFab>(amrex::convert(ba,Ey_nodal_flag),dm,ncomps,ngE,tag("Efield_avg_aux[y]"));
@@ -1568,19 +1801,21 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
 
 #ifdef WARPX_MAG_LLG
     // Create the MultiFabs for M
-        Mfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngE);
-        Mfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngE);
-        Mfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngE);
+        Mfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngM);
+        Mfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngM);
+        Mfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngM);
 
         // Create the MultiFabs for H
-        Hfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngE);
-        Hfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngE);
-        Hfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngE);
+        Hfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngH);
+        Hfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngH);
+        Hfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngH);
 
         // Create the MultiFabs for H_bias
-        H_biasfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngE);
-        H_biasfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngE);
-        H_biasfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngE);
+        if (!mag_H_bias_on_the_fly) {
+            H_biasfield_cp[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngE);
+            H_biasfield_cp[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngE);
+            H_biasfield_cp[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngE);
+        }
 
 #endif
 
@@ -1624,29 +1859,8 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
                 "WarpX::AllocLevelMFs: PSATD solver requires WarpX build with spectral solver support.");
 #else
 
-#   if (AMREX_SPACEDIM == 3)
-            RealVect cdx_vect(cdx[0], cdx[1], cdx[2]);
-#   elif (AMREX_SPACEDIM == 2)
-            RealVect cdx_vect(cdx[0], cdx[2]);
-#   endif
-            // Get the cell-centered box, with guard cells
-            BoxArray c_realspace_ba = cba;// Copy box
-            c_realspace_ba.enclosedCells(); // Make it cell-centered
             // Define spectral solver
-#   ifdef WARPX_DIM_RZ
-            c_realspace_ba.grow(1, ngE[1]); // add guard cells only in z
-            spectral_solver_cp[lev] = std::make_unique<SpectralSolverRZ>( lev, c_realspace_ba, dm,
-                n_rz_azimuthal_modes, noz_fft, do_nodal, m_v_galilean, cdx_vect, dt[lev], update_with_rho );
-            if (use_kspace_filter) {
-                spectral_solver_cp[lev]->InitFilter(filter_npass_each_dir, use_filter_compensation);
-            }
-#   else
-            c_realspace_ba.grow(ngE); // add guard cells
-            bool const pml_flag_false = false;
-            spectral_solver_cp[lev] = std::make_unique<SpectralSolver>( lev, c_realspace_ba, dm,
-                nox_fft, noy_fft, noz_fft, do_nodal, m_v_galilean, m_v_comoving, cdx_vect, dt[lev],
-                pml_flag_false, fft_periodic_single_box, update_with_rho, fft_do_time_averaging );
-#   endif
+            AllocLevelSpectralSolver(lev, PatchType::coarse, cba, dm, cdx);
 #endif
         } // MaxwellSolverAlgo::PSATD
         else {
@@ -1668,15 +1882,17 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
             if (aux_is_nodal) {
                 BoxArray const& cnba = amrex::convert(cba,IntVect::TheNodeVector());
 #ifdef WARPX_MAG_LLG
-                Mfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,3     ,ngE);
-                Mfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,3     ,ngE);
-                Mfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,3     ,ngE);
-                Hfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
-                Hfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
-                Hfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
-                H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
-                H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
-                H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
+                Mfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,3     ,ngM);
+                Mfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,3     ,ngM);
+                Mfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,3     ,ngM);
+                Hfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngH);
+                Hfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngH);
+                Hfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngH);
+                if (!mag_H_bias_on_the_fly) {
+                    H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
+                    H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
+                    H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE);
+                }
 #endif
                 Bfield_cax[lev][0] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE,tag("Bfield_cax[x]"));
                 Bfield_cax[lev][1] = std::make_unique<MultiFab>(cnba,dm,ncomps,ngE,tag("Bfield_cax[y]"));
@@ -1692,19 +1908,21 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
 
 #ifdef WARPX_MAG_LLG
                 // Create the MultiFabs for M
-                Mfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngE);
-                Mfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngE);
-                Mfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngE);
+                Mfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Mx_nodal_flag),dm,3     ,ngM);
+                Mfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,My_nodal_flag),dm,3     ,ngM);
+                Mfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Mz_nodal_flag),dm,3     ,ngM);
 
                 // Create the MultiFabs for H
-                Hfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngE);
-                Hfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngE);
-                Hfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngE);
+                Hfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_nodal_flag),dm,ncomps,ngH);
+                Hfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_nodal_flag),dm,ncomps,ngH);
+                Hfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_nodal_flag),dm,ncomps,ngH);
 
                 // Create the MultiFabs for H_bias
-                H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngE);
-                H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngE);
-                H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngE);
+                if (!mag_H_bias_on_the_fly) {
+                    H_biasfield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Hx_bias_nodal_flag),dm,ncomps,ngE);
+                    H_biasfield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Hy_bias_nodal_flag),dm,ncomps,ngE);
+                    H_biasfield_cax[lev][2] = std::make_unique<MultiFab>(amrex::convert(cba,Hz_bias_nodal_flag),dm,ncomps,ngE);
+                }
 #endif
                 Efield_cax[lev][0] = std::make_unique<MultiFab>(amrex::convert(cba,Ex_nodal_flag),dm,ncomps,ngE,tag("Efield_cax[x]"));
                 Efield_cax[lev][1] = std::make_unique<MultiFab>(amrex::convert(cba,Ey_nodal_flag),dm,ncomps,ngE,tag("Efield_cax[y]"));
@@ -1734,8 +1952,124 @@ WarpX::AllocLevelMFs (int lev, const BoxArray& ba, const DistributionMapping& dm
         costs[lev] = std::make_unique<LayoutData<Real>>(ba, dm);
         load_balance_efficiency[lev] = -1;
     }
+
+#if defined(AMREX_USE_OMP) && !defined(AMREX_USE_GPU)
+    FirstTouchLevelMFs(lev);
+#endif
 }
 
+void
+WarpX::FirstTouchLevelMFs (int lev)
+{
+    using WarpXUtilMemory::FirstTouch;
+    auto touch_vector = [&] (amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>>& v) {
+        if (lev >= static_cast<int>(v.size())) return;
+        for (auto& mf : v[lev]) FirstTouch(mf.get());
+    };
+    auto touch_scalar = [&] (amrex::Vector<std::unique_ptr<amrex::MultiFab>>& v) {
+        if (lev < static_cast<int>(v.size())) FirstTouch(v[lev].get());
+    };
+
+    touch_vector(Efield_fp);
+    touch_vector(Bfield_fp);
+    touch_vector(current_fp);
+    touch_vector(current_store);
+    touch_vector(Efield_avg_fp);
+    touch_vector(Bfield_avg_fp);
+    touch_vector(Efield_excitation_profile);
+    touch_vector(Bfield_excitation_profile);
+    touch_scalar(rho_fp);
+    touch_scalar(F_fp);
+    touch_scalar(phi_fp);
+
+#ifdef WARPX_MAG_LLG
+    touch_vector(Mfield_fp);
+    touch_vector(Hfield_fp);
+    touch_vector(H_biasfield_fp);
+    touch_vector(Bfield_fp_old);
+    touch_vector(Hfield_excitation_profile);
+    touch_vector(Mfield_cp);
+    touch_vector(Hfield_cp);
+    touch_vector(H_biasfield_cp);
+    touch_vector(Mfield_aux);
+    touch_vector(Hfield_aux);
+    touch_vector(H_biasfield_aux);
+    touch_vector(Mfield_cax);
+    touch_vector(Hfield_cax);
+    touch_vector(H_biasfield_cax);
+#endif
+
+    // the aux fields aliasing the fine patch are zeroed again, which does not move their pages
+    touch_vector(Efield_aux);
+    touch_vector(Bfield_aux);
+    touch_vector(Efield_avg_aux);
+    touch_vector(Bfield_avg_aux);
+    touch_vector(Efield_nci);
+    touch_vector(Bfield_nci);
+
+    touch_vector(Efield_cp);
+    touch_vector(Bfield_cp);
+    touch_vector(current_cp);
+    touch_vector(Efield_avg_cp);
+    touch_vector(Bfield_avg_cp);
+    touch_vector(Efield_cax);
+    touch_vector(Bfield_cax);
+    touch_vector(Efield_aux_ctmp);
+    touch_vector(Bfield_aux_ctmp);
+    touch_vector(Efield_nci_cax);
+    touch_vector(Bfield_nci_cax);
+    touch_vector(current_buf);
+    touch_scalar(rho_cp);
+    touch_scalar(F_cp);
+    touch_scalar(charge_buf);
+}
+
+#ifdef WARPX_USE_PSATD
+void
+WarpX::AllocLevelSpectralSolver (int lev, PatchType patch_type, const BoxArray& ba,
+                                 const DistributionMapping& dm, const std::array<Real,3>& dx)
+{
+#   if (AMREX_SPACEDIM == 3)
+    RealVect dx_vect(dx[0], dx[1], dx[2]);
+#   elif (AMREX_SPACEDIM == 2)
+    RealVect dx_vect(dx[0], dx[2]);
+#   endif
+    const IntVect ngE = getngE();
+    // Only the fine patch can be a single periodic box, without guard cells
+    const bool add_guard_cells = (patch_type == PatchType::coarse) ||
+        (fft_periodic_single_box == false && fft_global == false);
+
+    // Get the cell-centered box
+    BoxArray realspace_ba = ba;  // Copy box
+    realspace_ba.enclosedCells(); // Make it cell-centered
+
+    auto& spectral_solver = (patch_type == PatchType::fine) ? spectral_solver_fp[lev]
+                                                            : spectral_solver_cp[lev];
+#   ifdef WARPX_DIM_RZ
+    if (add_guard_cells) {
+        realspace_ba.grow(1, ngE[1]); // add guard cells only in z
+    }
+    spectral_solver = std::make_unique<SpectralSolverRZ>( lev, realspace_ba, dm,
+        n_rz_azimuthal_modes, noz_fft, do_nodal, m_v_galilean, dx_vect, dt[lev], update_with_rho );
+    if (use_kspace_filter) {
+        spectral_solver->InitFilter(filter_npass_each_dir, use_filter_compensation);
+    }
+#   else
+    if (add_guard_cells) {
+        realspace_ba.grow(ngE); // add guard cells
+    }
+    bool const pml_flag_false = false;
+    spectral_solver = std::make_unique<SpectralSolver>( lev, realspace_ba, dm,
+        nox_fft, noy_fft, noz_fft, do_nodal, m_v_galilean, m_v_comoving, dx_vect, dt[lev],
+        pml_flag_false, fft_periodic_single_box, update_with_rho, fft_do_time_averaging,
+        fft_on_the_fly_coefficients, fft_global );
+    if (use_kspace_filter) {
+        spectral_solver->InitFilter(filter_npass_each_dir, use_filter_compensation);
+    }
+#   endif
+}
+#endif
+
 std::array<Real,3>
 WarpX::CellSize (int lev)
 {
@@ -1931,6 +2265,114 @@ WarpX::getCosts (int lev)
     }
 }
 
+amrex::Vector<std::string>
+WarpX::MemoryCategoryNames ()
+{
+    return {"fields", "magnetization", "aux", "coarse_patch", "pml",
+            "macroscopic", "spectral", "diagnostics"};
+}
+
+amrex::Vector<amrex::Long>
+WarpX::MemoryBytes (int lev) const
+{
+    using WarpXUtilMemory::FabArrayBytes;
+    enum { fields=0, magnetization, aux, coarse_patch, pml_data, macroscopic, spectral,
+           diagnostics, ncategories };
+    amrex::Vector<amrex::Long> nbytes(ncategories, 0);
+    // data of the FABs already counted, so that the aliases (e.g. aux of the fine patch) are not
+    std::set<void const*> counted;
+    auto add = [&] (int category, auto const* mf) {
+        nbytes[category] += FabArrayBytes(mf, &counted);
+    };
+    auto add_vector = [&] (int category,
+                           amrex::Vector<std::array<std::unique_ptr<amrex::MultiFab>,3>> const& v) {
+        if (lev >= static_cast<int>(v.size())) return;
+        for (auto const& mf : v[lev]) add(category, mf.get());
+    };
+    auto add_scalar = [&] (int category, amrex::Vector<std::unique_ptr<amrex::MultiFab>> const& v) {
+        if (lev < static_cast<int>(v.size())) add(category, v[lev].get());
+    };
+
+    // fine patch first, so that the aliases in the other categories are not counted
+    add_vector(fields, Efield_fp);
+    add_vector(fields, Bfield_fp);
+    add_vector(fields, current_fp);
+    add_vector(fields, current_store);
+    add_vector(fields, Efield_avg_fp);
+    add_vector(fields, Bfield_avg_fp);
+    add_vector(fields, Efield_excitation_profile);
+    add_vector(fields, Bfield_excitation_profile);
+    add_scalar(fields, rho_fp);
+    add_scalar(fields, F_fp);
+    add_scalar(fields, phi_fp);
+
+#ifdef WARPX_MAG_LLG
+    add_vector(magnetization, Mfield_fp);
+    add_vector(magnetization, Hfield_fp);
+    add_vector(magnetization, H_biasfield_fp);
+    add_vector(magnetization, Bfield_fp_old);
+    add_vector(magnetization, Hfield_excitation_profile);
+    add_vector(magnetization, Mfield_cp);
+    add_vector(magnetization, Hfield_cp);
+    add_vector(magnetization, H_biasfield_cp);
+    add_vector(magnetization, Mfield_aux);
+    add_vector(magnetization, Hfield_aux);
+    add_vector(magnetization, H_biasfield_aux);
+    add_vector(magnetization, Mfield_cax);
+    add_vector(magnetization, Hfield_cax);
+    add_vector(magnetization, H_biasfield_cax);
+    if (lev < static_cast<int>(m_fdtd_solver_fp.size()) && m_fdtd_solver_fp[lev]) {
+        nbytes[magnetization] += m_fdtd_solver_fp[lev]->LLGScratchBytes();
+    }
+#endif
+
+    add_vector(aux, Efield_aux);
+    add_vector(aux, Bfield_aux);
+    add_vector(aux, Efield_avg_aux);
+    add_vector(aux, Bfield_avg_aux);
+    add_vector(aux, Efield_nci);
+    add_vector(aux, Bfield_nci);
+
+    add_vector(coarse_patch, Efield_cp);
+    add_vector(coarse_patch, Bfield_cp);
+    add_vector(coarse_patch, current_cp);
+    add_vector(coarse_patch, Efield_avg_cp);
+    add_vector(coarse_patch, Bfield_avg_cp);
+    add_vector(coarse_patch, Efield_cax);
+    add_vector(coarse_patch, Bfield_cax);
+    add_vector(coarse_patch, Efield_aux_ctmp);
+    add_vector(coarse_patch, Bfield_aux_ctmp);
+    add_vector(coarse_patch, Efield_nci_cax);
+    add_vector(coarse_patch, Bfield_nci_cax);
+    add_vector(coarse_patch, current_buf);
+    add_scalar(coarse_patch, rho_cp);
+    add_scalar(coarse_patch, F_cp);
+    add_scalar(coarse_patch, charge_buf);
+    if (lev < static_cast<int>(current_buffer_masks.size())) {
+        add(coarse_patch, current_buffer_masks[lev].get());
+        add(coarse_patch, gather_buffer_masks[lev].get());
+    }
+
+    if (do_pml && lev < static_cast<int>(pml.size()) && pml[lev]) {
+        nbytes[pml_data] = pml[lev]->MemoryBytes();
+    }
+
+    if (m_macroscopic_properties) {
+        nbytes[macroscopic] = m_macroscopic_properties->MemoryBytes(lev);
+    }
+
+#if defined(WARPX_USE_PSATD) && !defined(WARPX_DIM_RZ)
+    if (lev < static_cast<int>(spectral_solver_fp.size())) {
+        if (spectral_solver_fp[lev]) nbytes[spectral] += spectral_solver_fp[lev]->MemoryBytes();
+        if (spectral_solver_cp[lev]) nbytes[spectral] += spectral_solver_cp[lev]->MemoryBytes();
+    }
+#endif
+
+    if (multi_diags) nbytes[diagnostics] = multi_diags->MemoryBytes(lev);
+
+    return nbytes;
+}
+
 void
 WarpX::BuildBufferMasks ()
 {
@@ -2083,3 +2525,53 @@ WarpX::PicsarVersion ()
 #endif
 }
 
+const amrex::MultiFab&
+WarpX::GetDiagnosticChargeDensity (int lev, int species_index)
+{
+    WARPX_PROFILE("WarpX::GetDiagnosticChargeDensity()");
+
+    if (static_cast<int>(m_diag_rho.size()) <= lev) m_diag_rho.resize(lev+1);
+    DiagnosticChargeDensity& diag_rho = m_diag_rho[lev][species_index];
+
+    const bool same_grids = diag_rho.rho &&
+        diag_rho.ba == boxArray(lev) && diag_rho.dm == DistributionMap(lev);
+
+    // Already deposited at this step, by another diagnostic
+    if (same_grids && diag_rho.step == istep[lev] && diag_rho.time == t_new[lev]) {
+        return *diag_rho.rho;
+    }
+
+    if (!same_grids) {
+        diag_rho.rho = mypc->MakeChargeDensity(lev);
+        diag_rho.ba = boxArray(lev);
+        diag_rho.dm = DistributionMap(lev);
+    }
+    MultiFab& rho = *diag_rho.rho;
+
+    // The guard cells are summed by ApplyFilterandSumBoundaryRho
+    rho.setVal(0.);
+    if (species_index == -1) {
+        mypc->AddChargeDensity(rho, lev);
+    } else {
+        mypc->GetParticleContainer(species_index).AddChargeDensity(rho, lev);
+    }
+#ifdef WARPX_DIM_RZ
+    ApplyInverseVolumeScalingToChargeDensity(&rho, lev);
+#endif
+
+    ApplyFilterandSumBoundaryRho(lev, lev, rho, 0, rho.nComp());
+
+#ifdef WARPX_USE_PSATD
+    using Idx = SpectralAvgFieldIndex;
+    if (WarpX::use_kspace_filter) {
+        auto & solver = get_spectral_solver_fp(lev);
+        solver.ForwardTransform(lev, rho, Idx::rho_new);
+        solver.ApplyFilter(Idx::rho_new);
+        solver.BackwardTransform(lev, rho, Idx::rho_new);
+    }
+#endif
+
+    diag_rho.step = istep[lev];
+    diag_rho.time = t_new[lev];
+    return rho;
+}
@@ -8,6 +8,9 @@
  */
 #include "WarpX.H"
 #include "Initialization/WarpXAMReXInit.H"
+#include "Utils/Autotune.H"
+#include "Utils/CommBenchmark.H"
+#include "Utils/HardwareCounters.H"
 #include "Utils/MPIInitHelpers.H"
 #include "Utils/WarpXUtil.H"
 #include "Utils/WarpXProfilerWrapper.H"
@@ -26,10 +29,20 @@ int main(int argc, char* argv[])
 
     auto mpi_thread_levels = utils::warpx_mpi_init(argc, argv);
 
-    warpx_amrex_init(argc, argv);
+    auto const ensemble = utils::warpx_ensemble_init(argc, argv);
+
+    warpx_amrex_init(argc, argv, true, ensemble.first);
+
+    if (ensemble.second >= 0) {
+        Print() << "Ensemble run: member " << ensemble.second << "\n";
+    }
 
     utils::warpx_check_mpi_thread_level(mpi_thread_levels);
 
+    utils::warpx_bind_threads();
+
+    HardwareCounterRegion::Initialize();
+
 #if defined(AMREX_USE_HIP) && defined(WARPX_USE_PSATD)
     rocfft_setup();
 #endif
@@ -43,8 +56,12 @@ int main(int argc, char* argv[])
 
     WARPX_PROFILE_VAR("main()", pmain);
 
+    bool run_simulation = utils::warpx_autotune();
+    run_simulation = utils::warpx_comm_benchmark() && run_simulation;
+
     const auto strt_total = static_cast<Real>(amrex::second());
 
+    if (run_simulation)
     {
         WarpX warpx;
 
@@ -61,6 +78,8 @@ int main(int argc, char* argv[])
 
     WARPX_PROFILE_VAR_STOP(pmain);
 
+    HardwareCounterRegion::Finalize();
+
 #if defined(AMREX_USE_HIP) && defined(WARPX_USE_PSATD)
     rocfft_cleanup();
 #endif
@@ -0,0 +1,237 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "WarpX.H"
+#include "FieldSolver/FiniteDifferenceSolver/FiniteDifferenceSolver.H"
+#include "FieldSolver/FiniteDifferenceSolver/MacroscopicProperties/MacroscopicProperties.H"
+#include "Initialization/WarpXAMReXInit.H"
+#include "Utils/MPIInitHelpers.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+/**
+ * Micro-benchmark of the field kernels of the FDTD solver, without particles or diagnostics.
+ *
+ * The grid and the fields are set up by WarpX::InitData from a regular input deck (see
+ * Tools/PerformanceTests/KernelBenchmark/inputs_3d), so that the box sizes are set with
+ * amr.n_cell and amr.max_grid_size. Each kernel of bench.kernels is called bench.n_warmup
+ * times, then timed over bench.n_iter calls, and its throughput is reported in cells/s and
+ * in GB/s. The memory traffic is estimated with a compulsory-traffic model: each field point
+ * that is read or written by the kernel is counted once per access, the material properties
+ * are counted once per updated edge or face, and the reuse of the stencil neighbours in the
+ * caches is assumed to be perfect.
+ */
+namespace
+{
+    /** number of Reals stored in the valid points of mf, on all ranks */
+    amrex::Long ValidPoints (amrex::MultiFab const& mf)
+    {
+        return mf.boxArray().numPts() * mf.nComp();
+    }
+
+    /** sum of ValidPoints over the three components of a field on level 0 */
+    amrex::Long FieldPoints (std::function<amrex::MultiFab const& (int)> const& field)
+    {
+        amrex::Long n = 0;
+        for (int idim = 0; idim < 3; ++idim) n += ValidPoints(field(idim));
+        return n;
+    }
+
+    struct Kernel
+    {
+        std::string name;
+        std::function<void (amrex::Real)> run;
+        // estimated number of bytes moved by one call
+        std::function<double ()> bytes;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace amrex;
+
+    auto mpi_thread_levels = utils::warpx_mpi_init(argc, argv);
+
+    warpx_amrex_init(argc, argv);
+
+    utils::warpx_check_mpi_thread_level(mpi_thread_levels);
+
+    ConvertLabParamsToBoost();
+    ReadBCParams();
+
+    {
+        WarpX warpx;
+
+        warpx.InitData();
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(WarpX::maxwell_solver_id != MaxwellSolverAlgo::PSATD,
+            "the kernel benchmark requires a finite-difference Maxwell solver (algo.maxwell_solver = yee or ckc)");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(warpx.finestLevel() == 0,
+            "the kernel benchmark runs on a single level (amr.max_level = 0)");
+
+        int n_iter = 10;
+        int n_warmup = 2;
+        std::vector<std::string> kernel_names;
+        ParmParse pp_bench("bench");
+        pp_bench.query("n_iter", n_iter);
+        pp_bench.query("n_warmup", n_warmup);
+        pp_bench.queryarr("kernels", kernel_names);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n_iter > 0 && n_warmup >= 0,
+            "bench.n_iter must be > 0 and bench.n_warmup >= 0");
+
+        double const real_bytes = sizeof(Real);
+        auto E = [&warpx] (int idim) -> MultiFab const& { return warpx.getEfield_fp(0, idim); };
+        auto B = [&warpx] (int idim) -> MultiFab const& { return warpx.getBfield_fp(0, idim); };
+        auto J = [&warpx] (int idim) -> MultiFab const& { return warpx.getcurrent_fp(0, idim); };
+#ifdef WARPX_MAG_LLG
+        auto H = [&warpx] (int idim) -> MultiFab const& { return warpx.getHfield_fp(0, idim); };
+        auto M = [&warpx] (int idim) -> MultiFab const& { return warpx.getMfield_fp(0, idim); };
+        auto H_bias = [&warpx] (int idim) -> MultiFab const& { return *warpx.get_pointer_H_biasfield_fp(0, idim); };
+        // iterations of the 2nd-order LLG scheme, to estimate its memory traffic per call
+        amrex::Long llg_iter_before = 0;
+        int llg_calls = 0;
+#endif
+
+        // all kernels available in this build and for this medium
+        std::vector<Kernel> kernels;
+        kernels.push_back({"EvolveB",
+            [&warpx] (Real dt) { warpx.EvolveB(dt); },
+            [=] () { return real_bytes * (FieldPoints(E) + 2 * FieldPoints(B)); }});
+        kernels.push_back({"EvolveE",
+            [&warpx] (Real dt) { warpx.EvolveE(dt); },
+            [=] () { return real_bytes * (2 * FieldPoints(E) + FieldPoints(B) + FieldPoints(J)); }});
+        if (WarpX::em_solver_medium == MediumForEM::Macroscopic) {
+            auto macro_E_bytes = [=, &warpx] () {
+#ifdef WARPX_MAG_LLG
+                amrex::Long const curl_points = FieldPoints(H);
+                int const n_props = 2; // sigma, epsilon
+#else
+                amrex::Long const curl_points = FieldPoints(B);
+                int const n_props = 3; // sigma, epsilon, mu
+#endif
+                // number of coefficients read per updated edge
+                int const n_coefs = (warpx.GetMacroscopicProperties().getprecompute_E_coefs()) ? 2 : n_props;
+                amrex::Long const edges = FieldPoints(E);
+                return real_bytes * (2 * edges + curl_points + FieldPoints(J) + n_coefs * edges);
+            };
+            kernels.push_back({"MacroscopicEvolveE_LaxWendroff",
+                [&warpx] (Real dt) {
+                    WarpX::macroscopic_solver_algo = MacroscopicSolverAlgo::LaxWendroff;
+                    warpx.MacroscopicEvolveE(dt);
+                },
+                macro_E_bytes});
+            kernels.push_back({"MacroscopicEvolveE_BackwardEuler",
+                [&warpx] (Real dt) {
+                    WarpX::macroscopic_solver_algo = MacroscopicSolverAlgo::BackwardEuler;
+                    warpx.MacroscopicEvolveE(dt);
+                },
+                macro_E_bytes});
+#ifdef WARPX_MAG_LLG
+            // sweep of the update of M: M is read and written, H_bias is read, and Ms, alpha and gamma
+            // are read on each face (as many Reals as M); the update of H then reads and writes H,
+            // reads E and writes B
+            auto llg_sweep_points = [=] () {
+                return 2 * FieldPoints(M) + FieldPoints(H_bias) + FieldPoints(M);
+            };
+            kernels.push_back({"MacroscopicEvolveHM",
+                [&warpx] (Real dt) { warpx.MacroscopicEvolveHM(dt); },
+                [=] () {
+                    return real_bytes * (llg_sweep_points() + 2 * FieldPoints(H) + FieldPoints(E) + FieldPoints(B));
+                }});
+            // the fixed-point iterations of the 2nd-order scheme sweep over M, H_bias, the material properties
+            // and the scratch fields of the scheme once per iteration; H is advanced once per call
+            kernels.push_back({"MacroscopicEvolveHM_2nd",
+                [&warpx, &llg_iter_before, &llg_calls] (Real dt) {
+                    if (llg_calls == 0) llg_iter_before = warpx.get_pointer_fdtd_solver_fp(0)->LLGIterationCount();
+                    warpx.MacroscopicEvolveHM_2nd(dt);
+                    ++llg_calls;
+                },
+                [=, &warpx, &llg_iter_before, &llg_calls] () {
+                    // the iteration count is accumulated over all calls, since the step number does not change
+                    double const iter_per_call = (llg_calls > 0)
+                        ? double(warpx.get_pointer_fdtd_solver_fp(0)->LLGIterationCount() - llg_iter_before) / llg_calls
+                        : 1.;
+                    amrex::Long scratch_bytes = warpx.get_pointer_fdtd_solver_fp(0)->LLGScratchBytes();
+                    ParallelDescriptor::ReduceLongSum(scratch_bytes);
+                    return iter_per_call * (real_bytes * llg_sweep_points() + scratch_bytes)
+                        + real_bytes * (2 * FieldPoints(H) + FieldPoints(E) + FieldPoints(B));
+                }});
+#endif
+        }
+
+#ifndef WARPX_MAG_LLG
+        if (warpx.do_fused_fdtd) {
+            // E and B are read and written once, with the material properties on each edge in a macroscopic medium
+            int const n_props = (WarpX::em_solver_medium == MediumForEM::Macroscopic) ? 3 : 0;
+            kernels.push_back({"EvolveBEFused",
+                [&warpx] (Real dt) { warpx.EvolveBEFused(dt); },
+                [=] () {
+                    return real_bytes * (2 * FieldPoints(E) + 2 * FieldPoints(B) + FieldPoints(J) + n_props * FieldPoints(E));
+                }});
+        }
+#endif
+
+        if (kernel_names.empty()) {
+            for (auto const& kernel : kernels) kernel_names.push_back(kernel.name);
+        }
+
+        amrex::Long n_cells = warpx.boxArray(0).numPts();
+        Real const dt = warpx.getdt(0);
+        int const algo_saved = WarpX::macroscopic_solver_algo;
+
+        amrex::Print() << "\nKernel benchmark on " << n_cells << " cells in " << warpx.boxArray(0).size()
+                       << " boxes (amr.max_grid_size = " << warpx.maxGridSize(0) << "), "
+                       << n_iter << " timed calls after " << n_warmup << " warm-up calls\n\n"
+                       << std::left << std::setw(34) << "kernel"
+                       << std::right << std::setw(14) << "time/call (s)"
+                       << std::setw(14) << "Mcells/s"
+                       << std::setw(12) << "GB/s" << "\n";
+
+        for (auto const& name : kernel_names) {
+            auto const kernel = std::find_if(kernels.begin(), kernels.end(),
+                                             [&name] (Kernel const& k) { return k.name == name; });
+            if (kernel == kernels.end()) {
+                amrex::Abort("bench.kernels: kernel " + name + " is unknown or not available in this build"
+                             " and for this algo.em_solver_medium");
+            }
+
+            for (int i = 0; i < n_warmup; ++i) kernel->run(dt);
+            amrex::Gpu::synchronize();
+            ParallelDescriptor::Barrier();
+
+            Real time = static_cast<Real>(amrex::second());
+            for (int i = 0; i < n_iter; ++i) kernel->run(dt);
+            amrex::Gpu::synchronize();
+            time = (static_cast<Real>(amrex::second()) - time) / n_iter;
+            ParallelDescriptor::ReduceRealMax(time);
+
+            double const bytes = kernel->bytes();
+            amrex::Print() << std::left << std::setw(34) << name
+                           << std::right << std::setw(14) << std::setprecision(4) << time
+                           << std::setw(14) << std::setprecision(4) << n_cells / time * 1.e-6
+                           << std::setw(12) << std::setprecision(4) << bytes / time * 1.e-9 << "\n";
+        }
+        amrex::Print() << "\n";
+        WarpX::macroscopic_solver_algo = algo_saved;
+    }
+
+    Finalize();
+#if defined(AMREX_USE_MPI)
+    MPI_Finalize();
+#endif
+}
@@ -0,0 +1,579 @@
+/* Copyright 2021
+ *
+ * This file is part of WarpX.
+ *
+ * License: BSD-3-Clause-LBNL
+ */
+#include "WarpX.H"
+#include "Initialization/WarpXAMReXInit.H"
+#include "Particles/Deposition/ChargeDeposition.H"
+#include "Particles/Deposition/CurrentDeposition.H"
+#include "Particles/ElementaryProcess/Ionization.H"
+#ifdef WARPX_QED
+#   include "Particles/ElementaryProcess/QEDPairGeneration.H"
+#   include "Particles/ElementaryProcess/QEDPhotonEmission.H"
+#endif
+#include "Particles/Gather/FieldGather.H"
+#include "Particles/Gather/GetExternalFields.H"
+#include "Particles/MultiParticleContainer.H"
+#include "Particles/PhysicalParticleContainer.H"
+#include "Particles/Pusher/CopyParticleAttribs.H"
+#include "Particles/Pusher/GetAndSetPosition.H"
+#include "Particles/Pusher/PushSelector.H"
+#include "Utils/MPIInitHelpers.H"
+#include "Utils/WarpXAlgorithmSelection.H"
+#include "Utils/WarpXConst.H"
+#include "Utils/WarpXUtil.H"
+
+#include <AMReX.H>
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+#include <AMReX_Random.H>
+#include <AMReX_Utility.H>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Micro-benchmark of the particle kernels (gather, push, deposition and the filters of the
+ * ionization and QED processes), each timed in isolation on synthetic particles.
+ *
+ * The grid, the fields and the species are set up by WarpX::InitData from a regular input deck
+ * (see Tools/PerformanceTests/KernelBenchmark/inputs_particles_3d). The particles injected by the
+ * deck are then replaced, in every tile of level 0, by bench.ppc particles per cell, with a
+ * Gaussian momentum spread bench.u_th (in units of c). A fraction bench.sorted_fraction of the
+ * particles is stored in the order of their cells; the others are in random cells of their
+ * tile, to measure the cost of unsorted memory accesses. Each kernel of bench.kernels is called
+ * bench.n_warmup times, then timed over bench.n_iter calls, on all the tiles one after the other,
+ * and its throughput is reported in particles/ns. The particle shape is of order
+ * bench.shape_order.
+ */
+namespace
+{
+    using namespace amrex::literals;
+
+    using PairIndex = std::pair<int, int>;
+
+    /** fields gathered on the particles of a tile (Ex, Ey, Ez, Bx, By, Bz), read by the pushers */
+    using FieldsOnParticles = std::map<PairIndex, std::array<amrex::Gpu::DeviceVector<amrex::ParticleReal>, 6>>;
+
+    struct SyntheticDistribution
+    {
+        int ppc = 8;
+        amrex::Real u_th = 0.01;
+        amrex::Real sorted_fraction = 1.;
+        int ionization_level = 0;
+    };
+
+    struct Kernel
+    {
+        std::string name;
+        std::function<void ()> run;
+        // whether the kernel moves the particles, which are then generated again after it is timed
+        bool moves_particles;
+    };
+
+    /** call f with the shape order as a compile-time constant */
+    template <typename F>
+    void ShapeOrderDispatch (int shape_order, F&& f)
+    {
+        if (shape_order == 1) {
+            f(std::integral_constant<int, 1>{});
+        } else if (shape_order == 2) {
+            f(std::integral_constant<int, 2>{});
+        } else {
+            f(std::integral_constant<int, 3>{});
+        }
+    }
+
+    /** index of the integer component `name` of pc, or -1 */
+    int IntComp (WarpXParticleContainer const& pc, std::string const& name)
+    {
+        auto const icomps = pc.getParticleiComps();
+        auto const it = icomps.find(name);
+        return (it == icomps.end()) ? -1 : it->second;
+    }
+
+    /** Replace the particles of level 0 of pc by the synthetic distribution dist */
+    void FillSyntheticParticles (WarpXParticleContainer& pc, SyntheticDistribution const& dist)
+    {
+        using namespace amrex;
+
+        const int lev = 0;
+        pc.InvalidateSoAPositions(lev);
+        pc.clearParticles();
+
+        auto const plo = pc.Geom(lev).ProbLoArray();
+        auto const dx = pc.Geom(lev).CellSizeArray();
+        const int myproc = ParallelDescriptor::MyProc();
+        const long ppc = dist.ppc;
+        const Real u_th = dist.u_th * PhysConst::c;
+        const Real sorted_fraction = dist.sorted_fraction;
+        const int ion_comp = IntComp(pc, "ionization_level");
+        const int ion_level = dist.ionization_level;
+
+        for (MFIter mfi = pc.MakeMFIter(lev); mfi.isValid(); ++mfi)
+        {
+            const Box tbx = mfi.tilebox();
+            const long ncells = tbx.numPts();
+            const long np = ncells * ppc;
+            auto& ptile = pc.DefineAndReturnParticleTile(lev, mfi.index(), mfi.LocalTileIndex());
+            ptile.resize(np);
+
+            // the attributes that are not drawn below are set to 0, and the ionization level to dist.ionization_level
+            auto& soa = ptile.GetStructOfArrays();
+            for (int comp = 0; comp < soa.NumRealComps(); ++comp) {
+                ParticleReal* const p = soa.GetRealData(comp).dataPtr();
+                ParallelFor(np, [=] AMREX_GPU_DEVICE (long i) noexcept { p[i] = 0._prt; });
+            }
+            for (int comp = 0; comp < soa.NumIntComps(); ++comp) {
+                int* const p = soa.GetIntData(comp).dataPtr();
+                const int value = (comp == ion_comp) ? ion_level : 0;
+                ParallelFor(np, [=] AMREX_GPU_DEVICE (long i) noexcept { p[i] = value; });
+            }
+
+            auto const ptd = ptile.getParticleTileData();
+            const Dim3 lo = lbound(tbx);
+            const IntVect len = tbx.length();
+            ParallelForRNG(np, [=] AMREX_GPU_DEVICE (long ip, RandomEngine const& engine) noexcept
+            {
+                long cell = ip / ppc;
+                if (Random(engine) >= sorted_fraction) {
+                    cell = amrex::min(static_cast<long>(Random(engine) * ncells), ncells - 1);
+                }
+                auto& p = ptd.m_aos[ip];
+                p.id() = ip + 1;
+                p.cpu() = myproc;
+#if (AMREX_SPACEDIM == 3)
+                const long i = cell % len[0];
+                const long j = (cell / len[0]) % len[1];
+                const long k = cell / (len[0] * len[1]);
+                p.pos(0) = plo[0] + (lo.x + i + Random(engine)) * dx[0];
+                p.pos(1) = plo[1] + (lo.y + j + Random(engine)) * dx[1];
+                p.pos(2) = plo[2] + (lo.z + k + Random(engine)) * dx[2];
+#else
+                const long i = cell % len[0];
+                const long j = cell / len[0];
+                p.pos(0) = plo[0] + (lo.x + i + Random(engine)) * dx[0];
+                p.pos(1) = plo[1] + (lo.y + j + Random(engine)) * dx[1];
+#endif
+#ifdef WARPX_DIM_RZ
+                ptd.m_rdata[PIdx::theta][ip] = 2._rt * MathConst::pi * Random(engine);
+#endif
+                ptd.m_rdata[PIdx::w][ip] = 1._prt;
+                ptd.m_rdata[PIdx::ux][ip] = RandomNormal(0._rt, u_th, engine);
+                ptd.m_rdata[PIdx::uy][ip] = RandomNormal(0._rt, u_th, engine);
+                ptd.m_rdata[PIdx::uz][ip] = RandomNormal(0._rt, u_th, engine);
+            });
+
+#ifdef WARPX_QED
+            // optical depths drawn as at the injection
+            auto const comps = pc.getParticleComps();
+            for (std::string const name : {"optical_depth_QSR", "optical_depth_BW"}) {
+                auto const it = comps.find(name);
+                if (it == comps.end()) continue;
+                ParticleReal* const p = soa.GetRealData(it->second).dataPtr();
+                ParallelForRNG(np, [=] AMREX_GPU_DEVICE (long i, RandomEngine const& engine) noexcept {
+                    p[i] = -std::log(Random(engine));
+                });
+            }
+#endif
+        }
+
+        // same layout of the positions as in Evolve (particles.soa_positions)
+        pc.InitSoAPositions(lev);
+        for (WarpXParIter pti(pc, lev); pti.isValid(); ++pti) pc.CopyPositionsToSoA(pti);
+        amrex::Gpu::synchronize();
+    }
+
+    /** Gather the fields of level 0 on the particles of pc, into fop, with doGatherShapeN */
+    template <int depos_order>
+    void GatherTiles (WarpXParticleContainer& pc, WarpX& warpx, FieldsOnParticles& fop)
+    {
+        const int lev = 0;
+        amrex::MultiFab const& Ex = warpx.getEfield(lev, 0);
+        amrex::MultiFab const& Ey = warpx.getEfield(lev, 1);
+        amrex::MultiFab const& Ez = warpx.getEfield(lev, 2);
+        amrex::MultiFab const& Bx = warpx.getBfield(lev, 0);
+        amrex::MultiFab const& By = warpx.getBfield(lev, 1);
+        amrex::MultiFab const& Bz = warpx.getBfield(lev, 2);
+        const std::array<amrex::Real,3>& dx = WarpX::CellSize(lev);
+
+        for (WarpXParIter pti(pc, lev); pti.isValid(); ++pti)
+        {
+            const long np = pti.numParticles();
+            amrex::Box box = pti.tilebox();
+            box.grow(Ex.nGrowVect());
+            const std::array<amrex::Real,3> xyzmin = WarpX::LowerCorner(box, {0._rt, 0._rt, 0._rt}, lev);
+
+            auto& f = fop[{pti.index(), pti.LocalTileIndex()}];
+            for (auto& comp : f) comp.resize(np);
+
+            auto gather = [&] (auto galerkin) {
+                doGatherShapeN<depos_order, decltype(galerkin)::value>(
+                    GetParticlePosition(pti), GetExternalEField(pti), GetExternalBField(pti),
+                    f[0].dataPtr(), f[1].dataPtr(), f[2].dataPtr(),
+                    f[3].dataPtr(), f[4].dataPtr(), f[5].dataPtr(),
+                    &Ex[pti], &Ey[pti], &Ez[pti], &Bx[pti], &By[pti], &Bz[pti],
+                    np, dx, xyzmin, amrex::lbound(box), WarpX::n_rz_azimuthal_modes);
+            };
+            if (WarpX::galerkin_interpolation) {
+                gather(std::integral_constant<int, 1>{});
+            } else {
+                gather(std::integral_constant<int, 0>{});
+            }
+        }
+    }
+
+    /** Push the particles of pc with the fields of fop, with doParticlePushCT */
+    template <int push_algo, bool do_ionization>
+    void PushTiles (WarpXParticleContainer& pc, FieldsOnParticles& fop, amrex::Real dt)
+    {
+        const int lev = 0;
+        const amrex::Real q = pc.getCharge();
+        const amrex::Real m = pc.getMass();
+        const int ion_comp = IntComp(pc, "ionization_level");
+        // no copy of the old positions and momenta (back-transformed diagnostics)
+        WarpXParticleContainer::TmpParticles tmp_particle_data;
+
+        for (WarpXParIter pti(pc, lev); pti.isValid(); ++pti)
+        {
+            const long np = pti.numParticles();
+            const auto getPosition = GetParticlePosition(pti);
+            const auto setPosition = SetParticlePosition(pti);
+            const auto copyAttribs = CopyParticleAttribs(pti, tmp_particle_data);
+
+            auto& attribs = pti.GetAttribs();
+            amrex::ParticleReal* const AMREX_RESTRICT ux = attribs[PIdx::ux].dataPtr();
+            amrex::ParticleReal* const AMREX_RESTRICT uy = attribs[PIdx::uy].dataPtr();
+            amrex::ParticleReal* const AMREX_RESTRICT uz = attribs[PIdx::uz].dataPtr();
+            const int* const AMREX_RESTRICT ion_lev = do_ionization ? pti.GetiAttribs(ion_comp).dataPtr() : nullptr;
+
+            auto& f = fop.at({pti.index(), pti.LocalTileIndex()});
+            const amrex::ParticleReal* const AMREX_RESTRICT Ex = f[0].dataPtr();
+            const amrex::ParticleReal* const AMREX_RESTRICT Ey = f[1].dataPtr();
+            const amrex::ParticleReal* const AMREX_RESTRICT Ez = f[2].dataPtr();
+            const amrex::ParticleReal* const AMREX_RESTRICT Bx = f[3].dataPtr();
+            const amrex::ParticleReal* const AMREX_RESTRICT By = f[4].dataPtr();
+            const amrex::ParticleReal* const AMREX_RESTRICT Bz = f[5].dataPtr();
+
+            amrex::ParallelFor(np, [=] AMREX_GPU_DEVICE (long ip)
+            {
+                doParticlePushCT<push_algo, do_ionization>(
+                    getPosition, setPosition, copyAttribs, ip,
+                    ux[ip], uy[ip], uz[ip],
+                    Ex[ip], Ey[ip], Ez[ip], Bx[ip], By[ip], Bz[ip],
+                    do_ionization ? ion_lev[ip] : 0, m, q, 0,
+#ifdef WARPX_QED
+                    0, 0._rt,
+#endif
+                    dt);
+            });
+        }
+    }
+
+    /** Deposit the current of the particles of pc in the current of level 0, with
+     *  doDepositionShapeN or doEsirkepovDepositionShapeN */
+    template <int depos_order>
+    void DepositCurrentTiles (WarpXParticleContainer& pc, WarpX& warpx, amrex::Real dt, bool esirkepov)
+    {
+        const int lev = 0;
+        amrex::MultiFab& jx = *warpx.get_pointer_current_fp(lev, 0);
+        amrex::MultiFab& jy = *warpx.get_pointer_current_fp(lev, 1);
+        amrex::MultiFab& jz = *warpx.get_pointer_current_fp(lev, 2);
+        const std::array<amrex::Real,3>& dx = WarpX::CellSize(lev);
+        const amrex::Real q = pc.getCharge();
+        const int ion_comp = pc.DoFieldIonization() ? IntComp(pc, "ionization_level") : -1;
+
+        for (WarpXParIter pti(pc, lev); pti.isValid(); ++pti)
+        {
+            const long np = pti.numParticles();
+            amrex::Box tilebox = pti.tilebox();
+            tilebox.grow(warpx.get_ng_depos_J());
+            const std::array<amrex::Real,3> xyzmin = WarpX::LowerCorner(tilebox, {0._rt, 0._rt, 0._rt}, lev);
+            const amrex::Dim3 lo = amrex::lbound(tilebox);
+
+            auto& attribs = pti.GetAttribs();
+            const int* const ion_lev = (ion_comp >= 0) ? pti.GetiAttribs(ion_comp).dataPtr() : nullptr;
+            const auto GetPosition = GetParticlePosition(pti);
+
+            if (esirkepov) {
+                doEsirkepovDepositionShapeN<depos_order>(
+                    GetPosition, attribs[PIdx::w].dataPtr(), attribs[PIdx::ux].dataPtr(),
+                    attribs[PIdx::uy].dataPtr(), attribs[PIdx::uz].dataPtr(), ion_lev,
+                    jx.array(pti), jy.array(pti), jz.array(pti), np, dt, dx, xyzmin, lo, q,
+                    WarpX::n_rz_azimuthal_modes, nullptr, WarpX::load_balance_costs_update_algo);
+            } else {
+                doDepositionShapeN<depos_order>(
+                    GetPosition, attribs[PIdx::w].dataPtr(), attribs[PIdx::ux].dataPtr(),
+                    attribs[PIdx::uy].dataPtr(), attribs[PIdx::uz].dataPtr(), ion_lev,
+                    jx[pti], jy[pti], jz[pti], np, -0.5_rt*dt, dx, xyzmin, lo, q,
+                    WarpX::n_rz_azimuthal_modes, nullptr, WarpX::load_balance_costs_update_algo);
+            }
+        }
+    }
+
+    /** Deposit the charge of the particles of pc in rho, with doChargeDepositionShapeN */
+    template <int depos_order>
+    void DepositChargeTiles (WarpXParticleContainer& pc, amrex::MultiFab& rho, amrex::IntVect const& ng_rho)
+    {
+        const int lev = 0;
+        const std::array<amrex::Real,3>& dx = WarpX::CellSize(lev);
+        const amrex::Real q = pc.getCharge();
+        const int ion_comp = pc.DoFieldIonization() ? IntComp(pc, "ionization_level") : -1;
+
+        for (WarpXParIter pti(pc, lev); pti.isValid(); ++pti)
+        {
+            const long np = pti.numParticles();
+            amrex::Box tilebox = pti.tilebox();
+            tilebox.grow(ng_rho);
+            const std::array<amrex::Real,3> xyzmin = WarpX::LowerCorner(tilebox, {0._rt, 0._rt, 0._rt}, lev);
+
+            const int* const ion_lev = (ion_comp >= 0) ? pti.GetiAttribs(ion_comp).dataPtr() : nullptr;
+            doChargeDepositionShapeN<depos_order>(
+                GetParticlePosition(pti), pti.GetAttribs(PIdx::w).dataPtr(), ion_lev,
+                rho[pti], np, dx, xyzmin, amrex::lbound(tilebox), q,
+                WarpX::n_rz_azimuthal_modes, nullptr, WarpX::load_balance_costs_update_algo);
+        }
+    }
+
+    /** Evaluate the filter functor returned by get_filter(pti) on each particle of pc, into a
+     *  mask, as the first pass of filterCopyTransformParticles */
+    template <typename Filter>
+    void FilterTiles (WarpXParticleContainer& pc, std::function<Filter (WarpXParIter const&)> const& get_filter,
+                      amrex::Gpu::DeviceVector<int>& mask)
+    {
+        const int lev = 0;
+        for (WarpXParIter pti(pc, lev); pti.isValid(); ++pti)
+        {
+            const int np = static_cast<int>(pti.numParticles());
+            const auto filter = get_filter(pti);
+            const auto ptd = pti.GetParticleTile().getConstParticleTileData();
+            mask.resize(np);
+            int* const p_mask = mask.dataPtr();
+            amrex::ParallelForRNG(np,
+                [=] AMREX_GPU_DEVICE (int i, amrex::RandomEngine const& engine) noexcept
+                {
+                    p_mask[i] = filter(ptd, i, engine);
+                });
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace amrex;
+
+    auto mpi_thread_levels = utils::warpx_mpi_init(argc, argv);
+
+    warpx_amrex_init(argc, argv);
+
+    utils::warpx_check_mpi_thread_level(mpi_thread_levels);
+
+    ConvertLabParamsToBoost();
+    ReadBCParams();
+
+    {
+        WarpX warpx;
+
+        warpx.InitData();
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(warpx.finestLevel() == 0,
+            "the particle kernel benchmark runs on a single level (amr.max_level = 0)");
+
+        int n_iter = 10;
+        int n_warmup = 2;
+        int shape_order = static_cast<int>(WarpX::nox);
+        SyntheticDistribution dist;
+        std::vector<std::string> kernel_names;
+        std::vector<std::string> species_names = warpx.GetPartContainer().GetSpeciesNames();
+        ParmParse pp_bench("bench");
+        pp_bench.query("n_iter", n_iter);
+        pp_bench.query("n_warmup", n_warmup);
+        pp_bench.queryarr("kernels", kernel_names);
+        pp_bench.queryarr("species", species_names);
+        pp_bench.query("ppc", dist.ppc);
+        queryWithParser(pp_bench, "u_th", dist.u_th);
+        queryWithParser(pp_bench, "sorted_fraction", dist.sorted_fraction);
+        pp_bench.query("shape_order", shape_order);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(n_iter > 0 && n_warmup >= 0,
+            "bench.n_iter must be > 0 and bench.n_warmup >= 0");
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(dist.ppc > 0 && dist.u_th >= 0.
+                                         && dist.sorted_fraction >= 0. && dist.sorted_fraction <= 1.,
+            "bench.ppc must be > 0, bench.u_th >= 0 and bench.sorted_fraction in [0, 1]");
+        // the guard cells of the fields are set for the shape order of the input deck
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(shape_order >= 1 && shape_order <= WarpX::nox,
+            "bench.shape_order must be between 1 and interpolation.nox");
+
+        const Real dt = warpx.getdt(0);
+        const IntVect ng_rho = warpx.get_ng_depos_rho();
+        MultiFab rho(amrex::convert(warpx.boxArray(0), IntVect::TheNodeVector()),
+                     warpx.DistributionMap(0), WarpX::ncomps, ng_rho);
+        rho.setVal(0.);
+        FieldsOnParticles fop;
+        Gpu::DeviceVector<int> mask;
+
+        for (auto const& species_name : species_names)
+        {
+            auto const& all_names = warpx.GetPartContainer().GetSpeciesNames();
+            auto const ispecies = std::find(all_names.begin(), all_names.end(), species_name);
+            if (ispecies == all_names.end()) amrex::Abort("bench.species: unknown species " + species_name);
+            WarpXParticleContainer& pc = warpx.GetPartContainer().GetParticleContainer(
+                static_cast<int>(ispecies - all_names.begin()));
+            auto* const phys_pc = dynamic_cast<PhysicalParticleContainer*>(&pc);
+
+            SyntheticDistribution species_dist = dist;
+            if (pc.DoFieldIonization()) {
+                ParmParse pp_species(species_name);
+                pp_species.query("ionization_initial_level", species_dist.ionization_level);
+            }
+            FillSyntheticParticles(pc, species_dist);
+            auto gather = [&] () {
+                ShapeOrderDispatch(shape_order, [&] (auto order) {
+                    GatherTiles<decltype(order)::value>(pc, warpx, fop);
+                });
+            };
+            // the pushers read the gathered fields
+            gather();
+
+            // all kernels available in this build and for this species
+            std::vector<Kernel> kernels;
+            kernels.push_back({"gather", gather, false});
+            if (pc.getMass() > 0.) {
+                auto push = [&] (auto push_algo) {
+                    constexpr int algo = decltype(push_algo)::value;
+                    if (pc.DoFieldIonization()) {
+                        PushTiles<algo, true>(pc, fop, dt);
+                    } else {
+                        PushTiles<algo, false>(pc, fop, dt);
+                    }
+                };
+                kernels.push_back({"push_boris",
+                    [=] () { push(std::integral_constant<int, ParticlePusherAlgo::Boris>{}); }, true});
+                kernels.push_back({"push_vay",
+                    [=] () { push(std::integral_constant<int, ParticlePusherAlgo::Vay>{}); }, true});
+                kernels.push_back({"push_higuera_cary",
+                    [=] () { push(std::integral_constant<int, ParticlePusherAlgo::HigueraCary>{}); }, true});
+                kernels.push_back({"push_boris_radiation_reaction",
+                    [=] () { push(std::integral_constant<int, PushAlgoCT::BorisRadiationReaction>{}); }, true});
+            }
+            kernels.push_back({"deposit_current_direct",
+                [&] () {
+                    ShapeOrderDispatch(shape_order, [&] (auto order) {
+                        DepositCurrentTiles<decltype(order)::value>(pc, warpx, dt, false);
+                    });
+                }, false});
+            if (!WarpX::do_nodal) {
+                kernels.push_back({"deposit_current_esirkepov",
+                    [&] () {
+                        ShapeOrderDispatch(shape_order, [&] (auto order) {
+                            DepositCurrentTiles<decltype(order)::value>(pc, warpx, dt, true);
+                        });
+                    }, false});
+            }
+            kernels.push_back({"deposit_charge",
+                [&] () {
+                    ShapeOrderDispatch(shape_order, [&] (auto order) {
+                        DepositChargeTiles<decltype(order)::value>(pc, rho, ng_rho);
+                    });
+                }, false});
+            if (phys_pc && pc.DoFieldIonization()) {
+                kernels.push_back({"ionization_filter",
+                    [&] () {
+                        FilterTiles<IonizationFilterFunc>(pc, [&] (WarpXParIter const& pti) {
+                            return phys_pc->getIonizationFunc(pti, 0, warpx.getEfield(0, 0).nGrowVect(),
+                                warpx.getEfield(0, 0)[pti], warpx.getEfield(0, 1)[pti], warpx.getEfield(0, 2)[pti],
+                                warpx.getBfield(0, 0)[pti], warpx.getBfield(0, 1)[pti], warpx.getBfield(0, 2)[pti]);
+                        }, mask);
+                    }, false});
+            }
+#ifdef WARPX_QED
+            if (phys_pc && pc.has_quantum_sync()) {
+                kernels.push_back({"qed_photon_emission_filter",
+                    [&] () {
+                        FilterTiles<PhotonEmissionFilterFunc>(pc, [&] (WarpXParIter const&) {
+                            return phys_pc->getPhotonEmissionFilterFunc();
+                        }, mask);
+                    }, false});
+            }
+            if (phys_pc && pc.has_breit_wheeler()) {
+                kernels.push_back({"qed_pair_generation_filter",
+                    [&] () {
+                        FilterTiles<PairGenerationFilterFunc>(pc, [&] (WarpXParIter const&) {
+                            return phys_pc->getPairGenerationFilterFunc();
+                        }, mask);
+                    }, false});
+            }
+#endif
+
+            std::vector<std::string> names = kernel_names;
+            if (names.empty()) {
+                for (auto const& kernel : kernels) names.push_back(kernel.name);
+            }
+
+            Long n_particles = pc.TotalNumberOfParticles(true, true);
+            ParallelDescriptor::ReduceLongSum(n_particles);
+
+            amrex::Print() << "\nParticle kernel benchmark of species " << species_name << ": "
+                           << n_particles << " particles (bench.ppc = " << dist.ppc
+                           << ", bench.u_th = " << dist.u_th
+                           << ", bench.sorted_fraction = " << dist.sorted_fraction
+                           << ", bench.shape_order = " << shape_order << "), "
+                           << n_iter << " timed calls after " << n_warmup << " warm-up calls\n\n"
+                           << std::left << std::setw(34) << "kernel"
+                           << std::right << std::setw(14) << "time/call (s)"
+                           << std::setw(16) << "particles/ns" << "\n";
+
+            for (auto const& name : names) {
+                auto const kernel = std::find_if(kernels.begin(), kernels.end(),
+                                                 [&name] (Kernel const& k) { return k.name == name; });
+                if (kernel == kernels.end()) {
+                    // e.g. a filter of a process that another species of bench.species has
+                    if (!kernel_names.empty()) {
+                        amrex::Print() << std::left << std::setw(34) << name
+                                       << std::right << std::setw(30) << "not available" << "\n";
+                    }
+                    continue;
+                }
+
+                for (int i = 0; i < n_warmup; ++i) kernel->run();
+                amrex::Gpu::synchronize();
+                ParallelDescriptor::Barrier();
+
+                Real time = static_cast<Real>(amrex::second());
+                for (int i = 0; i < n_iter; ++i) kernel->run();
+                amrex::Gpu::synchronize();
+                time = (static_cast<Real>(amrex::second()) - time) / n_iter;
+                ParallelDescriptor::ReduceRealMax(time);
+
+                amrex::Print() << std::left << std::setw(34) << name
+                               << std::right << std::setw(14) << std::setprecision(4) << time
+                               << std::setw(16) << std::setprecision(4) << n_particles / time * 1.e-9 << "\n";
+
+                // the pushed particles are generated again, so that all kernels see the same distribution
+                if (kernel->moves_particles) {
+                    FillSyntheticParticles(pc, species_dist);
+                    gather();
+                }
+            }
+            amrex::Print() << "\n";
+
+            pc.InvalidateSoAPositions(0);
+            pc.clearParticles();
+            fop.clear();
+        }
+    }
+
+    Finalize();
+#if defined(AMREX_USE_MPI)
+    MPI_Finalize();
+#endif
+}
@@ -7,17 +7,19 @@
 
 import os, copy
 
-from functions_perftest import test_element
+from functions_perftest import test_element, build_suffix
 
 module_name = {'cpu': 'haswell.', 'knl': 'mic-knl.', 'gpu':'.'}
 
-def executable_name(compiler, architecture):
+def executable_name(compiler, architecture, build='default'):
     return 'perf_tests3d.' + compiler + \
-        '.' + module_name[architecture] + 'TPROF.MPI.OMP.ex'
+        '.' + module_name[architecture] + 'TPROF.MPI.OMP' + \
+        build_suffix[build] + '.ex'
 
 def get_config_command(compiler, architecture):
     config_command = ''
     config_command += 'module unload darshan;'
+    config_command += 'module load cray-fftw;'
     if architecture == 'knl':
         if compiler == 'intel':
             config_command += 'module unload PrgEnv-gnu;'
@@ -100,6 +102,7 @@ def get_batch_string(test_list, job_time_min, Cname, n_node):
     batch_string += '#SBATCH --account=m2852\n'
     batch_string += 'module unload PrgEnv-gnu\n'
     batch_string += 'module load PrgEnv-intel\n'
+    batch_string += 'module load cray-fftw\n'
     return batch_string
 
 def get_run_string(current_test, architecture, n_node, count, bin_name, runtime_param_string):
@@ -166,5 +169,68 @@ def get_test_list(n_repeat):
                                        max_grid_size=64,
                                        blocking_factor=32,
                                        n_step=1) )
+    # Tests of the macroscopic, LLG, PSATD, collision and QED paths, each with
+    # a weak scaling variant (n_cell scales with n_node) and a strong scaling
+    # variant (n_cell fixed to the weak scaling n_cell at 8 nodes)
+    for scaling, n_cell in [('weak', [128, 128, 128]), ('strong', [256, 256, 256])]:
+        test_list_unq.append( test_element(input_file='automated_test_7_macroscopic_maxwell',
+                                           n_mpi_per_node=8,
+                                           n_omp=8,
+                                           n_cell=n_cell,
+                                           max_grid_size=64,
+                                           blocking_factor=32,
+                                           n_step=20,
+                                           build='default',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [64, 64, 128]), ('strong', [128, 128, 256])]:
+        test_list_unq.append( test_element(input_file='automated_test_8_llg_1st_order',
+                                           n_mpi_per_node=8,
+                                           n_omp=8,
+                                           n_cell=n_cell,
+                                           max_grid_size=64,
+                                           blocking_factor=32,
+                                           n_step=20,
+                                           build='llg',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [64, 64, 128]), ('strong', [128, 128, 256])]:
+        test_list_unq.append( test_element(input_file='automated_test_9_llg_2nd_order',
+                                           n_mpi_per_node=8,
+                                           n_omp=8,
+                                           n_cell=n_cell,
+                                           max_grid_size=64,
+                                           blocking_factor=32,
+                                           n_step=20,
+                                           build='llg',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [64, 64, 128]), ('strong', [128, 128, 256])]:
+        test_list_unq.append( test_element(input_file='automated_test_10_psatd_uniform_4ppc',
+                                           n_mpi_per_node=8,
+                                           n_omp=8,
+                                           n_cell=n_cell,
+                                           max_grid_size=64,
+                                           blocking_factor=32,
+                                           n_step=10,
+                                           build='psatd',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [64, 64, 128]), ('strong', [128, 128, 256])]:
+        test_list_unq.append( test_element(input_file='automated_test_11_collision_16ppc',
+                                           n_mpi_per_node=8,
+                                           n_omp=8,
+                                           n_cell=n_cell,
+                                           max_grid_size=64,
+                                           blocking_factor=32,
+                                           n_step=10,
+                                           build='default',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [64, 64, 128]), ('strong', [128, 128, 256])]:
+        test_list_unq.append( test_element(input_file='automated_test_12_qed_2ppc',
+                                           n_mpi_per_node=8,
+                                           n_omp=8,
+                                           n_cell=n_cell,
+                                           max_grid_size=64,
+                                           blocking_factor=32,
+                                           n_step=10,
+                                           build='qed',
+                                           scaling=scaling) )
     test_list = [copy.deepcopy(item) for item in test_list_unq for _ in range(n_repeat) ]
     return test_list
@@ -12,11 +12,19 @@ import git
 # import cori
 # import summit
 
+# Compilation options of each build, and the corresponding suffix of the
+# executable name. A test runs with the executable of its build.
+build_options = {'default': '', 'llg': ' USE_LLG=TRUE',
+                 'psatd': ' USE_PSATD=TRUE', 'qed': ' QED=TRUE'}
+build_suffix = {'default': '', 'llg': '.LLG', 'psatd': '.PSATD', 'qed': '.QED'}
+
 # Each instance of this class contains information for a single test.
+# With scaling='weak', n_cell is doubled each time n_node is doubled,
+# with scaling='strong', n_cell is the same for all n_node.
 class test_element():
     def __init__(self, input_file=None, n_node=None, n_mpi_per_node=None,
                  n_omp=None, n_cell=None, n_step=None, max_grid_size=None,
-                 blocking_factor=None):
+                 blocking_factor=None, build='default', scaling='weak'):
         self.input_file = input_file
         self.n_node = n_node
         self.n_mpi_per_node = n_mpi_per_node
@@ -25,8 +33,12 @@ class test_element():
         self.n_step = n_step
         self.max_grid_size = max_grid_size
         self.blocking_factor = blocking_factor
+        self.build = build
+        self.scaling = scaling
 
     def scale_n_cell(self, n_node=0):
+        if self.scaling == 'strong':
+            return
         n_cell_scaled = copy.deepcopy(self.n_cell)
         index_dim = 0
         while n_node > 1:
@@ -100,14 +112,15 @@ def run_batch(run_name, res_dir, bin_name, config_command, architecture='knl',\
     os.system(config_command + 'sbatch ' + batch_file + ' >> ' + cwd + 'log_jobids_tmp.txt')
     return 0
 
-def run_batch_nnode(test_list, res_dir, cwd, bin_name, config_command, batch_string, submit_job_command):
+def run_batch_nnode(test_list, res_dir, cwd, bin_names, config_command, batch_string, submit_job_command):
     # Clean res_dir
     if os.path.exists(res_dir):
          shutil.rmtree(res_dir, ignore_errors=True)
     os.makedirs(res_dir)
     # Copy files to res_dir
     bin_dir = cwd + 'Bin/'
-    shutil.copy(bin_dir + bin_name, res_dir)
+    for bin_name in bin_names:
+        shutil.copy(bin_dir + bin_name, res_dir)
     os.chdir(res_dir)
 
     for count, current_test in enumerate(test_list):
@@ -116,7 +129,8 @@ def run_batch_nnode(test_list, res_dir, cwd, bin_name, config_command, batch_str
     f_exe = open(batch_file,'w')
     f_exe.write(batch_string)
     f_exe.close()
-    os.system('chmod 700 ' + bin_name)
+    for bin_name in bin_names:
+        os.system('chmod 700 ' + bin_name)
     os.system(config_command + submit_job_command + batch_file +\
                    ' >> ' + cwd + 'log_jobids_tmp.txt')
 
@@ -220,6 +234,45 @@ def extract_dataframe(filename, n_steps):
     # df['string_output'] = partition_limit_start + '\n' + search_area
     return df
 
+# Read the last output of the Timing reduced diagnostics (the time per step of
+# each phase, averaged over the steps of the run) and return the average over
+# the MPI ranks of each phase, as a dataframe with columns phase_<name>
+def extract_phase_timings(filename):
+    df = pd.DataFrame()
+    if not os.path.exists(filename):
+        return df
+    with open(filename) as file_handler:
+        lines = file_handler.read().split('\n')
+    header = lines[0].split()
+    values = [line.split() for line in lines[1:] if line.strip() != '']
+    if len(values) == 0:
+        return df
+    # header entries look like [12]field_push_avg(s)
+    for column, value in zip(header, values[-1]):
+        name = column.partition(']')[2].partition('(')[0]
+        if name.endswith('_avg'):
+            df.loc[0, 'phase_' + name[:-len('_avg')]] = float(value)
+    return df
+
+# Append the phase timings of a test to the performance log file. A new
+# header line is written whenever the phases differ from those of the last
+# header, so that the file stays readable when phases are added.
+def write_phase_logfile(log_file, first_columns, first_values, df_phases):
+    phases = [column[len('phase_'):] for column in df_phases.columns]
+    header = '## ' + ' '.join(first_columns + phases) + ' (unit: second per step)\n'
+    last_header = ''
+    if os.path.exists(log_file):
+        with open(log_file) as file_handler:
+            for line in file_handler:
+                if line.startswith('##'):
+                    last_header = line
+    log_line = ''
+    if last_header != header:
+        log_line += header
+    log_line += ' '.join([str(value) for value in first_values] + \
+                         ['%.4g' %value for value in df_phases.loc[0]]) + '\n'
+    return write_perf_logfile(log_file, log_line)
+
 # Run a performance test in an interactive allocation
 # def run_interactive(run_name, res_dir, n_node=1, n_mpi=1, n_omp=1):
 #     # Clean res_dir                                                                                                                                                                                                                                                           #
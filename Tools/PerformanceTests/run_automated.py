@@ -9,7 +9,8 @@ import os, sys, shutil, datetime, git
 import argparse, time, copy
 import pandas as pd
 from functions_perftest import store_git_hash, get_file_content, \
-    run_batch_nnode, extract_dataframe
+    run_batch_nnode, extract_dataframe, extract_phase_timings, \
+    write_phase_logfile, build_options
 
 # Get name of supercomputer and import configuration functions from
 # machine-specific file
@@ -132,6 +133,8 @@ if args.automated == True:
 n_repeat = 2
 # test_list is machine-specific
 test_list = get_test_list(n_repeat)
+# Each build used by the tests is compiled once
+build_list = sorted(set(current_run.build for current_run in test_list))
 
 # Define directories
 # ------------------
@@ -140,6 +143,12 @@ picsar_dir = source_dir_base + '/picsar/'
 amrex_dir = source_dir_base + '/amrex/'
 perf_logs_repo = source_dir_base + 'perf_logs/'
 
+# Directory of the Timing reduced diagnostics of a test, in res_dir
+def timing_dir(current_run, n_node, count):
+    return './timing_' + '_'.join([current_run.input_file, str(n_node),
+                                   str(current_run.n_mpi_per_node),
+                                   str(current_run.n_omp), str(count)]) + '/'
+
 # Define dictionaries
 # -------------------
 compiler_name = {'intel': 'intel', 'gnu': 'gcc', 'pgi':'pgi'}
@@ -153,7 +162,7 @@ if args.automated:
     path_hdf5 = perf_logs_repo + '/logs_hdf5/'
 
 bin_dir = cwd + 'Bin/'
-bin_name = executable_name(compiler, architecture)
+bin_names = [executable_name(compiler, architecture, build) for build in build_list]
 
 log_dir  = cwd
 day = time.strftime('%d')
@@ -195,7 +204,9 @@ if args.mode == 'run':
         if machine == 'summit':
             make_command += ' USE_GPU=TRUE '
         os.system(config_command + make_realclean_command + \
-                  "rm -r tmp_build_dir *.mod; " + make_command )
+                  "rm -r tmp_build_dir *.mod; ")
+        for build in build_list:
+            os.system(config_command + make_command + build_options[build])
 
         # Store git hashes for WarpX, AMReX and PICSAR into file, so that
         # they can be read when running the analysis.
@@ -229,14 +240,20 @@ if args.mode == 'run':
             runtime_param_string += ' amr.max_grid_size=' + str(current_run.max_grid_size)
             runtime_param_string += ' amr.blocking_factor=' + str(current_run.blocking_factor)
             runtime_param_string += ' max_step=' + str( current_run.n_step )
+            # Time per step of each phase, averaged over the run
+            runtime_param_string += ' warpx.reduced_diags_names=perf_timing'
+            runtime_param_string += ' perf_timing.type=Timing'
+            runtime_param_string += ' perf_timing.intervals=' + str( current_run.n_step )
+            runtime_param_string += ' perf_timing.path=' + timing_dir(current_run, n_node, count)
             # runtime_param_list.append( runtime_param_string )
+            bin_name = executable_name(compiler, architecture, current_run.build)
             run_string = get_run_string(current_run, architecture, n_node, count, bin_name, runtime_param_string)
             batch_string += run_string
             batch_string += 'rm -rf plotfiles lab_frame_data diags\n'
 
         submit_job_command = get_submit_job_command()
         # Run the simulations.
-        run_batch_nnode(test_list_n_node, res_dir, cwd, bin_name, config_command, batch_string, submit_job_command)
+        run_batch_nnode(test_list_n_node, res_dir, cwd, bin_names, config_command, batch_string, submit_job_command)
     os.chdir(cwd)
     # submit batch for analysis
     if os.path.exists( 'read_error.txt' ):
@@ -262,6 +279,8 @@ for n_node in n_node_list:
             # This is an hdf5 file containing ALL the simulation
             # parameters and results. Might be too large for a repo
             df_newline = extract_dataframe(res_dir + output_filename, current_run.n_step)
+            df_phases = extract_phase_timings(res_dir + timing_dir(current_run, n_node, count) + 'perf_timing.txt')
+            df_newline = pd.concat([df_newline, df_phases], axis=1)
             # Add all simulation parameters to the dataframe
             df_newline['git_hashes'] = get_file_content(filename=cwd+'store_git_hashes.txt')
             df_newline['start_date'] = start_date
@@ -271,6 +290,8 @@ for n_node in n_node_list:
             df_newline['n_mpi_per_node'] = current_run.n_mpi_per_node
             df_newline['n_omp'] = current_run.n_omp
             df_newline['n_steps'] = current_run.n_step
+            df_newline['build'] = current_run.build
+            df_newline['scaling'] = current_run.scaling
             df_newline['rep'] = count%n_repeat
             df_newline['date'] = datetime.datetime.now()
             if store_full_input:
@@ -285,6 +306,19 @@ for n_node in n_node_list:
             # Write dataframe to file perf_database_file
             # (overwrite if file exists)
             updated_df.to_hdf(path_hdf5 + perf_database_file, key='all_data', mode='w', format='table')
+            # Append the phase timings to the performance log, to follow
+            # them over time
+            if not df_phases.empty:
+                log_columns = ['year', 'month', 'day', 'input_file', 'build', 'scaling',
+                               'compiler', 'architecture', 'n_node', 'n_mpi', 'n_omp',
+                               'time_initialization', 'time_one_iteration']
+                log_values = [year, month, day, current_run.input_file, current_run.build,
+                              current_run.scaling, compiler, architecture, n_node,
+                              current_run.n_mpi_per_node, current_run.n_omp,
+                              '%.4g' %df_newline['time_initialization'][0],
+                              '%.4g' %(df_newline['time_running'][0]/current_run.n_step)]
+                write_phase_logfile(log_dir + 'performance_log.txt', log_columns,
+                                    log_values, df_phases)
 
 # Extract sub-set of pandas data frame, write it to
 # csv file and copy this file to perf_logs repo
@@ -9,10 +9,10 @@
 # - module load python/3.7.0-anaconda3-5.3.0
 
 import os, copy
-from functions_perftest import test_element
+from functions_perftest import test_element, build_suffix
 
-def executable_name(compiler,architecture):
-    return 'perf_tests3d.' + compiler + '.TPROF.MPI.CUDA.ex'
+def executable_name(compiler, architecture, build='default'):
+    return 'perf_tests3d.' + compiler + '.TPROF.MPI.CUDA' + build_suffix[build] + '.ex'
 
 def get_config_command(compiler, architecture):
     config_command = ''
@@ -139,5 +139,68 @@ def get_test_list(n_repeat):
                                        max_grid_size=256,
                                        blocking_factor=64,
                                        n_step=1) )
+    # Tests of the macroscopic, LLG, PSATD, collision and QED paths, each with
+    # a weak scaling variant (n_cell scales with n_node) and a strong scaling
+    # variant (n_cell fixed to the weak scaling n_cell at 8 nodes)
+    for scaling, n_cell in [('weak', [256, 256, 384]), ('strong', [512, 512, 768])]:
+        test_list_unq.append( test_element(input_file='automated_test_7_macroscopic_maxwell',
+                                           n_mpi_per_node=6,
+                                           n_omp=1,
+                                           n_cell=n_cell,
+                                           max_grid_size=128,
+                                           blocking_factor=64,
+                                           n_step=20,
+                                           build='default',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [128, 128, 192]), ('strong', [256, 256, 384])]:
+        test_list_unq.append( test_element(input_file='automated_test_8_llg_1st_order',
+                                           n_mpi_per_node=6,
+                                           n_omp=1,
+                                           n_cell=n_cell,
+                                           max_grid_size=128,
+                                           blocking_factor=64,
+                                           n_step=20,
+                                           build='llg',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [128, 128, 192]), ('strong', [256, 256, 384])]:
+        test_list_unq.append( test_element(input_file='automated_test_9_llg_2nd_order',
+                                           n_mpi_per_node=6,
+                                           n_omp=1,
+                                           n_cell=n_cell,
+                                           max_grid_size=128,
+                                           blocking_factor=64,
+                                           n_step=20,
+                                           build='llg',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [128, 128, 192]), ('strong', [256, 256, 384])]:
+        test_list_unq.append( test_element(input_file='automated_test_10_psatd_uniform_4ppc',
+                                           n_mpi_per_node=6,
+                                           n_omp=1,
+                                           n_cell=n_cell,
+                                           max_grid_size=128,
+                                           blocking_factor=64,
+                                           n_step=10,
+                                           build='psatd',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [128, 128, 192]), ('strong', [256, 256, 384])]:
+        test_list_unq.append( test_element(input_file='automated_test_11_collision_16ppc',
+                                           n_mpi_per_node=6,
+                                           n_omp=1,
+                                           n_cell=n_cell,
+                                           max_grid_size=128,
+                                           blocking_factor=64,
+                                           n_step=10,
+                                           build='default',
+                                           scaling=scaling) )
+    for scaling, n_cell in [('weak', [128, 128, 192]), ('strong', [256, 256, 384])]:
+        test_list_unq.append( test_element(input_file='automated_test_12_qed_2ppc',
+                                           n_mpi_per_node=6,
+                                           n_omp=1,
+                                           n_cell=n_cell,
+                                           max_grid_size=128,
+                                           blocking_factor=64,
+                                           n_step=10,
+                                           build='qed',
+                                           scaling=scaling) )
     test_list = [copy.deepcopy(item) for item in test_list_unq for _ in range(n_repeat) ]
     return test_list
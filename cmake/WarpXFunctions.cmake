@@ -159,7 +159,13 @@ function(set_warpx_binary_name)
         list(APPEND warpx_bin_names shared)
     endif()
     foreach(tgt IN LISTS _ALL_TARGETS)
-        set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx")
+        if(tgt STREQUAL kernel_benchmark)
+            set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx_kernel_benchmark")
+        elseif(tgt STREQUAL particle_kernel_benchmark)
+            set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx_particle_kernel_benchmark")
+        else()
+            set_target_properties(${tgt} PROPERTIES OUTPUT_NAME "warpx")
+        endif()
         if(WarpX_DIMS STREQUAL 3)
             set_property(TARGET ${tgt} APPEND_STRING PROPERTY OUTPUT_NAME ".3d")
         elseif(WarpX_DIMS STREQUAL 2)
@@ -196,6 +202,9 @@ function(set_warpx_binary_name)
 
         if(WarpX_MAG_LLG)
             set_property(TARGET WarpX APPEND_STRING PROPERTY OUTPUT_NAME ".LLG")
+            if(WarpX_MAG_LLG_MIXED_PRECISION)
+                set_property(TARGET WarpX APPEND_STRING PROPERTY OUTPUT_NAME ".MP")
+            endif()
         endif()
 
         if(WarpX_EB)
@@ -210,6 +219,10 @@ function(set_warpx_binary_name)
             set_property(TARGET ${tgt} APPEND_STRING PROPERTY OUTPUT_NAME ".GENQEDTABLES")
         endif()
 
+        if(WarpX_QED AND WarpX_QED_TABLES_SINGLE)
+            set_property(TARGET ${tgt} APPEND_STRING PROPERTY OUTPUT_NAME ".SPQEDTABLES")
+        endif()
+
 
         if(CMAKE_BUILD_TYPE MATCHES "Debug")
             set_property(TARGET ${tgt} APPEND_STRING PROPERTY OUTPUT_NAME ".DEBUG")
@@ -335,6 +348,7 @@ function(warpx_print_summary)
     message("  Build options:")
     message("    APP: ${WarpX_APP}")
     message("    ASCENT: ${WarpX_ASCENT}")
+    message("    BENCHMARK: ${WarpX_BENCHMARK}")
     message("    CCACHE: ${CCACHE_PROGRAM}")
     message("    COMPUTE: ${WarpX_COMPUTE}")
     message("    DIMS: ${WarpX_DIMS}")
@@ -351,6 +365,8 @@ function(warpx_print_summary)
     message("    OPENPMD: ${WarpX_OPENPMD}")
     message("    QED: ${WarpX_QED}")
     message("    LLG: ${WarpX_MAG_LLG}")
+    message("    LLG mixed precision: ${WarpX_MAG_LLG_MIXED_PRECISION}")
     message("    QED table generation: ${WarpX_QED_TABLE_GEN}")
+    message("    QED single-precision tables: ${WarpX_QED_TABLES_SINGLE}")
     message("")
 endfunction()
@@ -29,20 +29,19 @@ if(WarpX_PSATD)
         endif()
         mark_as_advanced(WarpX_FFTW_SEARCH)
 
+        # the single-precision library is also needed in double precision,
+        # for psatd.fft_precision = single
         if(WarpX_FFTW_SEARCH STREQUAL CMAKE)
             if(WarpX_PRECISION STREQUAL "DOUBLE")
                 find_package(FFTW3 CONFIG REQUIRED)
-            else()
-                find_package(FFTW3f CONFIG REQUIRED)
             endif()
+            find_package(FFTW3f CONFIG REQUIRED)
         else()
+            find_package(PkgConfig REQUIRED QUIET)
             if(WarpX_PRECISION STREQUAL "DOUBLE")
-                find_package(PkgConfig REQUIRED QUIET)
                 pkg_check_modules(fftw3 REQUIRED IMPORTED_TARGET fftw3)
-            else()
-                find_package(PkgConfig REQUIRED QUIET)
-                pkg_check_modules(fftw3f REQUIRED IMPORTED_TARGET fftw3f)
             endif()
+            pkg_check_modules(fftw3f REQUIRED IMPORTED_TARGET fftw3f)
         endif()
     endif()
 
@@ -64,6 +63,12 @@ if(WarpX_PSATD)
             else()
                 make_third_party_includes_system(PkgConfig::fftw3 FFT)
             endif()
+            # single-precision FFTs (psatd.fft_precision = single)
+            if(FFTW3f_FOUND)
+                target_link_libraries(WarpX::thirdparty::FFT INTERFACE FFTW3::fftw3f)
+            else()
+                target_link_libraries(WarpX::thirdparty::FFT INTERFACE PkgConfig::fftw3f)
+            endif()
         else()
             if(FFTW3f_FOUND)
                 # subtargets: fftw3f, fftw3f_threads, fftw3f_omp